@@ -2,15 +2,49 @@
 #define ULTREALITY_RENDERING_D3D12_RENDERER_H
 
 #include <windows.h>
+#include <wrl.h>
 #include <d3d12.h>
 #include <dxgi1_4.h>
 
 #include <stdint.h>
+#include <chrono>
+#include <memory>
+#include <vector>
 
 #include <IRenderer.h>
 #include <DisplayTarget.h>
 #include <PlatformMessageHandler.h>
 
+#include <FrameRing.h>
+#include <D3D12FenceTimeline.h>
+#include <D3D12UploadRing.h>
+#include <D3D12HeapManager.h>
+#include <D3D12DescriptorAllocator.h>
+#include <D3D12DescriptorRing.h>
+#include <D3D12BindlessTable.h>
+#include <D3D12CommandListPool.h>
+#include <D3D12QueueSet.h>
+#include <D3D12UploadQueue.h>
+#include <D3D12TextureStreamer.h>
+#include <D3D12DrawItem.h>
+#include <D3D12GpuCuller.h>
+#include <D3D12RenderGraph.h>
+#include <D3D12PostProcessor.h>
+#include <D3D12ResourceStateTracker.h>
+#include <D3D12PipelineCache.h>
+#include <ShaderCache.h>
+#include <D3D12GpuProfiler.h>
+#include <FrameTimingStats.h>
+#include <JobSystem.h>
+#include <FrustumCulling.h>
+#include <DrawSortKey.h>
+#include <InstanceBatcher.h>
+#include <OcclusionCulling.h>
+#include <ShadowCascades.h>
+#include <ClusteredLighting.h>
+#include <DynamicResolution.h>
+#include <DeferredReleaseQueue.h>
+
 #if defined(__GNUC__) or defined(__clang__)
 #define FORCE_INLINE inline __attribute__((always_inline))
 #elif defined(_MSC_VER)
@@ -33,6 +67,227 @@ namespace UltReality::Rendering
 		uint32_t m_dsvDescriptorSize;
 		// 
 		uint32_t m_cbvSrvDescriptorSize;
+		// Sampler descriptor size
+		uint32_t m_samplerDescriptorSize;
+
+		// Number of frames the CPU may record ahead of the GPU
+		uint32_t m_framesInFlight = 2;
+		// Command allocator for each frame slot. Only reset once the frame slot has been retired by the GPU
+		Microsoft::WRL::ComPtr<ID3D12CommandAllocator> m_frameCmdListAllocs[Common::FrameRing::maxFramesInFlight];
+		// Fence timeline of the direct command queue
+		std::unique_ptr<D3D12::D3D12FenceTimeline> m_fenceTimeline;
+		// Tracks the fence value of every frame in flight
+		std::unique_ptr<Common::FrameRing> m_frameRing;
+
+		// Size in bytes of the per-frame upload ring shared by all frames in flight
+		static constexpr uint64_t s_uploadRingCapacity = 16ull * 1024 * 1024;
+		// Persistently mapped ring that per-draw constants and other transient upload data are sub-allocated from
+		std::unique_ptr<D3D12::D3D12UploadRing> m_uploadRing;
+
+		// Sub-allocates GPU resources out of large heap pages instead of one implicit heap per resource
+		std::unique_ptr<D3D12::D3D12HeapManager> m_heapManager;
+		// Heap placement of the depth stencil buffer
+		D3D12::D3D12PlacedAllocation m_depthStencilAllocation;
+		// Heap placement of the shadow map, an atlas holding every cascade
+		D3D12::D3D12PlacedAllocation m_shadowMapAllocation;
+		// Atlas caching the depth of static casters, copied into the shadow map before dynamic casters are drawn
+		D3D12::D3D12PlacedAllocation m_shadowStaticAtlasAllocation;
+		Microsoft::WRL::ComPtr<ID3D12Resource> m_shadowStaticAtlas;
+		// Targets replaced by settings changes. Their blocks go back to the heap pages once the frames using them retired
+		Common::DeferredReleaseQueue<D3D12::D3D12PlacedAllocation> m_retiredAllocations;
+
+		// Growable CPU-only descriptor allocators, one per heap type
+		std::unique_ptr<D3D12::D3D12CPUDescriptorAllocator> m_rtvAllocator;
+		std::unique_ptr<D3D12::D3D12CPUDescriptorAllocator> m_dsvAllocator;
+		std::unique_ptr<D3D12::D3D12CPUDescriptorAllocator> m_cbvSrvUavAllocator;
+		std::unique_ptr<D3D12::D3D12CPUDescriptorAllocator> m_samplerAllocator;
+
+		// Number of descriptors in the shader visible heaps. The CBV/SRV/UAV heap starts with the bindless region,
+		// the per-frame ring covers the rest
+		static constexpr uint32_t s_bindlessDescriptorCount = 262144;
+		static constexpr uint32_t s_cbvSrvUavRingCount = 65536;
+		static constexpr uint32_t s_shaderVisibleCbvSrvUavCount = s_bindlessDescriptorCount + s_cbvSrvUavRingCount;
+		static constexpr uint32_t s_shaderVisibleSamplerCount = D3D12_MAX_SHADER_VISIBLE_SAMPLER_HEAP_SIZE;
+		// Shader visible heaps bound for every frame
+		Microsoft::WRL::ComPtr<ID3D12DescriptorHeap> m_shaderVisibleCbvSrvUavHeap;
+		Microsoft::WRL::ComPtr<ID3D12DescriptorHeap> m_shaderVisibleSamplerHeap;
+		// Per-frame descriptor table rings over the shader visible heaps
+		std::unique_ptr<D3D12::D3D12DescriptorRing> m_cbvSrvUavRing;
+		std::unique_ptr<D3D12::D3D12DescriptorRing> m_samplerRing;
+		// Long lived descriptors shaders reach by index
+		std::unique_ptr<D3D12::D3D12BindlessTable> m_bindlessTable;
+		// Root signature of bindless draws, null if the device's resource binding tier is too low
+		Microsoft::WRL::ComPtr<ID3D12RootSignature> m_bindlessRootSignature;
+
+		// Render target views of the swap chain buffers
+		D3D12::D3D12DescriptorAllocation m_backBufferRTVs;
+		// Depth stencil view of the depth buffer
+		D3D12::D3D12DescriptorAllocation m_depthStencilDSV;
+		// Depth stencil views of the shadow map and of the static shadow atlas
+		D3D12::D3D12DescriptorAllocation m_shadowMapDSV;
+		D3D12::D3D12DescriptorAllocation m_shadowStaticDSV;
+		// CPU-only texture sampler, copied into the sampler ring by passes that need it
+		D3D12::D3D12DescriptorAllocation m_samplerDescriptor;
+
+		// Members are destroyed in reverse order of declaration. Everything below that runs work on the job system, the
+		// upload queue or the streaming uploader is declared after the service it uses, so it is destroyed while that
+		// service still runs and never leaves work queued on it. New users of these services belong below them too
+
+		// Work-stealing scheduler used to record command lists in parallel
+		std::unique_ptr<Common::JobSystem> m_jobSystem;
+		// Per worker, per frame command lists for the direct queue
+		std::unique_ptr<D3D12::D3D12CommandListPool> m_directListPool;
+		// Per worker, per frame command lists for the async compute queue
+		std::unique_ptr<D3D12::D3D12CommandListPool> m_computeListPool;
+		// Compute and copy queues next to the direct queue, with the cross-queue waits between their submissions
+		std::unique_ptr<D3D12::D3D12QueueSet> m_queueSet;
+
+		// Size in bytes of the staging buffer background uploads are written into
+		static constexpr uint64_t s_streamingStagingCapacity = 64ull * 1024 * 1024;
+		// Staging bytes and copies after which the uploader submits a batch
+		static constexpr uint64_t s_streamingBatchBytes = 8ull * 1024 * 1024;
+		static constexpr uint32_t s_streamingBatchCopies = 512;
+		// Executes background uploads on the copy queue
+		std::unique_ptr<D3D12::D3D12UploadQueue> m_uploadQueue;
+		// Batches uploads on its own thread
+		std::unique_ptr<Common::StreamingUploader> m_streamingUploader;
+
+		// Texture memory budget used when the adapter cannot report one
+		static constexpr uint64_t s_defaultTextureBudget = 512ull * 1024 * 1024;
+		// Adapter of the device, null if it cannot report its video memory budget
+		Microsoft::WRL::ComPtr<IDXGIAdapter3> m_videoMemoryAdapter;
+		// Budget set through SetTextureStreamingBudget, 0 to derive it from the adapter
+		uint64_t m_textureBudgetOverride = 0;
+		// Share of the budget streamed textures may use and bias of their requested mips, both from TextureSettings::quality
+		float m_textureBudgetScale = 1.0f;
+		float m_textureMipBias = 0.0f;
+		// Streams texture mips within the budget
+		std::unique_ptr<D3D12::D3D12TextureStreamer> m_textureStreamer;
+		// Number of draws recorded by a single job
+		static constexpr uint32_t s_drawsPerRecordingJob = 256;
+		// Root parameter the per-draw constants of a <seealso cref="D3D12::DrawItem"/> are bound to
+		static constexpr uint32_t s_objectConstantsRootParameter = 0;
+		// Draws queued for the next Render() call
+		std::vector<D3D12::DrawItem> m_drawItems;
+		// Sorts the queued draws by their key before recording
+		std::unique_ptr<Common::DrawKeySorter> m_drawKeySorter;
+		// Scratch of the sort, kept between frames to reuse their memory
+		std::vector<uint64_t> m_drawSortKeys;
+		std::vector<uint32_t> m_drawOrder;
+		std::vector<D3D12::DrawItem> m_sortedDrawItems;
+
+		// Draws queued for automatic instancing, merged into m_drawItems by the next Render() call
+		std::vector<D3D12::DrawItem> m_instancedDraws;
+		std::vector<uint64_t> m_instancedSortKeys;
+		std::vector<uint64_t> m_instancedBatchKeys;
+		// Per-instance data of every instanced draw, packed back to back
+		std::vector<uint8_t> m_instanceData;
+		std::vector<uint32_t> m_instanceDataOffsets;
+		// Groups the instanced draws
+		std::unique_ptr<Common::InstanceBatcher> m_instanceBatcher;
+		std::vector<Common::InstanceBatch> m_instanceBatches;
+		std::vector<uint32_t> m_instanceOrder;
+		// Command lists of the frame in submission order
+		std::vector<ID3D12CommandList*> m_submitLists;
+
+		// Culls and draws instances on the GPU. Null when the culling shaders cannot be compiled or the device cannot
+		// bind the bindless root signature
+		std::unique_ptr<D3D12::D3D12GpuCuller> m_gpuCuller;
+		// Pipeline key the instances are drawn with, 0 while none was set
+		uint64_t m_instancePipelineKey = 0;
+		// Frustum GPU driven instances and CPU side volumes are culled against. All zero planes until a camera is set, which culls nothing
+		float m_cullFrustumPlanes[6][4] = {};
+		// Culls CPU side bounding volumes against the same frustum on the job system
+		std::unique_ptr<Common::FrustumCuller> m_frustumCuller;
+		// Hides CPU side boxes behind the occluders of the frame
+		std::unique_ptr<Common::OcclusionCuller> m_occlusionCuller;
+
+		// Splits and projections of the shadow cascades and their tiles in the shadow map
+		std::unique_ptr<Common::ShadowCascadeSet> m_shadowCascades;
+		// Bindless view of the shadow map, invalid until the shadow map is created
+		Common::BindlessHandle m_shadowAtlasSrv;
+		// Shadow casters queued for the next Render() call, per cascade
+		std::vector<D3D12::DrawItem> m_shadowStaticCasters[Common::maxShadowCascades];
+		std::vector<D3D12::DrawItem> m_shadowDynamicCasters[Common::maxShadowCascades];
+		// Whether UpdateShadowCascades was called for the frame being built
+		bool m_shadowCascadesUpdated = false;
+		// Cascades whose static depth is rendered by the frame being built, one bit each
+		uint32_t m_shadowStaticCascadeMask = 0;
+		// Whether the shadow map holds dynamic casters on top of the static depth
+		bool m_shadowMapHasDynamicCasters = false;
+
+		// Bins the point lights into the cluster grid
+		std::unique_ptr<Common::ClusteredLightBinner> m_lightBinner;
+		// View space spheres of the lights and the lists of the last binning, kept to reuse their memory
+		Common::BoundingSphereSoA m_clusterLightSpheres;
+		std::vector<Common::ClusterLightRange> m_clusterLightRanges;
+		std::vector<uint32_t> m_clusterLightIndices;
+		// Projection the last lights were binned for, kept to bin them again for a new grid
+		float m_clusterProjection[4] = {};
+		// Persistent buffers of the lights, the cluster ranges and the light index list, with their capacities in
+		// elements. Their views keep the same bindless index until a list outgrows its buffer
+		D3D12::D3D12PlacedAllocation m_clusterLightBuffers[3];
+		uint32_t m_clusterLightCapacities[3] = {};
+		Common::BindlessHandle m_clusterLightSrvs[3];
+		// Smallest buffer a cluster list gets, so a few more lights do not replace it
+		static constexpr uint32_t s_minClusterListCapacity = 256;
+		// Lists staged by the last SetClusterLights or SetClusterGrid call, copied into the buffers by the next Render() call
+		D3D12::UploadAllocation m_clusterLightUploads[3];
+		// Constants of the last lights, no lights until SetClusterLights is called
+		Common::ClusterShaderConstants m_clusterConstants;
+
+		// Post-processing chain, null when the renderer was built without DXC since its shaders ship as source
+		std::unique_ptr<D3D12::D3D12PostProcessor> m_postProcessor;
+		// HDR target the scene is drawn into while post-processing is active, created the first time an effect is enabled
+		D3D12::D3D12PlacedAllocation m_sceneColorAllocation;
+		Microsoft::WRL::ComPtr<ID3D12Resource> m_sceneColor;
+		// Render target view of the scene color
+		D3D12::D3D12DescriptorAllocation m_sceneColorRTV;
+		// Declared index of the scene pass in the frame graph
+		uint32_t m_scenePass = 0;
+
+		// Picks the scale the scene is drawn at from the GPU frame times. The scene targets keep the display size,
+		// the scene is drawn into their top left and upscaled by the post-processing passes
+		Common::DynamicResolutionController m_dynamicResolution;
+		// Last profiled frame whose GPU time was fed to the controller
+		uint64_t m_dynamicResolutionFrame = 0;
+
+		// Compiles pipelines on the job system and persists them across runs
+		std::unique_ptr<D3D12::D3D12PipelineCache> m_pipelineCache;
+		// What happens to draws whose pipeline is still compiling
+		D3D12::PipelinePendingPolicy m_pipelinePendingPolicy = D3D12::PipelinePendingPolicy::SkipDraw;
+		// Directory the pipeline library is persisted in
+		static constexpr const char* s_pipelineCacheDirectory = "PipelineCache";
+
+		// Timestamp queries of the direct queue, resolved a few frames late so the CPU never waits on them
+		std::unique_ptr<D3D12::D3D12GpuProfiler> m_gpuProfiler;
+
+		// CPU frame, fence wait and present interval of the most recent frames
+		Common::FrameTimingStats m_frameTiming;
+		// When the current frame's Render() call started
+		std::chrono::steady_clock::time_point m_frameStartTime;
+		// Seconds between the starts of the previous and the current frame, zero for the first frame
+		float m_frameDeltaSeconds = 0.0f;
+		// Longest frame delta time based effects see
+		static constexpr float s_maxFrameDeltaSeconds = 0.1f;
+		// When the previous frame was presented, default constructed before the first present
+		std::chrono::steady_clock::time_point m_lastPresentTime;
+		// Time the current frame spent waiting for its frame slot
+		float m_fenceWaitMilliseconds = 0.0f;
+
+		// Reads shader sources and includes for hashing and compiling
+		std::unique_ptr<Common::FileShaderIncludeResolver> m_shaderIncludeResolver;
+		// Null when the renderer was built without DXC, the shader cache then only serves stored blobs
+		std::unique_ptr<Common::IShaderCompiler> m_shaderCompiler;
+		// Compiled shaders keyed by their source, include closure, defines and arguments
+		std::unique_ptr<Common::ShaderCache> m_shaderCache;
+		// Directory compiled shaders are persisted in
+		static constexpr const char* s_shaderCacheDirectory = "ShaderCache";
+
+		// Frame graph rebuilt every frame. Derives the frame's barriers and owns the transient targets
+		std::unique_ptr<D3D12::D3D12RenderGraph> m_renderGraph;
+		// State of every long lived resource as of the last submission to the direct queue
+		Common::ResourceStateTable m_resourceStates;
 
 		/// <summary>
 		/// Method creates the DirectX device <seealso cref="m_d3dDevice"/>
@@ -66,16 +321,106 @@ namespace UltReality::Rendering
 		/// </summary>
 		FORCE_INLINE void CreateCommandObjects();
 
+		/// <summary>
+		/// Gets the command allocator of the frame slot currently being recorded
+		/// </summary>
+		FORCE_INLINE ID3D12CommandAllocator* CurrentFrameAllocator() const;
+
 		/// <summary>
 		/// Creates the swap chain and sets <seealso cref="m_swapChain"/>
 		/// </summary>
 		FORCE_INLINE void CreateSwapChain();
 
 		/// <summary>
-		/// Creates the descriptor heaps, setting <seealso cref="m_rtvHeap"/>, <seealso cref="m_dsvHeap"/>
+		/// Creates the descriptor allocators and shader visible heaps, and allocates the renderer's fixed descriptors
 		/// </summary>
 		FORCE_INLINE void CreateDescriptorHeaps();
 
+		/// <summary>
+		/// Binds the descriptor heaps, viewport, scissor rect and render targets of the scene pass
+		/// </summary>
+		/// <param name="cmdList">Command list to bind the state on</param>
+		FORCE_INLINE void BindSceneTargets(ID3D12GraphicsCommandList* cmdList);
+
+		/// <summary>
+		/// Declares the passes of the current frame in <seealso cref="m_renderGraph"/> and compiles it
+		/// </summary>
+		FORCE_INLINE void BuildFrameGraph();
+
+		/// <summary>
+		/// Hashes the adapter and driver version, so pipelines persisted for another GPU or driver are discarded
+		/// </summary>
+		uint64_t PipelineCompatibilityHash() const;
+
+		/// <summary>
+		/// Sets the texture streaming budget from the adapter's video memory budget, or from the configured override
+		/// </summary>
+		void UpdateTextureStreamingBudget();
+
+		/// <summary>
+		/// Compiles the culling shaders and creates <seealso cref="m_gpuCuller"/> if the device supports it
+		/// </summary>
+		void CreateGpuCuller();
+
+		/// <summary>
+		/// Creates <seealso cref="m_postProcessor"/> if the runtime shader compiler is available
+		/// </summary>
+		void CreatePostProcessor();
+
+		/// <summary>
+		/// Replaces the pipeline key of every draw with the pipeline from <seealso cref="m_pipelineCache"/> and
+		/// drops the draws that have none yet
+		/// </summary>
+		/// <returns>True if no draw was dropped</returns>
+		bool ResolveDrawPipelines(std::vector<D3D12::DrawItem>& drawItems);
+
+		/// <summary>
+		/// Merges the queued instanced draws into one draw per batch, with the batch's instance data packed into the upload ring
+		/// </summary>
+		void BuildInstanceBatches();
+
+		/// <summary>
+		/// Reorders the queued draws by their sort key, so neighbouring draws share as much state as possible
+		/// </summary>
+		void SortDrawItems();
+
+		/// <summary>
+		/// Records the draws in [<paramref name="first"/>, <paramref name="last"/>) into <paramref name="cmdList"/>
+		/// </summary>
+		void RecordDrawRange(ID3D12GraphicsCommandList* cmdList, const std::vector<D3D12::DrawItem>& drawItems, uint32_t first, uint32_t last) const;
+
+		/// <summary>
+		/// Resolves the pipelines of the queued shadow casters and picks the cascades whose static depth is rendered
+		/// this frame. Cascades are marked rendered unless one of their static casters is still compiling
+		/// </summary>
+		void PrepareShadowCasters();
+
+		/// <summary>
+		/// Records the casters of the cascades in <paramref name="cascadeMask"/>, each into its tile of the atlas behind <paramref name="dsv"/>
+		/// </summary>
+		/// <param name="clear">Whether the tiles are cleared first</param>
+		void RecordShadowCasters(ID3D12GraphicsCommandList* cmdList, D3D12_CPU_DESCRIPTOR_HANDLE dsv, const std::vector<D3D12::DrawItem>* casters, uint32_t cascadeMask, bool clear) const;
+
+		/// <summary>
+		/// Reclaims per-frame allocations of every frame the GPU has finished with
+		/// </summary>
+		/// <param name="completedFenceValue">Last fence value completed by the GPU</param>
+		FORCE_INLINE void RetireFrameResources(uint64_t completedFenceValue);
+
+		/// <summary>
+		/// Tags the per-frame allocations made during the current frame with the frame's fence value
+		/// </summary>
+		/// <param name="frameFenceValue">Fence value signalled at the end of the frame</param>
+		FORCE_INLINE void FinishFrameResources(uint64_t frameFenceValue);
+
+		/// <summary>
+		/// Replaces a placed target without waiting for the GPU. The target is dropped from the state tracker and
+		/// its allocation queued on <seealso cref="m_retiredAllocations"/>, so a new one can be placed alongside it
+		/// </summary>
+		/// <param name="resource">Reference to the target, reset</param>
+		/// <param name="allocation">Placement of the target, reset</param>
+		FORCE_INLINE void RetireTarget(Microsoft::WRL::ComPtr<ID3D12Resource>& resource, D3D12::D3D12PlacedAllocation& allocation);
+
 		/// <summary>
 		/// Initializes the items in <seealso cref="m_swapChainBuffer"/>
 		/// </summary>
@@ -87,7 +432,36 @@ namespace UltReality::Rendering
 		FORCE_INLINE void CreateDepthStencilBuffer();
 
 		/// <summary>
-		/// Issues command to initialize the viewport and its configuration
+		/// Creates the <seealso cref="m_sceneColor"/> at the display size
+		/// </summary>
+		FORCE_INLINE void CreateSceneColorBuffer();
+
+		/// <summary>
+		/// Whether the scene is drawn into <seealso cref="m_sceneColor"/> and post-processed into the back buffer, for
+		/// any enabled effect or for dynamic resolution. The scene color is single sampled, so post-processing is
+		/// bypassed while MSAA is enabled
+		/// </summary>
+		FORCE_INLINE bool IsPostProcessingActive() const;
+
+		/// <summary>
+		/// Whether the scene is drawn at the scale picked by <seealso cref="m_dynamicResolution"/>
+		/// </summary>
+		FORCE_INLINE bool IsDynamicResolutionActive() const;
+
+		/// <summary>
+		/// Feeds the GPU time of the last profiled frame to <seealso cref="m_dynamicResolution"/> and sizes the viewport
+		/// of the next frame
+		/// </summary>
+		FORCE_INLINE void UpdateRenderScale();
+
+		/// <summary>
+		/// Gets the view of the target the scene pass draws into
+		/// </summary>
+		FORCE_INLINE D3D12_CPU_DESCRIPTOR_HANDLE SceneTargetView() const;
+
+		/// <summary>
+		/// Issues command to initialize the viewport and its configuration. The viewport covers the display size times
+		/// the dynamic resolution scale
 		/// </summary>
 		FORCE_INLINE void SetViewport();
 		//FORCE_INLINE void SetScissorRectangles(D3D12_RECT* rect);
@@ -102,6 +476,27 @@ namespace UltReality::Rendering
 
 		FORCE_INLINE void RecreateShadowMap();
 
+		/// <summary>
+		/// Bins <seealso cref="m_clusterLightSpheres"/> into the cluster grid with the projection of the last lights
+		/// </summary>
+		FORCE_INLINE void BinClusterLights();
+
+		/// <summary>
+		/// Stages one of the cluster lists for the next frame, replacing its buffer and view if the list outgrew it
+		/// </summary>
+		/// <param name="list">0 for the lights, 1 for the cluster ranges, 2 for the light indices</param>
+		FORCE_INLINE void StageClusterList(uint32_t list, const void* data, uint32_t count, uint32_t stride);
+
+		/// <summary>
+		/// Stages the cluster ranges and light indices of the last binning and points <seealso cref="m_clusterConstants"/> at the buffers
+		/// </summary>
+		FORCE_INLINE void StageClusterBins(uint32_t lightCount);
+
+		/// <summary>
+		/// Copies the staged cluster lists into their buffers
+		/// </summary>
+		FORCE_INLINE void RecordClusterLightCopies(ID3D12GraphicsCommandList* cmdList);
+
 		FORCE_INLINE void UpdateSoftShadowsState();
 
 		FORCE_INLINE ID3D12Resource* CurrentBackBuffer() const;
@@ -152,11 +547,326 @@ namespace UltReality::Rendering
 		/// </summary>
 		void RENDERER_INTERFACE_CALL FlushCommandQueue() final;
 
+		/// <summary>
+		/// Queues a draw to be recorded by the next <seealso cref="Render"/> call. Draws are recorded in the order of
+		/// their sort keys
+		/// </summary>
+		/// <param name="item">Draw to record</param>
+		void SubmitDrawItem(const D3D12::DrawItem& item);
+
+		/// <summary>
+		/// Queues one instance of a draw. Instances of draws sharing geometry, pipeline, root signature, constants and
+		/// resource indices are merged into a single instanced draw by the next <seealso cref="Render"/> call. Their data
+		/// is packed into a vertex buffer bound to slot 1, so the pipeline needs per-instance input elements in that slot
+		/// </summary>
+		/// <param name="item">Draw to instance. Its instance count, start instance and instance buffer are ignored</param>
+		/// <param name="instanceData">Per-instance data of this instance, e.g. its world transform</param>
+		/// <param name="instanceDataSize">Size in bytes of <paramref name="instanceData"/>, the same for every instance of a batch</param>
+		void SubmitInstancedDrawItem(const D3D12::DrawItem& item, const void* instanceData, uint32_t instanceDataSize);
+
+		const Common::InstanceBatcher::Statistics& GetInstanceBatchStatistics() const;
+
+		/// <summary>
+		/// Gets the draw count, sort time and state changes saved by sorting of the last frame
+		/// </summary>
+		const Common::DrawKeySorter::Statistics& GetDrawSortStatistics() const;
+
+		/// <summary>
+		/// Queues command lists for one of the renderer's queues. They are executed by the next <seealso cref="Render"/>
+		/// call ahead of the frame's graphics work, which depends on all of them
+		/// </summary>
+		/// <param name="queue">Queue to execute the lists on</param>
+		/// <param name="lists">Closed command lists. Their allocators may be reset once the fence of that frame completed</param>
+		/// <param name="dependencies">Earlier submissions of this frame whose results the lists consume</param>
+		/// <returns>Index of the submission, to be used as a dependency of later ones</returns>
+		uint32_t SubmitCommandLists(Common::QueueType queue, const std::vector<ID3D12CommandList*>& lists, const std::vector<uint32_t>& dependencies = {});
+
+		/// <summary>
+		/// Uploads <paramref name="data"/> into a buffer on the copy queue in the background. Never blocks the calling thread
+		/// </summary>
+		/// <param name="destination">Buffer in the COMMON state. Must stay alive until the upload completed</param>
+		/// <param name="destinationOffset">Byte offset into <paramref name="destination"/></param>
+		/// <param name="data">Bytes to upload</param>
+		/// <returns>Ticket to poll with <seealso cref="IsUploadComplete"/></returns>
+		Common::UploadTicket UploadBuffer(ID3D12Resource* destination, uint64_t destinationOffset, std::vector<uint8_t> data);
+
+		/// <summary>
+		/// Uploads one subresource of a texture on the copy queue in the background. Never blocks the calling thread
+		/// </summary>
+		/// <param name="destination">Texture in the COMMON state. Must stay alive until the upload completed</param>
+		/// <param name="subresource">Destination subresource</param>
+		/// <param name="data">Texel rows of the subresource</param>
+		/// <param name="rowPitch">Distance in bytes between the rows in <paramref name="data"/></param>
+		/// <returns>Ticket to poll with <seealso cref="IsUploadComplete"/></returns>
+		Common::UploadTicket UploadTexture(ID3D12Resource* destination, uint32_t subresource, std::vector<uint8_t> data, uint64_t rowPitch);
+
+		/// <summary>
+		/// Checks whether a background upload finished on the GPU, so its destination can be used by the next frame
+		/// </summary>
+		bool IsUploadComplete(Common::UploadTicket ticket);
+
+		/// <summary>
+		/// Creates a texture whose mips are streamed in and out within the texture memory budget
+		/// </summary>
+		/// <param name="desc">Description of a 2D texture with a single array slice</param>
+		/// <param name="writer">Provides the texels of a mip when it streams in. Runs on the uploader thread</param>
+		/// <returns>Texture index for the other streaming methods</returns>
+		uint32_t CreateStreamedTexture(const D3D12_RESOURCE_DESC& desc, D3D12::D3D12TextureStreamer::MipWriter writer);
+
+		void DestroyStreamedTexture(uint32_t texture);
+
+		/// <summary>
+		/// Reports how many pixels a streamed texture covers on screen along its longer axis this frame
+		/// </summary>
+		void ReportTextureFootprint(uint32_t texture, float screenPixels);
+
+		/// <summary>
+		/// Overrides the texture streaming budget
+		/// </summary>
+		/// <param name="budgetBytes">Budget before the quality scale is applied, 0 to follow the adapter's video memory budget</param>
+		void SetTextureStreamingBudget(uint64_t budgetBytes);
+
+		const Common::TextureStreamingManager::Statistics& GetTextureStreamingStatistics() const;
+
+		/// <summary>
+		/// Creates a shader resource view in the bindless table
+		/// </summary>
+		/// <returns>Handle to pass to <seealso cref="GetBindlessIndex"/> and <seealso cref="FreeBindless"/></returns>
+		Common::BindlessHandle CreateBindlessSrv(ID3D12Resource* resource, const D3D12_SHADER_RESOURCE_VIEW_DESC* desc);
+
+		/// <summary>
+		/// Creates an unordered access view in the bindless table
+		/// </summary>
+		/// <returns>Handle to pass to <seealso cref="GetBindlessIndex"/> and <seealso cref="FreeBindless"/></returns>
+		Common::BindlessHandle CreateBindlessUav(ID3D12Resource* resource, const D3D12_UNORDERED_ACCESS_VIEW_DESC* desc, ID3D12Resource* counter = nullptr);
+
+		/// <summary>
+		/// Frees a bindless descriptor. Its index is reused once the frames that may still read it retired
+		/// </summary>
+		void FreeBindless(Common::BindlessHandle handle);
+
+		/// <summary>
+		/// Gets the shader index of a bindless descriptor, to be put into <seealso cref="D3D12::DrawItem::resourceIndices"/>
+		/// </summary>
+		uint32_t GetBindlessIndex(Common::BindlessHandle handle) const;
+
+		/// <summary>
+		/// Gets the root signature draws with resource indices are recorded with, null if the device cannot bind it
+		/// </summary>
+		ID3D12RootSignature* GetBindlessRootSignature() const;
+
+		/// <summary>
+		/// Checks whether instances can be culled and drawn on the GPU. The instance methods below require it
+		/// </summary>
+		bool IsGpuDrivenDrawingSupported() const;
+
+		/// <summary>
+		/// Replaces the mesh table GPU driven instances draw from
+		/// </summary>
+		/// <param name="meshes">Index ranges of the meshes inside the geometry buffers</param>
+		/// <param name="vertexBuffer">Vertex buffer shared by every mesh</param>
+		/// <param name="indexBuffer">Index buffer shared by every mesh</param>
+		void SetInstanceMeshes(const std::vector<Common::GpuMesh>& meshes, const D3D12_VERTEX_BUFFER_VIEW& vertexBuffer, const D3D12_INDEX_BUFFER_VIEW& indexBuffer);
+
+		/// <summary>
+		/// Sets the number of GPU driven instances. Existing records are kept when the count grows
+		/// </summary>
+		void SetInstanceCount(uint32_t count);
+
+		/// <summary>
+		/// Uploads the records of instances [<paramref name="first"/>, <paramref name="first"/> + size of <paramref name="instances"/>)
+		/// </summary>
+		void UpdateInstances(uint32_t first, const std::vector<Common::GpuInstance>& instances);
+
+		/// <summary>
+		/// Sets the pipeline GPU driven instances are drawn with
+		/// </summary>
+		/// <param name="pipelineKey">Key from <seealso cref="RequestPipeline"/> of a pipeline using <seealso cref="GetBindlessRootSignature"/></param>
+		void SetInstancePipeline(uint64_t pipelineKey);
+
+		/// <summary>
+		/// Sets the camera GPU driven instances and CPU side volumes are culled against. Drops the occluders of the previous frame
+		/// </summary>
+		/// <param name="viewProjection">Row-major, row-vector view projection matrix with a [0, 1] depth range</param>
+		void SetCullingViewProjection(const float viewProjection[16]);
+
+		/// <summary>
+		/// Culls bounding spheres against the frustum set by <seealso cref="SetCullingViewProjection"/>
+		/// </summary>
+		/// <param name="spheres">Spheres to test</param>
+		/// <param name="visible">Receives the indices of the visible spheres in ascending order</param>
+		void CullSpheres(const Common::BoundingSphereSoA& spheres, std::vector<uint32_t>& visible);
+
+		/// <summary>
+		/// Adds a low-poly occluder mesh for the camera set by <seealso cref="SetCullingViewProjection"/>
+		/// </summary>
+		/// <param name="positions">World space positions, three floats per vertex</param>
+		/// <param name="vertexCount">Number of vertices</param>
+		/// <param name="indices">Triangle list indices</param>
+		/// <param name="indexCount">Number of indices</param>
+		void AddOccluder(const float* positions, uint32_t vertexCount, const uint32_t* indices, uint32_t indexCount);
+
+		/// <summary>
+		/// Culls bounding boxes against the frustum set by <seealso cref="SetCullingViewProjection"/>, then removes those
+		/// hidden behind the occluders of the frame. Call before submitting the draws of the boxes
+		/// </summary>
+		/// <param name="boxes">Boxes to test</param>
+		/// <param name="visible">Receives the indices of the visible boxes in ascending order</param>
+		void CullBoxes(const Common::BoundingBoxSoA& boxes, std::vector<uint32_t>& visible);
+
+		/// <summary>
+		/// Fits the shadow cascades to the camera. Shadows are only drawn in frames that call this, once the shadow
+		/// map was created by <seealso cref="SetShadowSettings"/>. Call before submitting shadow casters
+		/// </summary>
+		/// <param name="camera">Camera of the frame, its far plane is the distance the shadows reach</param>
+		/// <param name="lightDirection">Direction the light travels in</param>
+		void UpdateShadowCascades(const Common::ShadowCamera& camera, const float lightDirection[3]);
+
+		uint32_t GetShadowCascadeCount() const;
+
+		/// <summary>
+		/// Gets a cascade. Its view projection belongs in the constants of the casters submitted for it, and its tile
+		/// tells shaders where to sample it in the shadow map
+		/// </summary>
+		const Common::ShadowCascade& GetShadowCascade(uint32_t cascade) const;
+
+		/// <summary>
+		/// Queues a depth-only draw into a cascade for the next <seealso cref="Render"/> call. Static casters are only
+		/// rendered when the cascade's cached depth is dirty and are dropped otherwise, so callers may skip them while
+		/// <seealso cref="Common::ShadowCascade::staticDirty"/> is false
+		/// </summary>
+		/// <param name="cascade">Cascade to draw into</param>
+		/// <param name="item">Draw whose pipeline writes depth only, in the shadow map's D32_FLOAT format</param>
+		/// <param name="isStatic">Whether the caster never moves, so its depth can be cached</param>
+		void SubmitShadowCaster(uint32_t cascade, const D3D12::DrawItem& item, bool isStatic);
+
+		/// <summary>
+		/// Renders the static casters of every cascade again, e.g. after static geometry was added or removed
+		/// </summary>
+		void InvalidateStaticShadows();
+
+		/// <summary>
+		/// Gets the bindless index of the shadow map, to be sampled as R32_FLOAT
+		/// </summary>
+		/// <exception cref="std::logic_error">Thrown if the shadow map was not created yet</exception>
+		uint32_t GetShadowAtlasIndex() const;
+
+		/// <summary>
+		/// Replaces the size of the cluster grid the lights are binned into. Lights already set are binned again
+		/// </summary>
+		/// <exception cref="std::invalid_argument">Thrown if the grid is empty or has more than Common::ClusteredLightBinner::maxClusterCount clusters</exception>
+		void SetClusterGrid(const Common::ClusterGridSettings& grid);
+
+		/// <summary>
+		/// Bins the point lights into the cluster grid and uploads the light buffer, the light range of every cluster
+		/// and the light index list with the next <seealso cref="Render"/> call. The lights stay set for later frames
+		/// until the next call. Shaders locate them through <seealso cref="GetClusterShaderConstants"/>
+		/// </summary>
+		/// <param name="view">Row-major, row-vector world to view matrix of the camera, looking down +z</param>
+		/// <param name="verticalFov">Vertical field of view in radians</param>
+		/// <param name="aspectRatio">Width over height</param>
+		/// <param name="nearZ">Near plane of the camera</param>
+		/// <param name="farZ">Far plane of the camera, lights beyond it are not binned</param>
+		/// <param name="lights">Lights with world space positions</param>
+		void SetClusterLights(const float view[16], float verticalFov, float aspectRatio, float nearZ, float farZ, const std::vector<Common::ClusterPointLight>& lights);
+
+		/// <summary>
+		/// Gets the constants shaders find the lights of their cluster with. The buffer indices only change when a light
+		/// list outgrows its buffer
+		/// </summary>
+		const Common::ClusterShaderConstants& GetClusterShaderConstants() const;
+
+		/// <summary>
+		/// Gets the light count, list size and duration of the last binning
+		/// </summary>
+		const Common::ClusteredLightBinner::Statistics& GetClusterLightStatistics() const;
+
+		/// <summary>
+		/// Replaces the post-processing effects and their parameters. While any effect is enabled the scene is drawn
+		/// into an HDR target, so draw pipelines have to be created for <seealso cref="GetSceneTargetFormat"/>
+		/// </summary>
+		/// <exception cref="std::logic_error">Thrown if the renderer was built without the runtime shader compiler</exception>
+		/// <exception cref="std::invalid_argument">Thrown if the config is invalid</exception>
+		void SetPostProcessConfig(const Common::PostProcessConfig& config);
+
+		/// <summary>
+		/// Gets the passes the last frame was post-processed with
+		/// </summary>
+		/// <exception cref="std::logic_error">Thrown if the renderer was built without the runtime shader compiler</exception>
+		const Common::PostProcessPlan& GetPostProcessPlan() const;
+
+		/// <summary>
+		/// Gets the render target format the scene is drawn in, the HDR scene color while post-processing is active
+		/// </summary>
+		DXGI_FORMAT GetSceneTargetFormat() const;
+
+		/// <summary>
+		/// Replaces the budget and the bounds of dynamic resolution. While enabled, every frame draws the scene into a
+		/// viewport scaled to keep the GPU frame time at the budget and the post-processing passes upscale it. The scene
+		/// targets are allocated once at the display size and never resized by the scale
+		/// </summary>
+		/// <exception cref="std::logic_error">Thrown if enabled on a renderer built without the runtime shader compiler</exception>
+		/// <exception cref="std::invalid_argument">Thrown if the config is invalid</exception>
+		void SetDynamicResolutionConfig(const Common::DynamicResolutionConfig& config);
+
+		const Common::DynamicResolutionConfig& GetDynamicResolutionConfig() const;
+
+		/// <summary>
+		/// Gets the viewport the next frame draws the scene into, below the display size while dynamic resolution
+		/// scales it down. Picked at the end of every <seealso cref="Render"/>
+		/// </summary>
+		const D3D12_VIEWPORT& GetRenderViewport() const;
+
+		/// <summary>
+		/// Requests a pipeline from the pipeline cache. It is compiled in the background unless it was already compiled
+		/// this run or is found in the persisted pipeline library
+		/// </summary>
+		/// <param name="desc">Pipeline description</param>
+		/// <param name="rootSignatureHash">Stable hash of the root signature, e.g. of its serialized blob</param>
+		/// <param name="fallback">Pipeline drawn with while this one compiles under <seealso cref="D3D12::PipelinePendingPolicy::UseFallback"/></param>
+		/// <returns>Key to set as <seealso cref="D3D12::DrawItem::pipelineKey"/></returns>
+		uint64_t RequestPipeline(const D3D12_GRAPHICS_PIPELINE_STATE_DESC& desc, uint64_t rootSignatureHash, ID3D12PipelineState* fallback = nullptr);
+
+		/// <summary>
+		/// Gets the bytecode of every requested shader, compiling the ones missing from the shader cache in parallel
+		/// </summary>
+		/// <param name="requests">Shaders to compile</param>
+		/// <returns>One result per request, in request order. The bytecode stays valid for the lifetime of the renderer</returns>
+		std::vector<Common::ShaderCompileResult> CompileShaders(const std::vector<Common::ShaderCompileRequest>& requests);
+
+		/// <summary>
+		/// Sets what happens to draws whose pipeline is still compiling
+		/// </summary>
+		void SetPipelinePendingPolicy(D3D12::PipelinePendingPolicy policy);
+
+		/// <summary>
+		/// Sets how many frames the CPU may record ahead of the GPU. Drains the GPU before applying the change
+		/// </summary>
+		/// <param name="framesInFlight">Number of frames in flight, clamped to [1, <seealso cref="Common::FrameRing::maxFramesInFlight"/>]</param>
+		void SetFramesInFlight(uint32_t framesInFlight);
+
 		/// <summary>
 		/// Method that calculates frame stats
 		/// </summary>
 		void RENDERER_INTERFACE_CALL CalculateFrameStats(FrameStats* fs) final;
 
+		/// <summary>
+		/// Calculates frame stats and gets the GPU time of every profiled pass
+		/// </summary>
+		/// <param name="fs">Receives the frame stats</param>
+		/// <param name="gpuProfile">Receives the scope timings of the most recent frame the GPU finished</param>
+		void CalculateFrameStats(FrameStats* fs, Common::GpuFrameProfile* gpuProfile);
+
+		/// <summary>
+		/// Gets percentiles, pacing and hitches of the most recent frames. Thread safe
+		/// </summary>
+		Common::FrameTimingSummary GetFrameTimingSummary() const;
+
+		/// <summary>
+		/// Gets the GPU scope timings of the most recent frame the GPU finished
+		/// </summary>
+		const Common::GpuFrameProfile& GetGpuFrameProfile() const;
+
 		/// <summary>
 		/// Method that gets info on available adapters and reports details
 		/// </summary>
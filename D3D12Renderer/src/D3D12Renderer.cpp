@@ -1,13 +1,20 @@
 #include <directx/d3dx12.h>
 
 #include <DirectXColors.h>
+#include <algorithm>
+#include <cstring>
+#include <stdexcept>
+#include <string>
+#include <utility>
 #if defined(DEBUG) or defined(_DEBUG)
 #include <dxgidebug.h>
 #endif
 
 #include <D3D12Renderer.h>
 #include <D3D12Utilities.h>
+#include <D3D12DxcCompiler.h>
 #include <D3DException.h>
+#include <StableHash.h>
 
 using namespace Microsoft::WRL;
 using namespace UltReality::Utilities;
@@ -85,6 +92,9 @@ namespace UltReality::Rendering
 
 		m_cbvSrvDescriptorSize = m_d3dDevice->GetDescriptorHandleIncrementSize(
 			D3D12_DESCRIPTOR_HEAP_TYPE_CBV_SRV_UAV);
+
+		m_samplerDescriptorSize = m_d3dDevice->GetDescriptorHandleIncrementSize(
+			D3D12_DESCRIPTOR_HEAP_TYPE_SAMPLER);
 	}
 
 	FORCE_INLINE bool D3D12Renderer::CheckMSAAQualitySupport(const uint32_t sampleCount)
@@ -130,10 +140,13 @@ namespace UltReality::Rendering
 
 	FORCE_INLINE void D3D12Renderer::RecreateMSAAResources()
 	{
-		FlushCommandQueue();
-
 		CreateRenderTargetView();
 		CreateDepthStencilBuffer();
+		if (m_sceneColor)
+			CreateSceneColorBuffer();
+
+		// The scene is only drawn below full scale while it is post-processed, which MSAA bypasses
+		SetViewport();
 	}
 
 	FORCE_INLINE void D3D12Renderer::CreateCommandObjects()
@@ -146,15 +159,37 @@ namespace UltReality::Rendering
 			IID_PPV_ARGS(&m_commandQueue)
 		));
 
-		ThrowIfFailed(m_d3dDevice->CreateCommandAllocator(
-			D3D12_COMMAND_LIST_TYPE_DIRECT,
-			IID_PPV_ARGS(m_directCmdListAlloc.GetAddressOf())
-		));
+		// One allocator per frame slot so a frame can be recorded while the GPU still executes the previous ones
+		for (uint32_t i = 0; i < Common::FrameRing::maxFramesInFlight; i++)
+		{
+			ThrowIfFailed(m_d3dDevice->CreateCommandAllocator(
+				D3D12_COMMAND_LIST_TYPE_DIRECT,
+				IID_PPV_ARGS(m_frameCmdListAllocs[i].GetAddressOf())
+			));
+		}
+
+		m_fenceTimeline = std::make_unique<D3D12FenceTimeline>(m_fence.Get(), m_commandQueue.Get());
+		m_frameRing = std::make_unique<Common::FrameRing>(m_fenceTimeline.get(), m_framesInFlight);
+
+		m_uploadRing = std::make_unique<D3D12UploadRing>(m_d3dDevice.Get(), s_uploadRingCapacity);
+
+		// Every job system worker records into its own allocators
+		m_directListPool = std::make_unique<D3D12CommandListPool>(
+			m_d3dDevice.Get(), D3D12_COMMAND_LIST_TYPE_DIRECT, m_jobSystem->GetWorkerCount(), Common::FrameRing::maxFramesInFlight);
+		m_computeListPool = std::make_unique<D3D12CommandListPool>(
+			m_d3dDevice.Get(), D3D12_COMMAND_LIST_TYPE_COMPUTE, m_jobSystem->GetWorkerCount(), Common::FrameRing::maxFramesInFlight);
+
+		// The direct queue joins the other queues at the end of every frame, so the frame fence covers their work too
+		m_queueSet = std::make_unique<D3D12QueueSet>(m_d3dDevice.Get(), m_commandQueue.Get(), m_fenceTimeline.get());
+
+		// Background uploads share the copy queue but signal a fence of their own
+		m_uploadQueue = std::make_unique<D3D12UploadQueue>(m_d3dDevice.Get(), m_queueSet->GetQueue(Common::QueueType::Copy), s_streamingStagingCapacity);
+		m_streamingUploader = std::make_unique<Common::StreamingUploader>(m_uploadQueue.get(), s_streamingBatchBytes, s_streamingBatchCopies);
 
 		ThrowIfFailed(m_d3dDevice->CreateCommandList(
 			0,
 			D3D12_COMMAND_LIST_TYPE_DIRECT,
-			m_directCmdListAlloc.Get(), // Associated command allocator
+			m_frameCmdListAllocs[0].Get(), // Associated command allocator
 			nullptr, // Initial PipelineStateObject
 			IID_PPV_ARGS(m_commandList.GetAddressOf())
 		));
@@ -165,6 +200,11 @@ namespace UltReality::Rendering
 		m_commandList->Close();
 	}
 
+	FORCE_INLINE ID3D12CommandAllocator* D3D12Renderer::CurrentFrameAllocator() const
+	{
+		return m_frameCmdListAllocs[m_frameRing->GetFrameIndex()].Get();
+	}
+
 	FORCE_INLINE void D3D12Renderer::CreateSwapChain()
 	{
 		// Release the previous swapchain we will be recreating
@@ -198,46 +238,458 @@ namespace UltReality::Rendering
 
 	FORCE_INLINE void D3D12Renderer::CreateDescriptorHeaps()
 	{
-		D3D12_DESCRIPTOR_HEAP_DESC rtvHeapDesc;
-		rtvHeapDesc.NumDescriptors = m_swapChainBufferCount;
-		rtvHeapDesc.Type = D3D12_DESCRIPTOR_HEAP_TYPE_RTV;
-		rtvHeapDesc.Flags = D3D12_DESCRIPTOR_HEAP_FLAG_NONE;
-		rtvHeapDesc.NodeMask = 0;
+		// CPU-only descriptors grow in pages as they are needed
+		m_rtvAllocator = std::make_unique<D3D12CPUDescriptorAllocator>(
+			m_d3dDevice.Get(), D3D12_DESCRIPTOR_HEAP_TYPE_RTV, m_rtvDescriptorSize);
+		m_dsvAllocator = std::make_unique<D3D12CPUDescriptorAllocator>(
+			m_d3dDevice.Get(), D3D12_DESCRIPTOR_HEAP_TYPE_DSV, m_dsvDescriptorSize);
+		m_cbvSrvUavAllocator = std::make_unique<D3D12CPUDescriptorAllocator>(
+			m_d3dDevice.Get(), D3D12_DESCRIPTOR_HEAP_TYPE_CBV_SRV_UAV, m_cbvSrvDescriptorSize);
+		m_samplerAllocator = std::make_unique<D3D12CPUDescriptorAllocator>(
+			m_d3dDevice.Get(), D3D12_DESCRIPTOR_HEAP_TYPE_SAMPLER, m_samplerDescriptorSize);
+
+		// Only one heap of each shader visible type can be bound at a time, so
+		// these are created once and carved into per-frame tables
+		D3D12_DESCRIPTOR_HEAP_DESC cbvSrvUavHeapDesc;
+		cbvSrvUavHeapDesc.NumDescriptors = s_shaderVisibleCbvSrvUavCount;
+		cbvSrvUavHeapDesc.Type = D3D12_DESCRIPTOR_HEAP_TYPE_CBV_SRV_UAV;
+		cbvSrvUavHeapDesc.Flags = D3D12_DESCRIPTOR_HEAP_FLAG_SHADER_VISIBLE;
+		cbvSrvUavHeapDesc.NodeMask = 0;
 
 		ThrowIfFailed(m_d3dDevice->CreateDescriptorHeap(
-			&rtvHeapDesc,
-			IID_PPV_ARGS(m_rtvHeap.GetAddressOf())
+			&cbvSrvUavHeapDesc,
+			IID_PPV_ARGS(m_shaderVisibleCbvSrvUavHeap.GetAddressOf())
 		));
 
-		D3D12_DESCRIPTOR_HEAP_DESC dsvHeapDesc;
-		dsvHeapDesc.NumDescriptors = 1;
-		dsvHeapDesc.Type = D3D12_DESCRIPTOR_HEAP_TYPE_DSV;
-		dsvHeapDesc.Flags = D3D12_DESCRIPTOR_HEAP_FLAG_NONE;
-		dsvHeapDesc.NodeMask = 0;
+		D3D12_DESCRIPTOR_HEAP_DESC samplerHeapDesc;
+		samplerHeapDesc.NumDescriptors = s_shaderVisibleSamplerCount;
+		samplerHeapDesc.Type = D3D12_DESCRIPTOR_HEAP_TYPE_SAMPLER;
+		samplerHeapDesc.Flags = D3D12_DESCRIPTOR_HEAP_FLAG_SHADER_VISIBLE;
+		samplerHeapDesc.NodeMask = 0;
 
 		ThrowIfFailed(m_d3dDevice->CreateDescriptorHeap(
-			&dsvHeapDesc,
-			IID_PPV_ARGS(m_dsvHeap.GetAddressOf())
+			&samplerHeapDesc,
+			IID_PPV_ARGS(m_shaderVisibleSamplerHeap.GetAddressOf())
 		));
+
+		m_bindlessTable = std::make_unique<D3D12BindlessTable>(
+			m_d3dDevice.Get(), m_shaderVisibleCbvSrvUavHeap.Get(), 0, s_bindlessDescriptorCount, m_cbvSrvDescriptorSize);
+		m_cbvSrvUavRing = std::make_unique<D3D12DescriptorRing>(
+			m_shaderVisibleCbvSrvUavHeap.Get(), s_bindlessDescriptorCount, s_cbvSrvUavRingCount, m_cbvSrvDescriptorSize);
+
+		if (D3D12BindlessTable::IsSupported(m_d3dDevice.Get()))
+		{
+			const CD3DX12_STATIC_SAMPLER_DESC linearWrap(0, D3D12_FILTER_MIN_MAG_MIP_LINEAR);
+			m_bindlessRootSignature = D3D12BindlessTable::CreateRootSignature(m_d3dDevice.Get(), &linearWrap, 1);
+		}
+		m_samplerRing = std::make_unique<D3D12DescriptorRing>(
+			m_shaderVisibleSamplerHeap.Get(), 0, s_shaderVisibleSamplerCount, m_samplerDescriptorSize);
+
+		// Fixed descriptors used by the renderer itself
+		m_backBufferRTVs = m_rtvAllocator->Allocate(m_swapChainBufferCount);
+		m_depthStencilDSV = m_dsvAllocator->Allocate();
+		m_shadowMapDSV = m_dsvAllocator->Allocate();
+		m_shadowStaticDSV = m_dsvAllocator->Allocate();
+		m_sceneColorRTV = m_rtvAllocator->Allocate();
+		m_samplerDescriptor = m_samplerAllocator->Allocate();
+	}
+
+	FORCE_INLINE void D3D12Renderer::BindSceneTargets(ID3D12GraphicsCommandList* cmdList)
+	{
+		// Bind the shader visible heaps that this frame's descriptor tables live in
+		ID3D12DescriptorHeap* descriptorHeaps[] = { m_shaderVisibleCbvSrvUavHeap.Get(), m_shaderVisibleSamplerHeap.Get() };
+		cmdList->SetDescriptorHeaps(_countof(descriptorHeaps), descriptorHeaps);
+
+		// Set the viewport and scissor rect. This needs to be reset
+		// whenever the command list is reset
+		cmdList->RSSetViewports(1, &m_screenViewport);
+		cmdList->RSSetScissorRects(1, &m_scissorRect);
+
+		// Specify the buffers we are going to render to
+		auto sceneTargetView = SceneTargetView();
+		auto depthStencilView = DepthStencilView();
+		cmdList->OMSetRenderTargets(1, &sceneTargetView, true, &depthStencilView);
+	}
+
+	FORCE_INLINE void D3D12Renderer::BuildFrameGraph()
+	{
+		using Common::ResourceState;
+
+		m_renderGraph->Reset();
+
+		// Imported resources start in their committed state. The back buffer goes back to the presentation engine,
+		// the depth buffer is left in depth write for the next frame
+		const auto backBuffer = m_renderGraph->Import("BackBuffer", CurrentBackBuffer(),
+			m_resourceStates.Get(D3D12ResourceStateTracker::Key(CurrentBackBuffer())), ResourceState::Present);
+		const auto depthStencil = m_renderGraph->Import("DepthStencil", m_depthStencilBuffer.Get(),
+			m_resourceStates.Get(D3D12ResourceStateTracker::Key(m_depthStencilBuffer.Get())), ResourceState::DepthWrite);
+
+		// While post-processing is active the scene is drawn into the HDR scene color, which the post-processing passes
+		// resolve into the back buffer. It is left in render target for the next frame
+		const bool postProcess = IsPostProcessingActive();
+		const auto sceneColor = postProcess
+			? m_renderGraph->Import("SceneColor", m_sceneColor.Get(),
+				m_resourceStates.Get(D3D12ResourceStateTracker::Key(m_sceneColor.Get())), ResourceState::RenderTarget)
+			: backBuffer;
+
+		// Shadow passes come first. The static atlas is only drawn into when a cascade's cache is dirty, and the shadow
+		// map only has to be refreshed from it when its contents change
+		Common::RenderGraphResource shadowMap = Common::invalidRenderGraphResource;
+		if (m_shadowCascadesUpdated)
+		{
+			shadowMap = m_renderGraph->Import("ShadowMap", m_shadowMap.Get(),
+				m_resourceStates.Get(D3D12ResourceStateTracker::Key(m_shadowMap.Get())), ResourceState::PixelShaderResource);
+			const auto staticAtlas = m_renderGraph->Import("ShadowStaticAtlas", m_shadowStaticAtlas.Get(),
+				m_resourceStates.Get(D3D12ResourceStateTracker::Key(m_shadowStaticAtlas.Get())), ResourceState::CopySource);
+
+			bool hasDynamicCasters = false;
+			for (const std::vector<DrawItem>& casters : m_shadowDynamicCasters)
+				hasDynamicCasters |= !casters.empty();
+
+			if (m_shadowStaticCascadeMask != 0 || hasDynamicCasters || m_shadowMapHasDynamicCasters)
+			{
+				if (m_shadowStaticCascadeMask != 0)
+				{
+					const uint32_t staticPass = m_renderGraph->AddPass("ShadowStatic", [this](ID3D12GraphicsCommandList* cmdList)
+					{
+						RecordShadowCasters(cmdList, m_shadowStaticDSV.Handle(), m_shadowStaticCasters, m_shadowStaticCascadeMask, true);
+					});
+					m_renderGraph->Write(staticPass, staticAtlas, ResourceState::DepthWrite);
+				}
+
+				// Depth formats cannot be copied in sub-rectangles, so the whole atlas is copied
+				const uint32_t copyPass = m_renderGraph->AddPass("ShadowCopy", [this](ID3D12GraphicsCommandList* cmdList)
+				{
+					cmdList->CopyResource(m_shadowMap.Get(), m_shadowStaticAtlas.Get());
+				});
+				m_renderGraph->Read(copyPass, staticAtlas, ResourceState::CopySource);
+				m_renderGraph->Write(copyPass, shadowMap, ResourceState::CopyDest);
+
+				if (hasDynamicCasters)
+				{
+					const uint32_t dynamicPass = m_renderGraph->AddPass("ShadowDynamic", [this](ID3D12GraphicsCommandList* cmdList)
+					{
+						RecordShadowCasters(cmdList, m_shadowMapDSV.Handle(), m_shadowDynamicCasters, (1u << m_shadowCascades->GetCascadeCount()) - 1, false);
+					});
+					m_renderGraph->Write(dynamicPass, shadowMap, ResourceState::DepthWrite);
+				}
+
+				m_shadowMapHasDynamicCasters = hasDynamicCasters;
+			}
+		}
+
+		// The scene pass is recorded across the preamble and the parallel draw lists, so it has no callback. Only the
+		// post-processing passes follow it in the compiled order
+		m_scenePass = m_renderGraph->AddPass("Scene");
+		m_renderGraph->Write(m_scenePass, sceneColor, ResourceState::RenderTarget);
+		m_renderGraph->Write(m_scenePass, depthStencil, ResourceState::DepthWrite);
+		if (shadowMap != Common::invalidRenderGraphResource)
+			m_renderGraph->Read(m_scenePass, shadowMap, ResourceState::PixelShaderResource);
+
+		if (postProcess)
+		{
+			m_postProcessor->AddPasses(*m_renderGraph, sceneColor, backBuffer, CurrentBackBufferView(), m_displaySettings.width,
+				m_displaySettings.height, static_cast<uint32_t>(m_scissorRect.right), static_cast<uint32_t>(m_scissorRect.bottom), m_frameDeltaSeconds);
+		}
+
+		m_renderGraph->Compile();
+	}
+
+	uint64_t D3D12Renderer::PipelineCompatibilityHash() const
+	{
+		Common::StableHasher hasher;
+
+		ComPtr<IDXGIFactory4> factory4;
+		ComPtr<IDXGIAdapter1> adapter;
+		if (SUCCEEDED(m_dxgiFactory.As(&factory4)) && SUCCEEDED(factory4->EnumAdapterByLuid(m_d3dDevice->GetAdapterLuid(), IID_PPV_ARGS(&adapter))))
+		{
+			DXGI_ADAPTER_DESC1 desc;
+			ThrowIfFailed(adapter->GetDesc1(&desc));
+			hasher.Add(desc.VendorId).Add(desc.DeviceId).Add(desc.SubSysId).Add(desc.Revision);
+
+			// User mode driver version, bumped by every driver update
+			LARGE_INTEGER driverVersion = {};
+			if (SUCCEEDED(adapter->CheckInterfaceSupport(__uuidof(IDXGIDevice), &driverVersion)))
+				hasher.Add<int64_t>(driverVersion.QuadPart);
+		}
+
+		return hasher.Finish();
+	}
+
+	void D3D12Renderer::UpdateTextureStreamingBudget()
+	{
+		uint64_t budget = m_textureBudgetOverride;
+		if (budget == 0)
+		{
+			budget = s_defaultTextureBudget;
+
+			DXGI_QUERY_VIDEO_MEMORY_INFO memoryInfo;
+			if (m_videoMemoryAdapter && SUCCEEDED(m_videoMemoryAdapter->QueryVideoMemoryInfo(0, DXGI_MEMORY_SEGMENT_GROUP_LOCAL, &memoryInfo)))
+			{
+				// Streamed textures are part of the current usage, only what everything else uses is unavailable to them
+				const uint64_t streamedBytes = m_textureStreamer->Manager().GetStatistics().committedBytes;
+				const uint64_t otherUsage = memoryInfo.CurrentUsage > streamedBytes ? memoryInfo.CurrentUsage - streamedBytes : 0;
+				budget = memoryInfo.Budget > otherUsage ? memoryInfo.Budget - otherUsage : 0;
+			}
+		}
+
+		m_textureStreamer->Manager().SetBudget(static_cast<uint64_t>(static_cast<double>(budget) * m_textureBudgetScale));
+	}
+
+	void D3D12Renderer::CreateGpuCuller()
+	{
+		// The culling shaders ship as source, so GPU driven drawing needs the runtime compiler
+		if (m_shaderCompiler == nullptr || m_bindlessRootSignature == nullptr)
+			return;
+
+		const char* entryPoints[] = { D3D12GpuCuller::cullEntryPoint, D3D12GpuCuller::compactEntryPoint };
+		std::vector<uint8_t> bytecode[_countof(entryPoints)];
+
+		for (size_t i = 0; i < _countof(entryPoints); i++)
+		{
+			Common::ShaderCompileRequest request;
+			request.sourcePath = "GpuCulling.hlsl";
+			request.entryPoint = entryPoints[i];
+			request.target = "cs_6_0";
+
+			std::string messages;
+			if (!m_shaderCompiler->Compile(request, D3D12GpuCuller::shaderSource, *m_shaderIncludeResolver, bytecode[i], messages))
+				throw std::runtime_error(messages);
+		}
+
+		m_gpuCuller = std::make_unique<D3D12GpuCuller>(m_d3dDevice.Get(),
+			D3D12_SHADER_BYTECODE{ bytecode[0].data(), bytecode[0].size() }, D3D12_SHADER_BYTECODE{ bytecode[1].data(), bytecode[1].size() },
+			m_uploadRing.get(), m_bindlessTable.get(), m_bindlessRootSignature.Get());
+	}
+
+	void D3D12Renderer::CreatePostProcessor()
+	{
+		// Like the culling shaders, the post-processing shaders ship as source
+		if (m_shaderCompiler == nullptr)
+			return;
+
+		m_postProcessor = std::make_unique<D3D12PostProcessor>(m_d3dDevice.Get(), m_shaderCompiler.get(), m_shaderIncludeResolver.get(),
+			m_uploadRing.get(), m_cbvSrvUavRing.get(), m_backBufferFormat);
+	}
+
+	bool D3D12Renderer::ResolveDrawPipelines(std::vector<DrawItem>& drawItems)
+	{
+		// Compacts in place so recording jobs only ever see draws with a pipeline
+		size_t kept = 0;
+		for (size_t i = 0; i < drawItems.size(); i++)
+		{
+			DrawItem& item = drawItems[i];
+			if (item.pipelineState == nullptr && item.pipelineKey != 0)
+				item.pipelineState = m_pipelineCache->Resolve(item.pipelineKey, m_pipelinePendingPolicy);
+
+			if (item.pipelineState == nullptr)
+				continue;
+
+			drawItems[kept++] = item;
+		}
+
+		const bool resolvedAll = kept == drawItems.size();
+		drawItems.resize(kept);
+
+		return resolvedAll;
+	}
+
+	void D3D12Renderer::BuildInstanceBatches()
+	{
+		if (m_instancedDraws.empty())
+			return;
+
+		m_instanceBatcher->Build(m_instancedSortKeys, m_instancedBatchKeys, m_instanceBatches, m_instanceOrder);
+
+		for (const Common::InstanceBatch& batch : m_instanceBatches)
+		{
+			const uint32_t representative = m_instanceOrder[batch.firstInstance];
+			const uint32_t stride = m_instancedDraws[representative].instanceBufferView.StrideInBytes;
+
+			// One copy per instance straight into the slice the GPU reads
+			const UploadAllocation allocation = m_uploadRing->Allocate(static_cast<uint64_t>(stride) * batch.instanceCount, 16);
+			for (uint32_t i = 0; i < batch.instanceCount; i++)
+			{
+				const uint32_t draw = m_instanceOrder[batch.firstInstance + i];
+				std::memcpy(allocation.cpuAddress + static_cast<size_t>(i) * stride, m_instanceData.data() + m_instanceDataOffsets[draw], stride);
+			}
+
+			DrawItem item = m_instancedDraws[representative];
+			item.instanceCount = batch.instanceCount;
+			item.startInstance = 0;
+			item.instanceBufferView.BufferLocation = allocation.gpuAddress;
+			item.instanceBufferView.SizeInBytes = stride * batch.instanceCount;
+			m_drawItems.push_back(item);
+		}
+
+		m_instancedDraws.clear();
+		m_instancedSortKeys.clear();
+		m_instancedBatchKeys.clear();
+		m_instanceData.clear();
+		m_instanceDataOffsets.clear();
+	}
+
+	void D3D12Renderer::SortDrawItems()
+	{
+		m_drawSortKeys.resize(m_drawItems.size());
+		for (size_t i = 0; i < m_drawItems.size(); i++)
+			m_drawSortKeys[i] = m_drawItems[i].sortKey;
+
+		m_drawKeySorter->Sort(m_drawSortKeys, m_drawOrder);
+
+		m_sortedDrawItems.resize(m_drawItems.size());
+		for (size_t i = 0; i < m_drawOrder.size(); i++)
+			m_sortedDrawItems[i] = m_drawItems[m_drawOrder[i]];
+
+		m_drawItems.swap(m_sortedDrawItems);
+	}
+
+	void D3D12Renderer::RecordDrawRange(ID3D12GraphicsCommandList* cmdList, const std::vector<DrawItem>& drawItems, uint32_t first, uint32_t last) const
+	{
+		ID3D12PipelineState* currentPipeline = nullptr;
+		ID3D12RootSignature* currentRootSignature = nullptr;
+
+		for (uint32_t i = first; i < last; i++)
+		{
+			const DrawItem& item = drawItems[i];
+
+			// Skip state changes that match what the list already has bound
+			if (item.rootSignature != currentRootSignature)
+			{
+				cmdList->SetGraphicsRootSignature(item.rootSignature);
+				currentRootSignature = item.rootSignature;
+
+				// The table never moves, so it is bound once per root signature change instead of per draw
+				if (currentRootSignature == m_bindlessRootSignature.Get())
+					cmdList->SetGraphicsRootDescriptorTable(D3D12BindlessTable::tableRootParameter, m_bindlessTable->GpuStart());
+			}
+
+			if (item.pipelineState != currentPipeline)
+			{
+				cmdList->SetPipelineState(item.pipelineState);
+				currentPipeline = item.pipelineState;
+			}
+
+			if (item.objectConstants != 0)
+				cmdList->SetGraphicsRootConstantBufferView(s_objectConstantsRootParameter, item.objectConstants);
+
+			if (item.resourceIndexCount != 0)
+				cmdList->SetGraphicsRoot32BitConstants(D3D12BindlessTable::resourceIndicesRootParameter, item.resourceIndexCount, item.resourceIndices, 0);
+
+			cmdList->IASetPrimitiveTopology(item.primitiveTopology);
+			cmdList->IASetVertexBuffers(0, 1, &item.vertexBufferView);
+			if (item.instanceBufferView.SizeInBytes != 0)
+				cmdList->IASetVertexBuffers(1, 1, &item.instanceBufferView);
+			cmdList->IASetIndexBuffer(&item.indexBufferView);
+			cmdList->DrawIndexedInstanced(item.indexCount, item.instanceCount, item.startIndex, item.baseVertex, item.startInstance);
+		}
+	}
+
+	void D3D12Renderer::PrepareShadowCasters()
+	{
+		m_shadowStaticCascadeMask = 0;
+		if (!m_shadowCascadesUpdated)
+			return;
+
+		for (uint32_t i = 0; i < m_shadowCascades->GetCascadeCount(); i++)
+		{
+			ResolveDrawPipelines(m_shadowDynamicCasters[i]);
+			if (!m_shadowCascades->GetCascade(i).staticDirty)
+				continue;
+
+			// A cascade missing casters is drawn anyway and rendered again next frame
+			m_shadowStaticCascadeMask |= 1u << i;
+			if (ResolveDrawPipelines(m_shadowStaticCasters[i]))
+				m_shadowCascades->MarkStaticRendered(i);
+		}
+	}
+
+	void D3D12Renderer::RecordShadowCasters(ID3D12GraphicsCommandList* cmdList, D3D12_CPU_DESCRIPTOR_HANDLE dsv, const std::vector<DrawItem>* casters, uint32_t cascadeMask, bool clear) const
+	{
+		ID3D12DescriptorHeap* descriptorHeaps[] = { m_shaderVisibleCbvSrvUavHeap.Get(), m_shaderVisibleSamplerHeap.Get() };
+		cmdList->SetDescriptorHeaps(_countof(descriptorHeaps), descriptorHeaps);
+		cmdList->OMSetRenderTargets(0, nullptr, false, &dsv);
+
+		for (uint32_t i = 0; i < m_shadowCascades->GetCascadeCount(); i++)
+		{
+			if ((cascadeMask & (1u << i)) == 0)
+				continue;
+
+			const Common::ShadowCascade& cascade = m_shadowCascades->GetCascade(i);
+			const D3D12_VIEWPORT viewport = { static_cast<float>(cascade.atlasX), static_cast<float>(cascade.atlasY),
+				static_cast<float>(cascade.atlasSize), static_cast<float>(cascade.atlasSize), 0.0f, 1.0f };
+			const D3D12_RECT tile = { static_cast<LONG>(cascade.atlasX), static_cast<LONG>(cascade.atlasY),
+				static_cast<LONG>(cascade.atlasX + cascade.atlasSize), static_cast<LONG>(cascade.atlasY + cascade.atlasSize) };
+			cmdList->RSSetViewports(1, &viewport);
+			cmdList->RSSetScissorRects(1, &tile);
+
+			if (clear)
+				cmdList->ClearDepthStencilView(dsv, D3D12_CLEAR_FLAG_DEPTH, 1.0f, 0, 1, &tile);
+
+			RecordDrawRange(cmdList, casters[i], 0, static_cast<uint32_t>(casters[i].size()));
+		}
+	}
+
+	FORCE_INLINE void D3D12Renderer::RetireFrameResources(uint64_t completedFenceValue)
+	{
+		m_uploadRing->Retire(completedFenceValue);
+		m_cbvSrvUavRing->Retire(completedFenceValue);
+		m_samplerRing->Retire(completedFenceValue);
+		m_renderGraph->Retire(completedFenceValue);
+		m_gpuProfiler->Retire(completedFenceValue);
+		m_textureStreamer->Retire(completedFenceValue);
+		m_bindlessTable->Retire(completedFenceValue);
+		if (m_gpuCuller)
+			m_gpuCuller->Retire(completedFenceValue);
+		const size_t pendingAllocations = m_retiredAllocations.GetPendingCount();
+		m_retiredAllocations.Retire(completedFenceValue, [this](D3D12PlacedAllocation& allocation)
+		{
+			m_heapManager->Release(allocation);
+		});
+
+		// Targets replaced by a settings change can leave whole heap pages empty, which are handed back here
+		if (m_retiredAllocations.GetPendingCount() != pendingAllocations)
+			m_heapManager->TrimEmptyPages();
+	}
+
+	FORCE_INLINE void D3D12Renderer::FinishFrameResources(uint64_t frameFenceValue)
+	{
+		m_uploadRing->FinishFrame(frameFenceValue);
+		m_cbvSrvUavRing->FinishFrame(frameFenceValue);
+		m_samplerRing->FinishFrame(frameFenceValue);
+		m_renderGraph->FinishFrame(frameFenceValue);
+		m_gpuProfiler->FinishFrame(frameFenceValue);
+		m_textureStreamer->FinishFrame(frameFenceValue);
+		m_bindlessTable->FinishFrame(frameFenceValue);
+		if (m_gpuCuller)
+			m_gpuCuller->FinishFrame(frameFenceValue);
+		m_retiredAllocations.FinishFrame(frameFenceValue);
+	}
+
+	FORCE_INLINE void D3D12Renderer::RetireTarget(ComPtr<ID3D12Resource>& resource, D3D12PlacedAllocation& allocation)
+	{
+		m_resourceStates.Unregister(D3D12ResourceStateTracker::Key(resource.Get()));
+		resource.Reset();
+		if (allocation.resource != nullptr)
+			m_retiredAllocations.Release(std::move(allocation));
+		allocation = D3D12PlacedAllocation();
 	}
 
 	FORCE_INLINE void D3D12Renderer::CreateRenderTargetView()
 	{
-		CD3DX12_CPU_DESCRIPTOR_HANDLE rtvHeapHandle(m_rtvHeap->GetCPUDescriptorHandleForHeapStart());
 		for (uint8_t i = 0; i < m_swapChainBufferCount; i++)
 		{
 			ThrowIfFailed(m_swapChain->GetBuffer(
 				i, 
 				IID_PPV_ARGS(&m_swapChainBuffer[i])
 			));
+			m_resourceStates.Register(D3D12ResourceStateTracker::Key(m_swapChainBuffer[i].Get()), Common::ResourceState::Present);
 
 			m_d3dDevice->CreateRenderTargetView(
 				m_swapChainBuffer[i].Get(),
 				nullptr,
-				rtvHeapHandle
+				m_backBufferRTVs.Handle(i)
 			);
-
-			rtvHeapHandle.Offset(1, m_rtvDescriptorSize);
 		}
 
 		/*if (m_msaaEnabled)
@@ -259,17 +711,16 @@ namespace UltReality::Rendering
 			clearValue.Color[2] = 0.0f;
 			clearValue.Color[3] = 1.0f;
 
-			CD3DX12_HEAP_PROPERTIES heapProps(D3D12_HEAP_TYPE_DEFAULT);
-			ThrowIfFailed(m_d3dDevice->CreateCommittedResource(
-				&heapProps,
-				D3D12_HEAP_FLAG_NONE,
-				&msaaRenderTargetDesc,
+			m_heapManager->Release(m_msaaRenderTargetAllocation);
+			m_msaaRenderTargetAllocation = m_heapManager->CreateResource(
+				D3D12_HEAP_TYPE_DEFAULT,
+				msaaRenderTargetDesc,
 				D3D12_RESOURCE_STATE_RENDER_TARGET,
-				&clearValue,
-				IID_PPV_ARGS(m_msaaRenderTarget.GetAddressOf())
-			));
+				&clearValue
+			);
+			m_msaaRenderTarget = m_msaaRenderTargetAllocation.resource;
 
-			m_d3dDevice->CreateRenderTargetView(m_msaaRenderTarget.Get(), nullptr, m_msaaRtvHeap->GetCPUDescriptorHandleForHeapStart());
+			m_d3dDevice->CreateRenderTargetView(m_msaaRenderTarget.Get(), nullptr, m_msaaRTV.Handle());
 		}*/
 	}
 
@@ -294,15 +745,18 @@ namespace UltReality::Rendering
 		optClear.DepthStencil.Depth = 1.0f;
 		optClear.DepthStencil.Stencil = 0;
 		
-		CD3DX12_HEAP_PROPERTIES heapProps(D3D12_HEAP_TYPE_DEFAULT);
-		ThrowIfFailed(m_d3dDevice->CreateCommittedResource(
-			&heapProps,
-			D3D12_HEAP_FLAG_NONE,
-			&depthStencilDesc,
-			D3D12_RESOURCE_STATE_COMMON,
-			&optClear,
-			IID_PPV_ARGS(m_depthStencilBuffer.GetAddressOf())
-		));
+		// Frames in flight keep the previous buffer until they retire, the new one is placed alongside it
+		RetireTarget(m_depthStencilBuffer, m_depthStencilAllocation);
+
+		// Created directly in the state the frame graph expects it in between frames, so no barrier is needed
+		m_depthStencilAllocation = m_heapManager->CreateResource(
+			D3D12_HEAP_TYPE_DEFAULT,
+			depthStencilDesc,
+			D3D12_RESOURCE_STATE_DEPTH_WRITE,
+			&optClear
+		);
+		m_depthStencilBuffer = m_depthStencilAllocation.resource;
+		m_resourceStates.Register(D3D12ResourceStateTracker::Key(m_depthStencilBuffer.Get()), Common::ResourceState::DepthWrite);
 
 		// Create descriptor to mip level 0 of entire resource using the format of the resource
 		m_d3dDevice->CreateDepthStencilView(
@@ -310,26 +764,59 @@ namespace UltReality::Rendering
 			nullptr,
 			DepthStencilView()
 		);
+	}
 
-		// Transition the resource from its initial state to state so it can be used as a depth buffer
-		auto barrier = CD3DX12_RESOURCE_BARRIER::Transition(
-			m_depthStencilBuffer.Get(),
-			D3D12_RESOURCE_STATE_COMMON,
-			D3D12_RESOURCE_STATE_DEPTH_WRITE
+	FORCE_INLINE void D3D12Renderer::CreateSceneColorBuffer()
+	{
+		const CD3DX12_RESOURCE_DESC sceneColorDesc = CD3DX12_RESOURCE_DESC::Tex2D(D3D12PostProcessor::colorFormat,
+			m_displaySettings.width, m_displaySettings.height, 1, 1, 1, 0, D3D12_RESOURCE_FLAG_ALLOW_RENDER_TARGET);
+
+		D3D12_CLEAR_VALUE optClear;
+		optClear.Format = D3D12PostProcessor::colorFormat;
+		std::memcpy(optClear.Color, Colors::LightSteelBlue.f, sizeof(optClear.Color));
+
+		RetireTarget(m_sceneColor, m_sceneColorAllocation);
+
+		// Created in the state the frame graph leaves it in between frames
+		m_sceneColorAllocation = m_heapManager->CreateResource(
+			D3D12_HEAP_TYPE_DEFAULT,
+			sceneColorDesc,
+			D3D12_RESOURCE_STATE_RENDER_TARGET,
+			&optClear
 		);
-		m_commandList->ResourceBarrier(1, &barrier);
+		m_sceneColor = m_sceneColorAllocation.resource;
+		m_resourceStates.Register(D3D12ResourceStateTracker::Key(m_sceneColor.Get()), Common::ResourceState::RenderTarget);
+
+		m_d3dDevice->CreateRenderTargetView(m_sceneColor.Get(), nullptr, m_sceneColorRTV.Handle());
 	}
 
 	FORCE_INLINE void D3D12Renderer::SetViewport()
 	{
+		const float scale = IsDynamicResolutionActive() ? m_dynamicResolution.GetScale() : 1.0f;
+		const uint32_t width = Common::DynamicResolutionController::ScaleSize(m_displaySettings.width, scale);
+		const uint32_t height = Common::DynamicResolutionController::ScaleSize(m_displaySettings.height, scale);
+
 		m_screenViewport.TopLeftX = 0;
 		m_screenViewport.TopLeftY = 0;
-		m_screenViewport.Width = static_cast<float>(m_displaySettings.width);
-		m_screenViewport.Height = static_cast<float>(m_displaySettings.height);
+		m_screenViewport.Width = static_cast<float>(width);
+		m_screenViewport.Height = static_cast<float>(height);
 		m_screenViewport.MinDepth = 0.0f;
 		m_screenViewport.MaxDepth = 1.0f;
 
-		m_scissorRect = { 0,0,m_displaySettings.width, m_displaySettings.height };
+		m_scissorRect = { 0, 0, static_cast<LONG>(width), static_cast<LONG>(height) };
+	}
+
+	FORCE_INLINE void D3D12Renderer::UpdateRenderScale()
+	{
+		// Every profiled frame is fed once, as soon as its timestamps were read back
+		const Common::GpuFrameProfile& profile = m_gpuProfiler->GetLatestProfile();
+		if (IsDynamicResolutionActive() && profile.frameNumber != 0 && profile.frameNumber != m_dynamicResolutionFrame)
+		{
+			m_dynamicResolutionFrame = profile.frameNumber;
+			m_dynamicResolution.Update(static_cast<float>(profile.frameMilliseconds));
+		}
+
+		SetViewport();
 	}
 
 	/*FORCE_INLINE void D3D12Renderer::SetScissorRectangles(D3D12_RECT* rect)
@@ -345,48 +832,50 @@ namespace UltReality::Rendering
 		samplerDesc.AddressV = D3D12_TEXTURE_ADDRESS_MODE_WRAP;
 		samplerDesc.AddressW = D3D12_TEXTURE_ADDRESS_MODE_WRAP;
 		samplerDesc.MinLOD = 0;
-		samplerDesc.MaxLOD = D3D12_FLOAT32_MAX;
+		samplerDesc.MaxLOD = m_textureSettings.mipmapping ? D3D12_FLOAT32_MAX : 0.0f;
 		samplerDesc.MipLODBias = 0.0f;
 		samplerDesc.MaxAnisotropy = m_textureSettings.filteringLevel;
 
-		CD3DX12_CPU_DESCRIPTOR_HANDLE samplerHandle(m_samplerHeap->GetCPUDescriptorHandleForHeapStart());
-		m_d3dDevice->CreateSampler(&samplerDesc, samplerHandle);
+		m_d3dDevice->CreateSampler(&samplerDesc, m_samplerDescriptor.Handle());
 	}
 
 	FORCE_INLINE void D3D12Renderer::UpdateTextureQuality()
 	{
-		// Adjust texture resolution scale based on quality setting
-		float resolutionScale;
+		// Quality trades texture memory and sharpness, a positive bias streams coarser mips than the footprint asks for
 		switch (m_textureSettings.quality)
 		{
 		case TextureSettings::TextureQuality::low:
-			resolutionScale = 0.5f; // Half resolution
+			m_textureBudgetScale = 0.5f;
+			m_textureMipBias = 1.0f;
 			break;
 
 		case TextureSettings::TextureQuality::medium:
-			resolutionScale = 0.75f; // Three-quarters resolution
+			m_textureBudgetScale = 0.75f;
+			m_textureMipBias = 0.5f;
 			break;
 
 		case TextureSettings::TextureQuality::high:
-			resolutionScale = 1.0f; // Full resolution
+			m_textureBudgetScale = 1.0f;
+			m_textureMipBias = 0.0f;
 			break;
 
 		case TextureSettings::TextureQuality::ultra:
-			resolutionScale = 1.5f; // Enhanced resolution (of supported)
+			m_textureBudgetScale = 1.0f;
+			m_textureMipBias = -0.5f; // Sharper than the footprint needs (if the budget allows)
 			break;
 		}
 
-		// Apply resolution scaling logic (e.g., recreate texture resources)
-		//RecreateTextures(resolutionScale);
+		if (m_textureStreamer)
+		{
+			m_textureStreamer->Manager().SetMipBias(m_textureMipBias);
+			UpdateTextureStreamingBudget();
+		}
 	}
 
 	FORCE_INLINE void D3D12Renderer::UpdateMipmapping()
 	{
-		// Recreate textures with or without mipmaps
-		/*for (auto& texture : m_loadedTextures)
-		{
-			texture->EnableMipmaps(m_textureSettings.mipmapping);
-		}*/
+		// The sampler clamps to mip 0 without mipmapping, streamed views still clamp to their resident mips
+		UpdateSamplerDescriptor();
 	}
 
 	FORCE_INLINE void D3D12Renderer::UpdateShadowQuality()
@@ -417,15 +906,27 @@ namespace UltReality::Rendering
 
 	FORCE_INLINE void D3D12Renderer::RecreateShadowMap()
 	{
-		// Release the old shadow map
-		m_shadowMap.Reset();
-
+		// Frames in flight keep sampling the old shadow map through its bindless slot until they retire, the new maps
+		// are placed alongside the old ones and get a slot of their own
+		if (m_shadowAtlasSrv.IsValid())
+			m_bindlessTable->Free(m_shadowAtlasSrv);
+		RetireTarget(m_shadowMap, m_shadowMapAllocation);
+		RetireTarget(m_shadowStaticAtlas, m_shadowStaticAtlasAllocation);
+
+		// The cascades share the map as a 2x2 atlas, so its size and memory stay what the settings ask for. Every
+		// cached cascade is rendered again
+		Common::ShadowCascadeSettings cascadeSettings = m_shadowCascades->GetSettings();
+		cascadeSettings.cascadeResolution = std::max(static_cast<uint32_t>(m_shadowSettings.mapResolution) / 2, 1u);
+		m_shadowCascades->SetSettings(cascadeSettings);
+
+		// Typeless, so the map can be both written as depth and sampled as a float texture
 		D3D12_RESOURCE_DESC shadowMapDesc = {};
 		shadowMapDesc.Dimension = D3D12_RESOURCE_DIMENSION_TEXTURE2D;
-		shadowMapDesc.Width = m_shadowSettings.mapResolution;
-		shadowMapDesc.Height = m_shadowSettings.mapResolution;
+		shadowMapDesc.Width = m_shadowCascades->GetAtlasWidth();
+		shadowMapDesc.Height = m_shadowCascades->GetAtlasHeight();
+		shadowMapDesc.DepthOrArraySize = 1;
 		shadowMapDesc.MipLevels = 1;
-		shadowMapDesc.Format = DXGI_FORMAT_D32_FLOAT;
+		shadowMapDesc.Format = DXGI_FORMAT_R32_TYPELESS;
 		shadowMapDesc.SampleDesc.Count = 1;
 		shadowMapDesc.Flags = D3D12_RESOURCE_FLAG_ALLOW_DEPTH_STENCIL;
 
@@ -433,23 +934,45 @@ namespace UltReality::Rendering
 		clearValue.Format = DXGI_FORMAT_D32_FLOAT;
 		clearValue.DepthStencil.Depth = 1.0f;
 		clearValue.DepthStencil.Stencil = 0;
-		CD3DX12_HEAP_PROPERTIES heapProps(D3D12_HEAP_TYPE_DEFAULT);
-		ThrowIfFailed(m_d3dDevice->CreateCommittedResource(
-			&heapProps,
-			D3D12_HEAP_FLAG_NONE,
-			&shadowMapDesc,
+
+		m_shadowMapAllocation = m_heapManager->CreateResource(
+			D3D12_HEAP_TYPE_DEFAULT,
+			shadowMapDesc,
 			D3D12_RESOURCE_STATE_DEPTH_WRITE,
-			&clearValue,
-			IID_PPV_ARGS(m_shadowMap.GetAddressOf())
-		));
+			&clearValue
+		);
+		m_shadowMap = m_shadowMapAllocation.resource;
+		m_resourceStates.Register(D3D12ResourceStateTracker::Key(m_shadowMap.Get()), Common::ResourceState::DepthWrite);
+
+		// The static atlas is never sampled
+		shadowMapDesc.Flags |= D3D12_RESOURCE_FLAG_DENY_SHADER_RESOURCE;
+		m_shadowStaticAtlasAllocation = m_heapManager->CreateResource(
+			D3D12_HEAP_TYPE_DEFAULT,
+			shadowMapDesc,
+			D3D12_RESOURCE_STATE_DEPTH_WRITE,
+			&clearValue
+		);
+		m_shadowStaticAtlas = m_shadowStaticAtlasAllocation.resource;
+		m_resourceStates.Register(D3D12ResourceStateTracker::Key(m_shadowStaticAtlas.Get()), Common::ResourceState::DepthWrite);
+		m_shadowMapHasDynamicCasters = false;
 
-		// Create a depth-stencil view for the shadow map
+		// Create depth-stencil views for both atlases
 		D3D12_DEPTH_STENCIL_VIEW_DESC dsvDesc = {};
 		dsvDesc.Format = DXGI_FORMAT_D32_FLOAT;
 		dsvDesc.ViewDimension = D3D12_DSV_DIMENSION_TEXTURE2D;
 		dsvDesc.Flags = D3D12_DSV_FLAG_NONE;
 
-		m_d3dDevice->CreateDepthStencilView(m_shadowMap.Get(), &dsvDesc, m_shadowMapHeap->GetCPUDescriptorHandleForHeapStart());
+		m_d3dDevice->CreateDepthStencilView(m_shadowMap.Get(), &dsvDesc, m_shadowMapDSV.Handle());
+		m_d3dDevice->CreateDepthStencilView(m_shadowStaticAtlas.Get(), &dsvDesc, m_shadowStaticDSV.Handle());
+
+		// Shaders sample the shadow map by bindless index
+		D3D12_SHADER_RESOURCE_VIEW_DESC srvDesc = {};
+		srvDesc.Format = DXGI_FORMAT_R32_FLOAT;
+		srvDesc.ViewDimension = D3D12_SRV_DIMENSION_TEXTURE2D;
+		srvDesc.Shader4ComponentMapping = D3D12_DEFAULT_SHADER_4_COMPONENT_MAPPING;
+		srvDesc.Texture2D.MipLevels = 1;
+
+		m_shadowAtlasSrv = m_bindlessTable->CreateSrv(m_shadowMap.Get(), &srvDesc);
 	}
 
 	FORCE_INLINE void D3D12Renderer::UpdateSoftShadowsState()
@@ -457,6 +980,94 @@ namespace UltReality::Rendering
 
 	}
 
+	FORCE_INLINE void D3D12Renderer::BinClusterLights()
+	{
+		m_lightBinner->SetProjection(m_clusterProjection[0], m_clusterProjection[1], m_clusterProjection[2], m_clusterProjection[3]);
+		m_lightBinner->Bin(m_clusterLightSpheres, m_clusterLightRanges, m_clusterLightIndices);
+	}
+
+	FORCE_INLINE void D3D12Renderer::StageClusterList(uint32_t list, const void* data, uint32_t count, uint32_t stride)
+	{
+		// Views cannot be empty, so every list gets a buffer even while it has no elements
+		if (count > m_clusterLightCapacities[list] || !m_clusterLightSrvs[list].IsValid())
+		{
+			// Frames in flight keep reading the old buffer through the old view until they retire
+			if (m_clusterLightBuffers[list].resource != nullptr)
+				m_retiredAllocations.Release(std::move(m_clusterLightBuffers[list]));
+			if (m_clusterLightSrvs[list].IsValid())
+				m_bindlessTable->Free(m_clusterLightSrvs[list]);
+
+			const uint32_t capacity = std::max({ count, m_clusterLightCapacities[list] * 2, s_minClusterListCapacity });
+			m_clusterLightBuffers[list] = m_heapManager->CreateResource(
+				D3D12_HEAP_TYPE_DEFAULT,
+				CD3DX12_RESOURCE_DESC::Buffer(static_cast<uint64_t>(capacity) * stride),
+				D3D12_RESOURCE_STATE_COMMON,
+				nullptr
+			);
+			m_clusterLightCapacities[list] = capacity;
+
+			D3D12_SHADER_RESOURCE_VIEW_DESC srvDesc = {};
+			srvDesc.Format = DXGI_FORMAT_UNKNOWN;
+			srvDesc.ViewDimension = D3D12_SRV_DIMENSION_BUFFER;
+			srvDesc.Shader4ComponentMapping = D3D12_DEFAULT_SHADER_4_COMPONENT_MAPPING;
+			srvDesc.Buffer.NumElements = capacity;
+			srvDesc.Buffer.StructureByteStride = stride;
+			m_clusterLightSrvs[list] = m_bindlessTable->CreateSrv(m_clusterLightBuffers[list].resource.Get(), &srvDesc);
+		}
+
+		// Replaces a list staged earlier that no frame copied yet
+		m_clusterLightUploads[list] = UploadAllocation();
+		if (count > 0)
+		{
+			m_clusterLightUploads[list] = m_uploadRing->Allocate(static_cast<uint64_t>(count) * stride, stride);
+			std::memcpy(m_clusterLightUploads[list].cpuAddress, data, static_cast<size_t>(count) * stride);
+		}
+	}
+
+	FORCE_INLINE void D3D12Renderer::StageClusterBins(uint32_t lightCount)
+	{
+		StageClusterList(1, m_clusterLightRanges.data(), static_cast<uint32_t>(m_clusterLightRanges.size()), sizeof(Common::ClusterLightRange));
+		StageClusterList(2, m_clusterLightIndices.data(), static_cast<uint32_t>(m_clusterLightIndices.size()), sizeof(uint32_t));
+
+		m_clusterConstants = m_lightBinner->GetShaderConstants(lightCount);
+		m_clusterConstants.lightBufferIndex = m_bindlessTable->GetShaderIndex(m_clusterLightSrvs[0]);
+		m_clusterConstants.clusterBufferIndex = m_bindlessTable->GetShaderIndex(m_clusterLightSrvs[1]);
+		m_clusterConstants.lightIndexBufferIndex = m_bindlessTable->GetShaderIndex(m_clusterLightSrvs[2]);
+	}
+
+	FORCE_INLINE void D3D12Renderer::RecordClusterLightCopies(ID3D12GraphicsCommandList* cmdList)
+	{
+		// Buffers decay to COMMON once an ExecuteCommandLists call completes, so every frame starts from COMMON.
+		// Frames without new lists read them through implicit promotion
+		std::vector<D3D12_RESOURCE_BARRIER> barriers;
+		for (uint32_t list = 0; list < 3; list++)
+		{
+			if (m_clusterLightUploads[list].size > 0)
+				barriers.push_back(CD3DX12_RESOURCE_BARRIER::Transition(m_clusterLightBuffers[list].resource.Get(), D3D12_RESOURCE_STATE_COMMON, D3D12_RESOURCE_STATE_COPY_DEST));
+		}
+
+		if (barriers.empty())
+			return;
+
+		cmdList->ResourceBarrier(static_cast<UINT>(barriers.size()), barriers.data());
+		barriers.clear();
+
+		for (uint32_t list = 0; list < 3; list++)
+		{
+			UploadAllocation& upload = m_clusterLightUploads[list];
+			if (upload.size == 0)
+				continue;
+
+			ID3D12Resource* buffer = m_clusterLightBuffers[list].resource.Get();
+			cmdList->CopyBufferRegion(buffer, 0, upload.resource, upload.offset, upload.size);
+			barriers.push_back(CD3DX12_RESOURCE_BARRIER::Transition(buffer, D3D12_RESOURCE_STATE_COPY_DEST,
+				D3D12_RESOURCE_STATE_NON_PIXEL_SHADER_RESOURCE | D3D12_RESOURCE_STATE_PIXEL_SHADER_RESOURCE));
+			upload = UploadAllocation();
+		}
+
+		cmdList->ResourceBarrier(static_cast<UINT>(barriers.size()), barriers.data());
+	}
+
 	FORCE_INLINE ID3D12Resource* D3D12Renderer::CurrentBackBuffer() const
 	{
 		return m_swapChainBuffer[m_currBackBuffer].Get();
@@ -464,16 +1075,28 @@ namespace UltReality::Rendering
 
 	FORCE_INLINE D3D12_CPU_DESCRIPTOR_HANDLE D3D12Renderer::CurrentBackBufferView() const
 	{
-		return CD3DX12_CPU_DESCRIPTOR_HANDLE(
-			m_rtvHeap->GetCPUDescriptorHandleForHeapStart(), // handle start 
-			m_currBackBuffer, // Index to offset 
-			m_rtvDescriptorSize // Size in bytes of the descriptor
-		);
+		return m_backBufferRTVs.Handle(m_currBackBuffer);
 	}
 
 	FORCE_INLINE D3D12_CPU_DESCRIPTOR_HANDLE D3D12Renderer::DepthStencilView() const
 	{
-		return m_dsvHeap->GetCPUDescriptorHandleForHeapStart();
+		return m_depthStencilDSV.Handle();
+	}
+
+	FORCE_INLINE bool D3D12Renderer::IsPostProcessingActive() const
+	{
+		return m_postProcessor && m_sceneColor && !m_msaaEnabled
+			&& (m_postProcessor->GetConfig().effects != Common::PostEffect::None || m_dynamicResolution.GetConfig().enabled);
+	}
+
+	FORCE_INLINE bool D3D12Renderer::IsDynamicResolutionActive() const
+	{
+		return m_dynamicResolution.GetConfig().enabled && IsPostProcessingActive();
+	}
+
+	FORCE_INLINE D3D12_CPU_DESCRIPTOR_HANDLE D3D12Renderer::SceneTargetView() const
+	{
+		return IsPostProcessingActive() ? m_sceneColorRTV.Handle() : CurrentBackBufferView();
 	}
 
 	void D3D12Renderer::Initialize(DisplayTarget targetWindow, const GameTimer* gameTimer)
@@ -503,6 +1126,24 @@ namespace UltReality::Rendering
 		CreateFence();
 		GetDescriptorSizes();
 
+		m_heapManager = std::make_unique<D3D12HeapManager>(m_d3dDevice.Get());
+		m_jobSystem = std::make_unique<Common::JobSystem>();
+		m_drawKeySorter = std::make_unique<Common::DrawKeySorter>(m_jobSystem.get());
+		m_instanceBatcher = std::make_unique<Common::InstanceBatcher>(m_jobSystem.get());
+		m_frustumCuller = std::make_unique<Common::FrustumCuller>(m_jobSystem.get());
+		m_occlusionCuller = std::make_unique<Common::OcclusionCuller>(m_jobSystem.get());
+		m_shadowCascades = std::make_unique<Common::ShadowCascadeSet>();
+		m_lightBinner = std::make_unique<Common::ClusteredLightBinner>(m_jobSystem.get());
+		m_renderGraph = std::make_unique<D3D12RenderGraph>(m_d3dDevice.Get());
+		m_pipelineCache = std::make_unique<D3D12PipelineCache>(m_d3dDevice.Get(), m_jobSystem.get(), s_pipelineCacheDirectory, PipelineCompatibilityHash());
+
+		// Maps every shader compiled by earlier runs
+		m_shaderIncludeResolver = std::make_unique<Common::FileShaderIncludeResolver>();
+#if defined(D3D12_RENDERER_DXC)
+		m_shaderCompiler = std::make_unique<D3D12DxcCompiler>();
+#endif
+		m_shaderCache = std::make_unique<Common::ShaderCache>(s_shaderCacheDirectory, m_shaderCompiler.get(), m_shaderIncludeResolver.get());
+
 		// Check MSAA
 		if (m_antiAliasingSettings.type == AntiAliasingSettings::AntiAliasingType::MSAA)
 		{
@@ -517,8 +1158,20 @@ namespace UltReality::Rendering
 #endif
 
 		CreateCommandObjects();
+		m_gpuProfiler = std::make_unique<D3D12GpuProfiler>(m_d3dDevice.Get(), m_commandQueue.Get());
 		CreateSwapChain();
 		CreateDescriptorHeaps();
+
+		// The adapter reports how much video memory the process may use, which bounds the streamed textures
+		ComPtr<IDXGIFactory4> factory4;
+		if (SUCCEEDED(m_dxgiFactory.As(&factory4)))
+			factory4->EnumAdapterByLuid(m_d3dDevice->GetAdapterLuid(), IID_PPV_ARGS(&m_videoMemoryAdapter));
+
+		m_textureStreamer = std::make_unique<D3D12TextureStreamer>(m_d3dDevice.Get(), m_queueSet->GetQueue(Common::QueueType::Copy),
+			m_streamingUploader.get(), m_cbvSrvUavAllocator.get(), s_defaultTextureBudget);
+		UpdateTextureQuality();
+		CreateGpuCuller();
+		CreatePostProcessor();
 		//CreateRenderTargetView();
 		//CreateDepthStencilBuffer();
 		//SetViewport();
@@ -526,49 +1179,493 @@ namespace UltReality::Rendering
 
 	void D3D12Renderer::Render()
 	{
+		// The exposure adapts over the time between frame starts. The first frame has no previous start, and a long
+		// stall such as a breakpoint or a window drag should not jump the adaptation to its end
+		const auto frameStartTime = std::chrono::steady_clock::now();
+		if (m_frameStartTime != std::chrono::steady_clock::time_point())
+			m_frameDeltaSeconds = std::min(std::chrono::duration<float>(frameStartTime - m_frameStartTime).count(), s_maxFrameDeltaSeconds);
+		m_frameStartTime = frameStartTime;
+
+		// Wait only if the GPU has not yet retired the frame that last used this slot
+		const uint32_t frameIndex = m_frameRing->BeginFrame();
+		m_fenceWaitMilliseconds = std::chrono::duration<float, std::milli>(std::chrono::steady_clock::now() - m_frameStartTime).count();
+
+		// Reclaim the upload slices and descriptor tables of every frame the GPU has finished with
+		RetireFrameResources(m_fenceTimeline->GetCompletedValue());
+		m_directListPool->BeginFrame(frameIndex);
+		m_computeListPool->BeginFrame(frameIndex);
+
+		// Stream texture mips towards this frame's budget before any descriptor of the frame is copied
+		UpdateTextureStreamingBudget();
+		m_textureStreamer->Update();
+
 		// Reuse the memory associated with the command recording
 		// We can only reset when the associated command list have finished
-		// execution on the gpu
-		ThrowIfFailed(m_directCmdListAlloc->Reset());
+		// execution on the gpu, which BeginFrame guarantees for this slot
+		ThrowIfFailed(CurrentFrameAllocator()->Reset());
 
 		// A command list can be reset after it has been added to the
 		// command queue via ExecuteCommandList. Reusing the command list
 		// reuses memory
-		ThrowIfFailed(m_commandList->Reset(m_directCmdListAlloc.Get(), nullptr));
+		ThrowIfFailed(m_commandList->Reset(CurrentFrameAllocator(), nullptr));
 
-		// Indicate a state transition on the resource usage
-		auto presentBarrier = CD3DX12_RESOURCE_BARRIER::Transition(
-			CurrentBackBuffer(),
-			D3D12_RESOURCE_STATE_PRESENT,
-			D3D12_RESOURCE_STATE_RENDER_TARGET);
-		m_commandList->ResourceBarrier(
-			1,
-			&presentBarrier);
+		m_gpuProfiler->BeginFrame();
+		const uint32_t frameScope = m_gpuProfiler->BeginScope(m_commandList.Get(), "Frame");
 
-		// Set the viewport and scissor rect. This needs to be reset
-		// whenever the command list is reset
-		m_commandList->RSSetViewports(1, &m_screenViewport);
-		m_commandList->RSSetScissorRects(1, &m_scissorRect);
+		// Lights set since the previous frame land in their buffers before anything reads them
+		RecordClusterLightCopies(m_commandList.Get());
 
-		// Clear the back buffer and depth buffer
-		m_commandList->ClearRenderTargetView(CurrentBackBufferView(), Colors::LightSteelBlue, 0, nullptr);
-		m_commandList->ClearDepthStencilView(DepthStencilView(), D3D12_CLEAR_FLAG_DEPTH | D3D12_CLEAR_FLAG_STENCIL, 1.0f, 0, 0, nullptr);
+		// Cull the GPU driven instances on the async compute queue, overlapping the shadow and scene draws. Only
+		// their draws on the closing list wait for it
+		const bool drawInstances = m_gpuCuller && m_gpuCuller->GetInstanceCount() > 0;
+		ID3D12GraphicsCommandList* cullList = nullptr;
+		if (drawInstances)
+		{
+			cullList = m_computeListPool->Acquire(m_jobSystem->CurrentWorkerIndex());
+			m_gpuCuller->RecordCulling(cullList, m_cullFrustumPlanes);
+			ThrowIfFailed(cullList->Close());
+		}
 
-		// Specify the buffers we are going to render to
-		auto backBufferView = CurrentBackBufferView();
-		auto depthStencilView = DepthStencilView();
-		m_commandList->OMSetRenderTargets(1, &backBufferView, true, &depthStencilView);
+		// Shadow casters need their pipelines before the shadow passes are declared
+		PrepareShadowCasters();
 
-		// Indicate a state transition on the resource usage
-		auto swapBarrier = CD3DX12_RESOURCE_BARRIER::Transition(CurrentBackBuffer(), D3D12_RESOURCE_STATE_RENDER_TARGET, D3D12_RESOURCE_STATE_PRESENT);
-		m_commandList->ResourceBarrier(1, &swapBarrier);
+		// Shadow passes and the barriers in front of the scene pass, derived by the frame graph
+		BuildFrameGraph();
+		const auto& compiledPasses = m_renderGraph->Graph().GetCompiled().passes;
+		const uint32_t compiledPassCount = static_cast<uint32_t>(compiledPasses.size());
+		const uint32_t scenePassIndex = static_cast<uint32_t>(std::find_if(compiledPasses.begin(), compiledPasses.end(),
+			[this](const auto& pass) { return pass.passIndex == m_scenePass; }) - compiledPasses.begin());
+		if (scenePassIndex > 0)
+		{
+			const uint32_t shadowScope = m_gpuProfiler->BeginScope(m_commandList.Get(), "Shadows", frameScope);
+			for (uint32_t pass = 0; pass < scenePassIndex; pass++)
+				m_renderGraph->ExecutePass(pass, m_commandList.Get());
+			m_gpuProfiler->EndScope(m_commandList.Get(), shadowScope);
+		}
+		m_renderGraph->RecordPassBarriers(scenePassIndex, m_commandList.Get());
 
-		// Done recording commands
+		// The scene scope spans every recording job and ends on the closing list
+		const uint32_t sceneScope = m_gpuProfiler->BeginScope(m_commandList.Get(), "Scene", frameScope);
+
+		BindSceneTargets(m_commandList.Get());
+
+		// Clear the part of the scene target and depth buffer the scene is drawn into
+		m_commandList->ClearRenderTargetView(SceneTargetView(), Colors::LightSteelBlue, 1, &m_scissorRect);
+		m_commandList->ClearDepthStencilView(DepthStencilView(), D3D12_CLEAR_FLAG_DEPTH | D3D12_CLEAR_FLAG_STENCIL, 1.0f, 0, 1, &m_scissorRect);
+
+		// Done recording the frame preamble
 		ThrowIfFailed(m_commandList->Close());
 
-		// Add command list to the queue for execution
-		ID3D12CommandList* cmdLists[] = { m_commandList.Get() };
-		m_commandQueue->ExecuteCommandLists(_countof(cmdLists), cmdLists);
+		for (uint32_t i = 0; i < Common::maxShadowCascades; i++)
+		{
+			m_shadowStaticCasters[i].clear();
+			m_shadowDynamicCasters[i].clear();
+		}
+
+		// Record the queued draws in parallel, one command list per chunk. Lists are
+		// slotted by chunk index so submission order does not depend on which worker
+		// finished first
+		BuildInstanceBatches();
+		ResolveDrawPipelines(m_drawItems);
+		SortDrawItems();
+		const uint32_t drawCount = static_cast<uint32_t>(m_drawItems.size());
+		const uint32_t chunkCount = (drawCount + s_drawsPerRecordingJob - 1) / s_drawsPerRecordingJob;
+
+		m_submitLists.assign(chunkCount + 2, nullptr);
+		m_submitLists.front() = m_commandList.Get();
+
+		if (chunkCount > 0)
+		{
+			Common::JobCounter recordCounter;
+			m_jobSystem->Dispatch(drawCount, s_drawsPerRecordingJob, [this, sceneScope](uint32_t first, uint32_t last, uint32_t workerIndex)
+			{
+				ID3D12GraphicsCommandList* chunkList = m_directListPool->Acquire(workerIndex);
+
+				// Recording jobs share the scope name, the profile merges them into one entry
+				const uint32_t drawScope = m_gpuProfiler->BeginScope(chunkList, "Draws", sceneScope);
+
+				// State does not carry over between command lists
+				BindSceneTargets(chunkList);
+				RecordDrawRange(chunkList, m_drawItems, first, last);
+
+				m_gpuProfiler->EndScope(chunkList, drawScope);
+
+				ThrowIfFailed(chunkList->Close());
+				m_submitLists[1 + first / s_drawsPerRecordingJob] = chunkList;
+			}, recordCounter);
+
+			m_jobSystem->Wait(recordCounter);
+		}
+
+		m_drawItems.clear();
+
+		// Return the imported resources to the state the next frame expects them in
+		ID3D12GraphicsCommandList* closingList = m_directListPool->Acquire(m_jobSystem->CurrentWorkerIndex());
+
+		ID3D12PipelineState* instancePipeline = drawInstances && m_instancePipelineKey != 0
+			? m_pipelineCache->Resolve(m_instancePipelineKey, m_pipelinePendingPolicy) : nullptr;
+		if (instancePipeline != nullptr)
+		{
+			const uint32_t instanceScope = m_gpuProfiler->BeginScope(closingList, "Instances", sceneScope);
+			BindSceneTargets(closingList);
+			m_gpuCuller->RecordDraws(closingList, instancePipeline);
+			m_gpuProfiler->EndScope(closingList, instanceScope);
+		}
+
+		m_gpuProfiler->EndScope(closingList, sceneScope);
+
+		// Post-processing resolves the scene color into the back buffer
+		if (scenePassIndex + 1 < compiledPassCount)
+		{
+			const uint32_t postProcessScope = m_gpuProfiler->BeginScope(closingList, "PostProcess", frameScope);
+			for (uint32_t pass = scenePassIndex + 1; pass < compiledPassCount; pass++)
+				m_renderGraph->ExecutePass(pass, closingList);
+			m_gpuProfiler->EndScope(closingList, postProcessScope);
+		}
+
+		m_renderGraph->RecordFinalBarriers(closingList);
+
+		m_gpuProfiler->EndScope(closingList, frameScope);
+		m_gpuProfiler->ResolveFrame(closingList);
+
+		// Done recording commands
+		ThrowIfFailed(closingList->Close());
+		m_submitLists.back() = closingList;
+
+		// Submit the whole frame in recording order with a single call, after the work queued on the other queues
+		const std::vector<uint32_t> pendingSubmissions = m_queueSet->GetPendingSubmissions();
+		if (cullList == nullptr)
+		{
+			m_queueSet->Submit(Common::QueueType::Graphics, m_submitLists, pendingSubmissions);
+		}
+		else
+		{
+			// The culling rewrites the buffers the previous frame's instance draws read, so it starts once the preamble
+			// completes, which the graphics queue runs after every earlier frame. The draw lists run alongside it and
+			// only the closing list with the instance draws waits for it
+			const uint32_t preambleSubmission = m_queueSet->Submit(Common::QueueType::Graphics, { m_submitLists.front() }, pendingSubmissions);
+			const uint32_t cullSubmission = m_queueSet->Submit(Common::QueueType::Compute, { cullList }, { preambleSubmission });
+
+			const std::vector<ID3D12CommandList*> drawLists(m_submitLists.begin() + 1, m_submitLists.end() - 1);
+			if (!drawLists.empty())
+				m_queueSet->Submit(Common::QueueType::Graphics, drawLists);
+			m_queueSet->Submit(Common::QueueType::Graphics, { m_submitLists.back() }, { cullSubmission });
+		}
+		m_queueSet->Flush();
+
+		// The final barriers left the imported resources in the states the next frame expects
+		m_resourceStates.Set(D3D12ResourceStateTracker::Key(CurrentBackBuffer()), Common::ResourceState::Present);
+		m_resourceStates.Set(D3D12ResourceStateTracker::Key(m_depthStencilBuffer.Get()), Common::ResourceState::DepthWrite);
+		if (m_sceneColor)
+			m_resourceStates.Set(D3D12ResourceStateTracker::Key(m_sceneColor.Get()), Common::ResourceState::RenderTarget);
+		if (m_shadowCascadesUpdated)
+		{
+			m_resourceStates.Set(D3D12ResourceStateTracker::Key(m_shadowMap.Get()), Common::ResourceState::PixelShaderResource);
+			m_resourceStates.Set(D3D12ResourceStateTracker::Key(m_shadowStaticAtlas.Get()), Common::ResourceState::CopySource);
+			m_shadowCascadesUpdated = false;
+		}
+
+		UpdateRenderScale();
+	}
+
+	void D3D12Renderer::SubmitDrawItem(const DrawItem& item)
+	{
+		m_drawItems.push_back(item);
+	}
+
+	void D3D12Renderer::SubmitInstancedDrawItem(const DrawItem& item, const void* instanceData, uint32_t instanceDataSize)
+	{
+		if (instanceData == nullptr || instanceDataSize == 0)
+			throw std::invalid_argument("Instanced draws need per-instance data");
+
+		// Identity of everything the instances must share. The key only lives for this frame, so object addresses may be hashed
+		Common::StableHasher hasher;
+		hasher.Add(reinterpret_cast<uintptr_t>(item.pipelineState)).Add(reinterpret_cast<uintptr_t>(item.rootSignature)).Add(item.pipelineKey);
+		hasher.Add(item.vertexBufferView.BufferLocation).Add(item.vertexBufferView.SizeInBytes).Add(item.vertexBufferView.StrideInBytes);
+		hasher.Add(item.indexBufferView.BufferLocation).Add(item.indexBufferView.SizeInBytes).Add(item.indexBufferView.Format);
+		hasher.Add(item.primitiveTopology).Add(item.indexCount).Add(item.startIndex).Add(item.baseVertex);
+		hasher.Add(item.objectConstants).Add(item.resourceIndexCount);
+		for (uint32_t i = 0; i < item.resourceIndexCount; i++)
+			hasher.Add(item.resourceIndices[i]);
+		hasher.Add(instanceDataSize);
+
+		m_instancedDraws.push_back(item);
+		m_instancedDraws.back().instanceBufferView = { 0, 0, instanceDataSize };
+		m_instancedSortKeys.push_back(item.sortKey);
+		m_instancedBatchKeys.push_back(hasher.Finish());
+		m_instanceDataOffsets.push_back(static_cast<uint32_t>(m_instanceData.size()));
+
+		const uint8_t* bytes = static_cast<const uint8_t*>(instanceData);
+		m_instanceData.insert(m_instanceData.end(), bytes, bytes + instanceDataSize);
+	}
+
+	const Common::InstanceBatcher::Statistics& D3D12Renderer::GetInstanceBatchStatistics() const
+	{
+		return m_instanceBatcher->GetStatistics();
+	}
+
+	const Common::DrawKeySorter::Statistics& D3D12Renderer::GetDrawSortStatistics() const
+	{
+		return m_drawKeySorter->GetStatistics();
+	}
+
+	uint32_t D3D12Renderer::SubmitCommandLists(Common::QueueType queue, const std::vector<ID3D12CommandList*>& lists, const std::vector<uint32_t>& dependencies)
+	{
+		return m_queueSet->Submit(queue, lists, dependencies);
+	}
+
+	Common::UploadTicket D3D12Renderer::UploadBuffer(ID3D12Resource* destination, uint64_t destinationOffset, std::vector<uint8_t> data)
+	{
+		return m_streamingUploader->EnqueueBuffer(destination, destinationOffset, std::move(data));
+	}
+
+	Common::UploadTicket D3D12Renderer::UploadTexture(ID3D12Resource* destination, uint32_t subresource, std::vector<uint8_t> data, uint64_t rowPitch)
+	{
+		return m_streamingUploader->Enqueue(m_uploadQueue->CreateTextureRequest(destination, subresource, std::move(data), rowPitch));
+	}
+
+	bool D3D12Renderer::IsUploadComplete(Common::UploadTicket ticket)
+	{
+		return m_streamingUploader->IsComplete(ticket);
+	}
+
+	uint32_t D3D12Renderer::CreateStreamedTexture(const D3D12_RESOURCE_DESC& desc, D3D12TextureStreamer::MipWriter writer)
+	{
+		return m_textureStreamer->CreateTexture(desc, std::move(writer));
+	}
+
+	void D3D12Renderer::DestroyStreamedTexture(uint32_t texture)
+	{
+		m_textureStreamer->DestroyTexture(texture);
+	}
+
+	void D3D12Renderer::ReportTextureFootprint(uint32_t texture, float screenPixels)
+	{
+		m_textureStreamer->ReportFootprint(texture, screenPixels);
+	}
+
+	void D3D12Renderer::SetTextureStreamingBudget(uint64_t budgetBytes)
+	{
+		m_textureBudgetOverride = budgetBytes;
+
+		if (m_textureStreamer)
+			UpdateTextureStreamingBudget();
+	}
+
+	const Common::TextureStreamingManager::Statistics& D3D12Renderer::GetTextureStreamingStatistics() const
+	{
+		return m_textureStreamer->Manager().GetStatistics();
+	}
+
+	Common::BindlessHandle D3D12Renderer::CreateBindlessSrv(ID3D12Resource* resource, const D3D12_SHADER_RESOURCE_VIEW_DESC* desc)
+	{
+		return m_bindlessTable->CreateSrv(resource, desc);
+	}
+
+	Common::BindlessHandle D3D12Renderer::CreateBindlessUav(ID3D12Resource* resource, const D3D12_UNORDERED_ACCESS_VIEW_DESC* desc, ID3D12Resource* counter)
+	{
+		return m_bindlessTable->CreateUav(resource, desc, counter);
+	}
+
+	void D3D12Renderer::FreeBindless(Common::BindlessHandle handle)
+	{
+		m_bindlessTable->Free(handle);
+	}
+
+	uint32_t D3D12Renderer::GetBindlessIndex(Common::BindlessHandle handle) const
+	{
+		return m_bindlessTable->GetShaderIndex(handle);
+	}
+
+	ID3D12RootSignature* D3D12Renderer::GetBindlessRootSignature() const
+	{
+		return m_bindlessRootSignature.Get();
+	}
+
+	bool D3D12Renderer::IsGpuDrivenDrawingSupported() const
+	{
+		return m_gpuCuller != nullptr;
+	}
+
+	void D3D12Renderer::SetInstanceMeshes(const std::vector<Common::GpuMesh>& meshes, const D3D12_VERTEX_BUFFER_VIEW& vertexBuffer, const D3D12_INDEX_BUFFER_VIEW& indexBuffer)
+	{
+		m_gpuCuller->SetMeshes(meshes, vertexBuffer, indexBuffer);
+	}
+
+	void D3D12Renderer::SetInstanceCount(uint32_t count)
+	{
+		m_gpuCuller->SetInstanceCount(count);
+	}
+
+	void D3D12Renderer::UpdateInstances(uint32_t first, const std::vector<Common::GpuInstance>& instances)
+	{
+		m_gpuCuller->UpdateInstances(first, instances.data(), static_cast<uint32_t>(instances.size()));
+	}
+
+	void D3D12Renderer::SetInstancePipeline(uint64_t pipelineKey)
+	{
+		m_instancePipelineKey = pipelineKey;
+	}
+
+	void D3D12Renderer::SetCullingViewProjection(const float viewProjection[16])
+	{
+		Common::ExtractFrustumPlanes(viewProjection, m_cullFrustumPlanes);
+		m_occlusionCuller->BeginFrame(viewProjection);
+	}
+
+	void D3D12Renderer::AddOccluder(const float* positions, uint32_t vertexCount, const uint32_t* indices, uint32_t indexCount)
+	{
+		m_occlusionCuller->AddOccluder(positions, vertexCount, indices, indexCount);
+	}
+
+	void D3D12Renderer::CullSpheres(const Common::BoundingSphereSoA& spheres, std::vector<uint32_t>& visible)
+	{
+		m_frustumCuller->CullSpheres(m_cullFrustumPlanes, spheres, visible);
+	}
+
+	void D3D12Renderer::CullBoxes(const Common::BoundingBoxSoA& boxes, std::vector<uint32_t>& visible)
+	{
+		m_frustumCuller->CullBoxes(m_cullFrustumPlanes, boxes, visible);
+
+		// Occluders are rasterized by the first test after they changed
+		m_occlusionCuller->CullBoxes(boxes, visible);
+	}
+
+	void D3D12Renderer::UpdateShadowCascades(const Common::ShadowCamera& camera, const float lightDirection[3])
+	{
+		m_shadowCascades->Update(camera, lightDirection);
+		m_shadowCascadesUpdated = m_shadowMap != nullptr;
+	}
+
+	uint32_t D3D12Renderer::GetShadowCascadeCount() const
+	{
+		return m_shadowCascades->GetCascadeCount();
+	}
+
+	const Common::ShadowCascade& D3D12Renderer::GetShadowCascade(uint32_t cascade) const
+	{
+		return m_shadowCascades->GetCascade(cascade);
+	}
+
+	void D3D12Renderer::SubmitShadowCaster(uint32_t cascade, const DrawItem& item, bool isStatic)
+	{
+		const Common::ShadowCascade& shadowCascade = m_shadowCascades->GetCascade(cascade);
+		if (!isStatic)
+			m_shadowDynamicCasters[cascade].push_back(item);
+		else if (shadowCascade.staticDirty)
+			m_shadowStaticCasters[cascade].push_back(item);
+	}
+
+	void D3D12Renderer::InvalidateStaticShadows()
+	{
+		m_shadowCascades->InvalidateStatic();
+	}
+
+	uint32_t D3D12Renderer::GetShadowAtlasIndex() const
+	{
+		if (!m_shadowAtlasSrv.IsValid())
+			throw std::logic_error("Shadow map was not created yet");
+
+		return m_bindlessTable->GetShaderIndex(m_shadowAtlasSrv);
+	}
+
+	void D3D12Renderer::SetClusterGrid(const Common::ClusterGridSettings& grid)
+	{
+		m_lightBinner->SetGrid(grid);
+
+		// The lists of lights already set no longer match the grid, the lights themselves stay as they are
+		if (m_clusterLightSrvs[0].IsValid())
+		{
+			BinClusterLights();
+			StageClusterBins(m_clusterConstants.lightCount);
+		}
+	}
+
+	void D3D12Renderer::SetClusterLights(const float view[16], float verticalFov, float aspectRatio, float nearZ, float farZ, const std::vector<Common::ClusterPointLight>& lights)
+	{
+		m_clusterLightSpheres.Clear();
+		for (const Common::ClusterPointLight& light : lights)
+		{
+			const float* p = light.position;
+			const float center[3] = {
+				p[0] * view[0] + p[1] * view[4] + p[2] * view[8] + view[12],
+				p[0] * view[1] + p[1] * view[5] + p[2] * view[9] + view[13],
+				p[0] * view[2] + p[1] * view[6] + p[2] * view[10] + view[14]
+			};
+			m_clusterLightSpheres.Add(center, light.range);
+		}
+
+		m_clusterProjection[0] = verticalFov;
+		m_clusterProjection[1] = aspectRatio;
+		m_clusterProjection[2] = nearZ;
+		m_clusterProjection[3] = farZ;
+		BinClusterLights();
+
+		const uint32_t lightCount = static_cast<uint32_t>(lights.size());
+		StageClusterList(0, lights.data(), lightCount, sizeof(Common::ClusterPointLight));
+		StageClusterBins(lightCount);
+	}
+
+	const Common::ClusterShaderConstants& D3D12Renderer::GetClusterShaderConstants() const
+	{
+		return m_clusterConstants;
+	}
+
+	const Common::ClusteredLightBinner::Statistics& D3D12Renderer::GetClusterLightStatistics() const
+	{
+		return m_lightBinner->GetStatistics();
+	}
+
+	void D3D12Renderer::SetPostProcessConfig(const Common::PostProcessConfig& config)
+	{
+		if (m_postProcessor == nullptr)
+			throw std::logic_error("Post-processing needs the runtime shader compiler");
+
+		m_postProcessor->SetConfig(config);
+
+		// Created once on first use and afterwards only with the other display sized targets, so a frame in flight
+		// never loses the target it draws into
+		if (config.effects != Common::PostEffect::None && m_sceneColor == nullptr)
+			CreateSceneColorBuffer();
+
+		SetViewport();
+	}
+
+	const Common::PostProcessPlan& D3D12Renderer::GetPostProcessPlan() const
+	{
+		if (m_postProcessor == nullptr)
+			throw std::logic_error("Post-processing needs the runtime shader compiler");
+
+		return m_postProcessor->GetPlan();
+	}
+
+	DXGI_FORMAT D3D12Renderer::GetSceneTargetFormat() const
+	{
+		return IsPostProcessingActive() ? D3D12PostProcessor::colorFormat : m_backBufferFormat;
+	}
+
+	void D3D12Renderer::SetDynamicResolutionConfig(const Common::DynamicResolutionConfig& config)
+	{
+		// The scaled scene is upscaled by the post-processing passes
+		if (config.enabled && m_postProcessor == nullptr)
+			throw std::logic_error("Dynamic resolution needs the runtime shader compiler");
+
+		m_dynamicResolution.SetConfig(config);
+
+		if (config.enabled && m_sceneColor == nullptr)
+			CreateSceneColorBuffer();
+
+		SetViewport();
+	}
+
+	const Common::DynamicResolutionConfig& D3D12Renderer::GetDynamicResolutionConfig() const
+	{
+		return m_dynamicResolution.GetConfig();
+	}
+
+	const D3D12_VIEWPORT& D3D12Renderer::GetRenderViewport() const
+	{
+		return m_screenViewport;
 	}
 
 	void D3D12Renderer::Present()
@@ -577,57 +1674,94 @@ namespace UltReality::Rendering
 		ThrowIfFailed(m_swapChain->Present(0, 0));
 		m_currBackBuffer = (m_currBackBuffer + 1) % m_swapChainBufferCount;
 
-		// Wait until frame commands are complete. This waiting is
-		// inefficient and is done for simplicity. Later we wil show how to
-		// organize our rendering code so we don't have to wait per frame
-		FlushCommandQueue();
+		// Mark the end of the frame on the GPU timeline and move on to the next
+		// frame slot. The CPU only waits once it wraps back onto a slot the GPU
+		// is still working on
+		const uint64_t frameFence = m_frameRing->EndFrame();
+
+		// Everything allocated this frame can be reclaimed once the frame fence is reached
+		FinishFrameResources(frameFence);
+
+		const auto presentTime = std::chrono::steady_clock::now();
+
+		Common::FrameTimingSample sample;
+		sample.fenceWaitMilliseconds = m_fenceWaitMilliseconds;
+		sample.cpuFrameMilliseconds = std::chrono::duration<float, std::milli>(presentTime - m_frameStartTime).count() - m_fenceWaitMilliseconds;
+		if (m_lastPresentTime != std::chrono::steady_clock::time_point())
+			sample.presentIntervalMilliseconds = std::chrono::duration<float, std::milli>(presentTime - m_lastPresentTime).count();
+
+		m_frameTiming.Record(sample);
+		m_lastPresentTime = presentTime;
 	}
 
 	void D3D12Renderer::FlushCommandQueue()
 	{
-		// Advance the fence value to mark commands up to this fence point.
-		m_currentFence++;
+		// Nothing can have been submitted before the command objects exist
+		if (!m_frameRing)
+			return;
+
+		// Signal a new fence point and wait until the GPU has completed all commands up to it
+		m_frameRing->WaitForIdle();
+		// Work on the other queues that no frame joined yet
+		m_queueSet->WaitForIdle();
+		m_streamingUploader->WaitForIdle();
+	}
 
-		// Add an instruction to the command queue to set a new fence point.  Because we 
-		// are on the GPU timeline, the new fence point won't be set until the GPU finishes
-		// processing all the commands prior to this Signal().
-		ThrowIfFailed(m_commandQueue->Signal(m_fence.Get(), m_currentFence));
+	uint64_t D3D12Renderer::RequestPipeline(const D3D12_GRAPHICS_PIPELINE_STATE_DESC& desc, uint64_t rootSignatureHash, ID3D12PipelineState* fallback)
+	{
+		return m_pipelineCache->RequestGraphics(desc, rootSignatureHash, fallback);
+	}
 
-		// Wait until the GPU has completed commands up to this fence point.
-		if (m_fence->GetCompletedValue() < m_currentFence)
-		{
-			HANDLE eventHandle = CreateEvent(nullptr, false, false, nullptr);
+	std::vector<Common::ShaderCompileResult> D3D12Renderer::CompileShaders(const std::vector<Common::ShaderCompileRequest>& requests)
+	{
+		return m_shaderCache->Compile(requests, *m_jobSystem);
+	}
 
-			// Fire event when GPU hits current fence.  
-			ThrowIfFailed(m_fence->SetEventOnCompletion(m_currentFence, eventHandle));
+	void D3D12Renderer::SetPipelinePendingPolicy(PipelinePendingPolicy policy)
+	{
+		m_pipelinePendingPolicy = policy;
+	}
 
-			// Wait until the GPU hits current fence event is fired.
-			WaitForSingleObject(eventHandle, INFINITE);
-			CloseHandle(eventHandle);
-		}
+	void D3D12Renderer::SetFramesInFlight(uint32_t framesInFlight)
+	{
+		framesInFlight = std::clamp<uint32_t>(framesInFlight, 1, Common::FrameRing::maxFramesInFlight);
+		if (framesInFlight == m_framesInFlight)
+			return;
+
+		m_framesInFlight = framesInFlight;
+
+		// Resize drains the GPU so every frame slot and allocator is free to reuse
+		if (m_frameRing)
+			m_frameRing->Resize(m_framesInFlight);
 	}
 
 	void D3D12Renderer::CalculateFrameStats(FrameStats* fs)
 	{
-		// Code computes the average frames per second, and also the 
-		// average time it takes to render one frame.  These stats 
-		// are appended to the window caption bar.
+		// Averages over the frames held by the timing ring, see GetFrameTimingSummary for the distribution
+		const Common::FrameTimingSummary summary = m_frameTiming.GetSummary();
+		if (summary.presentInterval.mean <= 0.0)
+			return;
 
-		static int frameCnt = 0;
-		static float timeElapsed = 0.0f;
+		fs->fps = static_cast<float>(summary.framesPerSecond);
+		fs->mspf = static_cast<float>(summary.presentInterval.mean);
+	}
 
-		frameCnt++;
+	void D3D12Renderer::CalculateFrameStats(FrameStats* fs, Common::GpuFrameProfile* gpuProfile)
+	{
+		CalculateFrameStats(fs);
 
-		// Compute averages over one second period.
-		if ((m_gameTimer->GetTotalTime() - timeElapsed) >= 1.0f)
-		{
-			fs->fps = (float)frameCnt; // fps = frameCnt / 1
-			fs->mspf = 1000.0f / fs->fps;
+		if (gpuProfile != nullptr)
+			*gpuProfile = m_gpuProfiler->GetLatestProfile();
+	}
 
-			// Reset for next average.
-			frameCnt = 0;
-			timeElapsed += 1.0f;
-		}
+	Common::FrameTimingSummary D3D12Renderer::GetFrameTimingSummary() const
+	{
+		return m_frameTiming.GetSummary();
+	}
+
+	const Common::GpuFrameProfile& D3D12Renderer::GetGpuFrameProfile() const
+	{
+		return m_gpuProfiler->GetLatestProfile();
 	}
 
 	void D3D12Renderer::LogAdapters()
@@ -706,7 +1840,8 @@ namespace UltReality::Rendering
 
 	void RENDERER_INTERFACE_CALL D3D12Renderer::SetDisplaySettings(const DisplaySettings& settings)
 	{
-		if (settings.width != m_displaySettings.width || settings.height != m_displaySettings.height)
+		const bool resized = settings.width != m_displaySettings.width || settings.height != m_displaySettings.height;
+		if (resized)
 		{
 			// Update cached dimensions
 			m_displaySettings.width = settings.width;
@@ -728,15 +1863,25 @@ namespace UltReality::Rendering
 			m_displaySettings.vSync = settings.vSync;
 		}
 
-		FlushCommandQueue();
+		// Only a new size needs new buffers
+		if (!resized)
+			return;
 
-		ThrowIfFailed(m_commandList->Reset(m_directCmdListAlloc.Get(), nullptr));
+		// Recreate the depth-stencil buffer and the scene color. Both are placed alongside the old ones, which retire
+		// with the frames still using them. They are created in their steady state, so no commands need to be executed
+		CreateDepthStencilBuffer();
+		if (m_sceneColor)
+			CreateSceneColorBuffer();
+
+		// The swap chain buffers can only be resized once the GPU no longer references them. Only frames on the
+		// graphics queue do, so the copy and compute queues keep running
+		m_frameRing->WaitForIdle();
 
 		for (uint8_t i = 0; i < m_swapChainBufferCount; i++)
 		{
+			m_resourceStates.Unregister(D3D12ResourceStateTracker::Key(m_swapChainBuffer[i].Get()));
 			m_swapChainBuffer[i].Reset();
 		}
-		m_depthStencilBuffer.Reset();
 
 		m_swapChain->ResizeBuffers(
 			m_swapChainBufferCount,
@@ -774,17 +1919,6 @@ namespace UltReality::Rendering
 		// Recreate render target views for the new swap chain buffers
 		CreateRenderTargetView();
 
-		// Recreate the depth-stencil buffer
-		CreateDepthStencilBuffer();
-
-		// Execute the resize commands
-		ThrowIfFailed(m_commandList->Close());
-		ID3D12CommandList* cmdLists[] = { m_commandList.Get() };
-		m_commandQueue->ExecuteCommandLists(_countof(cmdLists), cmdLists);
-
-		// Wait until Resize is complete
-		FlushCommandQueue();
-
 		// Update the viewport and scissor rect
 		SetViewport();
 	}
@@ -877,7 +2011,7 @@ namespace UltReality::Rendering
 	/// <param name="settings">Instance of <seealso cref="UltReality.Rendering.LightingSettings"/> struct to get settings from</param>
 	void RENDERER_INTERFACE_CALL D3D12Renderer::SetLightingSettings(const LightingSettings& settings)
 	{
-
+		// The cluster grid lights are binned into is set through SetClusterGrid
 	}
 
 	/// <summary>
@@ -886,7 +2020,7 @@ namespace UltReality::Rendering
 	/// <param name="settings">Instance of <seealso cref="UltReality.Rendering.PostProcessingSettings"/> struct to get settings from</param>
 	void RENDERER_INTERFACE_CALL D3D12Renderer::SetPostProcessingSettings(const PostProcessingSettings& settings)
 	{
-
+		// The post-processing effects and their parameters are set through SetPostProcessConfig
 	}
 
 	/// <summary>
@@ -895,6 +2029,6 @@ namespace UltReality::Rendering
 	/// <param name="settings">Instance of <seealso cref="UltReality.Rendering.PerformanceSettings"/> struct to get settings from</param>
 	void RENDERER_INTERFACE_CALL D3D12Renderer::SetPerformanceSettings(const PerformanceSettings& settings)
 	{
-
+		// Dynamic resolution is configured through SetDynamicResolutionConfig
 	}
 }
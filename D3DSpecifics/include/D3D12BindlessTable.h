@@ -0,0 +1,122 @@
+#ifndef ULTREALITY_RENDERING_D3D12_BINDLESS_TABLE_H
+#define ULTREALITY_RENDERING_D3D12_BINDLESS_TABLE_H
+
+#include <stdint.h>
+
+#include <wrl.h>
+#include <d3d12.h>
+
+#include <BindlessIndexAllocator.h>
+
+namespace UltReality::Rendering::D3D12
+{
+	/// <summary>
+	/// Region of the shader visible CBV/SRV/UAV heap whose descriptors live as long as their resources. Shaders index it
+	/// with the 32-bit indices handed out here, through the unbounded ranges of <see cref="CreateRootSignature"/>, so
+	/// draws only pass indices instead of copying descriptors into per-draw tables
+	/// </summary>
+	class D3D12BindlessTable
+	{
+	public:
+		// Root parameters of the bindless root signature
+		static constexpr uint32_t objectConstantsRootParameter = 0;
+		static constexpr uint32_t resourceIndicesRootParameter = 1;
+		static constexpr uint32_t tableRootParameter = 2;
+		// Number of 32-bit resource indices a draw can pass as root constants
+		static constexpr uint32_t maxResourceIndices = 8;
+
+	private:
+		ID3D12Device* m_device;
+		// Heap is owned by the renderer, the table only manages a region of it
+		ID3D12DescriptorHeap* m_heap;
+		D3D12_CPU_DESCRIPTOR_HANDLE m_cpuBase;
+		D3D12_GPU_DESCRIPTOR_HANDLE m_gpuBase;
+		uint32_t m_descriptorSize;
+
+		Common::BindlessIndexAllocator m_allocator;
+
+		D3D12_CPU_DESCRIPTOR_HANDLE CpuHandle(uint32_t index) const;
+
+	public:
+		/// <summary>
+		/// Creates a table over <paramref name="count"/> descriptors of <paramref name="heap"/> starting at <paramref name="baseIndex"/>
+		/// </summary>
+		/// <param name="device">Device the views are created with. Must outlive the table</param>
+		/// <param name="heap">Shader visible CBV/SRV/UAV heap. Must outlive the table</param>
+		/// <param name="baseIndex">First descriptor of the region, shader index 0</param>
+		/// <param name="count">Number of descriptors in the region</param>
+		/// <param name="descriptorSize">Handle increment size of the heap type</param>
+		D3D12BindlessTable(ID3D12Device* device, ID3D12DescriptorHeap* heap, uint32_t baseIndex, uint32_t count, uint32_t descriptorSize);
+
+		/// <summary>
+		/// Creates a shader resource view in a new slot
+		/// </summary>
+		Common::BindlessHandle CreateSrv(ID3D12Resource* resource, const D3D12_SHADER_RESOURCE_VIEW_DESC* desc);
+
+		/// <summary>
+		/// Creates an unordered access view in a new slot
+		/// </summary>
+		Common::BindlessHandle CreateUav(ID3D12Resource* resource, const D3D12_UNORDERED_ACCESS_VIEW_DESC* desc, ID3D12Resource* counter = nullptr);
+
+		/// <summary>
+		/// Creates a constant buffer view in a new slot
+		/// </summary>
+		Common::BindlessHandle CreateCbv(const D3D12_CONSTANT_BUFFER_VIEW_DESC& desc);
+
+		/// <summary>
+		/// Copies a CPU-only descriptor into a new slot
+		/// </summary>
+		Common::BindlessHandle CopyDescriptor(D3D12_CPU_DESCRIPTOR_HANDLE source);
+
+		/// <summary>
+		/// Frees a slot. It is reused once the frames that may still read it retired
+		/// </summary>
+		void Free(Common::BindlessHandle handle);
+
+		/// <summary>
+		/// Gets the index shaders use to reach the descriptor of <paramref name="handle"/>
+		/// </summary>
+		/// <exception cref="std::invalid_argument">Thrown if the slot has been freed</exception>
+		uint32_t GetShaderIndex(Common::BindlessHandle handle) const;
+
+		/// <summary>
+		/// Gets the start of the region, bound to <see cref="tableRootParameter"/>
+		/// </summary>
+		D3D12_GPU_DESCRIPTOR_HANDLE GpuStart() const;
+
+		/// <summary>
+		/// Tags every slot freed since the previous call with <paramref name="fenceValue"/>
+		/// </summary>
+		void FinishFrame(uint64_t fenceValue);
+
+		/// <summary>
+		/// Makes the slots of every frame whose fence value is at or below <paramref name="completedFenceValue"/> reusable
+		/// </summary>
+		void Retire(uint64_t completedFenceValue);
+
+		const Common::BindlessIndexAllocator& Allocator() const;
+
+		/// <summary>
+		/// Checks whether <paramref name="device"/> can bind the unbounded ranges of <see cref="CreateRootSignature"/>
+		/// </summary>
+		static bool IsSupported(ID3D12Device* device);
+
+		/// <summary>
+		/// Creates the root signature of bindless draws: a root CBV for the object constants (b0), up to
+		/// <see cref="maxResourceIndices"/> root constants of resource indices (b1) and one table of unbounded ranges
+		/// over the bindless region. SRVs are declared in space1, UAVs in space2 and CBVs in space3, all starting at
+		/// register 0 and descriptor 0, so a shader declares e.g. Texture2D textures[] : register(t0, space1)
+		/// </summary>
+		/// <param name="device">Device to create the root signature on</param>
+		/// <param name="staticSamplers">Samplers baked into the root signature</param>
+		/// <param name="staticSamplerCount">Number of <paramref name="staticSamplers"/></param>
+		/// <exception cref="std::runtime_error">Thrown if the device's resource binding tier cannot express unbounded ranges</exception>
+		static Microsoft::WRL::ComPtr<ID3D12RootSignature> CreateRootSignature(ID3D12Device* device,
+			const D3D12_STATIC_SAMPLER_DESC* staticSamplers = nullptr, uint32_t staticSamplerCount = 0);
+
+		D3D12BindlessTable(const D3D12BindlessTable&) = delete;
+		D3D12BindlessTable& operator=(const D3D12BindlessTable&) = delete;
+	};
+}
+
+#endif // !ULTREALITY_RENDERING_D3D12_BINDLESS_TABLE_H
@@ -0,0 +1,66 @@
+#ifndef ULTREALITY_RENDERING_D3D12_COMMAND_LIST_POOL_H
+#define ULTREALITY_RENDERING_D3D12_COMMAND_LIST_POOL_H
+
+#include <stdint.h>
+#include <vector>
+
+#include <wrl.h>
+#include <d3d12.h>
+
+namespace UltReality::Rendering::D3D12
+{
+	/// <summary>
+	/// Command allocators and command lists for every job system worker and every frame slot. A worker only ever
+	/// records into its own allocator, so recording needs no locking
+	/// </summary>
+	class D3D12CommandListPool
+	{
+	private:
+		struct WorkerFrame
+		{
+			Microsoft::WRL::ComPtr<ID3D12CommandAllocator> allocator;
+			std::vector<Microsoft::WRL::ComPtr<ID3D12GraphicsCommandList>> lists;
+			// Number of lists handed out from this slot during the frame
+			uint32_t usedLists = 0;
+		};
+
+		ID3D12Device* m_device;
+		D3D12_COMMAND_LIST_TYPE m_type;
+		uint32_t m_workerCount;
+		uint32_t m_frameCount;
+		uint32_t m_frameIndex = 0;
+
+		// Indexed by frameIndex * m_workerCount + workerIndex
+		std::vector<WorkerFrame> m_workerFrames;
+
+	public:
+		/// <summary>
+		/// Creates the allocators of every worker and frame slot. Command lists are created on demand
+		/// </summary>
+		/// <param name="device">Device the objects are created on. Must outlive the pool</param>
+		/// <param name="type">Command list type handed out by the pool</param>
+		/// <param name="workerCount">Number of workers that record concurrently</param>
+		/// <param name="frameCount">Number of frame slots, one per frame in flight</param>
+		D3D12CommandListPool(ID3D12Device* device, D3D12_COMMAND_LIST_TYPE type, uint32_t workerCount, uint32_t frameCount);
+
+		/// <summary>
+		/// Starts recording into <paramref name="frameIndex"/>, resetting the allocators that slot used last time.
+		/// The GPU must have retired the frame that last used the slot
+		/// </summary>
+		void BeginFrame(uint32_t frameIndex);
+
+		/// <summary>
+		/// Gets a command list of the current frame slot, reset and open for recording on <paramref name="workerIndex"/>
+		/// </summary>
+		/// <param name="workerIndex">Worker that will record into the list</param>
+		/// <param name="initialState">Initial pipeline state of the list</param>
+		ID3D12GraphicsCommandList* Acquire(uint32_t workerIndex, ID3D12PipelineState* initialState = nullptr);
+
+		uint32_t GetWorkerCount() const;
+
+		D3D12CommandListPool(const D3D12CommandListPool&) = delete;
+		D3D12CommandListPool& operator=(const D3D12CommandListPool&) = delete;
+	};
+}
+
+#endif // !ULTREALITY_RENDERING_D3D12_COMMAND_LIST_POOL_H
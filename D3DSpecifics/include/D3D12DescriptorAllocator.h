@@ -0,0 +1,86 @@
+#ifndef ULTREALITY_RENDERING_D3D12_DESCRIPTOR_ALLOCATOR_H
+#define ULTREALITY_RENDERING_D3D12_DESCRIPTOR_ALLOCATOR_H
+
+#include <stdint.h>
+#include <vector>
+
+#include <wrl.h>
+#include <d3d12.h>
+
+#include <DescriptorFreeList.h>
+
+namespace UltReality::Rendering::D3D12
+{
+	/// <summary>
+	/// Contiguous run of CPU-only descriptors handed out by <see cref="D3D12CPUDescriptorAllocator"/>
+	/// </summary>
+	struct D3D12DescriptorAllocation
+	{
+		D3D12_CPU_DESCRIPTOR_HANDLE cpuStart = {};
+		uint32_t descriptorSize = 0;
+		Common::DescriptorRange range;
+
+		/// <summary>
+		/// Gets the handle of the descriptor at <paramref name="index"/> inside the allocation
+		/// </summary>
+		D3D12_CPU_DESCRIPTOR_HANDLE Handle(uint32_t index = 0) const
+		{
+			return D3D12_CPU_DESCRIPTOR_HANDLE{ cpuStart.ptr + static_cast<SIZE_T>(index) * descriptorSize };
+		}
+
+		uint32_t Count() const { return range.count; }
+
+		bool IsValid() const { return range.IsValid(); }
+	};
+
+	/// <summary>
+	/// Growable allocator of CPU-only (non shader visible) descriptors of a single heap type. Backed by a
+	/// <see cref="Common::DescriptorFreeList"/> that adds a new descriptor heap page whenever the existing ones are full
+	/// </summary>
+	class D3D12CPUDescriptorAllocator final : private Common::IDescriptorPageFactory
+	{
+	private:
+		ID3D12Device* m_device;
+		D3D12_DESCRIPTOR_HEAP_TYPE m_type;
+		uint32_t m_descriptorSize;
+
+		std::vector<Microsoft::WRL::ComPtr<ID3D12DescriptorHeap>> m_pages;
+		Common::DescriptorFreeList m_freeList;
+
+		void CreatePage(uint32_t pageIndex, uint32_t descriptorCount) override;
+
+	public:
+		// Default number of descriptors per heap page
+		static constexpr uint32_t defaultPageSize = 256;
+
+		/// <summary>
+		/// Creates an allocator for descriptors of <paramref name="type"/>
+		/// </summary>
+		/// <param name="device">Device descriptor heaps are created on. Must outlive the allocator</param>
+		/// <param name="type">Descriptor heap type served by the allocator</param>
+		/// <param name="descriptorSize">Handle increment size of <paramref name="type"/> as queried from the device</param>
+		/// <param name="pageSize">Number of descriptors in each heap page</param>
+		D3D12CPUDescriptorAllocator(ID3D12Device* device, D3D12_DESCRIPTOR_HEAP_TYPE type, uint32_t descriptorSize, uint32_t pageSize = defaultPageSize);
+
+		/// <summary>
+		/// Allocates <paramref name="count"/> contiguous descriptors
+		/// </summary>
+		D3D12DescriptorAllocation Allocate(uint32_t count = 1);
+
+		/// <summary>
+		/// Returns the descriptors of <paramref name="allocation"/> to the allocator and invalidates it
+		/// </summary>
+		void Free(D3D12DescriptorAllocation& allocation);
+
+		D3D12_DESCRIPTOR_HEAP_TYPE Type() const;
+
+		uint32_t DescriptorSize() const;
+
+		const Common::DescriptorFreeList& FreeList() const;
+
+		D3D12CPUDescriptorAllocator(const D3D12CPUDescriptorAllocator&) = delete;
+		D3D12CPUDescriptorAllocator& operator=(const D3D12CPUDescriptorAllocator&) = delete;
+	};
+}
+
+#endif // !ULTREALITY_RENDERING_D3D12_DESCRIPTOR_ALLOCATOR_H
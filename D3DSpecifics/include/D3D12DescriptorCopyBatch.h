@@ -0,0 +1,47 @@
+#ifndef ULTREALITY_RENDERING_D3D12_DESCRIPTOR_COPY_BATCH_H
+#define ULTREALITY_RENDERING_D3D12_DESCRIPTOR_COPY_BATCH_H
+
+#include <stdint.h>
+#include <vector>
+
+#include <d3d12.h>
+
+namespace UltReality::Rendering::D3D12
+{
+	/// <summary>
+	/// Gathers descriptor copies of a single heap type and submits them with one <see cref="ID3D12Device::CopyDescriptors"/> call
+	/// </summary>
+	class D3D12DescriptorCopyBatch
+	{
+	private:
+		ID3D12Device* m_device;
+		D3D12_DESCRIPTOR_HEAP_TYPE m_type;
+
+		std::vector<D3D12_CPU_DESCRIPTOR_HANDLE> m_destStarts;
+		std::vector<UINT> m_destSizes;
+		std::vector<D3D12_CPU_DESCRIPTOR_HANDLE> m_srcStarts;
+		std::vector<UINT> m_srcSizes;
+
+	public:
+		D3D12DescriptorCopyBatch(ID3D12Device* device, D3D12_DESCRIPTOR_HEAP_TYPE type);
+
+		/// <summary>
+		/// Queues a copy of <paramref name="count"/> contiguous descriptors
+		/// </summary>
+		void Add(D3D12_CPU_DESCRIPTOR_HANDLE dest, D3D12_CPU_DESCRIPTOR_HANDLE src, uint32_t count = 1);
+
+		/// <summary>
+		/// Queues copies of scattered single descriptors into a contiguous destination range
+		/// </summary>
+		void AddGather(D3D12_CPU_DESCRIPTOR_HANDLE destStart, const D3D12_CPU_DESCRIPTOR_HANDLE* srcs, uint32_t count);
+
+		/// <summary>
+		/// Issues every queued copy in a single call and clears the batch
+		/// </summary>
+		void Flush();
+
+		bool Empty() const;
+	};
+}
+
+#endif // !ULTREALITY_RENDERING_D3D12_DESCRIPTOR_COPY_BATCH_H
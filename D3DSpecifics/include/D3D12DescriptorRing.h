@@ -0,0 +1,83 @@
+#ifndef ULTREALITY_RENDERING_D3D12_DESCRIPTOR_RING_H
+#define ULTREALITY_RENDERING_D3D12_DESCRIPTOR_RING_H
+
+#include <stdint.h>
+
+#include <d3d12.h>
+
+#include <LinearRingAllocator.h>
+
+namespace UltReality::Rendering::D3D12
+{
+	/// <summary>
+	/// Contiguous run of shader visible descriptors, usable as a descriptor table for the current frame
+	/// </summary>
+	struct D3D12DescriptorTable
+	{
+		D3D12_CPU_DESCRIPTOR_HANDLE cpuStart = {};
+		D3D12_GPU_DESCRIPTOR_HANDLE gpuStart = {};
+		uint32_t count = 0;
+		uint32_t descriptorSize = 0;
+
+		D3D12_CPU_DESCRIPTOR_HANDLE CpuHandle(uint32_t index = 0) const
+		{
+			return D3D12_CPU_DESCRIPTOR_HANDLE{ cpuStart.ptr + static_cast<SIZE_T>(index) * descriptorSize };
+		}
+
+		D3D12_GPU_DESCRIPTOR_HANDLE GpuHandle(uint32_t index = 0) const
+		{
+			return D3D12_GPU_DESCRIPTOR_HANDLE{ gpuStart.ptr + static_cast<UINT64>(index) * descriptorSize };
+		}
+	};
+
+	/// <summary>
+	/// Ring of per-frame descriptor tables over a region of a shader visible descriptor heap. Tables are written
+	/// during recording and reclaimed once the fence of their frame retires
+	/// </summary>
+	class D3D12DescriptorRing
+	{
+	private:
+		// Heap is owned by the renderer, the ring only manages a region of it
+		ID3D12DescriptorHeap* m_heap;
+		D3D12_CPU_DESCRIPTOR_HANDLE m_cpuBase;
+		D3D12_GPU_DESCRIPTOR_HANDLE m_gpuBase;
+		uint32_t m_descriptorSize;
+
+		Common::LinearRingAllocator m_allocator;
+
+	public:
+		/// <summary>
+		/// Creates a ring over <paramref name="count"/> descriptors of <paramref name="heap"/> starting at <paramref name="baseIndex"/>
+		/// </summary>
+		/// <param name="heap">Shader visible descriptor heap. Must outlive the ring</param>
+		/// <param name="baseIndex">First descriptor of the region managed by the ring</param>
+		/// <param name="count">Number of descriptors managed by the ring</param>
+		/// <param name="descriptorSize">Handle increment size of the heap type</param>
+		D3D12DescriptorRing(ID3D12DescriptorHeap* heap, uint32_t baseIndex, uint32_t count, uint32_t descriptorSize);
+
+		/// <summary>
+		/// Allocates a table of <paramref name="count"/> contiguous descriptors for the current frame.
+		/// Throws if the ring is exhausted, as a shader visible heap cannot be swapped mid frame
+		/// </summary>
+		D3D12DescriptorTable Allocate(uint32_t count);
+
+		/// <summary>
+		/// Tags every table allocated since the previous call with <paramref name="fenceValue"/>
+		/// </summary>
+		void FinishFrame(uint64_t fenceValue);
+
+		/// <summary>
+		/// Reclaims the tables of every frame whose fence value is at or below <paramref name="completedFenceValue"/>
+		/// </summary>
+		void Retire(uint64_t completedFenceValue);
+
+		ID3D12DescriptorHeap* Heap() const;
+
+		const Common::LinearRingAllocator& Allocator() const;
+
+		D3D12DescriptorRing(const D3D12DescriptorRing&) = delete;
+		D3D12DescriptorRing& operator=(const D3D12DescriptorRing&) = delete;
+	};
+}
+
+#endif // !ULTREALITY_RENDERING_D3D12_DESCRIPTOR_RING_H
@@ -0,0 +1,48 @@
+#ifndef ULTREALITY_RENDERING_D3D12_DRAW_ITEM_H
+#define ULTREALITY_RENDERING_D3D12_DRAW_ITEM_H
+
+#include <stdint.h>
+
+#include <d3d12.h>
+
+#include <D3D12BindlessTable.h>
+
+namespace UltReality::Rendering::D3D12
+{
+	/// <summary>
+	/// Everything needed to record one indexed draw into a command list
+	/// </summary>
+	struct DrawItem
+	{
+		// Pipeline state and root signature the draw is recorded with
+		ID3D12PipelineState* pipelineState = nullptr;
+		ID3D12RootSignature* rootSignature = nullptr;
+		// Key returned by the pipeline cache, used in place of pipelineState when that is null
+		uint64_t pipelineKey = 0;
+
+		// Draws are recorded in ascending key order, see Common::EncodeDrawSortKey. Equal keys keep their submission order
+		uint64_t sortKey = 0;
+
+		// Geometry of the draw
+		D3D12_VERTEX_BUFFER_VIEW vertexBufferView = {};
+		D3D12_INDEX_BUFFER_VIEW indexBufferView = {};
+		D3D12_PRIMITIVE_TOPOLOGY primitiveTopology = D3D_PRIMITIVE_TOPOLOGY_TRIANGLELIST;
+		// Per-instance vertex stream bound to slot 1 when its size is not 0, filled in by the instancing batcher
+		D3D12_VERTEX_BUFFER_VIEW instanceBufferView = {};
+
+		uint32_t indexCount = 0;
+		uint32_t startIndex = 0;
+		int32_t baseVertex = 0;
+		uint32_t instanceCount = 1;
+		uint32_t startInstance = 0;
+
+		// Per-draw constants bound as a root CBV, usually a slice of the upload ring. 0 when the draw has none
+		D3D12_GPU_VIRTUAL_ADDRESS objectConstants = 0;
+
+		// Bindless shader indices of the draw's resources, passed as root constants when the draw uses the bindless root signature
+		uint32_t resourceIndices[D3D12BindlessTable::maxResourceIndices] = {};
+		uint32_t resourceIndexCount = 0;
+	};
+}
+
+#endif // !ULTREALITY_RENDERING_D3D12_DRAW_ITEM_H
@@ -0,0 +1,38 @@
+#ifndef ULTREALITY_RENDERING_D3D12_DXC_COMPILER_H
+#define ULTREALITY_RENDERING_D3D12_DXC_COMPILER_H
+
+// Only built when CMake found the DirectX Shader Compiler
+#if defined(D3D12_RENDERER_DXC)
+
+#include <stdint.h>
+
+#include <ShaderCompiler.h>
+
+namespace UltReality::Rendering::D3D12
+{
+	/// <summary>
+	/// <see cref="Common::IShaderCompiler"/> that compiles HLSL to DXIL with the DirectX Shader Compiler. Every
+	/// compilation creates its own compiler instance, DXC instances must not be shared between threads
+	/// </summary>
+	class D3D12DxcCompiler final : public Common::IShaderCompiler
+	{
+	private:
+		uint64_t m_versionHash = 0;
+
+	public:
+		/// <summary>
+		/// Loads DXC and reads its version
+		/// </summary>
+		/// <exception cref="D3DException">Thrown if DXC can not be instantiated</exception>
+		D3D12DxcCompiler();
+
+		uint64_t GetVersionHash() const override;
+
+		bool Compile(const Common::ShaderCompileRequest& request, const std::string& source, Common::IShaderIncludeResolver& resolver,
+			std::vector<uint8_t>& bytecode, std::string& messages) override;
+	};
+}
+
+#endif // D3D12_RENDERER_DXC
+
+#endif // !ULTREALITY_RENDERING_D3D12_DXC_COMPILER_H
@@ -0,0 +1,48 @@
+#ifndef ULTREALITY_RENDERING_D3D12_FENCE_TIMELINE_H
+#define ULTREALITY_RENDERING_D3D12_FENCE_TIMELINE_H
+
+#include <stdint.h>
+
+#include <windows.h>
+#include <d3d12.h>
+
+#include <IFenceTimeline.h>
+
+namespace UltReality::Rendering::D3D12
+{
+	/// <summary>
+	/// <see cref="Common::IFenceTimeline"/> backed by an <see cref="ID3D12Fence"/> signalled on an <see cref="ID3D12CommandQueue"/>
+	/// </summary>
+	class D3D12FenceTimeline final : public Common::IFenceTimeline
+	{
+	private:
+		// Fence and queue are owned by the renderer and must outlive the timeline
+		ID3D12Fence* m_fence;
+		ID3D12CommandQueue* m_queue;
+
+		// Event reused for every CPU wait on the fence
+		HANDLE m_fenceEvent = nullptr;
+
+		// Last value signalled on the queue
+		uint64_t m_currentValue = 0;
+
+	public:
+		D3D12FenceTimeline(ID3D12Fence* fence, ID3D12CommandQueue* queue);
+		~D3D12FenceTimeline();
+
+		uint64_t Signal() override;
+
+		uint64_t GetCompletedValue() const override;
+
+		void WaitForValue(uint64_t value) override;
+
+		ID3D12Fence* Fence() const;
+
+		uint64_t GetCurrentValue() const;
+
+		D3D12FenceTimeline(const D3D12FenceTimeline&) = delete;
+		D3D12FenceTimeline& operator=(const D3D12FenceTimeline&) = delete;
+	};
+}
+
+#endif // !ULTREALITY_RENDERING_D3D12_FENCE_TIMELINE_H
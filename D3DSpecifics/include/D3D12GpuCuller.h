@@ -0,0 +1,150 @@
+#ifndef ULTREALITY_RENDERING_D3D12_GPU_CULLER_H
+#define ULTREALITY_RENDERING_D3D12_GPU_CULLER_H
+
+#include <stdint.h>
+#include <vector>
+
+#include <wrl.h>
+#include <d3d12.h>
+
+#include <GpuCulling.h>
+#include <DeferredReleaseQueue.h>
+#include <D3D12UploadRing.h>
+#include <D3D12BindlessTable.h>
+
+namespace UltReality::Rendering::D3D12
+{
+	/// <summary>
+	/// GPU driven instance drawing. Instances and the mesh table live in GPU buffers, a compute pass culls the instances
+	/// against the frustum and compacts the visible ones into an indirect argument buffer, and a single ExecuteIndirect
+	/// draws them. The CPU cost of a frame only depends on the number of instances that changed
+	/// </summary>
+	class D3D12GpuCuller
+	{
+	public:
+		// HLSL of the culling and compaction passes, see <see cref="Common::CullAndCompactReference"/> for their result
+		static const char* const shaderSource;
+		static constexpr const char* cullEntryPoint = "CullInstances";
+		static constexpr const char* compactEntryPoint = "CompactInstances";
+
+		// Root constant of the draw root signature receiving the index of the drawn instance. The one after it holds the
+		// bindless index of the instance buffer, so vertex shaders can read the instance's record
+		static constexpr uint32_t instanceIndexConstant = 0;
+		static constexpr uint32_t instanceBufferConstant = 1;
+
+	private:
+		struct PendingCopy
+		{
+			UploadAllocation source;
+			uint64_t destinationOffset;
+		};
+
+		ID3D12Device* m_device;
+		D3D12UploadRing* m_uploadRing;
+		D3D12BindlessTable* m_bindlessTable;
+		ID3D12RootSignature* m_drawRootSignature;
+
+		Microsoft::WRL::ComPtr<ID3D12RootSignature> m_computeRootSignature;
+		Microsoft::WRL::ComPtr<ID3D12PipelineState> m_cullPipeline;
+		Microsoft::WRL::ComPtr<ID3D12PipelineState> m_compactPipeline;
+		Microsoft::WRL::ComPtr<ID3D12CommandSignature> m_commandSignature;
+
+		// Persistent instance records and mesh table
+		Microsoft::WRL::ComPtr<ID3D12Resource> m_instanceBuffer;
+		Microsoft::WRL::ComPtr<ID3D12Resource> m_meshBuffer;
+		// Scratch of the culling pass: the offset of every instance within its group and the visible count of every group
+		Microsoft::WRL::ComPtr<ID3D12Resource> m_localOffsetBuffer;
+		Microsoft::WRL::ComPtr<ID3D12Resource> m_groupCountBuffer;
+		// Indirect arguments and draw count consumed by ExecuteIndirect
+		Microsoft::WRL::ComPtr<ID3D12Resource> m_commandBuffer;
+		Microsoft::WRL::ComPtr<ID3D12Resource> m_countBuffer;
+		Common::BindlessHandle m_instanceBufferSrv;
+
+		uint32_t m_instanceCapacity = 0;
+		uint32_t m_meshCapacity = 0;
+		uint32_t m_instanceCount = 0;
+		uint32_t m_meshCount = 0;
+
+		// Instance buffer replaced by a larger one, its records are copied over before the next pass
+		Microsoft::WRL::ComPtr<ID3D12Resource> m_growSource;
+		uint64_t m_growBytes = 0;
+		std::vector<PendingCopy> m_pendingInstanceCopies;
+		std::vector<PendingCopy> m_pendingMeshCopies;
+
+		// Geometry every instance draws from
+		D3D12_VERTEX_BUFFER_VIEW m_vertexBufferView = {};
+		D3D12_INDEX_BUFFER_VIEW m_indexBufferView = {};
+
+		// Replaced buffers, kept until the frames using them retire
+		Common::DeferredReleaseQueue<Microsoft::WRL::ComPtr<ID3D12Resource>> m_retiredResources;
+
+		Microsoft::WRL::ComPtr<ID3D12Resource> CreateBuffer(uint64_t size, D3D12_RESOURCE_FLAGS flags) const;
+
+		void RetireResource(Microsoft::WRL::ComPtr<ID3D12Resource>& resource);
+
+		void GrowInstanceBuffers(uint32_t capacity);
+
+	public:
+		/// <summary>
+		/// Creates the culling pipelines and the command signature of the instance draws
+		/// </summary>
+		/// <param name="device">Device to create the pipelines and buffers on. Must outlive the culler</param>
+		/// <param name="cullShader">Compiled <see cref="cullEntryPoint"/> of <see cref="shaderSource"/></param>
+		/// <param name="compactShader">Compiled <see cref="compactEntryPoint"/> of <see cref="shaderSource"/></param>
+		/// <param name="uploadRing">Ring instance and mesh updates are staged in. Must outlive the culler</param>
+		/// <param name="bindlessTable">Table the instance buffer is published in. Must outlive the culler</param>
+		/// <param name="drawRootSignature">Bindless root signature the instances are drawn with</param>
+		D3D12GpuCuller(ID3D12Device* device, D3D12_SHADER_BYTECODE cullShader, D3D12_SHADER_BYTECODE compactShader,
+			D3D12UploadRing* uploadRing, D3D12BindlessTable* bindlessTable, ID3D12RootSignature* drawRootSignature);
+		~D3D12GpuCuller();
+
+		/// <summary>
+		/// Replaces the mesh table and the geometry buffers every mesh range points into
+		/// </summary>
+		void SetMeshes(const std::vector<Common::GpuMesh>& meshes, const D3D12_VERTEX_BUFFER_VIEW& vertexBuffer, const D3D12_INDEX_BUFFER_VIEW& indexBuffer);
+
+		/// <summary>
+		/// Sets the number of instances. Growing keeps the existing records, new ones must be written before they are drawn
+		/// </summary>
+		void SetInstanceCount(uint32_t count);
+
+		/// <summary>
+		/// Overwrites the records of instances [<paramref name="first"/>, <paramref name="first"/> + <paramref name="count"/>).
+		/// Only the changed records are uploaded
+		/// </summary>
+		/// <exception cref="std::out_of_range">Thrown if the range exceeds the instance count</exception>
+		void UpdateInstances(uint32_t first, const Common::GpuInstance* instances, uint32_t count);
+
+		/// <summary>
+		/// Records the pending uploads followed by the culling and compaction passes
+		/// </summary>
+		/// <param name="cmdList">Direct or compute command list</param>
+		/// <param name="frustumPlanes">Normalized frustum planes, see <see cref="Common::ExtractFrustumPlanes"/></param>
+		void RecordCulling(ID3D12GraphicsCommandList* cmdList, const float frustumPlanes[6][4]);
+
+		/// <summary>
+		/// Draws the instances that survived the last <see cref="RecordCulling"/> of the same submission
+		/// </summary>
+		/// <param name="cmdList">Command list with the render targets and descriptor heaps bound</param>
+		/// <param name="pipelineState">Pipeline created with the draw root signature</param>
+		/// <param name="topology">Primitive topology of the geometry</param>
+		void RecordDraws(ID3D12GraphicsCommandList* cmdList, ID3D12PipelineState* pipelineState, D3D12_PRIMITIVE_TOPOLOGY topology = D3D_PRIMITIVE_TOPOLOGY_TRIANGLELIST);
+
+		uint32_t GetInstanceCount() const;
+
+		/// <summary>
+		/// Tags every buffer replaced since the previous call with <paramref name="fenceValue"/>
+		/// </summary>
+		void FinishFrame(uint64_t fenceValue);
+
+		/// <summary>
+		/// Releases the buffers of every frame whose fence value is at or below <paramref name="completedFenceValue"/>
+		/// </summary>
+		void Retire(uint64_t completedFenceValue);
+
+		D3D12GpuCuller(const D3D12GpuCuller&) = delete;
+		D3D12GpuCuller& operator=(const D3D12GpuCuller&) = delete;
+	};
+}
+
+#endif // !ULTREALITY_RENDERING_D3D12_GPU_CULLER_H
@@ -0,0 +1,87 @@
+#ifndef ULTREALITY_RENDERING_D3D12_GPU_PROFILER_H
+#define ULTREALITY_RENDERING_D3D12_GPU_PROFILER_H
+
+#include <stdint.h>
+#include <string_view>
+
+#include <wrl.h>
+#include <d3d12.h>
+
+#include <GpuProfiler.h>
+
+namespace UltReality::Rendering::D3D12
+{
+	/// <summary>
+	/// Timestamp query profiler for one command queue. Scope timestamps go into a query heap split into
+	/// <see cref="Common::GpuProfiler::frameSlotCount"/> frame slots, every frame resolves its slot into a readback
+	/// buffer that is read once the frame's fence completed
+	/// </summary>
+	class D3D12GpuProfiler
+	{
+	private:
+		Microsoft::WRL::ComPtr<ID3D12QueryHeap> m_queryHeap;
+		// Resolved timestamps of every frame slot, laid out like the query heap
+		Microsoft::WRL::ComPtr<ID3D12Resource> m_readbackBuffer;
+
+		Common::GpuProfiler m_profiler;
+
+	public:
+		// Default number of scopes a frame can record
+		static constexpr uint32_t defaultMaxScopesPerFrame = 256;
+
+		/// <summary>
+		/// Creates the query heap and readback buffer
+		/// </summary>
+		/// <param name="device">Device to create the queries on</param>
+		/// <param name="queue">Queue the profiled command lists are submitted to, provides the timestamp frequency</param>
+		/// <param name="maxScopesPerFrame">Number of scopes a frame can record</param>
+		D3D12GpuProfiler(ID3D12Device* device, ID3D12CommandQueue* queue, uint32_t maxScopesPerFrame = defaultMaxScopesPerFrame);
+
+		/// <summary>
+		/// Starts profiling a new frame. Call before any scope of the frame is opened
+		/// </summary>
+		void BeginFrame();
+
+		/// <summary>
+		/// Opens a scope by writing its begin timestamp to <paramref name="cmdList"/>. Thread safe
+		/// </summary>
+		/// <param name="cmdList">Command list the scope starts on</param>
+		/// <param name="name">Name of the scope</param>
+		/// <param name="parent">Scope to nest the new one under</param>
+		/// <returns>Scope to pass to <see cref="EndScope"/></returns>
+		uint32_t BeginScope(ID3D12GraphicsCommandList* cmdList, std::string_view name, uint32_t parent = Common::GpuProfiler::invalidScope);
+
+		/// <summary>
+		/// Closes a scope by writing its end timestamp to <paramref name="cmdList"/>, which may differ from the list it began on. Thread safe
+		/// </summary>
+		void EndScope(ID3D12GraphicsCommandList* cmdList, uint32_t scope);
+
+		/// <summary>
+		/// Closes the scopes left open and resolves the frame's timestamps into the readback buffer. Record on the last
+		/// command list of the frame
+		/// </summary>
+		void ResolveFrame(ID3D12GraphicsCommandList* cmdList);
+
+		/// <summary>
+		/// Tags the frame's timestamps with the fence value signalled after the frame
+		/// </summary>
+		void FinishFrame(uint64_t fenceValue);
+
+		/// <summary>
+		/// Reads back every frame whose fence completed. Never waits on the GPU
+		/// </summary>
+		void Retire(uint64_t completedFenceValue);
+
+		/// <summary>
+		/// Gets the timings of the most recent frame that was read back, usually a few frames old
+		/// </summary>
+		const Common::GpuFrameProfile& GetLatestProfile() const;
+
+		const Common::GpuProfiler& Profiler() const;
+
+		D3D12GpuProfiler(const D3D12GpuProfiler&) = delete;
+		D3D12GpuProfiler& operator=(const D3D12GpuProfiler&) = delete;
+	};
+}
+
+#endif // !ULTREALITY_RENDERING_D3D12_GPU_PROFILER_H
@@ -0,0 +1,141 @@
+#ifndef ULTREALITY_RENDERING_D3D12_HEAP_MANAGER_H
+#define ULTREALITY_RENDERING_D3D12_HEAP_MANAGER_H
+
+#include <stdint.h>
+#include <array>
+#include <memory>
+#include <vector>
+
+#include <wrl.h>
+#include <d3d12.h>
+
+#include <BuddyAllocator.h>
+
+namespace UltReality::Rendering::D3D12
+{
+	/// <summary>
+	/// Resource placed by <see cref="D3D12HeapManager"/>. Resources too large for a heap page are committed instead
+	/// </summary>
+	struct D3D12PlacedAllocation
+	{
+		Microsoft::WRL::ComPtr<ID3D12Resource> resource;
+
+		// Pool and page the resource was placed in
+		uint32_t poolIndex = UINT32_MAX;
+		uint32_t pageIndex = UINT32_MAX;
+		// Offset of the resource inside its heap page
+		uint64_t offset = 0;
+
+		// True when the resource got its own implicit heap
+		bool committed = false;
+	};
+
+	/// <summary>
+	/// Reserves large <see cref="ID3D12Heap"/> pages per heap type and resource category and places resources into
+	/// them with a <see cref="Common::BuddyAllocator"/> per page
+	/// </summary>
+	class D3D12HeapManager
+	{
+	public:
+		// Resource heap tier 1 hardware cannot mix these categories in one heap
+		enum class ResourceCategory : uint8_t
+		{
+			Buffers = 0,
+			RenderTargetsAndDepth,
+			OtherTextures,
+
+			Count
+		};
+
+		struct Statistics
+		{
+			// Number of heap pages reserved across every pool
+			uint32_t pageCount = 0;
+			// Bytes reserved in heap pages
+			uint64_t reservedBytes = 0;
+			// Bytes in placed blocks
+			uint64_t usedBytes = 0;
+			// Bytes placed resources actually need
+			uint64_t requestedBytes = 0;
+			// Number of live placed resources
+			uint32_t placedCount = 0;
+			// Number of resources that fell back to a committed resource
+			uint32_t committedCount = 0;
+			// Worst page fragmentation, see <see cref="Common::BuddyAllocator::Statistics::fragmentation"/>
+			float maxFragmentation = 0.0f;
+			// Average and worst CPU time spent in CreateResource, in microseconds
+			double averageAllocationMicroseconds = 0.0;
+			double maxAllocationMicroseconds = 0.0;
+		};
+
+	private:
+		struct HeapPage
+		{
+			Microsoft::WRL::ComPtr<ID3D12Heap> heap;
+			std::unique_ptr<Common::BuddyAllocator> allocator;
+		};
+
+		struct HeapPool
+		{
+			D3D12_HEAP_TYPE heapType;
+			D3D12_HEAP_FLAGS heapFlags;
+			std::vector<HeapPage> pages;
+		};
+
+		static constexpr uint32_t s_heapTypeCount = 3; // DEFAULT, UPLOAD, READBACK
+
+		ID3D12Device* m_device;
+		uint64_t m_pageSize;
+
+		std::array<HeapPool, s_heapTypeCount * static_cast<size_t>(ResourceCategory::Count)> m_pools;
+
+		uint32_t m_committedCount = 0;
+		uint64_t m_allocationCount = 0;
+		double m_totalAllocationMicroseconds = 0.0;
+		double m_maxAllocationMicroseconds = 0.0;
+
+		HeapPage& CreatePage(HeapPool& pool);
+
+		static uint32_t PoolIndex(D3D12_HEAP_TYPE heapType, ResourceCategory category);
+
+		static ResourceCategory CategoryOf(const D3D12_RESOURCE_DESC& desc);
+
+	public:
+		// Default size of a heap page
+		static constexpr uint64_t defaultPageSize = 64ull * 1024 * 1024;
+
+		/// <summary>
+		/// Creates an empty heap manager. Pages are reserved lazily on first use
+		/// </summary>
+		/// <param name="device">Device heaps and resources are created on. Must outlive the manager</param>
+		/// <param name="pageSize">Size of each <see cref="ID3D12Heap"/>. Must be a power of 2</param>
+		D3D12HeapManager(ID3D12Device* device, uint64_t pageSize = defaultPageSize);
+
+		/// <summary>
+		/// Places a resource in a heap page of <paramref name="heapType"/>, reserving a new page if none has room.
+		/// Falls back to a committed resource when the resource is larger than a page
+		/// </summary>
+		D3D12PlacedAllocation CreateResource(
+			D3D12_HEAP_TYPE heapType,
+			const D3D12_RESOURCE_DESC& desc,
+			D3D12_RESOURCE_STATES initialState,
+			const D3D12_CLEAR_VALUE* clearValue);
+
+		/// <summary>
+		/// Releases the resource and returns its block to the page. The GPU must no longer be using the resource
+		/// </summary>
+		void Release(D3D12PlacedAllocation& allocation);
+
+		/// <summary>
+		/// Releases heap pages that no longer hold any resource
+		/// </summary>
+		void TrimEmptyPages();
+
+		Statistics GetStatistics() const;
+
+		D3D12HeapManager(const D3D12HeapManager&) = delete;
+		D3D12HeapManager& operator=(const D3D12HeapManager&) = delete;
+	};
+}
+
+#endif // !ULTREALITY_RENDERING_D3D12_HEAP_MANAGER_H
@@ -0,0 +1,164 @@
+#ifndef ULTREALITY_RENDERING_D3D12_PIPELINE_CACHE_H
+#define ULTREALITY_RENDERING_D3D12_PIPELINE_CACHE_H
+
+#include <stdint.h>
+#include <atomic>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <vector>
+#include <unordered_map>
+
+#include <wrl.h>
+#include <d3d12.h>
+
+#include <JobSystem.h>
+#include <PipelineCacheIndex.h>
+
+namespace UltReality::Rendering::D3D12
+{
+	// What <see cref="D3D12PipelineCache::Resolve"/> does with a pipeline that is still compiling
+	enum class PipelinePendingPolicy : uint8_t
+	{
+		// Return null so the draw is skipped for this frame
+		SkipDraw,
+		// Return the fallback pipeline given at request time, or null if there is none
+		UseFallback,
+		// Wait for the compilation to finish
+		Block
+	};
+
+	/// <summary>
+	/// Graphics pipeline state cache keyed by a stable hash of the full pipeline description. Misses are compiled on
+	/// the job system so recording never waits on the driver, and compiled pipelines are persisted through an
+	/// <see cref="ID3D12PipelineLibrary"/> so later runs load them instead of compiling them again
+	/// </summary>
+	class D3D12PipelineCache
+	{
+	public:
+		struct Statistics
+		{
+			// Pipelines requested during this run
+			uint32_t requestCount = 0;
+			// Pipelines loaded from the pipeline library
+			uint32_t libraryHits = 0;
+			// Pipelines compiled from scratch
+			uint32_t compileCount = 0;
+			uint32_t failedCount = 0;
+			// Resolve calls that found their pipeline still compiling
+			uint64_t pendingResolves = 0;
+			// Total and worst CPU time spent creating a pipeline, in milliseconds
+			double totalCreateMilliseconds = 0.0;
+			double maxCreateMilliseconds = 0.0;
+		};
+
+	private:
+		enum class EntryState : uint8_t
+		{
+			Pending,
+			Ready,
+			Failed
+		};
+
+		struct Entry
+		{
+			std::atomic<EntryState> state{ EntryState::Pending };
+			Microsoft::WRL::ComPtr<ID3D12PipelineState> pipelineState;
+			Microsoft::WRL::ComPtr<ID3D12PipelineState> fallback;
+
+			// Copy of the description and everything it points to, compilation runs after the request returned
+			D3D12_GRAPHICS_PIPELINE_STATE_DESC desc;
+			Microsoft::WRL::ComPtr<ID3D12RootSignature> rootSignature;
+			std::vector<uint8_t> shaderBytecode[5];
+			std::vector<D3D12_INPUT_ELEMENT_DESC> inputElements;
+			std::vector<std::string> semanticNames;
+		};
+
+		ID3D12Device* m_device;
+		Common::JobSystem* m_jobSystem;
+
+		std::string m_libraryPath;
+		std::string m_indexPath;
+
+		// Null when the device does not support pipeline libraries
+		Microsoft::WRL::ComPtr<ID3D12PipelineLibrary> m_library;
+		// Serialized library the current library was created from. Has to outlive m_library
+		std::vector<uint8_t> m_libraryBlob;
+		bool m_libraryDirty = false;
+		// Hash of the library blob the index is written next to
+		uint64_t m_libraryFileHash = 0;
+		std::mutex m_libraryMutex;
+
+		Common::PipelineCacheIndex m_index;
+
+		mutable std::mutex m_entryMutex;
+		std::unordered_map<uint64_t, std::unique_ptr<Entry>> m_entries;
+		Common::JobCounter m_compileCounter;
+
+		mutable std::mutex m_statisticsMutex;
+		Statistics m_statistics;
+
+		void OpenLibrary(uint64_t compatibilityHash);
+
+		void CopyDescription(Entry& entry, const D3D12_GRAPHICS_PIPELINE_STATE_DESC& desc);
+
+		void Compile(uint64_t key, Entry& entry);
+
+	public:
+		/// <summary>
+		/// Creates the cache and opens the pipeline library persisted in <paramref name="cacheDirectory"/>
+		/// </summary>
+		/// <param name="device">Device pipelines are created on. Must outlive the cache</param>
+		/// <param name="jobSystem">Job system compilations run on. Must outlive the cache</param>
+		/// <param name="cacheDirectory">Directory the library and its index are stored in, empty to disable persistence</param>
+		/// <param name="compatibilityHash">Identifies the adapter and driver, a change discards the persisted pipelines</param>
+		D3D12PipelineCache(ID3D12Device* device, Common::JobSystem* jobSystem, const std::string& cacheDirectory, uint64_t compatibilityHash);
+
+		/// <summary>
+		/// Waits for pending compilations and persists the library
+		/// </summary>
+		~D3D12PipelineCache();
+
+		/// <summary>
+		/// Hashes every field of <paramref name="desc"/> that affects the compiled pipeline. Shaders and the input layout
+		/// are hashed by content. The root signature is identified by <paramref name="rootSignatureHash"/>, typically the
+		/// hash of its serialized blob, since the object address changes every run
+		/// </summary>
+		static uint64_t HashGraphicsDesc(const D3D12_GRAPHICS_PIPELINE_STATE_DESC& desc, uint64_t rootSignatureHash);
+
+		/// <summary>
+		/// Requests the pipeline described by <paramref name="desc"/>. Returns immediately, a pipeline that is neither
+		/// cached nor compiling is loaded from the library or compiled on the job system
+		/// </summary>
+		/// <param name="desc">Pipeline description. Copied, so the memory it points to may be freed once this returns</param>
+		/// <param name="rootSignatureHash">Stable hash of the root signature, see <see cref="HashGraphicsDesc"/></param>
+		/// <param name="fallback">Pipeline returned by <see cref="Resolve"/> with <see cref="PipelinePendingPolicy::UseFallback"/> while this one compiles</param>
+		/// <returns>Key to resolve the pipeline with</returns>
+		uint64_t RequestGraphics(const D3D12_GRAPHICS_PIPELINE_STATE_DESC& desc, uint64_t rootSignatureHash, ID3D12PipelineState* fallback = nullptr);
+
+		/// <summary>
+		/// Gets the pipeline for <paramref name="key"/>
+		/// </summary>
+		/// <returns>The pipeline, or whatever <paramref name="policy"/> dictates while it is compiling. Null for failed or unknown pipelines</returns>
+		ID3D12PipelineState* Resolve(uint64_t key, PipelinePendingPolicy policy);
+
+		bool IsReady(uint64_t key) const;
+
+		/// <summary>
+		/// Blocks until every requested pipeline finished compiling
+		/// </summary>
+		void WaitForPending();
+
+		/// <summary>
+		/// Writes the pipeline library and its index to the cache directory if pipelines were added since the last save
+		/// </summary>
+		void Save();
+
+		Statistics GetStatistics() const;
+
+		D3D12PipelineCache(const D3D12PipelineCache&) = delete;
+		D3D12PipelineCache& operator=(const D3D12PipelineCache&) = delete;
+	};
+}
+
+#endif // !ULTREALITY_RENDERING_D3D12_PIPELINE_CACHE_H
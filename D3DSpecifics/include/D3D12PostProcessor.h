@@ -0,0 +1,155 @@
+#ifndef ULTREALITY_RENDERING_D3D12_POST_PROCESSOR_H
+#define ULTREALITY_RENDERING_D3D12_POST_PROCESSOR_H
+
+#include <stdint.h>
+#include <unordered_map>
+#include <vector>
+
+#include <wrl.h>
+#include <d3d12.h>
+
+#include <PostProcessPlanner.h>
+#include <ShaderCompiler.h>
+#include <D3D12UploadRing.h>
+#include <D3D12DescriptorRing.h>
+#include <D3D12RenderGraph.h>
+
+namespace UltReality::Rendering::D3D12
+{
+	/// <summary>
+	/// Post-processing chain recorded into the frame graph. Runs the passes of a <see cref="Common::PostProcessPlan"/>:
+	/// the shared downsample pyramid, the exposure reduction and the bloom upsamples as compute passes, and every group
+	/// of fused effects as one pass over the image. Fused effects are compiled into a single shader per combination the
+	/// first time a plan uses it. The pass writing the output draws a full screen triangle, so the output only has to be
+	/// a render target. Pyramid levels and intermediates are transient textures of the graph, which pools their memory
+	/// across frames and aliases targets whose lifetimes do not overlap
+	/// </summary>
+	class D3D12PostProcessor
+	{
+	public:
+		// HLSL of every post-processing pass
+		static const char* const shaderSource;
+		// Format of the scene color, the pyramid and the intermediates
+		static constexpr DXGI_FORMAT colorFormat = DXGI_FORMAT_R16G16B16A16_FLOAT;
+
+	private:
+		// Mirrors the constant buffer of <see cref="shaderSource"/>
+		struct PassConstants
+		{
+			uint32_t outputSize[2];
+			float bloomWeight;
+			float bloomIntensity;
+			float exposureScale;
+			float adaptation;
+			float saturation;
+			float contrast;
+			float colorFilter[3];
+			float vignetteStrength;
+			float chromaticAberration;
+			float sharpenStrength;
+			float filmGrainStrength;
+			uint32_t frameIndex;
+			// Maps output UVs onto the drawn part of the source and clamps them half a texel inside it
+			float sourceUVScale[2];
+			float sourceUVMax[2];
+		};
+
+		// Graph resources and pipeline of one pass, captured by its callback
+		struct PassResources
+		{
+			ID3D12PipelineState* pipeline = nullptr;
+			// Whether the pass draws into the output instead of dispatching
+			bool drawsOutput = false;
+			Common::RenderGraphResource input = Common::invalidRenderGraphResource;
+			// Pyramid level an upsample adds to, or the bloom a fused pass blends in
+			Common::RenderGraphResource auxiliary = Common::invalidRenderGraphResource;
+			Common::RenderGraphResource exposureRead = Common::invalidRenderGraphResource;
+			Common::RenderGraphResource exposureWrite = Common::invalidRenderGraphResource;
+			Common::RenderGraphResource output = Common::invalidRenderGraphResource;
+			D3D12_CPU_DESCRIPTOR_HANDLE outputRtv = {};
+			PassConstants constants = {};
+		};
+
+		ID3D12Device* m_device;
+		Common::IShaderCompiler* m_compiler;
+		Common::IShaderIncludeResolver* m_includeResolver;
+		D3D12UploadRing* m_uploadRing;
+		D3D12DescriptorRing* m_descriptorRing;
+		DXGI_FORMAT m_outputFormat;
+
+		Microsoft::WRL::ComPtr<ID3D12RootSignature> m_rootSignature;
+		Microsoft::WRL::ComPtr<ID3D12PipelineState> m_downsamplePipeline;
+		Microsoft::WRL::ComPtr<ID3D12PipelineState> m_upsamplePipeline;
+		Microsoft::WRL::ComPtr<ID3D12PipelineState> m_exposurePipeline;
+		std::vector<uint8_t> m_fullscreenVertexShader;
+		// Fused pipelines by their effects, dispatched into an intermediate or drawn into the output
+		std::unordered_map<uint32_t, Microsoft::WRL::ComPtr<ID3D12PipelineState>> m_fusedComputePipelines;
+		std::unordered_map<uint32_t, Microsoft::WRL::ComPtr<ID3D12PipelineState>> m_fusedOutputPipelines;
+
+		// Adapted exposure, kept in unordered access between frames
+		Microsoft::WRL::ComPtr<ID3D12Resource> m_exposure;
+
+		Common::PostProcessConfig m_config;
+		Common::PostProcessPlan m_plan;
+		uint32_t m_planWidth = 0;
+		uint32_t m_planHeight = 0;
+		bool m_planDirty = true;
+		uint32_t m_frameIndex = 0;
+
+		std::vector<uint8_t> CompileShader(const char* entryPoint, const char* target, Common::PostEffect effects) const;
+
+		Microsoft::WRL::ComPtr<ID3D12PipelineState> CreateComputePipeline(const char* entryPoint, Common::PostEffect effects) const;
+
+		ID3D12PipelineState* GetFusedPipeline(Common::PostEffect effects, bool drawsOutput);
+
+		void RecordPass(ID3D12GraphicsCommandList* cmdList, const D3D12RenderGraph& graph, const PassResources& resources);
+
+	public:
+		/// <summary>
+		/// Compiles the pyramid and exposure passes and creates the exposure texture
+		/// </summary>
+		/// <param name="device">Device to create the pipelines on. Must outlive the post processor</param>
+		/// <param name="compiler">Compiler the passes are built with. Must outlive the post processor</param>
+		/// <param name="includeResolver">Resolver of the compiler. Must outlive the post processor</param>
+		/// <param name="uploadRing">Ring the pass constants are uploaded to. Must outlive the post processor</param>
+		/// <param name="descriptorRing">Shader visible ring the descriptor tables of the passes are written to. Must outlive the post processor</param>
+		/// <param name="outputFormat">Render target format of the output</param>
+		D3D12PostProcessor(ID3D12Device* device, Common::IShaderCompiler* compiler, Common::IShaderIncludeResolver* includeResolver,
+			D3D12UploadRing* uploadRing, D3D12DescriptorRing* descriptorRing, DXGI_FORMAT outputFormat);
+
+		/// <summary>
+		/// Replaces the effects and their parameters. The plan is rebuilt by the next <see cref="AddPasses"/>
+		/// </summary>
+		/// <exception cref="std::invalid_argument">Thrown if the config is invalid</exception>
+		void SetConfig(const Common::PostProcessConfig& config);
+
+		const Common::PostProcessConfig& GetConfig() const;
+
+		/// <summary>
+		/// Adds the passes of the chain to the graph. Pipelines of effect combinations not used before are compiled here.
+		/// The passes reading the scene color upscale the part it was drawn into to the output size
+		/// </summary>
+		/// <param name="graph">Graph being built for the frame. Must stay alive until it was executed</param>
+		/// <param name="sceneColor">Scene color in <see cref="colorFormat"/>, read by the first passes</param>
+		/// <param name="output">Target the last pass draws into</param>
+		/// <param name="outputRtv">Render target view of <paramref name="output"/></param>
+		/// <param name="width">Width of the scene color and the output</param>
+		/// <param name="height">Height of the scene color and the output</param>
+		/// <param name="sourceWidth">Width of the top left part of the scene color the scene was drawn into</param>
+		/// <param name="sourceHeight">Height of the top left part of the scene color the scene was drawn into</param>
+		/// <param name="deltaTime">Seconds since the previous frame, the exposure adapts over them</param>
+		/// <exception cref="std::invalid_argument">Thrown if the drawn part is empty or larger than the scene color</exception>
+		void AddPasses(D3D12RenderGraph& graph, Common::RenderGraphResource sceneColor, Common::RenderGraphResource output,
+			D3D12_CPU_DESCRIPTOR_HANDLE outputRtv, uint32_t width, uint32_t height, uint32_t sourceWidth, uint32_t sourceHeight, float deltaTime);
+
+		/// <summary>
+		/// Gets the plan of the last <see cref="AddPasses"/>
+		/// </summary>
+		const Common::PostProcessPlan& GetPlan() const;
+
+		D3D12PostProcessor(const D3D12PostProcessor&) = delete;
+		D3D12PostProcessor& operator=(const D3D12PostProcessor&) = delete;
+	};
+}
+
+#endif // !ULTREALITY_RENDERING_D3D12_POST_PROCESSOR_H
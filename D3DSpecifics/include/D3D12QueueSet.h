@@ -0,0 +1,89 @@
+#ifndef ULTREALITY_RENDERING_D3D12_QUEUE_SET_H
+#define ULTREALITY_RENDERING_D3D12_QUEUE_SET_H
+
+#include <stdint.h>
+#include <array>
+#include <memory>
+#include <vector>
+
+#include <wrl.h>
+#include <d3d12.h>
+
+#include <QueueScheduler.h>
+#include <D3D12FenceTimeline.h>
+
+namespace UltReality::Rendering::D3D12
+{
+	/// <summary>
+	/// The graphics, compute and copy queues of a device, each with its own fence timeline. Submissions are collected
+	/// with their dependencies and executed by <see cref="Flush"/>, which inserts the cross-queue waits and signals
+	/// derived by a <see cref="Common::QueueScheduler"/>
+	/// </summary>
+	class D3D12QueueSet
+	{
+	private:
+		struct Queue
+		{
+			Microsoft::WRL::ComPtr<ID3D12CommandQueue> queue;
+			// Only set for the queues the set created, the graphics fence belongs to the renderer
+			Microsoft::WRL::ComPtr<ID3D12Fence> fence;
+			std::unique_ptr<D3D12FenceTimeline> ownedTimeline;
+			D3D12FenceTimeline* timeline = nullptr;
+		};
+
+		std::array<Queue, Common::queueTypeCount> m_queues;
+
+		Common::QueueScheduler m_scheduler;
+		// Command lists of every pending submission, indexed like the scheduler's submissions
+		std::vector<std::vector<ID3D12CommandList*>> m_submissionLists;
+		// Fence value each submission signalled, 0 if it did not signal
+		std::vector<uint64_t> m_signalValues;
+
+		Queue& QueueOf(Common::QueueType type);
+		const Queue& QueueOf(Common::QueueType type) const;
+
+	public:
+		/// <summary>
+		/// Creates the compute and copy queues and adopts the renderer's graphics queue
+		/// </summary>
+		/// <param name="device">Device to create the queues on</param>
+		/// <param name="graphicsQueue">Direct queue of the renderer</param>
+		/// <param name="graphicsTimeline">Fence timeline of <paramref name="graphicsQueue"/>. Must outlive the set</param>
+		D3D12QueueSet(ID3D12Device* device, ID3D12CommandQueue* graphicsQueue, D3D12FenceTimeline* graphicsTimeline);
+
+		/// <summary>
+		/// Queues command lists for execution on <paramref name="queue"/> by the next <see cref="Flush"/>
+		/// </summary>
+		/// <param name="queue">Queue to execute the lists on</param>
+		/// <param name="lists">Closed command lists of a type the queue accepts</param>
+		/// <param name="dependencies">Earlier submissions of this batch whose results the lists consume</param>
+		/// <returns>Index of the submission, to be used as a dependency of later ones</returns>
+		uint32_t Submit(Common::QueueType queue, const std::vector<ID3D12CommandList*>& lists, const std::vector<uint32_t>& dependencies = {});
+
+		/// <summary>
+		/// Executes every pending submission in order. Each queue only waits where a dependency is not already
+		/// guaranteed by an earlier wait, and the graphics queue joins the other queues at the end, so the next fence
+		/// signalled on it covers all work of the batch
+		/// </summary>
+		void Flush();
+
+		/// <summary>
+		/// Gets the indices of the submissions pending for the next <see cref="Flush"/>
+		/// </summary>
+		std::vector<uint32_t> GetPendingSubmissions() const;
+
+		ID3D12CommandQueue* GetQueue(Common::QueueType queue) const;
+
+		D3D12FenceTimeline* GetTimeline(Common::QueueType queue) const;
+
+		/// <summary>
+		/// Blocks until every queue finished the work submitted to it
+		/// </summary>
+		void WaitForIdle();
+
+		D3D12QueueSet(const D3D12QueueSet&) = delete;
+		D3D12QueueSet& operator=(const D3D12QueueSet&) = delete;
+	};
+}
+
+#endif // !ULTREALITY_RENDERING_D3D12_QUEUE_SET_H
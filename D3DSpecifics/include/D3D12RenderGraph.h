@@ -0,0 +1,180 @@
+#ifndef ULTREALITY_RENDERING_D3D12_RENDER_GRAPH_H
+#define ULTREALITY_RENDERING_D3D12_RENDER_GRAPH_H
+
+#include <stdint.h>
+#include <functional>
+#include <string>
+#include <vector>
+
+#include <wrl.h>
+#include <d3d12.h>
+
+#include <RenderGraph.h>
+#include <DeferredReleaseQueue.h>
+
+namespace UltReality::Rendering::D3D12
+{
+	/// <summary>
+	/// D3D12 backend of <see cref="Common::RenderGraph"/>. Places transient textures in a single heap at the offsets
+	/// chosen by the graph compiler, records the compiled barrier batches and runs the pass callbacks.
+	/// Placed transients are cached between frames as long as their offset and description do not change. The first
+	/// use of a transient in a frame is ordered against the last resource that used its memory, in this frame or an
+	/// earlier one, and render target and depth transients taking over memory are discarded before that use
+	/// </summary>
+	class D3D12RenderGraph
+	{
+	public:
+		// Records the commands of a pass. Barriers for the pass have already been recorded when it is called
+		using PassExecute = std::function<void(ID3D12GraphicsCommandList*)>;
+
+	private:
+		struct ResourceEntry
+		{
+			// Imported resource, or the placed resource of a transient once the graph is compiled
+			ID3D12Resource* resource = nullptr;
+
+			bool transient = false;
+			D3D12_RESOURCE_DESC desc = {};
+			bool hasClearValue = false;
+			D3D12_CLEAR_VALUE clearValue = {};
+		};
+
+		struct PlacedTransient
+		{
+			uint64_t offset;
+			D3D12_RESOURCE_DESC desc;
+			bool hasClearValue;
+			D3D12_CLEAR_VALUE clearValue;
+			Microsoft::WRL::ComPtr<ID3D12Resource> resource;
+			// Occupant id in m_heapHistory
+			uint64_t id;
+			// State the resource was left in by the last graph that used it
+			Common::ResourceState state;
+
+			// Set by PlaceTransients for the current graph: whether the first use needs an aliasing barrier against
+			// the last occupant of an earlier frame (null when unknown or several), and whether it needs a discard
+			bool aliasPreviousFrame = false;
+			ID3D12Resource* aliasBefore = nullptr;
+			bool discard = false;
+		};
+
+		ID3D12Device* m_device;
+		// Heap flags usable for every transient, depends on the resource heap tier
+		D3D12_HEAP_FLAGS m_heapFlags;
+
+		Common::RenderGraph m_graph;
+		std::vector<ResourceEntry> m_resources;
+		std::vector<PassExecute> m_passExecutes;
+
+		Microsoft::WRL::ComPtr<ID3D12Heap> m_transientHeap;
+		uint64_t m_transientHeapSize = 0;
+		std::vector<PlacedTransient> m_placedTransients;
+		// Last occupant of each range of the transient heap as of the previous graph
+		Common::TransientMemoryHistory m_heapHistory;
+		uint64_t m_nextPlacedId = 1;
+
+		// Dropped heaps and resources, kept until the frames using them retire
+		Common::DeferredReleaseQueue<Microsoft::WRL::ComPtr<ID3D12Pageable>> m_retiredObjects;
+
+		void PlaceTransients(const Common::CompiledRenderGraph& compiled);
+
+		void RecordBarrierBatch(const std::vector<Common::RenderGraphBarrier>& barriers, ID3D12GraphicsCommandList* cmdList);
+
+	public:
+		/// <summary>
+		/// Creates an empty graph
+		/// </summary>
+		/// <param name="device">Device transient heaps and resources are created on. Must outlive the graph</param>
+		D3D12RenderGraph(ID3D12Device* device);
+
+		/// <summary>
+		/// Registers a resource owned outside the graph
+		/// </summary>
+		/// <param name="name">Debug name</param>
+		/// <param name="resource">Resource to import. Must stay alive until the frame using the graph retires</param>
+		/// <param name="initialState">State the resource is in when the graph starts</param>
+		/// <param name="finalState">State the graph leaves the resource in</param>
+		Common::RenderGraphResource Import(const std::string& name, ID3D12Resource* resource, Common::ResourceState initialState, Common::ResourceState finalState);
+
+		/// <summary>
+		/// Declares a texture that only lives for the duration of the graph. Its memory may be shared with other
+		/// transients whose lifetimes do not overlap, so its content is undefined until the first pass writing it
+		/// fully clears or overwrites it. Render targets and depth buffers are discarded before that pass whenever
+		/// another resource used their memory, which is all the initialization aliased memory needs
+		/// </summary>
+		/// <param name="name">Debug name</param>
+		/// <param name="desc">Description of the texture</param>
+		/// <param name="clearValue">Optimized clear value, may be null</param>
+		Common::RenderGraphResource CreateTexture(const std::string& name, const D3D12_RESOURCE_DESC& desc, const D3D12_CLEAR_VALUE* clearValue = nullptr);
+
+		/// <summary>
+		/// Adds a pass. Passes execute in the order they are added
+		/// </summary>
+		/// <param name="name">Debug name</param>
+		/// <param name="execute">Callback recording the pass, may be empty for passes recorded elsewhere</param>
+		/// <param name="hasSideEffects">Keeps the pass even if nothing consumes its output</param>
+		uint32_t AddPass(const std::string& name, PassExecute execute = {}, bool hasSideEffects = false);
+
+		void Read(uint32_t pass, Common::RenderGraphResource resource, Common::ResourceState state);
+
+		void Write(uint32_t pass, Common::RenderGraphResource resource, Common::ResourceState state);
+
+		/// <summary>
+		/// Compiles the graph and places every surviving transient in the transient heap, growing it if needed
+		/// </summary>
+		const Common::CompiledRenderGraph& Compile();
+
+		/// <summary>
+		/// Records the barrier batch that precedes compiled pass <paramref name="compiledPassIndex"/>
+		/// </summary>
+		void RecordPassBarriers(uint32_t compiledPassIndex, ID3D12GraphicsCommandList* cmdList);
+
+		/// <summary>
+		/// Records the barriers returning imported resources to their final state
+		/// </summary>
+		void RecordFinalBarriers(ID3D12GraphicsCommandList* cmdList);
+
+		/// <summary>
+		/// Records the barriers of compiled pass <paramref name="compiledPassIndex"/> and runs its callback
+		/// </summary>
+		void ExecutePass(uint32_t compiledPassIndex, ID3D12GraphicsCommandList* cmdList);
+
+		/// <summary>
+		/// Records every surviving pass with its barriers, followed by the final barriers
+		/// </summary>
+		void Execute(ID3D12GraphicsCommandList* cmdList);
+
+		/// <summary>
+		/// Gets the D3D12 resource behind <paramref name="resource"/>. Transients are only available after <see cref="Compile"/>
+		/// </summary>
+		ID3D12Resource* GetResource(Common::RenderGraphResource resource) const;
+
+		/// <summary>
+		/// Removes every pass and resource so the graph can be rebuilt. Placed transients stay cached
+		/// </summary>
+		void Reset();
+
+		/// <summary>
+		/// Tags every heap and resource dropped since the previous call with <paramref name="fenceValue"/>
+		/// </summary>
+		void FinishFrame(uint64_t fenceValue);
+
+		/// <summary>
+		/// Releases dropped heaps and resources of every frame whose fence value is at or below <paramref name="completedFenceValue"/>
+		/// </summary>
+		void Retire(uint64_t completedFenceValue);
+
+		const Common::RenderGraph& Graph() const;
+
+		/// <summary>
+		/// True when transients may be textures other than render targets and depth buffers. Resource heap tier 1
+		/// hardware only places render target and depth transients
+		/// </summary>
+		bool SupportsNonTargetTransients() const;
+
+		D3D12RenderGraph(const D3D12RenderGraph&) = delete;
+		D3D12RenderGraph& operator=(const D3D12RenderGraph&) = delete;
+	};
+}
+
+#endif // !ULTREALITY_RENDERING_D3D12_RENDER_GRAPH_H
@@ -0,0 +1,65 @@
+#ifndef ULTREALITY_RENDERING_D3D12_RESOURCE_STATE_TRACKER_H
+#define ULTREALITY_RENDERING_D3D12_RESOURCE_STATE_TRACKER_H
+
+#include <stdint.h>
+#include <vector>
+
+#include <d3d12.h>
+
+#include <ResourceStateTracker.h>
+
+namespace UltReality::Rendering::D3D12
+{
+	/// <summary>
+	/// D3D12 front end of <see cref="Common::ResourceStateTracker"/>. One instance per command list being recorded.
+	/// Queued barriers are recorded with a single ResourceBarrier call per flush
+	/// </summary>
+	class D3D12ResourceStateTracker
+	{
+	private:
+		Common::ResourceStateTracker m_tracker;
+
+		// Scratch storage reused between flushes
+		std::vector<Common::TrackedBarrier> m_trackedBarriers;
+		std::vector<D3D12_RESOURCE_BARRIER> m_d3dBarriers;
+
+		void RecordTrackedBarriers(ID3D12GraphicsCommandList* cmdList);
+
+	public:
+		/// <summary>
+		/// Gets the key <paramref name="resource"/> is tracked under in a <see cref="Common::ResourceStateTable"/>
+		/// </summary>
+		static Common::TrackedResource Key(ID3D12Resource* resource);
+
+		void Transition(ID3D12Resource* resource, Common::ResourceState state);
+
+		void BeginTransition(ID3D12Resource* resource, Common::ResourceState state);
+
+		void EndTransition(ID3D12Resource* resource);
+
+		void UAVBarrier(ID3D12Resource* resource);
+
+		/// <summary>
+		/// Records every queued barrier into <paramref name="cmdList"/> as one batch
+		/// </summary>
+		void FlushBarriers(ID3D12GraphicsCommandList* cmdList);
+
+		/// <summary>
+		/// Records the barriers that bring every resource used by the tracked list from its committed state into the
+		/// state the list expects. <paramref name="cmdList"/> has to execute right before the tracked list
+		/// </summary>
+		/// <returns>True if any barrier was recorded</returns>
+		bool RecordPendingBarriers(const Common::ResourceStateTable& table, ID3D12GraphicsCommandList* cmdList);
+
+		/// <summary>
+		/// Writes the final state of every resource used by the tracked list to <paramref name="table"/>
+		/// </summary>
+		void Commit(Common::ResourceStateTable& table) const;
+
+		void Reset();
+
+		const Common::ResourceStateTracker& Tracker() const;
+	};
+}
+
+#endif // !ULTREALITY_RENDERING_D3D12_RESOURCE_STATE_TRACKER_H
@@ -0,0 +1,154 @@
+#ifndef ULTREALITY_RENDERING_D3D12_TEXTURE_STREAMER_H
+#define ULTREALITY_RENDERING_D3D12_TEXTURE_STREAMER_H
+
+#include <stdint.h>
+#include <functional>
+#include <vector>
+
+#include <wrl.h>
+#include <d3d12.h>
+
+#include <StreamingUploader.h>
+#include <TextureStreaming.h>
+#include <DeferredReleaseQueue.h>
+#include <D3D12DescriptorAllocator.h>
+
+namespace UltReality::Rendering::D3D12
+{
+	/// <summary>
+	/// Streams the mips of reserved 2D textures in and out as decided by a <see cref="Common::TextureStreamingManager"/>.
+	/// Every standard mip is backed by a heap of its own that is mapped when the mip streams in and released when it is
+	/// evicted, the packed mips form the tail that stays resident. The shader resource view of a texture clamps
+	/// sampling to its resident mips
+	/// </summary>
+	class D3D12TextureStreamer
+	{
+	public:
+		/// <summary>
+		/// Writes the texels of one subresource into staging memory laid out as <paramref name="footprint"/>.
+		/// Runs on the uploader thread
+		/// </summary>
+		using MipWriter = std::function<void(uint32_t mip, uint8_t* staging, const D3D12_SUBRESOURCE_FOOTPRINT& footprint)>;
+
+	private:
+		struct Texture
+		{
+			Microsoft::WRL::ComPtr<ID3D12Resource> resource;
+			MipWriter writer;
+			DXGI_FORMAT format = DXGI_FORMAT_UNKNOWN;
+			uint32_t mipLevels = 0;
+			// Streaming mip the tail starts at, every D3D mip from there on belongs to the tail
+			uint32_t tailMip = 0;
+			std::vector<D3D12_SUBRESOURCE_TILING> tilings;
+			D3D12_PACKED_MIP_INFO packedMipInfo = {};
+			// One heap per streaming mip, null while the mip is not resident
+			std::vector<Microsoft::WRL::ComPtr<ID3D12Heap>> mipHeaps;
+			D3D12DescriptorAllocation srv;
+			// Upload of the tail, the texture may only be sampled once it completed
+			Common::UploadTicket tailTicket = 0;
+			// Load in flight, 0 if none
+			Common::UploadTicket loadTicket = 0;
+			uint32_t loadMip = 0;
+		};
+
+		// Memory of a destroyed texture whose uploads were still in flight on the copy queue
+		struct UploadingMemory
+		{
+			// Last upload into the resource, tickets complete in order so the earlier ones are done once it is
+			Common::UploadTicket ticket;
+			// The resource first, then the heaps mapped into it
+			std::vector<Microsoft::WRL::ComPtr<ID3D12Pageable>> memory;
+		};
+
+		ID3D12Device* m_device;
+		// Queue the tile mappings are updated on. The uploads run on it too, so a mip is mapped before it is written
+		ID3D12CommandQueue* m_copyQueue;
+		Common::StreamingUploader* m_uploader;
+		D3D12CPUDescriptorAllocator* m_srvAllocator;
+
+		Common::TextureStreamingManager m_manager;
+		// Indexed like the manager's textures
+		std::vector<Texture> m_textures;
+
+		// Heaps of evicted mips and the resources of destroyed textures, kept until the GPU is done with them
+		Common::DeferredReleaseQueue<Microsoft::WRL::ComPtr<ID3D12Pageable>> m_retiredMemory;
+		// Destroyed textures the copy queue may still write, handed to m_retiredMemory once their last upload completed
+		std::vector<UploadingMemory> m_uploadingMemory;
+
+		uint64_t TileBytes(const Texture& texture, uint32_t mip) const;
+
+		void MapMip(Texture& texture, uint32_t mip);
+
+		Common::UploadTicket UploadMip(Texture& texture, uint32_t mip);
+
+		void UpdateSrv(uint32_t index);
+
+	public:
+		/// <summary>
+		/// Creates a streamer that keeps texture memory within <paramref name="budgetBytes"/>
+		/// </summary>
+		/// <param name="device">Device the textures are created on. Must outlive the streamer</param>
+		/// <param name="copyQueue">Queue the uploader executes on. Must outlive the streamer</param>
+		/// <param name="uploader">Uploader the mips are written with. Must outlive the streamer</param>
+		/// <param name="srvAllocator">Allocator of the textures' shader resource views. Must outlive the streamer</param>
+		/// <param name="budgetBytes">Initial texture memory budget</param>
+		D3D12TextureStreamer(ID3D12Device* device, ID3D12CommandQueue* copyQueue, Common::StreamingUploader* uploader,
+			D3D12CPUDescriptorAllocator* srvAllocator, uint64_t budgetBytes);
+
+		/// <summary>
+		/// Creates a reserved texture and starts uploading its tail
+		/// </summary>
+		/// <param name="desc">Description of a 2D texture with a single array slice</param>
+		/// <param name="writer">Provides the texels of every mip on demand</param>
+		/// <returns>Texture index for the other methods</returns>
+		/// <exception cref="std::invalid_argument">Thrown if <paramref name="desc"/> is not a single 2D texture</exception>
+		uint32_t CreateTexture(const D3D12_RESOURCE_DESC& desc, MipWriter writer);
+
+		/// <summary>
+		/// Stops streaming a texture without waiting for its uploads. Its memory is released once its last upload
+		/// completed on the copy queue and the frames that may have sampled it retired
+		/// </summary>
+		void DestroyTexture(uint32_t texture);
+
+		/// <summary>
+		/// Reports that a texture was drawn covering <paramref name="screenPixels"/> pixels along its longer axis this frame
+		/// </summary>
+		void ReportFootprint(uint32_t texture, float screenPixels);
+
+		/// <summary>
+		/// Completes the loads that finished uploading, then issues the loads and evictions of the manager's next plan.
+		/// Call once per frame before the frame's descriptors are copied
+		/// </summary>
+		void Update();
+
+		/// <summary>
+		/// Tags the memory released this frame with <paramref name="fenceValue"/>
+		/// </summary>
+		void FinishFrame(uint64_t fenceValue);
+
+		/// <summary>
+		/// Releases the memory of every frame whose fence value is at or below <paramref name="completedFenceValue"/>, and
+		/// queues the memory of destroyed textures whose uploads completed for release with the current frame
+		/// </summary>
+		void Retire(uint64_t completedFenceValue);
+
+		/// <summary>
+		/// Checks whether the tail of a texture has been uploaded, so it can be sampled
+		/// </summary>
+		bool IsReady(uint32_t texture);
+
+		/// <summary>
+		/// Gets the shader resource view of a texture, clamped to its resident mips
+		/// </summary>
+		D3D12_CPU_DESCRIPTOR_HANDLE GetSrv(uint32_t texture) const;
+
+		ID3D12Resource* GetResource(uint32_t texture) const;
+
+		Common::TextureStreamingManager& Manager();
+
+		D3D12TextureStreamer(const D3D12TextureStreamer&) = delete;
+		D3D12TextureStreamer& operator=(const D3D12TextureStreamer&) = delete;
+	};
+}
+
+#endif // !ULTREALITY_RENDERING_D3D12_TEXTURE_STREAMER_H
@@ -0,0 +1,86 @@
+#ifndef ULTREALITY_RENDERING_D3D12_UPLOAD_QUEUE_H
+#define ULTREALITY_RENDERING_D3D12_UPLOAD_QUEUE_H
+
+#include <stdint.h>
+#include <deque>
+#include <vector>
+
+#include <wrl.h>
+#include <d3d12.h>
+
+#include <StreamingUploader.h>
+
+namespace UltReality::Rendering::D3D12
+{
+	/// <summary>
+	/// <see cref="Common::IUploadQueue"/> on a copy queue. Owns the staging buffer and a fence of its own, so the
+	/// uploader thread never shares a fence timeline with the render thread
+	/// </summary>
+	class D3D12UploadQueue final : public Common::IUploadQueue
+	{
+	private:
+		struct RetiringAllocator
+		{
+			Microsoft::WRL::ComPtr<ID3D12CommandAllocator> allocator;
+			uint64_t fenceValue;
+		};
+
+		ID3D12Device* m_device;
+		ID3D12CommandQueue* m_queue;
+
+		Microsoft::WRL::ComPtr<ID3D12Resource> m_stagingBuffer;
+		uint8_t* m_mappedData = nullptr;
+		uint64_t m_stagingCapacity;
+
+		Microsoft::WRL::ComPtr<ID3D12Fence> m_fence;
+		uint64_t m_fenceValue = 0;
+
+		// Allocators of submitted batches, reused once their fence completed
+		std::deque<RetiringAllocator> m_allocators;
+		// Allocator of the open batch
+		Microsoft::WRL::ComPtr<ID3D12CommandAllocator> m_openAllocator;
+		Microsoft::WRL::ComPtr<ID3D12GraphicsCommandList> m_commandList;
+		bool m_recording = false;
+
+		void OpenBatch();
+
+	public:
+		/// <summary>
+		/// Creates and maps a staging buffer of <paramref name="stagingCapacity"/> bytes
+		/// </summary>
+		/// <param name="device">Device the objects are created on. Must outlive the queue</param>
+		/// <param name="copyQueue">Copy queue the batches are executed on. Must outlive the queue</param>
+		/// <param name="stagingCapacity">Size in bytes of the staging buffer</param>
+		D3D12UploadQueue(ID3D12Device* device, ID3D12CommandQueue* copyQueue, uint64_t stagingCapacity);
+		~D3D12UploadQueue();
+
+		uint8_t* GetStagingMemory() override;
+
+		uint64_t GetStagingCapacity() const override;
+
+		void RecordCopy(const Common::UploadCopy& copy) override;
+
+		uint64_t SubmitBatch() override;
+
+		uint64_t GetCompletedValue() const override;
+
+		/// <summary>
+		/// Blocks until the fence reaches <paramref name="value"/>. Uses an event per call, so several threads may wait at once
+		/// </summary>
+		void WaitForValue(uint64_t value) override;
+
+		/// <summary>
+		/// Builds a request that uploads one subresource of a texture. Rows are repacked to the pitch the copy queue expects
+		/// </summary>
+		/// <param name="texture">Destination texture. Must be in the COMMON state when the copy executes</param>
+		/// <param name="subresource">Destination subresource</param>
+		/// <param name="data">Tightly or loosely packed texel rows of the subresource</param>
+		/// <param name="rowPitch">Distance in bytes between the rows in <paramref name="data"/></param>
+		Common::UploadRequest CreateTextureRequest(ID3D12Resource* texture, uint32_t subresource, std::vector<uint8_t> data, uint64_t rowPitch) const;
+
+		D3D12UploadQueue(const D3D12UploadQueue&) = delete;
+		D3D12UploadQueue& operator=(const D3D12UploadQueue&) = delete;
+	};
+}
+
+#endif // !ULTREALITY_RENDERING_D3D12_UPLOAD_QUEUE_H
@@ -0,0 +1,113 @@
+#ifndef ULTREALITY_RENDERING_D3D12_UPLOAD_RING_H
+#define ULTREALITY_RENDERING_D3D12_UPLOAD_RING_H
+
+#include <stdint.h>
+#include <deque>
+#include <vector>
+
+#include <wrl.h>
+#include <d3d12.h>
+
+#include <LinearRingAllocator.h>
+
+namespace UltReality::Rendering::D3D12
+{
+	/// <summary>
+	/// Slice of upload memory handed out by <see cref="D3D12UploadRing"/>. Valid until the frame it was allocated in is retired
+	/// </summary>
+	struct UploadAllocation
+	{
+		// CPU write address of the slice
+		uint8_t* cpuAddress = nullptr;
+		// GPU virtual address of the slice, usable directly as a root CBV/SRV
+		D3D12_GPU_VIRTUAL_ADDRESS gpuAddress = 0;
+		// Resource the slice lives in
+		ID3D12Resource* resource = nullptr;
+		// Offset of the slice inside <see cref="resource"/>
+		uint64_t offset = 0;
+		// Size in bytes of the slice
+		uint64_t size = 0;
+	};
+
+	/// <summary>
+	/// Single persistently mapped UPLOAD buffer that hands out per-frame slices with bump-pointer allocation.
+	/// Slices are reclaimed once the fence of the frame they were allocated in retires. Requests that do not fit
+	/// fall back to a dedicated buffer that is kept alive until the same fence retires
+	/// </summary>
+	class D3D12UploadRing
+	{
+	private:
+		struct OverflowBuffer
+		{
+			Microsoft::WRL::ComPtr<ID3D12Resource> resource;
+			uint64_t fenceValue;
+		};
+
+		ID3D12Device* m_device;
+
+		Microsoft::WRL::ComPtr<ID3D12Resource> m_ringBuffer;
+		uint8_t* m_mappedData = nullptr;
+		D3D12_GPU_VIRTUAL_ADDRESS m_gpuBaseAddress = 0;
+
+		Common::LinearRingAllocator m_allocator;
+
+		// Overflow buffers created during the current frame
+		std::vector<Microsoft::WRL::ComPtr<ID3D12Resource>> m_frameOverflowBuffers;
+		// Overflow buffers of finished frames waiting on their fence
+		std::deque<OverflowBuffer> m_retiringOverflowBuffers;
+
+		UploadAllocation AllocateOverflow(uint64_t size);
+
+	public:
+		/// <summary>
+		/// Creates and maps an upload ring of <paramref name="capacity"/> bytes
+		/// </summary>
+		D3D12UploadRing(ID3D12Device* device, uint64_t capacity);
+		~D3D12UploadRing();
+
+		/// <summary>
+		/// Allocates a slice of <paramref name="size"/> bytes aligned to <paramref name="alignment"/>
+		/// </summary>
+		/// <returns>The slice, or an empty allocation with null addresses if <paramref name="size"/> is 0</returns>
+		UploadAllocation Allocate(uint64_t size, uint64_t alignment);
+
+		/// <summary>
+		/// Allocates a slice for constant buffer data, padded to a multiple of 256 bytes and placed on a 256 byte boundary
+		/// </summary>
+		UploadAllocation AllocateConstants(uint32_t size);
+
+		/// <summary>
+		/// Copies <paramref name="data"/> into a new constant buffer slice
+		/// </summary>
+		/// <returns>GPU virtual address for binding the data as a root CBV</returns>
+		template<typename T>
+		D3D12_GPU_VIRTUAL_ADDRESS PushConstants(const T& data);
+
+		/// <summary>
+		/// Copies <paramref name="count"/> contiguous elements into a new slice with a single copy
+		/// </summary>
+		template<typename T>
+		UploadAllocation PushArray(const T* data, uint32_t count, uint64_t alignment = alignof(T));
+
+		/// <summary>
+		/// Tags every slice allocated since the previous call with <paramref name="fenceValue"/>
+		/// </summary>
+		void FinishFrame(uint64_t fenceValue);
+
+		/// <summary>
+		/// Reclaims the slices of every frame whose fence value is at or below <paramref name="completedFenceValue"/>
+		/// </summary>
+		void Retire(uint64_t completedFenceValue);
+
+		ID3D12Resource* Resource() const;
+
+		const Common::LinearRingAllocator& Allocator() const;
+
+		D3D12UploadRing(const D3D12UploadRing&) = delete;
+		D3D12UploadRing& operator=(const D3D12UploadRing&) = delete;
+	};
+}
+
+#include <D3D12UploadRing.inl>
+
+#endif // !ULTREALITY_RENDERING_D3D12_UPLOAD_RING_H
@@ -2,10 +2,12 @@
 #define ULTREALITY_RENDERING_D3D12_UTILITIES_H
 
 #include <Windows.h>
+#include <d3d12.h>
 
 #include <stdint.h>
 
 #include <D3DException.h>
+#include <ResourceState.h>
 
 namespace UltReality::Rendering::D3D12
 {
@@ -14,6 +16,11 @@ namespace UltReality::Rendering::D3D12
 	struct D3D12Utilities
 	{
 		static uint32_t CalcConstantBufferSize(uint32_t bytes);
+
+		/// <summary>
+		/// Converts backend neutral resource states to their D3D12 equivalent
+		/// </summary>
+		static D3D12_RESOURCE_STATES ToD3D12States(Common::ResourceState state);
 	};
 }
 
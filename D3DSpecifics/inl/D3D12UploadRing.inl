@@ -0,0 +1,46 @@
+#ifndef ULTREALITY_RENDERING_D3D12_UPLOAD_RING_INL
+#define ULTREALITY_RENDERING_D3D12_UPLOAD_RING_INL
+
+#include <string.h>
+
+#if defined(__GNUC__) or defined(__clang__)
+#define FORCE_INLINE inline __attribute__((always_inline))
+#elif defined(_MSC_VER)
+#define FORCE_INLINE __forceinline
+#else
+#define FORCE_INLINE inline
+#endif
+
+namespace UltReality::Rendering::D3D12
+{
+	template<typename T>
+	FORCE_INLINE D3D12_GPU_VIRTUAL_ADDRESS D3D12UploadRing::PushConstants(const T& data)
+	{
+		UploadAllocation allocation = AllocateConstants(sizeof(T));
+		memcpy(allocation.cpuAddress, &data, sizeof(T));
+
+		return allocation.gpuAddress;
+	}
+
+	template<typename T>
+	FORCE_INLINE UploadAllocation D3D12UploadRing::PushArray(const T* data, uint32_t count, uint64_t alignment)
+	{
+		UploadAllocation allocation = Allocate(static_cast<uint64_t>(sizeof(T)) * count, alignment);
+		if (count != 0)
+			memcpy(allocation.cpuAddress, data, sizeof(T) * count);
+
+		return allocation;
+	}
+
+	FORCE_INLINE ID3D12Resource* D3D12UploadRing::Resource() const
+	{
+		return m_ringBuffer.Get();
+	}
+
+	FORCE_INLINE const Common::LinearRingAllocator& D3D12UploadRing::Allocator() const
+	{
+		return m_allocator;
+	}
+}
+
+#endif // !ULTREALITY_RENDERING_D3D12_UPLOAD_RING_INL
@@ -9,6 +9,8 @@
 #define FORCE_INLINE inline
 #endif
 
+#include <utility>
+
 namespace UltReality::Rendering::D3D12
 {
     FORCE_INLINE void ThrowIfFailed(HRESULT hr, const char* file, uint32_t line)
@@ -34,6 +36,36 @@ namespace UltReality::Rendering::D3D12
         // 512
         return (bytes + 255) & ~255;
 	}
+
+	FORCE_INLINE D3D12_RESOURCE_STATES D3D12Utilities::ToD3D12States(Common::ResourceState state)
+	{
+		using Common::ResourceState;
+
+		constexpr std::pair<ResourceState, D3D12_RESOURCE_STATES> mapping[] = {
+			{ ResourceState::VertexAndConstantBuffer, D3D12_RESOURCE_STATE_VERTEX_AND_CONSTANT_BUFFER },
+			{ ResourceState::IndexBuffer, D3D12_RESOURCE_STATE_INDEX_BUFFER },
+			{ ResourceState::RenderTarget, D3D12_RESOURCE_STATE_RENDER_TARGET },
+			{ ResourceState::UnorderedAccess, D3D12_RESOURCE_STATE_UNORDERED_ACCESS },
+			{ ResourceState::DepthWrite, D3D12_RESOURCE_STATE_DEPTH_WRITE },
+			{ ResourceState::DepthRead, D3D12_RESOURCE_STATE_DEPTH_READ },
+			{ ResourceState::NonPixelShaderResource, D3D12_RESOURCE_STATE_NON_PIXEL_SHADER_RESOURCE },
+			{ ResourceState::PixelShaderResource, D3D12_RESOURCE_STATE_PIXEL_SHADER_RESOURCE },
+			{ ResourceState::IndirectArgument, D3D12_RESOURCE_STATE_INDIRECT_ARGUMENT },
+			{ ResourceState::CopyDest, D3D12_RESOURCE_STATE_COPY_DEST },
+			{ ResourceState::CopySource, D3D12_RESOURCE_STATE_COPY_SOURCE },
+			{ ResourceState::ResolveDest, D3D12_RESOURCE_STATE_RESOLVE_DEST },
+			{ ResourceState::ResolveSource, D3D12_RESOURCE_STATE_RESOLVE_SOURCE }
+		};
+
+		D3D12_RESOURCE_STATES d3dState = D3D12_RESOURCE_STATE_COMMON;
+		for (const auto& [common, d3d] : mapping)
+		{
+			if ((state & common) == common)
+				d3dState |= d3d;
+		}
+
+		return d3dState;
+	}
 }
 
 #endif // !ULTREALITY_RENDERING_D3D12_UTILITIES_INL
@@ -0,0 +1,148 @@
+#include <directx/d3dx12.h>
+
+#include <stdexcept>
+#include <string>
+
+#include <D3D12BindlessTable.h>
+#include <D3D12Utilities.h>
+
+using namespace Microsoft::WRL;
+
+namespace UltReality::Rendering::D3D12
+{
+	D3D12BindlessTable::D3D12BindlessTable(ID3D12Device* device, ID3D12DescriptorHeap* heap, uint32_t baseIndex, uint32_t count, uint32_t descriptorSize)
+		: m_device(device), m_heap(heap), m_descriptorSize(descriptorSize), m_allocator(count)
+	{
+		m_cpuBase = heap->GetCPUDescriptorHandleForHeapStart();
+		m_cpuBase.ptr += static_cast<SIZE_T>(baseIndex) * descriptorSize;
+
+		m_gpuBase = heap->GetGPUDescriptorHandleForHeapStart();
+		m_gpuBase.ptr += static_cast<UINT64>(baseIndex) * descriptorSize;
+	}
+
+	D3D12_CPU_DESCRIPTOR_HANDLE D3D12BindlessTable::CpuHandle(uint32_t index) const
+	{
+		return D3D12_CPU_DESCRIPTOR_HANDLE{ m_cpuBase.ptr + static_cast<SIZE_T>(index) * m_descriptorSize };
+	}
+
+	Common::BindlessHandle D3D12BindlessTable::CreateSrv(ID3D12Resource* resource, const D3D12_SHADER_RESOURCE_VIEW_DESC* desc)
+	{
+		// Only slots no frame in flight can read are handed out, so they can be written directly
+		const Common::BindlessHandle handle = m_allocator.Allocate();
+		m_device->CreateShaderResourceView(resource, desc, CpuHandle(handle.index));
+
+		return handle;
+	}
+
+	Common::BindlessHandle D3D12BindlessTable::CreateUav(ID3D12Resource* resource, const D3D12_UNORDERED_ACCESS_VIEW_DESC* desc, ID3D12Resource* counter)
+	{
+		const Common::BindlessHandle handle = m_allocator.Allocate();
+		m_device->CreateUnorderedAccessView(resource, counter, desc, CpuHandle(handle.index));
+
+		return handle;
+	}
+
+	Common::BindlessHandle D3D12BindlessTable::CreateCbv(const D3D12_CONSTANT_BUFFER_VIEW_DESC& desc)
+	{
+		const Common::BindlessHandle handle = m_allocator.Allocate();
+		m_device->CreateConstantBufferView(&desc, CpuHandle(handle.index));
+
+		return handle;
+	}
+
+	Common::BindlessHandle D3D12BindlessTable::CopyDescriptor(D3D12_CPU_DESCRIPTOR_HANDLE source)
+	{
+		const Common::BindlessHandle handle = m_allocator.Allocate();
+		m_device->CopyDescriptorsSimple(1, CpuHandle(handle.index), source, D3D12_DESCRIPTOR_HEAP_TYPE_CBV_SRV_UAV);
+
+		return handle;
+	}
+
+	void D3D12BindlessTable::Free(Common::BindlessHandle handle)
+	{
+		m_allocator.Free(handle);
+	}
+
+	uint32_t D3D12BindlessTable::GetShaderIndex(Common::BindlessHandle handle) const
+	{
+		return m_allocator.Resolve(handle);
+	}
+
+	D3D12_GPU_DESCRIPTOR_HANDLE D3D12BindlessTable::GpuStart() const
+	{
+		return m_gpuBase;
+	}
+
+	void D3D12BindlessTable::FinishFrame(uint64_t fenceValue)
+	{
+		m_allocator.FinishFrame(fenceValue);
+	}
+
+	void D3D12BindlessTable::Retire(uint64_t completedFenceValue)
+	{
+		m_allocator.Retire(completedFenceValue);
+	}
+
+	const Common::BindlessIndexAllocator& D3D12BindlessTable::Allocator() const
+	{
+		return m_allocator;
+	}
+
+	bool D3D12BindlessTable::IsSupported(ID3D12Device* device)
+	{
+		D3D12_FEATURE_DATA_D3D12_OPTIONS options = {};
+		return SUCCEEDED(device->CheckFeatureSupport(D3D12_FEATURE_D3D12_OPTIONS, &options, sizeof(options)))
+			&& options.ResourceBindingTier >= D3D12_RESOURCE_BINDING_TIER_2;
+	}
+
+	ComPtr<ID3D12RootSignature> D3D12BindlessTable::CreateRootSignature(ID3D12Device* device, const D3D12_STATIC_SAMPLER_DESC* staticSamplers, uint32_t staticSamplerCount)
+	{
+		D3D12_FEATURE_DATA_D3D12_OPTIONS options = {};
+		ThrowIfFailed(device->CheckFeatureSupport(D3D12_FEATURE_D3D12_OPTIONS, &options, sizeof(options)));
+
+		if (options.ResourceBindingTier < D3D12_RESOURCE_BINDING_TIER_2)
+			throw std::runtime_error("Bindless resources require resource binding tier 2");
+
+		// Slots are written while the table is bound and unused ones hold no view, so nothing may be assumed static
+		constexpr D3D12_DESCRIPTOR_RANGE_FLAGS rangeFlags = D3D12_DESCRIPTOR_RANGE_FLAG_DESCRIPTORS_VOLATILE | D3D12_DESCRIPTOR_RANGE_FLAG_DATA_VOLATILE;
+
+		// Every range starts at descriptor 0 in its own register space and covers the whole region
+		CD3DX12_DESCRIPTOR_RANGE1 ranges[3];
+		uint32_t rangeCount = 0;
+		ranges[rangeCount++].Init(D3D12_DESCRIPTOR_RANGE_TYPE_SRV, UINT_MAX, 0, 1, rangeFlags, 0);
+
+		// Tier 2 bounds the number of UAVs and CBVs a table may reach
+		if (options.ResourceBindingTier >= D3D12_RESOURCE_BINDING_TIER_3)
+		{
+			ranges[rangeCount++].Init(D3D12_DESCRIPTOR_RANGE_TYPE_UAV, UINT_MAX, 0, 2, rangeFlags, 0);
+			ranges[rangeCount++].Init(D3D12_DESCRIPTOR_RANGE_TYPE_CBV, UINT_MAX, 0, 3, rangeFlags, 0);
+		}
+
+		CD3DX12_ROOT_PARAMETER1 rootParameters[3];
+		rootParameters[objectConstantsRootParameter].InitAsConstantBufferView(0, 0, D3D12_ROOT_DESCRIPTOR_FLAG_DATA_STATIC_WHILE_SET_AT_EXECUTE);
+		rootParameters[resourceIndicesRootParameter].InitAsConstants(maxResourceIndices, 1, 0);
+		rootParameters[tableRootParameter].InitAsDescriptorTable(rangeCount, ranges);
+
+		CD3DX12_VERSIONED_ROOT_SIGNATURE_DESC rootSignatureDesc;
+		rootSignatureDesc.Init_1_1(_countof(rootParameters), rootParameters, staticSamplerCount, staticSamplers,
+			D3D12_ROOT_SIGNATURE_FLAG_ALLOW_INPUT_ASSEMBLER_INPUT_LAYOUT);
+
+		// Older runtimes only take 1.0 root signatures, the helper converts the flags away for them
+		D3D12_FEATURE_DATA_ROOT_SIGNATURE versionData = {};
+		versionData.HighestVersion = D3D_ROOT_SIGNATURE_VERSION_1_1;
+		if (FAILED(device->CheckFeatureSupport(D3D12_FEATURE_ROOT_SIGNATURE, &versionData, sizeof(versionData))))
+			versionData.HighestVersion = D3D_ROOT_SIGNATURE_VERSION_1_0;
+
+		ComPtr<ID3DBlob> serialized;
+		ComPtr<ID3DBlob> errors;
+		const HRESULT hr = D3DX12SerializeVersionedRootSignature(&rootSignatureDesc, versionData.HighestVersion, serialized.GetAddressOf(), errors.GetAddressOf());
+		if (FAILED(hr) && errors != nullptr)
+			throw std::runtime_error(std::string(static_cast<const char*>(errors->GetBufferPointer()), errors->GetBufferSize()));
+		ThrowIfFailed(hr);
+
+		ComPtr<ID3D12RootSignature> rootSignature;
+		ThrowIfFailed(device->CreateRootSignature(0, serialized->GetBufferPointer(), serialized->GetBufferSize(), IID_PPV_ARGS(rootSignature.GetAddressOf())));
+
+		return rootSignature;
+	}
+}
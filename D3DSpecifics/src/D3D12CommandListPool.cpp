@@ -0,0 +1,70 @@
+#include <D3D12CommandListPool.h>
+#include <D3D12Utilities.h>
+
+using namespace Microsoft::WRL;
+
+namespace UltReality::Rendering::D3D12
+{
+	D3D12CommandListPool::D3D12CommandListPool(ID3D12Device* device, D3D12_COMMAND_LIST_TYPE type, uint32_t workerCount, uint32_t frameCount)
+		: m_device(device), m_type(type), m_workerCount(workerCount), m_frameCount(frameCount)
+	{
+		m_workerFrames.resize(static_cast<size_t>(workerCount) * frameCount);
+		for (WorkerFrame& workerFrame : m_workerFrames)
+		{
+			ThrowIfFailed(m_device->CreateCommandAllocator(
+				m_type,
+				IID_PPV_ARGS(workerFrame.allocator.GetAddressOf())
+			));
+		}
+	}
+
+	void D3D12CommandListPool::BeginFrame(uint32_t frameIndex)
+	{
+		m_frameIndex = frameIndex % m_frameCount;
+
+		for (uint32_t worker = 0; worker < m_workerCount; worker++)
+		{
+			WorkerFrame& workerFrame = m_workerFrames[m_frameIndex * m_workerCount + worker];
+			if (workerFrame.usedLists == 0)
+				continue;
+
+			// Reuse the memory of the commands recorded the last time this slot was used
+			ThrowIfFailed(workerFrame.allocator->Reset());
+			workerFrame.usedLists = 0;
+		}
+	}
+
+	ID3D12GraphicsCommandList* D3D12CommandListPool::Acquire(uint32_t workerIndex, ID3D12PipelineState* initialState)
+	{
+		WorkerFrame& workerFrame = m_workerFrames[m_frameIndex * m_workerCount + workerIndex];
+
+		if (workerFrame.usedLists == workerFrame.lists.size())
+		{
+			// Lists are created open, so the new one is ready for recording
+			ComPtr<ID3D12GraphicsCommandList> list;
+			ThrowIfFailed(m_device->CreateCommandList(
+				0,
+				m_type,
+				workerFrame.allocator.Get(),
+				initialState,
+				IID_PPV_ARGS(list.GetAddressOf())
+			));
+
+			workerFrame.lists.push_back(list);
+			workerFrame.usedLists++;
+
+			return list.Get();
+		}
+
+		// The list was closed at the end of its previous use, so it can be reset onto the allocator
+		ID3D12GraphicsCommandList* list = workerFrame.lists[workerFrame.usedLists++].Get();
+		ThrowIfFailed(list->Reset(workerFrame.allocator.Get(), initialState));
+
+		return list;
+	}
+
+	uint32_t D3D12CommandListPool::GetWorkerCount() const
+	{
+		return m_workerCount;
+	}
+}
@@ -0,0 +1,59 @@
+#include <D3D12DescriptorAllocator.h>
+#include <D3D12Utilities.h>
+
+namespace UltReality::Rendering::D3D12
+{
+	D3D12CPUDescriptorAllocator::D3D12CPUDescriptorAllocator(ID3D12Device* device, D3D12_DESCRIPTOR_HEAP_TYPE type, uint32_t descriptorSize, uint32_t pageSize)
+		: m_device(device), m_type(type), m_descriptorSize(descriptorSize), m_freeList(this, pageSize)
+	{}
+
+	void D3D12CPUDescriptorAllocator::CreatePage(uint32_t pageIndex, uint32_t descriptorCount)
+	{
+		D3D12_DESCRIPTOR_HEAP_DESC heapDesc;
+		heapDesc.NumDescriptors = descriptorCount;
+		heapDesc.Type = m_type;
+		heapDesc.Flags = D3D12_DESCRIPTOR_HEAP_FLAG_NONE;
+		heapDesc.NodeMask = 0;
+
+		Microsoft::WRL::ComPtr<ID3D12DescriptorHeap> heap;
+		ThrowIfFailed(m_device->CreateDescriptorHeap(
+			&heapDesc,
+			IID_PPV_ARGS(heap.GetAddressOf())
+		));
+
+		m_pages.resize(pageIndex + 1);
+		m_pages[pageIndex] = std::move(heap);
+	}
+
+	D3D12DescriptorAllocation D3D12CPUDescriptorAllocator::Allocate(uint32_t count)
+	{
+		D3D12DescriptorAllocation allocation;
+		allocation.range = m_freeList.Allocate(count);
+		allocation.descriptorSize = m_descriptorSize;
+		allocation.cpuStart = m_pages[allocation.range.page]->GetCPUDescriptorHandleForHeapStart();
+		allocation.cpuStart.ptr += static_cast<SIZE_T>(allocation.range.offset) * m_descriptorSize;
+
+		return allocation;
+	}
+
+	void D3D12CPUDescriptorAllocator::Free(D3D12DescriptorAllocation& allocation)
+	{
+		m_freeList.Free(allocation.range);
+		allocation = D3D12DescriptorAllocation();
+	}
+
+	D3D12_DESCRIPTOR_HEAP_TYPE D3D12CPUDescriptorAllocator::Type() const
+	{
+		return m_type;
+	}
+
+	uint32_t D3D12CPUDescriptorAllocator::DescriptorSize() const
+	{
+		return m_descriptorSize;
+	}
+
+	const Common::DescriptorFreeList& D3D12CPUDescriptorAllocator::FreeList() const
+	{
+		return m_freeList;
+	}
+}
@@ -0,0 +1,51 @@
+#include <D3D12DescriptorCopyBatch.h>
+
+namespace UltReality::Rendering::D3D12
+{
+	D3D12DescriptorCopyBatch::D3D12DescriptorCopyBatch(ID3D12Device* device, D3D12_DESCRIPTOR_HEAP_TYPE type)
+		: m_device(device), m_type(type)
+	{}
+
+	void D3D12DescriptorCopyBatch::Add(D3D12_CPU_DESCRIPTOR_HANDLE dest, D3D12_CPU_DESCRIPTOR_HANDLE src, uint32_t count)
+	{
+		m_destStarts.push_back(dest);
+		m_destSizes.push_back(count);
+		m_srcStarts.push_back(src);
+		m_srcSizes.push_back(count);
+	}
+
+	void D3D12DescriptorCopyBatch::AddGather(D3D12_CPU_DESCRIPTOR_HANDLE destStart, const D3D12_CPU_DESCRIPTOR_HANDLE* srcs, uint32_t count)
+	{
+		// One destination range fed by many single-descriptor source ranges
+		m_destStarts.push_back(destStart);
+		m_destSizes.push_back(count);
+
+		for (uint32_t i = 0; i < count; i++)
+		{
+			m_srcStarts.push_back(srcs[i]);
+			m_srcSizes.push_back(1);
+		}
+	}
+
+	void D3D12DescriptorCopyBatch::Flush()
+	{
+		if (m_destStarts.empty())
+			return;
+
+		m_device->CopyDescriptors(
+			static_cast<UINT>(m_destStarts.size()), m_destStarts.data(), m_destSizes.data(),
+			static_cast<UINT>(m_srcStarts.size()), m_srcStarts.data(), m_srcSizes.data(),
+			m_type
+		);
+
+		m_destStarts.clear();
+		m_destSizes.clear();
+		m_srcStarts.clear();
+		m_srcSizes.clear();
+	}
+
+	bool D3D12DescriptorCopyBatch::Empty() const
+	{
+		return m_destStarts.empty();
+	}
+}
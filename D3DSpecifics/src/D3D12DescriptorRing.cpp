@@ -0,0 +1,52 @@
+#include <stdexcept>
+
+#include <D3D12DescriptorRing.h>
+
+namespace UltReality::Rendering::D3D12
+{
+	D3D12DescriptorRing::D3D12DescriptorRing(ID3D12DescriptorHeap* heap, uint32_t baseIndex, uint32_t count, uint32_t descriptorSize)
+		: m_heap(heap), m_descriptorSize(descriptorSize), m_allocator(count)
+	{
+		m_cpuBase = m_heap->GetCPUDescriptorHandleForHeapStart();
+		m_cpuBase.ptr += static_cast<SIZE_T>(baseIndex) * descriptorSize;
+
+		m_gpuBase = m_heap->GetGPUDescriptorHandleForHeapStart();
+		m_gpuBase.ptr += static_cast<UINT64>(baseIndex) * descriptorSize;
+	}
+
+	D3D12DescriptorTable D3D12DescriptorRing::Allocate(uint32_t count)
+	{
+		// Descriptors have no alignment requirement beyond their own slot
+		const uint64_t offset = m_allocator.Allocate(count, 1);
+		if (offset == Common::LinearRingAllocator::invalidOffset)
+			throw std::runtime_error("Shader visible descriptor ring exhausted");
+
+		D3D12DescriptorTable table;
+		table.cpuStart.ptr = m_cpuBase.ptr + static_cast<SIZE_T>(offset) * m_descriptorSize;
+		table.gpuStart.ptr = m_gpuBase.ptr + offset * m_descriptorSize;
+		table.count = count;
+		table.descriptorSize = m_descriptorSize;
+
+		return table;
+	}
+
+	void D3D12DescriptorRing::FinishFrame(uint64_t fenceValue)
+	{
+		m_allocator.FinishFrame(fenceValue);
+	}
+
+	void D3D12DescriptorRing::Retire(uint64_t completedFenceValue)
+	{
+		m_allocator.Retire(completedFenceValue);
+	}
+
+	ID3D12DescriptorHeap* D3D12DescriptorRing::Heap() const
+	{
+		return m_heap;
+	}
+
+	const Common::LinearRingAllocator& D3D12DescriptorRing::Allocator() const
+	{
+		return m_allocator;
+	}
+}
@@ -0,0 +1,194 @@
+#include <D3D12DxcCompiler.h>
+
+#if defined(D3D12_RENDERER_DXC)
+
+#include <windows.h>
+#include <wrl.h>
+#include <dxcapi.h>
+
+#include <D3D12Utilities.h>
+#include <StableHash.h>
+
+using namespace Microsoft::WRL;
+
+namespace UltReality::Rendering::D3D12
+{
+	namespace
+	{
+		std::wstring ToWide(const std::string& text)
+		{
+			if (text.empty())
+				return {};
+
+			const int length = MultiByteToWideChar(CP_UTF8, 0, text.data(), static_cast<int>(text.size()), nullptr, 0);
+			std::wstring wide(static_cast<size_t>(length), L'\0');
+			MultiByteToWideChar(CP_UTF8, 0, text.data(), static_cast<int>(text.size()), wide.data(), length);
+
+			return wide;
+		}
+
+		std::string ToUtf8(const wchar_t* text)
+		{
+			const int length = WideCharToMultiByte(CP_UTF8, 0, text, -1, nullptr, 0, nullptr, nullptr);
+			if (length <= 1)
+				return {};
+
+			std::string utf8(static_cast<size_t>(length - 1), '\0');
+			WideCharToMultiByte(CP_UTF8, 0, text, -1, utf8.data(), length, nullptr, nullptr);
+
+			return utf8;
+		}
+
+		/// <summary>
+		/// Loads includes through the resolver the cache key was computed with, so DXC reads exactly the files that were hashed
+		/// </summary>
+		class IncludeHandler final : public IDxcIncludeHandler
+		{
+		private:
+			IDxcUtils* m_utils;
+			Common::IShaderIncludeResolver& m_resolver;
+			const std::string& m_sourcePath;
+
+		public:
+			IncludeHandler(IDxcUtils* utils, Common::IShaderIncludeResolver& resolver, const std::string& sourcePath)
+				: m_utils(utils), m_resolver(resolver), m_sourcePath(sourcePath)
+			{}
+
+			HRESULT STDMETHODCALLTYPE LoadSource(LPCWSTR filename, IDxcBlob** includeSource) override
+			{
+				*includeSource = nullptr;
+
+				// DXC passes nested includes already joined with the directory of the including file
+				const std::string include = ToUtf8(filename);
+				std::string path = m_resolver.Resolve({}, include);
+				if (path.empty())
+					path = m_resolver.Resolve(m_sourcePath, include);
+
+				std::string contents;
+				if (path.empty() || !m_resolver.Read(path, contents))
+					return HRESULT_FROM_WIN32(ERROR_FILE_NOT_FOUND);
+
+				ComPtr<IDxcBlobEncoding> blob;
+				const HRESULT hr = m_utils->CreateBlob(contents.data(), static_cast<UINT32>(contents.size()), DXC_CP_UTF8, &blob);
+				if (FAILED(hr))
+					return hr;
+
+				*includeSource = blob.Detach();
+				return S_OK;
+			}
+
+			// Lives on the stack for the duration of one compilation, reference counting is not needed
+			HRESULT STDMETHODCALLTYPE QueryInterface(REFIID riid, void** object) override
+			{
+				if (riid == __uuidof(IDxcIncludeHandler) || riid == __uuidof(IUnknown))
+				{
+					*object = static_cast<IDxcIncludeHandler*>(this);
+					return S_OK;
+				}
+
+				*object = nullptr;
+				return E_NOINTERFACE;
+			}
+
+			ULONG STDMETHODCALLTYPE AddRef() override { return 1; }
+			ULONG STDMETHODCALLTYPE Release() override { return 1; }
+		};
+	}
+
+	D3D12DxcCompiler::D3D12DxcCompiler()
+	{
+		ComPtr<IDxcCompiler3> compiler;
+		ThrowIfFailed(DxcCreateInstance(CLSID_DxcCompiler, IID_PPV_ARGS(&compiler)));
+
+		Common::StableHasher hasher;
+
+		ComPtr<IDxcVersionInfo> versionInfo;
+		if (SUCCEEDED(compiler.As(&versionInfo)))
+		{
+			UINT32 major = 0;
+			UINT32 minor = 0;
+			ThrowIfFailed(versionInfo->GetVersion(&major, &minor));
+			hasher.Add(major).Add(minor);
+		}
+
+		// Development builds share a version number, the commit tells them apart
+		ComPtr<IDxcVersionInfo2> versionInfo2;
+		if (SUCCEEDED(compiler.As(&versionInfo2)))
+		{
+			UINT32 commitCount = 0;
+			char* commitHash = nullptr;
+			if (SUCCEEDED(versionInfo2->GetCommitInfo(&commitCount, &commitHash)))
+			{
+				hasher.Add(commitCount).AddString(commitHash ? commitHash : "");
+				CoTaskMemFree(commitHash);
+			}
+		}
+
+		m_versionHash = hasher.Finish();
+	}
+
+	uint64_t D3D12DxcCompiler::GetVersionHash() const
+	{
+		return m_versionHash;
+	}
+
+	bool D3D12DxcCompiler::Compile(const Common::ShaderCompileRequest& request, const std::string& source, Common::IShaderIncludeResolver& resolver,
+		std::vector<uint8_t>& bytecode, std::string& messages)
+	{
+		ComPtr<IDxcUtils> utils;
+		ComPtr<IDxcCompiler3> compiler;
+		ThrowIfFailed(DxcCreateInstance(CLSID_DxcUtils, IID_PPV_ARGS(&utils)));
+		ThrowIfFailed(DxcCreateInstance(CLSID_DxcCompiler, IID_PPV_ARGS(&compiler)));
+
+		std::vector<std::wstring> arguments;
+		arguments.push_back(ToWide(request.sourcePath));
+		arguments.push_back(L"-E");
+		arguments.push_back(ToWide(request.entryPoint));
+		arguments.push_back(L"-T");
+		arguments.push_back(ToWide(request.target));
+
+		for (const Common::ShaderDefine& define : request.defines)
+		{
+			arguments.push_back(L"-D");
+			arguments.push_back(ToWide(define.value.empty() ? define.name : define.name + "=" + define.value));
+		}
+
+		for (const std::string& argument : request.arguments)
+			arguments.push_back(ToWide(argument));
+
+		std::vector<LPCWSTR> argumentPointers;
+		argumentPointers.reserve(arguments.size());
+		for (const std::wstring& argument : arguments)
+			argumentPointers.push_back(argument.c_str());
+
+		DxcBuffer sourceBuffer;
+		sourceBuffer.Ptr = source.data();
+		sourceBuffer.Size = source.size();
+		sourceBuffer.Encoding = DXC_CP_UTF8;
+
+		IncludeHandler includeHandler(utils.Get(), resolver, request.sourcePath);
+
+		ComPtr<IDxcResult> result;
+		ThrowIfFailed(compiler->Compile(&sourceBuffer, argumentPointers.data(), static_cast<UINT32>(argumentPointers.size()),
+			&includeHandler, IID_PPV_ARGS(&result)));
+
+		ComPtr<IDxcBlobUtf8> errors;
+		if (SUCCEEDED(result->GetOutput(DXC_OUT_ERRORS, IID_PPV_ARGS(&errors), nullptr)) && errors && errors->GetStringLength() > 0)
+			messages.assign(errors->GetStringPointer(), errors->GetStringLength());
+
+		HRESULT status;
+		ThrowIfFailed(result->GetStatus(&status));
+		if (FAILED(status))
+			return false;
+
+		ComPtr<IDxcBlob> object;
+		ThrowIfFailed(result->GetOutput(DXC_OUT_OBJECT, IID_PPV_ARGS(&object), nullptr));
+
+		const uint8_t* data = static_cast<const uint8_t*>(object->GetBufferPointer());
+		bytecode.assign(data, data + object->GetBufferSize());
+
+		return true;
+	}
+}
+
+#endif // D3D12_RENDERER_DXC
@@ -0,0 +1,60 @@
+#include <D3D12FenceTimeline.h>
+#include <D3D12Utilities.h>
+
+namespace UltReality::Rendering::D3D12
+{
+	D3D12FenceTimeline::D3D12FenceTimeline(ID3D12Fence* fence, ID3D12CommandQueue* queue)
+		: m_fence(fence), m_queue(queue)
+	{
+		// Continue from wherever the fence already is, so a timeline can be rebuilt over a live fence
+		m_currentValue = m_fence->GetCompletedValue();
+
+		m_fenceEvent = CreateEvent(nullptr, false, false, nullptr);
+		if (m_fenceEvent == nullptr)
+			ThrowIfFailed(HRESULT_FROM_WIN32(GetLastError()));
+	}
+
+	D3D12FenceTimeline::~D3D12FenceTimeline()
+	{
+		if (m_fenceEvent != nullptr)
+			CloseHandle(m_fenceEvent);
+	}
+
+	uint64_t D3D12FenceTimeline::Signal()
+	{
+		// Advance the fence value to mark commands up to this fence point.
+		m_currentValue++;
+
+		// Add an instruction to the command queue to set a new fence point. Because we 
+		// are on the GPU timeline, the new fence point won't be set until the GPU finishes
+		// processing all the commands prior to this Signal().
+		ThrowIfFailed(m_queue->Signal(m_fence, m_currentValue));
+
+		return m_currentValue;
+	}
+
+	uint64_t D3D12FenceTimeline::GetCompletedValue() const
+	{
+		return m_fence->GetCompletedValue();
+	}
+
+	void D3D12FenceTimeline::WaitForValue(uint64_t value)
+	{
+		if (m_fence->GetCompletedValue() < value)
+		{
+			// Fire event when GPU hits the fence value and wait on it
+			ThrowIfFailed(m_fence->SetEventOnCompletion(value, m_fenceEvent));
+			WaitForSingleObject(m_fenceEvent, INFINITE);
+		}
+	}
+
+	ID3D12Fence* D3D12FenceTimeline::Fence() const
+	{
+		return m_fence;
+	}
+
+	uint64_t D3D12FenceTimeline::GetCurrentValue() const
+	{
+		return m_currentValue;
+	}
+}
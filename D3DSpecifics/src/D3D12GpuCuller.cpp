@@ -0,0 +1,444 @@
+#include <directx/d3dx12.h>
+
+#include <algorithm>
+#include <stdexcept>
+#include <string>
+#include <utility>
+
+#include <D3D12GpuCuller.h>
+#include <D3D12Utilities.h>
+
+using namespace Microsoft::WRL;
+
+namespace UltReality::Rendering::D3D12
+{
+	namespace
+	{
+		// Root parameters of the culling passes
+		constexpr uint32_t s_cullConstantsParameter = 0;
+		constexpr uint32_t s_instancesParameter = 1;
+		constexpr uint32_t s_meshesParameter = 2;
+		constexpr uint32_t s_localOffsetsParameter = 3;
+		constexpr uint32_t s_groupCountsParameter = 4;
+		constexpr uint32_t s_commandsParameter = 5;
+		constexpr uint32_t s_drawCountParameter = 6;
+		constexpr uint32_t s_computeParameterCount = 7;
+
+		// Smallest instance capacity, so the first few instances do not reallocate one by one
+		constexpr uint32_t s_minInstanceCapacity = 1024;
+	}
+
+	// Both passes avoid atomics: the culling pass ranks the visible instances of every group with a prefix sum and the
+	// compaction pass offsets them by the visible count of the preceding groups, so the visible instances land in
+	// instance order and the result is deterministic. The plane distance is marked precise so it is evaluated with the
+	// same roundings as Common::IsSphereInFrustum
+	const char* const D3D12GpuCuller::shaderSource = R"(
+#define GROUP_SIZE 256
+#define CULLED_OFFSET 0xFFFFFFFF
+
+struct Instance
+{
+	float3 boundsCenter;
+	float boundsRadius;
+	uint meshIndex;
+	uint userData;
+	uint2 padding;
+};
+
+struct Mesh
+{
+	uint indexCount;
+	uint startIndex;
+	int baseVertex;
+	uint padding;
+};
+
+struct DrawCommand
+{
+	uint instanceIndex;
+	uint indexCountPerInstance;
+	uint instanceCount;
+	uint startIndexLocation;
+	int baseVertexLocation;
+	uint startInstanceLocation;
+};
+
+cbuffer CullConstants : register(b0)
+{
+	float4 frustumPlanes[6];
+	uint instanceCount;
+	uint meshCount;
+	uint groupCount;
+	uint constantsPadding;
+};
+
+StructuredBuffer<Instance> instances : register(t0);
+StructuredBuffer<Mesh> meshes : register(t1);
+RWStructuredBuffer<uint> localOffsets : register(u0);
+RWStructuredBuffer<uint> groupCounts : register(u1);
+RWStructuredBuffer<DrawCommand> commands : register(u2);
+RWStructuredBuffer<uint> drawCount : register(u3);
+
+groupshared uint sharedSums[GROUP_SIZE];
+groupshared uint sharedTotals[GROUP_SIZE];
+
+bool IsVisible(Instance instance)
+{
+	if (instance.meshIndex >= meshCount)
+		return false;
+
+	[unroll]
+	for (uint p = 0; p < 6; p++)
+	{
+		precise float distance = frustumPlanes[p].x * instance.boundsCenter.x;
+		distance = distance + frustumPlanes[p].y * instance.boundsCenter.y;
+		distance = distance + frustumPlanes[p].z * instance.boundsCenter.z;
+		distance = distance + frustumPlanes[p].w;
+
+		if (distance < -instance.boundsRadius)
+			return false;
+	}
+
+	return true;
+}
+
+[numthreads(GROUP_SIZE, 1, 1)]
+void CullInstances(uint3 groupId : SV_GroupID, uint3 dispatchId : SV_DispatchThreadID, uint groupIndex : SV_GroupIndex)
+{
+	const uint index = dispatchId.x;
+
+	uint visible = 0;
+	if (index < instanceCount)
+		visible = IsVisible(instances[index]) ? 1 : 0;
+
+	// Inclusive prefix sum of the visibility flags
+	sharedSums[groupIndex] = visible;
+	GroupMemoryBarrierWithGroupSync();
+
+	for (uint offset = 1; offset < GROUP_SIZE; offset <<= 1)
+	{
+		const uint value = groupIndex >= offset ? sharedSums[groupIndex - offset] : 0;
+		GroupMemoryBarrierWithGroupSync();
+		sharedSums[groupIndex] += value;
+		GroupMemoryBarrierWithGroupSync();
+	}
+
+	if (index < instanceCount)
+		localOffsets[index] = visible != 0 ? sharedSums[groupIndex] - 1 : CULLED_OFFSET;
+
+	if (groupIndex == GROUP_SIZE - 1)
+		groupCounts[groupId.x] = sharedSums[groupIndex];
+}
+
+[numthreads(GROUP_SIZE, 1, 1)]
+void CompactInstances(uint3 groupId : SV_GroupID, uint3 dispatchId : SV_DispatchThreadID, uint groupIndex : SV_GroupIndex)
+{
+	// Every thread sums a strided share of the group counts, the group then reduces the shares
+	uint before = 0;
+	uint total = 0;
+	for (uint group = groupIndex; group < groupCount; group += GROUP_SIZE)
+	{
+		const uint count = groupCounts[group];
+		total += count;
+		if (group < groupId.x)
+			before += count;
+	}
+
+	sharedSums[groupIndex] = before;
+	sharedTotals[groupIndex] = total;
+	GroupMemoryBarrierWithGroupSync();
+
+	for (uint stride = GROUP_SIZE / 2; stride > 0; stride >>= 1)
+	{
+		if (groupIndex < stride)
+		{
+			sharedSums[groupIndex] += sharedSums[groupIndex + stride];
+			sharedTotals[groupIndex] += sharedTotals[groupIndex + stride];
+		}
+		GroupMemoryBarrierWithGroupSync();
+	}
+
+	if (dispatchId.x == 0)
+		drawCount[0] = sharedTotals[0];
+
+	const uint index = dispatchId.x;
+	if (index >= instanceCount)
+		return;
+
+	const uint localOffset = localOffsets[index];
+	if (localOffset == CULLED_OFFSET)
+		return;
+
+	const Mesh mesh = meshes[instances[index].meshIndex];
+
+	DrawCommand command;
+	command.instanceIndex = index;
+	command.indexCountPerInstance = mesh.indexCount;
+	command.instanceCount = 1;
+	command.startIndexLocation = mesh.startIndex;
+	command.baseVertexLocation = mesh.baseVertex;
+	command.startInstanceLocation = 0;
+	commands[sharedSums[0] + localOffset] = command;
+}
+)";
+
+	D3D12GpuCuller::D3D12GpuCuller(ID3D12Device* device, D3D12_SHADER_BYTECODE cullShader, D3D12_SHADER_BYTECODE compactShader,
+		D3D12UploadRing* uploadRing, D3D12BindlessTable* bindlessTable, ID3D12RootSignature* drawRootSignature)
+		: m_device(device), m_uploadRing(uploadRing), m_bindlessTable(bindlessTable), m_drawRootSignature(drawRootSignature)
+	{
+		CD3DX12_ROOT_PARAMETER parameters[s_computeParameterCount];
+		parameters[s_cullConstantsParameter].InitAsConstantBufferView(0);
+		parameters[s_instancesParameter].InitAsShaderResourceView(0);
+		parameters[s_meshesParameter].InitAsShaderResourceView(1);
+		parameters[s_localOffsetsParameter].InitAsUnorderedAccessView(0);
+		parameters[s_groupCountsParameter].InitAsUnorderedAccessView(1);
+		parameters[s_commandsParameter].InitAsUnorderedAccessView(2);
+		parameters[s_drawCountParameter].InitAsUnorderedAccessView(3);
+
+		const CD3DX12_ROOT_SIGNATURE_DESC rootSignatureDesc(s_computeParameterCount, parameters);
+
+		ComPtr<ID3DBlob> serialized;
+		ComPtr<ID3DBlob> errors;
+		const HRESULT hr = D3D12SerializeRootSignature(&rootSignatureDesc, D3D_ROOT_SIGNATURE_VERSION_1, serialized.GetAddressOf(), errors.GetAddressOf());
+		if (FAILED(hr) && errors != nullptr)
+			throw std::runtime_error(std::string(static_cast<const char*>(errors->GetBufferPointer()), errors->GetBufferSize()));
+		ThrowIfFailed(hr);
+
+		ThrowIfFailed(m_device->CreateRootSignature(0, serialized->GetBufferPointer(), serialized->GetBufferSize(), IID_PPV_ARGS(m_computeRootSignature.GetAddressOf())));
+
+		D3D12_COMPUTE_PIPELINE_STATE_DESC pipelineDesc = {};
+		pipelineDesc.pRootSignature = m_computeRootSignature.Get();
+		pipelineDesc.CS = cullShader;
+		ThrowIfFailed(m_device->CreateComputePipelineState(&pipelineDesc, IID_PPV_ARGS(m_cullPipeline.GetAddressOf())));
+
+		pipelineDesc.CS = compactShader;
+		ThrowIfFailed(m_device->CreateComputePipelineState(&pipelineDesc, IID_PPV_ARGS(m_compactPipeline.GetAddressOf())));
+
+		// Every command sets the instance index root constant, then draws
+		D3D12_INDIRECT_ARGUMENT_DESC arguments[2] = {};
+		arguments[0].Type = D3D12_INDIRECT_ARGUMENT_TYPE_CONSTANT;
+		arguments[0].Constant.RootParameterIndex = D3D12BindlessTable::resourceIndicesRootParameter;
+		arguments[0].Constant.DestOffsetIn32BitValues = instanceIndexConstant;
+		arguments[0].Constant.Num32BitValuesToSet = 1;
+		arguments[1].Type = D3D12_INDIRECT_ARGUMENT_TYPE_DRAW_INDEXED;
+
+		D3D12_COMMAND_SIGNATURE_DESC commandSignatureDesc = {};
+		commandSignatureDesc.ByteStride = sizeof(Common::IndirectDrawCommand);
+		commandSignatureDesc.NumArgumentDescs = _countof(arguments);
+		commandSignatureDesc.pArgumentDescs = arguments;
+		ThrowIfFailed(m_device->CreateCommandSignature(&commandSignatureDesc, m_drawRootSignature, IID_PPV_ARGS(m_commandSignature.GetAddressOf())));
+
+		m_countBuffer = CreateBuffer(sizeof(uint32_t), D3D12_RESOURCE_FLAG_ALLOW_UNORDERED_ACCESS);
+	}
+
+	D3D12GpuCuller::~D3D12GpuCuller()
+	{
+		if (m_instanceBufferSrv.IsValid())
+			m_bindlessTable->Free(m_instanceBufferSrv);
+	}
+
+	ComPtr<ID3D12Resource> D3D12GpuCuller::CreateBuffer(uint64_t size, D3D12_RESOURCE_FLAGS flags) const
+	{
+		const CD3DX12_HEAP_PROPERTIES heapProperties(D3D12_HEAP_TYPE_DEFAULT);
+		const CD3DX12_RESOURCE_DESC desc = CD3DX12_RESOURCE_DESC::Buffer(size, flags);
+
+		ComPtr<ID3D12Resource> buffer;
+		ThrowIfFailed(m_device->CreateCommittedResource(&heapProperties, D3D12_HEAP_FLAG_NONE, &desc, D3D12_RESOURCE_STATE_COMMON,
+			nullptr, IID_PPV_ARGS(buffer.GetAddressOf())));
+
+		return buffer;
+	}
+
+	void D3D12GpuCuller::RetireResource(ComPtr<ID3D12Resource>& resource)
+	{
+		if (resource != nullptr)
+			m_retiredResources.Release(std::move(resource));
+	}
+
+	void D3D12GpuCuller::GrowInstanceBuffers(uint32_t capacity)
+	{
+		// Only the records of the buffer the GPU last saw need to be carried over, a buffer replaced again before
+		// the next pass never received any
+		if (m_growSource == nullptr && m_instanceBuffer != nullptr)
+		{
+			m_growSource = std::move(m_instanceBuffer);
+			m_growBytes = static_cast<uint64_t>(m_instanceCount) * sizeof(Common::GpuInstance);
+		}
+		RetireResource(m_instanceBuffer);
+		RetireResource(m_localOffsetBuffer);
+		RetireResource(m_groupCountBuffer);
+		RetireResource(m_commandBuffer);
+
+		m_instanceBuffer = CreateBuffer(static_cast<uint64_t>(capacity) * sizeof(Common::GpuInstance), D3D12_RESOURCE_FLAG_NONE);
+		m_localOffsetBuffer = CreateBuffer(static_cast<uint64_t>(capacity) * sizeof(uint32_t), D3D12_RESOURCE_FLAG_ALLOW_UNORDERED_ACCESS);
+		m_groupCountBuffer = CreateBuffer(static_cast<uint64_t>(Common::GpuCullGroupCount(capacity)) * sizeof(uint32_t), D3D12_RESOURCE_FLAG_ALLOW_UNORDERED_ACCESS);
+		m_commandBuffer = CreateBuffer(static_cast<uint64_t>(capacity) * sizeof(Common::IndirectDrawCommand), D3D12_RESOURCE_FLAG_ALLOW_UNORDERED_ACCESS);
+		m_instanceCapacity = capacity;
+
+		// Frames in flight keep reading the old buffer through the old slot until it retires
+		if (m_instanceBufferSrv.IsValid())
+			m_bindlessTable->Free(m_instanceBufferSrv);
+
+		D3D12_SHADER_RESOURCE_VIEW_DESC srvDesc = {};
+		srvDesc.Format = DXGI_FORMAT_UNKNOWN;
+		srvDesc.ViewDimension = D3D12_SRV_DIMENSION_BUFFER;
+		srvDesc.Shader4ComponentMapping = D3D12_DEFAULT_SHADER_4_COMPONENT_MAPPING;
+		srvDesc.Buffer.NumElements = capacity;
+		srvDesc.Buffer.StructureByteStride = sizeof(Common::GpuInstance);
+		m_instanceBufferSrv = m_bindlessTable->CreateSrv(m_instanceBuffer.Get(), &srvDesc);
+	}
+
+	void D3D12GpuCuller::SetMeshes(const std::vector<Common::GpuMesh>& meshes, const D3D12_VERTEX_BUFFER_VIEW& vertexBuffer, const D3D12_INDEX_BUFFER_VIEW& indexBuffer)
+	{
+		const uint32_t meshCount = static_cast<uint32_t>(meshes.size());
+		if (meshCount > m_meshCapacity)
+		{
+			RetireResource(m_meshBuffer);
+			m_meshBuffer = CreateBuffer(static_cast<uint64_t>(meshCount) * sizeof(Common::GpuMesh), D3D12_RESOURCE_FLAG_NONE);
+			m_meshCapacity = meshCount;
+		}
+
+		// The whole table is replaced, so copies still pending for the old one are dropped
+		m_pendingMeshCopies.clear();
+		if (meshCount > 0)
+			m_pendingMeshCopies.push_back(PendingCopy{ m_uploadRing->PushArray(meshes.data(), meshCount), 0 });
+
+		m_meshCount = meshCount;
+		m_vertexBufferView = vertexBuffer;
+		m_indexBufferView = indexBuffer;
+	}
+
+	void D3D12GpuCuller::SetInstanceCount(uint32_t count)
+	{
+		if (count > m_instanceCapacity)
+			GrowInstanceBuffers(std::max({ count, m_instanceCapacity * 2, s_minInstanceCapacity }));
+
+		m_instanceCount = count;
+	}
+
+	void D3D12GpuCuller::UpdateInstances(uint32_t first, const Common::GpuInstance* instances, uint32_t count)
+	{
+		if (static_cast<uint64_t>(first) + count > m_instanceCount)
+			throw std::out_of_range("Instance update exceeds the instance count");
+
+		if (count == 0)
+			return;
+
+		m_pendingInstanceCopies.push_back(PendingCopy{ m_uploadRing->PushArray(instances, count), static_cast<uint64_t>(first) * sizeof(Common::GpuInstance) });
+	}
+
+	void D3D12GpuCuller::RecordCulling(ID3D12GraphicsCommandList* cmdList, const float frustumPlanes[6][4])
+	{
+		if (m_instanceCount == 0)
+			return;
+
+		// Buffers decay to COMMON once an ExecuteCommandLists call completes, so every frame starts from COMMON.
+		// Buffers that are only read are promoted implicitly
+		std::vector<D3D12_RESOURCE_BARRIER> barriers;
+
+		const bool copyInstances = m_growSource != nullptr || !m_pendingInstanceCopies.empty();
+		const bool copyMeshes = !m_pendingMeshCopies.empty();
+		if (copyInstances)
+			barriers.push_back(CD3DX12_RESOURCE_BARRIER::Transition(m_instanceBuffer.Get(), D3D12_RESOURCE_STATE_COMMON, D3D12_RESOURCE_STATE_COPY_DEST));
+		if (copyMeshes)
+			barriers.push_back(CD3DX12_RESOURCE_BARRIER::Transition(m_meshBuffer.Get(), D3D12_RESOURCE_STATE_COMMON, D3D12_RESOURCE_STATE_COPY_DEST));
+
+		if (!barriers.empty())
+		{
+			cmdList->ResourceBarrier(static_cast<UINT>(barriers.size()), barriers.data());
+			barriers.clear();
+		}
+
+		// Records carried over from a replaced buffer go first, so later updates overwrite them
+		if (m_growSource != nullptr)
+		{
+			cmdList->CopyBufferRegion(m_instanceBuffer.Get(), 0, m_growSource.Get(), 0, m_growBytes);
+			RetireResource(m_growSource);
+			m_growBytes = 0;
+		}
+
+		for (const PendingCopy& copy : m_pendingInstanceCopies)
+			cmdList->CopyBufferRegion(m_instanceBuffer.Get(), copy.destinationOffset, copy.source.resource, copy.source.offset, copy.source.size);
+		for (const PendingCopy& copy : m_pendingMeshCopies)
+			cmdList->CopyBufferRegion(m_meshBuffer.Get(), copy.destinationOffset, copy.source.resource, copy.source.offset, copy.source.size);
+
+		m_pendingInstanceCopies.clear();
+		m_pendingMeshCopies.clear();
+
+		if (copyInstances)
+			barriers.push_back(CD3DX12_RESOURCE_BARRIER::Transition(m_instanceBuffer.Get(), D3D12_RESOURCE_STATE_COPY_DEST, D3D12_RESOURCE_STATE_NON_PIXEL_SHADER_RESOURCE));
+		if (copyMeshes)
+			barriers.push_back(CD3DX12_RESOURCE_BARRIER::Transition(m_meshBuffer.Get(), D3D12_RESOURCE_STATE_COPY_DEST, D3D12_RESOURCE_STATE_NON_PIXEL_SHADER_RESOURCE));
+		barriers.push_back(CD3DX12_RESOURCE_BARRIER::Transition(m_localOffsetBuffer.Get(), D3D12_RESOURCE_STATE_COMMON, D3D12_RESOURCE_STATE_UNORDERED_ACCESS));
+		barriers.push_back(CD3DX12_RESOURCE_BARRIER::Transition(m_groupCountBuffer.Get(), D3D12_RESOURCE_STATE_COMMON, D3D12_RESOURCE_STATE_UNORDERED_ACCESS));
+		barriers.push_back(CD3DX12_RESOURCE_BARRIER::Transition(m_commandBuffer.Get(), D3D12_RESOURCE_STATE_COMMON, D3D12_RESOURCE_STATE_UNORDERED_ACCESS));
+		barriers.push_back(CD3DX12_RESOURCE_BARRIER::Transition(m_countBuffer.Get(), D3D12_RESOURCE_STATE_COMMON, D3D12_RESOURCE_STATE_UNORDERED_ACCESS));
+		cmdList->ResourceBarrier(static_cast<UINT>(barriers.size()), barriers.data());
+		barriers.clear();
+
+		Common::GpuCullConstants constants;
+		std::copy(&frustumPlanes[0][0], &frustumPlanes[0][0] + 24, &constants.frustumPlanes[0][0]);
+		constants.instanceCount = m_instanceCount;
+		constants.meshCount = m_meshCount;
+		constants.groupCount = Common::GpuCullGroupCount(m_instanceCount);
+
+		cmdList->SetComputeRootSignature(m_computeRootSignature.Get());
+		cmdList->SetComputeRootConstantBufferView(s_cullConstantsParameter, m_uploadRing->PushConstants(constants));
+		cmdList->SetComputeRootShaderResourceView(s_instancesParameter, m_instanceBuffer->GetGPUVirtualAddress());
+		// Without meshes every instance is culled before the table is read, any valid address will do
+		cmdList->SetComputeRootShaderResourceView(s_meshesParameter, m_meshCount > 0 ? m_meshBuffer->GetGPUVirtualAddress() : m_instanceBuffer->GetGPUVirtualAddress());
+		cmdList->SetComputeRootUnorderedAccessView(s_localOffsetsParameter, m_localOffsetBuffer->GetGPUVirtualAddress());
+		cmdList->SetComputeRootUnorderedAccessView(s_groupCountsParameter, m_groupCountBuffer->GetGPUVirtualAddress());
+		cmdList->SetComputeRootUnorderedAccessView(s_commandsParameter, m_commandBuffer->GetGPUVirtualAddress());
+		cmdList->SetComputeRootUnorderedAccessView(s_drawCountParameter, m_countBuffer->GetGPUVirtualAddress());
+
+		cmdList->SetPipelineState(m_cullPipeline.Get());
+		cmdList->Dispatch(constants.groupCount, 1, 1);
+
+		// Compaction reads the offsets and group counts of every group
+		barriers.push_back(CD3DX12_RESOURCE_BARRIER::UAV(m_localOffsetBuffer.Get()));
+		barriers.push_back(CD3DX12_RESOURCE_BARRIER::UAV(m_groupCountBuffer.Get()));
+		cmdList->ResourceBarrier(static_cast<UINT>(barriers.size()), barriers.data());
+		barriers.clear();
+
+		cmdList->SetPipelineState(m_compactPipeline.Get());
+		cmdList->Dispatch(constants.groupCount, 1, 1);
+
+		barriers.push_back(CD3DX12_RESOURCE_BARRIER::Transition(m_commandBuffer.Get(), D3D12_RESOURCE_STATE_UNORDERED_ACCESS, D3D12_RESOURCE_STATE_INDIRECT_ARGUMENT));
+		barriers.push_back(CD3DX12_RESOURCE_BARRIER::Transition(m_countBuffer.Get(), D3D12_RESOURCE_STATE_UNORDERED_ACCESS, D3D12_RESOURCE_STATE_INDIRECT_ARGUMENT));
+		cmdList->ResourceBarrier(static_cast<UINT>(barriers.size()), barriers.data());
+	}
+
+	void D3D12GpuCuller::RecordDraws(ID3D12GraphicsCommandList* cmdList, ID3D12PipelineState* pipelineState, D3D12_PRIMITIVE_TOPOLOGY topology)
+	{
+		if (m_instanceCount == 0)
+			return;
+
+		cmdList->SetGraphicsRootSignature(m_drawRootSignature);
+		cmdList->SetGraphicsRootDescriptorTable(D3D12BindlessTable::tableRootParameter, m_bindlessTable->GpuStart());
+		cmdList->SetGraphicsRoot32BitConstant(D3D12BindlessTable::resourceIndicesRootParameter, m_bindlessTable->GetShaderIndex(m_instanceBufferSrv), instanceBufferConstant);
+		cmdList->SetPipelineState(pipelineState);
+
+		cmdList->IASetPrimitiveTopology(topology);
+		cmdList->IASetVertexBuffers(0, 1, &m_vertexBufferView);
+		cmdList->IASetIndexBuffer(&m_indexBufferView);
+
+		// The draw count comes from the compaction pass, the instance count only bounds it
+		cmdList->ExecuteIndirect(m_commandSignature.Get(), m_instanceCount, m_commandBuffer.Get(), 0, m_countBuffer.Get(), 0);
+	}
+
+	uint32_t D3D12GpuCuller::GetInstanceCount() const
+	{
+		return m_instanceCount;
+	}
+
+	void D3D12GpuCuller::FinishFrame(uint64_t fenceValue)
+	{
+		m_retiredResources.FinishFrame(fenceValue);
+	}
+
+	void D3D12GpuCuller::Retire(uint64_t completedFenceValue)
+	{
+		m_retiredResources.Retire(completedFenceValue);
+	}
+}
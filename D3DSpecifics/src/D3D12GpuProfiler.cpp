@@ -0,0 +1,109 @@
+#include <directx/d3dx12.h>
+
+#include <D3D12GpuProfiler.h>
+#include <D3D12Utilities.h>
+
+using namespace Microsoft::WRL;
+
+namespace UltReality::Rendering::D3D12
+{
+	D3D12GpuProfiler::D3D12GpuProfiler(ID3D12Device* device, ID3D12CommandQueue* queue, uint32_t maxScopesPerFrame)
+		: m_profiler(maxScopesPerFrame)
+	{
+		D3D12_QUERY_HEAP_DESC heapDesc = {};
+		heapDesc.Type = D3D12_QUERY_HEAP_TYPE_TIMESTAMP;
+		heapDesc.Count = m_profiler.GetQueryCount();
+		ThrowIfFailed(device->CreateQueryHeap(&heapDesc, IID_PPV_ARGS(m_queryHeap.GetAddressOf())));
+
+		CD3DX12_HEAP_PROPERTIES heapProps(D3D12_HEAP_TYPE_READBACK);
+		auto bufferDesc = CD3DX12_RESOURCE_DESC::Buffer(static_cast<uint64_t>(heapDesc.Count) * sizeof(uint64_t));
+		ThrowIfFailed(device->CreateCommittedResource(
+			&heapProps,
+			D3D12_HEAP_FLAG_NONE,
+			&bufferDesc,
+			D3D12_RESOURCE_STATE_COPY_DEST,
+			nullptr,
+			IID_PPV_ARGS(m_readbackBuffer.GetAddressOf())
+		));
+
+		uint64_t frequency = 0;
+		ThrowIfFailed(queue->GetTimestampFrequency(&frequency));
+		m_profiler.SetTimestampFrequency(frequency);
+	}
+
+	void D3D12GpuProfiler::BeginFrame()
+	{
+		m_profiler.BeginFrame();
+	}
+
+	uint32_t D3D12GpuProfiler::BeginScope(ID3D12GraphicsCommandList* cmdList, std::string_view name, uint32_t parent)
+	{
+		const uint32_t scope = m_profiler.BeginScope(name, parent);
+		if (scope != Common::GpuProfiler::invalidScope)
+			cmdList->EndQuery(m_queryHeap.Get(), D3D12_QUERY_TYPE_TIMESTAMP, m_profiler.GetBeginQuery(scope));
+
+		return scope;
+	}
+
+	void D3D12GpuProfiler::EndScope(ID3D12GraphicsCommandList* cmdList, uint32_t scope)
+	{
+		if (!m_profiler.IsScopeOpen(scope))
+			return;
+
+		cmdList->EndQuery(m_queryHeap.Get(), D3D12_QUERY_TYPE_TIMESTAMP, m_profiler.GetEndQuery(scope));
+		m_profiler.EndScope(scope);
+	}
+
+	void D3D12GpuProfiler::ResolveFrame(ID3D12GraphicsCommandList* cmdList)
+	{
+		const uint32_t scopeCount = m_profiler.GetScopeCount();
+		if (scopeCount == 0)
+			return;
+
+		// Every query in the resolved range must have been written. Scopes left open get an end timestamp here but
+		// are still left out of the profile, their duration is meaningless
+		for (uint32_t scope = 0; scope < scopeCount; scope++)
+		{
+			if (m_profiler.IsScopeOpen(scope))
+				cmdList->EndQuery(m_queryHeap.Get(), D3D12_QUERY_TYPE_TIMESTAMP, m_profiler.GetEndQuery(scope));
+		}
+
+		const uint32_t firstQuery = m_profiler.GetFrameQueryOffset();
+		cmdList->ResolveQueryData(m_queryHeap.Get(), D3D12_QUERY_TYPE_TIMESTAMP, firstQuery, scopeCount * 2,
+			m_readbackBuffer.Get(), static_cast<uint64_t>(firstQuery) * sizeof(uint64_t));
+	}
+
+	void D3D12GpuProfiler::FinishFrame(uint64_t fenceValue)
+	{
+		m_profiler.EndFrame(fenceValue);
+	}
+
+	void D3D12GpuProfiler::Retire(uint64_t completedFenceValue)
+	{
+		uint32_t slot;
+		while (m_profiler.NextCompletedFrame(completedFenceValue, slot))
+		{
+			// Only the slot's range is read, the GPU may be resolving other slots at the same time
+			const size_t slotBytes = static_cast<size_t>(m_profiler.GetQueryCount() / Common::GpuProfiler::frameSlotCount) * sizeof(uint64_t);
+			CD3DX12_RANGE readRange(slot * slotBytes, (slot + 1) * slotBytes);
+
+			uint8_t* mappedData = nullptr;
+			ThrowIfFailed(m_readbackBuffer->Map(0, &readRange, reinterpret_cast<void**>(&mappedData)));
+
+			m_profiler.ReadFrame(slot, reinterpret_cast<const uint64_t*>(mappedData + readRange.Begin));
+
+			CD3DX12_RANGE writeRange(0, 0);
+			m_readbackBuffer->Unmap(0, &writeRange);
+		}
+	}
+
+	const Common::GpuFrameProfile& D3D12GpuProfiler::GetLatestProfile() const
+	{
+		return m_profiler.GetLatestProfile();
+	}
+
+	const Common::GpuProfiler& D3D12GpuProfiler::Profiler() const
+	{
+		return m_profiler;
+	}
+}
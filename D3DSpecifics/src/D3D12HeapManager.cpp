@@ -0,0 +1,218 @@
+#include <directx/d3dx12.h>
+
+#include <chrono>
+#include <algorithm>
+#include <stdexcept>
+
+#include <D3D12HeapManager.h>
+#include <D3D12Utilities.h>
+
+using namespace Microsoft::WRL;
+
+namespace UltReality::Rendering::D3D12
+{
+	D3D12HeapManager::D3D12HeapManager(ID3D12Device* device, uint64_t pageSize)
+		: m_device(device), m_pageSize(pageSize)
+	{
+		if (!Common::BuddyAllocator::IsPowerOfTwo(pageSize) || pageSize < D3D12_DEFAULT_MSAA_RESOURCE_PLACEMENT_ALIGNMENT)
+			throw std::invalid_argument("D3D12HeapManager page size must be a power of 2 of at least 4MB");
+
+		constexpr D3D12_HEAP_TYPE heapTypes[s_heapTypeCount] = { D3D12_HEAP_TYPE_DEFAULT, D3D12_HEAP_TYPE_UPLOAD, D3D12_HEAP_TYPE_READBACK };
+		constexpr D3D12_HEAP_FLAGS categoryFlags[static_cast<size_t>(ResourceCategory::Count)] = {
+			D3D12_HEAP_FLAG_ALLOW_ONLY_BUFFERS,
+			D3D12_HEAP_FLAG_ALLOW_ONLY_RT_DS_TEXTURES,
+			D3D12_HEAP_FLAG_ALLOW_ONLY_NON_RT_DS_TEXTURES
+		};
+
+		for (uint32_t type = 0; type < s_heapTypeCount; type++)
+		{
+			for (uint32_t category = 0; category < static_cast<uint32_t>(ResourceCategory::Count); category++)
+			{
+				HeapPool& pool = m_pools[PoolIndex(heapTypes[type], static_cast<ResourceCategory>(category))];
+				pool.heapType = heapTypes[type];
+				pool.heapFlags = categoryFlags[category];
+			}
+		}
+	}
+
+	uint32_t D3D12HeapManager::PoolIndex(D3D12_HEAP_TYPE heapType, ResourceCategory category)
+	{
+		uint32_t typeIndex;
+		switch (heapType)
+		{
+		case D3D12_HEAP_TYPE_DEFAULT:
+			typeIndex = 0;
+			break;
+
+		case D3D12_HEAP_TYPE_UPLOAD:
+			typeIndex = 1;
+			break;
+
+		case D3D12_HEAP_TYPE_READBACK:
+			typeIndex = 2;
+			break;
+
+		default:
+			throw std::invalid_argument("D3D12HeapManager only manages DEFAULT, UPLOAD and READBACK heaps");
+		}
+
+		return typeIndex * static_cast<uint32_t>(ResourceCategory::Count) + static_cast<uint32_t>(category);
+	}
+
+	D3D12HeapManager::ResourceCategory D3D12HeapManager::CategoryOf(const D3D12_RESOURCE_DESC& desc)
+	{
+		if (desc.Dimension == D3D12_RESOURCE_DIMENSION_BUFFER)
+			return ResourceCategory::Buffers;
+
+		if (desc.Flags & (D3D12_RESOURCE_FLAG_ALLOW_RENDER_TARGET | D3D12_RESOURCE_FLAG_ALLOW_DEPTH_STENCIL))
+			return ResourceCategory::RenderTargetsAndDepth;
+
+		return ResourceCategory::OtherTextures;
+	}
+
+	D3D12HeapManager::HeapPage& D3D12HeapManager::CreatePage(HeapPool& pool)
+	{
+		// Heaps that may hold MSAA targets need the larger 4MB placement alignment
+		const uint64_t alignment = (pool.heapFlags == D3D12_HEAP_FLAG_ALLOW_ONLY_RT_DS_TEXTURES)
+			? D3D12_DEFAULT_MSAA_RESOURCE_PLACEMENT_ALIGNMENT
+			: D3D12_DEFAULT_RESOURCE_PLACEMENT_ALIGNMENT;
+
+		CD3DX12_HEAP_DESC heapDesc(m_pageSize, pool.heapType, alignment, pool.heapFlags);
+
+		HeapPage page;
+		ThrowIfFailed(m_device->CreateHeap(&heapDesc, IID_PPV_ARGS(page.heap.GetAddressOf())));
+		page.allocator = std::make_unique<Common::BuddyAllocator>(m_pageSize, D3D12_DEFAULT_RESOURCE_PLACEMENT_ALIGNMENT);
+
+		pool.pages.push_back(std::move(page));
+
+		return pool.pages.back();
+	}
+
+	D3D12PlacedAllocation D3D12HeapManager::CreateResource(
+		D3D12_HEAP_TYPE heapType,
+		const D3D12_RESOURCE_DESC& desc,
+		D3D12_RESOURCE_STATES initialState,
+		const D3D12_CLEAR_VALUE* clearValue)
+	{
+		const auto startTime = std::chrono::high_resolution_clock::now();
+
+		D3D12PlacedAllocation allocation;
+
+		const D3D12_RESOURCE_ALLOCATION_INFO allocInfo = m_device->GetResourceAllocationInfo(0, 1, &desc);
+		if (allocInfo.SizeInBytes > m_pageSize)
+		{
+			// Too large to share a page, give it its own implicit heap
+			CD3DX12_HEAP_PROPERTIES heapProps(heapType);
+			ThrowIfFailed(m_device->CreateCommittedResource(
+				&heapProps,
+				D3D12_HEAP_FLAG_NONE,
+				&desc,
+				initialState,
+				clearValue,
+				IID_PPV_ARGS(allocation.resource.GetAddressOf())
+			));
+
+			allocation.committed = true;
+			m_committedCount++;
+		}
+		else
+		{
+			allocation.poolIndex = PoolIndex(heapType, CategoryOf(desc));
+			HeapPool& pool = m_pools[allocation.poolIndex];
+
+			uint64_t offset = Common::BuddyAllocator::invalidOffset;
+			uint32_t pageIndex = 0;
+			for (; pageIndex < pool.pages.size(); pageIndex++)
+			{
+				offset = pool.pages[pageIndex].allocator->Allocate(allocInfo.SizeInBytes, allocInfo.Alignment);
+				if (offset != Common::BuddyAllocator::invalidOffset)
+					break;
+			}
+
+			if (offset == Common::BuddyAllocator::invalidOffset)
+			{
+				pageIndex = static_cast<uint32_t>(pool.pages.size());
+				offset = CreatePage(pool).allocator->Allocate(allocInfo.SizeInBytes, allocInfo.Alignment);
+			}
+
+			HeapPage& page = pool.pages[pageIndex];
+			HRESULT hr = m_device->CreatePlacedResource(
+				page.heap.Get(),
+				offset,
+				&desc,
+				initialState,
+				clearValue,
+				IID_PPV_ARGS(allocation.resource.GetAddressOf())
+			);
+			if (FAILED(hr))
+			{
+				page.allocator->Free(offset);
+				ThrowIfFailed(hr);
+			}
+
+			allocation.pageIndex = pageIndex;
+			allocation.offset = offset;
+		}
+
+		const double elapsed = std::chrono::duration<double, std::micro>(std::chrono::high_resolution_clock::now() - startTime).count();
+		m_allocationCount++;
+		m_totalAllocationMicroseconds += elapsed;
+		m_maxAllocationMicroseconds = std::max(m_maxAllocationMicroseconds, elapsed);
+
+		return allocation;
+	}
+
+	void D3D12HeapManager::Release(D3D12PlacedAllocation& allocation)
+	{
+		if (allocation.resource == nullptr)
+			return;
+
+		allocation.resource.Reset();
+
+		if (allocation.committed)
+		{
+			m_committedCount--;
+		}
+		else
+		{
+			m_pools[allocation.poolIndex].pages[allocation.pageIndex].allocator->Free(allocation.offset);
+		}
+
+		allocation = D3D12PlacedAllocation();
+	}
+
+	void D3D12HeapManager::TrimEmptyPages()
+	{
+		// Pages are addressed by index from live allocations, so only trailing empty pages can go
+		for (HeapPool& pool : m_pools)
+		{
+			while (!pool.pages.empty() && pool.pages.back().allocator->IsEmpty())
+				pool.pages.pop_back();
+		}
+	}
+
+	D3D12HeapManager::Statistics D3D12HeapManager::GetStatistics() const
+	{
+		Statistics stats;
+		for (const HeapPool& pool : m_pools)
+		{
+			for (const HeapPage& page : pool.pages)
+			{
+				const Common::BuddyAllocator::Statistics pageStats = page.allocator->GetStatistics();
+
+				stats.pageCount++;
+				stats.reservedBytes += pageStats.capacity;
+				stats.usedBytes += pageStats.usedBytes;
+				stats.requestedBytes += pageStats.requestedBytes;
+				stats.placedCount += pageStats.allocationCount;
+				stats.maxFragmentation = std::max(stats.maxFragmentation, pageStats.fragmentation);
+			}
+		}
+
+		stats.committedCount = m_committedCount;
+		stats.averageAllocationMicroseconds = m_allocationCount ? (m_totalAllocationMicroseconds / m_allocationCount) : 0.0;
+		stats.maxAllocationMicroseconds = m_maxAllocationMicroseconds;
+
+		return stats;
+	}
+}
@@ -0,0 +1,359 @@
+#include <chrono>
+#include <cstdio>
+#include <cwchar>
+#include <filesystem>
+#include <fstream>
+#include <iterator>
+#include <algorithm>
+#include <stdexcept>
+
+#include <D3D12PipelineCache.h>
+#include <D3D12Utilities.h>
+#include <StableHash.h>
+
+using namespace Microsoft::WRL;
+
+namespace UltReality::Rendering::D3D12
+{
+	namespace
+	{
+		std::wstring LibraryEntryName(uint64_t key)
+		{
+			wchar_t name[24];
+			std::swprintf(name, std::size(name), L"PSO_%016llx", static_cast<unsigned long long>(key));
+
+			return name;
+		}
+
+		void HashBytecode(Common::StableHasher& hasher, const D3D12_SHADER_BYTECODE& bytecode)
+		{
+			hasher.Add<uint64_t>(bytecode.BytecodeLength);
+			if (bytecode.BytecodeLength > 0)
+				hasher.AddBytes(bytecode.pShaderBytecode, bytecode.BytecodeLength);
+		}
+
+		bool WriteFileAtomically(const std::string& path, const void* data, size_t size)
+		{
+			const std::string tempPath = path + ".tmp";
+			{
+				std::ofstream file(tempPath, std::ios::binary | std::ios::trunc);
+				if (!file)
+					return false;
+
+				file.write(static_cast<const char*>(data), static_cast<std::streamsize>(size));
+				if (!file)
+					return false;
+			}
+
+			std::remove(path.c_str());
+			return std::rename(tempPath.c_str(), path.c_str()) == 0;
+		}
+	}
+
+	D3D12PipelineCache::D3D12PipelineCache(ID3D12Device* device, Common::JobSystem* jobSystem, const std::string& cacheDirectory, uint64_t compatibilityHash)
+		: m_device(device), m_jobSystem(jobSystem), m_index(compatibilityHash)
+	{
+		if (device == nullptr || jobSystem == nullptr)
+			throw std::invalid_argument("D3D12PipelineCache requires a device and a job system");
+
+		if (!cacheDirectory.empty())
+		{
+			std::error_code error;
+			std::filesystem::create_directories(cacheDirectory, error);
+
+			m_libraryPath = (std::filesystem::path(cacheDirectory) / "pipelines.bin").string();
+			m_indexPath = (std::filesystem::path(cacheDirectory) / "pipelines.idx").string();
+		}
+
+		OpenLibrary(compatibilityHash);
+	}
+
+	D3D12PipelineCache::~D3D12PipelineCache()
+	{
+		WaitForPending();
+		Save();
+	}
+
+	void D3D12PipelineCache::OpenLibrary(uint64_t compatibilityHash)
+	{
+		ComPtr<ID3D12Device1> device1;
+		if (FAILED(m_device->QueryInterface(IID_PPV_ARGS(device1.GetAddressOf()))))
+			return;
+
+		if (!m_libraryPath.empty())
+		{
+			std::ifstream file(m_libraryPath, std::ios::binary);
+			if (file)
+				m_libraryBlob.assign(std::istreambuf_iterator<char>(file), std::istreambuf_iterator<char>());
+
+			// The library is only reused together with the index written next to it for this adapter and driver
+			const uint64_t libraryHash = Common::StableHash(m_libraryBlob.data(), m_libraryBlob.size());
+			if (m_index.LoadFromFile(m_indexPath, compatibilityHash, libraryHash) != Common::PipelineCacheIndex::LoadResult::Loaded)
+				m_libraryBlob.clear();
+		}
+
+		// A discarded library file is overwritten by the first save, until then the index must not match it
+		m_libraryFileHash = Common::StableHash(m_libraryBlob.data(), m_libraryBlob.size());
+
+		HRESULT hr = device1->CreatePipelineLibrary(m_libraryBlob.data(), m_libraryBlob.size(), IID_PPV_ARGS(m_library.GetAddressOf()));
+		if (hr == DXGI_ERROR_UNSUPPORTED)
+		{
+			// Pipelines are still cached in memory for this run
+			m_libraryBlob.clear();
+			m_index.Clear();
+			return;
+		}
+
+		if (FAILED(hr) && !m_libraryBlob.empty())
+		{
+			// Driver updates and adapter changes invalidate a serialized library, start over with an empty one
+			m_libraryBlob.clear();
+			m_index.Clear();
+			hr = device1->CreatePipelineLibrary(nullptr, 0, IID_PPV_ARGS(m_library.ReleaseAndGetAddressOf()));
+		}
+
+		ThrowIfFailed(hr);
+	}
+
+	void D3D12PipelineCache::CopyDescription(Entry& entry, const D3D12_GRAPHICS_PIPELINE_STATE_DESC& desc)
+	{
+		entry.desc = desc;
+		entry.rootSignature = desc.pRootSignature;
+
+		D3D12_SHADER_BYTECODE* stages[] = { &entry.desc.VS, &entry.desc.PS, &entry.desc.DS, &entry.desc.HS, &entry.desc.GS };
+		for (size_t i = 0; i < std::size(stages); i++)
+		{
+			const uint8_t* bytecode = static_cast<const uint8_t*>(stages[i]->pShaderBytecode);
+			entry.shaderBytecode[i].assign(bytecode, bytecode + stages[i]->BytecodeLength);
+			stages[i]->pShaderBytecode = entry.shaderBytecode[i].empty() ? nullptr : entry.shaderBytecode[i].data();
+		}
+
+		entry.semanticNames.reserve(desc.InputLayout.NumElements);
+		entry.inputElements.assign(desc.InputLayout.pInputElementDescs, desc.InputLayout.pInputElementDescs + desc.InputLayout.NumElements);
+		for (D3D12_INPUT_ELEMENT_DESC& element : entry.inputElements)
+			entry.semanticNames.push_back(element.SemanticName);
+		for (size_t i = 0; i < entry.inputElements.size(); i++)
+			entry.inputElements[i].SemanticName = entry.semanticNames[i].c_str();
+		entry.desc.InputLayout.pInputElementDescs = entry.inputElements.empty() ? nullptr : entry.inputElements.data();
+
+		// The library takes the place of cached blobs
+		entry.desc.CachedPSO = {};
+	}
+
+	void D3D12PipelineCache::Compile(uint64_t key, Entry& entry)
+	{
+		const auto startTime = std::chrono::high_resolution_clock::now();
+		const std::wstring name = LibraryEntryName(key);
+
+		bool loaded = false;
+		if (m_library)
+		{
+			std::lock_guard<std::mutex> lock(m_libraryMutex);
+			if (m_index.Contains(key))
+				loaded = SUCCEEDED(m_library->LoadGraphicsPipeline(name.c_str(), &entry.desc, IID_PPV_ARGS(entry.pipelineState.GetAddressOf())));
+		}
+
+		bool compiled = false;
+		if (!loaded)
+			compiled = SUCCEEDED(m_device->CreateGraphicsPipelineState(&entry.desc, IID_PPV_ARGS(entry.pipelineState.ReleaseAndGetAddressOf())));
+
+		if (m_library && (loaded || compiled))
+		{
+			std::lock_guard<std::mutex> lock(m_libraryMutex);
+
+			// Fails with E_INVALIDARG when the name is already taken, the stored pipeline is then the same one
+			if (compiled && SUCCEEDED(m_library->StorePipeline(name.c_str(), entry.pipelineState.Get())))
+				m_libraryDirty = true;
+
+			m_index.MarkUsed(key);
+		}
+
+		const double elapsed = std::chrono::duration<double, std::milli>(std::chrono::high_resolution_clock::now() - startTime).count();
+		{
+			std::lock_guard<std::mutex> lock(m_statisticsMutex);
+			m_statistics.libraryHits += loaded ? 1 : 0;
+			m_statistics.compileCount += compiled ? 1 : 0;
+			m_statistics.failedCount += (loaded || compiled) ? 0 : 1;
+			m_statistics.totalCreateMilliseconds += elapsed;
+			m_statistics.maxCreateMilliseconds = std::max(m_statistics.maxCreateMilliseconds, elapsed);
+		}
+
+		entry.state.store((loaded || compiled) ? EntryState::Ready : EntryState::Failed, std::memory_order_release);
+	}
+
+	uint64_t D3D12PipelineCache::HashGraphicsDesc(const D3D12_GRAPHICS_PIPELINE_STATE_DESC& desc, uint64_t rootSignatureHash)
+	{
+		Common::StableHasher hasher;
+		hasher.Add(rootSignatureHash);
+
+		HashBytecode(hasher, desc.VS);
+		HashBytecode(hasher, desc.PS);
+		HashBytecode(hasher, desc.DS);
+		HashBytecode(hasher, desc.HS);
+		HashBytecode(hasher, desc.GS);
+
+		hasher.Add(desc.StreamOutput.NumEntries);
+		for (UINT i = 0; i < desc.StreamOutput.NumEntries; i++)
+		{
+			const D3D12_SO_DECLARATION_ENTRY& entry = desc.StreamOutput.pSODeclaration[i];
+			hasher.Add(entry.Stream).AddString(entry.SemanticName ? entry.SemanticName : "").Add(entry.SemanticIndex)
+				.Add(entry.StartComponent).Add(entry.ComponentCount).Add(entry.OutputSlot);
+		}
+		hasher.Add(desc.StreamOutput.NumStrides);
+		for (UINT i = 0; i < desc.StreamOutput.NumStrides; i++)
+			hasher.Add(desc.StreamOutput.pBufferStrides[i]);
+		hasher.Add(desc.StreamOutput.RasterizedStream);
+
+		hasher.Add(desc.BlendState.AlphaToCoverageEnable).Add(desc.BlendState.IndependentBlendEnable);
+		for (const D3D12_RENDER_TARGET_BLEND_DESC& blend : desc.BlendState.RenderTarget)
+		{
+			hasher.Add(blend.BlendEnable).Add(blend.LogicOpEnable)
+				.Add(blend.SrcBlend).Add(blend.DestBlend).Add(blend.BlendOp)
+				.Add(blend.SrcBlendAlpha).Add(blend.DestBlendAlpha).Add(blend.BlendOpAlpha)
+				.Add(blend.LogicOp).Add(blend.RenderTargetWriteMask);
+		}
+		hasher.Add(desc.SampleMask);
+
+		const D3D12_RASTERIZER_DESC& raster = desc.RasterizerState;
+		hasher.Add(raster.FillMode).Add(raster.CullMode).Add(raster.FrontCounterClockwise)
+			.Add(raster.DepthBias).Add(raster.DepthBiasClamp).Add(raster.SlopeScaledDepthBias)
+			.Add(raster.DepthClipEnable).Add(raster.MultisampleEnable).Add(raster.AntialiasedLineEnable)
+			.Add(raster.ForcedSampleCount).Add(raster.ConservativeRaster);
+
+		const D3D12_DEPTH_STENCIL_DESC& depth = desc.DepthStencilState;
+		hasher.Add(depth.DepthEnable).Add(depth.DepthWriteMask).Add(depth.DepthFunc)
+			.Add(depth.StencilEnable).Add(depth.StencilReadMask).Add(depth.StencilWriteMask);
+		for (const D3D12_DEPTH_STENCILOP_DESC& face : { depth.FrontFace, depth.BackFace })
+			hasher.Add(face.StencilFailOp).Add(face.StencilDepthFailOp).Add(face.StencilPassOp).Add(face.StencilFunc);
+
+		hasher.Add(desc.InputLayout.NumElements);
+		for (UINT i = 0; i < desc.InputLayout.NumElements; i++)
+		{
+			const D3D12_INPUT_ELEMENT_DESC& element = desc.InputLayout.pInputElementDescs[i];
+			hasher.AddString(element.SemanticName).Add(element.SemanticIndex).Add(element.Format).Add(element.InputSlot)
+				.Add(element.AlignedByteOffset).Add(element.InputSlotClass).Add(element.InstanceDataStepRate);
+		}
+
+		hasher.Add(desc.IBStripCutValue).Add(desc.PrimitiveTopologyType).Add(desc.NumRenderTargets);
+		for (DXGI_FORMAT format : desc.RTVFormats)
+			hasher.Add(format);
+		hasher.Add(desc.DSVFormat).Add(desc.SampleDesc.Count).Add(desc.SampleDesc.Quality).Add(desc.NodeMask).Add(desc.Flags);
+
+		return hasher.Finish();
+	}
+
+	uint64_t D3D12PipelineCache::RequestGraphics(const D3D12_GRAPHICS_PIPELINE_STATE_DESC& desc, uint64_t rootSignatureHash, ID3D12PipelineState* fallback)
+	{
+		const uint64_t key = HashGraphicsDesc(desc, rootSignatureHash);
+
+		Entry* entry;
+		{
+			std::lock_guard<std::mutex> lock(m_entryMutex);
+
+			auto [it, inserted] = m_entries.try_emplace(key);
+			if (!inserted)
+				return key;
+
+			it->second = std::make_unique<Entry>();
+			entry = it->second.get();
+			entry->fallback = fallback;
+			CopyDescription(*entry, desc);
+		}
+
+		{
+			std::lock_guard<std::mutex> lock(m_statisticsMutex);
+			m_statistics.requestCount++;
+		}
+
+		m_jobSystem->Submit([this, key, entry](uint32_t)
+		{
+			Compile(key, *entry);
+		}, &m_compileCounter);
+
+		return key;
+	}
+
+	ID3D12PipelineState* D3D12PipelineCache::Resolve(uint64_t key, PipelinePendingPolicy policy)
+	{
+		Entry* entry;
+		{
+			std::lock_guard<std::mutex> lock(m_entryMutex);
+
+			auto it = m_entries.find(key);
+			if (it == m_entries.end())
+				return nullptr;
+
+			entry = it->second.get();
+		}
+
+		EntryState state = entry->state.load(std::memory_order_acquire);
+		if (state == EntryState::Pending)
+		{
+			{
+				std::lock_guard<std::mutex> lock(m_statisticsMutex);
+				m_statistics.pendingResolves++;
+			}
+
+			switch (policy)
+			{
+			case PipelinePendingPolicy::SkipDraw:
+				return nullptr;
+
+			case PipelinePendingPolicy::UseFallback:
+				return entry->fallback.Get();
+
+			case PipelinePendingPolicy::Block:
+				// Helps with the queued jobs, so the compilation may well run on this thread
+				m_jobSystem->Wait(m_compileCounter);
+				state = entry->state.load(std::memory_order_acquire);
+				break;
+			}
+		}
+
+		return (state == EntryState::Ready) ? entry->pipelineState.Get() : nullptr;
+	}
+
+	bool D3D12PipelineCache::IsReady(uint64_t key) const
+	{
+		std::lock_guard<std::mutex> lock(m_entryMutex);
+
+		auto it = m_entries.find(key);
+		return it != m_entries.end() && it->second->state.load(std::memory_order_acquire) == EntryState::Ready;
+	}
+
+	void D3D12PipelineCache::WaitForPending()
+	{
+		m_jobSystem->Wait(m_compileCounter);
+	}
+
+	void D3D12PipelineCache::Save()
+	{
+		if (!m_library || m_libraryPath.empty())
+			return;
+
+		std::lock_guard<std::mutex> lock(m_libraryMutex);
+
+		if (m_libraryDirty)
+		{
+			std::vector<uint8_t> blob(m_library->GetSerializedSize());
+			ThrowIfFailed(m_library->Serialize(blob.data(), blob.size()));
+
+			if (!WriteFileAtomically(m_libraryPath, blob.data(), blob.size()))
+				return;
+
+			m_libraryFileHash = Common::StableHash(blob.data(), blob.size());
+			m_libraryDirty = false;
+		}
+
+		m_index.SetLibraryHash(m_libraryFileHash);
+
+		// Written even without new pipelines, it records which pipelines this run used
+		m_index.SaveToFile(m_indexPath);
+	}
+
+	D3D12PipelineCache::Statistics D3D12PipelineCache::GetStatistics() const
+	{
+		std::lock_guard<std::mutex> lock(m_statisticsMutex);
+		return m_statistics;
+	}
+}
@@ -0,0 +1,576 @@
+#include <directx/d3dx12.h>
+
+#include <algorithm>
+#include <cmath>
+#include <stdexcept>
+#include <string>
+
+#include <D3D12PostProcessor.h>
+#include <D3D12Utilities.h>
+
+using namespace Microsoft::WRL;
+
+namespace UltReality::Rendering::D3D12
+{
+	namespace
+	{
+		// Root parameters of every pass
+		constexpr uint32_t s_constantsParameter = 0;
+		constexpr uint32_t s_tableParameter = 1;
+		constexpr uint32_t s_parameterCount = 2;
+
+		// Descriptor table of a pass: source, auxiliary and exposure SRVs followed by destination and exposure UAVs
+		constexpr uint32_t s_sourceSlot = 0;
+		constexpr uint32_t s_auxiliarySlot = 1;
+		constexpr uint32_t s_exposureReadSlot = 2;
+		constexpr uint32_t s_destinationSlot = 3;
+		constexpr uint32_t s_exposureWriteSlot = 4;
+		constexpr uint32_t s_tableSize = 5;
+
+		constexpr uint32_t s_groupSize = 8;
+
+		// Preprocessor switch of every effect, in bit order
+		constexpr const char* s_effectDefines[Common::postEffectCount] = {
+			"EFFECT_CHROMATIC_ABERRATION", "EFFECT_BLOOM", "EFFECT_AUTO_EXPOSURE", "EFFECT_TONEMAP",
+			"EFFECT_COLOR_GRADING", "EFFECT_VIGNETTE", "EFFECT_SHARPEN", "EFFECT_FILM_GRAIN"
+		};
+
+		void WriteSrv(ID3D12Device* device, ID3D12Resource* resource, DXGI_FORMAT format, D3D12_CPU_DESCRIPTOR_HANDLE handle)
+		{
+			// Unused slots get a null view, the table is always fully populated
+			D3D12_SHADER_RESOURCE_VIEW_DESC desc = {};
+			desc.Format = format;
+			desc.ViewDimension = D3D12_SRV_DIMENSION_TEXTURE2D;
+			desc.Shader4ComponentMapping = D3D12_DEFAULT_SHADER_4_COMPONENT_MAPPING;
+			desc.Texture2D.MipLevels = 1;
+			device->CreateShaderResourceView(resource, &desc, handle);
+		}
+
+		void WriteUav(ID3D12Device* device, ID3D12Resource* resource, DXGI_FORMAT format, D3D12_CPU_DESCRIPTOR_HANDLE handle)
+		{
+			D3D12_UNORDERED_ACCESS_VIEW_DESC desc = {};
+			desc.Format = format;
+			desc.ViewDimension = D3D12_UAV_DIMENSION_TEXTURE2D;
+			device->CreateUnorderedAccessView(resource, nullptr, &desc, handle);
+		}
+	}
+
+	// Passes reading the scene color sample it through SampleSource, which upscales it when the scene was drawn below
+	// full scale. Downsampling averages a 4x4 footprint with four bilinear taps. Upsampling filters the bloom below with a 3x3 tent
+	// and adds the pyramid level of its own size, so the finest bloom level holds the sum of every level. Fused passes
+	// apply their effects in bit order, only the first of them may read neighboring pixels of the source
+	const char* const D3D12PostProcessor::shaderSource = R"(
+cbuffer PassConstants : register(b0)
+{
+	uint2 outputSize;
+	float bloomWeight;
+	float bloomIntensity;
+	float exposureScale;
+	float adaptation;
+	float saturation;
+	float contrast;
+	float3 colorFilter;
+	float vignetteStrength;
+	float chromaticAberration;
+	float sharpenStrength;
+	float filmGrainStrength;
+	uint frameIndex;
+	float2 sourceUVScale;
+	float2 sourceUVMax;
+};
+
+Texture2D<float4> source : register(t0);
+Texture2D<float4> auxiliary : register(t1);
+Texture2D<float> exposureRead : register(t2);
+RWTexture2D<float4> destination : register(u0);
+RWTexture2D<float> exposureWrite : register(u1);
+SamplerState linearClamp : register(s0);
+
+#define GROUP_SIZE 8
+#define EXPOSURE_GROUP_SIZE 16
+
+float Luminance(float3 color)
+{
+	return dot(color, float3(0.2126, 0.7152, 0.0722));
+}
+
+float2 PixelUV(uint2 pixel)
+{
+	return (float2(pixel) + 0.5) / float2(outputSize);
+}
+
+// Maps an output UV onto the part of the source that holds the image. Below full scale the scene covers the top left
+// of the scene color and is upscaled bilinearly, the clamp keeps the filter from reaching past its edge
+float3 SampleSource(float2 uv)
+{
+	return source.SampleLevel(linearClamp, min(uv * sourceUVScale, sourceUVMax), 0).rgb;
+}
+
+float3 LoadSource(int2 pixel)
+{
+	return SampleSource(PixelUV(uint2(clamp(pixel, int2(0, 0), int2(outputSize) - 1))));
+}
+
+float Hash(uint2 pixel, uint frame)
+{
+	uint h = pixel.x * 1973u + pixel.y * 9277u + frame * 26699u;
+	h = (h ^ 61u) ^ (h >> 16);
+	h *= 9u;
+	h ^= h >> 4;
+	h *= 0x27d4eb2du;
+	h ^= h >> 15;
+	return float(h) * (1.0 / 4294967295.0);
+}
+
+[numthreads(GROUP_SIZE, GROUP_SIZE, 1)]
+void Downsample(uint3 dispatchId : SV_DispatchThreadID)
+{
+	if (any(dispatchId.xy >= outputSize))
+		return;
+
+	// Half an output texel is one texel of the source
+	const float2 uv = PixelUV(dispatchId.xy);
+	const float2 offset = 0.5 / float2(outputSize);
+	float3 color = SampleSource(uv + float2(-offset.x, -offset.y));
+	color += SampleSource(uv + float2(offset.x, -offset.y));
+	color += SampleSource(uv + float2(-offset.x, offset.y));
+	color += SampleSource(uv + float2(offset.x, offset.y));
+	destination[dispatchId.xy] = float4(color * 0.25, 1.0);
+}
+
+[numthreads(GROUP_SIZE, GROUP_SIZE, 1)]
+void Upsample(uint3 dispatchId : SV_DispatchThreadID)
+{
+	if (any(dispatchId.xy >= outputSize))
+		return;
+
+	const float2 uv = PixelUV(dispatchId.xy);
+	const float2 texel = 1.0 / float2(outputSize);
+	float3 bloom = source.SampleLevel(linearClamp, uv, 0).rgb * 4.0;
+	bloom += source.SampleLevel(linearClamp, uv + float2(-texel.x, 0.0), 0).rgb * 2.0;
+	bloom += source.SampleLevel(linearClamp, uv + float2(texel.x, 0.0), 0).rgb * 2.0;
+	bloom += source.SampleLevel(linearClamp, uv + float2(0.0, -texel.y), 0).rgb * 2.0;
+	bloom += source.SampleLevel(linearClamp, uv + float2(0.0, texel.y), 0).rgb * 2.0;
+	bloom += source.SampleLevel(linearClamp, uv + float2(-texel.x, -texel.y), 0).rgb;
+	bloom += source.SampleLevel(linearClamp, uv + float2(texel.x, -texel.y), 0).rgb;
+	bloom += source.SampleLevel(linearClamp, uv + float2(-texel.x, texel.y), 0).rgb;
+	bloom += source.SampleLevel(linearClamp, uv + float2(texel.x, texel.y), 0).rgb;
+	destination[dispatchId.xy] = float4(auxiliary.Load(int3(dispatchId.xy, 0)).rgb + bloom * (1.0 / 16.0), 1.0);
+}
+
+groupshared float sharedLogLuminance[EXPOSURE_GROUP_SIZE * EXPOSURE_GROUP_SIZE];
+
+[numthreads(EXPOSURE_GROUP_SIZE, EXPOSURE_GROUP_SIZE, 1)]
+void Exposure(uint3 groupThreadId : SV_GroupThreadID, uint groupIndex : SV_GroupIndex)
+{
+	uint2 size;
+	source.GetDimensions(size.x, size.y);
+
+	float sum = 0.0;
+	for (uint y = groupThreadId.y; y < size.y; y += EXPOSURE_GROUP_SIZE)
+	{
+		for (uint x = groupThreadId.x; x < size.x; x += EXPOSURE_GROUP_SIZE)
+			sum += log2(max(Luminance(source.Load(int3(x, y, 0)).rgb), 1e-4));
+	}
+	sharedLogLuminance[groupIndex] = sum;
+	GroupMemoryBarrierWithGroupSync();
+
+	for (uint stride = EXPOSURE_GROUP_SIZE * EXPOSURE_GROUP_SIZE / 2; stride > 0; stride >>= 1)
+	{
+		if (groupIndex < stride)
+			sharedLogLuminance[groupIndex] += sharedLogLuminance[groupIndex + stride];
+		GroupMemoryBarrierWithGroupSync();
+	}
+
+	if (groupIndex == 0)
+	{
+		// Maps the geometric mean luminance to middle grey. Adapts in stops, a texture that was never written holds zero
+		const float target = 0.18 / exp2(sharedLogLuminance[0] / float(size.x * size.y));
+		const float previous = exposureWrite[uint2(0, 0)];
+		exposureWrite[uint2(0, 0)] = previous > 0.0 ? exp2(lerp(log2(previous), log2(target), adaptation)) : target;
+	}
+}
+
+float3 ApplyEffects(uint2 pixel)
+{
+	const float2 uv = PixelUV(pixel);
+
+#if EFFECT_CHROMATIC_ABERRATION
+	const float2 offset = (uv - 0.5) * (2.0 * chromaticAberration);
+	float3 color;
+	color.r = SampleSource(uv - offset).r;
+	color.g = LoadSource(pixel).g;
+	color.b = SampleSource(uv + offset).b;
+#elif EFFECT_SHARPEN
+	const float3 center = LoadSource(pixel);
+	const float3 neighbors = LoadSource(int2(pixel) + int2(-1, 0)) + LoadSource(int2(pixel) + int2(1, 0))
+		+ LoadSource(int2(pixel) + int2(0, -1)) + LoadSource(int2(pixel) + int2(0, 1));
+	float3 color = max(center + (4.0 * center - neighbors) * sharpenStrength, 0.0);
+#else
+	float3 color = LoadSource(pixel);
+#endif
+
+#if EFFECT_BLOOM
+	color = lerp(color, auxiliary.SampleLevel(linearClamp, uv, 0).rgb * bloomWeight, bloomIntensity);
+#endif
+
+#if EFFECT_AUTO_EXPOSURE
+	color *= exposureRead.Load(int3(0, 0, 0)) * exposureScale;
+#endif
+
+#if EFFECT_TONEMAP
+	// Fitted ACES curve
+	color = saturate(color * (2.51 * color + 0.03) / (color * (2.43 * color + 0.59) + 0.14));
+#endif
+
+#if EFFECT_COLOR_GRADING
+	color = lerp(Luminance(color).xxx, color, saturation);
+	color = max((color - 0.5) * contrast + 0.5, 0.0) * colorFilter;
+#endif
+
+#if EFFECT_VIGNETTE
+	const float2 fromCenter = uv - 0.5;
+	color *= saturate(1.0 - vignetteStrength * 4.0 * dot(fromCenter, fromCenter));
+#endif
+
+#if EFFECT_FILM_GRAIN
+	color += (Hash(pixel, frameIndex) - 0.5) * filmGrainStrength;
+#endif
+
+	return color;
+}
+
+[numthreads(GROUP_SIZE, GROUP_SIZE, 1)]
+void FusedCS(uint3 dispatchId : SV_DispatchThreadID)
+{
+	if (any(dispatchId.xy >= outputSize))
+		return;
+
+	destination[dispatchId.xy] = float4(ApplyEffects(dispatchId.xy), 1.0);
+}
+
+float4 FullscreenVS(uint vertexId : SV_VertexID) : SV_Position
+{
+	const float2 uv = float2((vertexId << 1) & 2, vertexId & 2);
+	return float4(uv * float2(2.0, -2.0) + float2(-1.0, 1.0), 0.0, 1.0);
+}
+
+float4 FusedPS(float4 position : SV_Position) : SV_Target
+{
+	return float4(ApplyEffects(uint2(position.xy)), 1.0);
+}
+)";
+
+	D3D12PostProcessor::D3D12PostProcessor(ID3D12Device* device, Common::IShaderCompiler* compiler, Common::IShaderIncludeResolver* includeResolver,
+		D3D12UploadRing* uploadRing, D3D12DescriptorRing* descriptorRing, DXGI_FORMAT outputFormat)
+		: m_device(device), m_compiler(compiler), m_includeResolver(includeResolver), m_uploadRing(uploadRing),
+		m_descriptorRing(descriptorRing), m_outputFormat(outputFormat)
+	{
+		CD3DX12_DESCRIPTOR_RANGE ranges[2];
+		ranges[0].Init(D3D12_DESCRIPTOR_RANGE_TYPE_SRV, 3, 0);
+		ranges[1].Init(D3D12_DESCRIPTOR_RANGE_TYPE_UAV, 2, 0);
+
+		CD3DX12_ROOT_PARAMETER parameters[s_parameterCount];
+		parameters[s_constantsParameter].InitAsConstantBufferView(0);
+		parameters[s_tableParameter].InitAsDescriptorTable(_countof(ranges), ranges);
+
+		const CD3DX12_STATIC_SAMPLER_DESC linearClamp(0, D3D12_FILTER_MIN_MAG_MIP_LINEAR,
+			D3D12_TEXTURE_ADDRESS_MODE_CLAMP, D3D12_TEXTURE_ADDRESS_MODE_CLAMP, D3D12_TEXTURE_ADDRESS_MODE_CLAMP);
+
+		const CD3DX12_ROOT_SIGNATURE_DESC rootSignatureDesc(s_parameterCount, parameters, 1, &linearClamp);
+
+		ComPtr<ID3DBlob> serialized;
+		ComPtr<ID3DBlob> errors;
+		const HRESULT hr = D3D12SerializeRootSignature(&rootSignatureDesc, D3D_ROOT_SIGNATURE_VERSION_1, serialized.GetAddressOf(), errors.GetAddressOf());
+		if (FAILED(hr) && errors != nullptr)
+			throw std::runtime_error(std::string(static_cast<const char*>(errors->GetBufferPointer()), errors->GetBufferSize()));
+		ThrowIfFailed(hr);
+
+		ThrowIfFailed(m_device->CreateRootSignature(0, serialized->GetBufferPointer(), serialized->GetBufferSize(), IID_PPV_ARGS(m_rootSignature.GetAddressOf())));
+
+		m_downsamplePipeline = CreateComputePipeline("Downsample", Common::PostEffect::None);
+		m_upsamplePipeline = CreateComputePipeline("Upsample", Common::PostEffect::None);
+		m_exposurePipeline = CreateComputePipeline("Exposure", Common::PostEffect::None);
+		m_fullscreenVertexShader = CompileShader("FullscreenVS", "vs_6_0", Common::PostEffect::None);
+
+		// Committed resources start zeroed, which the exposure pass reads as no history
+		const CD3DX12_HEAP_PROPERTIES heapProperties(D3D12_HEAP_TYPE_DEFAULT);
+		const CD3DX12_RESOURCE_DESC exposureDesc = CD3DX12_RESOURCE_DESC::Tex2D(DXGI_FORMAT_R32_FLOAT, 1, 1, 1, 1, 1, 0, D3D12_RESOURCE_FLAG_ALLOW_UNORDERED_ACCESS);
+		ThrowIfFailed(m_device->CreateCommittedResource(&heapProperties, D3D12_HEAP_FLAG_NONE, &exposureDesc, D3D12_RESOURCE_STATE_UNORDERED_ACCESS,
+			nullptr, IID_PPV_ARGS(m_exposure.GetAddressOf())));
+	}
+
+	std::vector<uint8_t> D3D12PostProcessor::CompileShader(const char* entryPoint, const char* target, Common::PostEffect effects) const
+	{
+		Common::ShaderCompileRequest request;
+		request.sourcePath = "PostProcess.hlsl";
+		request.entryPoint = entryPoint;
+		request.target = target;
+		for (uint32_t bit = 0; bit < Common::postEffectCount; bit++)
+		{
+			if ((effects & static_cast<Common::PostEffect>(1u << bit)) != Common::PostEffect::None)
+				request.defines.push_back({ s_effectDefines[bit], "" });
+		}
+
+		std::vector<uint8_t> bytecode;
+		std::string messages;
+		if (!m_compiler->Compile(request, shaderSource, *m_includeResolver, bytecode, messages))
+			throw std::runtime_error(messages);
+
+		return bytecode;
+	}
+
+	ComPtr<ID3D12PipelineState> D3D12PostProcessor::CreateComputePipeline(const char* entryPoint, Common::PostEffect effects) const
+	{
+		const std::vector<uint8_t> bytecode = CompileShader(entryPoint, "cs_6_0", effects);
+
+		D3D12_COMPUTE_PIPELINE_STATE_DESC pipelineDesc = {};
+		pipelineDesc.pRootSignature = m_rootSignature.Get();
+		pipelineDesc.CS = { bytecode.data(), bytecode.size() };
+
+		ComPtr<ID3D12PipelineState> pipeline;
+		ThrowIfFailed(m_device->CreateComputePipelineState(&pipelineDesc, IID_PPV_ARGS(pipeline.GetAddressOf())));
+
+		return pipeline;
+	}
+
+	ID3D12PipelineState* D3D12PostProcessor::GetFusedPipeline(Common::PostEffect effects, bool drawsOutput)
+	{
+		auto& pipelines = drawsOutput ? m_fusedOutputPipelines : m_fusedComputePipelines;
+		ComPtr<ID3D12PipelineState>& pipeline = pipelines[static_cast<uint32_t>(effects)];
+		if (pipeline != nullptr)
+			return pipeline.Get();
+
+		if (!drawsOutput)
+		{
+			pipeline = CreateComputePipeline("FusedCS", effects);
+			return pipeline.Get();
+		}
+
+		const std::vector<uint8_t> pixelShader = CompileShader("FusedPS", "ps_6_0", effects);
+
+		D3D12_GRAPHICS_PIPELINE_STATE_DESC pipelineDesc = {};
+		pipelineDesc.pRootSignature = m_rootSignature.Get();
+		pipelineDesc.VS = { m_fullscreenVertexShader.data(), m_fullscreenVertexShader.size() };
+		pipelineDesc.PS = { pixelShader.data(), pixelShader.size() };
+		pipelineDesc.BlendState = CD3DX12_BLEND_DESC(D3D12_DEFAULT);
+		pipelineDesc.SampleMask = UINT_MAX;
+		pipelineDesc.RasterizerState = CD3DX12_RASTERIZER_DESC(D3D12_DEFAULT);
+		pipelineDesc.RasterizerState.CullMode = D3D12_CULL_MODE_NONE;
+		pipelineDesc.DepthStencilState.DepthEnable = FALSE;
+		pipelineDesc.DepthStencilState.StencilEnable = FALSE;
+		pipelineDesc.PrimitiveTopologyType = D3D12_PRIMITIVE_TOPOLOGY_TYPE_TRIANGLE;
+		pipelineDesc.NumRenderTargets = 1;
+		pipelineDesc.RTVFormats[0] = m_outputFormat;
+		pipelineDesc.SampleDesc.Count = 1;
+		ThrowIfFailed(m_device->CreateGraphicsPipelineState(&pipelineDesc, IID_PPV_ARGS(pipeline.GetAddressOf())));
+
+		return pipeline.Get();
+	}
+
+	void D3D12PostProcessor::SetConfig(const Common::PostProcessConfig& config)
+	{
+		// Planning validates the config, the size does not matter for that
+		Common::PostProcessPlan plan;
+		Common::BuildPostProcessPlan(config, 1, 1, plan);
+
+		m_config = config;
+		m_planDirty = true;
+	}
+
+	const Common::PostProcessConfig& D3D12PostProcessor::GetConfig() const
+	{
+		return m_config;
+	}
+
+	void D3D12PostProcessor::AddPasses(D3D12RenderGraph& graph, Common::RenderGraphResource sceneColor, Common::RenderGraphResource output,
+		D3D12_CPU_DESCRIPTOR_HANDLE outputRtv, uint32_t width, uint32_t height, uint32_t sourceWidth, uint32_t sourceHeight, float deltaTime)
+	{
+		using Common::ResourceState;
+		using Common::PostEffect;
+		using Kind = Common::PostProcessTarget::Kind;
+
+		if (m_planDirty || width != m_planWidth || height != m_planHeight)
+		{
+			Common::BuildPostProcessPlan(m_config, width, height, m_plan);
+			m_planWidth = width;
+			m_planHeight = height;
+			m_planDirty = false;
+		}
+
+		if (sourceWidth == 0 || sourceHeight == 0 || sourceWidth > width || sourceHeight > height)
+			throw std::invalid_argument("The drawn part of the scene color must be non-empty and fit into it");
+
+		PassConstants constants = {};
+		constants.bloomWeight = m_plan.bloomLevels > 0 ? 1.0f / static_cast<float>(m_plan.bloomLevels) : 0.0f;
+		constants.bloomIntensity = m_config.bloomIntensity;
+		constants.exposureScale = std::exp2(m_config.exposureCompensation);
+		constants.adaptation = 1.0f - std::exp(-std::max(deltaTime, 0.0f) * m_config.exposureAdaptationRate);
+		constants.saturation = m_config.saturation;
+		constants.contrast = m_config.contrast;
+		for (uint32_t i = 0; i < 3; i++)
+			constants.colorFilter[i] = m_config.colorFilter[i];
+		constants.vignetteStrength = m_config.vignetteStrength;
+		constants.chromaticAberration = m_config.chromaticAberration;
+		constants.sharpenStrength = m_config.sharpenStrength;
+		constants.filmGrainStrength = m_config.filmGrainStrength;
+		constants.frameIndex = m_frameIndex++;
+
+		Common::RenderGraphResource exposure = m_plan.exposureLevel > 0
+			? graph.Import("PostExposure", m_exposure.Get(), ResourceState::UnorderedAccess, ResourceState::UnorderedAccess)
+			: Common::invalidRenderGraphResource;
+
+		// Targets are created by the pass that first writes them
+		std::vector<Common::RenderGraphResource> pyramid(m_plan.pyramidLevels + 1, Common::invalidRenderGraphResource);
+		std::vector<Common::RenderGraphResource> bloom(m_plan.pyramidLevels + 1, Common::invalidRenderGraphResource);
+		Common::RenderGraphResource intermediates[2] = { Common::invalidRenderGraphResource, Common::invalidRenderGraphResource };
+		const auto resolve = [&](const Common::PostProcessTarget& target) -> Common::RenderGraphResource&
+		{
+			switch (target.kind)
+			{
+			case Kind::Pyramid:
+				return pyramid[target.index];
+			case Kind::Bloom:
+				return bloom[target.index];
+			case Kind::Intermediate:
+				return intermediates[target.index];
+			case Kind::Exposure:
+				return exposure;
+			case Kind::Output:
+				return output;
+			case Kind::SceneColor:
+			default:
+				return sceneColor;
+			}
+		};
+
+		for (const Common::PostProcessPass& pass : m_plan.passes)
+		{
+			PassResources resources;
+			resources.drawsOutput = pass.output.kind == Kind::Output;
+			resources.outputRtv = outputRtv;
+			resources.constants = constants;
+			resources.constants.outputSize[0] = pass.width;
+			resources.constants.outputSize[1] = pass.height;
+
+			// Passes reading the scene color upscale the part the scene was drawn into, the others read whole targets
+			const bool readsScene = pass.input.kind == Kind::SceneColor;
+			resources.constants.sourceUVScale[0] = readsScene ? static_cast<float>(sourceWidth) / static_cast<float>(width) : 1.0f;
+			resources.constants.sourceUVScale[1] = readsScene ? static_cast<float>(sourceHeight) / static_cast<float>(height) : 1.0f;
+			resources.constants.sourceUVMax[0] = readsScene ? (static_cast<float>(sourceWidth) - 0.5f) / static_cast<float>(width) : 1.0f;
+			resources.constants.sourceUVMax[1] = readsScene ? (static_cast<float>(sourceHeight) - 0.5f) / static_cast<float>(height) : 1.0f;
+
+			Common::RenderGraphResource& target = resolve(pass.output);
+			if (target == Common::invalidRenderGraphResource)
+			{
+				// Intermediates are only written by compute passes that overwrite every texel, so they need no clear.
+				// Without the render target flag they also need no discard after aliasing, except on heap tier 1 where
+				// the graph only places render targets and discards them before the first write
+				D3D12_RESOURCE_FLAGS flags = D3D12_RESOURCE_FLAG_ALLOW_UNORDERED_ACCESS;
+				if (!graph.SupportsNonTargetTransients())
+					flags |= D3D12_RESOURCE_FLAG_ALLOW_RENDER_TARGET;
+
+				const CD3DX12_RESOURCE_DESC desc = CD3DX12_RESOURCE_DESC::Tex2D(colorFormat, pass.width, pass.height, 1, 1, 1, 0, flags);
+				const char* name = pass.output.kind == Kind::Pyramid ? "PostPyramid" : pass.output.kind == Kind::Bloom ? "PostBloom" : "PostIntermediate";
+				target = graph.CreateTexture(name + std::to_string(pass.output.index), desc);
+			}
+			resources.input = resolve(pass.input);
+
+			const char* passName = "PostFused";
+			switch (pass.type)
+			{
+			case Common::PostProcessPass::Type::Downsample:
+				passName = "PostDownsample";
+				resources.pipeline = m_downsamplePipeline.Get();
+				resources.output = target;
+				break;
+			case Common::PostProcessPass::Type::Upsample:
+				passName = "PostUpsample";
+				resources.pipeline = m_upsamplePipeline.Get();
+				resources.auxiliary = pyramid[pass.output.index];
+				resources.output = target;
+				break;
+			case Common::PostProcessPass::Type::Exposure:
+				passName = "PostExposure";
+				resources.pipeline = m_exposurePipeline.Get();
+				resources.exposureWrite = exposure;
+				break;
+			case Common::PostProcessPass::Type::Fused:
+				resources.pipeline = GetFusedPipeline(pass.effects, resources.drawsOutput);
+				if ((pass.effects & PostEffect::Bloom) != PostEffect::None)
+					resources.auxiliary = resolve(m_plan.bloomSource);
+				if ((pass.effects & PostEffect::AutoExposure) != PostEffect::None)
+					resources.exposureRead = exposure;
+				resources.output = target;
+				break;
+			}
+
+			const uint32_t graphPass = graph.AddPass(passName, [this, &graph, resources](ID3D12GraphicsCommandList* cmdList)
+			{
+				RecordPass(cmdList, graph, resources);
+			});
+
+			const ResourceState readState = resources.drawsOutput ? ResourceState::PixelShaderResource : ResourceState::NonPixelShaderResource;
+			graph.Read(graphPass, resources.input, readState);
+			if (resources.auxiliary != Common::invalidRenderGraphResource)
+				graph.Read(graphPass, resources.auxiliary, readState);
+			if (resources.exposureRead != Common::invalidRenderGraphResource)
+				graph.Read(graphPass, resources.exposureRead, readState);
+			if (resources.exposureWrite != Common::invalidRenderGraphResource)
+				graph.Write(graphPass, resources.exposureWrite, ResourceState::UnorderedAccess);
+			if (resources.output != Common::invalidRenderGraphResource)
+				graph.Write(graphPass, resources.output, resources.drawsOutput ? ResourceState::RenderTarget : ResourceState::UnorderedAccess);
+		}
+	}
+
+	void D3D12PostProcessor::RecordPass(ID3D12GraphicsCommandList* cmdList, const D3D12RenderGraph& graph, const PassResources& resources)
+	{
+		const auto resourceOf = [&graph](Common::RenderGraphResource resource) -> ID3D12Resource*
+		{
+			return resource != Common::invalidRenderGraphResource ? graph.GetResource(resource) : nullptr;
+		};
+
+		const D3D12DescriptorTable table = m_descriptorRing->Allocate(s_tableSize);
+		WriteSrv(m_device, resourceOf(resources.input), colorFormat, table.CpuHandle(s_sourceSlot));
+		WriteSrv(m_device, resourceOf(resources.auxiliary), colorFormat, table.CpuHandle(s_auxiliarySlot));
+		WriteSrv(m_device, resourceOf(resources.exposureRead), DXGI_FORMAT_R32_FLOAT, table.CpuHandle(s_exposureReadSlot));
+		WriteUav(m_device, resources.drawsOutput ? nullptr : resourceOf(resources.output), colorFormat, table.CpuHandle(s_destinationSlot));
+		WriteUav(m_device, resourceOf(resources.exposureWrite), DXGI_FORMAT_R32_FLOAT, table.CpuHandle(s_exposureWriteSlot));
+
+		ID3D12DescriptorHeap* descriptorHeaps[] = { m_descriptorRing->Heap() };
+		cmdList->SetDescriptorHeaps(_countof(descriptorHeaps), descriptorHeaps);
+		cmdList->SetPipelineState(resources.pipeline);
+
+		const D3D12_GPU_VIRTUAL_ADDRESS constants = m_uploadRing->PushConstants(resources.constants);
+		const uint32_t width = resources.constants.outputSize[0];
+		const uint32_t height = resources.constants.outputSize[1];
+
+		if (resources.drawsOutput)
+		{
+			cmdList->SetGraphicsRootSignature(m_rootSignature.Get());
+			cmdList->SetGraphicsRootConstantBufferView(s_constantsParameter, constants);
+			cmdList->SetGraphicsRootDescriptorTable(s_tableParameter, table.gpuStart);
+
+			const D3D12_VIEWPORT viewport = { 0.0f, 0.0f, static_cast<float>(width), static_cast<float>(height), 0.0f, 1.0f };
+			const D3D12_RECT scissor = { 0, 0, static_cast<LONG>(width), static_cast<LONG>(height) };
+			cmdList->RSSetViewports(1, &viewport);
+			cmdList->RSSetScissorRects(1, &scissor);
+			cmdList->OMSetRenderTargets(1, &resources.outputRtv, FALSE, nullptr);
+			cmdList->IASetPrimitiveTopology(D3D_PRIMITIVE_TOPOLOGY_TRIANGLELIST);
+			cmdList->DrawInstanced(3, 1, 0, 0);
+			return;
+		}
+
+		cmdList->SetComputeRootSignature(m_rootSignature.Get());
+		cmdList->SetComputeRootConstantBufferView(s_constantsParameter, constants);
+		cmdList->SetComputeRootDescriptorTable(s_tableParameter, table.gpuStart);
+
+		// The exposure reduction writes a single texel, so it is a single group looping over its level
+		cmdList->Dispatch((width + s_groupSize - 1) / s_groupSize, (height + s_groupSize - 1) / s_groupSize, 1);
+	}
+
+	const Common::PostProcessPlan& D3D12PostProcessor::GetPlan() const
+	{
+		return m_plan;
+	}
+}
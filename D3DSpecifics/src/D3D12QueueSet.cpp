@@ -0,0 +1,114 @@
+#include <stdexcept>
+
+#include <D3D12QueueSet.h>
+#include <D3D12Utilities.h>
+
+using namespace Microsoft::WRL;
+
+namespace UltReality::Rendering::D3D12
+{
+	D3D12QueueSet::D3D12QueueSet(ID3D12Device* device, ID3D12CommandQueue* graphicsQueue, D3D12FenceTimeline* graphicsTimeline)
+	{
+		if (graphicsQueue == nullptr || graphicsTimeline == nullptr)
+			throw std::invalid_argument("D3D12QueueSet requires the graphics queue and its fence timeline");
+
+		Queue& graphics = QueueOf(Common::QueueType::Graphics);
+		graphics.queue = graphicsQueue;
+		graphics.timeline = graphicsTimeline;
+
+		const std::pair<Common::QueueType, D3D12_COMMAND_LIST_TYPE> createdQueues[] = {
+			{ Common::QueueType::Compute, D3D12_COMMAND_LIST_TYPE_COMPUTE },
+			{ Common::QueueType::Copy, D3D12_COMMAND_LIST_TYPE_COPY }
+		};
+
+		for (const auto& [type, listType] : createdQueues)
+		{
+			Queue& queue = QueueOf(type);
+
+			D3D12_COMMAND_QUEUE_DESC queueDesc = {};
+			queueDesc.Type = listType;
+			queueDesc.Flags = D3D12_COMMAND_QUEUE_FLAG_NONE;
+			ThrowIfFailed(device->CreateCommandQueue(&queueDesc, IID_PPV_ARGS(queue.queue.GetAddressOf())));
+
+			ThrowIfFailed(device->CreateFence(0, D3D12_FENCE_FLAG_NONE, IID_PPV_ARGS(queue.fence.GetAddressOf())));
+
+			queue.ownedTimeline = std::make_unique<D3D12FenceTimeline>(queue.fence.Get(), queue.queue.Get());
+			queue.timeline = queue.ownedTimeline.get();
+		}
+	}
+
+	D3D12QueueSet::Queue& D3D12QueueSet::QueueOf(Common::QueueType type)
+	{
+		return m_queues[static_cast<uint32_t>(type)];
+	}
+
+	const D3D12QueueSet::Queue& D3D12QueueSet::QueueOf(Common::QueueType type) const
+	{
+		return m_queues[static_cast<uint32_t>(type)];
+	}
+
+	uint32_t D3D12QueueSet::Submit(Common::QueueType queue, const std::vector<ID3D12CommandList*>& lists, const std::vector<uint32_t>& dependencies)
+	{
+		const uint32_t submission = m_scheduler.Add(queue, dependencies);
+		m_submissionLists.push_back(lists);
+
+		return submission;
+	}
+
+	void D3D12QueueSet::Flush()
+	{
+		const Common::QueueSchedule schedule = m_scheduler.Resolve(Common::QueueType::Graphics);
+		const std::vector<Common::QueueSubmission>& submissions = m_scheduler.GetSubmissions();
+
+		m_signalValues.assign(submissions.size(), 0);
+
+		// Waits only ever refer to earlier submissions, so their fence values are known by the time they are needed
+		for (uint32_t index = 0; index < submissions.size(); index++)
+		{
+			Queue& queue = QueueOf(submissions[index].queue);
+			const Common::ScheduledSubmission& scheduled = schedule.submissions[index];
+
+			for (uint32_t wait : scheduled.waits)
+				ThrowIfFailed(queue.queue->Wait(QueueOf(submissions[wait].queue).timeline->Fence(), m_signalValues[wait]));
+
+			const std::vector<ID3D12CommandList*>& lists = m_submissionLists[index];
+			if (!lists.empty())
+				queue.queue->ExecuteCommandLists(static_cast<UINT>(lists.size()), lists.data());
+
+			if (scheduled.signal)
+				m_signalValues[index] = queue.timeline->Signal();
+		}
+
+		Queue& graphics = QueueOf(Common::QueueType::Graphics);
+		for (uint32_t wait : schedule.joinWaits)
+			ThrowIfFailed(graphics.queue->Wait(QueueOf(submissions[wait].queue).timeline->Fence(), m_signalValues[wait]));
+
+		m_scheduler.Reset();
+		m_submissionLists.clear();
+	}
+
+	std::vector<uint32_t> D3D12QueueSet::GetPendingSubmissions() const
+	{
+		std::vector<uint32_t> pending(m_scheduler.GetSubmissionCount());
+		for (uint32_t i = 0; i < pending.size(); i++)
+			pending[i] = i;
+
+		return pending;
+	}
+
+	ID3D12CommandQueue* D3D12QueueSet::GetQueue(Common::QueueType queue) const
+	{
+		return QueueOf(queue).queue.Get();
+	}
+
+	D3D12FenceTimeline* D3D12QueueSet::GetTimeline(Common::QueueType queue) const
+	{
+		return QueueOf(queue).timeline;
+	}
+
+	void D3D12QueueSet::WaitForIdle()
+	{
+		for (Queue& queue : m_queues)
+			queue.timeline->WaitForValue(queue.timeline->Signal());
+	}
+}
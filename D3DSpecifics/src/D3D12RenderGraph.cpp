@@ -0,0 +1,424 @@
+#include <directx/d3dx12.h>
+
+#include <algorithm>
+#include <cstring>
+#include <numeric>
+#include <stdexcept>
+
+#include <D3D12RenderGraph.h>
+#include <D3D12Utilities.h>
+
+using namespace Microsoft::WRL;
+
+namespace UltReality::Rendering::D3D12
+{
+	namespace
+	{
+		bool SameDesc(const D3D12_RESOURCE_DESC& a, const D3D12_RESOURCE_DESC& b)
+		{
+			return a.Dimension == b.Dimension && a.Alignment == b.Alignment && a.Width == b.Width && a.Height == b.Height
+				&& a.DepthOrArraySize == b.DepthOrArraySize && a.MipLevels == b.MipLevels && a.Format == b.Format
+				&& a.SampleDesc.Count == b.SampleDesc.Count && a.SampleDesc.Quality == b.SampleDesc.Quality
+				&& a.Layout == b.Layout && a.Flags == b.Flags;
+		}
+
+		bool SameClearValue(bool hasA, const D3D12_CLEAR_VALUE& a, bool hasB, const D3D12_CLEAR_VALUE& b)
+		{
+			if (hasA != hasB)
+				return false;
+
+			// Clear values are zero initialized before being copied in, so the whole union can be compared
+			return !hasA || std::memcmp(&a, &b, sizeof(D3D12_CLEAR_VALUE)) == 0;
+		}
+
+		// State DiscardResource needs the texture in, or Common for textures that need no initialization after aliasing
+		Common::ResourceState DiscardState(const D3D12_RESOURCE_DESC& desc)
+		{
+			if (desc.Flags & D3D12_RESOURCE_FLAG_ALLOW_RENDER_TARGET)
+				return Common::ResourceState::RenderTarget;
+			if (desc.Flags & D3D12_RESOURCE_FLAG_ALLOW_DEPTH_STENCIL)
+				return Common::ResourceState::DepthWrite;
+
+			return Common::ResourceState::Common;
+		}
+	}
+
+	D3D12RenderGraph::D3D12RenderGraph(ID3D12Device* device)
+		: m_device(device)
+	{
+		// Tier 1 hardware cannot mix render targets with other textures in one heap, so transients are limited
+		// to render target and depth textures there
+		D3D12_FEATURE_DATA_D3D12_OPTIONS options = {};
+		ThrowIfFailed(m_device->CheckFeatureSupport(D3D12_FEATURE_D3D12_OPTIONS, &options, sizeof(options)));
+
+		m_heapFlags = (options.ResourceHeapTier >= D3D12_RESOURCE_HEAP_TIER_2)
+			? D3D12_HEAP_FLAG_ALLOW_ALL_BUFFERS_AND_TEXTURES
+			: D3D12_HEAP_FLAG_ALLOW_ONLY_RT_DS_TEXTURES;
+	}
+
+	Common::RenderGraphResource D3D12RenderGraph::Import(const std::string& name, ID3D12Resource* resource, Common::ResourceState initialState, Common::ResourceState finalState)
+	{
+		if (resource == nullptr)
+			throw std::invalid_argument("D3D12RenderGraph cannot import a null resource");
+
+		ResourceEntry entry;
+		entry.resource = resource;
+		m_resources.push_back(entry);
+
+		return m_graph.ImportResource(name, initialState, finalState);
+	}
+
+	Common::RenderGraphResource D3D12RenderGraph::CreateTexture(const std::string& name, const D3D12_RESOURCE_DESC& desc, const D3D12_CLEAR_VALUE* clearValue)
+	{
+		if (desc.Dimension == D3D12_RESOURCE_DIMENSION_BUFFER)
+			throw std::invalid_argument("D3D12RenderGraph transients must be textures");
+
+		if (m_heapFlags == D3D12_HEAP_FLAG_ALLOW_ONLY_RT_DS_TEXTURES && !(desc.Flags & (D3D12_RESOURCE_FLAG_ALLOW_RENDER_TARGET | D3D12_RESOURCE_FLAG_ALLOW_DEPTH_STENCIL)))
+			throw std::invalid_argument("Resource heap tier 1 only supports render target and depth transients");
+
+		ResourceEntry entry;
+		entry.transient = true;
+		entry.desc = desc;
+		if (clearValue != nullptr)
+		{
+			entry.hasClearValue = true;
+			entry.clearValue = *clearValue;
+		}
+		m_resources.push_back(entry);
+
+		const D3D12_RESOURCE_ALLOCATION_INFO allocInfo = m_device->GetResourceAllocationInfo(0, 1, &desc);
+
+		return m_graph.CreateTransient(name, allocInfo.SizeInBytes, allocInfo.Alignment);
+	}
+
+	uint32_t D3D12RenderGraph::AddPass(const std::string& name, PassExecute execute, bool hasSideEffects)
+	{
+		m_passExecutes.push_back(std::move(execute));
+
+		return m_graph.AddPass(name, hasSideEffects);
+	}
+
+	void D3D12RenderGraph::Read(uint32_t pass, Common::RenderGraphResource resource, Common::ResourceState state)
+	{
+		m_graph.Read(pass, resource, state);
+	}
+
+	void D3D12RenderGraph::Write(uint32_t pass, Common::RenderGraphResource resource, Common::ResourceState state)
+	{
+		m_graph.Write(pass, resource, state);
+	}
+
+	const Common::CompiledRenderGraph& D3D12RenderGraph::Compile()
+	{
+		const Common::CompiledRenderGraph& compiled = m_graph.Compile();
+		PlaceTransients(compiled);
+
+		return compiled;
+	}
+
+	void D3D12RenderGraph::PlaceTransients(const Common::CompiledRenderGraph& compiled)
+	{
+		if (compiled.transientMemoryAliased > m_transientHeapSize)
+		{
+			// The old heap may still be in use by frames in flight, so it is retired by fence rather than released.
+			// Grow geometrically so a slowly growing graph does not replace the heap every frame
+			if (m_transientHeap)
+				m_retiredObjects.Release(m_transientHeap);
+			for (PlacedTransient& placed : m_placedTransients)
+				m_retiredObjects.Release(placed.resource);
+			m_placedTransients.clear();
+			m_heapHistory.Clear();
+
+			const uint64_t heapAlignment = D3D12_DEFAULT_MSAA_RESOURCE_PLACEMENT_ALIGNMENT;
+			const uint64_t heapSize = std::max(compiled.transientMemoryAliased, m_transientHeapSize * 2);
+			m_transientHeapSize = (heapSize + heapAlignment - 1) & ~(heapAlignment - 1);
+
+			CD3DX12_HEAP_DESC heapDesc(m_transientHeapSize, D3D12_HEAP_TYPE_DEFAULT, heapAlignment, m_heapFlags);
+			m_transientHeap.Reset();
+			ThrowIfFailed(m_device->CreateHeap(&heapDesc, IID_PPV_ARGS(m_transientHeap.GetAddressOf())));
+		}
+
+		std::vector<bool> claimed(m_placedTransients.size(), false);
+		std::vector<PlacedTransient> placedThisFrame;
+		placedThisFrame.reserve(compiled.transients.size());
+
+		for (const Common::RenderGraphTransientPlacement& placement : compiled.transients)
+		{
+			ResourceEntry& entry = m_resources[placement.resource];
+
+			// Reuse the placed resource from a previous frame if it sits at the same offset with the same description
+			size_t cached = 0;
+			for (; cached < m_placedTransients.size(); cached++)
+			{
+				const PlacedTransient& candidate = m_placedTransients[cached];
+				if (!claimed[cached] && candidate.offset == placement.offset && SameDesc(candidate.desc, entry.desc)
+					&& SameClearValue(candidate.hasClearValue, candidate.clearValue, entry.hasClearValue, entry.clearValue))
+				{
+					break;
+				}
+			}
+
+			const Common::ResourceState discardState = DiscardState(entry.desc);
+			bool created = false;
+			if (cached < m_placedTransients.size())
+			{
+				claimed[cached] = true;
+				placedThisFrame.push_back(m_placedTransients[cached]);
+			}
+			else
+			{
+				PlacedTransient placed;
+				placed.offset = placement.offset;
+				placed.desc = entry.desc;
+				placed.hasClearValue = entry.hasClearValue;
+				placed.clearValue = entry.clearValue;
+				placed.id = m_nextPlacedId++;
+				// Created straight into the discard state when its first use will need a discard anyway
+				placed.state = (discardState != Common::ResourceState::Common) ? discardState : placement.initialState;
+
+				ThrowIfFailed(m_device->CreatePlacedResource(
+					m_transientHeap.Get(),
+					placement.offset,
+					&entry.desc,
+					D3D12Utilities::ToD3D12States(placed.state),
+					entry.hasClearValue ? &entry.clearValue : nullptr,
+					IID_PPV_ARGS(placed.resource.GetAddressOf())
+				));
+
+				placedThisFrame.push_back(std::move(placed));
+				created = true;
+			}
+
+			PlacedTransient& placed = placedThisFrame.back();
+			entry.resource = placed.resource.Get();
+
+			// The compiled plan orders the transient against earlier occupants in this graph, the history against the
+			// last occupant in an earlier one. Resources of the previous graph stay alive until this frame retires even
+			// when dropped, older or several occupants get a null aliasing barrier instead
+			bool aliasedThisFrame = false;
+			for (const Common::RenderGraphBarrier& barrier : compiled.passes[placement.firstUse].barriers)
+				aliasedThisFrame |= barrier.type == Common::RenderGraphBarrier::Type::Aliasing && barrier.resource == placement.resource;
+
+			const uint64_t previous = m_heapHistory.FindPreviousOccupant(placement.offset, placement.size, placed.id);
+			placed.aliasPreviousFrame = previous != Common::TransientMemoryHistory::noOccupant;
+			placed.aliasBefore = nullptr;
+			for (const PlacedTransient& candidate : m_placedTransients)
+			{
+				if (candidate.id == previous)
+					placed.aliasBefore = candidate.resource.Get();
+			}
+
+			// Compression metadata of render targets and depth buffers is undefined in memory another resource used
+			placed.discard = discardState != Common::ResourceState::Common && (created || aliasedThisFrame || placed.aliasPreviousFrame);
+		}
+
+		// The last transient to take over a range in this graph is the one the next graph's first user waits for
+		std::vector<uint32_t> useOrder(compiled.transients.size());
+		std::iota(useOrder.begin(), useOrder.end(), 0u);
+		std::stable_sort(useOrder.begin(), useOrder.end(), [&compiled](uint32_t lhs, uint32_t rhs) {
+			return compiled.transients[lhs].firstUse < compiled.transients[rhs].firstUse;
+		});
+		for (uint32_t i : useOrder)
+			m_heapHistory.Occupy(compiled.transients[i].offset, compiled.transients[i].size, placedThisFrame[i].id);
+
+		// Transients the graph no longer needs may still be referenced by frames in flight
+		for (size_t i = 0; i < m_placedTransients.size(); i++)
+		{
+			if (!claimed[i])
+				m_retiredObjects.Release(m_placedTransients[i].resource);
+		}
+
+		m_placedTransients = std::move(placedThisFrame);
+	}
+
+	void D3D12RenderGraph::RecordBarrierBatch(const std::vector<Common::RenderGraphBarrier>& barriers, ID3D12GraphicsCommandList* cmdList)
+	{
+		std::vector<D3D12_RESOURCE_BARRIER> d3dBarriers;
+		d3dBarriers.reserve(barriers.size());
+
+		for (const Common::RenderGraphBarrier& barrier : barriers)
+		{
+			ID3D12Resource* resource = m_resources[barrier.resource].resource;
+
+			switch (barrier.type)
+			{
+			case Common::RenderGraphBarrier::Type::Transition:
+			{
+				D3D12_RESOURCE_BARRIER_FLAGS flags = D3D12_RESOURCE_BARRIER_FLAG_NONE;
+				if (barrier.split == Common::RenderGraphBarrier::Split::Begin)
+					flags = D3D12_RESOURCE_BARRIER_FLAG_BEGIN_ONLY;
+				else if (barrier.split == Common::RenderGraphBarrier::Split::End)
+					flags = D3D12_RESOURCE_BARRIER_FLAG_END_ONLY;
+
+				d3dBarriers.push_back(CD3DX12_RESOURCE_BARRIER::Transition(
+					resource,
+					D3D12Utilities::ToD3D12States(barrier.stateBefore),
+					D3D12Utilities::ToD3D12States(barrier.stateAfter),
+					D3D12_RESOURCE_BARRIER_ALL_SUBRESOURCES,
+					flags));
+				break;
+			}
+
+			case Common::RenderGraphBarrier::Type::Aliasing:
+			{
+				ID3D12Resource* before = (barrier.aliasBefore != Common::invalidRenderGraphResource) ? m_resources[barrier.aliasBefore].resource : nullptr;
+				d3dBarriers.push_back(CD3DX12_RESOURCE_BARRIER::Aliasing(before, resource));
+				break;
+			}
+
+			case Common::RenderGraphBarrier::Type::UnorderedAccess:
+				d3dBarriers.push_back(CD3DX12_RESOURCE_BARRIER::UAV(resource));
+				break;
+			}
+		}
+
+		if (!d3dBarriers.empty())
+			cmdList->ResourceBarrier(static_cast<UINT>(d3dBarriers.size()), d3dBarriers.data());
+	}
+
+	void D3D12RenderGraph::RecordPassBarriers(uint32_t compiledPassIndex, ID3D12GraphicsCommandList* cmdList)
+	{
+		const Common::CompiledRenderGraph& compiled = m_graph.GetCompiled();
+		const std::vector<Common::RenderGraphBarrier>& passBarriers = compiled.passes.at(compiledPassIndex).barriers;
+
+		// Transients first used by this pass take over their memory before the pass barriers run: the aliasing
+		// barriers come first, then the transitions into the discard state and the discards themselves
+		std::vector<D3D12_RESOURCE_BARRIER> acquireBarriers;
+		std::vector<D3D12_RESOURCE_BARRIER> discardTransitions;
+		std::vector<ID3D12Resource*> discards;
+		std::vector<Common::RenderGraphBarrier> barriers;
+
+		for (const Common::RenderGraphBarrier& barrier : passBarriers)
+		{
+			if (barrier.type != Common::RenderGraphBarrier::Type::Aliasing)
+				continue;
+
+			ID3D12Resource* before = (barrier.aliasBefore != Common::invalidRenderGraphResource) ? m_resources[barrier.aliasBefore].resource : nullptr;
+			acquireBarriers.push_back(CD3DX12_RESOURCE_BARRIER::Aliasing(before, m_resources[barrier.resource].resource));
+		}
+
+		// A cached transient is still in whatever state the previous frame left it in, the compiled plan
+		// assumes it starts in the state of its first use
+		for (uint32_t i = 0; i < compiled.transients.size(); i++)
+		{
+			const Common::RenderGraphTransientPlacement& placement = compiled.transients[i];
+			const PlacedTransient& placed = m_placedTransients[i];
+			if (placement.firstUse != compiledPassIndex)
+				continue;
+
+			if (placed.aliasPreviousFrame)
+				acquireBarriers.push_back(CD3DX12_RESOURCE_BARRIER::Aliasing(placed.aliasBefore, placed.resource.Get()));
+
+			Common::ResourceState state = placed.state;
+			if (placed.discard)
+			{
+				const Common::ResourceState discardState = DiscardState(placed.desc);
+				if (state != discardState)
+				{
+					discardTransitions.push_back(CD3DX12_RESOURCE_BARRIER::Transition(
+						placed.resource.Get(),
+						D3D12Utilities::ToD3D12States(state),
+						D3D12Utilities::ToD3D12States(discardState)));
+				}
+				discards.push_back(placed.resource.Get());
+				state = discardState;
+			}
+
+			if (state != placement.initialState)
+			{
+				Common::RenderGraphBarrier barrier;
+				barrier.resource = placement.resource;
+				barrier.stateBefore = state;
+				barrier.stateAfter = placement.initialState;
+				barriers.push_back(barrier);
+			}
+		}
+
+		acquireBarriers.insert(acquireBarriers.end(), discardTransitions.begin(), discardTransitions.end());
+		if (!acquireBarriers.empty())
+			cmdList->ResourceBarrier(static_cast<UINT>(acquireBarriers.size()), acquireBarriers.data());
+		for (ID3D12Resource* resource : discards)
+			cmdList->DiscardResource(resource, nullptr);
+
+		for (const Common::RenderGraphBarrier& barrier : passBarriers)
+		{
+			if (barrier.type != Common::RenderGraphBarrier::Type::Aliasing)
+				barriers.push_back(barrier);
+		}
+
+		RecordBarrierBatch(barriers, cmdList);
+
+		// Remember the state each transient ends up in for the next frame that reuses it
+		for (uint32_t i = 0; i < compiled.transients.size(); i++)
+		{
+			if (compiled.transients[i].firstUse == compiledPassIndex)
+				m_placedTransients[i].state = compiled.transients[i].initialState;
+		}
+		for (const Common::RenderGraphBarrier& barrier : passBarriers)
+		{
+			if (barrier.type != Common::RenderGraphBarrier::Type::Transition || !m_resources[barrier.resource].transient)
+				continue;
+
+			for (uint32_t i = 0; i < compiled.transients.size(); i++)
+			{
+				if (compiled.transients[i].resource == barrier.resource)
+					m_placedTransients[i].state = barrier.stateAfter;
+			}
+		}
+	}
+
+	void D3D12RenderGraph::RecordFinalBarriers(ID3D12GraphicsCommandList* cmdList)
+	{
+		RecordBarrierBatch(m_graph.GetCompiled().finalBarriers, cmdList);
+	}
+
+	void D3D12RenderGraph::ExecutePass(uint32_t compiledPassIndex, ID3D12GraphicsCommandList* cmdList)
+	{
+		RecordPassBarriers(compiledPassIndex, cmdList);
+
+		const PassExecute& execute = m_passExecutes[m_graph.GetCompiled().passes[compiledPassIndex].passIndex];
+		if (execute)
+			execute(cmdList);
+	}
+
+	void D3D12RenderGraph::Execute(ID3D12GraphicsCommandList* cmdList)
+	{
+		const Common::CompiledRenderGraph& compiled = m_graph.GetCompiled();
+		for (uint32_t i = 0; i < compiled.passes.size(); i++)
+			ExecutePass(i, cmdList);
+
+		RecordFinalBarriers(cmdList);
+	}
+
+	ID3D12Resource* D3D12RenderGraph::GetResource(Common::RenderGraphResource resource) const
+	{
+		return m_resources.at(resource).resource;
+	}
+
+	void D3D12RenderGraph::Reset()
+	{
+		m_graph.Reset();
+		m_resources.clear();
+		m_passExecutes.clear();
+	}
+
+	void D3D12RenderGraph::FinishFrame(uint64_t fenceValue)
+	{
+		m_retiredObjects.FinishFrame(fenceValue);
+	}
+
+	void D3D12RenderGraph::Retire(uint64_t completedFenceValue)
+	{
+		m_retiredObjects.Retire(completedFenceValue);
+	}
+
+	const Common::RenderGraph& D3D12RenderGraph::Graph() const
+	{
+		return m_graph;
+	}
+
+	bool D3D12RenderGraph::SupportsNonTargetTransients() const
+	{
+		return m_heapFlags != D3D12_HEAP_FLAG_ALLOW_ONLY_RT_DS_TEXTURES;
+	}
+}
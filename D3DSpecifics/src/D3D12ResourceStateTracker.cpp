@@ -0,0 +1,94 @@
+#include <directx/d3dx12.h>
+
+#include <D3D12ResourceStateTracker.h>
+#include <D3D12Utilities.h>
+
+namespace UltReality::Rendering::D3D12
+{
+	Common::TrackedResource D3D12ResourceStateTracker::Key(ID3D12Resource* resource)
+	{
+		return static_cast<Common::TrackedResource>(reinterpret_cast<uintptr_t>(resource));
+	}
+
+	void D3D12ResourceStateTracker::RecordTrackedBarriers(ID3D12GraphicsCommandList* cmdList)
+	{
+		m_d3dBarriers.clear();
+		for (const Common::TrackedBarrier& barrier : m_trackedBarriers)
+		{
+			ID3D12Resource* resource = reinterpret_cast<ID3D12Resource*>(static_cast<uintptr_t>(barrier.resource));
+
+			if (barrier.type == Common::TrackedBarrier::Type::UnorderedAccess)
+			{
+				m_d3dBarriers.push_back(CD3DX12_RESOURCE_BARRIER::UAV(resource));
+				continue;
+			}
+
+			D3D12_RESOURCE_BARRIER_FLAGS flags = D3D12_RESOURCE_BARRIER_FLAG_NONE;
+			if (barrier.split == Common::TrackedBarrier::Split::Begin)
+				flags = D3D12_RESOURCE_BARRIER_FLAG_BEGIN_ONLY;
+			else if (barrier.split == Common::TrackedBarrier::Split::End)
+				flags = D3D12_RESOURCE_BARRIER_FLAG_END_ONLY;
+
+			m_d3dBarriers.push_back(CD3DX12_RESOURCE_BARRIER::Transition(
+				resource,
+				D3D12Utilities::ToD3D12States(barrier.stateBefore),
+				D3D12Utilities::ToD3D12States(barrier.stateAfter),
+				D3D12_RESOURCE_BARRIER_ALL_SUBRESOURCES,
+				flags));
+		}
+
+		if (!m_d3dBarriers.empty())
+			cmdList->ResourceBarrier(static_cast<UINT>(m_d3dBarriers.size()), m_d3dBarriers.data());
+
+		m_trackedBarriers.clear();
+	}
+
+	void D3D12ResourceStateTracker::Transition(ID3D12Resource* resource, Common::ResourceState state)
+	{
+		m_tracker.Transition(Key(resource), state);
+	}
+
+	void D3D12ResourceStateTracker::BeginTransition(ID3D12Resource* resource, Common::ResourceState state)
+	{
+		m_tracker.BeginTransition(Key(resource), state);
+	}
+
+	void D3D12ResourceStateTracker::EndTransition(ID3D12Resource* resource)
+	{
+		m_tracker.EndTransition(Key(resource));
+	}
+
+	void D3D12ResourceStateTracker::UAVBarrier(ID3D12Resource* resource)
+	{
+		m_tracker.UAVBarrier(Key(resource));
+	}
+
+	void D3D12ResourceStateTracker::FlushBarriers(ID3D12GraphicsCommandList* cmdList)
+	{
+		m_tracker.Flush(m_trackedBarriers);
+		RecordTrackedBarriers(cmdList);
+	}
+
+	bool D3D12ResourceStateTracker::RecordPendingBarriers(const Common::ResourceStateTable& table, ID3D12GraphicsCommandList* cmdList)
+	{
+		const bool recorded = m_tracker.ResolvePending(table, m_trackedBarriers) > 0;
+		RecordTrackedBarriers(cmdList);
+
+		return recorded;
+	}
+
+	void D3D12ResourceStateTracker::Commit(Common::ResourceStateTable& table) const
+	{
+		m_tracker.Commit(table);
+	}
+
+	void D3D12ResourceStateTracker::Reset()
+	{
+		m_tracker.Reset();
+	}
+
+	const Common::ResourceStateTracker& D3D12ResourceStateTracker::Tracker() const
+	{
+		return m_tracker;
+	}
+}
@@ -0,0 +1,288 @@
+#include <algorithm>
+#include <stdexcept>
+#include <utility>
+
+#include <D3D12TextureStreamer.h>
+#include <D3D12Utilities.h>
+
+using namespace Microsoft::WRL;
+
+namespace UltReality::Rendering::D3D12
+{
+	D3D12TextureStreamer::D3D12TextureStreamer(ID3D12Device* device, ID3D12CommandQueue* copyQueue, Common::StreamingUploader* uploader,
+		D3D12CPUDescriptorAllocator* srvAllocator, uint64_t budgetBytes)
+		: m_device(device), m_copyQueue(copyQueue), m_uploader(uploader), m_srvAllocator(srvAllocator), m_manager(budgetBytes)
+	{
+	}
+
+	uint64_t D3D12TextureStreamer::TileBytes(const Texture& texture, uint32_t mip) const
+	{
+		if (mip == texture.tailMip && texture.packedMipInfo.NumPackedMips > 0)
+			return static_cast<uint64_t>(texture.packedMipInfo.NumTilesForPackedMips) * D3D12_TILED_RESOURCE_TILE_SIZE_IN_BYTES;
+
+		const D3D12_SUBRESOURCE_TILING& tiling = texture.tilings[mip];
+		return static_cast<uint64_t>(tiling.WidthInTiles) * tiling.HeightInTiles * tiling.DepthInTiles * D3D12_TILED_RESOURCE_TILE_SIZE_IN_BYTES;
+	}
+
+	uint32_t D3D12TextureStreamer::CreateTexture(const D3D12_RESOURCE_DESC& desc, MipWriter writer)
+	{
+		if (desc.Dimension != D3D12_RESOURCE_DIMENSION_TEXTURE2D || desc.DepthOrArraySize != 1)
+			throw std::invalid_argument("Only 2D textures with a single array slice can be streamed");
+
+		// Reserved resources have no memory of their own, every mip is mapped to a heap when it streams in
+		D3D12_RESOURCE_DESC reservedDesc = desc;
+		reservedDesc.Layout = D3D12_TEXTURE_LAYOUT_64KB_UNDEFINED_SWIZZLE;
+
+		ComPtr<ID3D12Resource> resource;
+		ThrowIfFailed(m_device->CreateReservedResource(&reservedDesc, D3D12_RESOURCE_STATE_COMMON, nullptr, IID_PPV_ARGS(resource.GetAddressOf())));
+
+		const D3D12_RESOURCE_DESC resourceDesc = resource->GetDesc();
+
+		UINT tileCount;
+		D3D12_PACKED_MIP_INFO packedMipInfo;
+		D3D12_TILE_SHAPE tileShape;
+		UINT subresourceCount = resourceDesc.MipLevels;
+		std::vector<D3D12_SUBRESOURCE_TILING> tilings(subresourceCount);
+		m_device->GetResourceTiling(resource.Get(), &tileCount, &packedMipInfo, &tileShape, &subresourceCount, 0, tilings.data());
+
+		// Without packed mips the smallest standard mip serves as the tail
+		const uint32_t tailMip = packedMipInfo.NumPackedMips > 0 ? packedMipInfo.NumStandardMips : packedMipInfo.NumStandardMips - 1;
+
+		Texture texture;
+		texture.resource = resource;
+		texture.writer = std::move(writer);
+		texture.format = resourceDesc.Format;
+		texture.mipLevels = resourceDesc.MipLevels;
+		texture.tailMip = tailMip;
+		texture.tilings = std::move(tilings);
+		texture.packedMipInfo = packedMipInfo;
+		texture.mipHeaps.resize(tailMip + 1);
+
+		Common::StreamingTextureDesc streamingDesc;
+		streamingDesc.baseSize = static_cast<uint32_t>(std::max<uint64_t>(resourceDesc.Width, resourceDesc.Height));
+		for (uint32_t mip = 0; mip <= tailMip; mip++)
+			streamingDesc.mipSizes.push_back(TileBytes(texture, mip));
+
+		const uint32_t index = m_manager.Register(streamingDesc);
+		if (index >= m_textures.size())
+			m_textures.resize(index + 1);
+
+		m_textures[index] = std::move(texture);
+		Texture& entry = m_textures[index];
+		entry.srv = m_srvAllocator->Allocate();
+
+		MapMip(entry, tailMip);
+		entry.tailTicket = UploadMip(entry, tailMip);
+		UpdateSrv(index);
+
+		return index;
+	}
+
+	void D3D12TextureStreamer::DestroyTexture(uint32_t texture)
+	{
+		Texture& entry = m_textures[texture];
+		if (entry.resource == nullptr)
+			return;
+
+		// The copy queue may run behind the frames, so the resource has to outlive its uploads as well. Tickets
+		// complete in order, so waiting for the later one covers both
+		UploadingMemory uploading;
+		uploading.ticket = std::max(entry.loadTicket, entry.tailTicket);
+
+		// The resource goes before the heaps mapped into it
+		uploading.memory.push_back(std::move(entry.resource));
+		for (ComPtr<ID3D12Heap>& heap : entry.mipHeaps)
+		{
+			if (heap != nullptr)
+				uploading.memory.push_back(std::move(heap));
+		}
+
+		if (uploading.ticket != 0 && !m_uploader->IsComplete(uploading.ticket))
+			m_uploadingMemory.push_back(std::move(uploading));
+		else
+		{
+			for (ComPtr<ID3D12Pageable>& memory : uploading.memory)
+				m_retiredMemory.Release(std::move(memory));
+		}
+
+		m_srvAllocator->Free(entry.srv);
+		m_manager.Unregister(texture);
+
+		entry = Texture();
+	}
+
+	void D3D12TextureStreamer::MapMip(Texture& texture, uint32_t mip)
+	{
+		const uint64_t size = TileBytes(texture, mip);
+
+		D3D12_HEAP_DESC heapDesc = {};
+		heapDesc.SizeInBytes = size;
+		heapDesc.Properties.Type = D3D12_HEAP_TYPE_DEFAULT;
+		heapDesc.Alignment = D3D12_DEFAULT_RESOURCE_PLACEMENT_ALIGNMENT;
+		heapDesc.Flags = D3D12_HEAP_FLAG_ALLOW_ONLY_NON_RT_DS_TEXTURES;
+		ThrowIfFailed(m_device->CreateHeap(&heapDesc, IID_PPV_ARGS(texture.mipHeaps[mip].ReleaseAndGetAddressOf())));
+
+		// Packed mips are addressed as tiles following the first packed subresource
+		D3D12_TILED_RESOURCE_COORDINATE coordinate = {};
+		coordinate.Subresource = mip;
+
+		D3D12_TILE_REGION_SIZE regionSize = {};
+		regionSize.NumTiles = static_cast<UINT>(size / D3D12_TILED_RESOURCE_TILE_SIZE_IN_BYTES);
+		regionSize.UseBox = FALSE;
+
+		const D3D12_TILE_RANGE_FLAGS rangeFlags = D3D12_TILE_RANGE_FLAG_NONE;
+		const UINT heapRangeStart = 0;
+		const UINT rangeTileCount = regionSize.NumTiles;
+
+		m_copyQueue->UpdateTileMappings(
+			texture.resource.Get(),
+			1, &coordinate, &regionSize,
+			texture.mipHeaps[mip].Get(),
+			1, &rangeFlags, &heapRangeStart, &rangeTileCount,
+			D3D12_TILE_MAPPING_FLAG_NONE
+		);
+	}
+
+	Common::UploadTicket D3D12TextureStreamer::UploadMip(Texture& texture, uint32_t mip)
+	{
+		const D3D12_RESOURCE_DESC desc = texture.resource->GetDesc();
+
+		// The tail covers every remaining subresource
+		const uint32_t lastSubresource = mip == texture.tailMip ? texture.mipLevels - 1 : mip;
+
+		Common::UploadTicket ticket = 0;
+		for (uint32_t subresource = mip; subresource <= lastSubresource; subresource++)
+		{
+			D3D12_PLACED_SUBRESOURCE_FOOTPRINT footprint;
+			UINT64 totalBytes;
+			m_device->GetCopyableFootprints(&desc, subresource, 1, 0, &footprint, nullptr, nullptr, &totalBytes);
+
+			Common::UploadRequest request;
+			request.size = totalBytes;
+			request.alignment = D3D12_TEXTURE_DATA_PLACEMENT_ALIGNMENT;
+			request.destination = texture.resource.Get();
+			request.subresource = subresource;
+			request.write = [writer = texture.writer, subresource, layout = footprint.Footprint](uint8_t* staging)
+			{
+				writer(subresource, staging, layout);
+			};
+
+			ticket = m_uploader->Enqueue(std::move(request));
+		}
+
+		return ticket;
+	}
+
+	void D3D12TextureStreamer::UpdateSrv(uint32_t index)
+	{
+		const Texture& texture = m_textures[index];
+
+		D3D12_SHADER_RESOURCE_VIEW_DESC srvDesc = {};
+		srvDesc.Format = texture.format;
+		srvDesc.ViewDimension = D3D12_SRV_DIMENSION_TEXTURE2D;
+		srvDesc.Shader4ComponentMapping = D3D12_DEFAULT_SHADER_4_COMPONENT_MAPPING;
+		srvDesc.Texture2D.MostDetailedMip = 0;
+		srvDesc.Texture2D.MipLevels = texture.mipLevels;
+		// Sampling never reaches into mips that are not mapped
+		srvDesc.Texture2D.ResourceMinLODClamp = static_cast<float>(m_manager.GetResidentMip(index));
+
+		m_device->CreateShaderResourceView(texture.resource.Get(), &srvDesc, texture.srv.Handle());
+	}
+
+	void D3D12TextureStreamer::ReportFootprint(uint32_t texture, float screenPixels)
+	{
+		m_manager.ReportFootprint(texture, screenPixels);
+	}
+
+	void D3D12TextureStreamer::Update()
+	{
+		for (uint32_t index = 0; index < m_textures.size(); index++)
+		{
+			Texture& texture = m_textures[index];
+			if (texture.loadTicket == 0 || !m_uploader->IsComplete(texture.loadTicket))
+				continue;
+
+			m_manager.OnMipsResident(index, texture.loadMip);
+			texture.loadTicket = 0;
+			UpdateSrv(index);
+		}
+
+		const Common::TextureStreamingUpdate update = m_manager.Update();
+
+		// The view stops covering evicted mips right away, their memory goes once the frames still sampling them retired
+		for (const Common::TextureMipChange& eviction : update.evictions)
+		{
+			Texture& texture = m_textures[eviction.texture];
+			for (uint32_t mip = 0; mip < eviction.mip; mip++)
+			{
+				if (texture.mipHeaps[mip] != nullptr)
+					m_retiredMemory.Release(std::move(texture.mipHeaps[mip]));
+			}
+
+			UpdateSrv(eviction.texture);
+		}
+
+		for (const Common::TextureMipChange& load : update.loads)
+		{
+			Texture& texture = m_textures[load.texture];
+			const uint32_t residentMip = m_manager.GetResidentMip(load.texture);
+
+			for (uint32_t mip = load.mip; mip < residentMip; mip++)
+				MapMip(texture, mip);
+
+			for (uint32_t mip = load.mip; mip < residentMip; mip++)
+				texture.loadTicket = UploadMip(texture, mip);
+
+			texture.loadMip = load.mip;
+		}
+	}
+
+	void D3D12TextureStreamer::FinishFrame(uint64_t fenceValue)
+	{
+		m_retiredMemory.FinishFrame(fenceValue);
+	}
+
+	void D3D12TextureStreamer::Retire(uint64_t completedFenceValue)
+	{
+		// Released heaps stay mapped, which is harmless since no view reaches their tiles anymore
+		m_retiredMemory.Retire(completedFenceValue);
+
+		// Memory whose uploads completed joins the current frame, which is later than any frame that sampled it
+		for (UploadingMemory& uploading : m_uploadingMemory)
+		{
+			if (!m_uploader->IsComplete(uploading.ticket))
+				continue;
+
+			for (ComPtr<ID3D12Pageable>& memory : uploading.memory)
+				m_retiredMemory.Release(std::move(memory));
+			uploading.memory.clear();
+		}
+
+		m_uploadingMemory.erase(std::remove_if(m_uploadingMemory.begin(), m_uploadingMemory.end(),
+			[](const UploadingMemory& uploading) { return uploading.memory.empty(); }), m_uploadingMemory.end());
+	}
+
+	bool D3D12TextureStreamer::IsReady(uint32_t texture)
+	{
+		Texture& entry = m_textures[texture];
+		if (entry.tailTicket != 0 && m_uploader->IsComplete(entry.tailTicket))
+			entry.tailTicket = 0;
+
+		return entry.resource != nullptr && entry.tailTicket == 0;
+	}
+
+	D3D12_CPU_DESCRIPTOR_HANDLE D3D12TextureStreamer::GetSrv(uint32_t texture) const
+	{
+		return m_textures[texture].srv.Handle();
+	}
+
+	ID3D12Resource* D3D12TextureStreamer::GetResource(uint32_t texture) const
+	{
+		return m_textures[texture].resource.Get();
+	}
+
+	Common::TextureStreamingManager& D3D12TextureStreamer::Manager()
+	{
+		return m_manager;
+	}
+}
@@ -0,0 +1,185 @@
+#include <directx/d3dx12.h>
+
+#include <cstring>
+#include <stdexcept>
+#include <utility>
+
+#include <D3D12UploadQueue.h>
+#include <D3D12Utilities.h>
+
+using namespace Microsoft::WRL;
+
+namespace UltReality::Rendering::D3D12
+{
+	D3D12UploadQueue::D3D12UploadQueue(ID3D12Device* device, ID3D12CommandQueue* copyQueue, uint64_t stagingCapacity)
+		: m_device(device), m_queue(copyQueue), m_stagingCapacity(stagingCapacity)
+	{
+		CD3DX12_HEAP_PROPERTIES heapProps(D3D12_HEAP_TYPE_UPLOAD);
+		auto bufferDesc = CD3DX12_RESOURCE_DESC::Buffer(stagingCapacity);
+		ThrowIfFailed(m_device->CreateCommittedResource(
+			&heapProps,
+			D3D12_HEAP_FLAG_NONE,
+			&bufferDesc,
+			D3D12_RESOURCE_STATE_GENERIC_READ,
+			nullptr,
+			IID_PPV_ARGS(m_stagingBuffer.GetAddressOf())
+		));
+
+		// The staging buffer is only ever written on the CPU
+		CD3DX12_RANGE readRange(0, 0);
+		ThrowIfFailed(m_stagingBuffer->Map(0, &readRange, reinterpret_cast<void**>(&m_mappedData)));
+
+		ThrowIfFailed(m_device->CreateFence(0, D3D12_FENCE_FLAG_NONE, IID_PPV_ARGS(m_fence.GetAddressOf())));
+	}
+
+	D3D12UploadQueue::~D3D12UploadQueue()
+	{
+		if (m_stagingBuffer != nullptr)
+		{
+			m_stagingBuffer->Unmap(0, nullptr);
+		}
+
+		m_mappedData = nullptr;
+	}
+
+	uint8_t* D3D12UploadQueue::GetStagingMemory()
+	{
+		return m_mappedData;
+	}
+
+	uint64_t D3D12UploadQueue::GetStagingCapacity() const
+	{
+		return m_stagingCapacity;
+	}
+
+	void D3D12UploadQueue::OpenBatch()
+	{
+		// Reuse the oldest allocator if the GPU is done with it
+		if (!m_allocators.empty() && m_allocators.front().fenceValue <= m_fence->GetCompletedValue())
+		{
+			m_openAllocator = std::move(m_allocators.front().allocator);
+			m_allocators.pop_front();
+			ThrowIfFailed(m_openAllocator->Reset());
+		}
+		else
+		{
+			ThrowIfFailed(m_device->CreateCommandAllocator(D3D12_COMMAND_LIST_TYPE_COPY, IID_PPV_ARGS(m_openAllocator.GetAddressOf())));
+		}
+
+		if (m_commandList == nullptr)
+		{
+			ThrowIfFailed(m_device->CreateCommandList(
+				0,
+				D3D12_COMMAND_LIST_TYPE_COPY,
+				m_openAllocator.Get(),
+				nullptr,
+				IID_PPV_ARGS(m_commandList.GetAddressOf())
+			));
+		}
+		else
+		{
+			// The list itself can be reset as soon as it was executed, only its allocator has to wait for the GPU
+			ThrowIfFailed(m_commandList->Reset(m_openAllocator.Get(), nullptr));
+		}
+
+		m_recording = true;
+	}
+
+	void D3D12UploadQueue::RecordCopy(const Common::UploadCopy& copy)
+	{
+		if (!m_recording)
+			OpenBatch();
+
+		ID3D12Resource* destination = static_cast<ID3D12Resource*>(copy.destination);
+
+		if (copy.subresource == Common::UploadCopy::wholeBuffer)
+		{
+			m_commandList->CopyBufferRegion(destination, copy.destinationOffset, m_stagingBuffer.Get(), copy.stagingOffset, copy.size);
+			return;
+		}
+
+		// Placed at the staging offset, which the request aligned for texture data
+		const D3D12_RESOURCE_DESC desc = destination->GetDesc();
+		D3D12_PLACED_SUBRESOURCE_FOOTPRINT footprint;
+		m_device->GetCopyableFootprints(&desc, copy.subresource, 1, copy.stagingOffset, &footprint, nullptr, nullptr, nullptr);
+
+		CD3DX12_TEXTURE_COPY_LOCATION dst(destination, copy.subresource);
+		CD3DX12_TEXTURE_COPY_LOCATION src(m_stagingBuffer.Get(), footprint);
+		m_commandList->CopyTextureRegion(&dst, 0, 0, 0, &src, nullptr);
+	}
+
+	uint64_t D3D12UploadQueue::SubmitBatch()
+	{
+		if (m_recording)
+		{
+			ThrowIfFailed(m_commandList->Close());
+
+			ID3D12CommandList* lists[] = { m_commandList.Get() };
+			m_queue->ExecuteCommandLists(1, lists);
+
+			m_recording = false;
+		}
+
+		m_fenceValue++;
+		ThrowIfFailed(m_queue->Signal(m_fence.Get(), m_fenceValue));
+
+		if (m_openAllocator != nullptr)
+			m_allocators.push_back(RetiringAllocator{ std::move(m_openAllocator), m_fenceValue });
+
+		return m_fenceValue;
+	}
+
+	uint64_t D3D12UploadQueue::GetCompletedValue() const
+	{
+		return m_fence->GetCompletedValue();
+	}
+
+	void D3D12UploadQueue::WaitForValue(uint64_t value)
+	{
+		if (m_fence->GetCompletedValue() >= value)
+			return;
+
+		HANDLE fenceEvent = CreateEvent(nullptr, false, false, nullptr);
+		if (fenceEvent == nullptr)
+			ThrowIfFailed(HRESULT_FROM_WIN32(GetLastError()));
+
+		const HRESULT hr = m_fence->SetEventOnCompletion(value, fenceEvent);
+		if (SUCCEEDED(hr))
+			WaitForSingleObject(fenceEvent, INFINITE);
+
+		CloseHandle(fenceEvent);
+		ThrowIfFailed(hr);
+	}
+
+	Common::UploadRequest D3D12UploadQueue::CreateTextureRequest(ID3D12Resource* texture, uint32_t subresource, std::vector<uint8_t> data, uint64_t rowPitch) const
+	{
+		const D3D12_RESOURCE_DESC desc = texture->GetDesc();
+
+		D3D12_PLACED_SUBRESOURCE_FOOTPRINT footprint;
+		UINT rowCount;
+		UINT64 rowSize;
+		UINT64 totalBytes;
+		m_device->GetCopyableFootprints(&desc, subresource, 1, 0, &footprint, &rowCount, &rowSize, &totalBytes);
+
+		const uint32_t depth = footprint.Footprint.Depth;
+		const uint64_t stagingPitch = footprint.Footprint.RowPitch;
+
+		if (data.size() < rowPitch * (static_cast<uint64_t>(rowCount) * depth - 1) + rowSize)
+			throw std::invalid_argument("Texture upload data is smaller than the subresource");
+
+		Common::UploadRequest request;
+		request.size = totalBytes;
+		request.alignment = D3D12_TEXTURE_DATA_PLACEMENT_ALIGNMENT;
+		request.destination = texture;
+		request.subresource = subresource;
+		request.write = [data = std::move(data), rowPitch, stagingPitch, rowCount, rowSize, depth](uint8_t* staging)
+		{
+			// Rows of every slice follow each other at the source pitch, the copy queue expects its own pitch
+			const uint64_t rows = static_cast<uint64_t>(rowCount) * depth;
+			for (uint64_t row = 0; row < rows; row++)
+				std::memcpy(staging + row * stagingPitch, data.data() + row * rowPitch, rowSize);
+		};
+
+		return request;
+	}
+}
@@ -0,0 +1,117 @@
+#include <directx/d3dx12.h>
+
+#include <D3D12UploadRing.h>
+#include <D3D12Utilities.h>
+
+using namespace Microsoft::WRL;
+
+namespace UltReality::Rendering::D3D12
+{
+	D3D12UploadRing::D3D12UploadRing(ID3D12Device* device, uint64_t capacity)
+		: m_device(device), m_allocator(capacity)
+	{
+		CD3DX12_HEAP_PROPERTIES heapProps(D3D12_HEAP_TYPE_UPLOAD);
+		auto bufferDesc = CD3DX12_RESOURCE_DESC::Buffer(capacity);
+		ThrowIfFailed(m_device->CreateCommittedResource(
+			&heapProps,
+			D3D12_HEAP_FLAG_NONE,
+			&bufferDesc,
+			D3D12_RESOURCE_STATE_GENERIC_READ,
+			nullptr,
+			IID_PPV_ARGS(m_ringBuffer.GetAddressOf())
+		));
+
+		// Upload heaps can stay mapped for their whole lifetime. We never read
+		// from the mapping on the CPU so an empty read range is passed
+		CD3DX12_RANGE readRange(0, 0);
+		ThrowIfFailed(m_ringBuffer->Map(0, &readRange, reinterpret_cast<void**>(&m_mappedData)));
+
+		m_gpuBaseAddress = m_ringBuffer->GetGPUVirtualAddress();
+	}
+
+	D3D12UploadRing::~D3D12UploadRing()
+	{
+		if (m_ringBuffer != nullptr)
+		{
+			m_ringBuffer->Unmap(0, nullptr);
+		}
+
+		m_mappedData = nullptr;
+	}
+
+	UploadAllocation D3D12UploadRing::Allocate(uint64_t size, uint64_t alignment)
+	{
+		// Nothing to upload, and a zero sized overflow buffer cannot be created
+		if (size == 0)
+			return UploadAllocation();
+
+		const uint64_t offset = m_allocator.Allocate(size, alignment);
+		if (offset == Common::LinearRingAllocator::invalidOffset)
+			return AllocateOverflow(size);
+
+		UploadAllocation allocation;
+		allocation.cpuAddress = m_mappedData + offset;
+		allocation.gpuAddress = m_gpuBaseAddress + offset;
+		allocation.resource = m_ringBuffer.Get();
+		allocation.offset = offset;
+		allocation.size = size;
+
+		return allocation;
+	}
+
+	UploadAllocation D3D12UploadRing::AllocateConstants(uint32_t size)
+	{
+		// Constant data has to be viewed at m*256 byte offsets and with n*256 byte lengths
+		return Allocate(D3D12Utilities::CalcConstantBufferSize(size), D3D12_CONSTANT_BUFFER_DATA_PLACEMENT_ALIGNMENT);
+	}
+
+	UploadAllocation D3D12UploadRing::AllocateOverflow(uint64_t size)
+	{
+		// The ring is exhausted for this frame. Give the request its own buffer
+		// rather than stalling on the GPU, and keep it alive until the frame retires
+		// Padded like constant data so the buffer can back any view, in 64 bits as overflow requests can exceed 4 GiB
+		constexpr uint64_t padding = D3D12_CONSTANT_BUFFER_DATA_PLACEMENT_ALIGNMENT - 1;
+		const uint64_t bufferSize = (size + padding) & ~padding;
+
+		ComPtr<ID3D12Resource> buffer;
+		CD3DX12_HEAP_PROPERTIES heapProps(D3D12_HEAP_TYPE_UPLOAD);
+		auto bufferDesc = CD3DX12_RESOURCE_DESC::Buffer(bufferSize);
+		ThrowIfFailed(m_device->CreateCommittedResource(
+			&heapProps,
+			D3D12_HEAP_FLAG_NONE,
+			&bufferDesc,
+			D3D12_RESOURCE_STATE_GENERIC_READ,
+			nullptr,
+			IID_PPV_ARGS(buffer.GetAddressOf())
+		));
+
+		UploadAllocation allocation;
+		CD3DX12_RANGE readRange(0, 0);
+		ThrowIfFailed(buffer->Map(0, &readRange, reinterpret_cast<void**>(&allocation.cpuAddress)));
+		allocation.gpuAddress = buffer->GetGPUVirtualAddress();
+		allocation.resource = buffer.Get();
+		allocation.offset = 0;
+		allocation.size = size;
+
+		m_frameOverflowBuffers.push_back(std::move(buffer));
+
+		return allocation;
+	}
+
+	void D3D12UploadRing::FinishFrame(uint64_t fenceValue)
+	{
+		m_allocator.FinishFrame(fenceValue);
+
+		for (auto& buffer : m_frameOverflowBuffers)
+			m_retiringOverflowBuffers.push_back(OverflowBuffer{ std::move(buffer), fenceValue });
+		m_frameOverflowBuffers.clear();
+	}
+
+	void D3D12UploadRing::Retire(uint64_t completedFenceValue)
+	{
+		m_allocator.Retire(completedFenceValue);
+
+		while (!m_retiringOverflowBuffers.empty() && m_retiringOverflowBuffers.front().fenceValue <= completedFenceValue)
+			m_retiringOverflowBuffers.pop_front();
+	}
+}
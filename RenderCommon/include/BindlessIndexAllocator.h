@@ -0,0 +1,106 @@
+#ifndef ULTREALITY_RENDERING_COMMON_BINDLESS_INDEX_ALLOCATOR_H
+#define ULTREALITY_RENDERING_COMMON_BINDLESS_INDEX_ALLOCATOR_H
+
+#include <stdint.h>
+#include <deque>
+#include <vector>
+
+namespace UltReality::Rendering::Common
+{
+	/// <summary>
+	/// Slot of a bindless descriptor table. Shaders only see <see cref="index"/>, the generation lets the CPU tell a
+	/// live handle from one whose slot has been freed and possibly handed out again
+	/// </summary>
+	struct BindlessHandle
+	{
+		static constexpr uint32_t invalidIndex = UINT32_MAX;
+
+		uint32_t index = invalidIndex;
+		uint32_t generation = 0;
+
+		bool IsValid() const { return index != invalidIndex; }
+	};
+
+	/// <summary>
+	/// Hands out stable indices into a fixed size bindless descriptor table. A freed index is not reused until the
+	/// fence of the frame it was freed in completed, since shaders of frames in flight may still read its descriptor.
+	/// Every slot counts its generations, freeing bumps the generation so any handle still held becomes stale
+	/// </summary>
+	class BindlessIndexAllocator
+	{
+	public:
+		struct Statistics
+		{
+			uint32_t capacity = 0;
+			uint32_t allocatedCount = 0;
+			// Freed indices waiting on their fence
+			uint32_t retiringCount = 0;
+			// Highest number of indices allocated at once
+			uint32_t highWaterMark = 0;
+		};
+
+	private:
+		struct RetiringFrame
+		{
+			std::vector<uint32_t> indices;
+			uint64_t fenceValue;
+		};
+
+		uint32_t m_capacity;
+
+		// Current generation of every slot that has been handed out at least once
+		std::vector<uint32_t> m_generations;
+		std::vector<bool> m_allocated;
+		// Indices ready for reuse, handed out oldest first so a recycled slot stays unused as long as possible
+		std::deque<uint32_t> m_freeIndices;
+
+		// Indices freed during the current frame
+		std::vector<uint32_t> m_frameFreed;
+		std::deque<RetiringFrame> m_retiring;
+
+		Statistics m_statistics;
+
+	public:
+		/// <summary>
+		/// Creates an allocator over <paramref name="capacity"/> indices
+		/// </summary>
+		explicit BindlessIndexAllocator(uint32_t capacity);
+
+		/// <summary>
+		/// Allocates an index
+		/// </summary>
+		/// <exception cref="std::runtime_error">Thrown if every index is allocated or still retiring</exception>
+		BindlessHandle Allocate();
+
+		/// <summary>
+		/// Frees an index. It becomes reusable once the fence value of the current frame completed
+		/// </summary>
+		/// <exception cref="std::invalid_argument">Thrown if <paramref name="handle"/> is stale or was never allocated</exception>
+		void Free(BindlessHandle handle);
+
+		/// <summary>
+		/// Checks that <paramref name="handle"/> still refers to the allocation it was created for
+		/// </summary>
+		bool IsLive(BindlessHandle handle) const;
+
+		/// <summary>
+		/// Gets the shader index of <paramref name="handle"/>
+		/// </summary>
+		/// <exception cref="std::invalid_argument">Thrown if <paramref name="handle"/> is stale, which would make a shader read another resource</exception>
+		uint32_t Resolve(BindlessHandle handle) const;
+
+		/// <summary>
+		/// Tags every index freed since the previous call with <paramref name="fenceValue"/>
+		/// </summary>
+		void FinishFrame(uint64_t fenceValue);
+
+		/// <summary>
+		/// Makes the indices of every frame whose fence value is at or below <paramref name="completedFenceValue"/> reusable
+		/// </summary>
+		void Retire(uint64_t completedFenceValue);
+
+		const Statistics& GetStatistics() const;
+	};
+}
+
+#endif // !ULTREALITY_RENDERING_COMMON_BINDLESS_INDEX_ALLOCATOR_H
@@ -0,0 +1,105 @@
+#ifndef ULTREALITY_RENDERING_COMMON_BUDDY_ALLOCATOR_H
+#define ULTREALITY_RENDERING_COMMON_BUDDY_ALLOCATOR_H
+
+#include <stdint.h>
+#include <set>
+#include <vector>
+#include <unordered_map>
+
+namespace UltReality::Rendering::Common
+{
+	/// <summary>
+	/// Power-of-two buddy allocator over an abstract address range. Blocks are naturally aligned to their size, which
+	/// makes it a good fit for GPU heaps that demand 64KB or 4MB placement alignment. Only offsets are handed out,
+	/// the memory itself is owned by the caller
+	/// </summary>
+	class BuddyAllocator
+	{
+	public:
+		// Returned by <see cref="Allocate"/> when no block large enough is free
+		static constexpr uint64_t invalidOffset = UINT64_MAX;
+
+		struct Statistics
+		{
+			// Total size of the managed range
+			uint64_t capacity = 0;
+			// Bytes in allocated blocks
+			uint64_t usedBytes = 0;
+			// Bytes the callers actually asked for. usedBytes - requestedBytes is the internal waste of power-of-two rounding
+			uint64_t requestedBytes = 0;
+			// Bytes in free blocks
+			uint64_t freeBytes = 0;
+			// Size of the largest allocation that can currently succeed
+			uint64_t largestFreeBlock = 0;
+			// Number of live allocations
+			uint32_t allocationCount = 0;
+			// Number of free blocks across all levels
+			uint32_t freeBlockCount = 0;
+			// 1 - largestFreeBlock / freeBytes. 0 when all free memory is one block, approaches 1 as it gets scattered
+			float fragmentation = 0.0f;
+		};
+
+	private:
+		struct Allocation
+		{
+			uint32_t level;
+			uint64_t requestedSize;
+		};
+
+		uint64_t m_capacity;
+		uint64_t m_minBlockSize;
+		// Level 0 is a single block spanning the whole range, the last level holds blocks of m_minBlockSize
+		uint32_t m_levelCount;
+
+		// Free block offsets per level. Ordered so the lowest address is reused first, keeping the range packed
+		std::vector<std::set<uint64_t>> m_freeLists;
+		// Live allocations keyed by offset
+		std::unordered_map<uint64_t, Allocation> m_allocations;
+
+		uint64_t m_usedBytes = 0;
+		uint64_t m_requestedBytes = 0;
+
+		uint64_t BlockSize(uint32_t level) const;
+
+	public:
+		/// <summary>
+		/// Creates a buddy allocator managing <paramref name="capacity"/> bytes
+		/// </summary>
+		/// <param name="capacity">Size of the managed range. Must be a power of 2</param>
+		/// <param name="minBlockSize">Smallest block handed out. Must be a power of 2 no larger than <paramref name="capacity"/></param>
+		BuddyAllocator(uint64_t capacity, uint64_t minBlockSize);
+
+		/// <summary>
+		/// Allocates a block of at least <paramref name="size"/> bytes whose offset is a multiple of <paramref name="alignment"/>
+		/// </summary>
+		/// <returns>Offset of the block, or <see cref="invalidOffset"/> if no block is free or the request exceeds the capacity</returns>
+		uint64_t Allocate(uint64_t size, uint64_t alignment);
+
+		/// <summary>
+		/// Frees the block at <paramref name="offset"/> and merges it with its buddies where possible
+		/// </summary>
+		void Free(uint64_t offset);
+
+		/// <summary>
+		/// Gets the size of the block backing the allocation at <paramref name="offset"/>
+		/// </summary>
+		uint64_t GetAllocationSize(uint64_t offset) const;
+
+		Statistics GetStatistics() const;
+
+		uint64_t GetCapacity() const;
+
+		bool IsEmpty() const;
+
+		static bool IsPowerOfTwo(uint64_t value);
+
+		/// <summary>
+		/// Rounds <paramref name="value"/> up to a power of 2. Must not exceed 2^63, the largest power of 2 that fits
+		/// </summary>
+		static uint64_t NextPowerOfTwo(uint64_t value);
+	};
+}
+
+#include <BuddyAllocator.inl>
+
+#endif // !ULTREALITY_RENDERING_COMMON_BUDDY_ALLOCATOR_H
@@ -0,0 +1,209 @@
+#ifndef ULTREALITY_RENDERING_COMMON_CLUSTERED_LIGHTING_H
+#define ULTREALITY_RENDERING_COMMON_CLUSTERED_LIGHTING_H
+
+#include <stdint.h>
+#include <vector>
+
+#include <FrustumCulling.h>
+
+namespace UltReality::Rendering::Common
+{
+	class JobSystem;
+
+	/// <summary>
+	/// Point light as shaders read it from the light buffer
+	/// </summary>
+	struct ClusterPointLight
+	{
+		float position[3] = {};
+		// Distance at which the light's contribution reaches zero
+		float range = 0.0f;
+		float color[3] = { 1.0f, 1.0f, 1.0f };
+		float intensity = 1.0f;
+	};
+
+	/// <summary>
+	/// Lights of one cluster, a range of the light index list
+	/// </summary>
+	struct ClusterLightRange
+	{
+		uint32_t offset = 0;
+		uint32_t count = 0;
+	};
+
+	/// <summary>
+	/// Constants shaders locate their cluster and its lights with. The cluster of a pixel is
+	/// ((slice * tilesY + tileY) * tilesX + tileX), with tileX and tileY from its position in the viewport and
+	/// slice = clamp(floor(log2(viewZ) * sliceScale + sliceBias), 0, depthSlices - 1)
+	/// </summary>
+	struct ClusterShaderConstants
+	{
+		uint32_t tilesX = 0;
+		uint32_t tilesY = 0;
+		uint32_t depthSlices = 0;
+		uint32_t lightCount = 0;
+		float sliceScale = 0.0f;
+		float sliceBias = 0.0f;
+		// Bindless indices of the light buffer, the cluster ranges and the light index list, filled in by the renderer
+		uint32_t lightBufferIndex = UINT32_MAX;
+		uint32_t clusterBufferIndex = UINT32_MAX;
+		uint32_t lightIndexBufferIndex = UINT32_MAX;
+		uint32_t padding[3] = {};
+	};
+
+	/// <summary>
+	/// Size of the cluster grid. Tiles divide the viewport, slices divide the view depth exponentially
+	/// </summary>
+	struct ClusterGridSettings
+	{
+		uint32_t tilesX = 16;
+		uint32_t tilesY = 9;
+		uint32_t depthSlices = 24;
+	};
+
+	class ClusteredLightBinner;
+
+	/// <summary>
+	/// Tests every light against every cluster one at a time. Reference the binning of
+	/// <see cref="ClusteredLightBinner"/> is validated against, both produce the same lists
+	/// </summary>
+	/// <param name="binner">Binner whose grid and projection are used</param>
+	/// <param name="lights">View space light spheres</param>
+	/// <param name="clusters">Receives the light range of every cluster</param>
+	/// <param name="lightIndices">Receives the light indices of every cluster in ascending order, cluster after cluster</param>
+	void BinClusterLightsReference(const ClusteredLightBinner& binner, const BoundingSphereSoA& lights, std::vector<ClusterLightRange>& clusters, std::vector<uint32_t>& lightIndices);
+
+	/// <summary>
+	/// Clustered light culling on the CPU. The view frustum is divided into a grid of clusters, and every light is
+	/// listed in the clusters its sphere overlaps, so shading only visits the lights near a pixel. Every depth slice
+	/// is binned by its own job. Lights are narrowed down to the slice, then to each row of tiles and then to each
+	/// tile, testing several spheres at a time against the clusters' view space bounds with SIMD
+	/// </summary>
+	class ClusteredLightBinner
+	{
+	public:
+		struct Statistics
+		{
+			uint32_t lightCount = 0;
+			uint32_t clusterCount = 0;
+			// Entries of the light index list
+			uint32_t indexCount = 0;
+			uint32_t maxLightsPerCluster = 0;
+			// Wall time of the last binning
+			float milliseconds = 0.0f;
+		};
+
+		// Upper bound of the cluster count, keeps the per-frame lists small enough to upload
+		static constexpr uint32_t maxClusterCount = 65536;
+
+	private:
+		// Lights surviving one level of the hierarchy, in structure-of-arrays layout padded for SIMD loads
+		struct Candidates
+		{
+			std::vector<float> x;
+			std::vector<float> y;
+			std::vector<float> z;
+			std::vector<float> radius;
+			std::vector<uint32_t> lightIndex;
+			uint32_t count = 0;
+		};
+
+		// Scratch and results of one depth slice
+		struct SliceBins
+		{
+			Candidates slice;
+			Candidates row;
+			std::vector<uint32_t> hits;
+			// Light count of every cluster of the slice and their light indices back to back
+			std::vector<uint32_t> clusterCounts;
+			std::vector<uint32_t> lightIndices;
+		};
+
+		JobSystem* m_jobSystem;
+		CullingSimdPath m_simdPath;
+		ClusterGridSettings m_grid;
+
+		// View space bounds of every cluster, of every row of tiles within a slice and of every slice. A row bounds
+		// its tiles and a slice bounds its rows exactly, so narrowing never drops a light a tile would accept
+		std::vector<float> m_clusterBounds;
+		std::vector<float> m_rowBounds;
+		std::vector<float> m_sliceBounds;
+		float m_nearZ = 0.0f;
+		float m_farZ = 0.0f;
+		float m_sliceScale = 0.0f;
+		float m_sliceBias = 0.0f;
+
+		std::vector<SliceBins> m_sliceBins;
+
+		Statistics m_statistics;
+
+		void BinSlice(uint32_t slice, const BoundingSphereSoA& lights);
+
+	public:
+		/// <param name="jobSystem">Job system the slices are binned on, null to bin on the calling thread. Must outlive the binner</param>
+		/// <exception cref="std::invalid_argument">Thrown if the grid is empty or has more than maxClusterCount clusters</exception>
+		explicit ClusteredLightBinner(JobSystem* jobSystem = nullptr, const ClusterGridSettings& grid = ClusterGridSettings());
+
+		/// <summary>
+		/// Replaces the grid. <see cref="SetProjection"/> has to be called again before binning
+		/// </summary>
+		/// <exception cref="std::invalid_argument">Thrown if the grid is empty or has more than maxClusterCount clusters</exception>
+		void SetGrid(const ClusterGridSettings& grid);
+
+		const ClusterGridSettings& GetGrid() const;
+
+		/// <summary>
+		/// Fits the clusters to a perspective projection looking down +z in view space
+		/// </summary>
+		/// <param name="verticalFov">Vertical field of view in radians</param>
+		/// <param name="aspectRatio">Width over height</param>
+		/// <param name="nearZ">Depth of the first slice</param>
+		/// <param name="farZ">Depth of the last slice, lights beyond it are not binned</param>
+		/// <exception cref="std::invalid_argument">Thrown if the projection is invalid</exception>
+		void SetProjection(float verticalFov, float aspectRatio, float nearZ, float farZ);
+
+		/// <summary>
+		/// Lists the lights of every cluster
+		/// </summary>
+		/// <param name="lights">View space light spheres</param>
+		/// <param name="clusters">Receives the light range of every cluster</param>
+		/// <param name="lightIndices">Receives the light indices of every cluster in ascending order, cluster after cluster</param>
+		/// <exception cref="std::logic_error">Thrown if no projection was set</exception>
+		void Bin(const BoundingSphereSoA& lights, std::vector<ClusterLightRange>& clusters, std::vector<uint32_t>& lightIndices);
+
+		uint32_t GetClusterCount() const;
+
+		/// <summary>
+		/// Gets the view space bounds of a cluster
+		/// </summary>
+		void GetClusterBounds(uint32_t cluster, float min[3], float max[3]) const;
+
+		/// <summary>
+		/// Gets the depth slice a view space depth falls into, clamped to the grid
+		/// </summary>
+		uint32_t GetDepthSlice(float viewZ) const;
+
+		/// <summary>
+		/// Gets the grid and slice constants of <see cref="ClusterShaderConstants"/>, leaving the buffer indices invalid
+		/// </summary>
+		ClusterShaderConstants GetShaderConstants(uint32_t lightCount) const;
+
+		CullingSimdPath GetSimdPath() const;
+
+		/// <summary>
+		/// Forces an instruction set, e.g. to compare the paths against each other
+		/// </summary>
+		/// <exception cref="std::invalid_argument">Thrown if the CPU or the build does not support <paramref name="path"/></exception>
+		void SetSimdPath(CullingSimdPath path);
+
+		/// <summary>
+		/// Gets the light count, list size and duration of the last binning
+		/// </summary>
+		const Statistics& GetStatistics() const;
+
+		ClusteredLightBinner(const ClusteredLightBinner&) = delete;
+		ClusteredLightBinner& operator=(const ClusteredLightBinner&) = delete;
+	};
+}
+
+#endif // !ULTREALITY_RENDERING_COMMON_CLUSTERED_LIGHTING_H
@@ -0,0 +1,72 @@
+#ifndef ULTREALITY_RENDERING_COMMON_DEFERRED_RELEASE_QUEUE_H
+#define ULTREALITY_RENDERING_COMMON_DEFERRED_RELEASE_QUEUE_H
+
+#include <stddef.h>
+#include <stdint.h>
+#include <deque>
+#include <vector>
+
+namespace UltReality::Rendering::Common
+{
+	/// <summary>
+	/// Keeps objects the CPU dropped alive until the GPU is done with them. Objects released during a frame are
+	/// tagged with the fence value of that frame once it is submitted, and destroyed once the fence completed. An
+	/// object released between frames is tagged with the next frame, which is later than any frame that used it,
+	/// so replacing a resource never has to wait for the GPU
+	/// </summary>
+	/// <typeparam name="T">Movable type owning the object, destroying it releases the object</typeparam>
+	template<typename T>
+	class DeferredReleaseQueue
+	{
+	private:
+		struct RetiringFrame
+		{
+			std::vector<T> objects;
+			uint64_t fenceValue;
+		};
+
+		// Objects released during the current frame
+		std::vector<T> m_frameReleased;
+		// Released objects of submitted frames, oldest first
+		std::deque<RetiringFrame> m_retiring;
+		size_t m_pendingCount = 0;
+
+	public:
+		DeferredReleaseQueue() = default;
+
+		/// <summary>
+		/// Queues an object released during the current frame. Frames already submitted may still use it
+		/// </summary>
+		void Release(T object);
+
+		/// <summary>
+		/// Tags every object released since the previous call with <paramref name="fenceValue"/>
+		/// </summary>
+		void FinishFrame(uint64_t fenceValue);
+
+		/// <summary>
+		/// Destroys the objects of every frame whose fence value is at or below <paramref name="completedFenceValue"/>
+		/// </summary>
+		void Retire(uint64_t completedFenceValue);
+
+		/// <summary>
+		/// Like <see cref="Retire(uint64_t)"/>, but hands every object to <paramref name="release"/> first, for objects
+		/// that have to be returned to the allocator they came from
+		/// </summary>
+		/// <param name="release">Called with a reference to every retired object, oldest first</param>
+		template<typename ReleaseFunction>
+		void Retire(uint64_t completedFenceValue, ReleaseFunction&& release);
+
+		/// <summary>
+		/// Gets the number of objects released but not destroyed yet
+		/// </summary>
+		size_t GetPendingCount() const;
+
+		DeferredReleaseQueue(const DeferredReleaseQueue&) = delete;
+		DeferredReleaseQueue& operator=(const DeferredReleaseQueue&) = delete;
+	};
+}
+
+#include <DeferredReleaseQueue.inl>
+
+#endif // !ULTREALITY_RENDERING_COMMON_DEFERRED_RELEASE_QUEUE_H
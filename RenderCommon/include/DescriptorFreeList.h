@@ -0,0 +1,83 @@
+#ifndef ULTREALITY_RENDERING_COMMON_DESCRIPTOR_FREE_LIST_H
+#define ULTREALITY_RENDERING_COMMON_DESCRIPTOR_FREE_LIST_H
+
+#include <stdint.h>
+#include <map>
+#include <vector>
+
+namespace UltReality::Rendering::Common
+{
+	/// <summary>
+	/// Contiguous run of descriptors inside one page of a <see cref="DescriptorFreeList"/>
+	/// </summary>
+	struct DescriptorRange
+	{
+		static constexpr uint32_t invalidPage = UINT32_MAX;
+
+		uint32_t page = invalidPage;
+		uint32_t offset = 0;
+		uint32_t count = 0;
+
+		bool IsValid() const { return page != invalidPage; }
+	};
+
+	/// <summary>
+	/// Creates the backing storage of a descriptor page. Implemented by the API backend, or by a fake heap in tests
+	/// </summary>
+	class IDescriptorPageFactory
+	{
+	public:
+		virtual ~IDescriptorPageFactory() = default;
+
+		/// <summary>
+		/// Called when the free list grows by a page
+		/// </summary>
+		/// <param name="pageIndex">Index of the new page, pages are created in order</param>
+		/// <param name="descriptorCount">Number of descriptors the page must hold</param>
+		virtual void CreatePage(uint32_t pageIndex, uint32_t descriptorCount) = 0;
+	};
+
+	/// <summary>
+	/// First-fit free list of descriptor ranges over a growing set of fixed size pages. Adjacent free ranges are
+	/// coalesced on free, and a new page is requested from the factory only when no existing page has room
+	/// </summary>
+	class DescriptorFreeList
+	{
+	private:
+		IDescriptorPageFactory* m_factory;
+		uint32_t m_pageSize;
+
+		// Free ranges per page, offset -> count
+		std::vector<std::map<uint32_t, uint32_t>> m_freeRanges;
+
+		uint32_t m_allocatedCount = 0;
+
+		DescriptorRange AllocateFromPage(uint32_t page, uint32_t count);
+
+	public:
+		/// <summary>
+		/// Creates an empty free list. The first page is created on the first allocation
+		/// </summary>
+		/// <param name="factory">Creates the storage of new pages. Must outlive the free list</param>
+		/// <param name="pageSize">Number of descriptors per page</param>
+		DescriptorFreeList(IDescriptorPageFactory* factory, uint32_t pageSize);
+
+		/// <summary>
+		/// Allocates <paramref name="count"/> contiguous descriptors, growing by a page if needed
+		/// </summary>
+		DescriptorRange Allocate(uint32_t count);
+
+		/// <summary>
+		/// Returns <paramref name="range"/> to its page
+		/// </summary>
+		void Free(const DescriptorRange& range);
+
+		uint32_t GetPageCount() const;
+
+		uint32_t GetPageSize() const;
+
+		uint32_t GetAllocatedCount() const;
+	};
+}
+
+#endif // !ULTREALITY_RENDERING_COMMON_DESCRIPTOR_FREE_LIST_H
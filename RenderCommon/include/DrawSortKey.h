@@ -0,0 +1,128 @@
+#ifndef ULTREALITY_RENDERING_COMMON_DRAW_SORT_KEY_H
+#define ULTREALITY_RENDERING_COMMON_DRAW_SORT_KEY_H
+
+#include <stdint.h>
+#include <vector>
+
+namespace UltReality::Rendering::Common
+{
+	class JobSystem;
+
+	/// <summary>
+	/// Blend layer of a draw within its pass. Layers are drawn in declaration order
+	/// </summary>
+	enum class DrawLayer : uint32_t
+	{
+		// Sorted by state, then front to back
+		Opaque,
+		AlphaTested,
+		// Sorted back to front, then by state
+		Transparent,
+		Overlay
+	};
+
+	/// <summary>
+	/// Fields packed into a draw sort key
+	/// </summary>
+	struct DrawSortKeyFields
+	{
+		// Pass the draw belongs to, below <see cref="maxDrawPasses"/>
+		uint32_t pass = 0;
+		DrawLayer layer = DrawLayer::Opaque;
+		// Small identifiers of the pipeline state and the material bindings, below <see cref="maxDrawStateIds"/>
+		uint32_t pipeline = 0;
+		uint32_t material = 0;
+		// Normalized view depth, 0 at the near plane and 1 at the far plane. Values outside are clamped
+		float depth = 0.0f;
+	};
+
+	constexpr uint32_t maxDrawPasses = 1u << 6;
+	constexpr uint32_t maxDrawStateIds = 1u << 16;
+	constexpr uint32_t drawSortDepthBits = 24;
+
+	/// <summary>
+	/// Packs the fields into a 64-bit key whose ascending order is the draw order. From the most significant bit:
+	/// 6 bits of pass and 2 of layer, followed by 16 bits of pipeline, 16 of material and 24 of depth for the
+	/// front-to-back layers, or by the inverted depth, pipeline and material for the back-to-front layers
+	/// </summary>
+	/// <exception cref="std::invalid_argument">Thrown if the pass or a state identifier exceeds its bits</exception>
+	uint64_t EncodeDrawSortKey(const DrawSortKeyFields& fields);
+
+	/// <summary>
+	/// Unpacks a key made by <see cref="EncodeDrawSortKey"/>. The depth comes back quantized
+	/// </summary>
+	DrawSortKeyFields DecodeDrawSortKey(uint64_t key);
+
+	/// <summary>
+	/// Gets the bits of a key that select GPU state, i.e. everything but the depth. Draws whose state bits match can
+	/// be recorded without rebinding
+	/// </summary>
+	uint64_t DrawSortKeyState(uint64_t key);
+
+	/// <summary>
+	/// Counts the neighbouring draws whose state bits differ when recorded in the given order
+	/// </summary>
+	/// <param name="keys">Sort keys of the draws</param>
+	/// <param name="order">Indices into <paramref name="keys"/> in recording order, null for the order of the keys</param>
+	uint32_t CountDrawStateChanges(const std::vector<uint64_t>& keys, const uint32_t* order = nullptr);
+
+	/// <summary>
+	/// Stable parallel LSD radix sort of draw sort keys, one byte per pass. Every pass histograms the chunks of the
+	/// keys in parallel, turns the histograms into per chunk offsets and scatters the chunks in parallel. Passes
+	/// over a byte that is equal in every key are skipped, so keys only differing in a few fields sort in few passes
+	/// </summary>
+	class DrawKeySorter
+	{
+	public:
+		struct Statistics
+		{
+			uint32_t keyCount = 0;
+			// Byte passes that moved keys, at most 8
+			uint32_t passCount = 0;
+			// State changes when recording in submission order and in sorted order
+			uint32_t submittedStateChanges = 0;
+			uint32_t sortedStateChanges = 0;
+			// Wall time of the last sort, without the state change counts
+			float milliseconds = 0.0f;
+		};
+
+		// Default number of keys a single job histograms and scatters
+		static constexpr uint32_t defaultKeysPerJob = 16384;
+
+	private:
+		static constexpr uint32_t s_radix = 256;
+
+		JobSystem* m_jobSystem;
+		uint32_t m_keysPerJob;
+
+		// Ping-pong buffers of keys and original indices
+		std::vector<uint64_t> m_keys[2];
+		std::vector<uint32_t> m_indices[2];
+		// Digit counts of every chunk, turned into scatter offsets in place
+		std::vector<uint32_t> m_chunkHistograms;
+
+		Statistics m_statistics;
+
+	public:
+		/// <param name="jobSystem">Job system chunks are processed on, null to sort on the calling thread. Must outlive the sorter</param>
+		/// <param name="keysPerJob">Keys handled by one job</param>
+		explicit DrawKeySorter(JobSystem* jobSystem = nullptr, uint32_t keysPerJob = defaultKeysPerJob);
+
+		/// <summary>
+		/// Sorts the keys ascending. Equal keys keep their submission order
+		/// </summary>
+		/// <param name="keys">Keys in submission order</param>
+		/// <param name="order">Receives the submission index of every key in sorted order</param>
+		void Sort(const std::vector<uint64_t>& keys, std::vector<uint32_t>& order);
+
+		/// <summary>
+		/// Gets the key count, pass count, state changes and duration of the last sort
+		/// </summary>
+		const Statistics& GetStatistics() const;
+
+		DrawKeySorter(const DrawKeySorter&) = delete;
+		DrawKeySorter& operator=(const DrawKeySorter&) = delete;
+	};
+}
+
+#endif // !ULTREALITY_RENDERING_COMMON_DRAW_SORT_KEY_H
@@ -0,0 +1,94 @@
+#ifndef ULTREALITY_RENDERING_COMMON_DYNAMIC_RESOLUTION_H
+#define ULTREALITY_RENDERING_COMMON_DYNAMIC_RESOLUTION_H
+
+#include <stdint.h>
+
+namespace UltReality::Rendering::Common
+{
+	/// <summary>
+	/// Budget, bounds and gains of a <see cref="DynamicResolutionController"/>
+	/// </summary>
+	struct DynamicResolutionConfig
+	{
+		// Off draws the scene at full scale every frame
+		bool enabled = false;
+		// GPU time per frame the controller steers towards. A little below the frame interval leaves headroom
+		float targetFrameMilliseconds = 15.0f;
+		// Bounds of the scale of each axis, relative to the display size
+		float minScale = 0.5f;
+		float maxScale = 1.0f;
+		// Gains on the error log2(target / measured), the factor in stops the pixel count is off by
+		float proportionalGain = 0.2f;
+		float integralGain = 0.1f;
+		float derivativeGain = 0.05f;
+		// Errors within this many stops count as on target, so timing noise does not move the scale
+		float deadbandStops = 0.05f;
+		// Step the scale is rounded to, so small corrections do not resize the viewport every frame
+		float scaleStep = 1.0f / 32.0f;
+	};
+
+	/// <summary>
+	/// PID controller picking the render scale from measured GPU frame times. It works on the log2 of the pixel
+	/// fraction, which GPU time roughly follows, so the same gains hold at every load. The integral term holds the
+	/// operating point and is clamped to the scale bounds, so it never winds up while the scale is saturated.
+	/// Deterministic, the same sequence of frame times always yields the same scales
+	/// </summary>
+	class DynamicResolutionController
+	{
+	private:
+		DynamicResolutionConfig m_config;
+		// Sum of the errors, in stops
+		float m_integral = 0.0f;
+		float m_previousError = 0.0f;
+		bool m_hasPreviousError = false;
+		float m_scale = 1.0f;
+		uint64_t m_updateCount = 0;
+
+	public:
+		/// <summary>
+		/// Creates a controller at the maximum scale of <paramref name="config"/>
+		/// </summary>
+		/// <exception cref="std::invalid_argument">Thrown if the config is invalid</exception>
+		explicit DynamicResolutionController(const DynamicResolutionConfig& config = DynamicResolutionConfig());
+
+		/// <summary>
+		/// Replaces the config and restarts at its maximum scale
+		/// </summary>
+		/// <exception cref="std::invalid_argument">Thrown if the budget or a gain is not positive, or the scale bounds are not within (0, 1]</exception>
+		void SetConfig(const DynamicResolutionConfig& config);
+
+		const DynamicResolutionConfig& GetConfig() const;
+
+		/// <summary>
+		/// Feeds the GPU time of one finished frame and picks the next scale
+		/// </summary>
+		/// <param name="gpuFrameMilliseconds">Measured GPU time of the frame. Non-positive times are ignored</param>
+		/// <returns>The scale of each axis to draw the next frames at</returns>
+		float Update(float gpuFrameMilliseconds);
+
+		/// <summary>
+		/// Gets the scale of each axis picked by the last <see cref="Update"/>, rounded to the scale step
+		/// </summary>
+		float GetScale() const;
+
+		/// <summary>
+		/// Gets the number of frame times fed since the config was set
+		/// </summary>
+		uint64_t GetUpdateCount() const;
+
+		/// <summary>
+		/// Drops the history and returns to the maximum scale
+		/// </summary>
+		void Reset();
+
+		/// <summary>
+		/// Scales a display size, rounding to whole pixels and never below one pixel
+		/// </summary>
+		static uint32_t ScaleSize(uint32_t size, float scale);
+
+		DynamicResolutionController(const DynamicResolutionController&) = delete;
+		DynamicResolutionController& operator=(const DynamicResolutionController&) = delete;
+	};
+}
+
+#endif // !ULTREALITY_RENDERING_COMMON_DYNAMIC_RESOLUTION_H
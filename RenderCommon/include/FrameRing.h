@@ -0,0 +1,79 @@
+#ifndef ULTREALITY_RENDERING_COMMON_FRAME_RING_H
+#define ULTREALITY_RENDERING_COMMON_FRAME_RING_H
+
+#include <stdint.h>
+#include <array>
+
+#include <IFenceTimeline.h>
+
+namespace UltReality::Rendering::Common
+{
+	/// <summary>
+	/// Tracks the fence value of every frame the CPU is allowed to record ahead of the GPU.
+	/// The CPU only waits when it wraps around onto a frame slot the GPU has not retired yet
+	/// </summary>
+	class FrameRing
+	{
+	public:
+		// Upper bound on the number of frames that can be in flight at once
+		static constexpr uint32_t maxFramesInFlight = 4;
+
+	private:
+		IFenceTimeline* m_timeline;
+
+		// Fence value signalled at the end of each frame slot. 0 means the slot was never used
+		std::array<uint64_t, maxFramesInFlight> m_frameFenceValues{};
+
+		uint32_t m_framesInFlight;
+		uint32_t m_frameIndex = 0;
+
+		// Number of times BeginFrame had to block on the GPU
+		uint64_t m_stallCount = 0;
+
+	public:
+		/// <summary>
+		/// Creates a frame ring driven by <paramref name="timeline"/>
+		/// </summary>
+		/// <param name="timeline">Fence timeline of the queue frames are submitted to. Must outlive the ring</param>
+		/// <param name="framesInFlight">Number of frames the CPU may record ahead of the GPU, in [1, maxFramesInFlight]</param>
+		FrameRing(IFenceTimeline* timeline, uint32_t framesInFlight);
+
+		/// <summary>
+		/// Waits until the GPU has retired the frame that last used the current slot
+		/// </summary>
+		/// <returns>Index of the frame slot that may now be recorded into</returns>
+		uint32_t BeginFrame();
+
+		/// <summary>
+		/// Signals the end of the current frame and advances to the next slot
+		/// </summary>
+		/// <returns>Fence value that marks the completion of the frame</returns>
+		uint64_t EndFrame();
+
+		/// <summary>
+		/// Signals the timeline and blocks until all submitted work has completed
+		/// </summary>
+		void WaitForIdle();
+
+		/// <summary>
+		/// Changes the number of frames in flight. Drains the GPU first so every slot is free
+		/// </summary>
+		/// <param name="framesInFlight">New frame count, in [1, maxFramesInFlight]</param>
+		void Resize(uint32_t framesInFlight);
+
+		uint32_t GetFrameIndex() const;
+
+		uint32_t GetFramesInFlight() const;
+
+		uint64_t GetFrameFenceValue(uint32_t frameIndex) const;
+
+		uint64_t GetStallCount() const;
+
+		FrameRing(const FrameRing&) = delete;
+		FrameRing& operator=(const FrameRing&) = delete;
+	};
+}
+
+#include <FrameRing.inl>
+
+#endif // !ULTREALITY_RENDERING_COMMON_FRAME_RING_H
@@ -0,0 +1,123 @@
+#ifndef ULTREALITY_RENDERING_COMMON_FRAME_TIMING_STATS_H
+#define ULTREALITY_RENDERING_COMMON_FRAME_TIMING_STATS_H
+
+#include <stdint.h>
+#include <array>
+#include <atomic>
+
+namespace UltReality::Rendering::Common
+{
+	struct FrameTimingSample
+	{
+		// CPU time spent recording and submitting the frame, excluding the fence wait
+		float cpuFrameMilliseconds = 0.0f;
+		// CPU time spent waiting for the GPU to free the frame slot
+		float fenceWaitMilliseconds = 0.0f;
+		// Time since the previous present
+		float presentIntervalMilliseconds = 0.0f;
+	};
+
+	struct FrameTimingDistribution
+	{
+		double mean = 0.0;
+		double p50 = 0.0;
+		double p95 = 0.0;
+		double p99 = 0.0;
+		double max = 0.0;
+	};
+
+	/// <summary>
+	/// Frame timing over the frames currently held by a <see cref="FrameTimingStats"/>, in milliseconds
+	/// </summary>
+	struct FrameTimingSummary
+	{
+		// Number of frames the distributions were computed from
+		uint32_t sampleCount = 0;
+		// Frames recorded since the stats were created or reset
+		uint64_t frameCount = 0;
+		// Frames whose present interval exceeded the hitch threshold since the stats were created or reset
+		uint64_t hitchCount = 0;
+
+		// Presents per second over the window
+		double framesPerSecond = 0.0;
+
+		FrameTimingDistribution cpuFrame;
+		FrameTimingDistribution fenceWait;
+		FrameTimingDistribution presentInterval;
+
+		// Standard deviation of the present interval, 0 for perfectly even pacing
+		double pacingStandardDeviation = 0.0;
+	};
+
+	/// <summary>
+	/// Keeps the timings of the most recent <see cref="capacity"/> frames in a fixed size ring. One thread records,
+	/// any number of threads may read summaries at the same time without locks. Every slot carries the number of the
+	/// frame it holds, a reader drops slots that were overwritten while it copied them
+	/// </summary>
+	class FrameTimingStats
+	{
+	public:
+		// Frames kept for the distributions, about 4 seconds at 60 Hz
+		static constexpr uint32_t capacity = 256;
+
+		// A present interval longer than this factor times the running average counts as a hitch
+		static constexpr float defaultHitchFactor = 2.0f;
+		// Intervals below this never count as a hitch, whatever the running average
+		static constexpr float defaultHitchFloorMilliseconds = 8.0f;
+
+	private:
+		struct Slot
+		{
+			// Frame number + 1 of the sample in the slot, 0 while the slot is being written
+			std::atomic<uint64_t> sequence{ 0 };
+			std::atomic<float> cpuFrameMilliseconds{ 0.0f };
+			std::atomic<float> fenceWaitMilliseconds{ 0.0f };
+			std::atomic<float> presentIntervalMilliseconds{ 0.0f };
+		};
+
+		std::array<Slot, capacity> m_slots;
+		std::atomic<uint64_t> m_frameCount{ 0 };
+		std::atomic<uint64_t> m_hitchCount{ 0 };
+
+		// Only touched by the recording thread
+		float m_averageInterval = 0.0f;
+		float m_hitchFactor = defaultHitchFactor;
+		float m_hitchFloorMilliseconds = defaultHitchFloorMilliseconds;
+
+	public:
+		FrameTimingStats() = default;
+
+		/// <summary>
+		/// Records the timings of one frame. Only one thread may record
+		/// </summary>
+		/// <returns>True if the frame counted as a hitch</returns>
+		bool Record(const FrameTimingSample& sample);
+
+		/// <summary>
+		/// Computes the distributions over the frames currently in the ring. Thread safe
+		/// </summary>
+		FrameTimingSummary GetSummary() const;
+
+		/// <summary>
+		/// Copies the frames currently in the ring, oldest first. Thread safe
+		/// </summary>
+		/// <param name="samples">Receives up to <see cref="capacity"/> samples</param>
+		/// <returns>Number of samples copied</returns>
+		uint32_t CopySamples(std::array<FrameTimingSample, capacity>& samples) const;
+
+		/// <summary>
+		/// Sets when a frame counts as a hitch. Only call from the recording thread
+		/// </summary>
+		void SetHitchThreshold(float factor, float floorMilliseconds);
+
+		/// <summary>
+		/// Drops every recorded frame. Only call from the recording thread
+		/// </summary>
+		void Reset();
+
+		FrameTimingStats(const FrameTimingStats&) = delete;
+		FrameTimingStats& operator=(const FrameTimingStats&) = delete;
+	};
+}
+
+#endif // !ULTREALITY_RENDERING_COMMON_FRAME_TIMING_STATS_H
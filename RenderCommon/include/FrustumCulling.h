@@ -0,0 +1,183 @@
+#ifndef ULTREALITY_RENDERING_COMMON_FRUSTUM_CULLING_H
+#define ULTREALITY_RENDERING_COMMON_FRUSTUM_CULLING_H
+
+#include <stdint.h>
+#include <vector>
+
+namespace UltReality::Rendering::Common
+{
+	class JobSystem;
+
+	/// <summary>
+	/// Instruction set a <see cref="FrustumCuller"/> tests bounding volumes with
+	/// </summary>
+	enum class CullingSimdPath : uint32_t
+	{
+		Scalar,
+		// 4 objects per instruction
+		Sse,
+		Neon,
+		// 8 objects per instruction
+		Avx2
+	};
+
+	/// <summary>
+	/// Bounding spheres in structure-of-arrays layout. The arrays are padded to a multiple of
+	/// <see cref="simdPadding"/>, so the widest SIMD path can load every chunk without a scalar tail
+	/// </summary>
+	class BoundingSphereSoA
+	{
+	public:
+		static constexpr uint32_t simdPadding = 8;
+
+	private:
+		std::vector<float> m_centerX;
+		std::vector<float> m_centerY;
+		std::vector<float> m_centerZ;
+		std::vector<float> m_radius;
+		uint32_t m_count = 0;
+
+	public:
+		/// <summary>
+		/// Appends a sphere
+		/// </summary>
+		/// <returns>Index of the sphere, reported by the culler when it is visible</returns>
+		uint32_t Add(const float center[3], float radius);
+
+		void Set(uint32_t index, const float center[3], float radius);
+
+		void Clear();
+
+		uint32_t Size() const;
+
+		const float* CenterX() const;
+		const float* CenterY() const;
+		const float* CenterZ() const;
+		const float* Radius() const;
+	};
+
+	/// <summary>
+	/// Axis aligned bounding boxes in structure-of-arrays layout, stored as center and half extents. Padded like
+	/// <see cref="BoundingSphereSoA"/>
+	/// </summary>
+	class BoundingBoxSoA
+	{
+	public:
+		static constexpr uint32_t simdPadding = BoundingSphereSoA::simdPadding;
+
+	private:
+		std::vector<float> m_centerX;
+		std::vector<float> m_centerY;
+		std::vector<float> m_centerZ;
+		std::vector<float> m_extentX;
+		std::vector<float> m_extentY;
+		std::vector<float> m_extentZ;
+		uint32_t m_count = 0;
+
+	public:
+		/// <summary>
+		/// Appends the box spanning [<paramref name="min"/>, <paramref name="max"/>]
+		/// </summary>
+		/// <returns>Index of the box, reported by the culler when it is visible</returns>
+		uint32_t Add(const float min[3], const float max[3]);
+
+		void Set(uint32_t index, const float min[3], const float max[3]);
+
+		void Clear();
+
+		uint32_t Size() const;
+
+		const float* CenterX() const;
+		const float* CenterY() const;
+		const float* CenterZ() const;
+		const float* ExtentX() const;
+		const float* ExtentY() const;
+		const float* ExtentZ() const;
+	};
+
+	/// <summary>
+	/// Tests bounding volumes against the frustum planes several at a time and collects the indices of the visible
+	/// ones in ascending order. Large sets are split into chunks culled in parallel on the job system, every chunk
+	/// fills its own list and the lists are concatenated in chunk order
+	/// </summary>
+	class FrustumCuller
+	{
+	public:
+		struct Statistics
+		{
+			uint32_t testedCount = 0;
+			uint32_t visibleCount = 0;
+			uint32_t chunkCount = 0;
+			// Wall time of the last cull
+			float milliseconds = 0.0f;
+		};
+
+		// Default number of objects a single job tests
+		static constexpr uint32_t defaultObjectsPerJob = 16384;
+
+	private:
+		JobSystem* m_jobSystem;
+		uint32_t m_objectsPerJob;
+		CullingSimdPath m_simdPath;
+
+		// Visible indices of every chunk, kept between culls to reuse their memory
+		std::vector<std::vector<uint32_t>> m_chunkVisible;
+
+		Statistics m_statistics;
+
+		template<typename Volumes, typename RangeCull>
+		void Cull(const Volumes& volumes, RangeCull rangeCull, std::vector<uint32_t>& visible);
+
+	public:
+		/// <summary>
+		/// Creates a culler using the widest instruction set the CPU supports
+		/// </summary>
+		/// <param name="jobSystem">Job system chunks are culled on, null to cull on the calling thread. Must outlive the culler</param>
+		/// <param name="objectsPerJob">Objects tested by one job, rounded up to a multiple of the SIMD padding</param>
+		explicit FrustumCuller(JobSystem* jobSystem = nullptr, uint32_t objectsPerJob = defaultObjectsPerJob);
+
+		/// <summary>
+		/// Replaces the visible indices with those of the spheres inside the frustum
+		/// </summary>
+		/// <param name="planes">Normalized frustum planes, see <see cref="ExtractFrustumPlanes"/></param>
+		/// <param name="spheres">Spheres to test</param>
+		/// <param name="visible">Receives the indices of the visible spheres in ascending order</param>
+		void CullSpheres(const float planes[6][4], const BoundingSphereSoA& spheres, std::vector<uint32_t>& visible);
+
+		/// <summary>
+		/// Replaces the visible indices with those of the boxes inside the frustum
+		/// </summary>
+		/// <param name="planes">Normalized frustum planes, see <see cref="ExtractFrustumPlanes"/></param>
+		/// <param name="boxes">Boxes to test</param>
+		/// <param name="visible">Receives the indices of the visible boxes in ascending order</param>
+		void CullBoxes(const float planes[6][4], const BoundingBoxSoA& boxes, std::vector<uint32_t>& visible);
+
+		CullingSimdPath GetSimdPath() const;
+
+		/// <summary>
+		/// Forces an instruction set, e.g. to compare the paths against each other
+		/// </summary>
+		/// <exception cref="std::invalid_argument">Thrown if the CPU or the build does not support <paramref name="path"/></exception>
+		void SetSimdPath(CullingSimdPath path);
+
+		/// <summary>
+		/// Gets the object count, visible count and duration of the last cull
+		/// </summary>
+		const Statistics& GetStatistics() const;
+
+		/// <summary>
+		/// Checks whether this build and CPU can run <paramref name="path"/>
+		/// </summary>
+		static bool IsSimdPathSupported(CullingSimdPath path);
+
+		/// <summary>
+		/// Gets the widest instruction set this build and CPU can run
+		/// </summary>
+		static CullingSimdPath DetectSimdPath();
+
+		FrustumCuller(const FrustumCuller&) = delete;
+		FrustumCuller& operator=(const FrustumCuller&) = delete;
+	};
+}
+
+#endif // !ULTREALITY_RENDERING_COMMON_FRUSTUM_CULLING_H
@@ -0,0 +1,102 @@
+#ifndef ULTREALITY_RENDERING_COMMON_GPU_CULLING_H
+#define ULTREALITY_RENDERING_COMMON_GPU_CULLING_H
+
+#include <stdint.h>
+#include <vector>
+
+namespace UltReality::Rendering::Common
+{
+	/// <summary>
+	/// Per-instance record of the instance buffer the culling pass reads. Layout matches the HLSL structure
+	/// </summary>
+	struct GpuInstance
+	{
+		// World space bounding sphere
+		float boundsCenter[3] = {};
+		float boundsRadius = 0.0f;
+		// Entry of the mesh table the instance draws
+		uint32_t meshIndex = 0;
+		// Opaque to the culling pass, e.g. the index of the instance's transform or material
+		uint32_t userData = 0;
+		uint32_t padding[2] = {};
+	};
+
+	/// <summary>
+	/// Index range of one mesh inside the shared geometry buffers
+	/// </summary>
+	struct GpuMesh
+	{
+		uint32_t indexCount = 0;
+		uint32_t startIndex = 0;
+		int32_t baseVertex = 0;
+		uint32_t padding = 0;
+	};
+
+	/// <summary>
+	/// Constant buffer of the culling pass
+	/// </summary>
+	struct GpuCullConstants
+	{
+		// Normalized frustum planes (a, b, c, d), inside where a*x + b*y + c*z + d >= 0
+		float frustumPlanes[6][4] = {};
+		uint32_t instanceCount = 0;
+		uint32_t meshCount = 0;
+		// Number of culling thread groups
+		uint32_t groupCount = 0;
+		uint32_t padding = 0;
+	};
+
+	/// <summary>
+	/// One draw of the indirect argument buffer: the instance index, written to a root constant, followed by the
+	/// arguments of an indexed draw in the layout of D3D12_DRAW_INDEXED_ARGUMENTS
+	/// </summary>
+	struct IndirectDrawCommand
+	{
+		uint32_t instanceIndex = 0;
+		uint32_t indexCountPerInstance = 0;
+		uint32_t instanceCount = 0;
+		uint32_t startIndexLocation = 0;
+		int32_t baseVertexLocation = 0;
+		uint32_t startInstanceLocation = 0;
+	};
+
+	static_assert(sizeof(GpuInstance) == 32, "GpuInstance must match the HLSL layout");
+	static_assert(sizeof(GpuMesh) == 16, "GpuMesh must match the HLSL layout");
+	static_assert(sizeof(GpuCullConstants) == 112, "GpuCullConstants must match the HLSL layout");
+	static_assert(sizeof(IndirectDrawCommand) == 24, "IndirectDrawCommand must match the command signature stride");
+
+	// Threads per culling thread group, the granularity of the compaction prefix sums
+	constexpr uint32_t gpuCullGroupSize = 256;
+	// Value of an instance's local offset when it was culled
+	constexpr uint32_t gpuCulledOffset = UINT32_MAX;
+
+	/// <summary>
+	/// Extracts the normalized frustum planes of a row-major, row-vector view projection matrix with a [0, 1] depth range
+	/// </summary>
+	void ExtractFrustumPlanes(const float viewProjection[16], float planes[6][4]);
+
+	/// <summary>
+	/// Tests a bounding sphere against the frustum planes with the same operations, in the same order, as the culling shader
+	/// </summary>
+	bool IsSphereInFrustum(const float planes[6][4], const float center[3], float radius);
+
+	/// <summary>
+	/// Number of culling thread groups needed for <paramref name="instanceCount"/> instances
+	/// </summary>
+	constexpr uint32_t GpuCullGroupCount(uint32_t instanceCount)
+	{
+		return (instanceCount + gpuCullGroupSize - 1) / gpuCullGroupSize;
+	}
+
+	/// <summary>
+	/// CPU reference of the culling and compaction passes. The GPU compaction places the visible instances in instance
+	/// order through prefix sums instead of atomics, so its argument buffer matches the result of this function bit for bit
+	/// </summary>
+	/// <param name="constants">Constants the passes run with</param>
+	/// <param name="instances">Instance buffer, at least <c>constants.instanceCount</c> entries</param>
+	/// <param name="meshes">Mesh table, at least <c>constants.meshCount</c> entries</param>
+	/// <returns>Draw commands of the visible instances, the draw count being the size</returns>
+	std::vector<IndirectDrawCommand> CullAndCompactReference(const GpuCullConstants& constants, const std::vector<GpuInstance>& instances, const std::vector<GpuMesh>& meshes);
+}
+
+#endif // !ULTREALITY_RENDERING_COMMON_GPU_CULLING_H
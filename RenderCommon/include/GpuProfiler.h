@@ -0,0 +1,186 @@
+#ifndef ULTREALITY_RENDERING_COMMON_GPU_PROFILER_H
+#define ULTREALITY_RENDERING_COMMON_GPU_PROFILER_H
+
+#include <stdint.h>
+#include <array>
+#include <atomic>
+#include <memory>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include <FrameRing.h>
+
+namespace UltReality::Rendering::Common
+{
+	struct GpuScopeTiming
+	{
+		std::string name;
+		// Index of the parent scope in <see cref="GpuFrameProfile::scopes"/>, GpuProfiler::invalidScope for top level scopes
+		uint32_t parent = UINT32_MAX;
+		uint32_t depth = 0;
+		// Number of recorded scopes merged into this one, scopes with the same name and parent are merged
+		uint32_t count = 0;
+		// GPU time spent inside the scope, including its children
+		double milliseconds = 0.0;
+		// GPU time spent inside the scope but outside its children
+		double exclusiveMilliseconds = 0.0;
+	};
+
+	/// <summary>
+	/// GPU timings of one frame as a scope tree
+	/// </summary>
+	struct GpuFrameProfile
+	{
+		// Frame the timings were recorded in, counted by the profiler. 0 until the first frame has been read back
+		uint64_t frameNumber = 0;
+		// Time from the first to the last timestamp of the frame
+		double frameMilliseconds = 0.0;
+		// Scopes in depth first order, every parent precedes its children
+		std::vector<GpuScopeTiming> scopes;
+
+		/// <summary>
+		/// Sums the time of every scope named <paramref name="name"/>
+		/// </summary>
+		double GetMilliseconds(std::string_view name) const;
+	};
+
+	/// <summary>
+	/// API independent bookkeeping of a timestamp query profiler. Every scope owns a begin and an end query. Queries
+	/// live in a ring of frame slots, a slot is read back once the fence of its frame completed and is only reused
+	/// after that, so neither recording nor reading back ever waits on the GPU. A frame whose slot is still in flight
+	/// is simply not profiled.
+	///
+	/// Scopes can be opened and closed from any thread and on any command list of the same queue, a parent scope may
+	/// begin on one command list and end on another
+	/// </summary>
+	class GpuProfiler
+	{
+	public:
+		static constexpr uint32_t invalidScope = UINT32_MAX;
+		// One slot more than frames can be in flight, so a slot is normally read back before it is needed again
+		static constexpr uint32_t frameSlotCount = FrameRing::maxFramesInFlight + 1;
+
+	private:
+		struct ScopeRecord
+		{
+			std::string name;
+			uint32_t parent = invalidScope;
+			std::atomic<bool> open{ false };
+		};
+
+		struct FrameSlot
+		{
+			std::unique_ptr<ScopeRecord[]> scopes;
+			std::atomic<uint32_t> scopeCount{ 0 };
+			// Fence value of the submitted frame, 0 while the slot is free or recording
+			uint64_t fenceValue = 0;
+			uint64_t frameNumber = 0;
+			bool submitted = false;
+		};
+
+		uint32_t m_maxScopesPerFrame;
+		double m_ticksPerMillisecond = 0.0;
+
+		std::array<FrameSlot, frameSlotCount> m_slots;
+		uint32_t m_currentSlot = 0;
+		// False when the current frame is not profiled because its slot was still in flight
+		bool m_recording = false;
+		uint64_t m_frameNumber = 0;
+		uint64_t m_skippedFrames = 0;
+
+		GpuFrameProfile m_latestProfile;
+
+	public:
+		/// <summary>
+		/// Creates a profiler with room for <paramref name="maxScopesPerFrame"/> scopes per frame. Scopes past that are dropped
+		/// </summary>
+		explicit GpuProfiler(uint32_t maxScopesPerFrame);
+
+		/// <summary>
+		/// Sets the rate the timestamps advance at
+		/// </summary>
+		void SetTimestampFrequency(uint64_t ticksPerSecond);
+
+		/// <summary>
+		/// Starts recording a frame into the next slot
+		/// </summary>
+		/// <returns>False if the slot is still waiting to be read back, the frame is then not profiled</returns>
+		bool BeginFrame();
+
+		/// <summary>
+		/// Opens a scope in the current frame. Thread safe
+		/// </summary>
+		/// <param name="name">Name of the scope</param>
+		/// <param name="parent">Scope to nest the new one under, <see cref="invalidScope"/> for a top level scope</param>
+		/// <returns>The scope, <see cref="invalidScope"/> if the frame is not profiled or out of scopes</returns>
+		uint32_t BeginScope(std::string_view name, uint32_t parent = invalidScope);
+
+		/// <summary>
+		/// Closes a scope opened by <see cref="BeginScope"/>. Thread safe
+		/// </summary>
+		void EndScope(uint32_t scope);
+
+		/// <summary>
+		/// Gets the number of scopes opened in the current frame
+		/// </summary>
+		uint32_t GetScopeCount() const;
+
+		bool IsScopeOpen(uint32_t scope) const;
+
+		/// <summary>
+		/// Gets the query index the begin timestamp of <paramref name="scope"/> is written to
+		/// </summary>
+		uint32_t GetBeginQuery(uint32_t scope) const;
+
+		/// <summary>
+		/// Gets the query index the end timestamp of <paramref name="scope"/> is written to
+		/// </summary>
+		uint32_t GetEndQuery(uint32_t scope) const;
+
+		/// <summary>
+		/// Gets the first query of the current frame's slot. The frame writes GetScopeCount() * 2 queries from there
+		/// </summary>
+		uint32_t GetFrameQueryOffset() const;
+
+		/// <summary>
+		/// Gets the number of queries needed for every slot
+		/// </summary>
+		uint32_t GetQueryCount() const;
+
+		/// <summary>
+		/// Marks the current frame as submitted. Its timestamps can be read once <paramref name="fenceValue"/> completed
+		/// </summary>
+		void EndFrame(uint64_t fenceValue);
+
+		/// <summary>
+		/// Finds the oldest submitted frame whose fence completed
+		/// </summary>
+		/// <param name="completedFenceValue">Last fence value completed by the GPU</param>
+		/// <param name="slot">Receives the slot of the frame</param>
+		/// <returns>False if no frame is ready to be read back</returns>
+		bool NextCompletedFrame(uint64_t completedFenceValue, uint32_t& slot) const;
+
+		/// <summary>
+		/// Builds the profile of the frame in <paramref name="slot"/> and frees the slot
+		/// </summary>
+		/// <param name="slot">Slot returned by <see cref="NextCompletedFrame"/></param>
+		/// <param name="timestamps">The slot's timestamps, 2 per scope starting at the slot's first query</param>
+		void ReadFrame(uint32_t slot, const uint64_t* timestamps);
+
+		/// <summary>
+		/// Gets the profile of the most recent frame that was read back
+		/// </summary>
+		const GpuFrameProfile& GetLatestProfile() const;
+
+		/// <summary>
+		/// Gets the number of frames that were not profiled because their slot was still in flight
+		/// </summary>
+		uint64_t GetSkippedFrameCount() const;
+
+		GpuProfiler(const GpuProfiler&) = delete;
+		GpuProfiler& operator=(const GpuProfiler&) = delete;
+	};
+}
+
+#endif // !ULTREALITY_RENDERING_COMMON_GPU_PROFILER_H
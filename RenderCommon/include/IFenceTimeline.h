@@ -0,0 +1,36 @@
+#ifndef ULTREALITY_RENDERING_COMMON_IFENCE_TIMELINE_H
+#define ULTREALITY_RENDERING_COMMON_IFENCE_TIMELINE_H
+
+#include <stdint.h>
+
+namespace UltReality::Rendering::Common
+{
+	/// <summary>
+	/// Abstraction over a monotonically increasing fence that is signalled by a queue.
+	/// Implemented by the D3D12 backend and by simulated timelines so that frame pacing logic does not depend on a GPU
+	/// </summary>
+	class IFenceTimeline
+	{
+	public:
+		virtual ~IFenceTimeline() = default;
+
+		/// <summary>
+		/// Enqueues a signal of the next fence value on the owning queue
+		/// </summary>
+		/// <returns>The fence value that will be reached once all previously submitted work completes</returns>
+		virtual uint64_t Signal() = 0;
+
+		/// <summary>
+		/// Gets the highest fence value the queue has completed
+		/// </summary>
+		virtual uint64_t GetCompletedValue() const = 0;
+
+		/// <summary>
+		/// Blocks the calling thread until the fence reaches <paramref name="value"/>
+		/// </summary>
+		/// <param name="value">Fence value to wait on</param>
+		virtual void WaitForValue(uint64_t value) = 0;
+	};
+}
+
+#endif // !ULTREALITY_RENDERING_COMMON_IFENCE_TIMELINE_H
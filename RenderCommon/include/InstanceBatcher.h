@@ -0,0 +1,72 @@
+#ifndef ULTREALITY_RENDERING_COMMON_INSTANCE_BATCHER_H
+#define ULTREALITY_RENDERING_COMMON_INSTANCE_BATCHER_H
+
+#include <stdint.h>
+#include <unordered_map>
+#include <vector>
+
+#include <DrawSortKey.h>
+
+namespace UltReality::Rendering::Common
+{
+	/// <summary>
+	/// Draws merged into one instanced draw
+	/// </summary>
+	struct InstanceBatch
+	{
+		// Range of the batch's draws in the instance order. The first one represents the batch
+		uint32_t firstInstance = 0;
+		uint32_t instanceCount = 0;
+	};
+
+	/// <summary>
+	/// Groups draws that share geometry, pipeline and material into instanced draws. Draws are visited in sort key
+	/// order. Within a pass and layer drawn front to back, every draw joins the batch of the first draw with the same
+	/// batch key. Within a layer drawn back to front, only neighbouring draws with the same batch key are merged, so
+	/// blending order is kept
+	/// </summary>
+	class InstanceBatcher
+	{
+	public:
+		struct Statistics
+		{
+			uint32_t drawCount = 0;
+			uint32_t batchCount = 0;
+		};
+
+	private:
+		DrawKeySorter m_sorter;
+
+		// Sort order of the draws and the batch each of them joined
+		std::vector<uint32_t> m_order;
+		std::vector<uint32_t> m_drawBatches;
+		// Batch of every batch key within the current pass and layer
+		std::unordered_map<uint64_t, uint32_t> m_openBatches;
+
+		Statistics m_statistics;
+
+	public:
+		/// <param name="jobSystem">Job system the draws are sorted on, null to sort on the calling thread. Must outlive the batcher</param>
+		explicit InstanceBatcher(JobSystem* jobSystem = nullptr);
+
+		/// <summary>
+		/// Groups the draws into batches
+		/// </summary>
+		/// <param name="sortKeys">Sort key of every draw, see <see cref="EncodeDrawSortKey"/></param>
+		/// <param name="batchKeys">Identity of every draw's geometry, pipeline and material. Draws with equal keys must be interchangeable</param>
+		/// <param name="batches">Receives the batches in draw order</param>
+		/// <param name="instanceOrder">Receives the draw indices of every batch's instances, batch after batch</param>
+		/// <exception cref="std::invalid_argument">Thrown if the key arrays differ in size</exception>
+		void Build(const std::vector<uint64_t>& sortKeys, const std::vector<uint64_t>& batchKeys, std::vector<InstanceBatch>& batches, std::vector<uint32_t>& instanceOrder);
+
+		/// <summary>
+		/// Gets the draw and batch count of the last build
+		/// </summary>
+		const Statistics& GetStatistics() const;
+
+		InstanceBatcher(const InstanceBatcher&) = delete;
+		InstanceBatcher& operator=(const InstanceBatcher&) = delete;
+	};
+}
+
+#endif // !ULTREALITY_RENDERING_COMMON_INSTANCE_BATCHER_H
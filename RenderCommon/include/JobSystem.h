@@ -0,0 +1,141 @@
+#ifndef ULTREALITY_RENDERING_COMMON_JOB_SYSTEM_H
+#define ULTREALITY_RENDERING_COMMON_JOB_SYSTEM_H
+
+#include <stdint.h>
+#include <atomic>
+#include <deque>
+#include <mutex>
+#include <thread>
+#include <vector>
+#include <memory>
+#include <exception>
+#include <functional>
+#include <condition_variable>
+
+namespace UltReality::Rendering::Common
+{
+	class JobSystem;
+
+	/// <summary>
+	/// Counts the outstanding jobs of a group so a thread can wait for all of them. Captures the first exception
+	/// thrown by a job of the group and rethrows it from <see cref="JobSystem::Wait"/>
+	/// </summary>
+	class JobCounter
+	{
+		friend class JobSystem;
+
+	private:
+		std::atomic<uint32_t> m_pending{ 0 };
+
+		std::mutex m_exceptionMutex;
+		std::exception_ptr m_exception;
+
+	public:
+		bool IsDone() const { return m_pending.load(std::memory_order_acquire) == 0; }
+	};
+
+	/// <summary>
+	/// Work-stealing job scheduler. Every worker owns a queue it pushes to and pops from in LIFO order, idle workers
+	/// steal the oldest job from another worker's queue. Worker 0 is the thread that created the system (the render
+	/// thread), which executes jobs while it waits on a <see cref="JobCounter"/>. Other threads may submit and wait
+	/// too. Their jobs go to a shared external queue the workers steal from, and they never run jobs themselves, as
+	/// job bodies index per-worker resources by worker index
+	/// </summary>
+	class JobSystem
+	{
+	public:
+		/// <summary>
+		/// Job body. Receives the index of the worker running it, in [0, <see cref="GetWorkerCount"/>)
+		/// </summary>
+		using JobFunction = std::function<void(uint32_t workerIndex)>;
+
+		/// <summary>
+		/// Body of a <see cref="Dispatch"/> group. Receives the half-open range [first, last) and the worker index
+		/// </summary>
+		using RangeFunction = std::function<void(uint32_t first, uint32_t last, uint32_t workerIndex)>;
+
+		// Returned by <see cref="CurrentWorkerIndex"/> on threads that are neither a worker nor the owning thread
+		static constexpr uint32_t externalThreadIndex = UINT32_MAX;
+
+	private:
+		struct Job
+		{
+			JobFunction function;
+			JobCounter* counter;
+		};
+
+		struct WorkerQueue
+		{
+			std::mutex mutex;
+			std::deque<Job> jobs;
+		};
+
+		// One queue per worker, followed by the queue of jobs submitted by external threads
+		std::vector<std::unique_ptr<WorkerQueue>> m_queues;
+		std::vector<std::thread> m_threads;
+
+		// Thread that created the system, worker 0
+		std::thread::id m_ownerThread;
+
+		std::atomic<bool> m_running{ true };
+		std::atomic<uint32_t> m_queuedJobs{ 0 };
+
+		std::mutex m_sleepMutex;
+		std::condition_variable m_wakeCondition;
+
+		bool PopLocal(uint32_t workerIndex, Job& job);
+
+		bool Steal(uint32_t thiefIndex, Job& job);
+
+		bool TryRunJob(uint32_t workerIndex);
+
+		void WorkerLoop(uint32_t workerIndex);
+
+	public:
+		/// <summary>
+		/// Starts the worker threads
+		/// </summary>
+		/// <param name="threadCount">Number of background threads. 0 picks one less than the hardware thread count</param>
+		explicit JobSystem(uint32_t threadCount = 0);
+
+		/// <summary>
+		/// Runs every queued job to completion and joins the worker threads
+		/// </summary>
+		~JobSystem();
+
+		/// <summary>
+		/// Queues a job on the calling worker's queue, or on the external queue when called from another thread
+		/// </summary>
+		/// <param name="job">Job body</param>
+		/// <param name="counter">Optional counter that is incremented now and decremented when the job finishes</param>
+		void Submit(JobFunction job, JobCounter* counter = nullptr);
+
+		/// <summary>
+		/// Splits [0, <paramref name="count"/>) into groups of <paramref name="groupSize"/> and queues one job per group
+		/// </summary>
+		void Dispatch(uint32_t count, uint32_t groupSize, RangeFunction function, JobCounter& counter);
+
+		/// <summary>
+		/// Executes queued jobs on the calling thread until every job counted by <paramref name="counter"/> finished.
+		/// External threads block instead of executing jobs. Rethrows the first exception thrown by one of those jobs
+		/// </summary>
+		void Wait(JobCounter& counter);
+
+		/// <summary>
+		/// Gets the number of workers including the owning thread. Per-worker resources should be sized by this, jobs
+		/// never run on external threads
+		/// </summary>
+		uint32_t GetWorkerCount() const;
+
+		/// <summary>
+		/// Gets the worker index of the calling thread, 0 on the thread that created the system and
+		/// <see cref="externalThreadIndex"/> on threads that are not workers of this system
+		/// </summary>
+		uint32_t CurrentWorkerIndex() const;
+
+		JobSystem(const JobSystem&) = delete;
+		JobSystem& operator=(const JobSystem&) = delete;
+	};
+}
+
+#endif // !ULTREALITY_RENDERING_COMMON_JOB_SYSTEM_H
@@ -0,0 +1,85 @@
+#ifndef ULTREALITY_RENDERING_COMMON_LINEAR_RING_ALLOCATOR_H
+#define ULTREALITY_RENDERING_COMMON_LINEAR_RING_ALLOCATOR_H
+
+#include <stdint.h>
+#include <deque>
+
+namespace UltReality::Rendering::Common
+{
+	/// <summary>
+	/// Bump-pointer allocator over a fixed size ring of bytes. Allocations made during a frame are reclaimed
+	/// together once the fence value the frame was tagged with has been reached. Knows nothing about the memory it
+	/// manages, it only hands out offsets
+	/// </summary>
+	class LinearRingAllocator
+	{
+	public:
+		// Returned by <see cref="Allocate"/> when the request cannot be satisfied
+		static constexpr uint64_t invalidOffset = UINT64_MAX;
+
+	private:
+		struct FrameMarker
+		{
+			// Fence value that retires the frame
+			uint64_t fenceValue;
+			// Position of the tail when the frame was finished. Becomes the new head once the frame is retired
+			uint64_t tail;
+			// Bytes consumed by the frame, including alignment and wrap padding
+			uint64_t size;
+		};
+
+		uint64_t m_capacity;
+
+		// Oldest byte still in use by the GPU
+		uint64_t m_head = 0;
+		// Next byte to allocate from
+		uint64_t m_tail = 0;
+		// Bytes currently in use, needed to tell a full ring from an empty one when head == tail
+		uint64_t m_usedSize = 0;
+
+		// Bytes handed out since the last FinishFrame
+		uint64_t m_currentFrameSize = 0;
+		// Finished frames waiting on their fence, oldest first
+		std::deque<FrameMarker> m_frames;
+
+		// Number of allocations that did not fit in the ring
+		uint64_t m_overflowCount = 0;
+
+	public:
+		/// <summary>
+		/// Creates a ring allocator managing <paramref name="capacity"/> bytes
+		/// </summary>
+		explicit LinearRingAllocator(uint64_t capacity);
+
+		/// <summary>
+		/// Allocates <paramref name="size"/> bytes aligned to <paramref name="alignment"/>. Wraps to the start of
+		/// the ring when the end is reached and the start has been retired
+		/// </summary>
+		/// <param name="size">Number of bytes to allocate</param>
+		/// <param name="alignment">Required alignment of the returned offset. Must be a power of 2</param>
+		/// <returns>Offset of the allocation, or <see cref="invalidOffset"/> if the ring has no room for it</returns>
+		uint64_t Allocate(uint64_t size, uint64_t alignment);
+
+		/// <summary>
+		/// Tags every allocation made since the previous call with <paramref name="fenceValue"/>
+		/// </summary>
+		void FinishFrame(uint64_t fenceValue);
+
+		/// <summary>
+		/// Reclaims the allocations of every finished frame whose fence value is at or below <paramref name="completedFenceValue"/>
+		/// </summary>
+		void Retire(uint64_t completedFenceValue);
+
+		uint64_t GetCapacity() const;
+
+		uint64_t GetUsedSize() const;
+
+		uint64_t GetOverflowCount() const;
+
+		static uint64_t AlignUp(uint64_t value, uint64_t alignment);
+	};
+}
+
+#include <LinearRingAllocator.inl>
+
+#endif // !ULTREALITY_RENDERING_COMMON_LINEAR_RING_ALLOCATOR_H
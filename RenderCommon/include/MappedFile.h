@@ -0,0 +1,55 @@
+#ifndef ULTREALITY_RENDERING_COMMON_MAPPED_FILE_H
+#define ULTREALITY_RENDERING_COMMON_MAPPED_FILE_H
+
+#include <stdint.h>
+#include <stddef.h>
+#include <string>
+
+namespace UltReality::Rendering::Common
+{
+	/// <summary>
+	/// Read-only memory mapping of a whole file. Pages are only read from disk when they are first touched, so
+	/// mapping a file is cheap no matter its size
+	/// </summary>
+	class MappedFile
+	{
+	private:
+		const uint8_t* m_data = nullptr;
+		size_t m_size = 0;
+
+#if defined(_WIN_TARGET)
+		void* m_file = nullptr;
+		void* m_mapping = nullptr;
+#else
+		int m_file = -1;
+#endif
+
+		void Close();
+
+	public:
+		MappedFile() = default;
+
+		/// <summary>
+		/// Maps the file at <paramref name="path"/>
+		/// </summary>
+		/// <exception cref="std::runtime_error">Thrown if the file can not be opened or mapped</exception>
+		explicit MappedFile(const std::string& path);
+
+		~MappedFile();
+
+		MappedFile(MappedFile&& other) noexcept;
+		MappedFile& operator=(MappedFile&& other) noexcept;
+
+		MappedFile(const MappedFile&) = delete;
+		MappedFile& operator=(const MappedFile&) = delete;
+
+		/// <summary>
+		/// Gets the mapped bytes. Null for an empty file
+		/// </summary>
+		const uint8_t* GetData() const;
+
+		size_t GetSize() const;
+	};
+}
+
+#endif // !ULTREALITY_RENDERING_COMMON_MAPPED_FILE_H
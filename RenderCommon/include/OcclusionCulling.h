@@ -0,0 +1,165 @@
+#ifndef ULTREALITY_RENDERING_COMMON_OCCLUSION_CULLING_H
+#define ULTREALITY_RENDERING_COMMON_OCCLUSION_CULLING_H
+
+#include <stdint.h>
+#include <vector>
+
+#include <FrustumCulling.h>
+
+namespace UltReality::Rendering::Common
+{
+	class JobSystem;
+
+	/// <summary>
+	/// Occluder triangle after projection, in pixels of the depth buffer with depth in [0, 1]. Vertices are ordered so
+	/// the signed area is positive, a pixel center is covered when all three edge functions are at or above zero
+	/// </summary>
+	struct OccluderTriangle
+	{
+		float x[3];
+		float y[3];
+		float z[3];
+	};
+
+	/// <summary>
+	/// Rasterizes <paramref name="triangles"/> one pixel at a time into a depth buffer, keeping the nearest depth.
+	/// Reference the SIMD rasterizer of <see cref="OcclusionCuller"/> is validated against, both produce the same buffer
+	/// </summary>
+	/// <param name="triangles">Projected triangles</param>
+	/// <param name="width">Width of the depth buffer in pixels</param>
+	/// <param name="height">Height of the depth buffer in pixels</param>
+	/// <param name="depth">Row-major depth buffer of width * height texels, cleared by the caller</param>
+	void RasterizeOccludersReference(const std::vector<OccluderTriangle>& triangles, uint32_t width, uint32_t height, std::vector<float>& depth);
+
+	/// <summary>
+	/// Software occlusion culling. Low-poly occluders are rasterized into a coarse depth buffer split into screen tiles,
+	/// every tile is rasterized by its own job with SIMD, and a hierarchical-Z pyramid of the farthest depth is built
+	/// from the result. Occludee boxes are tested against the pyramid level where their screen rectangle spans at most
+	/// two texels per axis and are occluded when their nearest depth lies behind all of those texels
+	/// </summary>
+	class OcclusionCuller
+	{
+	public:
+		struct Statistics
+		{
+			uint32_t occluderTriangleCount = 0;
+			uint32_t testedCount = 0;
+			uint32_t occludedCount = 0;
+			// Wall time of the last rasterization, including the pyramid
+			float rasterMilliseconds = 0.0f;
+			// Wall time of the last occludee test
+			float testMilliseconds = 0.0f;
+		};
+
+		// Size of the screen tiles rasterized by one job, the depth buffer must be a multiple of it
+		static constexpr uint32_t tileWidth = 32;
+		static constexpr uint32_t tileHeight = 16;
+		static constexpr uint32_t defaultWidth = 256;
+		static constexpr uint32_t defaultHeight = 128;
+		// Default number of occludees a single job tests
+		static constexpr uint32_t defaultObjectsPerJob = 4096;
+
+	private:
+		JobSystem* m_jobSystem;
+		uint32_t m_width;
+		uint32_t m_height;
+		uint32_t m_tileColumns;
+		uint32_t m_tileRows;
+		uint32_t m_objectsPerJob;
+		CullingSimdPath m_simdPath;
+
+		float m_viewProjection[16] = {};
+		std::vector<OccluderTriangle> m_triangles;
+		// Indices of the triangles overlapping every tile
+		std::vector<std::vector<uint32_t>> m_tileBins;
+		// Level 0 is the depth buffer, every further level keeps the farthest depth of 2x2 texels of the one before
+		std::vector<std::vector<float>> m_hiZ;
+		std::vector<uint32_t> m_hiZWidths;
+		// Whether occluders were added since the last rasterization
+		bool m_dirty = true;
+
+		// Surviving indices of every chunk of the last test
+		std::vector<std::vector<uint32_t>> m_chunkVisible;
+
+		Statistics m_statistics;
+
+		void RasterizeTile(uint32_t tile);
+
+		void BuildHiZ();
+
+		bool IsBoxVisible(float centerX, float centerY, float centerZ, float extentX, float extentY, float extentZ) const;
+
+	public:
+		/// <summary>
+		/// Creates a culler using the widest instruction set the CPU supports
+		/// </summary>
+		/// <param name="jobSystem">Job system tiles and occludees are processed on, null to run on the calling thread. Must outlive the culler</param>
+		/// <param name="width">Width of the depth buffer, a multiple of <see cref="tileWidth"/></param>
+		/// <param name="height">Height of the depth buffer, a multiple of <see cref="tileHeight"/></param>
+		/// <param name="objectsPerJob">Occludees tested by one job</param>
+		/// <exception cref="std::invalid_argument">Thrown if the size is zero or not a multiple of the tile size</exception>
+		explicit OcclusionCuller(JobSystem* jobSystem = nullptr, uint32_t width = defaultWidth, uint32_t height = defaultHeight, uint32_t objectsPerJob = defaultObjectsPerJob);
+
+		/// <summary>
+		/// Drops the occluders of the previous frame and sets the camera of the next ones
+		/// </summary>
+		/// <param name="viewProjection">Row-major, row-vector view projection matrix with a [0, 1] depth range</param>
+		void BeginFrame(const float viewProjection[16]);
+
+		/// <summary>
+		/// Projects an occluder mesh and bins its triangles into the tiles they overlap. Triangles crossing the near
+		/// plane are dropped, which only lets more occludees through
+		/// </summary>
+		/// <param name="positions">World space positions, three floats per vertex</param>
+		/// <param name="vertexCount">Number of vertices</param>
+		/// <param name="indices">Triangle list indices</param>
+		/// <param name="indexCount">Number of indices, a multiple of three</param>
+		/// <exception cref="std::out_of_range">Thrown if an index exceeds the vertex count</exception>
+		void AddOccluder(const float* positions, uint32_t vertexCount, const uint32_t* indices, uint32_t indexCount);
+
+		/// <summary>
+		/// Rasterizes the occluders added since <see cref="BeginFrame"/> and builds the pyramid. Called by
+		/// <see cref="CullBoxes"/> when occluders changed
+		/// </summary>
+		void Rasterize();
+
+		/// <summary>
+		/// Removes the indices of occluded boxes from <paramref name="visible"/>, keeping the order of the others
+		/// </summary>
+		/// <param name="boxes">Boxes <paramref name="visible"/> indexes into</param>
+		/// <param name="visible">Indices surviving frustum culling, see <see cref="FrustumCuller::CullBoxes"/></param>
+		void CullBoxes(const BoundingBoxSoA& boxes, std::vector<uint32_t>& visible);
+
+		/// <summary>
+		/// Checks a single box spanning [<paramref name="min"/>, <paramref name="max"/>] against the pyramid
+		/// </summary>
+		bool IsBoxVisible(const float min[3], const float max[3]);
+
+		bool HasOccluders() const;
+
+		const std::vector<OccluderTriangle>& GetTriangles() const;
+
+		/// <summary>
+		/// Gets the rasterized depth buffer, row-major with <see cref="GetWidth"/> texels per row
+		/// </summary>
+		const std::vector<float>& GetDepthBuffer() const;
+
+		uint32_t GetWidth() const;
+		uint32_t GetHeight() const;
+
+		CullingSimdPath GetSimdPath() const;
+
+		/// <summary>
+		/// Forces an instruction set for the rasterizer, e.g. to compare the paths against the reference
+		/// </summary>
+		/// <exception cref="std::invalid_argument">Thrown if the CPU or the build does not support <paramref name="path"/></exception>
+		void SetSimdPath(CullingSimdPath path);
+
+		const Statistics& GetStatistics() const;
+
+		OcclusionCuller(const OcclusionCuller&) = delete;
+		OcclusionCuller& operator=(const OcclusionCuller&) = delete;
+	};
+}
+
+#endif // !ULTREALITY_RENDERING_COMMON_OCCLUSION_CULLING_H
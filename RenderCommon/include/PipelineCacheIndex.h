@@ -0,0 +1,112 @@
+#ifndef ULTREALITY_RENDERING_COMMON_PIPELINE_CACHE_INDEX_H
+#define ULTREALITY_RENDERING_COMMON_PIPELINE_CACHE_INDEX_H
+
+#include <stdint.h>
+#include <string>
+#include <vector>
+#include <unordered_map>
+
+namespace UltReality::Rendering::Common
+{
+	struct PipelineCacheIndexEntry
+	{
+		// Stable hash of the full pipeline description
+		uint64_t key = 0;
+		// Number of runs that requested the pipeline
+		uint32_t useCount = 0;
+		// Run in which the pipeline was last requested
+		uint32_t lastUsedRun = 0;
+	};
+
+	/// <summary>
+	/// Describes the contents of a persisted pipeline library. The index is only trusted when it was written for the
+	/// same device and driver (<paramref name="compatibilityHash"/>) and next to the same library blob
+	/// (<paramref name="libraryHash"/>), otherwise both are discarded and rebuilt.
+	///
+	/// File layout, all integers little endian:
+	///   uint32 magic, uint32 formatVersion, uint64 compatibilityHash, uint64 libraryHash, uint32 run, uint32 entryCount,
+	///   entryCount * { uint64 key, uint32 useCount, uint32 lastUsedRun }, uint64 checksum of everything before it
+	/// </summary>
+	class PipelineCacheIndex
+	{
+	public:
+		static constexpr uint32_t magic = 0x49505255; // "URPI"
+		static constexpr uint32_t formatVersion = 1;
+
+		enum class LoadResult : uint8_t
+		{
+			Loaded,
+			Missing,
+			Corrupt,
+			VersionMismatch,
+			CompatibilityMismatch,
+			LibraryMismatch
+		};
+
+	private:
+		uint64_t m_compatibilityHash = 0;
+		uint64_t m_libraryHash = 0;
+		// Incremented every time the index is loaded, tells pipelines requested this run from stale ones
+		uint32_t m_run = 0;
+
+		std::unordered_map<uint64_t, PipelineCacheIndexEntry> m_entries;
+
+	public:
+		PipelineCacheIndex() = default;
+
+		/// <summary>
+		/// Creates an empty index for the device and driver identified by <paramref name="compatibilityHash"/>
+		/// </summary>
+		explicit PipelineCacheIndex(uint64_t compatibilityHash);
+
+		/// <summary>
+		/// Records that the pipeline with <paramref name="key"/> was requested during this run
+		/// </summary>
+		/// <returns>True if the pipeline was already in the index</returns>
+		bool MarkUsed(uint64_t key);
+
+		bool Contains(uint64_t key) const;
+
+		void Clear();
+
+		/// <summary>
+		/// Encodes the index in its on-disk format
+		/// </summary>
+		std::vector<uint8_t> Serialize() const;
+
+		/// <summary>
+		/// Decodes an index written by <see cref="Serialize"/>. On anything but <see cref="LoadResult::Loaded"/> the
+		/// index is left empty for <paramref name="compatibilityHash"/>
+		/// </summary>
+		/// <param name="data">Encoded index</param>
+		/// <param name="size">Size of <paramref name="data"/> in bytes</param>
+		/// <param name="compatibilityHash">Device and driver the caller runs on</param>
+		/// <param name="libraryHash">Hash of the library blob found next to the index</param>
+		LoadResult Deserialize(const uint8_t* data, size_t size, uint64_t compatibilityHash, uint64_t libraryHash);
+
+		LoadResult LoadFromFile(const std::string& path, uint64_t compatibilityHash, uint64_t libraryHash);
+
+		/// <summary>
+		/// Writes the index to a temporary file and renames it over <paramref name="path"/>, so a crash never leaves a torn index
+		/// </summary>
+		/// <returns>False if the file could not be written</returns>
+		bool SaveToFile(const std::string& path) const;
+
+		void SetLibraryHash(uint64_t libraryHash);
+
+		uint64_t GetCompatibilityHash() const;
+
+		uint64_t GetLibraryHash() const;
+
+		uint32_t GetRun() const;
+
+		size_t GetEntryCount() const;
+
+		/// <summary>
+		/// Gets the entries sorted by key, the order they are serialized in
+		/// </summary>
+		std::vector<PipelineCacheIndexEntry> GetEntries() const;
+	};
+}
+
+#endif // !ULTREALITY_RENDERING_COMMON_PIPELINE_CACHE_INDEX_H
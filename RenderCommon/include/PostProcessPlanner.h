@@ -0,0 +1,176 @@
+#ifndef ULTREALITY_RENDERING_COMMON_POST_PROCESS_PLANNER_H
+#define ULTREALITY_RENDERING_COMMON_POST_PROCESS_PLANNER_H
+
+#include <stdint.h>
+#include <vector>
+
+namespace UltReality::Rendering::Common
+{
+	/// <summary>
+	/// Effects of the post-processing chain, one bit each. Enabled effects are applied in the order of their bits
+	/// </summary>
+	enum class PostEffect : uint32_t
+	{
+		None = 0,
+		// Splits the color channels towards the screen edges. Reads around its pixel
+		ChromaticAberration = 1 << 0,
+		// Blends in the blurred bloom pyramid
+		Bloom = 1 << 1,
+		// Scales by the exposure adapted to the average scene luminance
+		AutoExposure = 1 << 2,
+		// Maps HDR color to display range
+		Tonemap = 1 << 3,
+		// Saturation, contrast and color filter
+		ColorGrading = 1 << 4,
+		Vignette = 1 << 5,
+		// Unsharp mask. Reads around its pixel
+		Sharpen = 1 << 6,
+		FilmGrain = 1 << 7,
+
+		All = (1 << 8) - 1
+	};
+
+	constexpr uint32_t postEffectCount = 8;
+
+	constexpr PostEffect operator|(PostEffect lhs, PostEffect rhs)
+	{
+		return static_cast<PostEffect>(static_cast<uint32_t>(lhs) | static_cast<uint32_t>(rhs));
+	}
+
+	constexpr PostEffect operator&(PostEffect lhs, PostEffect rhs)
+	{
+		return static_cast<PostEffect>(static_cast<uint32_t>(lhs) & static_cast<uint32_t>(rhs));
+	}
+
+	constexpr PostEffect& operator|=(PostEffect& lhs, PostEffect rhs)
+	{
+		lhs = lhs | rhs;
+		return lhs;
+	}
+
+	/// <summary>
+	/// True for effects that read the pixels around their own. They need their input in memory, so they can only be
+	/// the first effect of a fused pass
+	/// </summary>
+	constexpr bool PostEffectReadsNeighbors(PostEffect effect)
+	{
+		return effect == PostEffect::ChromaticAberration || effect == PostEffect::Sharpen;
+	}
+
+	/// <summary>
+	/// Effects and parameters of the post-processing chain
+	/// </summary>
+	struct PostProcessConfig
+	{
+		PostEffect effects = PostEffect::None;
+
+		// Levels of the bloom pyramid below full resolution, each half the size of the one above
+		uint32_t bloomLevels = 6;
+		// Weight of the bloom in the final color
+		float bloomIntensity = 0.04f;
+		// Auto exposure averages the first pyramid level whose larger edge is at most this many pixels
+		uint32_t exposureReduceSize = 64;
+		// Exposure offset in stops, applied on top of the adapted exposure
+		float exposureCompensation = 0.0f;
+		// Rate per second at which the exposure adapts to the scene luminance
+		float exposureAdaptationRate = 1.5f;
+		float saturation = 1.0f;
+		float contrast = 1.0f;
+		float colorFilter[3] = { 1.0f, 1.0f, 1.0f };
+		float vignetteStrength = 0.3f;
+		// Offset of the red and blue channels at the screen edges, in UV units
+		float chromaticAberration = 0.003f;
+		float sharpenStrength = 0.3f;
+		float filmGrainStrength = 0.03f;
+	};
+
+	/// <summary>
+	/// Image a post-processing pass reads or writes
+	/// </summary>
+	struct PostProcessTarget
+	{
+		enum class Kind : uint8_t
+		{
+			// HDR color the scene was rendered into
+			SceneColor,
+			// Level <see cref="index"/> of the shared downsample pyramid, starting at 1 for half resolution
+			Pyramid,
+			// Bloom at the size of pyramid level <see cref="index"/>, the level plus the blurred bloom below it
+			Bloom,
+			// Full resolution target <see cref="index"/> between two fused passes
+			Intermediate,
+			// Adapted exposure, a single texel kept across frames
+			Exposure,
+			// Display target the chain ends in
+			Output
+		};
+
+		Kind kind = Kind::SceneColor;
+		uint32_t index = 0;
+	};
+
+	struct PostProcessPass
+	{
+		enum class Type : uint8_t
+		{
+			// Halves the input into the next pyramid level
+			Downsample,
+			// Adds the filtered bloom below to a pyramid level, building the bloom from the bottom up
+			Upsample,
+			// Averages the luminance of a pyramid level and adapts the exposure towards it
+			Exposure,
+			// Applies one or more per-pixel effects in a single pass over the image
+			Fused
+		};
+
+		Type type = Type::Fused;
+		// Effects of a fused pass, applied in bit order
+		PostEffect effects = PostEffect::None;
+		PostProcessTarget input;
+		PostProcessTarget output;
+		// Size of the output in pixels
+		uint32_t width = 0;
+		uint32_t height = 0;
+	};
+
+	/// <summary>
+	/// Passes a <see cref="PostProcessConfig"/> is executed with
+	/// </summary>
+	struct PostProcessPlan
+	{
+		std::vector<PostProcessPass> passes;
+		// Levels of the downsample pyramid shared by bloom and auto exposure
+		uint32_t pyramidLevels = 0;
+		// Levels the bloom spans, 0 without bloom
+		uint32_t bloomLevels = 0;
+		// Pyramid level auto exposure averages, 0 without auto exposure
+		uint32_t exposureLevel = 0;
+		// Target fused passes blend the bloom from
+		PostProcessTarget bloomSource;
+		// Full resolution targets needed between fused passes
+		uint32_t intermediateCount = 0;
+		// Passes over the full image, the fused ones
+		uint32_t fullResolutionPasses = 0;
+		// Estimated bytes every pass reads and writes, and what the same effects would cost with one pass each
+		uint64_t bandwidthBytes = 0;
+		uint64_t unfusedBandwidthBytes = 0;
+	};
+
+	// Bytes per pixel of the HDR targets and of the display output the estimates assume
+	constexpr uint32_t postProcessColorBytes = 8;
+	constexpr uint32_t postProcessOutputBytes = 4;
+
+	/// <summary>
+	/// Plans the passes of a post-processing chain. Bloom and auto exposure share one downsample pyramid. Enabled
+	/// per-pixel effects are fused into as few full resolution passes as possible, a new pass only starting at an
+	/// effect that reads neighboring pixels. The last pass writes the output
+	/// </summary>
+	/// <param name="config">Enabled effects and pyramid sizes</param>
+	/// <param name="width">Width of the scene color and the output</param>
+	/// <param name="height">Height of the scene color and the output</param>
+	/// <param name="plan">Receives the passes in execution order</param>
+	/// <exception cref="std::invalid_argument">Thrown if the size is zero or an enabled effect has invalid pyramid settings</exception>
+	void BuildPostProcessPlan(const PostProcessConfig& config, uint32_t width, uint32_t height, PostProcessPlan& plan);
+}
+
+#endif // !ULTREALITY_RENDERING_COMMON_POST_PROCESS_PLANNER_H
@@ -0,0 +1,109 @@
+#ifndef ULTREALITY_RENDERING_COMMON_QUEUE_SCHEDULER_H
+#define ULTREALITY_RENDERING_COMMON_QUEUE_SCHEDULER_H
+
+#include <stdint.h>
+#include <initializer_list>
+#include <vector>
+
+namespace UltReality::Rendering::Common
+{
+	enum class QueueType : uint8_t
+	{
+		Graphics = 0,
+		Compute,
+		Copy,
+
+		Count
+	};
+
+	constexpr uint32_t queueTypeCount = static_cast<uint32_t>(QueueType::Count);
+
+	/// <summary>
+	/// Batch of command lists submitted to one queue, together with the earlier submissions whose results it consumes
+	/// </summary>
+	struct QueueSubmission
+	{
+		QueueType queue = QueueType::Graphics;
+		// Indices of earlier submissions this one has to wait for. Submissions on the same queue are already ordered
+		std::vector<uint32_t> dependencies;
+	};
+
+	/// <summary>
+	/// Cross-queue synchronization derived for one submission
+	/// </summary>
+	struct ScheduledSubmission
+	{
+		// Submissions on other queues whose signal the queue waits for before executing this one
+		std::vector<uint32_t> waits;
+		// True if a later wait refers to this submission, so its queue has to signal once it completes
+		bool signal = false;
+	};
+
+	struct QueueSchedule
+	{
+		// One entry per submission, in submission order
+		std::vector<ScheduledSubmission> submissions;
+		// Submissions the join queue waits for after the batch, so one fence on it covers every queue
+		std::vector<uint32_t> joinWaits;
+	};
+
+	/// <summary>
+	/// Outcome of replaying a schedule on simulated queues
+	/// </summary>
+	struct QueueSimulationResult
+	{
+		// True if every queue ran all of its submissions
+		bool completed = false;
+		// True if every dependency finished before the submission that consumes it started
+		bool dependenciesSatisfied = false;
+		// Number of waits whose target was already guaranteed complete by the queue's other waits and its own order
+		uint32_t redundantWaits = 0;
+	};
+
+	/// <summary>
+	/// Turns the dependencies between submissions to several queues into the minimal set of cross-queue waits and
+	/// signals. Every queue keeps a vector clock of the last submission of each queue it is known to have waited for,
+	/// directly or through the queues it waited on, and a dependency already covered by that clock adds no wait.
+	/// Submissions execute in the order they were added and may only depend on earlier ones, which rules out deadlocks
+	/// </summary>
+	class QueueScheduler
+	{
+	private:
+		std::vector<QueueSubmission> m_submissions;
+
+	public:
+		QueueScheduler() = default;
+
+		/// <summary>
+		/// Adds a submission
+		/// </summary>
+		/// <param name="queue">Queue the submission executes on</param>
+		/// <param name="dependencies">Earlier submissions whose results it consumes</param>
+		/// <returns>Index of the submission, to be used as a dependency of later ones</returns>
+		/// <exception cref="std::invalid_argument">Thrown if a dependency is not an earlier submission</exception>
+		uint32_t Add(QueueType queue, std::initializer_list<uint32_t> dependencies = {});
+
+		/// <inheritdoc cref="Add(QueueType, std::initializer_list{uint32_t})"/>
+		uint32_t Add(QueueType queue, const std::vector<uint32_t>& dependencies);
+
+		/// <summary>
+		/// Derives the waits and signals of the added submissions
+		/// </summary>
+		/// <param name="joinQueue">Queue that waits for the last submission of every other queue after the batch</param>
+		QueueSchedule Resolve(QueueType joinQueue = QueueType::Graphics) const;
+
+		/// <summary>
+		/// Replays <paramref name="schedule"/> on one simulated timeline per queue. Each queue runs its submissions in
+		/// order and blocks on waits whose target has not run yet
+		/// </summary>
+		static QueueSimulationResult Simulate(const std::vector<QueueSubmission>& submissions, const QueueSchedule& schedule);
+
+		const std::vector<QueueSubmission>& GetSubmissions() const;
+
+		uint32_t GetSubmissionCount() const;
+
+		void Reset();
+	};
+}
+
+#endif // !ULTREALITY_RENDERING_COMMON_QUEUE_SCHEDULER_H
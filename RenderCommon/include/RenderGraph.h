@@ -0,0 +1,247 @@
+#ifndef ULTREALITY_RENDERING_COMMON_RENDER_GRAPH_H
+#define ULTREALITY_RENDERING_COMMON_RENDER_GRAPH_H
+
+#include <stdint.h>
+#include <string>
+#include <vector>
+
+#include <ResourceState.h>
+
+namespace UltReality::Rendering::Common
+{
+	using RenderGraphResource = uint32_t;
+	constexpr RenderGraphResource invalidRenderGraphResource = UINT32_MAX;
+
+	struct RenderGraphBarrier
+	{
+		enum class Type : uint8_t
+		{
+			// State change of a single resource
+			Transition,
+			// Memory of aliasBefore is handed over to resource
+			Aliasing,
+			// Orders two unordered access passes on the same resource
+			UnorderedAccess
+		};
+
+		// Transitions whose producer and consumer are separated by other passes are split, so the GPU can
+		// overlap the transition with the passes in between
+		enum class Split : uint8_t
+		{
+			None,
+			// Starts the transition right after the producing pass
+			Begin,
+			// Completes the transition right before the consuming pass
+			End
+		};
+
+		Type type = Type::Transition;
+		Split split = Split::None;
+		RenderGraphResource resource = invalidRenderGraphResource;
+		// Previous occupant of the memory, only used by aliasing barriers. May be invalid
+		RenderGraphResource aliasBefore = invalidRenderGraphResource;
+		ResourceState stateBefore = ResourceState::Common;
+		ResourceState stateAfter = ResourceState::Common;
+	};
+
+	struct RenderGraphCompiledPass
+	{
+		// Index of the pass in declaration order
+		uint32_t passIndex = 0;
+		// Barriers to issue as one batch before the pass executes. May include split begins of later passes
+		std::vector<RenderGraphBarrier> barriers;
+	};
+
+	struct RenderGraphTransientPlacement
+	{
+		RenderGraphResource resource = invalidRenderGraphResource;
+		// Placement inside the transient memory block
+		uint64_t offset = 0;
+		uint64_t size = 0;
+		// First and last position in the compiled pass order that use the resource
+		uint32_t firstUse = 0;
+		uint32_t lastUse = 0;
+		// State the resource has to be created in
+		ResourceState initialState = ResourceState::Common;
+	};
+
+	/// <summary>
+	/// Execution plan produced by <see cref="RenderGraph::Compile"/>
+	/// </summary>
+	struct CompiledRenderGraph
+	{
+		// Surviving passes in execution order, each with the barrier batch that precedes it
+		std::vector<RenderGraphCompiledPass> passes;
+		// Passes removed because none of their results are consumed
+		std::vector<uint32_t> culledPasses;
+		// Memory placement of every transient resource used by a surviving pass
+		std::vector<RenderGraphTransientPlacement> transients;
+		// Barriers returning imported resources to their final state
+		std::vector<RenderGraphBarrier> finalBarriers;
+
+		// Transient memory needed if every transient got its own allocation
+		uint64_t transientMemoryUnaliased = 0;
+		// Transient memory needed once non overlapping lifetimes share memory
+		uint64_t transientMemoryAliased = 0;
+
+		uint32_t barrierCount = 0;
+		uint32_t barrierBatchCount = 0;
+	};
+
+	/// <summary>
+	/// Backend neutral frame graph. Passes declare the resources they read and write, and <see cref="Compile"/>
+	/// culls passes whose output is never consumed, derives the batched barriers between passes and aliases the
+	/// memory of transient resources whose lifetimes do not overlap. Passes run in declaration order, so every
+	/// dependency has to point at an earlier pass
+	/// </summary>
+	class RenderGraph
+	{
+	private:
+		struct ResourceNode
+		{
+			std::string name;
+			bool imported;
+			// Imported resources are in initialState before the graph and are returned to finalState after it
+			ResourceState initialState;
+			ResourceState finalState;
+			// Memory requirements of transient resources
+			uint64_t size;
+			uint64_t alignment;
+		};
+
+		struct ResourceUse
+		{
+			RenderGraphResource resource;
+			ResourceState state;
+			bool write;
+		};
+
+		struct PassNode
+		{
+			std::string name;
+			bool hasSideEffects;
+			std::vector<ResourceUse> uses;
+		};
+
+		std::vector<ResourceNode> m_resources;
+		std::vector<PassNode> m_passes;
+
+		CompiledRenderGraph m_compiled;
+
+		void CullPasses(std::vector<uint32_t>& order);
+
+		void PlaceTransients(const std::vector<uint32_t>& order);
+
+		void BuildBarriers(const std::vector<uint32_t>& order);
+
+		ResourceState MergedPassState(uint32_t pass, RenderGraphResource resource, bool& writes) const;
+
+	public:
+		/// <summary>
+		/// Registers a resource owned outside the graph, such as the back buffer
+		/// </summary>
+		/// <param name="name">Debug name</param>
+		/// <param name="initialState">State the resource is in when the graph starts</param>
+		/// <param name="finalState">State the resource must be in when the graph ends</param>
+		RenderGraphResource ImportResource(const std::string& name, ResourceState initialState, ResourceState finalState);
+
+		/// <summary>
+		/// Declares a resource that only lives for the duration of the graph and may share memory with other transients
+		/// </summary>
+		/// <param name="name">Debug name</param>
+		/// <param name="size">Bytes of memory the resource needs</param>
+		/// <param name="alignment">Placement alignment of the resource</param>
+		RenderGraphResource CreateTransient(const std::string& name, uint64_t size, uint64_t alignment);
+
+		/// <summary>
+		/// Adds a pass. Passes execute in the order they are added
+		/// </summary>
+		/// <param name="name">Debug name</param>
+		/// <param name="hasSideEffects">Keeps the pass even if nothing consumes its output</param>
+		/// <returns>Index of the pass</returns>
+		uint32_t AddPass(const std::string& name, bool hasSideEffects = false);
+
+		/// <summary>
+		/// Declares that <paramref name="pass"/> reads <paramref name="resource"/> in <paramref name="state"/>
+		/// </summary>
+		void Read(uint32_t pass, RenderGraphResource resource, ResourceState state);
+
+		/// <summary>
+		/// Declares that <paramref name="pass"/> writes <paramref name="resource"/> in <paramref name="state"/>
+		/// </summary>
+		void Write(uint32_t pass, RenderGraphResource resource, ResourceState state);
+
+		/// <summary>
+		/// Compiles the declared passes into an execution plan
+		/// </summary>
+		const CompiledRenderGraph& Compile();
+
+		/// <summary>
+		/// Removes every pass and resource so the graph can be rebuilt for the next frame
+		/// </summary>
+		void Reset();
+
+		const CompiledRenderGraph& GetCompiled() const;
+
+		const std::string& GetPassName(uint32_t pass) const;
+
+		const std::string& GetResourceName(RenderGraphResource resource) const;
+
+		bool IsImported(RenderGraphResource resource) const;
+
+		uint32_t GetPassCount() const;
+
+		uint32_t GetResourceCount() const;
+	};
+
+	/// <summary>
+	/// Remembers which resource last occupied each range of a transient memory block across frames. The compiled
+	/// plan only orders transients against earlier occupants of the same graph, so a backend that keeps its memory
+	/// between frames uses this to order the first user of a range against the last user of an earlier frame.
+	/// Ranges are kept disjoint: a new occupant replaces the parts of older ones it overlaps
+	/// </summary>
+	class TransientMemoryHistory
+	{
+	public:
+		static constexpr uint64_t noOccupant = 0;
+		// Returned when more than one earlier occupant overlaps a range
+		static constexpr uint64_t severalOccupants = UINT64_MAX;
+
+	private:
+		struct Range
+		{
+			uint64_t begin;
+			uint64_t end;
+			uint64_t occupant;
+		};
+
+		// Sorted by begin
+		std::vector<Range> m_ranges;
+		std::vector<Range> m_scratch;
+
+	public:
+		/// <summary>
+		/// Records <paramref name="occupant"/> as the last user of a range, replacing the older occupants there
+		/// </summary>
+		/// <param name="offset">Start of the range in the memory block</param>
+		/// <param name="size">Bytes in the range</param>
+		/// <param name="occupant">Backend id of the resource, neither <see cref="noOccupant"/> nor <see cref="severalOccupants"/></param>
+		void Occupy(uint64_t offset, uint64_t size, uint64_t occupant);
+
+		/// <summary>
+		/// Finds the earlier occupant of a range that <paramref name="occupant"/> takes over
+		/// </summary>
+		/// <returns>The one other occupant overlapping the range, <see cref="noOccupant"/> if the range was unused or only
+		/// used by <paramref name="occupant"/> itself, or <see cref="severalOccupants"/></returns>
+		uint64_t FindPreviousOccupant(uint64_t offset, uint64_t size, uint64_t occupant) const;
+
+		/// <summary>
+		/// Forgets every occupant, for when the memory block is replaced
+		/// </summary>
+		void Clear();
+
+		uint32_t GetRangeCount() const;
+	};
+}
+
+#endif // !ULTREALITY_RENDERING_COMMON_RENDER_GRAPH_H
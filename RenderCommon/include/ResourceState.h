@@ -0,0 +1,72 @@
+#ifndef ULTREALITY_RENDERING_COMMON_RESOURCE_STATE_H
+#define ULTREALITY_RENDERING_COMMON_RESOURCE_STATE_H
+
+#include <stdint.h>
+
+namespace UltReality::Rendering::Common
+{
+	/// <summary>
+	/// Backend neutral GPU resource usage states. Read states can be combined, write states are exclusive.
+	/// Values mirror the meaning of the matching D3D12_RESOURCE_STATES bits
+	/// </summary>
+	enum class ResourceState : uint32_t
+	{
+		Common = 0,
+		Present = Common,
+		VertexAndConstantBuffer = 1 << 0,
+		IndexBuffer = 1 << 1,
+		RenderTarget = 1 << 2,
+		UnorderedAccess = 1 << 3,
+		DepthWrite = 1 << 4,
+		DepthRead = 1 << 5,
+		NonPixelShaderResource = 1 << 6,
+		PixelShaderResource = 1 << 7,
+		IndirectArgument = 1 << 8,
+		CopyDest = 1 << 9,
+		CopySource = 1 << 10,
+		ResolveDest = 1 << 11,
+		ResolveSource = 1 << 12,
+
+		ShaderResource = NonPixelShaderResource | PixelShaderResource,
+		WriteMask = RenderTarget | UnorderedAccess | DepthWrite | CopyDest | ResolveDest
+	};
+
+	constexpr ResourceState operator|(ResourceState lhs, ResourceState rhs)
+	{
+		return static_cast<ResourceState>(static_cast<uint32_t>(lhs) | static_cast<uint32_t>(rhs));
+	}
+
+	constexpr ResourceState operator&(ResourceState lhs, ResourceState rhs)
+	{
+		return static_cast<ResourceState>(static_cast<uint32_t>(lhs) & static_cast<uint32_t>(rhs));
+	}
+
+	constexpr ResourceState& operator|=(ResourceState& lhs, ResourceState rhs)
+	{
+		lhs = lhs | rhs;
+		return lhs;
+	}
+
+	/// <summary>
+	/// True when <paramref name="state"/> only contains read states. <see cref="ResourceState::Common"/> is not
+	/// considered a read state since it has to be transitioned to exactly
+	/// </summary>
+	constexpr bool IsReadOnlyState(ResourceState state)
+	{
+		return state != ResourceState::Common && (state & ResourceState::WriteMask) == ResourceState::Common;
+	}
+
+	/// <summary>
+	/// True when a resource in <paramref name="current"/> can be used as <paramref name="required"/> without a transition
+	/// </summary>
+	constexpr bool StateSatisfies(ResourceState current, ResourceState required)
+	{
+		if (current == required)
+			return true;
+
+		// A combined read state covers every subset of itself
+		return IsReadOnlyState(current) && IsReadOnlyState(required) && (current & required) == required;
+	}
+}
+
+#endif // !ULTREALITY_RENDERING_COMMON_RESOURCE_STATE_H
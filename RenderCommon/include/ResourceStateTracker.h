@@ -0,0 +1,168 @@
+#ifndef ULTREALITY_RENDERING_COMMON_RESOURCE_STATE_TRACKER_H
+#define ULTREALITY_RENDERING_COMMON_RESOURCE_STATE_TRACKER_H
+
+#include <stdint.h>
+#include <mutex>
+#include <unordered_map>
+#include <vector>
+
+#include <ResourceState.h>
+
+namespace UltReality::Rendering::Common
+{
+	// Opaque key of a tracked resource. Backends use the address of their resource object
+	using TrackedResource = uint64_t;
+
+	struct TrackedBarrier
+	{
+		enum class Type : uint8_t
+		{
+			Transition,
+			UnorderedAccess
+		};
+
+		enum class Split : uint8_t
+		{
+			None,
+			Begin,
+			End
+		};
+
+		Type type = Type::Transition;
+		Split split = Split::None;
+		TrackedResource resource = 0;
+		ResourceState stateBefore = ResourceState::Common;
+		ResourceState stateAfter = ResourceState::Common;
+	};
+
+	/// <summary>
+	/// Committed state of every resource as of the last command list submitted to the queue.
+	/// Command lists only learn the state of a resource when they are submitted, so this table is updated in submission order
+	/// </summary>
+	class ResourceStateTable
+	{
+	private:
+		std::unordered_map<TrackedResource, ResourceState> m_states;
+		mutable std::mutex m_mutex;
+
+	public:
+		/// <summary>
+		/// Starts tracking <paramref name="resource"/>, which is currently in <paramref name="state"/>
+		/// </summary>
+		void Register(TrackedResource resource, ResourceState state);
+
+		/// <summary>
+		/// Stops tracking <paramref name="resource"/>. Call when the resource is released
+		/// </summary>
+		void Unregister(TrackedResource resource);
+
+		/// <summary>
+		/// Gets the committed state of <paramref name="resource"/>. Throws if the resource is not registered
+		/// </summary>
+		ResourceState Get(TrackedResource resource) const;
+
+		void Set(TrackedResource resource, ResourceState state);
+
+		bool IsRegistered(TrackedResource resource) const;
+
+		size_t GetCount() const;
+	};
+
+	/// <summary>
+	/// Tracks resource states within a single command list. Barriers are queued and handed out as one batch by <see cref="Flush"/>,
+	/// transitions to a state the resource is already in are dropped, and queued transitions of the same resource are merged.
+	/// The first use of a resource is left pending, since only the <see cref="ResourceStateTable"/> knows its state at
+	/// submission time; <see cref="ResolvePending"/> produces the fix-up barriers to record ahead of the list
+	/// </summary>
+	class ResourceStateTracker
+	{
+	private:
+		static constexpr size_t s_notQueued = SIZE_MAX;
+
+		struct LocalState
+		{
+			// State the list expects the resource to be in when it starts executing
+			ResourceState firstState;
+			// State of the resource after the commands recorded so far
+			ResourceState currentState;
+			// True while the list has not recorded a barrier on the resource, the first state can still be widened
+			bool pending;
+			// Index of the unflushed transition of the resource in the queue
+			size_t queuedIndex;
+			// Split transition begun by <see cref="BeginTransition"/> that has not been ended yet
+			bool splitInFlight;
+			ResourceState splitBefore;
+		};
+
+		std::unordered_map<TrackedResource, LocalState> m_local;
+		// Resources in the order they were first used, so fix-up barriers come out in a stable order
+		std::vector<TrackedResource> m_useOrder;
+		std::vector<TrackedBarrier> m_queued;
+
+		uint64_t m_droppedCount = 0;
+		uint64_t m_mergedCount = 0;
+		uint64_t m_splitCount = 0;
+
+		void QueueTransition(TrackedResource resource, LocalState& local, ResourceState state);
+
+		void EndSplit(TrackedResource resource, LocalState& local);
+
+	public:
+		/// <summary>
+		/// Makes <paramref name="resource"/> usable in <paramref name="state"/> by the next commands recorded
+		/// </summary>
+		void Transition(TrackedResource resource, ResourceState state);
+
+		/// <summary>
+		/// Starts transitioning <paramref name="resource"/> to <paramref name="state"/> without waiting for it. The transition
+		/// completes at the next <see cref="Transition"/> or <see cref="EndTransition"/> of the resource, so work recorded in
+		/// between overlaps it. Falls back to a regular transition when the current state is not known yet
+		/// </summary>
+		void BeginTransition(TrackedResource resource, ResourceState state);
+
+		/// <summary>
+		/// Completes a transition started with <see cref="BeginTransition"/>
+		/// </summary>
+		void EndTransition(TrackedResource resource);
+
+		/// <summary>
+		/// Orders unordered access of <paramref name="resource"/> before the next commands
+		/// </summary>
+		void UAVBarrier(TrackedResource resource);
+
+		/// <summary>
+		/// Moves every queued barrier to <paramref name="barriers"/>. Call right before recording work that depends on them
+		/// </summary>
+		/// <returns>Number of barriers appended</returns>
+		uint32_t Flush(std::vector<TrackedBarrier>& barriers);
+
+		/// <summary>
+		/// Appends the barriers that bring every resource from its committed state to the state the list expects at its start
+		/// </summary>
+		/// <returns>Number of barriers appended</returns>
+		uint32_t ResolvePending(const ResourceStateTable& table, std::vector<TrackedBarrier>& barriers) const;
+
+		/// <summary>
+		/// Writes the state every resource is left in to <paramref name="table"/>. Call in submission order
+		/// </summary>
+		void Commit(ResourceStateTable& table) const;
+
+		/// <summary>
+		/// Forgets every resource so the tracker can be used for a new command list
+		/// </summary>
+		void Reset();
+
+		bool HasQueuedBarriers() const;
+
+		// Transitions dropped because the resource already was in the requested state
+		uint64_t GetDroppedCount() const;
+
+		// Transitions folded into an already queued transition of the same resource
+		uint64_t GetMergedCount() const;
+
+		// Transitions issued as split begin/end pairs
+		uint64_t GetSplitCount() const;
+	};
+}
+
+#endif // !ULTREALITY_RENDERING_COMMON_RESOURCE_STATE_TRACKER_H
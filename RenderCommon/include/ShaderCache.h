@@ -0,0 +1,156 @@
+#ifndef ULTREALITY_RENDERING_COMMON_SHADER_CACHE_H
+#define ULTREALITY_RENDERING_COMMON_SHADER_CACHE_H
+
+#include <stdint.h>
+#include <stddef.h>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <vector>
+#include <unordered_map>
+
+#include <JobSystem.h>
+#include <MappedFile.h>
+#include <ShaderCompiler.h>
+
+namespace UltReality::Rendering::Common
+{
+	/// <summary>
+	/// View of compiled shader bytecode owned by a <see cref="ShaderCache"/>. Valid as long as the cache
+	/// </summary>
+	struct ShaderBlob
+	{
+		const uint8_t* data = nullptr;
+		size_t size = 0;
+
+		explicit operator bool() const { return data != nullptr; }
+	};
+
+	struct ShaderCompileResult
+	{
+		// Cache key of the request, 0 if its source could not be read
+		uint64_t key = 0;
+		// Empty if compilation failed
+		ShaderBlob blob;
+		// True if the bytecode came from the cache
+		bool cacheHit = false;
+		// Compiler errors and warnings, or why the request failed
+		std::string messages;
+	};
+
+	/// <summary>
+	/// Content addressed cache of compiled shaders. A shader's key hashes the compiler version, entry point, target,
+	/// defines, arguments and the contents of its source and every file it transitively includes, so editing any of
+	/// them produces a new key instead of a stale hit.
+	///
+	/// Every blob is stored as its own file named after its key in the cache directory. At construction all of them
+	/// are memory mapped, and a blob's checksum is verified the first time it is looked up. Without a compiler the
+	/// cache only serves stored blobs.
+	///
+	/// File layout, all integers little endian:
+	///   uint32 magic, uint32 formatVersion, uint64 key, uint64 bytecodeSize, uint64 checksum of the bytecode, bytecode
+	/// </summary>
+	class ShaderCache
+	{
+	public:
+		static constexpr uint32_t magic = 0x43535255; // "URSC"
+		static constexpr uint32_t formatVersion = 1;
+		// Extension of the blob files in the cache directory
+		static constexpr const char* fileExtension = ".dxil";
+
+		struct Statistics
+		{
+			// Blob files mapped at construction
+			uint32_t mappedFiles = 0;
+			// Blob files dropped because their header or checksum did not match
+			uint32_t rejectedFiles = 0;
+			uint32_t cacheHits = 0;
+			uint32_t compileCount = 0;
+			uint32_t failedCount = 0;
+		};
+
+	private:
+		static constexpr size_t s_headerSize = 4 + 4 + 8 + 8 + 8;
+
+		struct Record
+		{
+			// Either the mapped cache file or bytecode stored during this run
+			std::unique_ptr<MappedFile> file;
+			std::vector<uint8_t> bytecode;
+			// Mapped files are verified on their first lookup
+			bool verified = false;
+			// Looked up or stored during this run
+			bool used = false;
+		};
+
+		std::string m_directory;
+		IShaderCompiler* m_compiler;
+		IShaderIncludeResolver* m_resolver;
+
+		mutable std::mutex m_mutex;
+		std::unordered_map<uint64_t, Record> m_records;
+		Statistics m_statistics;
+
+		std::string BlobPath(uint64_t key) const;
+
+		void MapDirectory();
+
+		/// <summary>
+		/// Gets the blob of a record, verifying it first if it is a mapped file. Drops the record if it fails
+		/// verification. Expects <see cref="m_mutex"/> to be held
+		/// </summary>
+		ShaderBlob AcquireBlob(uint64_t key);
+
+	public:
+		/// <summary>
+		/// Opens the cache in <paramref name="directory"/> and maps every blob stored there
+		/// </summary>
+		/// <param name="directory">Directory the blobs are stored in, empty for an in-memory cache</param>
+		/// <param name="compiler">Compiler for cache misses, null to only serve stored blobs. Must outlive the cache</param>
+		/// <param name="resolver">Reads sources and includes for hashing and compiling. Must outlive the cache</param>
+		ShaderCache(const std::string& directory, IShaderCompiler* compiler, IShaderIncludeResolver* resolver);
+
+		/// <summary>
+		/// Computes the cache key of <paramref name="request"/>. Missing includes are part of the key as well, so
+		/// creating one later invalidates the shader
+		/// </summary>
+		/// <param name="request">Request to hash</param>
+		/// <param name="source">Receives the contents of the source file when not null</param>
+		/// <exception cref="std::runtime_error">Thrown if the source file can not be read</exception>
+		uint64_t ComputeKey(const ShaderCompileRequest& request, std::string* source = nullptr) const;
+
+		/// <summary>
+		/// Looks up the blob stored for <paramref name="key"/>
+		/// </summary>
+		/// <returns>The blob, empty if there is none</returns>
+		ShaderBlob Find(uint64_t key);
+
+		/// <summary>
+		/// Stores <paramref name="bytecode"/> under <paramref name="key"/> in memory and in the cache directory
+		/// </summary>
+		/// <returns>The stored blob</returns>
+		ShaderBlob Store(uint64_t key, std::vector<uint8_t> bytecode);
+
+		/// <summary>
+		/// Looks up every request and compiles the misses in parallel on <paramref name="jobSystem"/>
+		/// </summary>
+		/// <returns>One result per request, in request order</returns>
+		std::vector<ShaderCompileResult> Compile(const std::vector<ShaderCompileRequest>& requests, JobSystem& jobSystem);
+
+		/// <summary>
+		/// Deletes the blobs that were neither looked up nor stored since the cache was opened, which includes every
+		/// blob invalidated by a source change
+		/// </summary>
+		/// <returns>Number of blobs removed</returns>
+		size_t RemoveUnused();
+
+		size_t GetBlobCount() const;
+
+		Statistics GetStatistics() const;
+
+		ShaderCache(const ShaderCache&) = delete;
+		ShaderCache& operator=(const ShaderCache&) = delete;
+	};
+}
+
+#endif // !ULTREALITY_RENDERING_COMMON_SHADER_CACHE_H
@@ -0,0 +1,107 @@
+#ifndef ULTREALITY_RENDERING_COMMON_SHADER_COMPILER_H
+#define ULTREALITY_RENDERING_COMMON_SHADER_COMPILER_H
+
+#include <stdint.h>
+#include <string>
+#include <string_view>
+#include <vector>
+
+namespace UltReality::Rendering::Common
+{
+	struct ShaderDefine
+	{
+		std::string name;
+		// Empty defines the macro as 1
+		std::string value;
+	};
+
+	/// <summary>
+	/// Everything that determines the bytecode of a shader, apart from the contents of the files it reads
+	/// </summary>
+	struct ShaderCompileRequest
+	{
+		// Path of the HLSL source file
+		std::string sourcePath;
+		std::string entryPoint;
+		// Shader model profile, e.g. "vs_6_0"
+		std::string target;
+		std::vector<ShaderDefine> defines;
+		// Additional compiler arguments, e.g. "-O3" or "-Zi"
+		std::vector<std::string> arguments;
+	};
+
+	/// <summary>
+	/// Finds and reads shader sources and the files they include. Called from several compile jobs at once, so
+	/// implementations must be thread safe
+	/// </summary>
+	class IShaderIncludeResolver
+	{
+	public:
+		virtual ~IShaderIncludeResolver() = default;
+
+		/// <summary>
+		/// Resolves an include directive
+		/// </summary>
+		/// <param name="includingPath">Path of the file containing the directive, empty for a top level file</param>
+		/// <param name="include">File name as written in the directive</param>
+		/// <returns>Path to read the include from, empty if it can not be found</returns>
+		virtual std::string Resolve(const std::string& includingPath, const std::string& include) = 0;
+
+		/// <summary>
+		/// Reads the file at a path returned by <see cref="Resolve"/>
+		/// </summary>
+		/// <returns>False if the file can not be read</returns>
+		virtual bool Read(const std::string& path, std::string& contents) = 0;
+	};
+
+	/// <summary>
+	/// Resolves includes relative to the including file first and then against a list of include directories
+	/// </summary>
+	class FileShaderIncludeResolver : public IShaderIncludeResolver
+	{
+	private:
+		std::vector<std::string> m_includeDirectories;
+
+	public:
+		explicit FileShaderIncludeResolver(std::vector<std::string> includeDirectories = {});
+
+		std::string Resolve(const std::string& includingPath, const std::string& include) override;
+
+		bool Read(const std::string& path, std::string& contents) override;
+	};
+
+	/// <summary>
+	/// Compiles HLSL to bytecode. Called from several compile jobs at once, so implementations must be thread safe
+	/// </summary>
+	class IShaderCompiler
+	{
+	public:
+		virtual ~IShaderCompiler() = default;
+
+		/// <summary>
+		/// Identifies the compiler build. Part of every cache key, so a compiler update recompiles everything
+		/// </summary>
+		virtual uint64_t GetVersionHash() const = 0;
+
+		/// <summary>
+		/// Compiles <paramref name="source"/>, the contents of <paramref name="request"/>'s source file
+		/// </summary>
+		/// <param name="request">What to compile</param>
+		/// <param name="source">Contents of the source file</param>
+		/// <param name="resolver">Resolver the compiler loads includes through</param>
+		/// <param name="bytecode">Receives the compiled bytecode</param>
+		/// <param name="messages">Receives the compiler's errors and warnings</param>
+		/// <returns>False if compilation failed</returns>
+		virtual bool Compile(const ShaderCompileRequest& request, const std::string& source, IShaderIncludeResolver& resolver,
+			std::vector<uint8_t>& bytecode, std::string& messages) = 0;
+	};
+
+	/// <summary>
+	/// Lists the files named by the #include directives of <paramref name="source"/>, in order of appearance.
+	/// Directives inside comments are ignored. Conditional compilation is not evaluated, so the list may name files the
+	/// compiler never opens, which only errs on the side of invalidating too much
+	/// </summary>
+	std::vector<std::string> ScanShaderIncludes(std::string_view source);
+}
+
+#endif // !ULTREALITY_RENDERING_COMMON_SHADER_COMPILER_H
@@ -0,0 +1,158 @@
+#ifndef ULTREALITY_RENDERING_COMMON_SHADOW_CASCADES_H
+#define ULTREALITY_RENDERING_COMMON_SHADOW_CASCADES_H
+
+#include <stdint.h>
+
+namespace UltReality::Rendering::Common
+{
+	constexpr uint32_t maxShadowCascades = 4;
+
+	/// <summary>
+	/// Perspective camera the cascades are fitted to
+	/// </summary>
+	struct ShadowCamera
+	{
+		// Row-major, row-vector camera to world matrix. Rows are right, up, forward and position
+		float cameraToWorld[16] = {};
+		// Vertical field of view in radians and width over height
+		float verticalFov = 1.0f;
+		float aspectRatio = 1.0f;
+		float nearZ = 0.1f;
+		// Distance the shadows reach, usually shorter than the camera's far plane
+		float farZ = 100.0f;
+	};
+
+	/// <summary>
+	/// One cascade of the shadow atlas
+	/// </summary>
+	struct ShadowCascade
+	{
+		// Row-major, row-vector light view projection with a [0, 1] depth range, mapping the cascade to its tile
+		float viewProjection[16] = {};
+		// View depth range of the camera the cascade serves
+		float splitNear = 0.0f;
+		float splitFar = 0.0f;
+		// World sphere the projection covers, larger than the slice so cached static depth survives camera motion
+		float center[3] = {};
+		float radius = 0.0f;
+		// Light direction the projection was built for
+		float lightDirection[3] = {};
+		// Tile of the cascade in atlas pixels
+		uint32_t atlasX = 0;
+		uint32_t atlasY = 0;
+		uint32_t atlasSize = 0;
+		// Whether the cached static depth of the tile has to be rendered again
+		bool staticDirty = true;
+	};
+
+	/// <summary>
+	/// Computes the far split distance of every cascade with the practical split scheme, a blend of logarithmic and
+	/// uniform splits. The last split equals <paramref name="farZ"/>
+	/// </summary>
+	/// <param name="lambda">0 for uniform splits, 1 for logarithmic splits</param>
+	/// <param name="splits">Receives <paramref name="cascadeCount"/> distances in ascending order</param>
+	/// <exception cref="std::invalid_argument">Thrown if the range or the cascade count is invalid</exception>
+	void ComputeCascadeSplits(float nearZ, float farZ, uint32_t cascadeCount, float lambda, float* splits);
+
+	/// <summary>
+	/// Computes the smallest sphere centered on the view axis containing the frustum slice [<paramref name="sliceNear"/>,
+	/// <paramref name="sliceFar"/>]. Its radius does not depend on the camera's orientation, so a cascade's texel size
+	/// stays constant
+	/// </summary>
+	void ComputeFrustumSliceSphere(const ShadowCamera& camera, float sliceNear, float sliceFar, float center[3], float& radius);
+
+	/// <summary>
+	/// Builds an orthographic light view projection covering a sphere. The center is snapped to whole texels of the
+	/// tile along the light's axes, so the rasterized depth does not shimmer when the sphere moves
+	/// </summary>
+	/// <param name="lightDirection">Normalized direction the light travels in</param>
+	/// <param name="center">Sphere center, snapped in place</param>
+	/// <param name="radius">Sphere radius</param>
+	/// <param name="casterDistance">Distance towards the light beyond the sphere whose casters still cast into it</param>
+	/// <param name="resolution">Size of the cascade's tile in texels</param>
+	/// <param name="viewProjection">Receives the row-major, row-vector matrix</param>
+	void BuildCascadeViewProjection(const float lightDirection[3], float center[3], float radius, float casterDistance, uint32_t resolution, float viewProjection[16]);
+
+	/// <summary>
+	/// Checks whether a cached cascade can keep its static depth. It cannot once the light turned by more than the
+	/// angle whose cosine is <paramref name="minLightCosine"/>, or once the required sphere leaves the cached one
+	/// </summary>
+	bool IsCascadeCacheValid(const ShadowCascade& cached, const float lightDirection[3], const float requiredCenter[3], float requiredRadius, float minLightCosine);
+
+	/// <summary>
+	/// Configuration of a <see cref="ShadowCascadeSet"/>
+	/// </summary>
+	struct ShadowCascadeSettings
+	{
+		uint32_t cascadeCount = maxShadowCascades;
+		// Texels along the edge of one cascade's tile
+		uint32_t cascadeResolution = 2048;
+		// Blend between uniform (0) and logarithmic (1) splits
+		float splitLambda = 0.75f;
+		// Cached spheres are this much larger than required, so the camera can move before the cache is invalidated
+		float cachePadding = 1.25f;
+		// Light rotation in radians tolerated before the static depth is rendered again
+		float maxLightAngle = 0.002f;
+		// Distance towards the light beyond a cascade whose casters still shadow it
+		float casterDistance = 100.0f;
+	};
+
+	/// <summary>
+	/// Cascaded shadow maps packed into one atlas. Splits are computed from the camera every frame. Static casters are
+	/// rendered into a cached copy of the atlas only when a cascade's light or bounds move beyond the thresholds, and
+	/// dynamic casters are drawn over a copy of it every frame
+	/// </summary>
+	class ShadowCascadeSet
+	{
+	private:
+		ShadowCascadeSettings m_settings;
+		ShadowCascade m_cascades[maxShadowCascades];
+		uint32_t m_atlasWidth = 0;
+		uint32_t m_atlasHeight = 0;
+
+		void LayoutAtlas();
+
+	public:
+		/// <exception cref="std::invalid_argument">Thrown if the settings are invalid</exception>
+		explicit ShadowCascadeSet(const ShadowCascadeSettings& settings = ShadowCascadeSettings());
+
+		/// <summary>
+		/// Replaces the settings. Every cascade becomes dirty
+		/// </summary>
+		/// <exception cref="std::invalid_argument">Thrown if the settings are invalid</exception>
+		void SetSettings(const ShadowCascadeSettings& settings);
+
+		const ShadowCascadeSettings& GetSettings() const;
+
+		/// <summary>
+		/// Fits the cascades to the camera. Cascades whose cache is no longer valid get a new projection and are
+		/// marked dirty, the others keep theirs
+		/// </summary>
+		/// <param name="camera">Camera the shadows are seen from</param>
+		/// <param name="lightDirection">Direction the light travels in, normalized here</param>
+		void Update(const ShadowCamera& camera, const float lightDirection[3]);
+
+		/// <summary>
+		/// Marks the cached static depth of a cascade as up to date, once it was rendered
+		/// </summary>
+		void MarkStaticRendered(uint32_t cascade);
+
+		/// <summary>
+		/// Marks every cascade dirty, e.g. after static geometry changed or the atlas was recreated
+		/// </summary>
+		void InvalidateStatic();
+
+		uint32_t GetCascadeCount() const;
+
+		/// <exception cref="std::out_of_range">Thrown if <paramref name="cascade"/> is not below the cascade count</exception>
+		const ShadowCascade& GetCascade(uint32_t cascade) const;
+
+		uint32_t GetAtlasWidth() const;
+		uint32_t GetAtlasHeight() const;
+
+		ShadowCascadeSet(const ShadowCascadeSet&) = delete;
+		ShadowCascadeSet& operator=(const ShadowCascadeSet&) = delete;
+	};
+}
+
+#endif // !ULTREALITY_RENDERING_COMMON_SHADOW_CASCADES_H
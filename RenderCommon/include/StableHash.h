@@ -0,0 +1,53 @@
+#ifndef ULTREALITY_RENDERING_COMMON_STABLE_HASH_H
+#define ULTREALITY_RENDERING_COMMON_STABLE_HASH_H
+
+#include <stdint.h>
+#include <stddef.h>
+#include <string_view>
+#include <type_traits>
+
+namespace UltReality::Rendering::Common
+{
+	/// <summary>
+	/// Incremental 64-bit FNV-1a hasher whose result only depends on the values fed to it. Integers are hashed in
+	/// little endian byte order, so keys stay valid across runs, builds and platforms and can be persisted to disk.
+	/// Never feed it pointers or structs with padding
+	/// </summary>
+	class StableHasher
+	{
+	public:
+		static constexpr uint64_t offsetBasis = 0xcbf29ce484222325ull;
+		static constexpr uint64_t prime = 0x100000001b3ull;
+
+	private:
+		uint64_t m_hash = offsetBasis;
+
+	public:
+		/// <summary>
+		/// Hashes <paramref name="size"/> raw bytes
+		/// </summary>
+		StableHasher& AddBytes(const void* data, size_t size);
+
+		/// <summary>
+		/// Hashes an integer, enum, bool or float by value. The byte count is part of the value's type
+		/// </summary>
+		template<typename T>
+		StableHasher& Add(T value);
+
+		/// <summary>
+		/// Hashes the length and characters of <paramref name="text"/>, so "ab" + "c" and "a" + "bc" differ
+		/// </summary>
+		StableHasher& AddString(std::string_view text);
+
+		uint64_t Finish() const;
+	};
+
+	/// <summary>
+	/// Hashes a block of bytes in one call
+	/// </summary>
+	uint64_t StableHash(const void* data, size_t size);
+}
+
+#include <StableHash.inl>
+
+#endif // !ULTREALITY_RENDERING_COMMON_STABLE_HASH_H
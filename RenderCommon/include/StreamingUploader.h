@@ -0,0 +1,212 @@
+#ifndef ULTREALITY_RENDERING_COMMON_STREAMING_UPLOADER_H
+#define ULTREALITY_RENDERING_COMMON_STREAMING_UPLOADER_H
+
+#include <stdint.h>
+#include <atomic>
+#include <condition_variable>
+#include <deque>
+#include <exception>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+#include <LinearRingAllocator.h>
+
+namespace UltReality::Rendering::Common
+{
+	/// <summary>
+	/// Identifies an upload queued on a <see cref="StreamingUploader"/>. Tickets increase in queue order, 0 is never issued
+	/// </summary>
+	using UploadTicket = uint64_t;
+
+	/// <summary>
+	/// Copy from the staging ring into a destination resource, recorded by an <see cref="IUploadQueue"/>
+	/// </summary>
+	struct UploadCopy
+	{
+		// Subresource value of buffer copies
+		static constexpr uint32_t wholeBuffer = UINT32_MAX;
+
+		// Offset of the source bytes in the staging memory
+		uint64_t stagingOffset = 0;
+		uint64_t size = 0;
+		// Backend resource the bytes are copied into
+		void* destination = nullptr;
+		// Byte offset into a buffer destination
+		uint64_t destinationOffset = 0;
+		// Subresource of a texture destination, <see cref="wholeBuffer"/> for buffers
+		uint32_t subresource = wholeBuffer;
+	};
+
+	struct UploadRequest
+	{
+		// Staging bytes the request needs, laid out however the backend's copy of the destination expects
+		uint64_t size = 0;
+		// Alignment of the staging bytes. Must be a power of 2
+		uint64_t alignment = 16;
+		void* destination = nullptr;
+		uint64_t destinationOffset = 0;
+		uint32_t subresource = UploadCopy::wholeBuffer;
+		// Fills the <see cref="size"/> staging bytes. Runs on the uploader thread, so it must own or share the source data
+		std::function<void(uint8_t* staging)> write;
+	};
+
+	/// <summary>
+	/// Queue the uploads of a <see cref="StreamingUploader"/> are executed on. Only the uploader thread records and
+	/// submits, <see cref="GetCompletedValue"/> and <see cref="WaitForValue"/> may be called from any thread
+	/// </summary>
+	class IUploadQueue
+	{
+	public:
+		virtual ~IUploadQueue() = default;
+
+		/// <summary>
+		/// Gets the CPU address of the staging memory copies are recorded from
+		/// </summary>
+		virtual uint8_t* GetStagingMemory() = 0;
+
+		virtual uint64_t GetStagingCapacity() const = 0;
+
+		/// <summary>
+		/// Records a copy into the open batch, opening one if needed
+		/// </summary>
+		virtual void RecordCopy(const UploadCopy& copy) = 0;
+
+		/// <summary>
+		/// Executes the open batch and signals the queue's fence after it
+		/// </summary>
+		/// <returns>Fence value reached once the batch completed</returns>
+		virtual uint64_t SubmitBatch() = 0;
+
+		virtual uint64_t GetCompletedValue() const = 0;
+
+		virtual void WaitForValue(uint64_t value) = 0;
+	};
+
+	/// <summary>
+	/// Uploads resource data in the background. Requests are queued from any thread without blocking, and a dedicated
+	/// thread writes them into a staging ring and records them into as few batches as the batch limits allow. Every
+	/// request gets a ticket that completes once the fence value of its batch is reached. When the staging ring is
+	/// full the uploader thread, never the caller, waits for the oldest batch
+	/// </summary>
+	class StreamingUploader
+	{
+	public:
+		struct Statistics
+		{
+			uint64_t requestCount = 0;
+			uint64_t batchCount = 0;
+			uint64_t bytesUploaded = 0;
+			// Times the uploader thread waited on the GPU for staging memory
+			uint64_t stagingStalls = 0;
+		};
+
+	private:
+		struct PendingRequest
+		{
+			UploadTicket ticket;
+			UploadRequest request;
+		};
+
+		struct SubmittedBatch
+		{
+			// Last ticket recorded into the batch
+			UploadTicket lastTicket;
+			uint64_t fenceValue;
+		};
+
+		IUploadQueue* m_queue;
+		uint64_t m_maxBatchBytes;
+		uint32_t m_maxBatchCopies;
+
+		// Only touched by the uploader thread
+		LinearRingAllocator m_staging;
+		// Fence values of the batches still holding staging memory, oldest first. Only touched by the uploader thread
+		std::deque<uint64_t> m_stagingFences;
+
+		std::mutex m_mutex;
+		// Signalled when a request is queued or the uploader stops
+		std::condition_variable m_workAvailable;
+		// Signalled when a batch is submitted or the uploader thread failed
+		std::condition_variable m_batchSubmitted;
+		std::deque<PendingRequest> m_pending;
+		UploadTicket m_nextTicket = 1;
+		// Highest ticket whose batch has been submitted
+		UploadTicket m_submittedTicket = 0;
+		// Submitted batches whose fence has not been seen complete, oldest first
+		std::deque<SubmittedBatch> m_inFlight;
+		Statistics m_statistics;
+		// First exception thrown on the uploader thread, which stops it. Rethrown to callers
+		std::exception_ptr m_error;
+		bool m_stopping = false;
+
+		// Highest ticket known to be complete, read without the lock
+		std::atomic<UploadTicket> m_completedTicket{ 0 };
+
+		std::thread m_thread;
+
+		void ThreadMain();
+
+		void ProcessBatch(std::vector<PendingRequest>& batch);
+
+		void SubmitBatch(UploadTicket lastTicket, uint32_t requestCount, uint64_t byteCount);
+
+		/// <summary>
+		/// Advances <see cref="m_completedTicket"/> past every batch the queue completed. Requires m_mutex
+		/// </summary>
+		void RetireCompletedBatches();
+
+	public:
+		/// <summary>
+		/// Starts the uploader thread
+		/// </summary>
+		/// <param name="queue">Queue to upload on. Must outlive the uploader</param>
+		/// <param name="maxBatchBytes">Staging bytes after which a batch is submitted</param>
+		/// <param name="maxBatchCopies">Copies after which a batch is submitted</param>
+		StreamingUploader(IUploadQueue* queue, uint64_t maxBatchBytes, uint32_t maxBatchCopies);
+
+		/// <summary>
+		/// Submits the queued requests and stops the uploader thread. Does not wait for the GPU
+		/// </summary>
+		~StreamingUploader();
+
+		/// <summary>
+		/// Queues an upload. Never blocks on the GPU
+		/// </summary>
+		/// <exception cref="std::invalid_argument">Thrown if the request has no writer, no size, or needs more than half the staging ring</exception>
+		UploadTicket Enqueue(UploadRequest request);
+
+		/// <summary>
+		/// Queues a copy of <paramref name="data"/> into a buffer
+		/// </summary>
+		UploadTicket EnqueueBuffer(void* destination, uint64_t destinationOffset, std::vector<uint8_t> data);
+
+		/// <summary>
+		/// Checks whether an upload has completed on the GPU without blocking
+		/// </summary>
+		bool IsComplete(UploadTicket ticket);
+
+		/// <summary>
+		/// Blocks until an upload has completed on the GPU
+		/// </summary>
+		void Wait(UploadTicket ticket);
+
+		/// <summary>
+		/// Blocks until every upload queued so far has completed on the GPU
+		/// </summary>
+		void WaitForIdle();
+
+		/// <summary>
+		/// Gets the highest ticket known to be complete. Every lower ticket is complete as well
+		/// </summary>
+		UploadTicket GetCompletedTicket() const;
+
+		Statistics GetStatistics();
+
+		StreamingUploader(const StreamingUploader&) = delete;
+		StreamingUploader& operator=(const StreamingUploader&) = delete;
+	};
+}
+
+#endif // !ULTREALITY_RENDERING_COMMON_STREAMING_UPLOADER_H
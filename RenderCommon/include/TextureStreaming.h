@@ -0,0 +1,148 @@
+#ifndef ULTREALITY_RENDERING_COMMON_TEXTURE_STREAMING_H
+#define ULTREALITY_RENDERING_COMMON_TEXTURE_STREAMING_H
+
+#include <stdint.h>
+#include <vector>
+
+namespace UltReality::Rendering::Common
+{
+	struct StreamingTextureDesc
+	{
+		// Size of mip 0 along the longer axis
+		uint32_t baseSize = 0;
+		// Bytes of memory each mip occupies when resident, finest first. The last entry is the tail, which is
+		// resident for as long as the texture is registered
+		std::vector<uint64_t> mipSizes;
+	};
+
+	/// <summary>
+	/// New finest resident mip of a texture. Every coarser mip is resident as well
+	/// </summary>
+	struct TextureMipChange
+	{
+		uint32_t texture;
+		uint32_t mip;
+	};
+
+	/// <summary>
+	/// Residency changes decided by one <see cref="TextureStreamingManager::Update"/>
+	/// </summary>
+	struct TextureStreamingUpdate
+	{
+		// Mips to stream in, from the change's mip up to the texture's current resident mip.
+		// Report completion with <see cref="TextureStreamingManager::OnMipsResident"/>
+		std::vector<TextureMipChange> loads;
+		// Mips to drop, finer than the change's mip. Already accounted as freed
+		std::vector<TextureMipChange> evictions;
+	};
+
+	/// <summary>
+	/// Decides which mips of the streamed textures are resident so their memory stays within a budget. Each update,
+	/// every texture requests the mip its screen-space footprint needs. Starting from the tails, the budget is then
+	/// handed out one mip at a time to the step that covers the most screen pixels per byte, so large and close
+	/// textures sharpen first and no texture goes finer than it requested. Mips beyond that plan stay resident as a
+	/// cache until the budget is exceeded, and then the least visible textures are evicted first.
+	/// Knows nothing about the API, the backend performs the loads and evictions
+	/// </summary>
+	class TextureStreamingManager
+	{
+	public:
+		static constexpr uint32_t invalidTexture = UINT32_MAX;
+
+		struct Statistics
+		{
+			uint64_t budgetBytes = 0;
+			// Bytes of resident mips and of loads in flight
+			uint64_t committedBytes = 0;
+			// Bytes the requested mips of every texture would need
+			uint64_t requestedBytes = 0;
+			uint32_t textureCount = 0;
+			// Loads and evictions issued by the last update
+			uint32_t loadCount = 0;
+			uint32_t evictionCount = 0;
+		};
+
+	private:
+		struct Texture
+		{
+			bool live = false;
+			uint32_t baseSize = 0;
+			// Bytes needed when a mip and everything coarser is resident, indexed by mip
+			std::vector<uint64_t> residentSizes;
+			// Largest footprint reported since the last update, in screen pixels along the longer axis
+			float footprint = 0.0f;
+			// Footprint the last update worked with
+			float priority = 0.0f;
+			// Update the texture was last reported visible in
+			uint64_t lastVisibleUpdate = 0;
+			uint32_t requestedMip = 0;
+			uint32_t targetMip = 0;
+			uint32_t residentMip = 0;
+			// Equal to residentMip unless a load is in flight
+			uint32_t pendingMip = 0;
+
+			uint32_t TailMip() const { return static_cast<uint32_t>(residentSizes.size()) - 1; }
+		};
+
+		std::vector<Texture> m_textures;
+		std::vector<uint32_t> m_freeIndices;
+
+		uint64_t m_budget;
+		// Added to every requested mip, positive values stream coarser mips
+		float m_mipBias = 0.0f;
+		uint64_t m_updateIndex = 0;
+
+		Statistics m_statistics;
+
+		uint32_t RequestedMip(const Texture& texture) const;
+
+		void PlanTargets();
+
+		uint64_t CommittedBytes(const Texture& texture) const;
+
+	public:
+		explicit TextureStreamingManager(uint64_t budgetBytes);
+
+		/// <summary>
+		/// Registers a texture with only its tail resident
+		/// </summary>
+		/// <exception cref="std::invalid_argument">Thrown if the description has no mips or no size</exception>
+		uint32_t Register(const StreamingTextureDesc& desc);
+
+		/// <summary>
+		/// Stops streaming a texture. Its memory is the backend's to release
+		/// </summary>
+		void Unregister(uint32_t texture);
+
+		/// <summary>
+		/// Reports that a texture was drawn covering <paramref name="screenPixels"/> pixels along its longer axis.
+		/// Textures not reported between two updates request only their tail
+		/// </summary>
+		void ReportFootprint(uint32_t texture, float screenPixels);
+
+		/// <summary>
+		/// Plans the resident mips of every texture and returns the loads and evictions that move towards the plan.
+		/// A texture has at most one load in flight
+		/// </summary>
+		TextureStreamingUpdate Update();
+
+		/// <summary>
+		/// Marks the load issued for a texture as complete
+		/// </summary>
+		void OnMipsResident(uint32_t texture, uint32_t mip);
+
+		void SetBudget(uint64_t budgetBytes);
+
+		void SetMipBias(float bias);
+
+		uint32_t GetResidentMip(uint32_t texture) const;
+
+		uint32_t GetRequestedMip(uint32_t texture) const;
+
+		uint32_t GetTargetMip(uint32_t texture) const;
+
+		const Statistics& GetStatistics() const;
+	};
+}
+
+#endif // !ULTREALITY_RENDERING_COMMON_TEXTURE_STREAMING_H
@@ -0,0 +1,44 @@
+#ifndef ULTREALITY_RENDERING_COMMON_BUDDY_ALLOCATOR_INL
+#define ULTREALITY_RENDERING_COMMON_BUDDY_ALLOCATOR_INL
+
+#if defined(__GNUC__) or defined(__clang__)
+#define FORCE_INLINE inline __attribute__((always_inline))
+#elif defined(_MSC_VER)
+#define FORCE_INLINE __forceinline
+#else
+#define FORCE_INLINE inline
+#endif
+
+namespace UltReality::Rendering::Common
+{
+	FORCE_INLINE uint64_t BuddyAllocator::BlockSize(uint32_t level) const
+	{
+		return m_capacity >> level;
+	}
+
+	FORCE_INLINE uint64_t BuddyAllocator::GetCapacity() const
+	{
+		return m_capacity;
+	}
+
+	FORCE_INLINE bool BuddyAllocator::IsEmpty() const
+	{
+		return m_allocations.empty();
+	}
+
+	FORCE_INLINE bool BuddyAllocator::IsPowerOfTwo(uint64_t value)
+	{
+		return value != 0 && (value & (value - 1)) == 0;
+	}
+
+	FORCE_INLINE uint64_t BuddyAllocator::NextPowerOfTwo(uint64_t value)
+	{
+		uint64_t result = 1;
+		while (result < value)
+			result <<= 1;
+
+		return result;
+	}
+}
+
+#endif // !ULTREALITY_RENDERING_COMMON_BUDDY_ALLOCATOR_INL
@@ -0,0 +1,61 @@
+#ifndef ULTREALITY_RENDERING_COMMON_DEFERRED_RELEASE_QUEUE_INL
+#define ULTREALITY_RENDERING_COMMON_DEFERRED_RELEASE_QUEUE_INL
+
+#if defined(__GNUC__) or defined(__clang__)
+#define FORCE_INLINE inline __attribute__((always_inline))
+#elif defined(_MSC_VER)
+#define FORCE_INLINE __forceinline
+#else
+#define FORCE_INLINE inline
+#endif
+
+#include <utility>
+
+namespace UltReality::Rendering::Common
+{
+	template<typename T>
+	FORCE_INLINE void DeferredReleaseQueue<T>::Release(T object)
+	{
+		m_frameReleased.push_back(std::move(object));
+		m_pendingCount++;
+	}
+
+	template<typename T>
+	FORCE_INLINE void DeferredReleaseQueue<T>::FinishFrame(uint64_t fenceValue)
+	{
+		if (m_frameReleased.empty())
+			return;
+
+		m_retiring.push_back(RetiringFrame{ std::move(m_frameReleased), fenceValue });
+		m_frameReleased.clear();
+	}
+
+	template<typename T>
+	FORCE_INLINE void DeferredReleaseQueue<T>::Retire(uint64_t completedFenceValue)
+	{
+		Retire(completedFenceValue, [](T&) {});
+	}
+
+	template<typename T>
+	template<typename ReleaseFunction>
+	FORCE_INLINE void DeferredReleaseQueue<T>::Retire(uint64_t completedFenceValue, ReleaseFunction&& release)
+	{
+		// Fence values of submitted frames only grow, so the retired frames are always at the front
+		while (!m_retiring.empty() && m_retiring.front().fenceValue <= completedFenceValue)
+		{
+			for (T& object : m_retiring.front().objects)
+				release(object);
+			m_pendingCount -= m_retiring.front().objects.size();
+
+			m_retiring.pop_front();
+		}
+	}
+
+	template<typename T>
+	FORCE_INLINE size_t DeferredReleaseQueue<T>::GetPendingCount() const
+	{
+		return m_pendingCount;
+	}
+}
+
+#endif // !ULTREALITY_RENDERING_COMMON_DEFERRED_RELEASE_QUEUE_INL
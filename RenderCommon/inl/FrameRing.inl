@@ -0,0 +1,35 @@
+#ifndef ULTREALITY_RENDERING_COMMON_FRAME_RING_INL
+#define ULTREALITY_RENDERING_COMMON_FRAME_RING_INL
+
+#if defined(__GNUC__) or defined(__clang__)
+#define FORCE_INLINE inline __attribute__((always_inline))
+#elif defined(_MSC_VER)
+#define FORCE_INLINE __forceinline
+#else
+#define FORCE_INLINE inline
+#endif
+
+namespace UltReality::Rendering::Common
+{
+	FORCE_INLINE uint32_t FrameRing::GetFrameIndex() const
+	{
+		return m_frameIndex;
+	}
+
+	FORCE_INLINE uint32_t FrameRing::GetFramesInFlight() const
+	{
+		return m_framesInFlight;
+	}
+
+	FORCE_INLINE uint64_t FrameRing::GetFrameFenceValue(uint32_t frameIndex) const
+	{
+		return m_frameFenceValues[frameIndex];
+	}
+
+	FORCE_INLINE uint64_t FrameRing::GetStallCount() const
+	{
+		return m_stallCount;
+	}
+}
+
+#endif // !ULTREALITY_RENDERING_COMMON_FRAME_RING_INL
@@ -0,0 +1,35 @@
+#ifndef ULTREALITY_RENDERING_COMMON_LINEAR_RING_ALLOCATOR_INL
+#define ULTREALITY_RENDERING_COMMON_LINEAR_RING_ALLOCATOR_INL
+
+#if defined(__GNUC__) or defined(__clang__)
+#define FORCE_INLINE inline __attribute__((always_inline))
+#elif defined(_MSC_VER)
+#define FORCE_INLINE __forceinline
+#else
+#define FORCE_INLINE inline
+#endif
+
+namespace UltReality::Rendering::Common
+{
+	FORCE_INLINE uint64_t LinearRingAllocator::GetCapacity() const
+	{
+		return m_capacity;
+	}
+
+	FORCE_INLINE uint64_t LinearRingAllocator::GetUsedSize() const
+	{
+		return m_usedSize;
+	}
+
+	FORCE_INLINE uint64_t LinearRingAllocator::GetOverflowCount() const
+	{
+		return m_overflowCount;
+	}
+
+	FORCE_INLINE uint64_t LinearRingAllocator::AlignUp(uint64_t value, uint64_t alignment)
+	{
+		return (value + alignment - 1) & ~(alignment - 1);
+	}
+}
+
+#endif // !ULTREALITY_RENDERING_COMMON_LINEAR_RING_ALLOCATOR_INL
@@ -0,0 +1,80 @@
+#ifndef ULTREALITY_RENDERING_COMMON_STABLE_HASH_INL
+#define ULTREALITY_RENDERING_COMMON_STABLE_HASH_INL
+
+#if defined(__GNUC__) or defined(__clang__)
+#define FORCE_INLINE inline __attribute__((always_inline))
+#elif defined(_MSC_VER)
+#define FORCE_INLINE __forceinline
+#else
+#define FORCE_INLINE inline
+#endif
+
+#include <cstring>
+
+namespace UltReality::Rendering::Common
+{
+	FORCE_INLINE StableHasher& StableHasher::AddBytes(const void* data, size_t size)
+	{
+		const uint8_t* bytes = static_cast<const uint8_t*>(data);
+		for (size_t i = 0; i < size; i++)
+		{
+			m_hash ^= bytes[i];
+			m_hash *= prime;
+		}
+
+		return *this;
+	}
+
+	template<typename T>
+	FORCE_INLINE StableHasher& StableHasher::Add(T value)
+	{
+		static_assert(std::is_arithmetic_v<T> || std::is_enum_v<T>, "StableHasher::Add only accepts arithmetic and enum values");
+
+		uint64_t bits = 0;
+		if constexpr (std::is_floating_point_v<T>)
+		{
+			// -0.0 and 0.0 compare equal and have to hash equal
+			if (value == T(0))
+				value = T(0);
+
+			static_assert(sizeof(T) == 4 || sizeof(T) == 8, "StableHasher only supports 32 and 64 bit floating point values");
+			std::conditional_t<sizeof(T) == 4, uint32_t, uint64_t> raw;
+			std::memcpy(&raw, &value, sizeof(T));
+			bits = raw;
+		}
+		else if constexpr (std::is_enum_v<T>)
+		{
+			bits = static_cast<uint64_t>(static_cast<std::underlying_type_t<T>>(value));
+		}
+		else
+		{
+			bits = static_cast<uint64_t>(value);
+		}
+
+		for (size_t i = 0; i < sizeof(T); i++)
+		{
+			m_hash ^= static_cast<uint8_t>(bits >> (i * 8));
+			m_hash *= prime;
+		}
+
+		return *this;
+	}
+
+	FORCE_INLINE StableHasher& StableHasher::AddString(std::string_view text)
+	{
+		Add<uint64_t>(text.size());
+		return AddBytes(text.data(), text.size());
+	}
+
+	FORCE_INLINE uint64_t StableHasher::Finish() const
+	{
+		return m_hash;
+	}
+
+	FORCE_INLINE uint64_t StableHash(const void* data, size_t size)
+	{
+		return StableHasher().AddBytes(data, size).Finish();
+	}
+}
+
+#endif // !ULTREALITY_RENDERING_COMMON_STABLE_HASH_INL
@@ -0,0 +1,97 @@
+#include <BindlessIndexAllocator.h>
+
+#include <algorithm>
+#include <stdexcept>
+#include <utility>
+
+namespace UltReality::Rendering::Common
+{
+	BindlessIndexAllocator::BindlessIndexAllocator(uint32_t capacity)
+		: m_capacity(capacity)
+	{
+		if (capacity == 0 || capacity == BindlessHandle::invalidIndex)
+			throw std::invalid_argument("BindlessIndexAllocator capacity must be non-zero and below the invalid index");
+
+		m_statistics.capacity = capacity;
+	}
+
+	BindlessHandle BindlessIndexAllocator::Allocate()
+	{
+		uint32_t index;
+		if (!m_freeIndices.empty())
+		{
+			index = m_freeIndices.front();
+			m_freeIndices.pop_front();
+		}
+		else if (m_generations.size() < m_capacity)
+		{
+			// Slots are only touched once they are first needed
+			index = static_cast<uint32_t>(m_generations.size());
+			m_generations.push_back(0);
+			m_allocated.push_back(false);
+		}
+		else
+		{
+			throw std::runtime_error("Bindless descriptor table is full");
+		}
+
+		m_allocated[index] = true;
+
+		m_statistics.allocatedCount++;
+		m_statistics.highWaterMark = std::max(m_statistics.highWaterMark, m_statistics.allocatedCount);
+
+		return BindlessHandle{ index, m_generations[index] };
+	}
+
+	void BindlessIndexAllocator::Free(BindlessHandle handle)
+	{
+		if (!IsLive(handle))
+			throw std::invalid_argument("Freeing a bindless handle that is stale or was never allocated");
+
+		m_allocated[handle.index] = false;
+		m_generations[handle.index]++;
+		m_frameFreed.push_back(handle.index);
+
+		m_statistics.allocatedCount--;
+		m_statistics.retiringCount++;
+	}
+
+	bool BindlessIndexAllocator::IsLive(BindlessHandle handle) const
+	{
+		return handle.index < m_generations.size() && m_allocated[handle.index] && m_generations[handle.index] == handle.generation;
+	}
+
+	uint32_t BindlessIndexAllocator::Resolve(BindlessHandle handle) const
+	{
+		if (!IsLive(handle))
+			throw std::invalid_argument("Using a bindless handle after it was freed");
+
+		return handle.index;
+	}
+
+	void BindlessIndexAllocator::FinishFrame(uint64_t fenceValue)
+	{
+		if (m_frameFreed.empty())
+			return;
+
+		m_retiring.push_back(RetiringFrame{ std::move(m_frameFreed), fenceValue });
+		m_frameFreed.clear();
+	}
+
+	void BindlessIndexAllocator::Retire(uint64_t completedFenceValue)
+	{
+		while (!m_retiring.empty() && m_retiring.front().fenceValue <= completedFenceValue)
+		{
+			const std::vector<uint32_t>& indices = m_retiring.front().indices;
+			m_freeIndices.insert(m_freeIndices.end(), indices.begin(), indices.end());
+			m_statistics.retiringCount -= static_cast<uint32_t>(indices.size());
+
+			m_retiring.pop_front();
+		}
+	}
+
+	const BindlessIndexAllocator::Statistics& BindlessIndexAllocator::GetStatistics() const
+	{
+		return m_statistics;
+	}
+}
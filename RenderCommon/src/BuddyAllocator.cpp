@@ -0,0 +1,119 @@
+#include <BuddyAllocator.h>
+
+#include <algorithm>
+#include <stdexcept>
+
+namespace UltReality::Rendering::Common
+{
+	BuddyAllocator::BuddyAllocator(uint64_t capacity, uint64_t minBlockSize)
+		: m_capacity(capacity), m_minBlockSize(minBlockSize), m_levelCount(1)
+	{
+		if (!IsPowerOfTwo(capacity) || !IsPowerOfTwo(minBlockSize) || minBlockSize > capacity)
+			throw std::invalid_argument("BuddyAllocator sizes must be powers of 2 with minBlockSize <= capacity");
+
+		for (uint64_t blockSize = capacity; blockSize > minBlockSize; blockSize >>= 1)
+			m_levelCount++;
+
+		m_freeLists.resize(m_levelCount);
+		m_freeLists[0].insert(0);
+	}
+
+	uint64_t BuddyAllocator::Allocate(uint64_t size, uint64_t alignment)
+	{
+		// Checked before rounding, a request above the largest power of 2 could never be rounded up
+		if (size == 0 || size > m_capacity || alignment > m_capacity)
+			return invalidOffset;
+
+		// Blocks are aligned to their own size, so rounding the request up to the alignment satisfies both
+		const uint64_t blockSize = std::max({ m_minBlockSize, NextPowerOfTwo(size), NextPowerOfTwo(alignment) });
+		if (blockSize > m_capacity)
+			return invalidOffset;
+
+		uint32_t targetLevel = 0;
+		while (BlockSize(targetLevel) > blockSize)
+			targetLevel++;
+
+		// Find the smallest free block that can hold the request
+		int32_t level = static_cast<int32_t>(targetLevel);
+		while (level >= 0 && m_freeLists[level].empty())
+			level--;
+
+		if (level < 0)
+			return invalidOffset;
+
+		uint64_t offset = *m_freeLists[level].begin();
+		m_freeLists[level].erase(m_freeLists[level].begin());
+
+		// Split down to the target size, returning the upper halves to the free lists
+		while (static_cast<uint32_t>(level) < targetLevel)
+		{
+			level++;
+			m_freeLists[level].insert(offset + BlockSize(level));
+		}
+
+		m_allocations.emplace(offset, Allocation{ targetLevel, size });
+		m_usedBytes += BlockSize(targetLevel);
+		m_requestedBytes += size;
+
+		return offset;
+	}
+
+	void BuddyAllocator::Free(uint64_t offset)
+	{
+		auto it = m_allocations.find(offset);
+		if (it == m_allocations.end())
+			throw std::invalid_argument("BuddyAllocator::Free called with an offset that is not allocated");
+
+		uint32_t level = it->second.level;
+		m_usedBytes -= BlockSize(level);
+		m_requestedBytes -= it->second.requestedSize;
+		m_allocations.erase(it);
+
+		// Merge with the buddy for as long as it is also free
+		while (level > 0)
+		{
+			const uint64_t buddy = offset ^ BlockSize(level);
+			auto buddyIt = m_freeLists[level].find(buddy);
+			if (buddyIt == m_freeLists[level].end())
+				break;
+
+			m_freeLists[level].erase(buddyIt);
+			offset = std::min(offset, buddy);
+			level--;
+		}
+
+		m_freeLists[level].insert(offset);
+	}
+
+	uint64_t BuddyAllocator::GetAllocationSize(uint64_t offset) const
+	{
+		auto it = m_allocations.find(offset);
+		if (it == m_allocations.end())
+			return 0;
+
+		return BlockSize(it->second.level);
+	}
+
+	BuddyAllocator::Statistics BuddyAllocator::GetStatistics() const
+	{
+		Statistics stats;
+		stats.capacity = m_capacity;
+		stats.usedBytes = m_usedBytes;
+		stats.requestedBytes = m_requestedBytes;
+		stats.freeBytes = m_capacity - m_usedBytes;
+		stats.allocationCount = static_cast<uint32_t>(m_allocations.size());
+
+		for (uint32_t level = 0; level < m_levelCount; level++)
+		{
+			if (!m_freeLists[level].empty() && stats.largestFreeBlock == 0)
+				stats.largestFreeBlock = BlockSize(level);
+
+			stats.freeBlockCount += static_cast<uint32_t>(m_freeLists[level].size());
+		}
+
+		if (stats.freeBytes > 0)
+			stats.fragmentation = 1.0f - static_cast<float>(stats.largestFreeBlock) / static_cast<float>(stats.freeBytes);
+
+		return stats;
+	}
+}
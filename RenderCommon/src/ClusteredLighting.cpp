@@ -0,0 +1,505 @@
+#include <ClusteredLighting.h>
+#include <JobSystem.h>
+
+#include <algorithm>
+#include <bit>
+#include <chrono>
+#include <cmath>
+#include <stdexcept>
+
+#if defined(_M_X64) || defined(__x86_64__) || defined(_M_IX86) || defined(__i386__)
+#define ULTREALITY_CLUSTERING_X86
+#include <immintrin.h>
+#elif defined(__ARM_NEON) || defined(_M_ARM64) || defined(_M_ARM)
+#define ULTREALITY_CLUSTERING_NEON
+#include <arm_neon.h>
+#endif
+
+// GCC and Clang only emit instructions beyond the baseline in functions that opt into them, MSVC emits any intrinsic
+#if defined(__GNUC__) || defined(__clang__)
+#define ULTREALITY_CLUSTERING_TARGET(isa) __attribute__((target(isa)))
+#else
+#define ULTREALITY_CLUSTERING_TARGET(isa)
+#endif
+
+namespace UltReality::Rendering::Common
+{
+	namespace
+	{
+		// Bounds are stored as min x, y, z followed by max x, y, z
+		constexpr uint32_t s_boundsStride = 6;
+
+		uint32_t PaddedSize(uint32_t count)
+		{
+			return (count + BoundingSphereSoA::simdPadding - 1) / BoundingSphereSoA::simdPadding * BoundingSphereSoA::simdPadding;
+		}
+
+		// Appends the position of every set bit of a lane mask, dropping lanes past the end of the range
+		inline uint32_t EmitHits(uint32_t mask, uint32_t base, uint32_t last, uint32_t* out, uint32_t count)
+		{
+			const uint32_t lanes = last - base;
+			if (lanes < 32)
+				mask &= (1u << lanes) - 1;
+
+			while (mask != 0)
+			{
+				out[count++] = base + static_cast<uint32_t>(std::countr_zero(mask));
+				mask &= mask - 1;
+			}
+
+			return count;
+		}
+
+		using SphereBoundsKernel = uint32_t(*)(const float* x, const float* y, const float* z, const float* radius, uint32_t count, const float bounds[6], uint32_t* out);
+
+		// Every path computes the squared distance from the sphere center to the bounds with the same operations in
+		// the same order and without fused multiply-adds, so all of them and the reference report the same lights
+
+		inline bool SphereOverlapsBounds(float x, float y, float z, float radius, const float bounds[6])
+		{
+			const float dx = std::max(std::max(bounds[0] - x, x - bounds[3]), 0.0f);
+			const float dy = std::max(std::max(bounds[1] - y, y - bounds[4]), 0.0f);
+			const float dz = std::max(std::max(bounds[2] - z, z - bounds[5]), 0.0f);
+
+			float distance = dx * dx;
+			distance = distance + dy * dy;
+			distance = distance + dz * dz;
+			return distance <= radius * radius;
+		}
+
+		uint32_t OverlapScalar(const float* x, const float* y, const float* z, const float* radius, uint32_t count, const float bounds[6], uint32_t* out)
+		{
+			uint32_t hits = 0;
+			for (uint32_t i = 0; i < count; i++)
+			{
+				if (SphereOverlapsBounds(x[i], y[i], z[i], radius[i], bounds))
+					out[hits++] = i;
+			}
+
+			return hits;
+		}
+
+#if defined(ULTREALITY_CLUSTERING_X86)
+		ULTREALITY_CLUSTERING_TARGET("sse2")
+		uint32_t OverlapSse(const float* x, const float* y, const float* z, const float* radius, uint32_t count, const float bounds[6], uint32_t* out)
+		{
+			const __m128 minX = _mm_set1_ps(bounds[0]);
+			const __m128 minY = _mm_set1_ps(bounds[1]);
+			const __m128 minZ = _mm_set1_ps(bounds[2]);
+			const __m128 maxX = _mm_set1_ps(bounds[3]);
+			const __m128 maxY = _mm_set1_ps(bounds[4]);
+			const __m128 maxZ = _mm_set1_ps(bounds[5]);
+			const __m128 zero = _mm_setzero_ps();
+
+			uint32_t hits = 0;
+			for (uint32_t i = 0; i < count; i += 4)
+			{
+				const __m128 cx = _mm_loadu_ps(x + i);
+				const __m128 cy = _mm_loadu_ps(y + i);
+				const __m128 cz = _mm_loadu_ps(z + i);
+				const __m128 r = _mm_loadu_ps(radius + i);
+
+				const __m128 dx = _mm_max_ps(_mm_max_ps(_mm_sub_ps(minX, cx), _mm_sub_ps(cx, maxX)), zero);
+				const __m128 dy = _mm_max_ps(_mm_max_ps(_mm_sub_ps(minY, cy), _mm_sub_ps(cy, maxY)), zero);
+				const __m128 dz = _mm_max_ps(_mm_max_ps(_mm_sub_ps(minZ, cz), _mm_sub_ps(cz, maxZ)), zero);
+
+				__m128 distance = _mm_mul_ps(dx, dx);
+				distance = _mm_add_ps(distance, _mm_mul_ps(dy, dy));
+				distance = _mm_add_ps(distance, _mm_mul_ps(dz, dz));
+
+				const uint32_t mask = static_cast<uint32_t>(_mm_movemask_ps(_mm_cmple_ps(distance, _mm_mul_ps(r, r))));
+				hits = EmitHits(mask, i, count, out, hits);
+			}
+
+			return hits;
+		}
+
+		ULTREALITY_CLUSTERING_TARGET("avx2")
+		uint32_t OverlapAvx2(const float* x, const float* y, const float* z, const float* radius, uint32_t count, const float bounds[6], uint32_t* out)
+		{
+			const __m256 minX = _mm256_set1_ps(bounds[0]);
+			const __m256 minY = _mm256_set1_ps(bounds[1]);
+			const __m256 minZ = _mm256_set1_ps(bounds[2]);
+			const __m256 maxX = _mm256_set1_ps(bounds[3]);
+			const __m256 maxY = _mm256_set1_ps(bounds[4]);
+			const __m256 maxZ = _mm256_set1_ps(bounds[5]);
+			const __m256 zero = _mm256_setzero_ps();
+
+			uint32_t hits = 0;
+			for (uint32_t i = 0; i < count; i += 8)
+			{
+				const __m256 cx = _mm256_loadu_ps(x + i);
+				const __m256 cy = _mm256_loadu_ps(y + i);
+				const __m256 cz = _mm256_loadu_ps(z + i);
+				const __m256 r = _mm256_loadu_ps(radius + i);
+
+				const __m256 dx = _mm256_max_ps(_mm256_max_ps(_mm256_sub_ps(minX, cx), _mm256_sub_ps(cx, maxX)), zero);
+				const __m256 dy = _mm256_max_ps(_mm256_max_ps(_mm256_sub_ps(minY, cy), _mm256_sub_ps(cy, maxY)), zero);
+				const __m256 dz = _mm256_max_ps(_mm256_max_ps(_mm256_sub_ps(minZ, cz), _mm256_sub_ps(cz, maxZ)), zero);
+
+				__m256 distance = _mm256_mul_ps(dx, dx);
+				distance = _mm256_add_ps(distance, _mm256_mul_ps(dy, dy));
+				distance = _mm256_add_ps(distance, _mm256_mul_ps(dz, dz));
+
+				const uint32_t mask = static_cast<uint32_t>(_mm256_movemask_ps(_mm256_cmp_ps(distance, _mm256_mul_ps(r, r), _CMP_LE_OQ)));
+				hits = EmitHits(mask, i, count, out, hits);
+			}
+
+			return hits;
+		}
+#endif // ULTREALITY_CLUSTERING_X86
+
+#if defined(ULTREALITY_CLUSTERING_NEON)
+		// NEON has no movemask, every lane contributes its bit through a shift by its lane index
+		inline uint32_t LaneMask(uint32x4_t lanes)
+		{
+			static const int32_t shifts[4] = { 0, 1, 2, 3 };
+			const uint32x4_t bits = vshlq_u32(vshrq_n_u32(lanes, 31), vld1q_s32(shifts));
+			return vgetq_lane_u32(bits, 0) | vgetq_lane_u32(bits, 1) | vgetq_lane_u32(bits, 2) | vgetq_lane_u32(bits, 3);
+		}
+
+		uint32_t OverlapNeon(const float* x, const float* y, const float* z, const float* radius, uint32_t count, const float bounds[6], uint32_t* out)
+		{
+			const float32x4_t minX = vdupq_n_f32(bounds[0]);
+			const float32x4_t minY = vdupq_n_f32(bounds[1]);
+			const float32x4_t minZ = vdupq_n_f32(bounds[2]);
+			const float32x4_t maxX = vdupq_n_f32(bounds[3]);
+			const float32x4_t maxY = vdupq_n_f32(bounds[4]);
+			const float32x4_t maxZ = vdupq_n_f32(bounds[5]);
+			const float32x4_t zero = vdupq_n_f32(0.0f);
+
+			uint32_t hits = 0;
+			for (uint32_t i = 0; i < count; i += 4)
+			{
+				const float32x4_t cx = vld1q_f32(x + i);
+				const float32x4_t cy = vld1q_f32(y + i);
+				const float32x4_t cz = vld1q_f32(z + i);
+				const float32x4_t r = vld1q_f32(radius + i);
+
+				const float32x4_t dx = vmaxq_f32(vmaxq_f32(vsubq_f32(minX, cx), vsubq_f32(cx, maxX)), zero);
+				const float32x4_t dy = vmaxq_f32(vmaxq_f32(vsubq_f32(minY, cy), vsubq_f32(cy, maxY)), zero);
+				const float32x4_t dz = vmaxq_f32(vmaxq_f32(vsubq_f32(minZ, cz), vsubq_f32(cz, maxZ)), zero);
+
+				// Separate multiplies and adds, vmlaq may be fused on some targets
+				float32x4_t distance = vmulq_f32(dx, dx);
+				distance = vaddq_f32(distance, vmulq_f32(dy, dy));
+				distance = vaddq_f32(distance, vmulq_f32(dz, dz));
+
+				hits = EmitHits(LaneMask(vcleq_f32(distance, vmulq_f32(r, r))), i, count, out, hits);
+			}
+
+			return hits;
+		}
+#endif // ULTREALITY_CLUSTERING_NEON
+
+		SphereBoundsKernel SelectKernel(CullingSimdPath path)
+		{
+			switch (path)
+			{
+#if defined(ULTREALITY_CLUSTERING_X86)
+			case CullingSimdPath::Avx2:
+				return OverlapAvx2;
+			case CullingSimdPath::Sse:
+				return OverlapSse;
+#endif
+#if defined(ULTREALITY_CLUSTERING_NEON)
+			case CullingSimdPath::Neon:
+				return OverlapNeon;
+#endif
+			default:
+				return OverlapScalar;
+			}
+		}
+
+		void ValidateGrid(const ClusterGridSettings& grid)
+		{
+			if (grid.tilesX == 0 || grid.tilesY == 0 || grid.depthSlices == 0)
+				throw std::invalid_argument("Cluster grid must not be empty");
+
+			const uint64_t clusterCount = static_cast<uint64_t>(grid.tilesX) * grid.tilesY * grid.depthSlices;
+			if (clusterCount > ClusteredLightBinner::maxClusterCount)
+				throw std::invalid_argument("Cluster grid exceeds maxClusterCount clusters");
+		}
+
+		// Grows bounds to include other bounds
+		void MergeBounds(float bounds[6], const float other[6])
+		{
+			for (uint32_t axis = 0; axis < 3; axis++)
+			{
+				bounds[axis] = std::min(bounds[axis], other[axis]);
+				bounds[axis + 3] = std::max(bounds[axis + 3], other[axis + 3]);
+			}
+		}
+	}
+
+	void BinClusterLightsReference(const ClusteredLightBinner& binner, const BoundingSphereSoA& lights, std::vector<ClusterLightRange>& clusters, std::vector<uint32_t>& lightIndices)
+	{
+		const uint32_t clusterCount = binner.GetClusterCount();
+		clusters.assign(clusterCount, ClusterLightRange());
+		lightIndices.clear();
+
+		for (uint32_t cluster = 0; cluster < clusterCount; cluster++)
+		{
+			float bounds[6];
+			binner.GetClusterBounds(cluster, bounds, bounds + 3);
+
+			clusters[cluster].offset = static_cast<uint32_t>(lightIndices.size());
+			for (uint32_t light = 0; light < lights.Size(); light++)
+			{
+				if (SphereOverlapsBounds(lights.CenterX()[light], lights.CenterY()[light], lights.CenterZ()[light], lights.Radius()[light], bounds))
+					lightIndices.push_back(light);
+			}
+			clusters[cluster].count = static_cast<uint32_t>(lightIndices.size()) - clusters[cluster].offset;
+		}
+	}
+
+	ClusteredLightBinner::ClusteredLightBinner(JobSystem* jobSystem, const ClusterGridSettings& grid)
+		: m_jobSystem(jobSystem), m_simdPath(FrustumCuller::DetectSimdPath())
+	{
+		SetGrid(grid);
+	}
+
+	void ClusteredLightBinner::SetGrid(const ClusterGridSettings& grid)
+	{
+		ValidateGrid(grid);
+
+		m_grid = grid;
+		m_clusterBounds.clear();
+		m_rowBounds.clear();
+		m_sliceBounds.clear();
+		m_sliceBins.resize(grid.depthSlices);
+	}
+
+	const ClusterGridSettings& ClusteredLightBinner::GetGrid() const
+	{
+		return m_grid;
+	}
+
+	void ClusteredLightBinner::SetProjection(float verticalFov, float aspectRatio, float nearZ, float farZ)
+	{
+		if (!(verticalFov > 0.0f && verticalFov < 3.14159265f) || !(aspectRatio > 0.0f))
+			throw std::invalid_argument("Cluster projection needs a field of view in (0, pi) and a positive aspect ratio");
+		if (!(nearZ > 0.0f) || !(farZ > nearZ))
+			throw std::invalid_argument("Cluster projection needs 0 < near < far");
+
+		const float tanY = std::tan(verticalFov * 0.5f);
+		const float tanX = tanY * aspectRatio;
+		const uint32_t tilesPerSlice = m_grid.tilesX * m_grid.tilesY;
+
+		m_nearZ = nearZ;
+		m_farZ = farZ;
+		const float depthRatio = std::log2(farZ / nearZ);
+		m_sliceScale = static_cast<float>(m_grid.depthSlices) / depthRatio;
+		m_sliceBias = -static_cast<float>(m_grid.depthSlices) * std::log2(nearZ) / depthRatio;
+
+		m_clusterBounds.resize(static_cast<size_t>(tilesPerSlice) * m_grid.depthSlices * s_boundsStride);
+		m_rowBounds.resize(static_cast<size_t>(m_grid.tilesY) * m_grid.depthSlices * s_boundsStride);
+		m_sliceBounds.resize(static_cast<size_t>(m_grid.depthSlices) * s_boundsStride);
+
+		for (uint32_t slice = 0; slice < m_grid.depthSlices; slice++)
+		{
+			// Exponential slices keep clusters roughly cubic, the last one ends exactly on the far plane
+			const float sliceNear = slice == 0 ? nearZ : nearZ * std::pow(farZ / nearZ, static_cast<float>(slice) / static_cast<float>(m_grid.depthSlices));
+			const float sliceFar = slice + 1 == m_grid.depthSlices ? farZ : nearZ * std::pow(farZ / nearZ, static_cast<float>(slice + 1) / static_cast<float>(m_grid.depthSlices));
+
+			float* sliceBounds = m_sliceBounds.data() + static_cast<size_t>(slice) * s_boundsStride;
+			for (uint32_t y = 0; y < m_grid.tilesY; y++)
+			{
+				// Tile rows run top to bottom like the viewport
+				const float ndcTop = 1.0f - 2.0f * static_cast<float>(y) / static_cast<float>(m_grid.tilesY);
+				const float ndcBottom = 1.0f - 2.0f * static_cast<float>(y + 1) / static_cast<float>(m_grid.tilesY);
+
+				float* rowBounds = m_rowBounds.data() + (static_cast<size_t>(slice) * m_grid.tilesY + y) * s_boundsStride;
+				for (uint32_t x = 0; x < m_grid.tilesX; x++)
+				{
+					const float ndcLeft = -1.0f + 2.0f * static_cast<float>(x) / static_cast<float>(m_grid.tilesX);
+					const float ndcRight = -1.0f + 2.0f * static_cast<float>(x + 1) / static_cast<float>(m_grid.tilesX);
+
+					// The tile's frustum is bounded by its four edge rays cut at both ends of the slice
+					float* bounds = m_clusterBounds.data() + ((static_cast<size_t>(slice) * m_grid.tilesY + y) * m_grid.tilesX + x) * s_boundsStride;
+					const float corners[4] = { ndcLeft * tanX * sliceNear, ndcRight * tanX * sliceNear, ndcLeft * tanX * sliceFar, ndcRight * tanX * sliceFar };
+					const float cornersY[4] = { ndcBottom * tanY * sliceNear, ndcTop * tanY * sliceNear, ndcBottom * tanY * sliceFar, ndcTop * tanY * sliceFar };
+					bounds[0] = *std::min_element(corners, corners + 4);
+					bounds[3] = *std::max_element(corners, corners + 4);
+					bounds[1] = *std::min_element(cornersY, cornersY + 4);
+					bounds[4] = *std::max_element(cornersY, cornersY + 4);
+					bounds[2] = sliceNear;
+					bounds[5] = sliceFar;
+
+					if (x == 0)
+						std::copy(bounds, bounds + s_boundsStride, rowBounds);
+					else
+						MergeBounds(rowBounds, bounds);
+				}
+
+				if (y == 0)
+					std::copy(rowBounds, rowBounds + s_boundsStride, sliceBounds);
+				else
+					MergeBounds(sliceBounds, rowBounds);
+			}
+		}
+	}
+
+	void ClusteredLightBinner::BinSlice(uint32_t slice, const BoundingSphereSoA& lights)
+	{
+		const SphereBoundsKernel kernel = SelectKernel(m_simdPath);
+		SliceBins& bins = m_sliceBins[slice];
+
+		const uint32_t lightCount = lights.Size();
+		const uint32_t tilesPerSlice = m_grid.tilesX * m_grid.tilesY;
+		bins.hits.resize(PaddedSize(lightCount));
+		bins.clusterCounts.assign(tilesPerSlice, 0);
+		bins.lightIndices.clear();
+
+		// Copies the hit lights of one level into the candidates of the next, padded so every SIMD load stays inside
+		auto gather = [&bins](Candidates& target, const float* x, const float* y, const float* z, const float* radius, const uint32_t* lightIndex, uint32_t hitCount)
+		{
+			const uint32_t padded = PaddedSize(hitCount);
+			target.x.resize(padded);
+			target.y.resize(padded);
+			target.z.resize(padded);
+			target.radius.resize(padded);
+			target.lightIndex.resize(padded);
+			target.count = hitCount;
+
+			for (uint32_t i = 0; i < hitCount; i++)
+			{
+				const uint32_t source = bins.hits[i];
+				target.x[i] = x[source];
+				target.y[i] = y[source];
+				target.z[i] = z[source];
+				target.radius[i] = radius[source];
+				target.lightIndex[i] = lightIndex != nullptr ? lightIndex[source] : source;
+			}
+		};
+
+		const float* sliceBounds = m_sliceBounds.data() + static_cast<size_t>(slice) * s_boundsStride;
+		uint32_t hitCount = kernel(lights.CenterX(), lights.CenterY(), lights.CenterZ(), lights.Radius(), lightCount, sliceBounds, bins.hits.data());
+		gather(bins.slice, lights.CenterX(), lights.CenterY(), lights.CenterZ(), lights.Radius(), nullptr, hitCount);
+
+		for (uint32_t y = 0; y < m_grid.tilesY && bins.slice.count > 0; y++)
+		{
+			const float* rowBounds = m_rowBounds.data() + (static_cast<size_t>(slice) * m_grid.tilesY + y) * s_boundsStride;
+			hitCount = kernel(bins.slice.x.data(), bins.slice.y.data(), bins.slice.z.data(), bins.slice.radius.data(), bins.slice.count, rowBounds, bins.hits.data());
+			gather(bins.row, bins.slice.x.data(), bins.slice.y.data(), bins.slice.z.data(), bins.slice.radius.data(), bins.slice.lightIndex.data(), hitCount);
+
+			for (uint32_t x = 0; x < m_grid.tilesX && bins.row.count > 0; x++)
+			{
+				const size_t cluster = (static_cast<size_t>(slice) * m_grid.tilesY + y) * m_grid.tilesX + x;
+				hitCount = kernel(bins.row.x.data(), bins.row.y.data(), bins.row.z.data(), bins.row.radius.data(), bins.row.count,
+					m_clusterBounds.data() + cluster * s_boundsStride, bins.hits.data());
+
+				// Hits come in candidate order, which keeps the light indices ascending
+				for (uint32_t i = 0; i < hitCount; i++)
+					bins.lightIndices.push_back(bins.row.lightIndex[bins.hits[i]]);
+				bins.clusterCounts[y * m_grid.tilesX + x] = hitCount;
+			}
+		}
+	}
+
+	void ClusteredLightBinner::Bin(const BoundingSphereSoA& lights, std::vector<ClusterLightRange>& clusters, std::vector<uint32_t>& lightIndices)
+	{
+		if (m_clusterBounds.empty())
+			throw std::logic_error("Cluster projection must be set before binning lights");
+
+		const auto start = std::chrono::steady_clock::now();
+
+		const uint32_t sliceCount = m_grid.depthSlices;
+		if (m_jobSystem != nullptr && sliceCount > 1)
+		{
+			JobCounter counter;
+			m_jobSystem->Dispatch(sliceCount, 1, [this, &lights](uint32_t first, uint32_t last, uint32_t)
+			{
+				for (uint32_t slice = first; slice < last; slice++)
+					BinSlice(slice, lights);
+			}, counter);
+			m_jobSystem->Wait(counter);
+		}
+		else
+		{
+			for (uint32_t slice = 0; slice < sliceCount; slice++)
+				BinSlice(slice, lights);
+		}
+
+		// Slices hold consecutive clusters, so their lists are concatenated in slice order
+		const uint32_t tilesPerSlice = m_grid.tilesX * m_grid.tilesY;
+		clusters.resize(GetClusterCount());
+		lightIndices.clear();
+		uint32_t maxLightsPerCluster = 0;
+		for (uint32_t slice = 0; slice < sliceCount; slice++)
+		{
+			const SliceBins& bins = m_sliceBins[slice];
+			uint32_t offset = static_cast<uint32_t>(lightIndices.size());
+			for (uint32_t tile = 0; tile < tilesPerSlice; tile++)
+			{
+				const uint32_t count = bins.clusterCounts[tile];
+				clusters[slice * tilesPerSlice + tile] = ClusterLightRange{ offset, count };
+				offset += count;
+				maxLightsPerCluster = std::max(maxLightsPerCluster, count);
+			}
+
+			lightIndices.insert(lightIndices.end(), bins.lightIndices.begin(), bins.lightIndices.end());
+		}
+
+		m_statistics.lightCount = lights.Size();
+		m_statistics.clusterCount = GetClusterCount();
+		m_statistics.indexCount = static_cast<uint32_t>(lightIndices.size());
+		m_statistics.maxLightsPerCluster = maxLightsPerCluster;
+		m_statistics.milliseconds = std::chrono::duration<float, std::milli>(std::chrono::steady_clock::now() - start).count();
+	}
+
+	uint32_t ClusteredLightBinner::GetClusterCount() const
+	{
+		return m_grid.tilesX * m_grid.tilesY * m_grid.depthSlices;
+	}
+
+	void ClusteredLightBinner::GetClusterBounds(uint32_t cluster, float min[3], float max[3]) const
+	{
+		if (static_cast<size_t>(cluster) * s_boundsStride >= m_clusterBounds.size())
+			throw std::out_of_range("Cluster index out of range or no projection set");
+
+		const float* bounds = m_clusterBounds.data() + static_cast<size_t>(cluster) * s_boundsStride;
+		std::copy(bounds, bounds + 3, min);
+		std::copy(bounds + 3, bounds + 6, max);
+	}
+
+	uint32_t ClusteredLightBinner::GetDepthSlice(float viewZ) const
+	{
+		if (!(viewZ > m_nearZ))
+			return 0;
+
+		const float slice = std::floor(std::log2(viewZ) * m_sliceScale + m_sliceBias);
+		return static_cast<uint32_t>(std::clamp(slice, 0.0f, static_cast<float>(m_grid.depthSlices - 1)));
+	}
+
+	ClusterShaderConstants ClusteredLightBinner::GetShaderConstants(uint32_t lightCount) const
+	{
+		ClusterShaderConstants constants;
+		constants.tilesX = m_grid.tilesX;
+		constants.tilesY = m_grid.tilesY;
+		constants.depthSlices = m_grid.depthSlices;
+		constants.lightCount = lightCount;
+		constants.sliceScale = m_sliceScale;
+		constants.sliceBias = m_sliceBias;
+
+		return constants;
+	}
+
+	CullingSimdPath ClusteredLightBinner::GetSimdPath() const
+	{
+		return m_simdPath;
+	}
+
+	void ClusteredLightBinner::SetSimdPath(CullingSimdPath path)
+	{
+		if (!FrustumCuller::IsSimdPathSupported(path))
+			throw std::invalid_argument("Culling SIMD path is not supported by this build or CPU");
+
+		m_simdPath = path;
+	}
+
+	const ClusteredLightBinner::Statistics& ClusteredLightBinner::GetStatistics() const
+	{
+		return m_statistics;
+	}
+}
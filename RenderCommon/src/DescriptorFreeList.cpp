@@ -0,0 +1,117 @@
+#include <DescriptorFreeList.h>
+
+#include <iterator>
+#include <stdexcept>
+
+namespace UltReality::Rendering::Common
+{
+	DescriptorFreeList::DescriptorFreeList(IDescriptorPageFactory* factory, uint32_t pageSize)
+		: m_factory(factory), m_pageSize(pageSize)
+	{
+		if (factory == nullptr)
+			throw std::invalid_argument("DescriptorFreeList requires a page factory");
+
+		if (pageSize == 0)
+			throw std::invalid_argument("DescriptorFreeList page size must be non-zero");
+	}
+
+	DescriptorRange DescriptorFreeList::AllocateFromPage(uint32_t page, uint32_t count)
+	{
+		auto& freeRanges = m_freeRanges[page];
+		for (auto it = freeRanges.begin(); it != freeRanges.end(); ++it)
+		{
+			if (it->second < count)
+				continue;
+
+			DescriptorRange range;
+			range.page = page;
+			range.offset = it->first;
+			range.count = count;
+
+			// Keep whatever is left of the free range after the allocation
+			const uint32_t remaining = it->second - count;
+			const uint32_t remainingOffset = it->first + count;
+			freeRanges.erase(it);
+			if (remaining > 0)
+				freeRanges.emplace(remainingOffset, remaining);
+
+			m_allocatedCount += count;
+			return range;
+		}
+
+		return DescriptorRange();
+	}
+
+	DescriptorRange DescriptorFreeList::Allocate(uint32_t count)
+	{
+		if (count == 0 || count > m_pageSize)
+			throw std::out_of_range("DescriptorFreeList allocation must be between 1 and the page size");
+
+		for (uint32_t page = 0; page < m_freeRanges.size(); page++)
+		{
+			DescriptorRange range = AllocateFromPage(page, count);
+			if (range.IsValid())
+				return range;
+		}
+
+		// Every page is too full, grow by one
+		const uint32_t newPage = static_cast<uint32_t>(m_freeRanges.size());
+		m_factory->CreatePage(newPage, m_pageSize);
+
+		m_freeRanges.emplace_back();
+		m_freeRanges.back().emplace(0, m_pageSize);
+
+		return AllocateFromPage(newPage, count);
+	}
+
+	void DescriptorFreeList::Free(const DescriptorRange& range)
+	{
+		if (!range.IsValid())
+			return;
+
+		if (range.page >= m_freeRanges.size() || range.offset + range.count > m_pageSize)
+			throw std::out_of_range("DescriptorFreeList::Free called with a range that does not belong to this list");
+
+		auto& freeRanges = m_freeRanges[range.page];
+		uint32_t offset = range.offset;
+		uint32_t count = range.count;
+
+		// Coalesce with the following free range
+		auto next = freeRanges.lower_bound(offset);
+		if (next != freeRanges.end() && next->first == offset + count)
+		{
+			count += next->second;
+			next = freeRanges.erase(next);
+		}
+
+		// Coalesce with the preceding free range
+		if (next != freeRanges.begin())
+		{
+			auto prev = std::prev(next);
+			if (prev->first + prev->second == offset)
+			{
+				offset = prev->first;
+				count += prev->second;
+				freeRanges.erase(prev);
+			}
+		}
+
+		freeRanges.emplace(offset, count);
+		m_allocatedCount -= range.count;
+	}
+
+	uint32_t DescriptorFreeList::GetPageCount() const
+	{
+		return static_cast<uint32_t>(m_freeRanges.size());
+	}
+
+	uint32_t DescriptorFreeList::GetPageSize() const
+	{
+		return m_pageSize;
+	}
+
+	uint32_t DescriptorFreeList::GetAllocatedCount() const
+	{
+		return m_allocatedCount;
+	}
+}
@@ -0,0 +1,213 @@
+#include <DrawSortKey.h>
+#include <JobSystem.h>
+
+#include <algorithm>
+#include <chrono>
+#include <numeric>
+#include <stdexcept>
+
+namespace UltReality::Rendering::Common
+{
+	namespace
+	{
+		constexpr uint32_t s_passShift = 58;
+		constexpr uint32_t s_layerShift = 56;
+		constexpr uint64_t s_depthMask = (1ull << drawSortDepthBits) - 1;
+		constexpr uint64_t s_stateIdMask = maxDrawStateIds - 1;
+
+		bool IsBackToFront(DrawLayer layer)
+		{
+			return layer == DrawLayer::Transparent || layer == DrawLayer::Overlay;
+		}
+
+		uint64_t QuantizeDepth(float depth)
+		{
+			// Also maps NaN to the near plane
+			if (!(depth > 0.0f))
+				return 0;
+			if (depth >= 1.0f)
+				return s_depthMask;
+
+			return static_cast<uint64_t>(depth * static_cast<float>(s_depthMask) + 0.5f);
+		}
+	}
+
+	uint64_t EncodeDrawSortKey(const DrawSortKeyFields& fields)
+	{
+		if (fields.pass >= maxDrawPasses)
+			throw std::invalid_argument("Draw pass exceeds the bits of the sort key");
+		if (fields.pipeline >= maxDrawStateIds || fields.material >= maxDrawStateIds)
+			throw std::invalid_argument("Draw pipeline or material identifier exceeds the bits of the sort key");
+
+		uint64_t key = static_cast<uint64_t>(fields.pass) << s_passShift;
+		key |= static_cast<uint64_t>(fields.layer) << s_layerShift;
+
+		const uint64_t depth = QuantizeDepth(fields.depth);
+		if (IsBackToFront(fields.layer))
+		{
+			// Blending needs the far draws first, state only breaks depth ties
+			key |= (s_depthMask - depth) << 32;
+			key |= static_cast<uint64_t>(fields.pipeline) << 16;
+			key |= fields.material;
+		}
+		else
+		{
+			// Pipelines are the most expensive to switch, depth only orders draws sharing all state
+			key |= static_cast<uint64_t>(fields.pipeline) << 40;
+			key |= static_cast<uint64_t>(fields.material) << drawSortDepthBits;
+			key |= depth;
+		}
+
+		return key;
+	}
+
+	DrawSortKeyFields DecodeDrawSortKey(uint64_t key)
+	{
+		DrawSortKeyFields fields;
+		fields.pass = static_cast<uint32_t>(key >> s_passShift);
+		fields.layer = static_cast<DrawLayer>((key >> s_layerShift) & 3);
+
+		uint64_t depth;
+		if (IsBackToFront(fields.layer))
+		{
+			depth = s_depthMask - ((key >> 32) & s_depthMask);
+			fields.pipeline = static_cast<uint32_t>((key >> 16) & s_stateIdMask);
+			fields.material = static_cast<uint32_t>(key & s_stateIdMask);
+		}
+		else
+		{
+			fields.pipeline = static_cast<uint32_t>((key >> 40) & s_stateIdMask);
+			fields.material = static_cast<uint32_t>((key >> drawSortDepthBits) & s_stateIdMask);
+			depth = key & s_depthMask;
+		}
+
+		fields.depth = static_cast<float>(depth) / static_cast<float>(s_depthMask);
+		return fields;
+	}
+
+	uint64_t DrawSortKeyState(uint64_t key)
+	{
+		const DrawLayer layer = static_cast<DrawLayer>((key >> s_layerShift) & 3);
+		return IsBackToFront(layer) ? key & ~(s_depthMask << 32) : key & ~s_depthMask;
+	}
+
+	uint32_t CountDrawStateChanges(const std::vector<uint64_t>& keys, const uint32_t* order)
+	{
+		uint32_t changes = 0;
+		for (size_t i = 1; i < keys.size(); i++)
+		{
+			const uint64_t previous = keys[order != nullptr ? order[i - 1] : i - 1];
+			const uint64_t current = keys[order != nullptr ? order[i] : i];
+			if (DrawSortKeyState(previous) != DrawSortKeyState(current))
+				changes++;
+		}
+
+		return changes;
+	}
+
+	DrawKeySorter::DrawKeySorter(JobSystem* jobSystem, uint32_t keysPerJob)
+		: m_jobSystem(jobSystem), m_keysPerJob(std::max(keysPerJob, 1u))
+	{
+	}
+
+	void DrawKeySorter::Sort(const std::vector<uint64_t>& keys, std::vector<uint32_t>& order)
+	{
+		const auto start = std::chrono::steady_clock::now();
+
+		const uint32_t count = static_cast<uint32_t>(keys.size());
+		const uint32_t chunkCount = (count + m_keysPerJob - 1) / m_keysPerJob;
+
+		for (uint32_t buffer = 0; buffer < 2; buffer++)
+		{
+			m_keys[buffer].resize(count);
+			m_indices[buffer].resize(count);
+		}
+		std::copy(keys.begin(), keys.end(), m_keys[0].begin());
+		std::iota(m_indices[0].begin(), m_indices[0].end(), 0u);
+		m_chunkHistograms.resize(static_cast<size_t>(chunkCount) * s_radix);
+
+		auto forEachChunk = [this, count, chunkCount](auto&& chunkFunction)
+		{
+			if (m_jobSystem != nullptr && chunkCount > 1)
+			{
+				JobCounter counter;
+				m_jobSystem->Dispatch(count, m_keysPerJob, [this, &chunkFunction](uint32_t first, uint32_t last, uint32_t)
+				{
+					chunkFunction(first / m_keysPerJob, first, last);
+				}, counter);
+				m_jobSystem->Wait(counter);
+			}
+			else
+			{
+				for (uint32_t first = 0; first < count; first += m_keysPerJob)
+					chunkFunction(first / m_keysPerJob, first, std::min(first + m_keysPerJob, count));
+			}
+		};
+
+		// Bytes every key agrees on would leave the order unchanged
+		uint64_t differingBits = 0;
+		for (uint32_t i = 1; i < count; i++)
+			differingBits |= keys[i] ^ keys[0];
+
+		uint32_t source = 0;
+		uint32_t passCount = 0;
+		for (uint32_t shift = 0; shift < 64; shift += 8)
+		{
+			if (((differingBits >> shift) & 0xFF) == 0)
+				continue;
+
+			const uint64_t* sourceKeys = m_keys[source].data();
+			const uint32_t* sourceIndices = m_indices[source].data();
+			uint64_t* destinationKeys = m_keys[source ^ 1].data();
+			uint32_t* destinationIndices = m_indices[source ^ 1].data();
+
+			forEachChunk([this, shift, sourceKeys](uint32_t chunk, uint32_t first, uint32_t last)
+			{
+				uint32_t* histogram = m_chunkHistograms.data() + static_cast<size_t>(chunk) * s_radix;
+				std::fill_n(histogram, s_radix, 0u);
+				for (uint32_t i = first; i < last; i++)
+					histogram[(sourceKeys[i] >> shift) & 0xFF]++;
+			});
+
+			// Digit major, chunk minor, so every chunk scatters behind the chunks before it and the sort stays stable
+			uint32_t offset = 0;
+			for (uint32_t digit = 0; digit < s_radix; digit++)
+			{
+				for (uint32_t chunk = 0; chunk < chunkCount; chunk++)
+				{
+					uint32_t& slot = m_chunkHistograms[static_cast<size_t>(chunk) * s_radix + digit];
+					const uint32_t digitCount = slot;
+					slot = offset;
+					offset += digitCount;
+				}
+			}
+
+			forEachChunk([this, shift, sourceKeys, sourceIndices, destinationKeys, destinationIndices](uint32_t chunk, uint32_t first, uint32_t last)
+			{
+				uint32_t* offsets = m_chunkHistograms.data() + static_cast<size_t>(chunk) * s_radix;
+				for (uint32_t i = first; i < last; i++)
+				{
+					const uint32_t position = offsets[(sourceKeys[i] >> shift) & 0xFF]++;
+					destinationKeys[position] = sourceKeys[i];
+					destinationIndices[position] = sourceIndices[i];
+				}
+			});
+
+			source ^= 1;
+			passCount++;
+		}
+
+		order.assign(m_indices[source].begin(), m_indices[source].end());
+
+		m_statistics.keyCount = count;
+		m_statistics.passCount = passCount;
+		m_statistics.milliseconds = std::chrono::duration<float, std::milli>(std::chrono::steady_clock::now() - start).count();
+		m_statistics.submittedStateChanges = CountDrawStateChanges(keys);
+		m_statistics.sortedStateChanges = CountDrawStateChanges(m_keys[source]);
+	}
+
+	const DrawKeySorter::Statistics& DrawKeySorter::GetStatistics() const
+	{
+		return m_statistics;
+	}
+}
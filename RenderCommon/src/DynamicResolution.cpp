@@ -0,0 +1,100 @@
+#include <DynamicResolution.h>
+
+#include <algorithm>
+#include <cmath>
+#include <stdexcept>
+
+namespace UltReality::Rendering::Common
+{
+	namespace
+	{
+		// The controller output is the log2 of the pixel fraction, twice the log2 of the scale of each axis
+		float ScaleToOutput(float scale)
+		{
+			return 2.0f * std::log2(scale);
+		}
+	}
+
+	DynamicResolutionController::DynamicResolutionController(const DynamicResolutionConfig& config)
+	{
+		SetConfig(config);
+	}
+
+	void DynamicResolutionController::SetConfig(const DynamicResolutionConfig& config)
+	{
+		if (!(config.targetFrameMilliseconds > 0.0f))
+			throw std::invalid_argument("Dynamic resolution needs a positive frame budget");
+		if (!(config.minScale > 0.0f) || !(config.minScale <= config.maxScale) || !(config.maxScale <= 1.0f))
+			throw std::invalid_argument("Dynamic resolution scales must satisfy 0 < minScale <= maxScale <= 1");
+		if (!(config.integralGain > 0.0f) || !(config.proportionalGain >= 0.0f) || !(config.derivativeGain >= 0.0f))
+			throw std::invalid_argument("Dynamic resolution needs a positive integral gain and non-negative other gains");
+		if (!(config.deadbandStops >= 0.0f) || !(config.scaleStep >= 0.0f))
+			throw std::invalid_argument("Dynamic resolution deadband and scale step must not be negative");
+
+		m_config = config;
+		Reset();
+	}
+
+	const DynamicResolutionConfig& DynamicResolutionController::GetConfig() const
+	{
+		return m_config;
+	}
+
+	float DynamicResolutionController::Update(float gpuFrameMilliseconds)
+	{
+		if (!(gpuFrameMilliseconds > 0.0f))
+			return m_scale;
+
+		const float minOutput = ScaleToOutput(m_config.minScale);
+		const float maxOutput = ScaleToOutput(m_config.maxScale);
+
+		float error = std::log2(m_config.targetFrameMilliseconds / gpuFrameMilliseconds);
+		if (std::abs(error) <= m_config.deadbandStops)
+			error = 0.0f;
+
+		// Clamping the integral to what the bounds can use keeps it from winding up while the scale is saturated
+		m_integral = std::clamp(m_integral + error, minOutput / m_config.integralGain, maxOutput / m_config.integralGain);
+		const float derivative = m_hasPreviousError ? error - m_previousError : 0.0f;
+		m_previousError = error;
+		m_hasPreviousError = true;
+
+		const float output = std::clamp(
+			m_config.proportionalGain * error + m_config.integralGain * m_integral + m_config.derivativeGain * derivative,
+			minOutput, maxOutput);
+
+		// The rounded scale only moves once the output is a whole step away from it. Rounding alone would flip between
+		// neighboring steps whenever the budget falls between them
+		const float scale = std::exp2(0.5f * output);
+		if (m_config.scaleStep <= 0.0f)
+			m_scale = std::clamp(scale, m_config.minScale, m_config.maxScale);
+		else if (std::abs(scale - m_scale) >= m_config.scaleStep || scale <= m_config.minScale || scale >= m_config.maxScale)
+			m_scale = std::clamp(std::round(scale / m_config.scaleStep) * m_config.scaleStep, m_config.minScale, m_config.maxScale);
+		m_updateCount++;
+
+		return m_scale;
+	}
+
+	float DynamicResolutionController::GetScale() const
+	{
+		return m_scale;
+	}
+
+	uint64_t DynamicResolutionController::GetUpdateCount() const
+	{
+		return m_updateCount;
+	}
+
+	void DynamicResolutionController::Reset()
+	{
+		m_integral = ScaleToOutput(m_config.maxScale) / m_config.integralGain;
+		m_previousError = 0.0f;
+		m_hasPreviousError = false;
+		m_scale = m_config.maxScale;
+		m_updateCount = 0;
+	}
+
+	uint32_t DynamicResolutionController::ScaleSize(uint32_t size, float scale)
+	{
+		return std::max(static_cast<uint32_t>(std::lround(static_cast<double>(size) * scale)), 1u);
+	}
+}
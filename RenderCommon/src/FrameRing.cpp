@@ -0,0 +1,57 @@
+#include <FrameRing.h>
+
+#include <stdexcept>
+
+namespace UltReality::Rendering::Common
+{
+	FrameRing::FrameRing(IFenceTimeline* timeline, uint32_t framesInFlight)
+		: m_timeline(timeline), m_framesInFlight(framesInFlight)
+	{
+		if (timeline == nullptr)
+			throw std::invalid_argument("FrameRing requires a fence timeline");
+
+		if (framesInFlight == 0 || framesInFlight > maxFramesInFlight)
+			throw std::out_of_range("FrameRing frame count must be in [1, maxFramesInFlight]");
+	}
+
+	uint32_t FrameRing::BeginFrame()
+	{
+		// Only block when the GPU is still working on the frame that previously used this slot
+		const uint64_t slotFence = m_frameFenceValues[m_frameIndex];
+		if (slotFence != 0 && m_timeline->GetCompletedValue() < slotFence)
+		{
+			++m_stallCount;
+			m_timeline->WaitForValue(slotFence);
+		}
+
+		return m_frameIndex;
+	}
+
+	uint64_t FrameRing::EndFrame()
+	{
+		const uint64_t fenceValue = m_timeline->Signal();
+		m_frameFenceValues[m_frameIndex] = fenceValue;
+
+		m_frameIndex = (m_frameIndex + 1) % m_framesInFlight;
+
+		return fenceValue;
+	}
+
+	void FrameRing::WaitForIdle()
+	{
+		m_timeline->WaitForValue(m_timeline->Signal());
+	}
+
+	void FrameRing::Resize(uint32_t framesInFlight)
+	{
+		if (framesInFlight == 0 || framesInFlight > maxFramesInFlight)
+			throw std::out_of_range("FrameRing frame count must be in [1, maxFramesInFlight]");
+
+		WaitForIdle();
+
+		// Every slot is retired after the wait, so the old fence values can be dropped
+		m_frameFenceValues.fill(0);
+		m_framesInFlight = framesInFlight;
+		m_frameIndex = 0;
+	}
+}
@@ -0,0 +1,163 @@
+#include <FrameTimingStats.h>
+
+#include <algorithm>
+#include <cmath>
+
+namespace UltReality::Rendering::Common
+{
+	namespace
+	{
+		// Weight of the newest interval in the running average hitches are measured against
+		constexpr float s_averageWeight = 0.1f;
+		// Frames recorded before hitches are counted, the running average is meaningless before that
+		constexpr uint64_t s_hitchWarmupFrames = 8;
+
+		FrameTimingDistribution Distribute(std::array<float, FrameTimingStats::capacity>& values, uint32_t count)
+		{
+			FrameTimingDistribution distribution;
+			if (count == 0)
+				return distribution;
+
+			double sum = 0.0;
+			for (uint32_t i = 0; i < count; i++)
+				sum += values[i];
+
+			std::sort(values.begin(), values.begin() + count);
+
+			// Nearest rank percentile
+			auto percentile = [&](double p)
+			{
+				const uint32_t rank = static_cast<uint32_t>(std::ceil(p * count));
+				return static_cast<double>(values[std::clamp<uint32_t>(rank, 1, count) - 1]);
+			};
+
+			distribution.mean = sum / count;
+			distribution.p50 = percentile(0.50);
+			distribution.p95 = percentile(0.95);
+			distribution.p99 = percentile(0.99);
+			distribution.max = values[count - 1];
+
+			return distribution;
+		}
+	}
+
+	bool FrameTimingStats::Record(const FrameTimingSample& sample)
+	{
+		const uint64_t frame = m_frameCount.load(std::memory_order_relaxed);
+		Slot& slot = m_slots[frame % capacity];
+
+		// Readers that see the cleared sequence, or a different one after copying, drop the slot
+		slot.sequence.store(0, std::memory_order_relaxed);
+		std::atomic_thread_fence(std::memory_order_release);
+
+		slot.cpuFrameMilliseconds.store(sample.cpuFrameMilliseconds, std::memory_order_relaxed);
+		slot.fenceWaitMilliseconds.store(sample.fenceWaitMilliseconds, std::memory_order_relaxed);
+		slot.presentIntervalMilliseconds.store(sample.presentIntervalMilliseconds, std::memory_order_relaxed);
+
+		slot.sequence.store(frame + 1, std::memory_order_release);
+		m_frameCount.store(frame + 1, std::memory_order_release);
+
+		// The first present has no previous one to measure against
+		const float interval = sample.presentIntervalMilliseconds;
+		if (interval <= 0.0f)
+			return false;
+
+		const bool hitch = frame >= s_hitchWarmupFrames && interval > std::max(m_hitchFloorMilliseconds, m_hitchFactor * m_averageInterval);
+		if (hitch)
+			m_hitchCount.fetch_add(1, std::memory_order_relaxed);
+
+		m_averageInterval = m_averageInterval > 0.0f ? m_averageInterval + s_averageWeight * (interval - m_averageInterval) : interval;
+
+		return hitch;
+	}
+
+	uint32_t FrameTimingStats::CopySamples(std::array<FrameTimingSample, capacity>& samples) const
+	{
+		const uint64_t frameCount = m_frameCount.load(std::memory_order_acquire);
+		const uint64_t first = frameCount > capacity ? frameCount - capacity : 0;
+
+		uint32_t count = 0;
+		for (uint64_t frame = first; frame < frameCount; frame++)
+		{
+			const Slot& slot = m_slots[frame % capacity];
+
+			const uint64_t before = slot.sequence.load(std::memory_order_acquire);
+			FrameTimingSample sample;
+			sample.cpuFrameMilliseconds = slot.cpuFrameMilliseconds.load(std::memory_order_relaxed);
+			sample.fenceWaitMilliseconds = slot.fenceWaitMilliseconds.load(std::memory_order_relaxed);
+			sample.presentIntervalMilliseconds = slot.presentIntervalMilliseconds.load(std::memory_order_relaxed);
+			std::atomic_thread_fence(std::memory_order_acquire);
+			const uint64_t after = slot.sequence.load(std::memory_order_relaxed);
+
+			// Overwritten by a newer frame while it was copied
+			if (before != frame + 1 || after != before)
+				continue;
+
+			samples[count++] = sample;
+		}
+
+		return count;
+	}
+
+	FrameTimingSummary FrameTimingStats::GetSummary() const
+	{
+		std::array<FrameTimingSample, capacity> samples;
+		const uint32_t count = CopySamples(samples);
+
+		FrameTimingSummary summary;
+		summary.sampleCount = count;
+		summary.frameCount = m_frameCount.load(std::memory_order_acquire);
+		summary.hitchCount = m_hitchCount.load(std::memory_order_relaxed);
+
+		std::array<float, capacity> values;
+
+		for (uint32_t i = 0; i < count; i++)
+			values[i] = samples[i].cpuFrameMilliseconds;
+		summary.cpuFrame = Distribute(values, count);
+
+		for (uint32_t i = 0; i < count; i++)
+			values[i] = samples[i].fenceWaitMilliseconds;
+		summary.fenceWait = Distribute(values, count);
+
+		// Intervals of 0 belong to frames without a previous present
+		uint32_t intervalCount = 0;
+		for (uint32_t i = 0; i < count; i++)
+		{
+			if (samples[i].presentIntervalMilliseconds > 0.0f)
+				values[intervalCount++] = samples[i].presentIntervalMilliseconds;
+		}
+
+		summary.presentInterval = Distribute(values, intervalCount);
+
+		if (intervalCount > 0)
+		{
+			double variance = 0.0;
+			for (uint32_t i = 0; i < intervalCount; i++)
+			{
+				const double deviation = values[i] - summary.presentInterval.mean;
+				variance += deviation * deviation;
+			}
+
+			summary.pacingStandardDeviation = std::sqrt(variance / intervalCount);
+			summary.framesPerSecond = summary.presentInterval.mean > 0.0 ? 1000.0 / summary.presentInterval.mean : 0.0;
+		}
+
+		return summary;
+	}
+
+	void FrameTimingStats::SetHitchThreshold(float factor, float floorMilliseconds)
+	{
+		m_hitchFactor = factor;
+		m_hitchFloorMilliseconds = floorMilliseconds;
+	}
+
+	void FrameTimingStats::Reset()
+	{
+		m_frameCount.store(0, std::memory_order_release);
+		m_hitchCount.store(0, std::memory_order_relaxed);
+		m_averageInterval = 0.0f;
+
+		for (Slot& slot : m_slots)
+			slot.sequence.store(0, std::memory_order_release);
+	}
+}
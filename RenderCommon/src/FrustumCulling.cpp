@@ -0,0 +1,665 @@
+#include <FrustumCulling.h>
+#include <JobSystem.h>
+
+#include <algorithm>
+#include <bit>
+#include <chrono>
+#include <cmath>
+#include <stdexcept>
+
+#if defined(_M_X64) || defined(__x86_64__) || defined(_M_IX86) || defined(__i386__)
+#define ULTREALITY_CULLING_X86
+#include <immintrin.h>
+#if defined(_MSC_VER)
+#include <intrin.h>
+#endif
+#elif defined(__ARM_NEON) || defined(_M_ARM64) || defined(_M_ARM)
+#define ULTREALITY_CULLING_NEON
+#include <arm_neon.h>
+#endif
+
+// GCC and Clang only emit instructions beyond the baseline in functions that opt into them, MSVC emits any intrinsic
+#if defined(__GNUC__) || defined(__clang__)
+#define ULTREALITY_CULLING_TARGET(isa) __attribute__((target(isa)))
+#else
+#define ULTREALITY_CULLING_TARGET(isa)
+#endif
+
+namespace UltReality::Rendering::Common
+{
+	namespace
+	{
+		uint32_t PaddedSize(uint32_t count)
+		{
+			return (count + BoundingSphereSoA::simdPadding - 1) / BoundingSphereSoA::simdPadding * BoundingSphereSoA::simdPadding;
+		}
+
+		// Appends the index of every set bit of a lane mask, dropping lanes past the end of the range
+		inline uint32_t EmitVisible(uint32_t mask, uint32_t base, uint32_t last, uint32_t* out, uint32_t count)
+		{
+			const uint32_t lanes = last - base;
+			if (lanes < 32)
+				mask &= (1u << lanes) - 1;
+
+			while (mask != 0)
+			{
+				out[count++] = base + static_cast<uint32_t>(std::countr_zero(mask));
+				mask &= mask - 1;
+			}
+
+			return count;
+		}
+
+		using SphereKernel = uint32_t(*)(const float planes[6][4], const BoundingSphereSoA& spheres, uint32_t first, uint32_t last, uint32_t* out);
+		using BoxKernel = uint32_t(*)(const float planes[6][4], const BoundingBoxSoA& boxes, uint32_t first, uint32_t last, uint32_t* out);
+
+		// Every path evaluates the plane distance with the same operations in the same order and without fused
+		// multiply-adds, so all of them report the same objects
+
+		uint32_t CullSpheresScalar(const float planes[6][4], const BoundingSphereSoA& spheres, uint32_t first, uint32_t last, uint32_t* out)
+		{
+			const float* centerX = spheres.CenterX();
+			const float* centerY = spheres.CenterY();
+			const float* centerZ = spheres.CenterZ();
+			const float* radius = spheres.Radius();
+
+			uint32_t count = 0;
+			for (uint32_t i = first; i < last; i++)
+			{
+				bool inside = true;
+				for (uint32_t p = 0; p < 6 && inside; p++)
+				{
+					float distance = planes[p][0] * centerX[i];
+					distance = distance + planes[p][1] * centerY[i];
+					distance = distance + planes[p][2] * centerZ[i];
+					distance = distance + planes[p][3];
+					inside = !(distance < -radius[i]);
+				}
+
+				if (inside)
+					out[count++] = i;
+			}
+
+			return count;
+		}
+
+		uint32_t CullBoxesScalar(const float planes[6][4], const BoundingBoxSoA& boxes, uint32_t first, uint32_t last, uint32_t* out)
+		{
+			uint32_t count = 0;
+			for (uint32_t i = first; i < last; i++)
+			{
+				bool inside = true;
+				for (uint32_t p = 0; p < 6 && inside; p++)
+				{
+					float distance = planes[p][0] * boxes.CenterX()[i];
+					distance = distance + planes[p][1] * boxes.CenterY()[i];
+					distance = distance + planes[p][2] * boxes.CenterZ()[i];
+					distance = distance + planes[p][3];
+
+					// Projection of the half extents onto the plane normal
+					float extent = std::fabs(planes[p][0]) * boxes.ExtentX()[i];
+					extent = extent + std::fabs(planes[p][1]) * boxes.ExtentY()[i];
+					extent = extent + std::fabs(planes[p][2]) * boxes.ExtentZ()[i];
+
+					inside = !(distance < -extent);
+				}
+
+				if (inside)
+					out[count++] = i;
+			}
+
+			return count;
+		}
+
+#if defined(ULTREALITY_CULLING_X86)
+		bool HasSse2()
+		{
+#if defined(_M_X64) || defined(__x86_64__)
+			return true;
+#elif defined(_MSC_VER)
+			int info[4];
+			__cpuid(info, 1);
+			return (info[3] & (1 << 26)) != 0;
+#else
+			return __builtin_cpu_supports("sse2");
+#endif
+		}
+
+		bool HasAvx2()
+		{
+#if defined(_MSC_VER)
+			int info[4];
+			__cpuid(info, 0);
+			if (info[0] < 7)
+				return false;
+
+			// The OS has to save the YMM registers on context switches as well
+			__cpuid(info, 1);
+			const bool osSavesYmm = (info[2] & (1 << 27)) != 0 && (info[2] & (1 << 28)) != 0 && (_xgetbv(0) & 6) == 6;
+			if (!osSavesYmm)
+				return false;
+
+			__cpuidex(info, 7, 0);
+			return (info[1] & (1 << 5)) != 0;
+#else
+			return __builtin_cpu_supports("avx2");
+#endif
+		}
+
+		ULTREALITY_CULLING_TARGET("sse2")
+		uint32_t CullSpheresSse(const float planes[6][4], const BoundingSphereSoA& spheres, uint32_t first, uint32_t last, uint32_t* out)
+		{
+			__m128 planeX[6], planeY[6], planeZ[6], planeW[6];
+			for (uint32_t p = 0; p < 6; p++)
+			{
+				planeX[p] = _mm_set1_ps(planes[p][0]);
+				planeY[p] = _mm_set1_ps(planes[p][1]);
+				planeZ[p] = _mm_set1_ps(planes[p][2]);
+				planeW[p] = _mm_set1_ps(planes[p][3]);
+			}
+
+			const __m128 signMask = _mm_set1_ps(-0.0f);
+
+			uint32_t count = 0;
+			for (uint32_t i = first; i < last; i += 4)
+			{
+				const __m128 x = _mm_loadu_ps(spheres.CenterX() + i);
+				const __m128 y = _mm_loadu_ps(spheres.CenterY() + i);
+				const __m128 z = _mm_loadu_ps(spheres.CenterZ() + i);
+				const __m128 negRadius = _mm_xor_ps(_mm_loadu_ps(spheres.Radius() + i), signMask);
+
+				__m128 outside = _mm_setzero_ps();
+				for (uint32_t p = 0; p < 6; p++)
+				{
+					__m128 distance = _mm_mul_ps(planeX[p], x);
+					distance = _mm_add_ps(distance, _mm_mul_ps(planeY[p], y));
+					distance = _mm_add_ps(distance, _mm_mul_ps(planeZ[p], z));
+					distance = _mm_add_ps(distance, planeW[p]);
+					outside = _mm_or_ps(outside, _mm_cmplt_ps(distance, negRadius));
+				}
+
+				count = EmitVisible(~static_cast<uint32_t>(_mm_movemask_ps(outside)) & 0xF, i, last, out, count);
+			}
+
+			return count;
+		}
+
+		ULTREALITY_CULLING_TARGET("sse2")
+		uint32_t CullBoxesSse(const float planes[6][4], const BoundingBoxSoA& boxes, uint32_t first, uint32_t last, uint32_t* out)
+		{
+			__m128 planeX[6], planeY[6], planeZ[6], planeW[6];
+			__m128 absX[6], absY[6], absZ[6];
+			for (uint32_t p = 0; p < 6; p++)
+			{
+				planeX[p] = _mm_set1_ps(planes[p][0]);
+				planeY[p] = _mm_set1_ps(planes[p][1]);
+				planeZ[p] = _mm_set1_ps(planes[p][2]);
+				planeW[p] = _mm_set1_ps(planes[p][3]);
+				absX[p] = _mm_set1_ps(std::fabs(planes[p][0]));
+				absY[p] = _mm_set1_ps(std::fabs(planes[p][1]));
+				absZ[p] = _mm_set1_ps(std::fabs(planes[p][2]));
+			}
+
+			const __m128 signMask = _mm_set1_ps(-0.0f);
+
+			uint32_t count = 0;
+			for (uint32_t i = first; i < last; i += 4)
+			{
+				const __m128 x = _mm_loadu_ps(boxes.CenterX() + i);
+				const __m128 y = _mm_loadu_ps(boxes.CenterY() + i);
+				const __m128 z = _mm_loadu_ps(boxes.CenterZ() + i);
+				const __m128 ex = _mm_loadu_ps(boxes.ExtentX() + i);
+				const __m128 ey = _mm_loadu_ps(boxes.ExtentY() + i);
+				const __m128 ez = _mm_loadu_ps(boxes.ExtentZ() + i);
+
+				__m128 outside = _mm_setzero_ps();
+				for (uint32_t p = 0; p < 6; p++)
+				{
+					__m128 distance = _mm_mul_ps(planeX[p], x);
+					distance = _mm_add_ps(distance, _mm_mul_ps(planeY[p], y));
+					distance = _mm_add_ps(distance, _mm_mul_ps(planeZ[p], z));
+					distance = _mm_add_ps(distance, planeW[p]);
+
+					__m128 extent = _mm_mul_ps(absX[p], ex);
+					extent = _mm_add_ps(extent, _mm_mul_ps(absY[p], ey));
+					extent = _mm_add_ps(extent, _mm_mul_ps(absZ[p], ez));
+
+					outside = _mm_or_ps(outside, _mm_cmplt_ps(distance, _mm_xor_ps(extent, signMask)));
+				}
+
+				count = EmitVisible(~static_cast<uint32_t>(_mm_movemask_ps(outside)) & 0xF, i, last, out, count);
+			}
+
+			return count;
+		}
+
+		ULTREALITY_CULLING_TARGET("avx2")
+		uint32_t CullSpheresAvx2(const float planes[6][4], const BoundingSphereSoA& spheres, uint32_t first, uint32_t last, uint32_t* out)
+		{
+			__m256 planeX[6], planeY[6], planeZ[6], planeW[6];
+			for (uint32_t p = 0; p < 6; p++)
+			{
+				planeX[p] = _mm256_set1_ps(planes[p][0]);
+				planeY[p] = _mm256_set1_ps(planes[p][1]);
+				planeZ[p] = _mm256_set1_ps(planes[p][2]);
+				planeW[p] = _mm256_set1_ps(planes[p][3]);
+			}
+
+			const __m256 signMask = _mm256_set1_ps(-0.0f);
+
+			uint32_t count = 0;
+			for (uint32_t i = first; i < last; i += 8)
+			{
+				const __m256 x = _mm256_loadu_ps(spheres.CenterX() + i);
+				const __m256 y = _mm256_loadu_ps(spheres.CenterY() + i);
+				const __m256 z = _mm256_loadu_ps(spheres.CenterZ() + i);
+				const __m256 negRadius = _mm256_xor_ps(_mm256_loadu_ps(spheres.Radius() + i), signMask);
+
+				__m256 outside = _mm256_setzero_ps();
+				for (uint32_t p = 0; p < 6; p++)
+				{
+					__m256 distance = _mm256_mul_ps(planeX[p], x);
+					distance = _mm256_add_ps(distance, _mm256_mul_ps(planeY[p], y));
+					distance = _mm256_add_ps(distance, _mm256_mul_ps(planeZ[p], z));
+					distance = _mm256_add_ps(distance, planeW[p]);
+					outside = _mm256_or_ps(outside, _mm256_cmp_ps(distance, negRadius, _CMP_LT_OQ));
+				}
+
+				count = EmitVisible(~static_cast<uint32_t>(_mm256_movemask_ps(outside)) & 0xFF, i, last, out, count);
+			}
+
+			return count;
+		}
+
+		ULTREALITY_CULLING_TARGET("avx2")
+		uint32_t CullBoxesAvx2(const float planes[6][4], const BoundingBoxSoA& boxes, uint32_t first, uint32_t last, uint32_t* out)
+		{
+			__m256 planeX[6], planeY[6], planeZ[6], planeW[6];
+			__m256 absX[6], absY[6], absZ[6];
+			for (uint32_t p = 0; p < 6; p++)
+			{
+				planeX[p] = _mm256_set1_ps(planes[p][0]);
+				planeY[p] = _mm256_set1_ps(planes[p][1]);
+				planeZ[p] = _mm256_set1_ps(planes[p][2]);
+				planeW[p] = _mm256_set1_ps(planes[p][3]);
+				absX[p] = _mm256_set1_ps(std::fabs(planes[p][0]));
+				absY[p] = _mm256_set1_ps(std::fabs(planes[p][1]));
+				absZ[p] = _mm256_set1_ps(std::fabs(planes[p][2]));
+			}
+
+			const __m256 signMask = _mm256_set1_ps(-0.0f);
+
+			uint32_t count = 0;
+			for (uint32_t i = first; i < last; i += 8)
+			{
+				const __m256 x = _mm256_loadu_ps(boxes.CenterX() + i);
+				const __m256 y = _mm256_loadu_ps(boxes.CenterY() + i);
+				const __m256 z = _mm256_loadu_ps(boxes.CenterZ() + i);
+				const __m256 ex = _mm256_loadu_ps(boxes.ExtentX() + i);
+				const __m256 ey = _mm256_loadu_ps(boxes.ExtentY() + i);
+				const __m256 ez = _mm256_loadu_ps(boxes.ExtentZ() + i);
+
+				__m256 outside = _mm256_setzero_ps();
+				for (uint32_t p = 0; p < 6; p++)
+				{
+					__m256 distance = _mm256_mul_ps(planeX[p], x);
+					distance = _mm256_add_ps(distance, _mm256_mul_ps(planeY[p], y));
+					distance = _mm256_add_ps(distance, _mm256_mul_ps(planeZ[p], z));
+					distance = _mm256_add_ps(distance, planeW[p]);
+
+					__m256 extent = _mm256_mul_ps(absX[p], ex);
+					extent = _mm256_add_ps(extent, _mm256_mul_ps(absY[p], ey));
+					extent = _mm256_add_ps(extent, _mm256_mul_ps(absZ[p], ez));
+
+					outside = _mm256_or_ps(outside, _mm256_cmp_ps(distance, _mm256_xor_ps(extent, signMask), _CMP_LT_OQ));
+				}
+
+				count = EmitVisible(~static_cast<uint32_t>(_mm256_movemask_ps(outside)) & 0xFF, i, last, out, count);
+			}
+
+			return count;
+		}
+#endif // ULTREALITY_CULLING_X86
+
+#if defined(ULTREALITY_CULLING_NEON)
+		// NEON has no movemask, every lane contributes its bit through a shift by its lane index
+		inline uint32_t LaneMask(uint32x4_t lanes)
+		{
+			static const int32_t shifts[4] = { 0, 1, 2, 3 };
+			const uint32x4_t bits = vshlq_u32(vshrq_n_u32(lanes, 31), vld1q_s32(shifts));
+			return vgetq_lane_u32(bits, 0) | vgetq_lane_u32(bits, 1) | vgetq_lane_u32(bits, 2) | vgetq_lane_u32(bits, 3);
+		}
+
+		uint32_t CullSpheresNeon(const float planes[6][4], const BoundingSphereSoA& spheres, uint32_t first, uint32_t last, uint32_t* out)
+		{
+			float32x4_t planeX[6], planeY[6], planeZ[6], planeW[6];
+			for (uint32_t p = 0; p < 6; p++)
+			{
+				planeX[p] = vdupq_n_f32(planes[p][0]);
+				planeY[p] = vdupq_n_f32(planes[p][1]);
+				planeZ[p] = vdupq_n_f32(planes[p][2]);
+				planeW[p] = vdupq_n_f32(planes[p][3]);
+			}
+
+			uint32_t count = 0;
+			for (uint32_t i = first; i < last; i += 4)
+			{
+				const float32x4_t x = vld1q_f32(spheres.CenterX() + i);
+				const float32x4_t y = vld1q_f32(spheres.CenterY() + i);
+				const float32x4_t z = vld1q_f32(spheres.CenterZ() + i);
+				const float32x4_t negRadius = vnegq_f32(vld1q_f32(spheres.Radius() + i));
+
+				uint32x4_t outside = vdupq_n_u32(0);
+				for (uint32_t p = 0; p < 6; p++)
+				{
+					// Separate multiplies and adds, vmlaq may be fused on some targets
+					float32x4_t distance = vmulq_f32(planeX[p], x);
+					distance = vaddq_f32(distance, vmulq_f32(planeY[p], y));
+					distance = vaddq_f32(distance, vmulq_f32(planeZ[p], z));
+					distance = vaddq_f32(distance, planeW[p]);
+					outside = vorrq_u32(outside, vcltq_f32(distance, negRadius));
+				}
+
+				count = EmitVisible(~LaneMask(outside) & 0xF, i, last, out, count);
+			}
+
+			return count;
+		}
+
+		uint32_t CullBoxesNeon(const float planes[6][4], const BoundingBoxSoA& boxes, uint32_t first, uint32_t last, uint32_t* out)
+		{
+			float32x4_t planeX[6], planeY[6], planeZ[6], planeW[6];
+			float32x4_t absX[6], absY[6], absZ[6];
+			for (uint32_t p = 0; p < 6; p++)
+			{
+				planeX[p] = vdupq_n_f32(planes[p][0]);
+				planeY[p] = vdupq_n_f32(planes[p][1]);
+				planeZ[p] = vdupq_n_f32(planes[p][2]);
+				planeW[p] = vdupq_n_f32(planes[p][3]);
+				absX[p] = vdupq_n_f32(std::fabs(planes[p][0]));
+				absY[p] = vdupq_n_f32(std::fabs(planes[p][1]));
+				absZ[p] = vdupq_n_f32(std::fabs(planes[p][2]));
+			}
+
+			uint32_t count = 0;
+			for (uint32_t i = first; i < last; i += 4)
+			{
+				const float32x4_t x = vld1q_f32(boxes.CenterX() + i);
+				const float32x4_t y = vld1q_f32(boxes.CenterY() + i);
+				const float32x4_t z = vld1q_f32(boxes.CenterZ() + i);
+				const float32x4_t ex = vld1q_f32(boxes.ExtentX() + i);
+				const float32x4_t ey = vld1q_f32(boxes.ExtentY() + i);
+				const float32x4_t ez = vld1q_f32(boxes.ExtentZ() + i);
+
+				uint32x4_t outside = vdupq_n_u32(0);
+				for (uint32_t p = 0; p < 6; p++)
+				{
+					float32x4_t distance = vmulq_f32(planeX[p], x);
+					distance = vaddq_f32(distance, vmulq_f32(planeY[p], y));
+					distance = vaddq_f32(distance, vmulq_f32(planeZ[p], z));
+					distance = vaddq_f32(distance, planeW[p]);
+
+					float32x4_t extent = vmulq_f32(absX[p], ex);
+					extent = vaddq_f32(extent, vmulq_f32(absY[p], ey));
+					extent = vaddq_f32(extent, vmulq_f32(absZ[p], ez));
+
+					outside = vorrq_u32(outside, vcltq_f32(distance, vnegq_f32(extent)));
+				}
+
+				count = EmitVisible(~LaneMask(outside) & 0xF, i, last, out, count);
+			}
+
+			return count;
+		}
+#endif // ULTREALITY_CULLING_NEON
+
+		SphereKernel SelectSphereKernel(CullingSimdPath path)
+		{
+			switch (path)
+			{
+#if defined(ULTREALITY_CULLING_X86)
+			case CullingSimdPath::Avx2:
+				return CullSpheresAvx2;
+			case CullingSimdPath::Sse:
+				return CullSpheresSse;
+#endif
+#if defined(ULTREALITY_CULLING_NEON)
+			case CullingSimdPath::Neon:
+				return CullSpheresNeon;
+#endif
+			default:
+				return CullSpheresScalar;
+			}
+		}
+
+		BoxKernel SelectBoxKernel(CullingSimdPath path)
+		{
+			switch (path)
+			{
+#if defined(ULTREALITY_CULLING_X86)
+			case CullingSimdPath::Avx2:
+				return CullBoxesAvx2;
+			case CullingSimdPath::Sse:
+				return CullBoxesSse;
+#endif
+#if defined(ULTREALITY_CULLING_NEON)
+			case CullingSimdPath::Neon:
+				return CullBoxesNeon;
+#endif
+			default:
+				return CullBoxesScalar;
+			}
+		}
+	}
+
+	uint32_t BoundingSphereSoA::Add(const float center[3], float radius)
+	{
+		const uint32_t index = m_count++;
+		if (m_count > m_radius.size())
+		{
+			// Padding lanes stay zero, their results are masked off
+			const uint32_t padded = PaddedSize(m_count);
+			m_centerX.resize(padded);
+			m_centerY.resize(padded);
+			m_centerZ.resize(padded);
+			m_radius.resize(padded);
+		}
+
+		Set(index, center, radius);
+		return index;
+	}
+
+	void BoundingSphereSoA::Set(uint32_t index, const float center[3], float radius)
+	{
+		m_centerX[index] = center[0];
+		m_centerY[index] = center[1];
+		m_centerZ[index] = center[2];
+		m_radius[index] = radius;
+	}
+
+	void BoundingSphereSoA::Clear()
+	{
+		m_centerX.clear();
+		m_centerY.clear();
+		m_centerZ.clear();
+		m_radius.clear();
+		m_count = 0;
+	}
+
+	uint32_t BoundingSphereSoA::Size() const
+	{
+		return m_count;
+	}
+
+	const float* BoundingSphereSoA::CenterX() const { return m_centerX.data(); }
+	const float* BoundingSphereSoA::CenterY() const { return m_centerY.data(); }
+	const float* BoundingSphereSoA::CenterZ() const { return m_centerZ.data(); }
+	const float* BoundingSphereSoA::Radius() const { return m_radius.data(); }
+
+	uint32_t BoundingBoxSoA::Add(const float min[3], const float max[3])
+	{
+		const uint32_t index = m_count++;
+		if (m_count > m_extentX.size())
+		{
+			const uint32_t padded = PaddedSize(m_count);
+			m_centerX.resize(padded);
+			m_centerY.resize(padded);
+			m_centerZ.resize(padded);
+			m_extentX.resize(padded);
+			m_extentY.resize(padded);
+			m_extentZ.resize(padded);
+		}
+
+		Set(index, min, max);
+		return index;
+	}
+
+	void BoundingBoxSoA::Set(uint32_t index, const float min[3], const float max[3])
+	{
+		m_centerX[index] = (min[0] + max[0]) * 0.5f;
+		m_centerY[index] = (min[1] + max[1]) * 0.5f;
+		m_centerZ[index] = (min[2] + max[2]) * 0.5f;
+		m_extentX[index] = (max[0] - min[0]) * 0.5f;
+		m_extentY[index] = (max[1] - min[1]) * 0.5f;
+		m_extentZ[index] = (max[2] - min[2]) * 0.5f;
+	}
+
+	void BoundingBoxSoA::Clear()
+	{
+		m_centerX.clear();
+		m_centerY.clear();
+		m_centerZ.clear();
+		m_extentX.clear();
+		m_extentY.clear();
+		m_extentZ.clear();
+		m_count = 0;
+	}
+
+	uint32_t BoundingBoxSoA::Size() const
+	{
+		return m_count;
+	}
+
+	const float* BoundingBoxSoA::CenterX() const { return m_centerX.data(); }
+	const float* BoundingBoxSoA::CenterY() const { return m_centerY.data(); }
+	const float* BoundingBoxSoA::CenterZ() const { return m_centerZ.data(); }
+	const float* BoundingBoxSoA::ExtentX() const { return m_extentX.data(); }
+	const float* BoundingBoxSoA::ExtentY() const { return m_extentY.data(); }
+	const float* BoundingBoxSoA::ExtentZ() const { return m_extentZ.data(); }
+
+	FrustumCuller::FrustumCuller(JobSystem* jobSystem, uint32_t objectsPerJob)
+		: m_jobSystem(jobSystem), m_objectsPerJob(PaddedSize(std::max(objectsPerJob, 1u))), m_simdPath(DetectSimdPath())
+	{
+	}
+
+	template<typename Volumes, typename RangeCull>
+	void FrustumCuller::Cull(const Volumes& volumes, RangeCull rangeCull, std::vector<uint32_t>& visible)
+	{
+		const auto start = std::chrono::steady_clock::now();
+
+		const uint32_t count = volumes.Size();
+		const uint32_t chunkCount = (count + m_objectsPerJob - 1) / m_objectsPerJob;
+		if (m_chunkVisible.size() < chunkCount)
+			m_chunkVisible.resize(chunkCount);
+
+		// Chunks start on a multiple of the padding, so every SIMD load stays inside the arrays
+		auto cullChunk = [this, &rangeCull](uint32_t first, uint32_t last)
+		{
+			std::vector<uint32_t>& chunkVisible = m_chunkVisible[first / m_objectsPerJob];
+			chunkVisible.resize(last - first);
+			chunkVisible.resize(rangeCull(first, last, chunkVisible.data()));
+		};
+
+		if (m_jobSystem != nullptr && chunkCount > 1)
+		{
+			JobCounter counter;
+			m_jobSystem->Dispatch(count, m_objectsPerJob, [&cullChunk](uint32_t first, uint32_t last, uint32_t)
+			{
+				cullChunk(first, last);
+			}, counter);
+			m_jobSystem->Wait(counter);
+		}
+		else
+		{
+			for (uint32_t first = 0; first < count; first += m_objectsPerJob)
+				cullChunk(first, std::min(first + m_objectsPerJob, count));
+		}
+
+		visible.clear();
+		for (uint32_t chunk = 0; chunk < chunkCount; chunk++)
+			visible.insert(visible.end(), m_chunkVisible[chunk].begin(), m_chunkVisible[chunk].end());
+
+		m_statistics.testedCount = count;
+		m_statistics.visibleCount = static_cast<uint32_t>(visible.size());
+		m_statistics.chunkCount = chunkCount;
+		m_statistics.milliseconds = std::chrono::duration<float, std::milli>(std::chrono::steady_clock::now() - start).count();
+	}
+
+	void FrustumCuller::CullSpheres(const float planes[6][4], const BoundingSphereSoA& spheres, std::vector<uint32_t>& visible)
+	{
+		const SphereKernel kernel = SelectSphereKernel(m_simdPath);
+		Cull(spheres, [planes, &spheres, kernel](uint32_t first, uint32_t last, uint32_t* out)
+		{
+			return kernel(planes, spheres, first, last, out);
+		}, visible);
+	}
+
+	void FrustumCuller::CullBoxes(const float planes[6][4], const BoundingBoxSoA& boxes, std::vector<uint32_t>& visible)
+	{
+		const BoxKernel kernel = SelectBoxKernel(m_simdPath);
+		Cull(boxes, [planes, &boxes, kernel](uint32_t first, uint32_t last, uint32_t* out)
+		{
+			return kernel(planes, boxes, first, last, out);
+		}, visible);
+	}
+
+	CullingSimdPath FrustumCuller::GetSimdPath() const
+	{
+		return m_simdPath;
+	}
+
+	void FrustumCuller::SetSimdPath(CullingSimdPath path)
+	{
+		if (!IsSimdPathSupported(path))
+			throw std::invalid_argument("Culling SIMD path is not supported by this build or CPU");
+
+		m_simdPath = path;
+	}
+
+	const FrustumCuller::Statistics& FrustumCuller::GetStatistics() const
+	{
+		return m_statistics;
+	}
+
+	bool FrustumCuller::IsSimdPathSupported(CullingSimdPath path)
+	{
+		switch (path)
+		{
+		case CullingSimdPath::Scalar:
+			return true;
+#if defined(ULTREALITY_CULLING_X86)
+		case CullingSimdPath::Sse:
+			return HasSse2();
+		case CullingSimdPath::Avx2:
+			return HasAvx2();
+#endif
+#if defined(ULTREALITY_CULLING_NEON)
+		case CullingSimdPath::Neon:
+			return true;
+#endif
+		default:
+			return false;
+		}
+	}
+
+	CullingSimdPath FrustumCuller::DetectSimdPath()
+	{
+		for (CullingSimdPath path : { CullingSimdPath::Avx2, CullingSimdPath::Sse, CullingSimdPath::Neon })
+		{
+			if (IsSimdPathSupported(path))
+				return path;
+		}
+
+		return CullingSimdPath::Scalar;
+	}
+}
@@ -0,0 +1,77 @@
+#include <GpuCulling.h>
+
+#include <cmath>
+#include <stdexcept>
+
+namespace UltReality::Rendering::Common
+{
+	void ExtractFrustumPlanes(const float viewProjection[16], float planes[6][4])
+	{
+		// Row vectors multiply from the left, so clip coordinate j is the dot product with column j
+		auto column = [viewProjection](uint32_t j, uint32_t row) { return viewProjection[row * 4 + j]; };
+
+		for (uint32_t row = 0; row < 4; row++)
+		{
+			planes[0][row] = column(3, row) + column(0, row); // Left
+			planes[1][row] = column(3, row) - column(0, row); // Right
+			planes[2][row] = column(3, row) + column(1, row); // Bottom
+			planes[3][row] = column(3, row) - column(1, row); // Top
+			planes[4][row] = column(2, row);                   // Near, depth starts at 0
+			planes[5][row] = column(3, row) - column(2, row); // Far
+		}
+
+		for (uint32_t p = 0; p < 6; p++)
+		{
+			const float length = std::sqrt(planes[p][0] * planes[p][0] + planes[p][1] * planes[p][1] + planes[p][2] * planes[p][2]);
+			if (length > 0.0f)
+			{
+				for (uint32_t i = 0; i < 4; i++)
+					planes[p][i] /= length;
+			}
+		}
+	}
+
+	bool IsSphereInFrustum(const float planes[6][4], const float center[3], float radius)
+	{
+		for (uint32_t p = 0; p < 6; p++)
+		{
+			// One rounding per operation and no fused multiply-add, matching the precise arithmetic of the shader
+			float distance = planes[p][0] * center[0];
+			distance = distance + planes[p][1] * center[1];
+			distance = distance + planes[p][2] * center[2];
+			distance = distance + planes[p][3];
+
+			if (distance < -radius)
+				return false;
+		}
+
+		return true;
+	}
+
+	std::vector<IndirectDrawCommand> CullAndCompactReference(const GpuCullConstants& constants, const std::vector<GpuInstance>& instances, const std::vector<GpuMesh>& meshes)
+	{
+		if (instances.size() < constants.instanceCount || meshes.size() < constants.meshCount)
+			throw std::invalid_argument("Culling constants reference more instances or meshes than provided");
+
+		std::vector<IndirectDrawCommand> commands;
+		for (uint32_t index = 0; index < constants.instanceCount; index++)
+		{
+			const GpuInstance& instance = instances[index];
+			if (instance.meshIndex >= constants.meshCount || !IsSphereInFrustum(constants.frustumPlanes, instance.boundsCenter, instance.boundsRadius))
+				continue;
+
+			const GpuMesh& mesh = meshes[instance.meshIndex];
+
+			IndirectDrawCommand command;
+			command.instanceIndex = index;
+			command.indexCountPerInstance = mesh.indexCount;
+			command.instanceCount = 1;
+			command.startIndexLocation = mesh.startIndex;
+			command.baseVertexLocation = mesh.baseVertex;
+			command.startInstanceLocation = 0;
+			commands.push_back(command);
+		}
+
+		return commands;
+	}
+}
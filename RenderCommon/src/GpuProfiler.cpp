@@ -0,0 +1,270 @@
+#include <GpuProfiler.h>
+
+#include <algorithm>
+#include <stdexcept>
+
+namespace UltReality::Rendering::Common
+{
+	double GpuFrameProfile::GetMilliseconds(std::string_view name) const
+	{
+		double milliseconds = 0.0;
+		for (const GpuScopeTiming& scope : scopes)
+		{
+			if (scope.name == name)
+				milliseconds += scope.milliseconds;
+		}
+
+		return milliseconds;
+	}
+
+	GpuProfiler::GpuProfiler(uint32_t maxScopesPerFrame)
+		: m_maxScopesPerFrame(maxScopesPerFrame)
+	{
+		if (maxScopesPerFrame == 0)
+			throw std::invalid_argument("GpuProfiler needs room for at least one scope per frame");
+
+		for (FrameSlot& slot : m_slots)
+			slot.scopes = std::make_unique<ScopeRecord[]>(maxScopesPerFrame);
+	}
+
+	void GpuProfiler::SetTimestampFrequency(uint64_t ticksPerSecond)
+	{
+		m_ticksPerMillisecond = static_cast<double>(ticksPerSecond) / 1000.0;
+	}
+
+	bool GpuProfiler::BeginFrame()
+	{
+		m_frameNumber++;
+		m_currentSlot = static_cast<uint32_t>(m_frameNumber % frameSlotCount);
+
+		FrameSlot& slot = m_slots[m_currentSlot];
+		if (slot.submitted)
+		{
+			// The GPU is further behind than there are slots. Skip the frame rather than wait for the slot
+			m_recording = false;
+			m_skippedFrames++;
+			return false;
+		}
+
+		slot.scopeCount.store(0, std::memory_order_relaxed);
+		slot.frameNumber = m_frameNumber;
+		m_recording = true;
+
+		return true;
+	}
+
+	uint32_t GpuProfiler::BeginScope(std::string_view name, uint32_t parent)
+	{
+		if (!m_recording)
+			return invalidScope;
+
+		FrameSlot& slot = m_slots[m_currentSlot];
+		const uint32_t scope = slot.scopeCount.fetch_add(1, std::memory_order_relaxed);
+		if (scope >= m_maxScopesPerFrame)
+			return invalidScope;
+
+		ScopeRecord& record = slot.scopes[scope];
+		record.name.assign(name);
+		// A parent is always opened before its children, so it has the lower index
+		record.parent = parent < scope ? parent : invalidScope;
+		record.open.store(true, std::memory_order_release);
+
+		return scope;
+	}
+
+	void GpuProfiler::EndScope(uint32_t scope)
+	{
+		if (!m_recording || scope >= m_maxScopesPerFrame)
+			return;
+
+		m_slots[m_currentSlot].scopes[scope].open.store(false, std::memory_order_release);
+	}
+
+	uint32_t GpuProfiler::GetScopeCount() const
+	{
+		if (!m_recording)
+			return 0;
+
+		return std::min(m_slots[m_currentSlot].scopeCount.load(std::memory_order_acquire), m_maxScopesPerFrame);
+	}
+
+	bool GpuProfiler::IsScopeOpen(uint32_t scope) const
+	{
+		if (!m_recording || scope >= m_maxScopesPerFrame)
+			return false;
+
+		return m_slots[m_currentSlot].scopes[scope].open.load(std::memory_order_acquire);
+	}
+
+	uint32_t GpuProfiler::GetBeginQuery(uint32_t scope) const
+	{
+		return GetFrameQueryOffset() + scope * 2;
+	}
+
+	uint32_t GpuProfiler::GetEndQuery(uint32_t scope) const
+	{
+		return GetFrameQueryOffset() + scope * 2 + 1;
+	}
+
+	uint32_t GpuProfiler::GetFrameQueryOffset() const
+	{
+		return m_currentSlot * m_maxScopesPerFrame * 2;
+	}
+
+	uint32_t GpuProfiler::GetQueryCount() const
+	{
+		return frameSlotCount * m_maxScopesPerFrame * 2;
+	}
+
+	void GpuProfiler::EndFrame(uint64_t fenceValue)
+	{
+		if (!m_recording)
+			return;
+
+		FrameSlot& slot = m_slots[m_currentSlot];
+		slot.fenceValue = fenceValue;
+		slot.submitted = true;
+
+		m_recording = false;
+	}
+
+	bool GpuProfiler::NextCompletedFrame(uint64_t completedFenceValue, uint32_t& slot) const
+	{
+		bool found = false;
+		for (uint32_t i = 0; i < frameSlotCount; i++)
+		{
+			const FrameSlot& candidate = m_slots[i];
+			if (!candidate.submitted || candidate.fenceValue > completedFenceValue)
+				continue;
+
+			if (!found || candidate.frameNumber < m_slots[slot].frameNumber)
+			{
+				slot = i;
+				found = true;
+			}
+		}
+
+		return found;
+	}
+
+	void GpuProfiler::ReadFrame(uint32_t slotIndex, const uint64_t* timestamps)
+	{
+		FrameSlot& slot = m_slots[slotIndex];
+		const uint32_t scopeCount = std::min(slot.scopeCount.load(std::memory_order_acquire), m_maxScopesPerFrame);
+
+		struct Node
+		{
+			uint32_t scope;
+			uint32_t parent;
+			uint32_t depth;
+			uint32_t count = 0;
+			uint64_t ticks = 0;
+			std::vector<uint32_t> children;
+		};
+
+		// Scopes with the same name under the same parent merge into one node, e.g. one per recording job
+		std::vector<Node> nodes;
+		std::vector<uint32_t> roots;
+		std::vector<uint32_t> nodeOfScope(scopeCount, invalidScope);
+
+		uint64_t firstTimestamp = UINT64_MAX;
+		uint64_t lastTimestamp = 0;
+
+		for (uint32_t i = 0; i < scopeCount; i++)
+		{
+			const ScopeRecord& record = slot.scopes[i];
+			const uint64_t begin = timestamps[i * 2];
+			const uint64_t end = timestamps[i * 2 + 1];
+
+			// Scopes left open have no end timestamp and drop out together with their children
+			const uint32_t parentNode = record.parent == invalidScope ? invalidScope : nodeOfScope[record.parent];
+			if (record.open.load(std::memory_order_acquire) || (record.parent != invalidScope && parentNode == invalidScope))
+				continue;
+
+			std::vector<uint32_t>& siblings = parentNode == invalidScope ? roots : nodes[parentNode].children;
+			auto match = std::find_if(siblings.begin(), siblings.end(), [&](uint32_t node) { return slot.scopes[nodes[node].scope].name == record.name; });
+
+			uint32_t node;
+			if (match != siblings.end())
+			{
+				node = *match;
+			}
+			else
+			{
+				Node created;
+				created.scope = i;
+				created.parent = parentNode;
+				created.depth = parentNode == invalidScope ? 0 : nodes[parentNode].depth + 1;
+
+				node = static_cast<uint32_t>(nodes.size());
+				nodes.push_back(std::move(created));
+
+				// nodes may have reallocated, look the sibling list up again
+				(parentNode == invalidScope ? roots : nodes[parentNode].children).push_back(node);
+			}
+
+			nodeOfScope[i] = node;
+			nodes[node].count++;
+
+			// Timestamps from a disjoint queue clock or a reset counter read as zero time instead of wrapping around
+			if (end >= begin)
+			{
+				nodes[node].ticks += end - begin;
+				firstTimestamp = std::min(firstTimestamp, begin);
+				lastTimestamp = std::max(lastTimestamp, end);
+			}
+		}
+
+		const double ticksPerMillisecond = m_ticksPerMillisecond > 0.0 ? m_ticksPerMillisecond : 1.0;
+
+		GpuFrameProfile& profile = m_latestProfile;
+		profile.frameNumber = slot.frameNumber;
+		profile.frameMilliseconds = lastTimestamp > firstTimestamp ? (lastTimestamp - firstTimestamp) / ticksPerMillisecond : 0.0;
+		profile.scopes.clear();
+		profile.scopes.reserve(nodes.size());
+
+		// Emit depth first, children in the order they were first opened
+		std::vector<std::pair<uint32_t, uint32_t>> stack;
+		for (auto it = roots.rbegin(); it != roots.rend(); ++it)
+			stack.emplace_back(*it, invalidScope);
+
+		while (!stack.empty())
+		{
+			const auto [node, parentIndex] = stack.back();
+			stack.pop_back();
+
+			const Node& current = nodes[node];
+
+			uint64_t childTicks = 0;
+			for (uint32_t child : current.children)
+				childTicks += nodes[child].ticks;
+
+			GpuScopeTiming timing;
+			timing.name = slot.scopes[current.scope].name;
+			timing.parent = parentIndex;
+			timing.depth = current.depth;
+			timing.count = current.count;
+			timing.milliseconds = current.ticks / ticksPerMillisecond;
+			timing.exclusiveMilliseconds = (current.ticks > childTicks ? current.ticks - childTicks : 0) / ticksPerMillisecond;
+
+			const uint32_t index = static_cast<uint32_t>(profile.scopes.size());
+			profile.scopes.push_back(std::move(timing));
+
+			for (auto it = current.children.rbegin(); it != current.children.rend(); ++it)
+				stack.emplace_back(*it, index);
+		}
+
+		slot.submitted = false;
+		slot.fenceValue = 0;
+	}
+
+	const GpuFrameProfile& GpuProfiler::GetLatestProfile() const
+	{
+		return m_latestProfile;
+	}
+
+	uint64_t GpuProfiler::GetSkippedFrameCount() const
+	{
+		return m_skippedFrames;
+	}
+}
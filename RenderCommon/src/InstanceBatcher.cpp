@@ -0,0 +1,90 @@
+#include <InstanceBatcher.h>
+
+#include <stdexcept>
+
+namespace UltReality::Rendering::Common
+{
+	InstanceBatcher::InstanceBatcher(JobSystem* jobSystem)
+		: m_sorter(jobSystem)
+	{
+	}
+
+	void InstanceBatcher::Build(const std::vector<uint64_t>& sortKeys, const std::vector<uint64_t>& batchKeys, std::vector<InstanceBatch>& batches, std::vector<uint32_t>& instanceOrder)
+	{
+		if (sortKeys.size() != batchKeys.size())
+			throw std::invalid_argument("Every draw needs a sort key and a batch key");
+
+		m_sorter.Sort(sortKeys, m_order);
+
+		const uint32_t drawCount = static_cast<uint32_t>(sortKeys.size());
+		m_drawBatches.resize(drawCount);
+		m_openBatches.clear();
+		batches.clear();
+
+		// The pass and layer are the top byte of the key, batches never span two of them
+		uint32_t currentPassLayer = UINT32_MAX;
+		bool backToFront = false;
+		// Batch of the previous draw, which a back to front draw may extend
+		uint32_t previousBatch = UINT32_MAX;
+
+		for (uint32_t position = 0; position < drawCount; position++)
+		{
+			const uint32_t draw = m_order[position];
+			const uint32_t passLayer = static_cast<uint32_t>(sortKeys[draw] >> 56);
+			if (passLayer != currentPassLayer)
+			{
+				currentPassLayer = passLayer;
+				const DrawLayer layer = DecodeDrawSortKey(sortKeys[draw]).layer;
+				backToFront = layer == DrawLayer::Transparent || layer == DrawLayer::Overlay;
+				m_openBatches.clear();
+				previousBatch = UINT32_MAX;
+			}
+
+			uint32_t batch;
+			if (backToFront)
+			{
+				batch = previousBatch;
+				if (batch == UINT32_MAX || batchKeys[m_order[position - 1]] != batchKeys[draw])
+				{
+					batch = static_cast<uint32_t>(batches.size());
+					batches.emplace_back();
+				}
+			}
+			else
+			{
+				const auto [slot, inserted] = m_openBatches.try_emplace(batchKeys[draw], static_cast<uint32_t>(batches.size()));
+				if (inserted)
+					batches.emplace_back();
+				batch = slot->second;
+			}
+
+			previousBatch = batch;
+			m_drawBatches[position] = batch;
+			batches[batch].instanceCount++;
+		}
+
+		uint32_t firstInstance = 0;
+		for (InstanceBatch& batch : batches)
+		{
+			batch.firstInstance = firstInstance;
+			firstInstance += batch.instanceCount;
+			batch.instanceCount = 0;
+		}
+
+		// Instances keep the sort order within their batch
+		instanceOrder.resize(drawCount);
+		for (uint32_t position = 0; position < drawCount; position++)
+		{
+			InstanceBatch& batch = batches[m_drawBatches[position]];
+			instanceOrder[batch.firstInstance + batch.instanceCount++] = m_order[position];
+		}
+
+		m_statistics.drawCount = drawCount;
+		m_statistics.batchCount = static_cast<uint32_t>(batches.size());
+	}
+
+	const InstanceBatcher::Statistics& InstanceBatcher::GetStatistics() const
+	{
+		return m_statistics;
+	}
+}
@@ -0,0 +1,195 @@
+#include <JobSystem.h>
+
+#include <algorithm>
+
+namespace UltReality::Rendering::Common
+{
+	namespace
+	{
+		// Identifies the job system and worker a thread belongs to
+		thread_local const JobSystem* t_ownerSystem = nullptr;
+		thread_local uint32_t t_workerIndex = 0;
+	}
+
+	JobSystem::JobSystem(uint32_t threadCount)
+		: m_ownerThread(std::this_thread::get_id())
+	{
+		if (threadCount == 0)
+			threadCount = std::max(1u, std::thread::hardware_concurrency() - 1);
+
+		// Queue 0 belongs to the owning thread, the queue after the last worker to external threads
+		m_queues.reserve(threadCount + 2);
+		for (uint32_t i = 0; i <= threadCount + 1; i++)
+			m_queues.push_back(std::make_unique<WorkerQueue>());
+
+		m_threads.reserve(threadCount);
+		for (uint32_t i = 1; i <= threadCount; i++)
+		{
+			m_threads.emplace_back([this, i]()
+			{
+				t_ownerSystem = this;
+				t_workerIndex = i;
+				WorkerLoop(i);
+			});
+		}
+	}
+
+	JobSystem::~JobSystem()
+	{
+		{
+			std::lock_guard<std::mutex> lock(m_sleepMutex);
+			m_running.store(false);
+		}
+		m_wakeCondition.notify_all();
+
+		for (std::thread& thread : m_threads)
+			thread.join();
+	}
+
+	bool JobSystem::PopLocal(uint32_t workerIndex, Job& job)
+	{
+		WorkerQueue& queue = *m_queues[workerIndex];
+		std::lock_guard<std::mutex> lock(queue.mutex);
+		if (queue.jobs.empty())
+			return false;
+
+		// Newest first, its data is most likely still in cache
+		job = std::move(queue.jobs.back());
+		queue.jobs.pop_back();
+
+		return true;
+	}
+
+	bool JobSystem::Steal(uint32_t thiefIndex, Job& job)
+	{
+		// Visits every queue but the thief's own, including the external queue
+		const uint32_t queueCount = static_cast<uint32_t>(m_queues.size());
+		for (uint32_t i = 1; i < queueCount; i++)
+		{
+			WorkerQueue& victim = *m_queues[(thiefIndex + i) % queueCount];
+			std::lock_guard<std::mutex> lock(victim.mutex);
+			if (victim.jobs.empty())
+				continue;
+
+			// Oldest first, it tends to be the largest remaining piece of work
+			job = std::move(victim.jobs.front());
+			victim.jobs.pop_front();
+
+			return true;
+		}
+
+		return false;
+	}
+
+	bool JobSystem::TryRunJob(uint32_t workerIndex)
+	{
+		Job job;
+		if (!PopLocal(workerIndex, job) && !Steal(workerIndex, job))
+			return false;
+
+		m_queuedJobs.fetch_sub(1, std::memory_order_relaxed);
+
+		try
+		{
+			job.function(workerIndex);
+		}
+		catch (...)
+		{
+			if (job.counter == nullptr)
+				throw;
+
+			std::lock_guard<std::mutex> lock(job.counter->m_exceptionMutex);
+			if (!job.counter->m_exception)
+				job.counter->m_exception = std::current_exception();
+		}
+
+		if (job.counter != nullptr)
+			job.counter->m_pending.fetch_sub(1, std::memory_order_release);
+
+		return true;
+	}
+
+	void JobSystem::WorkerLoop(uint32_t workerIndex)
+	{
+		while (true)
+		{
+			if (TryRunJob(workerIndex))
+				continue;
+
+			std::unique_lock<std::mutex> lock(m_sleepMutex);
+			if (!m_running.load() && m_queuedJobs.load() == 0)
+				break;
+
+			m_wakeCondition.wait(lock, [this]() { return m_queuedJobs.load() > 0 || !m_running.load(); });
+		}
+	}
+
+	void JobSystem::Submit(JobFunction job, JobCounter* counter)
+	{
+		if (counter != nullptr)
+			counter->m_pending.fetch_add(1, std::memory_order_relaxed);
+
+		{
+			const uint32_t workerIndex = CurrentWorkerIndex();
+			WorkerQueue& queue = *m_queues[workerIndex == externalThreadIndex ? m_queues.size() - 1 : workerIndex];
+			std::lock_guard<std::mutex> lock(queue.mutex);
+			queue.jobs.push_back(Job{ std::move(job), counter });
+		}
+
+		{
+			// Taking the sleep mutex orders the increment with a worker checking the predicate
+			std::lock_guard<std::mutex> lock(m_sleepMutex);
+			m_queuedJobs.fetch_add(1, std::memory_order_relaxed);
+		}
+		m_wakeCondition.notify_one();
+	}
+
+	void JobSystem::Dispatch(uint32_t count, uint32_t groupSize, RangeFunction function, JobCounter& counter)
+	{
+		if (count == 0)
+			return;
+
+		groupSize = std::max(1u, groupSize);
+
+		// Every group shares one copy of the body
+		auto sharedFunction = std::make_shared<RangeFunction>(std::move(function));
+		for (uint32_t first = 0; first < count; first += groupSize)
+		{
+			const uint32_t last = std::min(count, first + groupSize);
+			Submit([sharedFunction, first, last](uint32_t workerIndex) { (*sharedFunction)(first, last, workerIndex); }, &counter);
+		}
+	}
+
+	void JobSystem::Wait(JobCounter& counter)
+	{
+		const uint32_t workerIndex = CurrentWorkerIndex();
+		while (!counter.IsDone())
+		{
+			// Help out instead of blocking. An external thread has no worker index to run a job with
+			if (workerIndex == externalThreadIndex || !TryRunJob(workerIndex))
+				std::this_thread::yield();
+		}
+
+		std::exception_ptr exception;
+		{
+			std::lock_guard<std::mutex> lock(counter.m_exceptionMutex);
+			std::swap(exception, counter.m_exception);
+		}
+
+		if (exception)
+			std::rethrow_exception(exception);
+	}
+
+	uint32_t JobSystem::GetWorkerCount() const
+	{
+		return static_cast<uint32_t>(m_queues.size() - 1);
+	}
+
+	uint32_t JobSystem::CurrentWorkerIndex() const
+	{
+		if (t_ownerSystem == this)
+			return t_workerIndex;
+
+		return (std::this_thread::get_id() == m_ownerThread) ? 0 : externalThreadIndex;
+	}
+}
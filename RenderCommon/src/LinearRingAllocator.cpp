@@ -0,0 +1,86 @@
+#include <LinearRingAllocator.h>
+
+#include <stdexcept>
+
+namespace UltReality::Rendering::Common
+{
+	LinearRingAllocator::LinearRingAllocator(uint64_t capacity)
+		: m_capacity(capacity)
+	{
+		if (capacity == 0)
+			throw std::invalid_argument("LinearRingAllocator capacity must be non-zero");
+	}
+
+	uint64_t LinearRingAllocator::Allocate(uint64_t size, uint64_t alignment)
+	{
+		if (alignment == 0 || (alignment & (alignment - 1)) != 0)
+			throw std::invalid_argument("LinearRingAllocator alignment must be a power of 2");
+
+		if (size == 0 || size > m_capacity || m_usedSize == m_capacity)
+		{
+			++m_overflowCount;
+			return invalidOffset;
+		}
+
+		if (m_tail >= m_head)
+		{
+			// Free space is [tail, capacity) followed by [0, head)
+			const uint64_t alignedTail = AlignUp(m_tail, alignment);
+			if (alignedTail + size <= m_capacity)
+			{
+				const uint64_t consumed = alignedTail + size - m_tail;
+				m_usedSize += consumed;
+				m_currentFrameSize += consumed;
+				m_tail = alignedTail + size;
+
+				return alignedTail;
+			}
+
+			// Offset 0 satisfies any alignment, so wrapping only needs the space below the head
+			if (size <= m_head)
+			{
+				const uint64_t consumed = (m_capacity - m_tail) + size;
+				m_usedSize += consumed;
+				m_currentFrameSize += consumed;
+				m_tail = size;
+
+				return 0;
+			}
+		}
+		else
+		{
+			// Free space is [tail, head)
+			const uint64_t alignedTail = AlignUp(m_tail, alignment);
+			if (alignedTail + size <= m_head)
+			{
+				const uint64_t consumed = alignedTail + size - m_tail;
+				m_usedSize += consumed;
+				m_currentFrameSize += consumed;
+				m_tail = alignedTail + size;
+
+				return alignedTail;
+			}
+		}
+
+		++m_overflowCount;
+		return invalidOffset;
+	}
+
+	void LinearRingAllocator::FinishFrame(uint64_t fenceValue)
+	{
+		m_frames.push_back(FrameMarker{ fenceValue, m_tail, m_currentFrameSize });
+		m_currentFrameSize = 0;
+	}
+
+	void LinearRingAllocator::Retire(uint64_t completedFenceValue)
+	{
+		while (!m_frames.empty() && m_frames.front().fenceValue <= completedFenceValue)
+		{
+			const FrameMarker& frame = m_frames.front();
+			m_head = frame.tail;
+			m_usedSize -= frame.size;
+
+			m_frames.pop_front();
+		}
+	}
+}
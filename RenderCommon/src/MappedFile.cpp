@@ -0,0 +1,135 @@
+#include <MappedFile.h>
+
+#include <stdexcept>
+#include <utility>
+
+#if defined(_WIN_TARGET)
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#endif
+
+namespace UltReality::Rendering::Common
+{
+	MappedFile::MappedFile(const std::string& path)
+	{
+#if defined(_WIN_TARGET)
+		HANDLE file = CreateFileA(path.c_str(), GENERIC_READ, FILE_SHARE_READ, nullptr, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, nullptr);
+		if (file == INVALID_HANDLE_VALUE)
+			throw std::runtime_error("Failed to open file for mapping: " + path);
+
+		m_file = file;
+
+		LARGE_INTEGER size;
+		if (!GetFileSizeEx(file, &size))
+		{
+			Close();
+			throw std::runtime_error("Failed to query the size of: " + path);
+		}
+
+		m_size = static_cast<size_t>(size.QuadPart);
+
+		// Zero sized files can not be mapped
+		if (m_size == 0)
+			return;
+
+		m_mapping = CreateFileMappingA(file, nullptr, PAGE_READONLY, 0, 0, nullptr);
+		if (m_mapping != nullptr)
+			m_data = static_cast<const uint8_t*>(MapViewOfFile(m_mapping, FILE_MAP_READ, 0, 0, 0));
+#else
+		m_file = open(path.c_str(), O_RDONLY);
+		if (m_file < 0)
+			throw std::runtime_error("Failed to open file for mapping: " + path);
+
+		struct stat status;
+		if (fstat(m_file, &status) != 0)
+		{
+			Close();
+			throw std::runtime_error("Failed to query the size of: " + path);
+		}
+
+		m_size = static_cast<size_t>(status.st_size);
+
+		// Zero sized files can not be mapped
+		if (m_size == 0)
+			return;
+
+		void* data = mmap(nullptr, m_size, PROT_READ, MAP_PRIVATE, m_file, 0);
+		if (data != MAP_FAILED)
+			m_data = static_cast<const uint8_t*>(data);
+#endif
+
+		if (m_data == nullptr)
+		{
+			Close();
+			throw std::runtime_error("Failed to map file: " + path);
+		}
+	}
+
+	MappedFile::~MappedFile()
+	{
+		Close();
+	}
+
+	MappedFile::MappedFile(MappedFile&& other) noexcept
+	{
+		*this = std::move(other);
+	}
+
+	MappedFile& MappedFile::operator=(MappedFile&& other) noexcept
+	{
+		if (this != &other)
+		{
+			Close();
+
+			m_data = std::exchange(other.m_data, nullptr);
+			m_size = std::exchange(other.m_size, 0);
+#if defined(_WIN_TARGET)
+			m_file = std::exchange(other.m_file, nullptr);
+			m_mapping = std::exchange(other.m_mapping, nullptr);
+#else
+			m_file = std::exchange(other.m_file, -1);
+#endif
+		}
+
+		return *this;
+	}
+
+	void MappedFile::Close()
+	{
+#if defined(_WIN_TARGET)
+		if (m_data != nullptr)
+			UnmapViewOfFile(m_data);
+		if (m_mapping != nullptr)
+			CloseHandle(m_mapping);
+		if (m_file != nullptr)
+			CloseHandle(m_file);
+
+		m_mapping = nullptr;
+		m_file = nullptr;
+#else
+		if (m_data != nullptr)
+			munmap(const_cast<uint8_t*>(m_data), m_size);
+		if (m_file >= 0)
+			close(m_file);
+
+		m_file = -1;
+#endif
+
+		m_data = nullptr;
+		m_size = 0;
+	}
+
+	const uint8_t* MappedFile::GetData() const
+	{
+		return m_data;
+	}
+
+	size_t MappedFile::GetSize() const
+	{
+		return m_size;
+	}
+}
@@ -0,0 +1,705 @@
+#include <OcclusionCulling.h>
+#include <JobSystem.h>
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <limits>
+#include <stdexcept>
+
+#if defined(_M_X64) || defined(__x86_64__) || defined(_M_IX86) || defined(__i386__)
+#define ULTREALITY_OCCLUSION_X86
+#include <immintrin.h>
+#elif defined(__ARM_NEON) || defined(_M_ARM64) || defined(_M_ARM)
+#define ULTREALITY_OCCLUSION_NEON
+#include <arm_neon.h>
+#endif
+
+// GCC and Clang only emit instructions beyond the baseline in functions that opt into them, MSVC emits any intrinsic
+#if defined(__GNUC__) || defined(__clang__)
+#define ULTREALITY_OCCLUSION_TARGET(isa) __attribute__((target(isa)))
+#else
+#define ULTREALITY_OCCLUSION_TARGET(isa)
+#endif
+
+namespace UltReality::Rendering::Common
+{
+	namespace
+	{
+		// Vertices with a smaller clip w are treated as lying on or behind the eye
+		constexpr float s_minClipW = 1e-5f;
+		constexpr float s_maxPixelCoordinate = 1e9f;
+
+		// Edge functions and depth plane of a triangle as a * x + b * y + c of the pixel center
+		struct TriangleSetup
+		{
+			float edgeA[3];
+			float edgeB[3];
+			float edgeC[3];
+			float depthA;
+			float depthB;
+			float depthC;
+			// Interpolated depth is clamped to the range of the vertices
+			float minDepth;
+			float maxDepth;
+			// Pixel rectangle that can contain covered pixel centers, half open
+			int32_t minX;
+			int32_t minY;
+			int32_t maxX;
+			int32_t maxY;
+		};
+
+		TriangleSetup SetupTriangle(const OccluderTriangle& triangle)
+		{
+			TriangleSetup setup;
+
+			// Edge i lies opposite vertex i, so it is positive inside for a positive area
+			for (uint32_t i = 0; i < 3; i++)
+			{
+				const uint32_t from = (i + 1) % 3;
+				const uint32_t to = (i + 2) % 3;
+				setup.edgeA[i] = triangle.y[from] - triangle.y[to];
+				setup.edgeB[i] = triangle.x[to] - triangle.x[from];
+				setup.edgeC[i] = -(setup.edgeA[i] * triangle.x[from] + setup.edgeB[i] * triangle.y[from]);
+			}
+
+			const float dx1 = triangle.x[1] - triangle.x[0];
+			const float dy1 = triangle.y[1] - triangle.y[0];
+			const float dx2 = triangle.x[2] - triangle.x[0];
+			const float dy2 = triangle.y[2] - triangle.y[0];
+			const float dz1 = triangle.z[1] - triangle.z[0];
+			const float dz2 = triangle.z[2] - triangle.z[0];
+			const float area = dx1 * dy2 - dy1 * dx2;
+
+			setup.depthA = (dz1 * dy2 - dz2 * dy1) / area;
+			setup.depthB = (dz2 * dx1 - dz1 * dx2) / area;
+			setup.depthC = triangle.z[0] - setup.depthA * triangle.x[0] - setup.depthB * triangle.y[0];
+			setup.minDepth = std::min({ triangle.z[0], triangle.z[1], triangle.z[2] });
+			setup.maxDepth = std::max({ triangle.z[0], triangle.z[1], triangle.z[2] });
+
+			// One pixel of margin, so rounding of the edge functions can never reach a center outside the rectangle.
+			// Vertices close to the eye project far off screen, they are clamped before the conversion
+			const auto pixel = [](float coordinate) { return static_cast<int32_t>(std::clamp(coordinate, -s_maxPixelCoordinate, s_maxPixelCoordinate)); };
+			setup.minX = pixel(std::floor(std::min({ triangle.x[0], triangle.x[1], triangle.x[2] }))) - 1;
+			setup.minY = pixel(std::floor(std::min({ triangle.y[0], triangle.y[1], triangle.y[2] }))) - 1;
+			setup.maxX = pixel(std::ceil(std::max({ triangle.x[0], triangle.x[1], triangle.x[2] }))) + 1;
+			setup.maxY = pixel(std::ceil(std::max({ triangle.y[0], triangle.y[1], triangle.y[2] }))) + 1;
+
+			return setup;
+		}
+
+		// Every path evaluates the edge functions and the depth plane with the same operations in the same order and
+		// without fused multiply-adds, so all of them produce the same depth buffer as the reference
+
+		inline void RasterizePixel(const TriangleSetup& setup, uint32_t x, uint32_t y, float& depth)
+		{
+			const float px = static_cast<float>(x) + 0.5f;
+			const float py = static_cast<float>(y) + 0.5f;
+
+			for (uint32_t i = 0; i < 3; i++)
+			{
+				float edge = setup.edgeA[i] * px;
+				edge = edge + setup.edgeB[i] * py;
+				edge = edge + setup.edgeC[i];
+				if (!(edge >= 0.0f))
+					return;
+			}
+
+			float z = setup.depthA * px;
+			z = z + setup.depthB * py;
+			z = z + setup.depthC;
+			z = std::min(std::max(z, setup.minDepth), setup.maxDepth);
+
+			depth = std::min(depth, z);
+		}
+
+		// Rasterizes the pixels [x0, x1) x [y0, y1) of a row-major buffer. x0 and x1 are multiples of 8
+		using TileKernel = void(*)(const TriangleSetup& setup, uint32_t x0, uint32_t x1, uint32_t y0, uint32_t y1, float* depth, uint32_t pitch);
+
+		void RasterizeScalar(const TriangleSetup& setup, uint32_t x0, uint32_t x1, uint32_t y0, uint32_t y1, float* depth, uint32_t pitch)
+		{
+			for (uint32_t y = y0; y < y1; y++)
+			{
+				for (uint32_t x = x0; x < x1; x++)
+					RasterizePixel(setup, x, y, depth[y * pitch + x]);
+			}
+		}
+
+#if defined(ULTREALITY_OCCLUSION_X86)
+		ULTREALITY_OCCLUSION_TARGET("sse2")
+		void RasterizeSse(const TriangleSetup& setup, uint32_t x0, uint32_t x1, uint32_t y0, uint32_t y1, float* depth, uint32_t pitch)
+		{
+			__m128 edgeA[3], edgeC[3];
+			for (uint32_t i = 0; i < 3; i++)
+			{
+				edgeA[i] = _mm_set1_ps(setup.edgeA[i]);
+				edgeC[i] = _mm_set1_ps(setup.edgeC[i]);
+			}
+
+			const __m128 depthA = _mm_set1_ps(setup.depthA);
+			const __m128 depthC = _mm_set1_ps(setup.depthC);
+			const __m128 minDepth = _mm_set1_ps(setup.minDepth);
+			const __m128 maxDepth = _mm_set1_ps(setup.maxDepth);
+			const __m128 laneCenters = _mm_setr_ps(0.5f, 1.5f, 2.5f, 3.5f);
+			const __m128 zero = _mm_setzero_ps();
+
+			for (uint32_t y = y0; y < y1; y++)
+			{
+				const float py = static_cast<float>(y) + 0.5f;
+
+				// Terms of the row are shared by all of its pixels
+				__m128 edgeRow[3];
+				for (uint32_t i = 0; i < 3; i++)
+					edgeRow[i] = _mm_set1_ps(setup.edgeB[i] * py);
+				const __m128 depthRow = _mm_set1_ps(setup.depthB * py);
+
+				float* row = depth + y * pitch;
+				for (uint32_t x = x0; x < x1; x += 4)
+				{
+					const __m128 px = _mm_add_ps(_mm_set1_ps(static_cast<float>(x)), laneCenters);
+
+					__m128 covered = _mm_castsi128_ps(_mm_set1_epi32(-1));
+					for (uint32_t i = 0; i < 3; i++)
+					{
+						__m128 edge = _mm_mul_ps(edgeA[i], px);
+						edge = _mm_add_ps(edge, edgeRow[i]);
+						edge = _mm_add_ps(edge, edgeC[i]);
+						covered = _mm_and_ps(covered, _mm_cmpge_ps(edge, zero));
+					}
+
+					if (_mm_movemask_ps(covered) == 0)
+						continue;
+
+					__m128 z = _mm_mul_ps(depthA, px);
+					z = _mm_add_ps(z, depthRow);
+					z = _mm_add_ps(z, depthC);
+					z = _mm_min_ps(_mm_max_ps(z, minDepth), maxDepth);
+
+					const __m128 current = _mm_loadu_ps(row + x);
+					const __m128 nearest = _mm_min_ps(current, z);
+					_mm_storeu_ps(row + x, _mm_or_ps(_mm_and_ps(covered, nearest), _mm_andnot_ps(covered, current)));
+				}
+			}
+		}
+
+		ULTREALITY_OCCLUSION_TARGET("avx2")
+		void RasterizeAvx2(const TriangleSetup& setup, uint32_t x0, uint32_t x1, uint32_t y0, uint32_t y1, float* depth, uint32_t pitch)
+		{
+			__m256 edgeA[3], edgeC[3];
+			for (uint32_t i = 0; i < 3; i++)
+			{
+				edgeA[i] = _mm256_set1_ps(setup.edgeA[i]);
+				edgeC[i] = _mm256_set1_ps(setup.edgeC[i]);
+			}
+
+			const __m256 depthA = _mm256_set1_ps(setup.depthA);
+			const __m256 depthC = _mm256_set1_ps(setup.depthC);
+			const __m256 minDepth = _mm256_set1_ps(setup.minDepth);
+			const __m256 maxDepth = _mm256_set1_ps(setup.maxDepth);
+			const __m256 laneCenters = _mm256_setr_ps(0.5f, 1.5f, 2.5f, 3.5f, 4.5f, 5.5f, 6.5f, 7.5f);
+			const __m256 zero = _mm256_setzero_ps();
+
+			for (uint32_t y = y0; y < y1; y++)
+			{
+				const float py = static_cast<float>(y) + 0.5f;
+
+				__m256 edgeRow[3];
+				for (uint32_t i = 0; i < 3; i++)
+					edgeRow[i] = _mm256_set1_ps(setup.edgeB[i] * py);
+				const __m256 depthRow = _mm256_set1_ps(setup.depthB * py);
+
+				float* row = depth + y * pitch;
+				for (uint32_t x = x0; x < x1; x += 8)
+				{
+					const __m256 px = _mm256_add_ps(_mm256_set1_ps(static_cast<float>(x)), laneCenters);
+
+					__m256 covered = _mm256_castsi256_ps(_mm256_set1_epi32(-1));
+					for (uint32_t i = 0; i < 3; i++)
+					{
+						__m256 edge = _mm256_mul_ps(edgeA[i], px);
+						edge = _mm256_add_ps(edge, edgeRow[i]);
+						edge = _mm256_add_ps(edge, edgeC[i]);
+						covered = _mm256_and_ps(covered, _mm256_cmp_ps(edge, zero, _CMP_GE_OQ));
+					}
+
+					if (_mm256_movemask_ps(covered) == 0)
+						continue;
+
+					__m256 z = _mm256_mul_ps(depthA, px);
+					z = _mm256_add_ps(z, depthRow);
+					z = _mm256_add_ps(z, depthC);
+					z = _mm256_min_ps(_mm256_max_ps(z, minDepth), maxDepth);
+
+					const __m256 current = _mm256_loadu_ps(row + x);
+					_mm256_storeu_ps(row + x, _mm256_blendv_ps(current, _mm256_min_ps(current, z), covered));
+				}
+			}
+		}
+#endif // ULTREALITY_OCCLUSION_X86
+
+#if defined(ULTREALITY_OCCLUSION_NEON)
+		void RasterizeNeon(const TriangleSetup& setup, uint32_t x0, uint32_t x1, uint32_t y0, uint32_t y1, float* depth, uint32_t pitch)
+		{
+			float32x4_t edgeA[3], edgeC[3];
+			for (uint32_t i = 0; i < 3; i++)
+			{
+				edgeA[i] = vdupq_n_f32(setup.edgeA[i]);
+				edgeC[i] = vdupq_n_f32(setup.edgeC[i]);
+			}
+
+			const float32x4_t depthA = vdupq_n_f32(setup.depthA);
+			const float32x4_t depthC = vdupq_n_f32(setup.depthC);
+			const float32x4_t minDepth = vdupq_n_f32(setup.minDepth);
+			const float32x4_t maxDepth = vdupq_n_f32(setup.maxDepth);
+			static const float laneCenterValues[4] = { 0.5f, 1.5f, 2.5f, 3.5f };
+			const float32x4_t laneCenters = vld1q_f32(laneCenterValues);
+			const float32x4_t zero = vdupq_n_f32(0.0f);
+
+			for (uint32_t y = y0; y < y1; y++)
+			{
+				const float py = static_cast<float>(y) + 0.5f;
+
+				float32x4_t edgeRow[3];
+				for (uint32_t i = 0; i < 3; i++)
+					edgeRow[i] = vdupq_n_f32(setup.edgeB[i] * py);
+				const float32x4_t depthRow = vdupq_n_f32(setup.depthB * py);
+
+				float* row = depth + y * pitch;
+				for (uint32_t x = x0; x < x1; x += 4)
+				{
+					const float32x4_t px = vaddq_f32(vdupq_n_f32(static_cast<float>(x)), laneCenters);
+
+					// Separate multiplies and adds, vmlaq may be fused on some targets
+					uint32x4_t covered = vdupq_n_u32(0xFFFFFFFFu);
+					for (uint32_t i = 0; i < 3; i++)
+					{
+						float32x4_t edge = vmulq_f32(edgeA[i], px);
+						edge = vaddq_f32(edge, edgeRow[i]);
+						edge = vaddq_f32(edge, edgeC[i]);
+						covered = vandq_u32(covered, vcgeq_f32(edge, zero));
+					}
+
+					if (vmaxvq_u32(covered) == 0)
+						continue;
+
+					float32x4_t z = vmulq_f32(depthA, px);
+					z = vaddq_f32(z, depthRow);
+					z = vaddq_f32(z, depthC);
+					z = vminq_f32(vmaxq_f32(z, minDepth), maxDepth);
+
+					const float32x4_t current = vld1q_f32(row + x);
+					vst1q_f32(row + x, vbslq_f32(covered, vminq_f32(current, z), current));
+				}
+			}
+		}
+#endif // ULTREALITY_OCCLUSION_NEON
+
+		TileKernel SelectTileKernel(CullingSimdPath path)
+		{
+			switch (path)
+			{
+#if defined(ULTREALITY_OCCLUSION_X86)
+			case CullingSimdPath::Avx2:
+				return RasterizeAvx2;
+			case CullingSimdPath::Sse:
+				return RasterizeSse;
+#endif
+#if defined(ULTREALITY_OCCLUSION_NEON)
+			case CullingSimdPath::Neon:
+				return RasterizeNeon;
+#endif
+			default:
+				return RasterizeScalar;
+			}
+		}
+
+		// Transforms a position by a row-major, row-vector matrix
+		inline void TransformPoint(const float m[16], float x, float y, float z, float clip[4])
+		{
+			for (uint32_t j = 0; j < 4; j++)
+				clip[j] = x * m[j] + y * m[4 + j] + z * m[8 + j] + m[12 + j];
+		}
+	}
+
+	void RasterizeOccludersReference(const std::vector<OccluderTriangle>& triangles, uint32_t width, uint32_t height, std::vector<float>& depth)
+	{
+		if (depth.size() < static_cast<size_t>(width) * height)
+			throw std::invalid_argument("Depth buffer is smaller than width * height");
+
+		for (const OccluderTriangle& triangle : triangles)
+		{
+			const TriangleSetup setup = SetupTriangle(triangle);
+			for (uint32_t y = 0; y < height; y++)
+			{
+				for (uint32_t x = 0; x < width; x++)
+					RasterizePixel(setup, x, y, depth[y * width + x]);
+			}
+		}
+	}
+
+	OcclusionCuller::OcclusionCuller(JobSystem* jobSystem, uint32_t width, uint32_t height, uint32_t objectsPerJob)
+		: m_jobSystem(jobSystem), m_width(width), m_height(height), m_tileColumns(width / tileWidth), m_tileRows(height / tileHeight),
+		m_objectsPerJob(std::max(objectsPerJob, 1u)), m_simdPath(FrustumCuller::DetectSimdPath())
+	{
+		if (width == 0 || height == 0 || width % tileWidth != 0 || height % tileHeight != 0)
+			throw std::invalid_argument("Occlusion depth buffer size must be a non-zero multiple of the tile size");
+
+		m_tileBins.resize(m_tileColumns * m_tileRows);
+
+		uint32_t levelWidth = width;
+		uint32_t levelHeight = height;
+		m_hiZ.emplace_back(static_cast<size_t>(levelWidth) * levelHeight, 1.0f);
+		m_hiZWidths.push_back(levelWidth);
+		while (levelWidth > 1 || levelHeight > 1)
+		{
+			levelWidth = (levelWidth + 1) / 2;
+			levelHeight = (levelHeight + 1) / 2;
+			m_hiZ.emplace_back(static_cast<size_t>(levelWidth) * levelHeight, 1.0f);
+			m_hiZWidths.push_back(levelWidth);
+		}
+	}
+
+	void OcclusionCuller::BeginFrame(const float viewProjection[16])
+	{
+		std::copy(viewProjection, viewProjection + 16, m_viewProjection);
+
+		m_triangles.clear();
+		for (std::vector<uint32_t>& bin : m_tileBins)
+			bin.clear();
+
+		m_dirty = true;
+	}
+
+	void OcclusionCuller::AddOccluder(const float* positions, uint32_t vertexCount, const uint32_t* indices, uint32_t indexCount)
+	{
+		const float width = static_cast<float>(m_width);
+		const float height = static_cast<float>(m_height);
+
+		for (uint32_t first = 0; first + 3 <= indexCount; first += 3)
+		{
+			OccluderTriangle triangle;
+			bool clipped = false;
+			bool beyondFar = true;
+			for (uint32_t v = 0; v < 3; v++)
+			{
+				const uint32_t index = indices[first + v];
+				if (index >= vertexCount)
+					throw std::out_of_range("Occluder index exceeds the vertex count");
+
+				float clip[4];
+				const float* position = positions + index * 3;
+				TransformPoint(m_viewProjection, position[0], position[1], position[2], clip);
+
+				if (clip[3] < s_minClipW || clip[2] < 0.0f)
+				{
+					clipped = true;
+					break;
+				}
+
+				// Depth buffer rows run top to bottom, clip y bottom to top
+				const float invW = 1.0f / clip[3];
+				triangle.x[v] = (clip[0] * invW * 0.5f + 0.5f) * width;
+				triangle.y[v] = (0.5f - clip[1] * invW * 0.5f) * height;
+				triangle.z[v] = clip[2] * invW;
+				beyondFar = beyondFar && triangle.z[v] > 1.0f;
+			}
+
+			if (clipped || beyondFar)
+				continue;
+
+			// Occluders hide what is behind them from both sides, so back faces are kept and flipped instead
+			const float area = (triangle.x[1] - triangle.x[0]) * (triangle.y[2] - triangle.y[0]) - (triangle.y[1] - triangle.y[0]) * (triangle.x[2] - triangle.x[0]);
+			if (!(std::fabs(area) > 1e-6f))
+				continue;
+			if (area < 0.0f)
+			{
+				std::swap(triangle.x[1], triangle.x[2]);
+				std::swap(triangle.y[1], triangle.y[2]);
+				std::swap(triangle.z[1], triangle.z[2]);
+			}
+
+			const float minX = std::min({ triangle.x[0], triangle.x[1], triangle.x[2] });
+			const float maxX = std::max({ triangle.x[0], triangle.x[1], triangle.x[2] });
+			const float minY = std::min({ triangle.y[0], triangle.y[1], triangle.y[2] });
+			const float maxY = std::max({ triangle.y[0], triangle.y[1], triangle.y[2] });
+			if (maxX < 0.0f || maxY < 0.0f || minX >= width || minY >= height)
+				continue;
+
+			// Bin by the pixel rectangle of the setup, which includes its margin
+			const auto tileOf = [](float coordinate, float margin, uint32_t tileSize, uint32_t tileCount)
+			{
+				const float tile = std::floor((coordinate + margin) / static_cast<float>(tileSize));
+				return static_cast<uint32_t>(std::clamp(tile, 0.0f, static_cast<float>(tileCount - 1)));
+			};
+
+			const uint32_t firstColumn = tileOf(minX, -1.0f, tileWidth, m_tileColumns);
+			const uint32_t lastColumn = tileOf(maxX, 1.0f, tileWidth, m_tileColumns);
+			const uint32_t firstRow = tileOf(minY, -1.0f, tileHeight, m_tileRows);
+			const uint32_t lastRow = tileOf(maxY, 1.0f, tileHeight, m_tileRows);
+
+			const uint32_t triangleIndex = static_cast<uint32_t>(m_triangles.size());
+			m_triangles.push_back(triangle);
+			for (uint32_t row = firstRow; row <= lastRow; row++)
+			{
+				for (uint32_t column = firstColumn; column <= lastColumn; column++)
+					m_tileBins[row * m_tileColumns + column].push_back(triangleIndex);
+			}
+		}
+
+		m_dirty = true;
+	}
+
+	void OcclusionCuller::RasterizeTile(uint32_t tile)
+	{
+		const uint32_t tileX = (tile % m_tileColumns) * tileWidth;
+		const uint32_t tileY = (tile / m_tileColumns) * tileHeight;
+		float* depth = m_hiZ[0].data();
+
+		for (uint32_t y = tileY; y < tileY + tileHeight; y++)
+			std::fill_n(depth + y * m_width + tileX, tileWidth, 1.0f);
+
+		const TileKernel kernel = SelectTileKernel(m_simdPath);
+		for (uint32_t triangleIndex : m_tileBins[tile])
+		{
+			const TriangleSetup setup = SetupTriangle(m_triangles[triangleIndex]);
+
+			// Columns are aligned to 8 pixels, the widest kernel. The extra pixels fail the edge tests
+			const int32_t x0 = std::max(setup.minX, static_cast<int32_t>(tileX)) & ~7;
+			const int32_t x1 = std::min((setup.maxX + 7) & ~7, static_cast<int32_t>(tileX + tileWidth));
+			const int32_t y0 = std::max(setup.minY, static_cast<int32_t>(tileY));
+			const int32_t y1 = std::min(setup.maxY, static_cast<int32_t>(tileY + tileHeight));
+			if (x0 >= x1 || y0 >= y1)
+				continue;
+
+			kernel(setup, static_cast<uint32_t>(x0), static_cast<uint32_t>(x1), static_cast<uint32_t>(y0), static_cast<uint32_t>(y1), depth, m_width);
+		}
+	}
+
+	void OcclusionCuller::BuildHiZ()
+	{
+		for (size_t level = 1; level < m_hiZ.size(); level++)
+		{
+			const std::vector<float>& source = m_hiZ[level - 1];
+			std::vector<float>& destination = m_hiZ[level];
+			const uint32_t sourceWidth = m_hiZWidths[level - 1];
+			const uint32_t sourceHeight = static_cast<uint32_t>(source.size()) / sourceWidth;
+			const uint32_t levelWidth = m_hiZWidths[level];
+			const uint32_t levelHeight = static_cast<uint32_t>(destination.size()) / levelWidth;
+
+			for (uint32_t y = 0; y < levelHeight; y++)
+			{
+				// Odd sizes repeat the last row or column
+				const uint32_t y0 = std::min(y * 2, sourceHeight - 1);
+				const uint32_t y1 = std::min(y * 2 + 1, sourceHeight - 1);
+				for (uint32_t x = 0; x < levelWidth; x++)
+				{
+					const uint32_t x0 = std::min(x * 2, sourceWidth - 1);
+					const uint32_t x1 = std::min(x * 2 + 1, sourceWidth - 1);
+					destination[y * levelWidth + x] = std::max(
+						std::max(source[y0 * sourceWidth + x0], source[y0 * sourceWidth + x1]),
+						std::max(source[y1 * sourceWidth + x0], source[y1 * sourceWidth + x1]));
+				}
+			}
+		}
+	}
+
+	void OcclusionCuller::Rasterize()
+	{
+		const auto start = std::chrono::steady_clock::now();
+
+		const uint32_t tileCount = m_tileColumns * m_tileRows;
+		if (m_jobSystem != nullptr && !m_triangles.empty())
+		{
+			// Tiles own disjoint pixels, so they are rasterized without synchronization
+			JobCounter counter;
+			m_jobSystem->Dispatch(tileCount, 1, [this](uint32_t first, uint32_t last, uint32_t)
+			{
+				for (uint32_t tile = first; tile < last; tile++)
+					RasterizeTile(tile);
+			}, counter);
+			m_jobSystem->Wait(counter);
+		}
+		else
+		{
+			for (uint32_t tile = 0; tile < tileCount; tile++)
+				RasterizeTile(tile);
+		}
+
+		BuildHiZ();
+		m_dirty = false;
+
+		m_statistics.occluderTriangleCount = static_cast<uint32_t>(m_triangles.size());
+		m_statistics.rasterMilliseconds = std::chrono::duration<float, std::milli>(std::chrono::steady_clock::now() - start).count();
+	}
+
+	bool OcclusionCuller::IsBoxVisible(float centerX, float centerY, float centerZ, float extentX, float extentY, float extentZ) const
+	{
+		float minX = std::numeric_limits<float>::max();
+		float minY = std::numeric_limits<float>::max();
+		float maxX = std::numeric_limits<float>::lowest();
+		float maxY = std::numeric_limits<float>::lowest();
+		float nearest = std::numeric_limits<float>::max();
+
+		for (uint32_t corner = 0; corner < 8; corner++)
+		{
+			float clip[4];
+			TransformPoint(m_viewProjection,
+				(corner & 1) != 0 ? centerX + extentX : centerX - extentX,
+				(corner & 2) != 0 ? centerY + extentY : centerY - extentY,
+				(corner & 4) != 0 ? centerZ + extentZ : centerZ - extentZ, clip);
+
+			// Boxes reaching the near plane cover the camera and cannot be hidden
+			if (clip[3] < s_minClipW || clip[2] < 0.0f)
+				return true;
+
+			const float invW = 1.0f / clip[3];
+			const float x = (clip[0] * invW * 0.5f + 0.5f) * static_cast<float>(m_width);
+			const float y = (0.5f - clip[1] * invW * 0.5f) * static_cast<float>(m_height);
+			minX = std::min(minX, x);
+			maxX = std::max(maxX, x);
+			minY = std::min(minY, y);
+			maxY = std::max(maxY, y);
+			nearest = std::min(nearest, clip[2] * invW);
+		}
+
+		// Nothing of the box lands on screen
+		if (maxX < 0.0f || maxY < 0.0f || minX >= static_cast<float>(m_width) || minY >= static_cast<float>(m_height))
+			return false;
+
+		const auto texel = [](float coordinate, uint32_t size)
+		{
+			return static_cast<uint32_t>(std::clamp(std::floor(coordinate), 0.0f, static_cast<float>(size - 1)));
+		};
+
+		const uint32_t x0 = texel(minX, m_width);
+		const uint32_t x1 = texel(maxX, m_width);
+		const uint32_t y0 = texel(minY, m_height);
+		const uint32_t y1 = texel(maxY, m_height);
+
+		// Coarsest level first that still covers the rectangle with at most 2x2 texels
+		uint32_t level = 0;
+		while ((x1 >> level) - (x0 >> level) > 1 || (y1 >> level) - (y0 >> level) > 1)
+			level++;
+
+		// Texel i of a level covers pixels [i << level, (i + 1) << level) of the depth buffer
+		const std::vector<float>& hiZ = m_hiZ[level];
+		const uint32_t pitch = m_hiZWidths[level];
+		for (uint32_t y = y0 >> level; y <= y1 >> level; y++)
+		{
+			for (uint32_t x = x0 >> level; x <= x1 >> level; x++)
+			{
+				if (hiZ[y * pitch + x] >= nearest)
+					return true;
+			}
+		}
+
+		return false;
+	}
+
+	bool OcclusionCuller::IsBoxVisible(const float min[3], const float max[3])
+	{
+		if (m_triangles.empty())
+			return true;
+		if (m_dirty)
+			Rasterize();
+
+		return IsBoxVisible((min[0] + max[0]) * 0.5f, (min[1] + max[1]) * 0.5f, (min[2] + max[2]) * 0.5f,
+			(max[0] - min[0]) * 0.5f, (max[1] - min[1]) * 0.5f, (max[2] - min[2]) * 0.5f);
+	}
+
+	void OcclusionCuller::CullBoxes(const BoundingBoxSoA& boxes, std::vector<uint32_t>& visible)
+	{
+		const uint32_t count = static_cast<uint32_t>(visible.size());
+		m_statistics.testedCount = count;
+		m_statistics.occludedCount = 0;
+		m_statistics.testMilliseconds = 0.0f;
+		if (m_triangles.empty())
+			return;
+		if (m_dirty)
+			Rasterize();
+
+		const auto start = std::chrono::steady_clock::now();
+
+		const uint32_t chunkCount = (count + m_objectsPerJob - 1) / m_objectsPerJob;
+		if (m_chunkVisible.size() < chunkCount)
+			m_chunkVisible.resize(chunkCount);
+
+		auto testChunk = [this, &boxes, &visible](uint32_t first, uint32_t last)
+		{
+			std::vector<uint32_t>& chunkVisible = m_chunkVisible[first / m_objectsPerJob];
+			chunkVisible.clear();
+			for (uint32_t i = first; i < last; i++)
+			{
+				const uint32_t box = visible[i];
+				if (IsBoxVisible(boxes.CenterX()[box], boxes.CenterY()[box], boxes.CenterZ()[box], boxes.ExtentX()[box], boxes.ExtentY()[box], boxes.ExtentZ()[box]))
+					chunkVisible.push_back(box);
+			}
+		};
+
+		if (m_jobSystem != nullptr && chunkCount > 1)
+		{
+			JobCounter counter;
+			m_jobSystem->Dispatch(count, m_objectsPerJob, [&testChunk](uint32_t first, uint32_t last, uint32_t)
+			{
+				testChunk(first, last);
+			}, counter);
+			m_jobSystem->Wait(counter);
+		}
+		else
+		{
+			for (uint32_t first = 0; first < count; first += m_objectsPerJob)
+				testChunk(first, std::min(first + m_objectsPerJob, count));
+		}
+
+		visible.clear();
+		for (uint32_t chunk = 0; chunk < chunkCount; chunk++)
+			visible.insert(visible.end(), m_chunkVisible[chunk].begin(), m_chunkVisible[chunk].end());
+
+		m_statistics.occludedCount = count - static_cast<uint32_t>(visible.size());
+		m_statistics.testMilliseconds = std::chrono::duration<float, std::milli>(std::chrono::steady_clock::now() - start).count();
+	}
+
+	bool OcclusionCuller::HasOccluders() const
+	{
+		return !m_triangles.empty();
+	}
+
+	const std::vector<OccluderTriangle>& OcclusionCuller::GetTriangles() const
+	{
+		return m_triangles;
+	}
+
+	const std::vector<float>& OcclusionCuller::GetDepthBuffer() const
+	{
+		return m_hiZ[0];
+	}
+
+	uint32_t OcclusionCuller::GetWidth() const
+	{
+		return m_width;
+	}
+
+	uint32_t OcclusionCuller::GetHeight() const
+	{
+		return m_height;
+	}
+
+	CullingSimdPath OcclusionCuller::GetSimdPath() const
+	{
+		return m_simdPath;
+	}
+
+	void OcclusionCuller::SetSimdPath(CullingSimdPath path)
+	{
+		if (!FrustumCuller::IsSimdPathSupported(path))
+			throw std::invalid_argument("Culling SIMD path is not supported by this build or CPU");
+
+		m_simdPath = path;
+		m_dirty = true;
+	}
+
+	const OcclusionCuller::Statistics& OcclusionCuller::GetStatistics() const
+	{
+		return m_statistics;
+	}
+}
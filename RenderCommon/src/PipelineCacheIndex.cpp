@@ -0,0 +1,210 @@
+#include <PipelineCacheIndex.h>
+#include <StableHash.h>
+
+#include <algorithm>
+#include <cstdio>
+#include <fstream>
+#include <iterator>
+
+namespace UltReality::Rendering::Common
+{
+	namespace
+	{
+		constexpr size_t s_headerSize = 4 + 4 + 8 + 8 + 4 + 4;
+		constexpr size_t s_entrySize = 8 + 4 + 4;
+		constexpr size_t s_checksumSize = 8;
+
+		template<typename T>
+		void Write(std::vector<uint8_t>& out, T value)
+		{
+			for (size_t i = 0; i < sizeof(T); i++)
+				out.push_back(static_cast<uint8_t>(static_cast<uint64_t>(value) >> (i * 8)));
+		}
+
+		template<typename T>
+		T Read(const uint8_t*& cursor)
+		{
+			uint64_t value = 0;
+			for (size_t i = 0; i < sizeof(T); i++)
+				value |= static_cast<uint64_t>(cursor[i]) << (i * 8);
+
+			cursor += sizeof(T);
+			return static_cast<T>(value);
+		}
+	}
+
+	PipelineCacheIndex::PipelineCacheIndex(uint64_t compatibilityHash)
+		: m_compatibilityHash(compatibilityHash)
+	{}
+
+	bool PipelineCacheIndex::MarkUsed(uint64_t key)
+	{
+		auto [it, inserted] = m_entries.try_emplace(key);
+		PipelineCacheIndexEntry& entry = it->second;
+		entry.key = key;
+
+		// Only count the first request of each run
+		if (inserted || entry.lastUsedRun != m_run)
+		{
+			entry.useCount++;
+			entry.lastUsedRun = m_run;
+		}
+
+		return !inserted;
+	}
+
+	bool PipelineCacheIndex::Contains(uint64_t key) const
+	{
+		return m_entries.find(key) != m_entries.end();
+	}
+
+	void PipelineCacheIndex::Clear()
+	{
+		m_entries.clear();
+	}
+
+	std::vector<uint8_t> PipelineCacheIndex::Serialize() const
+	{
+		const std::vector<PipelineCacheIndexEntry> entries = GetEntries();
+
+		std::vector<uint8_t> out;
+		out.reserve(s_headerSize + entries.size() * s_entrySize + s_checksumSize);
+
+		Write<uint32_t>(out, magic);
+		Write<uint32_t>(out, formatVersion);
+		Write<uint64_t>(out, m_compatibilityHash);
+		Write<uint64_t>(out, m_libraryHash);
+		Write<uint32_t>(out, m_run);
+		Write<uint32_t>(out, static_cast<uint32_t>(entries.size()));
+
+		for (const PipelineCacheIndexEntry& entry : entries)
+		{
+			Write<uint64_t>(out, entry.key);
+			Write<uint32_t>(out, entry.useCount);
+			Write<uint32_t>(out, entry.lastUsedRun);
+		}
+
+		Write<uint64_t>(out, StableHash(out.data(), out.size()));
+
+		return out;
+	}
+
+	PipelineCacheIndex::LoadResult PipelineCacheIndex::Deserialize(const uint8_t* data, size_t size, uint64_t compatibilityHash, uint64_t libraryHash)
+	{
+		m_compatibilityHash = compatibilityHash;
+		m_libraryHash = libraryHash;
+		m_run = 0;
+		m_entries.clear();
+
+		if (size < s_headerSize + s_checksumSize)
+			return LoadResult::Corrupt;
+
+		const uint8_t* checksumCursor = data + size - s_checksumSize;
+		if (Read<uint64_t>(checksumCursor) != StableHash(data, size - s_checksumSize))
+			return LoadResult::Corrupt;
+
+		const uint8_t* cursor = data;
+		if (Read<uint32_t>(cursor) != magic)
+			return LoadResult::Corrupt;
+
+		if (Read<uint32_t>(cursor) != formatVersion)
+			return LoadResult::VersionMismatch;
+
+		if (Read<uint64_t>(cursor) != compatibilityHash)
+			return LoadResult::CompatibilityMismatch;
+
+		if (Read<uint64_t>(cursor) != libraryHash)
+			return LoadResult::LibraryMismatch;
+
+		const uint32_t run = Read<uint32_t>(cursor);
+		const uint32_t entryCount = Read<uint32_t>(cursor);
+		if (size != s_headerSize + static_cast<size_t>(entryCount) * s_entrySize + s_checksumSize)
+			return LoadResult::Corrupt;
+
+		m_entries.reserve(entryCount);
+		for (uint32_t i = 0; i < entryCount; i++)
+		{
+			PipelineCacheIndexEntry entry;
+			entry.key = Read<uint64_t>(cursor);
+			entry.useCount = Read<uint32_t>(cursor);
+			entry.lastUsedRun = Read<uint32_t>(cursor);
+			m_entries[entry.key] = entry;
+		}
+
+		// Every load starts a new run
+		m_run = run + 1;
+
+		return LoadResult::Loaded;
+	}
+
+	PipelineCacheIndex::LoadResult PipelineCacheIndex::LoadFromFile(const std::string& path, uint64_t compatibilityHash, uint64_t libraryHash)
+	{
+		std::ifstream file(path, std::ios::binary);
+		if (!file)
+		{
+			Deserialize(nullptr, 0, compatibilityHash, libraryHash);
+			return LoadResult::Missing;
+		}
+
+		const std::vector<uint8_t> data((std::istreambuf_iterator<char>(file)), std::istreambuf_iterator<char>());
+
+		return Deserialize(data.data(), data.size(), compatibilityHash, libraryHash);
+	}
+
+	bool PipelineCacheIndex::SaveToFile(const std::string& path) const
+	{
+		const std::vector<uint8_t> data = Serialize();
+		const std::string tempPath = path + ".tmp";
+
+		{
+			std::ofstream file(tempPath, std::ios::binary | std::ios::trunc);
+			if (!file)
+				return false;
+
+			file.write(reinterpret_cast<const char*>(data.data()), static_cast<std::streamsize>(data.size()));
+			if (!file)
+				return false;
+		}
+
+		std::remove(path.c_str());
+		return std::rename(tempPath.c_str(), path.c_str()) == 0;
+	}
+
+	void PipelineCacheIndex::SetLibraryHash(uint64_t libraryHash)
+	{
+		m_libraryHash = libraryHash;
+	}
+
+	uint64_t PipelineCacheIndex::GetCompatibilityHash() const
+	{
+		return m_compatibilityHash;
+	}
+
+	uint64_t PipelineCacheIndex::GetLibraryHash() const
+	{
+		return m_libraryHash;
+	}
+
+	uint32_t PipelineCacheIndex::GetRun() const
+	{
+		return m_run;
+	}
+
+	size_t PipelineCacheIndex::GetEntryCount() const
+	{
+		return m_entries.size();
+	}
+
+	std::vector<PipelineCacheIndexEntry> PipelineCacheIndex::GetEntries() const
+	{
+		std::vector<PipelineCacheIndexEntry> entries;
+		entries.reserve(m_entries.size());
+		for (const auto& [key, entry] : m_entries)
+			entries.push_back(entry);
+
+		// unordered_map order is not stable, sorting keeps the file byte identical for identical contents
+		std::sort(entries.begin(), entries.end(), [](const PipelineCacheIndexEntry& a, const PipelineCacheIndexEntry& b) { return a.key < b.key; });
+
+		return entries;
+	}
+}
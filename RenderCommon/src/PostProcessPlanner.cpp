@@ -0,0 +1,179 @@
+#include <PostProcessPlanner.h>
+
+#include <algorithm>
+#include <stdexcept>
+
+namespace UltReality::Rendering::Common
+{
+	namespace
+	{
+		uint32_t LevelSize(uint32_t size, uint32_t level)
+		{
+			return std::max(size >> level, 1u);
+		}
+
+		uint64_t LevelPixels(uint32_t width, uint32_t height, uint32_t level)
+		{
+			return static_cast<uint64_t>(LevelSize(width, level)) * LevelSize(height, level);
+		}
+
+		// Appends the fused passes of <effects>. A pass ends before every effect reading its neighbors, or before
+		// every effect at all when not fusing. Without effects a single pass still copies the scene to the output
+		void AppendFusedPasses(PostEffect effects, bool fuse, uint32_t width, uint32_t height, std::vector<PostProcessPass>& passes, uint32_t& intermediateCount)
+		{
+			std::vector<PostEffect> groups;
+			PostEffect group = PostEffect::None;
+			for (uint32_t bit = 0; bit < postEffectCount; bit++)
+			{
+				const PostEffect effect = static_cast<PostEffect>(1u << bit);
+				if ((effects & effect) == PostEffect::None)
+					continue;
+
+				if (group != PostEffect::None && (!fuse || PostEffectReadsNeighbors(effect)))
+				{
+					groups.push_back(group);
+					group = PostEffect::None;
+				}
+				group |= effect;
+			}
+			groups.push_back(group);
+
+			// Passes alternate between two intermediates, a pass never reads the target it writes
+			const uint32_t groupCount = static_cast<uint32_t>(groups.size());
+			for (uint32_t i = 0; i < groupCount; i++)
+			{
+				PostProcessPass pass;
+				pass.type = PostProcessPass::Type::Fused;
+				pass.effects = groups[i];
+				pass.input = i == 0
+					? PostProcessTarget{ PostProcessTarget::Kind::SceneColor, 0 }
+					: PostProcessTarget{ PostProcessTarget::Kind::Intermediate, (i - 1) % 2 };
+				pass.output = i + 1 == groupCount
+					? PostProcessTarget{ PostProcessTarget::Kind::Output, 0 }
+					: PostProcessTarget{ PostProcessTarget::Kind::Intermediate, i % 2 };
+				pass.width = width;
+				pass.height = height;
+				passes.push_back(pass);
+			}
+
+			intermediateCount = std::min(groupCount - 1, 2u);
+		}
+
+		uint64_t PassBandwidth(const PostProcessPass& pass, uint32_t width, uint32_t height)
+		{
+			const uint64_t outputPixels = static_cast<uint64_t>(pass.width) * pass.height;
+			switch (pass.type)
+			{
+			case PostProcessPass::Type::Downsample:
+			{
+				const uint32_t inputLevel = pass.input.kind == PostProcessTarget::Kind::SceneColor ? 0 : pass.input.index;
+				return (LevelPixels(width, height, inputLevel) + outputPixels) * postProcessColorBytes;
+			}
+			case PostProcessPass::Type::Upsample:
+				// Reads the bloom below and the pyramid level of the size it writes
+				return (LevelPixels(width, height, pass.input.index) + 2 * outputPixels) * postProcessColorBytes;
+			case PostProcessPass::Type::Exposure:
+				return LevelPixels(width, height, pass.input.index) * postProcessColorBytes + 2 * sizeof(float);
+			case PostProcessPass::Type::Fused:
+			default:
+			{
+				uint64_t bytes = outputPixels * postProcessColorBytes;
+				bytes += outputPixels * (pass.output.kind == PostProcessTarget::Kind::Output ? postProcessOutputBytes : postProcessColorBytes);
+				if ((pass.effects & PostEffect::Bloom) != PostEffect::None)
+					bytes += LevelPixels(width, height, 1) * postProcessColorBytes;
+				if ((pass.effects & PostEffect::AutoExposure) != PostEffect::None)
+					bytes += sizeof(float);
+				return bytes;
+			}
+			}
+		}
+	}
+
+	void BuildPostProcessPlan(const PostProcessConfig& config, uint32_t width, uint32_t height, PostProcessPlan& plan)
+	{
+		if (width == 0 || height == 0)
+			throw std::invalid_argument("Post-processing needs a non-empty image");
+
+		const bool bloom = (config.effects & PostEffect::Bloom) != PostEffect::None;
+		const bool autoExposure = (config.effects & PostEffect::AutoExposure) != PostEffect::None;
+		if (bloom && config.bloomLevels == 0)
+			throw std::invalid_argument("Bloom needs at least one pyramid level");
+		if (autoExposure && config.exposureReduceSize == 0)
+			throw std::invalid_argument("Auto exposure reduce size must not be zero");
+
+		plan = PostProcessPlan();
+
+		// Levels past the one that reaches a single pixel would only repeat it
+		uint32_t maxLevels = 1;
+		while (LevelSize(width, maxLevels) > 1 || LevelSize(height, maxLevels) > 1)
+			maxLevels++;
+
+		plan.bloomLevels = bloom ? std::min(config.bloomLevels, maxLevels) : 0;
+		if (autoExposure)
+		{
+			plan.exposureLevel = 1;
+			while (std::max(LevelSize(width, plan.exposureLevel), LevelSize(height, plan.exposureLevel)) > config.exposureReduceSize)
+				plan.exposureLevel++;
+		}
+		plan.pyramidLevels = std::max(plan.bloomLevels, plan.exposureLevel);
+
+		for (uint32_t level = 1; level <= plan.pyramidLevels; level++)
+		{
+			PostProcessPass pass;
+			pass.type = PostProcessPass::Type::Downsample;
+			pass.input = level == 1
+				? PostProcessTarget{ PostProcessTarget::Kind::SceneColor, 0 }
+				: PostProcessTarget{ PostProcessTarget::Kind::Pyramid, level - 1 };
+			pass.output = { PostProcessTarget::Kind::Pyramid, level };
+			pass.width = LevelSize(width, level);
+			pass.height = LevelSize(height, level);
+			plan.passes.push_back(pass);
+		}
+
+		if (autoExposure)
+		{
+			PostProcessPass pass;
+			pass.type = PostProcessPass::Type::Exposure;
+			pass.input = { PostProcessTarget::Kind::Pyramid, plan.exposureLevel };
+			pass.output = { PostProcessTarget::Kind::Exposure, 0 };
+			pass.width = 1;
+			pass.height = 1;
+			plan.passes.push_back(pass);
+		}
+
+		// The deepest bloom level is the pyramid level itself
+		if (bloom)
+			plan.bloomSource = { PostProcessTarget::Kind::Pyramid, plan.bloomLevels };
+		for (uint32_t level = plan.bloomLevels; level > 1; level--)
+		{
+			PostProcessPass pass;
+			pass.type = PostProcessPass::Type::Upsample;
+			pass.input = plan.bloomSource;
+			pass.output = { PostProcessTarget::Kind::Bloom, level - 1 };
+			pass.width = LevelSize(width, level - 1);
+			pass.height = LevelSize(height, level - 1);
+			plan.passes.push_back(pass);
+			plan.bloomSource = pass.output;
+		}
+
+		const size_t prerequisiteCount = plan.passes.size();
+		AppendFusedPasses(config.effects, true, width, height, plan.passes, plan.intermediateCount);
+		plan.fullResolutionPasses = static_cast<uint32_t>(plan.passes.size() - prerequisiteCount);
+
+		uint64_t prerequisiteBytes = 0;
+		for (size_t i = 0; i < plan.passes.size(); i++)
+		{
+			const uint64_t bytes = PassBandwidth(plan.passes[i], width, height);
+			plan.bandwidthBytes += bytes;
+			if (i < prerequisiteCount)
+				prerequisiteBytes += bytes;
+		}
+
+		std::vector<PostProcessPass> unfused;
+		uint32_t unfusedIntermediates = 0;
+		AppendFusedPasses(config.effects, false, width, height, unfused, unfusedIntermediates);
+		plan.unfusedBandwidthBytes = prerequisiteBytes;
+		for (const PostProcessPass& pass : unfused)
+			plan.unfusedBandwidthBytes += PassBandwidth(pass, width, height);
+	}
+}
@@ -0,0 +1,240 @@
+#include <QueueScheduler.h>
+
+#include <algorithm>
+#include <array>
+#include <stdexcept>
+
+namespace UltReality::Rendering::Common
+{
+	namespace
+	{
+		// Per queue, the last submission known to have completed. -1 when none is
+		using VectorClock = std::array<int64_t, queueTypeCount>;
+
+		constexpr VectorClock s_emptyClock = { -1, -1, -1 };
+
+		uint32_t QueueIndex(QueueType queue)
+		{
+			return static_cast<uint32_t>(queue);
+		}
+
+		void Merge(VectorClock& clock, const VectorClock& other)
+		{
+			for (uint32_t i = 0; i < queueTypeCount; i++)
+				clock[i] = std::max(clock[i], other[i]);
+		}
+
+		bool Covers(const VectorClock& clock, const std::vector<QueueSubmission>& submissions, uint32_t submission)
+		{
+			return clock[QueueIndex(submissions[submission].queue)] >= static_cast<int64_t>(submission);
+		}
+
+		/// <summary>
+		/// Picks the waits a queue at <paramref name="known"/> needs to reach every submission in <paramref name="targets"/>.
+		/// A target is dropped when the queue already covers it or another target covers it transitively
+		/// </summary>
+		std::vector<uint32_t> MinimalWaits(const std::vector<QueueSubmission>& submissions, const std::vector<VectorClock>& completionClocks,
+			const VectorClock& known, const std::array<int64_t, queueTypeCount>& targets)
+		{
+			std::vector<uint32_t> candidates;
+			for (uint32_t queue = 0; queue < queueTypeCount; queue++)
+			{
+				if (targets[queue] > known[queue])
+					candidates.push_back(static_cast<uint32_t>(targets[queue]));
+			}
+
+			std::vector<uint32_t> waits;
+			for (uint32_t candidate : candidates)
+			{
+				const bool covered = std::any_of(candidates.begin(), candidates.end(), [&](uint32_t other)
+				{
+					return other != candidate && Covers(completionClocks[other], submissions, candidate);
+				});
+
+				if (!covered)
+					waits.push_back(candidate);
+			}
+
+			return waits;
+		}
+	}
+
+	uint32_t QueueScheduler::Add(QueueType queue, std::initializer_list<uint32_t> dependencies)
+	{
+		return Add(queue, std::vector<uint32_t>(dependencies));
+	}
+
+	uint32_t QueueScheduler::Add(QueueType queue, const std::vector<uint32_t>& dependencies)
+	{
+		if (queue >= QueueType::Count)
+			throw std::invalid_argument("Submission targets an unknown queue");
+
+		const uint32_t index = static_cast<uint32_t>(m_submissions.size());
+
+		// A queue waiting on work submitted after it could deadlock the GPU
+		for (uint32_t dependency : dependencies)
+		{
+			if (dependency >= index)
+				throw std::invalid_argument("A submission can only depend on earlier submissions");
+		}
+
+		m_submissions.push_back(QueueSubmission{ queue, dependencies });
+
+		return index;
+	}
+
+	QueueSchedule QueueScheduler::Resolve(QueueType joinQueue) const
+	{
+		QueueSchedule schedule;
+		schedule.submissions.resize(m_submissions.size());
+
+		std::array<VectorClock, queueTypeCount> queueClocks;
+		queueClocks.fill(s_emptyClock);
+
+		// Clock of a submission's queue once the submission completed
+		std::vector<VectorClock> completionClocks(m_submissions.size());
+
+		for (uint32_t index = 0; index < m_submissions.size(); index++)
+		{
+			const QueueSubmission& submission = m_submissions[index];
+			const uint32_t queue = QueueIndex(submission.queue);
+			VectorClock& clock = queueClocks[queue];
+
+			// Only the latest dependency per queue matters, earlier ones on that queue completed before it
+			std::array<int64_t, queueTypeCount> targets;
+			targets.fill(-1);
+			for (uint32_t dependency : submission.dependencies)
+			{
+				const uint32_t dependencyQueue = QueueIndex(m_submissions[dependency].queue);
+				if (dependencyQueue != queue)
+					targets[dependencyQueue] = std::max<int64_t>(targets[dependencyQueue], dependency);
+			}
+
+			ScheduledSubmission& scheduled = schedule.submissions[index];
+			scheduled.waits = MinimalWaits(m_submissions, completionClocks, clock, targets);
+
+			for (uint32_t wait : scheduled.waits)
+			{
+				schedule.submissions[wait].signal = true;
+				Merge(clock, completionClocks[wait]);
+			}
+
+			clock[queue] = index;
+			completionClocks[index] = clock;
+		}
+
+		// Join every queue's last submission, so a fence signalled on the join queue afterwards covers the whole batch
+		const uint32_t join = QueueIndex(joinQueue);
+		std::array<int64_t, queueTypeCount> lastSubmissions;
+		lastSubmissions.fill(-1);
+		for (uint32_t index = 0; index < m_submissions.size(); index++)
+		{
+			const uint32_t queue = QueueIndex(m_submissions[index].queue);
+			if (queue != join)
+				lastSubmissions[queue] = index;
+		}
+
+		schedule.joinWaits = MinimalWaits(m_submissions, completionClocks, queueClocks[join], lastSubmissions);
+		for (uint32_t wait : schedule.joinWaits)
+			schedule.submissions[wait].signal = true;
+
+		return schedule;
+	}
+
+	QueueSimulationResult QueueScheduler::Simulate(const std::vector<QueueSubmission>& submissions, const QueueSchedule& schedule)
+	{
+		QueueSimulationResult result;
+		result.dependenciesSatisfied = true;
+
+		if (schedule.submissions.size() != submissions.size())
+			return result;
+
+		std::array<std::vector<uint32_t>, queueTypeCount> queueSubmissions;
+		for (uint32_t index = 0; index < submissions.size(); index++)
+			queueSubmissions[QueueIndex(submissions[index].queue)].push_back(index);
+
+		std::array<size_t, queueTypeCount> next{};
+		std::array<VectorClock, queueTypeCount> queueClocks;
+		queueClocks.fill(s_emptyClock);
+
+		std::vector<bool> completed(submissions.size(), false);
+		std::vector<VectorClock> completionClocks(submissions.size(), s_emptyClock);
+
+		size_t completedCount = 0;
+		bool progress = true;
+		while (progress)
+		{
+			progress = false;
+
+			for (uint32_t queue = 0; queue < queueTypeCount; queue++)
+			{
+				if (next[queue] >= queueSubmissions[queue].size())
+					continue;
+
+				const uint32_t index = queueSubmissions[queue][next[queue]];
+				const ScheduledSubmission& scheduled = schedule.submissions[index];
+
+				// A queue blocks until the submissions it waits for have signalled
+				const bool ready = std::all_of(scheduled.waits.begin(), scheduled.waits.end(), [&](uint32_t wait)
+				{
+					return wait < submissions.size() && completed[wait] && schedule.submissions[wait].signal;
+				});
+
+				if (!ready)
+					continue;
+
+				VectorClock& clock = queueClocks[queue];
+				for (uint32_t wait : scheduled.waits)
+				{
+					// Redundant if the queue's own order and its other waits already guarantee the target
+					VectorClock withoutWait = clock;
+					for (uint32_t other : scheduled.waits)
+					{
+						if (other != wait)
+							Merge(withoutWait, completionClocks[other]);
+					}
+
+					if (Covers(withoutWait, submissions, wait))
+						result.redundantWaits++;
+				}
+
+				for (uint32_t wait : scheduled.waits)
+					Merge(clock, completionClocks[wait]);
+
+				// Work on another queue only happened before this submission if a chain of waits orders them
+				for (uint32_t dependency : submissions[index].dependencies)
+				{
+					if (QueueIndex(submissions[dependency].queue) != queue && !Covers(clock, submissions, dependency))
+						result.dependenciesSatisfied = false;
+				}
+
+				clock[queue] = index;
+				completionClocks[index] = clock;
+				completed[index] = true;
+				completedCount++;
+
+				next[queue]++;
+				progress = true;
+			}
+		}
+
+		result.completed = completedCount == submissions.size();
+
+		return result;
+	}
+
+	const std::vector<QueueSubmission>& QueueScheduler::GetSubmissions() const
+	{
+		return m_submissions;
+	}
+
+	uint32_t QueueScheduler::GetSubmissionCount() const
+	{
+		return static_cast<uint32_t>(m_submissions.size());
+	}
+
+	void QueueScheduler::Reset()
+	{
+		m_submissions.clear();
+	}
+}
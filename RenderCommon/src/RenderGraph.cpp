@@ -0,0 +1,445 @@
+#include <RenderGraph.h>
+
+#include <algorithm>
+#include <stdexcept>
+
+namespace UltReality::Rendering::Common
+{
+	RenderGraphResource RenderGraph::ImportResource(const std::string& name, ResourceState initialState, ResourceState finalState)
+	{
+		m_resources.push_back(ResourceNode{ name, true, initialState, finalState, 0, 0 });
+
+		return static_cast<RenderGraphResource>(m_resources.size() - 1);
+	}
+
+	RenderGraphResource RenderGraph::CreateTransient(const std::string& name, uint64_t size, uint64_t alignment)
+	{
+		if (size == 0 || alignment == 0 || (alignment & (alignment - 1)) != 0)
+			throw std::invalid_argument("RenderGraph transient resources need a size and a power of 2 alignment");
+
+		m_resources.push_back(ResourceNode{ name, false, ResourceState::Common, ResourceState::Common, size, alignment });
+
+		return static_cast<RenderGraphResource>(m_resources.size() - 1);
+	}
+
+	uint32_t RenderGraph::AddPass(const std::string& name, bool hasSideEffects)
+	{
+		m_passes.push_back(PassNode{ name, hasSideEffects, {} });
+
+		return static_cast<uint32_t>(m_passes.size() - 1);
+	}
+
+	void RenderGraph::Read(uint32_t pass, RenderGraphResource resource, ResourceState state)
+	{
+		if (resource >= m_resources.size())
+			throw std::out_of_range("RenderGraph::Read called with an unknown resource");
+
+		m_passes.at(pass).uses.push_back(ResourceUse{ resource, state, false });
+	}
+
+	void RenderGraph::Write(uint32_t pass, RenderGraphResource resource, ResourceState state)
+	{
+		if (resource >= m_resources.size())
+			throw std::out_of_range("RenderGraph::Write called with an unknown resource");
+
+		m_passes.at(pass).uses.push_back(ResourceUse{ resource, state, true });
+	}
+
+	ResourceState RenderGraph::MergedPassState(uint32_t pass, RenderGraphResource resource, bool& writes) const
+	{
+		// A pass may declare several uses of one resource, e.g. reading depth in two shader stages
+		ResourceState state = ResourceState::Common;
+		writes = false;
+		for (const ResourceUse& use : m_passes[pass].uses)
+		{
+			if (use.resource != resource)
+				continue;
+
+			state |= use.state;
+			writes |= use.write;
+		}
+
+		return state;
+	}
+
+	void RenderGraph::CullPasses(std::vector<uint32_t>& order)
+	{
+		// Walk backwards from the graph outputs. Imported resources outlive the graph,
+		// so anything written to them is consumed
+		std::vector<bool> needed(m_resources.size(), false);
+		for (size_t r = 0; r < m_resources.size(); r++)
+			needed[r] = m_resources[r].imported;
+
+		std::vector<bool> kept(m_passes.size(), false);
+		for (size_t p = m_passes.size(); p-- > 0;)
+		{
+			const PassNode& pass = m_passes[p];
+
+			bool isKept = pass.hasSideEffects;
+			for (const ResourceUse& use : pass.uses)
+				isKept |= use.write && needed[use.resource];
+
+			if (!isKept)
+				continue;
+
+			kept[p] = true;
+
+			// Writes stay needed as well, a write may only touch part of the resource
+			for (const ResourceUse& use : pass.uses)
+				needed[use.resource] = true;
+		}
+
+		for (uint32_t p = 0; p < m_passes.size(); p++)
+		{
+			if (kept[p])
+				order.push_back(p);
+			else
+				m_compiled.culledPasses.push_back(p);
+		}
+	}
+
+	void RenderGraph::PlaceTransients(const std::vector<uint32_t>& order)
+	{
+		// Lifetime of every transient in compiled pass order
+		std::vector<RenderGraphTransientPlacement> placements;
+		std::vector<uint32_t> placementOf(m_resources.size(), UINT32_MAX);
+		for (uint32_t position = 0; position < order.size(); position++)
+		{
+			for (const ResourceUse& use : m_passes[order[position]].uses)
+			{
+				if (m_resources[use.resource].imported)
+					continue;
+
+				if (placementOf[use.resource] == UINT32_MAX)
+				{
+					if (!use.write)
+						throw std::logic_error("RenderGraph transient '" + m_resources[use.resource].name + "' is read before it is written");
+
+					placementOf[use.resource] = static_cast<uint32_t>(placements.size());
+
+					RenderGraphTransientPlacement placement;
+					placement.resource = use.resource;
+					placement.size = m_resources[use.resource].size;
+					placement.firstUse = position;
+					placement.lastUse = position;
+					placements.push_back(placement);
+				}
+				else
+				{
+					placements[placementOf[use.resource]].lastUse = position;
+				}
+			}
+		}
+
+		// Place the largest resources first, each at the lowest offset that does not
+		// overlap in memory with a placed resource whose lifetime overlaps its own
+		std::vector<uint32_t> placementOrder(placements.size());
+		for (uint32_t i = 0; i < placementOrder.size(); i++)
+			placementOrder[i] = i;
+
+		std::stable_sort(placementOrder.begin(), placementOrder.end(), [&](uint32_t a, uint32_t b) { return placements[a].size > placements[b].size; });
+
+		std::vector<uint32_t> placed;
+		for (uint32_t index : placementOrder)
+		{
+			RenderGraphTransientPlacement& current = placements[index];
+			const uint64_t alignment = m_resources[current.resource].alignment;
+
+			std::vector<std::pair<uint64_t, uint64_t>> occupied;
+			for (uint32_t other : placed)
+			{
+				const RenderGraphTransientPlacement& o = placements[other];
+				if (o.lastUse >= current.firstUse && current.lastUse >= o.firstUse)
+					occupied.emplace_back(o.offset, o.offset + o.size);
+			}
+			std::sort(occupied.begin(), occupied.end());
+
+			uint64_t offset = 0;
+			for (const auto& [begin, end] : occupied)
+			{
+				if (offset + current.size <= begin)
+					break;
+
+				offset = std::max(offset, (end + alignment - 1) & ~(alignment - 1));
+			}
+
+			current.offset = offset;
+			placed.push_back(index);
+
+			m_compiled.transientMemoryUnaliased += (current.size + alignment - 1) & ~(alignment - 1);
+			m_compiled.transientMemoryAliased = std::max(m_compiled.transientMemoryAliased, offset + current.size);
+		}
+
+		m_compiled.transients = std::move(placements);
+	}
+
+	void RenderGraph::BuildBarriers(const std::vector<uint32_t>& order)
+	{
+		std::vector<ResourceState> currentState(m_resources.size(), ResourceState::Common);
+		std::vector<bool> initialized(m_resources.size(), false);
+		std::vector<bool> lastUseWasUnorderedWrite(m_resources.size(), false);
+		// Position of the last compiled pass that used each resource
+		std::vector<uint32_t> lastUsePosition(m_resources.size(), UINT32_MAX);
+
+		for (size_t r = 0; r < m_resources.size(); r++)
+		{
+			if (m_resources[r].imported)
+			{
+				currentState[r] = m_resources[r].initialState;
+				initialized[r] = true;
+			}
+		}
+
+		std::vector<uint32_t> placementOf(m_resources.size(), UINT32_MAX);
+		for (uint32_t i = 0; i < m_compiled.transients.size(); i++)
+			placementOf[m_compiled.transients[i].resource] = i;
+
+		for (uint32_t position = 0; position < order.size(); position++)
+		{
+			const uint32_t passIndex = order[position];
+			RenderGraphCompiledPass compiledPass;
+			compiledPass.passIndex = passIndex;
+
+			std::vector<RenderGraphResource> visited;
+			for (const ResourceUse& use : m_passes[passIndex].uses)
+			{
+				const RenderGraphResource resource = use.resource;
+				if (std::find(visited.begin(), visited.end(), resource) != visited.end())
+					continue;
+				visited.push_back(resource);
+
+				bool writes;
+				ResourceState required = MergedPassState(passIndex, resource, writes);
+
+				// Read-only runs are merged into one transition to the union of their
+				// read states, so consecutive readers do not transition again
+				if (!writes && IsReadOnlyState(required))
+				{
+					for (uint32_t next = position + 1; next < order.size(); next++)
+					{
+						bool nextWrites;
+						const ResourceState nextState = MergedPassState(order[next], resource, nextWrites);
+						if (nextState == ResourceState::Common && !nextWrites)
+							continue;
+
+						if (nextWrites || !IsReadOnlyState(nextState))
+							break;
+
+						required |= nextState;
+					}
+				}
+
+				if (!initialized[resource])
+				{
+					// First use of a transient. It is created directly in the required state,
+					// but the memory may still belong to a resource that died earlier
+					RenderGraphTransientPlacement& placement = m_compiled.transients[placementOf[resource]];
+					placement.initialState = required;
+
+					RenderGraphResource previousOccupant = invalidRenderGraphResource;
+					uint32_t previousLastUse = 0;
+					for (const RenderGraphTransientPlacement& other : m_compiled.transients)
+					{
+						const bool overlapsMemory = other.offset < placement.offset + placement.size && placement.offset < other.offset + other.size;
+						if (other.resource != resource && overlapsMemory && other.lastUse < position && (previousOccupant == invalidRenderGraphResource || other.lastUse >= previousLastUse))
+						{
+							previousOccupant = other.resource;
+							previousLastUse = other.lastUse;
+						}
+					}
+
+					if (previousOccupant != invalidRenderGraphResource)
+					{
+						RenderGraphBarrier barrier;
+						barrier.type = RenderGraphBarrier::Type::Aliasing;
+						barrier.resource = resource;
+						barrier.aliasBefore = previousOccupant;
+						compiledPass.barriers.push_back(barrier);
+					}
+
+					currentState[resource] = required;
+					initialized[resource] = true;
+				}
+				else if (StateSatisfies(currentState[resource], required))
+				{
+					// Back to back unordered access still has to be ordered
+					if (lastUseWasUnorderedWrite[resource] && (required & ResourceState::UnorderedAccess) == ResourceState::UnorderedAccess)
+					{
+						RenderGraphBarrier barrier;
+						barrier.type = RenderGraphBarrier::Type::UnorderedAccess;
+						barrier.resource = resource;
+						compiledPass.barriers.push_back(barrier);
+					}
+				}
+				else
+				{
+					RenderGraphBarrier barrier;
+					barrier.type = RenderGraphBarrier::Type::Transition;
+					barrier.resource = resource;
+					barrier.stateBefore = currentState[resource];
+					barrier.stateAfter = required;
+
+					// Begin the transition right after the last pass that used the resource when other passes
+					// run in between, and only wait for it to complete here
+					const uint32_t lastUse = lastUsePosition[resource];
+					if (lastUse != UINT32_MAX && position - lastUse >= 2)
+					{
+						RenderGraphBarrier begin = barrier;
+						begin.split = RenderGraphBarrier::Split::Begin;
+						m_compiled.passes[lastUse + 1].barriers.push_back(begin);
+
+						barrier.split = RenderGraphBarrier::Split::End;
+					}
+
+					compiledPass.barriers.push_back(barrier);
+
+					currentState[resource] = required;
+				}
+
+				lastUseWasUnorderedWrite[resource] = writes && (required & ResourceState::UnorderedAccess) == ResourceState::UnorderedAccess;
+				lastUsePosition[resource] = position;
+			}
+
+			m_compiled.passes.push_back(std::move(compiledPass));
+		}
+
+		for (RenderGraphResource r = 0; r < m_resources.size(); r++)
+		{
+			if (!m_resources[r].imported || currentState[r] == m_resources[r].finalState)
+				continue;
+
+			RenderGraphBarrier barrier;
+			barrier.type = RenderGraphBarrier::Type::Transition;
+			barrier.resource = r;
+			barrier.stateBefore = currentState[r];
+			barrier.stateAfter = m_resources[r].finalState;
+			m_compiled.finalBarriers.push_back(barrier);
+		}
+
+		// Counted once every pass is built, split begins are added to earlier batches
+		for (const RenderGraphCompiledPass& compiledPass : m_compiled.passes)
+		{
+			m_compiled.barrierCount += static_cast<uint32_t>(compiledPass.barriers.size());
+			m_compiled.barrierBatchCount += compiledPass.barriers.empty() ? 0 : 1;
+		}
+
+		m_compiled.barrierCount += static_cast<uint32_t>(m_compiled.finalBarriers.size());
+		m_compiled.barrierBatchCount += m_compiled.finalBarriers.empty() ? 0 : 1;
+	}
+
+	const CompiledRenderGraph& RenderGraph::Compile()
+	{
+		m_compiled = CompiledRenderGraph();
+
+		std::vector<uint32_t> order;
+		CullPasses(order);
+		PlaceTransients(order);
+		BuildBarriers(order);
+
+		return m_compiled;
+	}
+
+	void RenderGraph::Reset()
+	{
+		m_resources.clear();
+		m_passes.clear();
+		m_compiled = CompiledRenderGraph();
+	}
+
+	const CompiledRenderGraph& RenderGraph::GetCompiled() const
+	{
+		return m_compiled;
+	}
+
+	const std::string& RenderGraph::GetPassName(uint32_t pass) const
+	{
+		return m_passes.at(pass).name;
+	}
+
+	const std::string& RenderGraph::GetResourceName(RenderGraphResource resource) const
+	{
+		return m_resources.at(resource).name;
+	}
+
+	bool RenderGraph::IsImported(RenderGraphResource resource) const
+	{
+		return m_resources.at(resource).imported;
+	}
+
+	uint32_t RenderGraph::GetPassCount() const
+	{
+		return static_cast<uint32_t>(m_passes.size());
+	}
+
+	uint32_t RenderGraph::GetResourceCount() const
+	{
+		return static_cast<uint32_t>(m_resources.size());
+	}
+
+	void TransientMemoryHistory::Occupy(uint64_t offset, uint64_t size, uint64_t occupant)
+	{
+		if (size == 0 || occupant == noOccupant || occupant == severalOccupants)
+			throw std::invalid_argument("TransientMemoryHistory occupants need a size and a valid id");
+
+		const uint64_t end = offset + size;
+		m_scratch.clear();
+		bool inserted = false;
+		for (const Range& range : m_ranges)
+		{
+			if (range.end <= offset)
+			{
+				m_scratch.push_back(range);
+				continue;
+			}
+
+			// Whatever is left of an overlapped range before the new one stays in front of it
+			if (range.begin < offset)
+				m_scratch.push_back(Range{ range.begin, offset, range.occupant });
+
+			if (!inserted)
+			{
+				m_scratch.push_back(Range{ offset, end, occupant });
+				inserted = true;
+			}
+
+			if (range.begin >= end)
+				m_scratch.push_back(range);
+			else if (range.end > end)
+				m_scratch.push_back(Range{ end, range.end, range.occupant });
+		}
+
+		if (!inserted)
+			m_scratch.push_back(Range{ offset, end, occupant });
+
+		m_ranges.swap(m_scratch);
+	}
+
+	uint64_t TransientMemoryHistory::FindPreviousOccupant(uint64_t offset, uint64_t size, uint64_t occupant) const
+	{
+		const uint64_t end = offset + size;
+		uint64_t previous = noOccupant;
+		for (const Range& range : m_ranges)
+		{
+			if (range.begin >= end)
+				break;
+			if (range.end <= offset || range.occupant == occupant || range.occupant == previous)
+				continue;
+
+			if (previous != noOccupant)
+				return severalOccupants;
+			previous = range.occupant;
+		}
+
+		return previous;
+	}
+
+	void TransientMemoryHistory::Clear()
+	{
+		m_ranges.clear();
+	}
+
+	uint32_t TransientMemoryHistory::GetRangeCount() const
+	{
+		return static_cast<uint32_t>(m_ranges.size());
+	}
+}
@@ -0,0 +1,271 @@
+#include <ResourceStateTracker.h>
+
+#include <stdexcept>
+
+namespace UltReality::Rendering::Common
+{
+	void ResourceStateTable::Register(TrackedResource resource, ResourceState state)
+	{
+		std::lock_guard<std::mutex> lock(m_mutex);
+		m_states[resource] = state;
+	}
+
+	void ResourceStateTable::Unregister(TrackedResource resource)
+	{
+		std::lock_guard<std::mutex> lock(m_mutex);
+		m_states.erase(resource);
+	}
+
+	ResourceState ResourceStateTable::Get(TrackedResource resource) const
+	{
+		std::lock_guard<std::mutex> lock(m_mutex);
+
+		auto it = m_states.find(resource);
+		if (it == m_states.end())
+			throw std::out_of_range("Resource is not registered with the resource state table");
+
+		return it->second;
+	}
+
+	void ResourceStateTable::Set(TrackedResource resource, ResourceState state)
+	{
+		std::lock_guard<std::mutex> lock(m_mutex);
+
+		auto it = m_states.find(resource);
+		if (it == m_states.end())
+			throw std::out_of_range("Resource is not registered with the resource state table");
+
+		it->second = state;
+	}
+
+	bool ResourceStateTable::IsRegistered(TrackedResource resource) const
+	{
+		std::lock_guard<std::mutex> lock(m_mutex);
+		return m_states.find(resource) != m_states.end();
+	}
+
+	size_t ResourceStateTable::GetCount() const
+	{
+		std::lock_guard<std::mutex> lock(m_mutex);
+		return m_states.size();
+	}
+
+	void ResourceStateTracker::QueueTransition(TrackedResource resource, LocalState& local, ResourceState state)
+	{
+		if (StateSatisfies(local.currentState, state))
+		{
+			m_droppedCount++;
+			return;
+		}
+
+		// Readers of different stages can share one combined read state instead of ping-ponging between them
+		const ResourceState target = (IsReadOnlyState(local.currentState) && IsReadOnlyState(state)) ? (local.currentState | state) : state;
+
+		if (local.queuedIndex != s_notQueued)
+		{
+			// Nothing used the resource in between, so the queued transition can go straight to the new state.
+			// A transition that ends up where it started is skipped by Flush
+			m_queued[local.queuedIndex].stateAfter = target;
+			m_mergedCount++;
+		}
+		else
+		{
+			TrackedBarrier barrier;
+			barrier.resource = resource;
+			barrier.stateBefore = local.currentState;
+			barrier.stateAfter = target;
+
+			local.queuedIndex = m_queued.size();
+			m_queued.push_back(barrier);
+		}
+
+		local.currentState = target;
+	}
+
+	void ResourceStateTracker::EndSplit(TrackedResource resource, LocalState& local)
+	{
+		TrackedBarrier barrier;
+		barrier.split = TrackedBarrier::Split::End;
+		barrier.resource = resource;
+		barrier.stateBefore = local.splitBefore;
+		barrier.stateAfter = local.currentState;
+		m_queued.push_back(barrier);
+
+		local.splitInFlight = false;
+	}
+
+	void ResourceStateTracker::Transition(TrackedResource resource, ResourceState state)
+	{
+		auto [it, inserted] = m_local.try_emplace(resource);
+		LocalState& local = it->second;
+
+		if (inserted)
+		{
+			local = LocalState{ state, state, true, s_notQueued, false, ResourceState::Common };
+			m_useOrder.push_back(resource);
+			return;
+		}
+
+		if (local.pending)
+		{
+			// Still no barrier recorded, so the fix-up barrier at submission can target the combined read state
+			if (StateSatisfies(local.firstState, state))
+			{
+				m_droppedCount++;
+				return;
+			}
+
+			if (IsReadOnlyState(local.firstState) && IsReadOnlyState(state))
+			{
+				local.firstState |= state;
+				local.currentState = local.firstState;
+				m_mergedCount++;
+				return;
+			}
+
+			local.pending = false;
+		}
+
+		if (local.splitInFlight)
+			EndSplit(resource, local);
+
+		QueueTransition(resource, local, state);
+	}
+
+	void ResourceStateTracker::BeginTransition(TrackedResource resource, ResourceState state)
+	{
+		auto it = m_local.find(resource);
+
+		// A split needs a known before state, and is pointless if a transition of the resource is queued anyway
+		if (it == m_local.end() || it->second.pending || it->second.splitInFlight || it->second.queuedIndex != s_notQueued)
+		{
+			Transition(resource, state);
+			return;
+		}
+
+		LocalState& local = it->second;
+		if (StateSatisfies(local.currentState, state))
+		{
+			m_droppedCount++;
+			return;
+		}
+
+		TrackedBarrier barrier;
+		barrier.split = TrackedBarrier::Split::Begin;
+		barrier.resource = resource;
+		barrier.stateBefore = local.currentState;
+		barrier.stateAfter = state;
+		m_queued.push_back(barrier);
+
+		local.splitInFlight = true;
+		local.splitBefore = local.currentState;
+		local.currentState = state;
+		m_splitCount++;
+	}
+
+	void ResourceStateTracker::EndTransition(TrackedResource resource)
+	{
+		auto it = m_local.find(resource);
+		if (it != m_local.end() && it->second.splitInFlight)
+			EndSplit(resource, it->second);
+	}
+
+	void ResourceStateTracker::UAVBarrier(TrackedResource resource)
+	{
+		TrackedBarrier barrier;
+		barrier.type = TrackedBarrier::Type::UnorderedAccess;
+		barrier.resource = resource;
+		m_queued.push_back(barrier);
+	}
+
+	uint32_t ResourceStateTracker::Flush(std::vector<TrackedBarrier>& barriers)
+	{
+		uint32_t count = 0;
+		for (const TrackedBarrier& barrier : m_queued)
+		{
+			if (barrier.type == TrackedBarrier::Type::Transition)
+				m_local[barrier.resource].queuedIndex = s_notQueued;
+
+			// Merged transitions that returned to their starting state
+			if (barrier.type == TrackedBarrier::Type::Transition && barrier.split == TrackedBarrier::Split::None && barrier.stateBefore == barrier.stateAfter)
+			{
+				m_droppedCount++;
+				continue;
+			}
+
+			barriers.push_back(barrier);
+			count++;
+		}
+
+		m_queued.clear();
+
+		return count;
+	}
+
+	uint32_t ResourceStateTracker::ResolvePending(const ResourceStateTable& table, std::vector<TrackedBarrier>& barriers) const
+	{
+		uint32_t count = 0;
+		for (TrackedResource resource : m_useOrder)
+		{
+			const LocalState& local = m_local.at(resource);
+			const ResourceState committed = table.Get(resource);
+
+			// Barriers recorded in the list start from the first state exactly, a list that never recorded one
+			// can use a committed state that merely covers it
+			if (committed == local.firstState || (local.pending && StateSatisfies(committed, local.firstState)))
+				continue;
+
+			TrackedBarrier barrier;
+			barrier.resource = resource;
+			barrier.stateBefore = committed;
+			barrier.stateAfter = local.firstState;
+			barriers.push_back(barrier);
+			count++;
+		}
+
+		return count;
+	}
+
+	void ResourceStateTracker::Commit(ResourceStateTable& table) const
+	{
+		for (TrackedResource resource : m_useOrder)
+		{
+			const LocalState& local = m_local.at(resource);
+			if (local.splitInFlight)
+				throw std::logic_error("Split transition was not ended before the command list was committed");
+
+			// A list that only read the resource in a state the committed one satisfied leaves it untouched
+			if (local.pending && StateSatisfies(table.Get(resource), local.firstState))
+				continue;
+
+			table.Set(resource, local.currentState);
+		}
+	}
+
+	void ResourceStateTracker::Reset()
+	{
+		m_local.clear();
+		m_useOrder.clear();
+		m_queued.clear();
+	}
+
+	bool ResourceStateTracker::HasQueuedBarriers() const
+	{
+		return !m_queued.empty();
+	}
+
+	uint64_t ResourceStateTracker::GetDroppedCount() const
+	{
+		return m_droppedCount;
+	}
+
+	uint64_t ResourceStateTracker::GetMergedCount() const
+	{
+		return m_mergedCount;
+	}
+
+	uint64_t ResourceStateTracker::GetSplitCount() const
+	{
+		return m_splitCount;
+	}
+}
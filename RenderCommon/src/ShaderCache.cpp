@@ -0,0 +1,385 @@
+#include <ShaderCache.h>
+#include <StableHash.h>
+
+#include <cstdio>
+#include <filesystem>
+#include <fstream>
+#include <stdexcept>
+#include <thread>
+#include <unordered_set>
+#include <utility>
+
+namespace UltReality::Rendering::Common
+{
+	namespace
+	{
+		template<typename T>
+		void Write(std::vector<uint8_t>& out, T value)
+		{
+			for (size_t i = 0; i < sizeof(T); i++)
+				out.push_back(static_cast<uint8_t>(static_cast<uint64_t>(value) >> (i * 8)));
+		}
+
+		template<typename T>
+		T Read(const uint8_t*& cursor)
+		{
+			uint64_t value = 0;
+			for (size_t i = 0; i < sizeof(T); i++)
+				value |= static_cast<uint64_t>(cursor[i]) << (i * 8);
+
+			cursor += sizeof(T);
+			return static_cast<T>(value);
+		}
+
+		bool ParseKey(const std::string& stem, uint64_t& key)
+		{
+			if (stem.size() != 16)
+				return false;
+
+			key = 0;
+			for (char c : stem)
+			{
+				uint64_t digit;
+				if (c >= '0' && c <= '9')
+					digit = c - '0';
+				else if (c >= 'a' && c <= 'f')
+					digit = c - 'a' + 10;
+				else
+					return false;
+
+				key = (key << 4) | digit;
+			}
+
+			return true;
+		}
+	}
+
+	ShaderCache::ShaderCache(const std::string& directory, IShaderCompiler* compiler, IShaderIncludeResolver* resolver)
+		: m_directory(directory), m_compiler(compiler), m_resolver(resolver)
+	{
+		if (resolver == nullptr)
+			throw std::invalid_argument("ShaderCache requires an include resolver");
+
+		if (!m_directory.empty())
+		{
+			std::error_code error;
+			std::filesystem::create_directories(m_directory, error);
+
+			MapDirectory();
+		}
+	}
+
+	std::string ShaderCache::BlobPath(uint64_t key) const
+	{
+		char name[32];
+		std::snprintf(name, sizeof(name), "%016llx%s", static_cast<unsigned long long>(key), fileExtension);
+
+		return (std::filesystem::path(m_directory) / name).string();
+	}
+
+	void ShaderCache::MapDirectory()
+	{
+		std::error_code error;
+		for (const std::filesystem::directory_entry& entry : std::filesystem::directory_iterator(m_directory, error))
+		{
+			const std::filesystem::path& path = entry.path();
+			uint64_t key;
+			if (!entry.is_regular_file(error) || path.extension() != fileExtension || !ParseKey(path.stem().string(), key))
+				continue;
+
+			// Only the header is checked here, the bytecode pages are not touched until the blob is looked up
+			std::unique_ptr<MappedFile> file;
+			try
+			{
+				file = std::make_unique<MappedFile>(path.string());
+			}
+			catch (const std::runtime_error&)
+			{
+				m_statistics.rejectedFiles++;
+				continue;
+			}
+
+			bool valid = file->GetSize() >= s_headerSize;
+			if (valid)
+			{
+				const uint8_t* cursor = file->GetData();
+				valid = Read<uint32_t>(cursor) == magic
+					&& Read<uint32_t>(cursor) == formatVersion
+					&& Read<uint64_t>(cursor) == key
+					&& Read<uint64_t>(cursor) == file->GetSize() - s_headerSize;
+			}
+
+			if (!valid)
+			{
+				file.reset();
+				std::filesystem::remove(path, error);
+				m_statistics.rejectedFiles++;
+				continue;
+			}
+
+			m_records[key].file = std::move(file);
+			m_statistics.mappedFiles++;
+		}
+	}
+
+	ShaderBlob ShaderCache::AcquireBlob(uint64_t key)
+	{
+		auto it = m_records.find(key);
+		if (it == m_records.end())
+			return {};
+
+		Record& record = it->second;
+		if (!record.file)
+		{
+			record.used = true;
+			return { record.bytecode.data(), record.bytecode.size() };
+		}
+
+		const uint8_t* bytecode = record.file->GetData() + s_headerSize;
+		const size_t size = record.file->GetSize() - s_headerSize;
+
+		if (!record.verified)
+		{
+			const uint8_t* cursor = record.file->GetData() + s_headerSize - sizeof(uint64_t);
+			if (Read<uint64_t>(cursor) != StableHash(bytecode, size))
+			{
+				m_records.erase(it);
+
+				std::error_code error;
+				std::filesystem::remove(BlobPath(key), error);
+				m_statistics.rejectedFiles++;
+
+				return {};
+			}
+
+			record.verified = true;
+		}
+
+		record.used = true;
+		return { bytecode, size };
+	}
+
+	uint64_t ShaderCache::ComputeKey(const ShaderCompileRequest& request, std::string* source) const
+	{
+		StableHasher hasher;
+		hasher.Add(formatVersion);
+		hasher.Add<uint64_t>(m_compiler ? m_compiler->GetVersionHash() : 0);
+
+		hasher.AddString(request.entryPoint).AddString(request.target);
+		hasher.Add<uint64_t>(request.defines.size());
+		for (const ShaderDefine& define : request.defines)
+			hasher.AddString(define.name).AddString(define.value);
+		hasher.Add<uint64_t>(request.arguments.size());
+		for (const std::string& argument : request.arguments)
+			hasher.AddString(argument);
+
+		const std::string sourcePath = m_resolver->Resolve({}, request.sourcePath);
+		std::string contents;
+		if (sourcePath.empty() || !m_resolver->Read(sourcePath, contents))
+			throw std::runtime_error("Failed to read shader source: " + request.sourcePath);
+
+		hasher.AddString(contents);
+
+		// Walk the include closure depth first in directive order. Files are identified by their contents and the
+		// name they were included by, so moving the project directory keeps every key
+		std::unordered_set<std::string> visited{ sourcePath };
+		std::vector<std::pair<std::string, std::vector<std::string>>> stack;
+		stack.emplace_back(sourcePath, ScanShaderIncludes(contents));
+
+		if (source != nullptr)
+			*source = std::move(contents);
+
+		while (!stack.empty())
+		{
+			if (stack.back().second.empty())
+			{
+				stack.pop_back();
+				continue;
+			}
+
+			const std::string include = std::move(stack.back().second.front());
+			stack.back().second.erase(stack.back().second.begin());
+
+			const std::string includePath = m_resolver->Resolve(stack.back().first, include);
+			hasher.AddString(include);
+
+			std::string includeContents;
+			if (includePath.empty() || !m_resolver->Read(includePath, includeContents))
+			{
+				hasher.Add(false);
+				continue;
+			}
+
+			hasher.Add(true);
+			if (!visited.insert(includePath).second)
+				continue;
+
+			hasher.AddString(includeContents);
+			stack.emplace_back(includePath, ScanShaderIncludes(includeContents));
+		}
+
+		return hasher.Finish();
+	}
+
+	ShaderBlob ShaderCache::Find(uint64_t key)
+	{
+		std::lock_guard<std::mutex> lock(m_mutex);
+
+		return AcquireBlob(key);
+	}
+
+	ShaderBlob ShaderCache::Store(uint64_t key, std::vector<uint8_t> bytecode)
+	{
+		if (!m_directory.empty())
+		{
+			std::vector<uint8_t> header;
+			header.reserve(s_headerSize);
+			Write<uint32_t>(header, magic);
+			Write<uint32_t>(header, formatVersion);
+			Write<uint64_t>(header, key);
+			Write<uint64_t>(header, bytecode.size());
+			Write<uint64_t>(header, StableHash(bytecode.data(), bytecode.size()));
+
+			// Written under a unique temporary name and renamed, so neither a crash nor a concurrent store of the same
+			// key leaves a torn file behind. A failed write only costs the persistence
+			const std::string path = BlobPath(key);
+			const std::string tempPath = path + "." + std::to_string(std::hash<std::thread::id>{}(std::this_thread::get_id())) + ".tmp";
+			bool written = false;
+			{
+				std::ofstream file(tempPath, std::ios::binary | std::ios::trunc);
+				file.write(reinterpret_cast<const char*>(header.data()), static_cast<std::streamsize>(header.size()));
+				file.write(reinterpret_cast<const char*>(bytecode.data()), static_cast<std::streamsize>(bytecode.size()));
+				written = static_cast<bool>(file);
+			}
+
+			std::error_code error;
+			if (written)
+				std::filesystem::rename(tempPath, path, error);
+			if (!written || error)
+				std::filesystem::remove(tempPath, error);
+		}
+
+		std::lock_guard<std::mutex> lock(m_mutex);
+
+		// Replaces a mapped file of the same key, whose view is still handed out, only if it is unverified
+		Record& record = m_records[key];
+		if (record.file && record.verified)
+		{
+			record.used = true;
+			return { record.file->GetData() + s_headerSize, record.file->GetSize() - s_headerSize };
+		}
+
+		if (!record.file && !record.bytecode.empty())
+		{
+			record.used = true;
+			return { record.bytecode.data(), record.bytecode.size() };
+		}
+
+		record.file.reset();
+		record.bytecode = std::move(bytecode);
+		record.used = true;
+
+		return { record.bytecode.data(), record.bytecode.size() };
+	}
+
+	std::vector<ShaderCompileResult> ShaderCache::Compile(const std::vector<ShaderCompileRequest>& requests, JobSystem& jobSystem)
+	{
+		std::vector<ShaderCompileResult> results(requests.size());
+		if (requests.empty())
+			return results;
+
+		// Hashing reads the whole include closure, so it runs in the jobs along with the compilation
+		JobCounter counter;
+		jobSystem.Dispatch(static_cast<uint32_t>(requests.size()), 1, [&](uint32_t first, uint32_t last, uint32_t)
+		{
+			for (uint32_t i = first; i < last; i++)
+			{
+				const ShaderCompileRequest& request = requests[i];
+				ShaderCompileResult& result = results[i];
+
+				std::string source;
+				try
+				{
+					result.key = ComputeKey(request, &source);
+				}
+				catch (const std::runtime_error& e)
+				{
+					result.messages = e.what();
+					std::lock_guard<std::mutex> lock(m_mutex);
+					m_statistics.failedCount++;
+					continue;
+				}
+
+				result.blob = Find(result.key);
+				if (result.blob)
+				{
+					result.cacheHit = true;
+					std::lock_guard<std::mutex> lock(m_mutex);
+					m_statistics.cacheHits++;
+					continue;
+				}
+
+				std::vector<uint8_t> bytecode;
+				const bool compiled = m_compiler != nullptr
+					&& m_compiler->Compile(request, source, *m_resolver, bytecode, result.messages);
+
+				if (m_compiler == nullptr)
+					result.messages = "No shader compiler available and no cached blob for: " + request.sourcePath;
+
+				if (compiled)
+					result.blob = Store(result.key, std::move(bytecode));
+
+				std::lock_guard<std::mutex> lock(m_mutex);
+				if (compiled)
+					m_statistics.compileCount++;
+				else
+					m_statistics.failedCount++;
+			}
+		}, counter);
+
+		jobSystem.Wait(counter);
+
+		return results;
+	}
+
+	size_t ShaderCache::RemoveUnused()
+	{
+		std::lock_guard<std::mutex> lock(m_mutex);
+
+		size_t removed = 0;
+		for (auto it = m_records.begin(); it != m_records.end();)
+		{
+			if (it->second.used)
+			{
+				++it;
+				continue;
+			}
+
+			// Unmapped before the file is deleted, Windows refuses to delete mapped files
+			const uint64_t key = it->first;
+			it = m_records.erase(it);
+
+			std::error_code error;
+			if (!m_directory.empty())
+				std::filesystem::remove(BlobPath(key), error);
+
+			removed++;
+		}
+
+		return removed;
+	}
+
+	size_t ShaderCache::GetBlobCount() const
+	{
+		std::lock_guard<std::mutex> lock(m_mutex);
+
+		return m_records.size();
+	}
+
+	ShaderCache::Statistics ShaderCache::GetStatistics() const
+	{
+		std::lock_guard<std::mutex> lock(m_mutex);
+
+		return m_statistics;
+	}
+}
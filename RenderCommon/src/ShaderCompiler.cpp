@@ -0,0 +1,131 @@
+#include <ShaderCompiler.h>
+
+#include <filesystem>
+#include <fstream>
+#include <iterator>
+#include <utility>
+
+namespace UltReality::Rendering::Common
+{
+	FileShaderIncludeResolver::FileShaderIncludeResolver(std::vector<std::string> includeDirectories)
+		: m_includeDirectories(std::move(includeDirectories))
+	{}
+
+	std::string FileShaderIncludeResolver::Resolve(const std::string& includingPath, const std::string& include)
+	{
+		namespace fs = std::filesystem;
+
+		std::error_code error;
+		const fs::path includePath(include);
+		if (includePath.is_absolute())
+			return fs::is_regular_file(includePath, error) ? includePath.lexically_normal().generic_string() : std::string();
+
+		// Relative to the including file first, like the quoted form of #include
+		const fs::path localPath = fs::path(includingPath).parent_path() / includePath;
+		if (fs::is_regular_file(localPath, error))
+			return localPath.lexically_normal().generic_string();
+
+		for (const std::string& directory : m_includeDirectories)
+		{
+			const fs::path candidate = fs::path(directory) / includePath;
+			if (fs::is_regular_file(candidate, error))
+				return candidate.lexically_normal().generic_string();
+		}
+
+		return {};
+	}
+
+	bool FileShaderIncludeResolver::Read(const std::string& path, std::string& contents)
+	{
+		std::ifstream file(path, std::ios::binary);
+		if (!file)
+			return false;
+
+		contents.assign(std::istreambuf_iterator<char>(file), std::istreambuf_iterator<char>());
+
+		return true;
+	}
+
+	std::vector<std::string> ScanShaderIncludes(std::string_view source)
+	{
+		std::vector<std::string> includes;
+
+		size_t i = 0;
+		const size_t size = source.size();
+		bool lineStart = true;
+
+		auto skipBlanks = [&]()
+		{
+			while (i < size && (source[i] == ' ' || source[i] == '\t'))
+				i++;
+		};
+
+		while (i < size)
+		{
+			const char c = source[i];
+
+			if (c == '\n')
+			{
+				lineStart = true;
+				i++;
+			}
+			else if (c == '/' && i + 1 < size && source[i + 1] == '/')
+			{
+				while (i < size && source[i] != '\n')
+					i++;
+			}
+			else if (c == '/' && i + 1 < size && source[i + 1] == '*')
+			{
+				// A block comment is whitespace, it does not end the line for directive purposes
+				const size_t end = source.find("*/", i + 2);
+				i = end == std::string_view::npos ? size : end + 2;
+			}
+			else if (c == '"')
+			{
+				// Skip string literals so a "//" inside one is not taken for a comment
+				lineStart = false;
+				i++;
+				while (i < size && source[i] != '"' && source[i] != '\n')
+					i += source[i] == '\\' ? 2 : 1;
+				i++;
+			}
+			else if (c == ' ' || c == '\t' || c == '\r')
+			{
+				i++;
+			}
+			else if (c == '#' && lineStart)
+			{
+				lineStart = false;
+				i++;
+				skipBlanks();
+
+				if (source.substr(i, 7) != "include")
+					continue;
+
+				i += 7;
+				skipBlanks();
+
+				if (i >= size || (source[i] != '"' && source[i] != '<'))
+					continue;
+
+				const char close = source[i] == '"' ? '"' : '>';
+				const size_t begin = ++i;
+				while (i < size && source[i] != close && source[i] != '\n')
+					i++;
+
+				if (i < size && source[i] == close)
+				{
+					includes.emplace_back(source.substr(begin, i - begin));
+					i++;
+				}
+			}
+			else
+			{
+				lineStart = false;
+				i++;
+			}
+		}
+
+		return includes;
+	}
+}
@@ -0,0 +1,247 @@
+#include <ShadowCascades.h>
+
+#include <algorithm>
+#include <cmath>
+#include <stdexcept>
+
+namespace UltReality::Rendering::Common
+{
+	namespace
+	{
+		float Dot(const float a[3], const float b[3])
+		{
+			return a[0] * b[0] + a[1] * b[1] + a[2] * b[2];
+		}
+
+		void Cross(const float a[3], const float b[3], float result[3])
+		{
+			result[0] = a[1] * b[2] - a[2] * b[1];
+			result[1] = a[2] * b[0] - a[0] * b[2];
+			result[2] = a[0] * b[1] - a[1] * b[0];
+		}
+
+		bool Normalize(float v[3])
+		{
+			const float length = std::sqrt(Dot(v, v));
+			if (!(length > 0.0f))
+				return false;
+
+			for (uint32_t i = 0; i < 3; i++)
+				v[i] /= length;
+			return true;
+		}
+
+		void ValidateSettings(const ShadowCascadeSettings& settings)
+		{
+			if (settings.cascadeCount == 0 || settings.cascadeCount > maxShadowCascades)
+				throw std::invalid_argument("Shadow cascade count must be between 1 and maxShadowCascades");
+			if (settings.cascadeResolution == 0)
+				throw std::invalid_argument("Shadow cascade resolution must not be zero");
+			if (!(settings.splitLambda >= 0.0f && settings.splitLambda <= 1.0f))
+				throw std::invalid_argument("Shadow split lambda must be in [0, 1]");
+			if (!(settings.cachePadding >= 1.0f))
+				throw std::invalid_argument("Shadow cache padding must be at least 1");
+			if (!(settings.maxLightAngle >= 0.0f) || !(settings.casterDistance >= 0.0f))
+				throw std::invalid_argument("Shadow light angle and caster distance must not be negative");
+		}
+	}
+
+	void ComputeCascadeSplits(float nearZ, float farZ, uint32_t cascadeCount, float lambda, float* splits)
+	{
+		if (!(nearZ > 0.0f) || !(farZ > nearZ))
+			throw std::invalid_argument("Shadow range needs 0 < near < far");
+		if (cascadeCount == 0 || cascadeCount > maxShadowCascades)
+			throw std::invalid_argument("Shadow cascade count must be between 1 and maxShadowCascades");
+
+		for (uint32_t i = 1; i <= cascadeCount; i++)
+		{
+			const float fraction = static_cast<float>(i) / static_cast<float>(cascadeCount);
+			const float logarithmic = nearZ * std::pow(farZ / nearZ, fraction);
+			const float uniform = nearZ + (farZ - nearZ) * fraction;
+			splits[i - 1] = lambda * logarithmic + (1.0f - lambda) * uniform;
+		}
+
+		// Rounding must not leave a gap behind the last cascade
+		splits[cascadeCount - 1] = farZ;
+	}
+
+	void ComputeFrustumSliceSphere(const ShadowCamera& camera, float sliceNear, float sliceFar, float center[3], float& radius)
+	{
+		const float tanY = std::tan(camera.verticalFov * 0.5f);
+		const float tanX = tanY * camera.aspectRatio;
+		// Squared distance of a slice corner from the view axis per unit of depth
+		const float corner = tanX * tanX + tanY * tanY;
+
+		// Center where the near and far corners are equally far away, clamped to the far plane for wide slices
+		float depth = (sliceNear + sliceFar) * (1.0f + corner) * 0.5f;
+		if (depth >= sliceFar)
+		{
+			depth = sliceFar;
+			radius = sliceFar * std::sqrt(corner);
+		}
+		else
+		{
+			radius = std::sqrt((sliceFar - depth) * (sliceFar - depth) + sliceFar * sliceFar * corner);
+		}
+
+		const float* forward = camera.cameraToWorld + 8;
+		const float* position = camera.cameraToWorld + 12;
+		for (uint32_t i = 0; i < 3; i++)
+			center[i] = position[i] + forward[i] * depth;
+	}
+
+	void BuildCascadeViewProjection(const float lightDirection[3], float center[3], float radius, float casterDistance, uint32_t resolution, float viewProjection[16])
+	{
+		float forward[3] = { lightDirection[0], lightDirection[1], lightDirection[2] };
+		if (!Normalize(forward))
+			throw std::invalid_argument("Light direction must not be zero");
+
+		// Any up vector not parallel to the light works, the basis only has to be stable while the light is
+		const float worldUp[3] = { 0.0f, 1.0f, 0.0f };
+		const float worldForward[3] = { 0.0f, 0.0f, 1.0f };
+		float right[3];
+		Cross(std::fabs(forward[1]) < 0.99f ? worldUp : worldForward, forward, right);
+		Normalize(right);
+		float up[3];
+		Cross(forward, right, up);
+
+		// Snap the center to whole texels across the light
+		const float texel = 2.0f * radius / static_cast<float>(resolution);
+		const float x = std::floor(Dot(center, right) / texel) * texel;
+		const float y = std::floor(Dot(center, up) / texel) * texel;
+		const float z = Dot(center, forward);
+		for (uint32_t i = 0; i < 3; i++)
+			center[i] = right[i] * x + up[i] * y + forward[i] * z;
+
+		// Depth 0 lies casterDistance beyond the sphere towards the light, depth 1 on the far side of the sphere
+		const float nearDepth = z - radius - casterDistance;
+		const float depthRange = 2.0f * radius + casterDistance;
+
+		for (uint32_t row = 0; row < 3; row++)
+		{
+			viewProjection[row * 4 + 0] = right[row] / radius;
+			viewProjection[row * 4 + 1] = up[row] / radius;
+			viewProjection[row * 4 + 2] = forward[row] / depthRange;
+			viewProjection[row * 4 + 3] = 0.0f;
+		}
+		viewProjection[12] = -x / radius;
+		viewProjection[13] = -y / radius;
+		viewProjection[14] = -nearDepth / depthRange;
+		viewProjection[15] = 1.0f;
+	}
+
+	bool IsCascadeCacheValid(const ShadowCascade& cached, const float lightDirection[3], const float requiredCenter[3], float requiredRadius, float minLightCosine)
+	{
+		if (!(cached.radius > 0.0f) || Dot(cached.lightDirection, lightDirection) < minLightCosine)
+			return false;
+
+		const float offset[3] = { requiredCenter[0] - cached.center[0], requiredCenter[1] - cached.center[1], requiredCenter[2] - cached.center[2] };
+		return std::sqrt(Dot(offset, offset)) + requiredRadius <= cached.radius;
+	}
+
+	ShadowCascadeSet::ShadowCascadeSet(const ShadowCascadeSettings& settings)
+	{
+		SetSettings(settings);
+	}
+
+	void ShadowCascadeSet::LayoutAtlas()
+	{
+		// Tiles fill a grid as square as possible, row by row
+		uint32_t columns = 1;
+		while (columns * columns < m_settings.cascadeCount)
+			columns++;
+		const uint32_t rows = (m_settings.cascadeCount + columns - 1) / columns;
+
+		m_atlasWidth = columns * m_settings.cascadeResolution;
+		m_atlasHeight = rows * m_settings.cascadeResolution;
+		for (uint32_t i = 0; i < m_settings.cascadeCount; i++)
+		{
+			m_cascades[i].atlasX = (i % columns) * m_settings.cascadeResolution;
+			m_cascades[i].atlasY = (i / columns) * m_settings.cascadeResolution;
+			m_cascades[i].atlasSize = m_settings.cascadeResolution;
+		}
+	}
+
+	void ShadowCascadeSet::SetSettings(const ShadowCascadeSettings& settings)
+	{
+		ValidateSettings(settings);
+
+		m_settings = settings;
+		for (ShadowCascade& cascade : m_cascades)
+			cascade = ShadowCascade();
+
+		LayoutAtlas();
+	}
+
+	const ShadowCascadeSettings& ShadowCascadeSet::GetSettings() const
+	{
+		return m_settings;
+	}
+
+	void ShadowCascadeSet::Update(const ShadowCamera& camera, const float lightDirection[3])
+	{
+		float light[3] = { lightDirection[0], lightDirection[1], lightDirection[2] };
+		if (!Normalize(light))
+			throw std::invalid_argument("Light direction must not be zero");
+
+		float splits[maxShadowCascades];
+		ComputeCascadeSplits(camera.nearZ, camera.farZ, m_settings.cascadeCount, m_settings.splitLambda, splits);
+
+		const float minLightCosine = std::cos(m_settings.maxLightAngle);
+		for (uint32_t i = 0; i < m_settings.cascadeCount; i++)
+		{
+			ShadowCascade& cascade = m_cascades[i];
+			cascade.splitNear = i == 0 ? camera.nearZ : splits[i - 1];
+			cascade.splitFar = splits[i];
+
+			float center[3];
+			float radius;
+			ComputeFrustumSliceSphere(camera, cascade.splitNear, cascade.splitFar, center, radius);
+			if (IsCascadeCacheValid(cascade, light, center, radius, minLightCosine))
+				continue;
+
+			cascade.radius = radius * m_settings.cachePadding;
+			std::copy(center, center + 3, cascade.center);
+			std::copy(light, light + 3, cascade.lightDirection);
+			BuildCascadeViewProjection(light, cascade.center, cascade.radius, m_settings.casterDistance, cascade.atlasSize, cascade.viewProjection);
+			cascade.staticDirty = true;
+		}
+	}
+
+	void ShadowCascadeSet::MarkStaticRendered(uint32_t cascade)
+	{
+		if (cascade >= m_settings.cascadeCount)
+			throw std::out_of_range("Shadow cascade index out of range");
+
+		m_cascades[cascade].staticDirty = false;
+	}
+
+	void ShadowCascadeSet::InvalidateStatic()
+	{
+		for (ShadowCascade& cascade : m_cascades)
+			cascade.staticDirty = true;
+	}
+
+	uint32_t ShadowCascadeSet::GetCascadeCount() const
+	{
+		return m_settings.cascadeCount;
+	}
+
+	const ShadowCascade& ShadowCascadeSet::GetCascade(uint32_t cascade) const
+	{
+		if (cascade >= m_settings.cascadeCount)
+			throw std::out_of_range("Shadow cascade index out of range");
+
+		return m_cascades[cascade];
+	}
+
+	uint32_t ShadowCascadeSet::GetAtlasWidth() const
+	{
+		return m_atlasWidth;
+	}
+
+	uint32_t ShadowCascadeSet::GetAtlasHeight() const
+	{
+		return m_atlasHeight;
+	}
+}
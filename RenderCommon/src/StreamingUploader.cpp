@@ -0,0 +1,270 @@
+#include <StreamingUploader.h>
+
+#include <cstring>
+#include <stdexcept>
+#include <utility>
+
+namespace UltReality::Rendering::Common
+{
+	StreamingUploader::StreamingUploader(IUploadQueue* queue, uint64_t maxBatchBytes, uint32_t maxBatchCopies)
+		: m_queue(queue), m_maxBatchBytes(maxBatchBytes), m_maxBatchCopies(maxBatchCopies), m_staging(queue->GetStagingCapacity())
+	{
+		if (maxBatchBytes == 0 || maxBatchCopies == 0)
+			throw std::invalid_argument("StreamingUploader batch limits must be non-zero");
+
+		m_thread = std::thread(&StreamingUploader::ThreadMain, this);
+	}
+
+	StreamingUploader::~StreamingUploader()
+	{
+		{
+			std::lock_guard<std::mutex> lock(m_mutex);
+			m_stopping = true;
+		}
+
+		m_workAvailable.notify_one();
+		m_thread.join();
+	}
+
+	UploadTicket StreamingUploader::Enqueue(UploadRequest request)
+	{
+		if (!request.write || request.size == 0)
+			throw std::invalid_argument("Upload request needs a size and a writer");
+
+		if (request.alignment == 0 || (request.alignment & (request.alignment - 1)) != 0)
+			throw std::invalid_argument("Upload request alignment must be a power of 2");
+
+		// Guarantees the request fits into an empty ring wherever its head is
+		if (request.size + request.alignment > m_staging.GetCapacity() / 2)
+			throw std::invalid_argument("Upload request does not fit the staging ring");
+
+		UploadTicket ticket;
+		{
+			std::lock_guard<std::mutex> lock(m_mutex);
+			if (m_error)
+				std::rethrow_exception(m_error);
+
+			ticket = m_nextTicket++;
+			m_pending.push_back(PendingRequest{ ticket, std::move(request) });
+		}
+
+		m_workAvailable.notify_one();
+
+		return ticket;
+	}
+
+	UploadTicket StreamingUploader::EnqueueBuffer(void* destination, uint64_t destinationOffset, std::vector<uint8_t> data)
+	{
+		UploadRequest request;
+		request.size = data.size();
+		request.destination = destination;
+		request.destinationOffset = destinationOffset;
+		request.write = [data = std::move(data)](uint8_t* staging)
+		{
+			std::memcpy(staging, data.data(), data.size());
+		};
+
+		return Enqueue(std::move(request));
+	}
+
+	void StreamingUploader::ThreadMain()
+	{
+		std::vector<PendingRequest> batch;
+
+		for (;;)
+		{
+			{
+				std::unique_lock<std::mutex> lock(m_mutex);
+				m_workAvailable.wait(lock, [this] { return m_stopping || !m_pending.empty(); });
+
+				// Stopping only once everything queued has been submitted
+				if (m_pending.empty())
+					return;
+
+				// Take as many requests as one batch may hold, so a burst of small uploads becomes one command list
+				uint64_t batchBytes = 0;
+				while (!m_pending.empty() && batch.size() < m_maxBatchCopies)
+				{
+					const uint64_t size = m_pending.front().request.size;
+					if (!batch.empty() && batchBytes + size > m_maxBatchBytes)
+						break;
+
+					batchBytes += size;
+					batch.push_back(std::move(m_pending.front()));
+					m_pending.pop_front();
+				}
+			}
+
+			try
+			{
+				ProcessBatch(batch);
+			}
+			catch (...)
+			{
+				std::lock_guard<std::mutex> lock(m_mutex);
+				m_error = std::current_exception();
+				m_batchSubmitted.notify_all();
+
+				return;
+			}
+
+			batch.clear();
+		}
+	}
+
+	void StreamingUploader::ProcessBatch(std::vector<PendingRequest>& batch)
+	{
+		uint8_t* stagingMemory = m_queue->GetStagingMemory();
+
+		uint32_t recordedCount = 0;
+		uint64_t recordedBytes = 0;
+		UploadTicket lastRecorded = 0;
+
+		for (PendingRequest& pending : batch)
+		{
+			const UploadRequest& request = pending.request;
+
+			uint64_t offset;
+			while ((offset = m_staging.Allocate(request.size, request.alignment)) == LinearRingAllocator::invalidOffset)
+			{
+				// Hand the copies recorded so far to the GPU, they are what frees the ring
+				if (recordedCount > 0)
+				{
+					SubmitBatch(lastRecorded, recordedCount, recordedBytes);
+					recordedCount = 0;
+					recordedBytes = 0;
+				}
+
+				if (m_stagingFences.empty())
+					throw std::logic_error("Staging ring cannot fit an upload request while empty");
+
+				m_queue->WaitForValue(m_stagingFences.front());
+				m_staging.Retire(m_stagingFences.front());
+				m_stagingFences.pop_front();
+
+				std::lock_guard<std::mutex> lock(m_mutex);
+				m_statistics.stagingStalls++;
+			}
+
+			request.write(stagingMemory + offset);
+
+			UploadCopy copy;
+			copy.stagingOffset = offset;
+			copy.size = request.size;
+			copy.destination = request.destination;
+			copy.destinationOffset = request.destinationOffset;
+			copy.subresource = request.subresource;
+			m_queue->RecordCopy(copy);
+
+			recordedCount++;
+			recordedBytes += request.size;
+			lastRecorded = pending.ticket;
+		}
+
+		if (recordedCount > 0)
+			SubmitBatch(lastRecorded, recordedCount, recordedBytes);
+	}
+
+	void StreamingUploader::SubmitBatch(UploadTicket lastTicket, uint32_t requestCount, uint64_t byteCount)
+	{
+		const uint64_t fenceValue = m_queue->SubmitBatch();
+
+		m_staging.FinishFrame(fenceValue);
+		m_stagingFences.push_back(fenceValue);
+
+		// Reclaim what the GPU already finished while we are here, so the ring rarely has to wait
+		const uint64_t completed = m_queue->GetCompletedValue();
+		m_staging.Retire(completed);
+		while (!m_stagingFences.empty() && m_stagingFences.front() <= completed)
+			m_stagingFences.pop_front();
+
+		{
+			std::lock_guard<std::mutex> lock(m_mutex);
+			m_inFlight.push_back(SubmittedBatch{ lastTicket, fenceValue });
+			m_submittedTicket = lastTicket;
+			// Counted together with the ticket, so a caller that waited for it sees the statistics of its batch
+			m_statistics.batchCount++;
+			m_statistics.requestCount += requestCount;
+			m_statistics.bytesUploaded += byteCount;
+		}
+
+		m_batchSubmitted.notify_all();
+	}
+
+	void StreamingUploader::RetireCompletedBatches()
+	{
+		const uint64_t completed = m_queue->GetCompletedValue();
+		while (!m_inFlight.empty() && m_inFlight.front().fenceValue <= completed)
+		{
+			m_completedTicket.store(m_inFlight.front().lastTicket, std::memory_order_release);
+			m_inFlight.pop_front();
+		}
+	}
+
+	bool StreamingUploader::IsComplete(UploadTicket ticket)
+	{
+		if (ticket <= m_completedTicket.load(std::memory_order_acquire))
+			return true;
+
+		std::lock_guard<std::mutex> lock(m_mutex);
+		RetireCompletedBatches();
+
+		return ticket <= m_completedTicket.load(std::memory_order_relaxed);
+	}
+
+	void StreamingUploader::Wait(UploadTicket ticket)
+	{
+		if (ticket <= m_completedTicket.load(std::memory_order_acquire))
+			return;
+
+		uint64_t fenceValue = 0;
+		{
+			std::unique_lock<std::mutex> lock(m_mutex);
+			if (ticket >= m_nextTicket)
+				throw std::invalid_argument("Waiting on an upload ticket that was never issued");
+
+			m_batchSubmitted.wait(lock, [&] { return m_submittedTicket >= ticket || m_error; });
+			if (m_submittedTicket < ticket)
+				std::rethrow_exception(m_error);
+
+			for (const SubmittedBatch& batch : m_inFlight)
+			{
+				if (batch.lastTicket >= ticket)
+				{
+					fenceValue = batch.fenceValue;
+					break;
+				}
+			}
+		}
+
+		// Not found means a concurrent caller already saw the batch complete
+		if (fenceValue != 0)
+			m_queue->WaitForValue(fenceValue);
+
+		std::lock_guard<std::mutex> lock(m_mutex);
+		RetireCompletedBatches();
+	}
+
+	void StreamingUploader::WaitForIdle()
+	{
+		UploadTicket lastTicket;
+		{
+			std::lock_guard<std::mutex> lock(m_mutex);
+			lastTicket = m_nextTicket - 1;
+		}
+
+		if (lastTicket > 0)
+			Wait(lastTicket);
+	}
+
+	UploadTicket StreamingUploader::GetCompletedTicket() const
+	{
+		return m_completedTicket.load(std::memory_order_acquire);
+	}
+
+	StreamingUploader::Statistics StreamingUploader::GetStatistics()
+	{
+		std::lock_guard<std::mutex> lock(m_mutex);
+		return m_statistics;
+	}
+}
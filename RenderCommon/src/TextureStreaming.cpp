@@ -0,0 +1,276 @@
+#include <TextureStreaming.h>
+
+#include <algorithm>
+#include <cmath>
+#include <queue>
+#include <stdexcept>
+
+namespace UltReality::Rendering::Common
+{
+	TextureStreamingManager::TextureStreamingManager(uint64_t budgetBytes)
+		: m_budget(budgetBytes)
+	{
+		m_statistics.budgetBytes = budgetBytes;
+	}
+
+	uint32_t TextureStreamingManager::Register(const StreamingTextureDesc& desc)
+	{
+		if (desc.mipSizes.empty() || desc.baseSize == 0)
+			throw std::invalid_argument("Streamed texture needs at least one mip and a size");
+
+		uint32_t index;
+		if (!m_freeIndices.empty())
+		{
+			index = m_freeIndices.back();
+			m_freeIndices.pop_back();
+		}
+		else
+		{
+			index = static_cast<uint32_t>(m_textures.size());
+			m_textures.emplace_back();
+		}
+
+		Texture& texture = m_textures[index];
+		texture = Texture();
+		texture.live = true;
+		texture.baseSize = desc.baseSize;
+
+		// Suffix sums, a mip is only ever resident together with every coarser one
+		texture.residentSizes.resize(desc.mipSizes.size());
+		uint64_t size = 0;
+		for (size_t mip = desc.mipSizes.size(); mip-- > 0;)
+		{
+			size += desc.mipSizes[mip];
+			texture.residentSizes[mip] = size;
+		}
+
+		texture.requestedMip = texture.TailMip();
+		texture.targetMip = texture.TailMip();
+		texture.residentMip = texture.TailMip();
+		texture.pendingMip = texture.TailMip();
+
+		m_statistics.textureCount++;
+
+		return index;
+	}
+
+	void TextureStreamingManager::Unregister(uint32_t texture)
+	{
+		if (texture >= m_textures.size() || !m_textures[texture].live)
+			return;
+
+		m_textures[texture] = Texture();
+		m_freeIndices.push_back(texture);
+		m_statistics.textureCount--;
+	}
+
+	void TextureStreamingManager::ReportFootprint(uint32_t texture, float screenPixels)
+	{
+		Texture& entry = m_textures[texture];
+		entry.footprint = std::max(entry.footprint, screenPixels);
+	}
+
+	uint32_t TextureStreamingManager::RequestedMip(const Texture& texture) const
+	{
+		if (texture.priority <= 0.0f)
+			return texture.TailMip();
+
+		// The finest mip whose texels are still no larger than the pixels they cover
+		const float mip = std::log2(static_cast<float>(texture.baseSize) / texture.priority) + m_mipBias;
+		if (mip <= 0.0f)
+			return 0;
+
+		return std::min(static_cast<uint32_t>(mip), texture.TailMip());
+	}
+
+	void TextureStreamingManager::PlanTargets()
+	{
+		struct Step
+		{
+			// Screen pixels the step covers per byte it costs
+			double value;
+			uint32_t texture;
+
+			bool operator<(const Step& other) const
+			{
+				// Lower indices first on ties, so plans do not depend on the queue's internals
+				return value < other.value || (value == other.value && texture > other.texture);
+			}
+		};
+
+		std::priority_queue<Step> steps;
+		uint64_t used = 0;
+		uint64_t requested = 0;
+
+		auto pushStep = [&](uint32_t index)
+		{
+			const Texture& texture = m_textures[index];
+			if (texture.targetMip <= texture.requestedMip)
+				return;
+
+			const uint64_t cost = texture.residentSizes[texture.targetMip - 1] - texture.residentSizes[texture.targetMip];
+			steps.push(Step{ texture.priority / static_cast<double>(std::max<uint64_t>(cost, 1)), index });
+		};
+
+		for (uint32_t index = 0; index < m_textures.size(); index++)
+		{
+			Texture& texture = m_textures[index];
+			if (!texture.live)
+				continue;
+
+			// Tails are resident regardless of the budget
+			texture.requestedMip = RequestedMip(texture);
+			texture.targetMip = texture.TailMip();
+			used += texture.residentSizes[texture.TailMip()];
+			requested += texture.residentSizes[texture.requestedMip];
+
+			pushStep(index);
+		}
+
+		// A step that does not fit ends its texture's refinement, smaller steps of other textures may still fit
+		while (!steps.empty())
+		{
+			const Step step = steps.top();
+			steps.pop();
+
+			Texture& texture = m_textures[step.texture];
+			const uint64_t cost = texture.residentSizes[texture.targetMip - 1] - texture.residentSizes[texture.targetMip];
+			if (used + cost > m_budget)
+				continue;
+
+			used += cost;
+			texture.targetMip--;
+
+			pushStep(step.texture);
+		}
+
+		m_statistics.requestedBytes = requested;
+	}
+
+	uint64_t TextureStreamingManager::CommittedBytes(const Texture& texture) const
+	{
+		// A load in flight already owns its memory
+		return texture.residentSizes[std::min(texture.residentMip, texture.pendingMip)];
+	}
+
+	TextureStreamingUpdate TextureStreamingManager::Update()
+	{
+		m_updateIndex++;
+
+		for (Texture& texture : m_textures)
+		{
+			if (!texture.live)
+				continue;
+
+			texture.priority = texture.footprint;
+			if (texture.footprint > 0.0f)
+				texture.lastVisibleUpdate = m_updateIndex;
+
+			texture.footprint = 0.0f;
+		}
+
+		PlanTargets();
+
+		TextureStreamingUpdate update;
+
+		uint64_t committed = 0;
+		for (uint32_t index = 0; index < m_textures.size(); index++)
+		{
+			Texture& texture = m_textures[index];
+			if (!texture.live)
+				continue;
+
+			if (texture.pendingMip == texture.residentMip && texture.targetMip < texture.residentMip)
+			{
+				texture.pendingMip = texture.targetMip;
+				update.loads.push_back(TextureMipChange{ index, texture.targetMip });
+			}
+
+			committed += CommittedBytes(texture);
+		}
+
+		// Mips beyond the plan are kept as a cache until the budget needs their memory
+		if (committed > m_budget)
+		{
+			std::vector<uint32_t> candidates;
+			for (uint32_t index = 0; index < m_textures.size(); index++)
+			{
+				const Texture& texture = m_textures[index];
+				if (texture.live && texture.pendingMip == texture.residentMip && texture.targetMip > texture.residentMip)
+					candidates.push_back(index);
+			}
+
+			// Least visible first, then least recently visible
+			std::sort(candidates.begin(), candidates.end(), [this](uint32_t a, uint32_t b)
+			{
+				const Texture& left = m_textures[a];
+				const Texture& right = m_textures[b];
+				if (left.priority != right.priority)
+					return left.priority < right.priority;
+				if (left.lastVisibleUpdate != right.lastVisibleUpdate)
+					return left.lastVisibleUpdate < right.lastVisibleUpdate;
+
+				return a < b;
+			});
+
+			for (uint32_t index : candidates)
+			{
+				if (committed <= m_budget)
+					break;
+
+				Texture& texture = m_textures[index];
+				committed -= texture.residentSizes[texture.residentMip] - texture.residentSizes[texture.targetMip];
+				texture.residentMip = texture.targetMip;
+				texture.pendingMip = texture.targetMip;
+
+				update.evictions.push_back(TextureMipChange{ index, texture.targetMip });
+			}
+		}
+
+		m_statistics.committedBytes = committed;
+		m_statistics.loadCount = static_cast<uint32_t>(update.loads.size());
+		m_statistics.evictionCount = static_cast<uint32_t>(update.evictions.size());
+
+		return update;
+	}
+
+	void TextureStreamingManager::OnMipsResident(uint32_t texture, uint32_t mip)
+	{
+		Texture& entry = m_textures[texture];
+		if (!entry.live || entry.pendingMip != mip)
+			return;
+
+		entry.residentMip = mip;
+	}
+
+	void TextureStreamingManager::SetBudget(uint64_t budgetBytes)
+	{
+		m_budget = budgetBytes;
+		m_statistics.budgetBytes = budgetBytes;
+	}
+
+	void TextureStreamingManager::SetMipBias(float bias)
+	{
+		m_mipBias = bias;
+	}
+
+	uint32_t TextureStreamingManager::GetResidentMip(uint32_t texture) const
+	{
+		return m_textures[texture].residentMip;
+	}
+
+	uint32_t TextureStreamingManager::GetRequestedMip(uint32_t texture) const
+	{
+		return m_textures[texture].requestedMip;
+	}
+
+	uint32_t TextureStreamingManager::GetTargetMip(uint32_t texture) const
+	{
+		return m_textures[texture].targetMip;
+	}
+
+	const TextureStreamingManager::Statistics& TextureStreamingManager::GetStatistics() const
+	{
+		return m_statistics;
+	}
+}
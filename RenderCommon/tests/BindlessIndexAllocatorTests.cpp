@@ -0,0 +1,177 @@
+#include <gtest/gtest.h>
+
+#include <random>
+#include <stdexcept>
+#include <vector>
+
+#include <BindlessIndexAllocator.h>
+#include <SimulatedFenceTimeline.h>
+
+using namespace UltReality::Rendering::Common;
+using namespace UltReality::Rendering::Common::Tests;
+
+TEST(BindlessIndexAllocator, RejectsCapacitiesWithoutUsableIndices)
+{
+	EXPECT_THROW(BindlessIndexAllocator(0), std::invalid_argument);
+	EXPECT_THROW(BindlessIndexAllocator(BindlessHandle::invalidIndex), std::invalid_argument);
+	EXPECT_FALSE(BindlessHandle{}.IsValid());
+}
+
+TEST(BindlessIndexAllocator, FreedHandlesBecomeStale)
+{
+	BindlessIndexAllocator allocator(16);
+	const BindlessHandle first = allocator.Allocate();
+	const BindlessHandle second = allocator.Allocate();
+	EXPECT_EQ(first.index, 0u);
+	EXPECT_EQ(second.index, 1u);
+	EXPECT_EQ(allocator.Resolve(second), 1u);
+
+	allocator.Free(first);
+	EXPECT_FALSE(allocator.IsLive(first));
+	EXPECT_TRUE(allocator.IsLive(second));
+	EXPECT_THROW(allocator.Resolve(first), std::invalid_argument);
+	EXPECT_THROW(allocator.Free(first), std::invalid_argument);
+
+	// Handles of slots that were never handed out are rejected as well
+	EXPECT_FALSE(allocator.IsLive(BindlessHandle{ 5, 0 }));
+	EXPECT_THROW(allocator.Free(BindlessHandle{}), std::invalid_argument);
+}
+
+TEST(BindlessIndexAllocator, RecyclesIndicesOnlyAfterTheirFrameCompleted)
+{
+	SimulatedFenceTimeline fence;
+	BindlessIndexAllocator allocator(4);
+
+	const BindlessHandle first = allocator.Allocate();
+	allocator.Allocate();
+	allocator.Free(first);
+
+	// Frames in flight may still read the freed descriptor, so fresh slots are used instead
+	const uint64_t frame = fence.Signal();
+	allocator.FinishFrame(frame);
+	allocator.Retire(fence.GetCompletedValue());
+	EXPECT_EQ(allocator.Allocate().index, 2u);
+	EXPECT_EQ(allocator.Allocate().index, 3u);
+	EXPECT_EQ(allocator.GetStatistics().retiringCount, 1u);
+	EXPECT_THROW(allocator.Allocate(), std::runtime_error);
+
+	fence.Complete(frame);
+	allocator.Retire(fence.GetCompletedValue());
+	const BindlessHandle recycled = allocator.Allocate();
+	EXPECT_EQ(recycled.index, first.index);
+	EXPECT_EQ(recycled.generation, first.generation + 1);
+	EXPECT_TRUE(allocator.IsLive(recycled));
+	EXPECT_FALSE(allocator.IsLive(first));
+
+	const BindlessIndexAllocator::Statistics& statistics = allocator.GetStatistics();
+	EXPECT_EQ(statistics.capacity, 4u);
+	EXPECT_EQ(statistics.allocatedCount, 4u);
+	EXPECT_EQ(statistics.retiringCount, 0u);
+	EXPECT_EQ(statistics.highWaterMark, 4u);
+}
+
+TEST(BindlessIndexAllocator, RecyclesTheOldestFreedIndexFirst)
+{
+	SimulatedFenceTimeline fence;
+	BindlessIndexAllocator allocator(8);
+
+	std::vector<BindlessHandle> handles;
+	for (int i = 0; i < 8; i++)
+		handles.push_back(allocator.Allocate());
+
+	// Freed over two frames, in an order different from their indices
+	allocator.Free(handles[5]);
+	allocator.Free(handles[2]);
+	allocator.FinishFrame(fence.Signal());
+	allocator.Free(handles[7]);
+	allocator.FinishFrame(fence.Signal());
+
+	fence.CompleteAll();
+	allocator.Retire(fence.GetCompletedValue());
+	EXPECT_EQ(allocator.Allocate().index, 5u);
+	EXPECT_EQ(allocator.Allocate().index, 2u);
+	EXPECT_EQ(allocator.Allocate().index, 7u);
+}
+
+TEST(BindlessIndexAllocator, NeverHandsOutAnIndexAFrameInFlightCanRead)
+{
+	// Replays random allocation traffic over a simulated GPU that lags a few frames behind, tracking every index
+	// that is allocated or still readable by a frame in flight
+	std::mt19937 random(3);
+	SimulatedFenceTimeline fence;
+	constexpr uint32_t capacity = 1000;
+	BindlessIndexAllocator allocator(capacity);
+
+	struct FrameFrees
+	{
+		uint64_t fenceValue;
+		std::vector<uint32_t> indices;
+	};
+
+	std::vector<BindlessHandle> live;
+	std::vector<bool> busy(capacity, false);
+	std::vector<FrameFrees> inFlight;
+	std::vector<uint32_t> frameFreed;
+	std::vector<BindlessHandle> stale;
+
+	for (int step = 0; step < 200000; step++)
+	{
+		const uint32_t operation = random() % 10;
+		if (operation < 5)
+		{
+			const BindlessIndexAllocator::Statistics& statistics = allocator.GetStatistics();
+			if (statistics.allocatedCount + statistics.retiringCount == capacity)
+			{
+				ASSERT_THROW(allocator.Allocate(), std::runtime_error);
+				continue;
+			}
+
+			const BindlessHandle handle = allocator.Allocate();
+			ASSERT_LT(handle.index, capacity);
+			ASSERT_FALSE(busy[handle.index]) << "index " << handle.index << " handed out while in use, step " << step;
+
+			busy[handle.index] = true;
+			live.push_back(handle);
+		}
+		else if (operation < 9)
+		{
+			if (live.empty())
+				continue;
+
+			const size_t position = random() % live.size();
+			allocator.Free(live[position]);
+			frameFreed.push_back(live[position].index);
+			stale.push_back(live[position]);
+
+			live[position] = live.back();
+			live.pop_back();
+		}
+		else
+		{
+			const uint64_t frame = fence.Signal();
+			allocator.FinishFrame(frame);
+			inFlight.push_back(FrameFrees{ frame, std::move(frameFreed) });
+			frameFreed.clear();
+
+			// The GPU keeps up to three frames in flight
+			if (frame > 3)
+				fence.Complete(frame - random() % 4);
+			allocator.Retire(fence.GetCompletedValue());
+
+			while (!inFlight.empty() && inFlight.front().fenceValue <= fence.GetCompletedValue())
+			{
+				for (uint32_t index : inFlight.front().indices)
+					busy[index] = false;
+				inFlight.erase(inFlight.begin());
+			}
+		}
+	}
+
+	for (const BindlessHandle& handle : live)
+		ASSERT_TRUE(allocator.IsLive(handle));
+	for (const BindlessHandle& handle : stale)
+		ASSERT_FALSE(allocator.IsLive(handle));
+
+	EXPECT_EQ(allocator.GetStatistics().allocatedCount, live.size());
+	EXPECT_LE(allocator.GetStatistics().highWaterMark, capacity);
+}
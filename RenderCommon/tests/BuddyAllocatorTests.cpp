@@ -0,0 +1,201 @@
+#include <gtest/gtest.h>
+
+#include <map>
+#include <random>
+#include <stdexcept>
+#include <vector>
+
+#include <BuddyAllocator.h>
+
+using namespace UltReality::Rendering::Common;
+
+namespace
+{
+	constexpr uint64_t kilobyte = 1024;
+	constexpr uint64_t megabyte = 1024 * kilobyte;
+
+	// Checks that no two live blocks overlap and that the statistics agree with the blocks handed out
+	void ExpectConsistent(const BuddyAllocator& allocator, const std::map<uint64_t, uint64_t>& live)
+	{
+		uint64_t usedBytes = 0;
+		uint64_t end = 0;
+		for (const auto& [offset, size] : live)
+		{
+			const uint64_t blockSize = allocator.GetAllocationSize(offset);
+			ASSERT_GE(blockSize, size);
+			ASSERT_GE(offset, end) << "block at " << offset << " overlaps its predecessor";
+			ASSERT_EQ(offset % blockSize, 0u) << "block at " << offset << " is not naturally aligned";
+			end = offset + blockSize;
+			usedBytes += blockSize;
+		}
+		ASSERT_LE(end, allocator.GetCapacity());
+
+		const BuddyAllocator::Statistics stats = allocator.GetStatistics();
+		EXPECT_EQ(stats.allocationCount, live.size());
+		EXPECT_EQ(stats.usedBytes, usedBytes);
+		EXPECT_EQ(stats.usedBytes + stats.freeBytes, stats.capacity);
+		EXPECT_LE(stats.requestedBytes, stats.usedBytes);
+		EXPECT_LE(stats.largestFreeBlock, stats.freeBytes);
+	}
+}
+
+TEST(BuddyAllocator, RejectsInvalidConstruction)
+{
+	EXPECT_THROW(BuddyAllocator(3 * megabyte, 64 * kilobyte), std::invalid_argument);
+	EXPECT_THROW(BuddyAllocator(4 * megabyte, 48 * kilobyte), std::invalid_argument);
+	EXPECT_THROW(BuddyAllocator(64 * kilobyte, 4 * megabyte), std::invalid_argument);
+	EXPECT_THROW(BuddyAllocator(0, 0), std::invalid_argument);
+}
+
+TEST(BuddyAllocator, RejectsRequestsLargerThanTheRange)
+{
+	BuddyAllocator allocator(4 * megabyte, 64 * kilobyte);
+
+	EXPECT_EQ(allocator.Allocate(0, 1), BuddyAllocator::invalidOffset);
+	EXPECT_EQ(allocator.Allocate(4 * megabyte + 1, 1), BuddyAllocator::invalidOffset);
+	EXPECT_EQ(allocator.Allocate(64 * kilobyte, 8 * megabyte), BuddyAllocator::invalidOffset);
+
+	// Sizes above 2^63 cannot be rounded to a power of 2 and must be refused rather than rounded
+	EXPECT_EQ(allocator.Allocate(UINT64_MAX, 1), BuddyAllocator::invalidOffset);
+	EXPECT_EQ(allocator.Allocate((1ull << 63) + 1, 1), BuddyAllocator::invalidOffset);
+	EXPECT_EQ(allocator.Allocate(64 * kilobyte, UINT64_MAX), BuddyAllocator::invalidOffset);
+
+	EXPECT_TRUE(allocator.IsEmpty());
+}
+
+TEST(BuddyAllocator, RoundsToNaturallyAlignedPowerOfTwoBlocks)
+{
+	BuddyAllocator allocator(4 * megabyte, 64 * kilobyte);
+
+	const uint64_t small = allocator.Allocate(1, 1);
+	EXPECT_EQ(allocator.GetAllocationSize(small), 64 * kilobyte);
+
+	const uint64_t medium = allocator.Allocate(300 * kilobyte, 1);
+	EXPECT_EQ(allocator.GetAllocationSize(medium), 512 * kilobyte);
+	EXPECT_EQ(medium % (512 * kilobyte), 0u);
+
+	// The alignment raises the block size when it is the larger of the two
+	const uint64_t aligned = allocator.Allocate(64 * kilobyte, 1 * megabyte);
+	EXPECT_EQ(aligned % megabyte, 0u);
+	EXPECT_EQ(allocator.GetAllocationSize(aligned), 1 * megabyte);
+
+	const BuddyAllocator::Statistics stats = allocator.GetStatistics();
+	EXPECT_EQ(stats.requestedBytes, 1 + 300 * kilobyte + 64 * kilobyte);
+	EXPECT_EQ(stats.usedBytes, 64 * kilobyte + 512 * kilobyte + 1 * megabyte);
+}
+
+TEST(BuddyAllocator, ReusesTheLowestAddressFirst)
+{
+	BuddyAllocator allocator(1 * megabyte, 64 * kilobyte);
+
+	EXPECT_EQ(allocator.Allocate(64 * kilobyte, 1), 0u);
+	EXPECT_EQ(allocator.Allocate(64 * kilobyte, 1), 64 * kilobyte);
+	EXPECT_EQ(allocator.Allocate(128 * kilobyte, 1), 128 * kilobyte);
+
+	allocator.Free(0);
+	EXPECT_EQ(allocator.Allocate(64 * kilobyte, 1), 0u);
+}
+
+TEST(BuddyAllocator, MergesBuddiesBackIntoOneBlock)
+{
+	BuddyAllocator allocator(1 * megabyte, 64 * kilobyte);
+
+	std::vector<uint64_t> blocks;
+	for (int i = 0; i < 16; i++)
+		blocks.push_back(allocator.Allocate(64 * kilobyte, 1));
+
+	EXPECT_EQ(allocator.Allocate(1, 1), BuddyAllocator::invalidOffset);
+	EXPECT_EQ(allocator.GetStatistics().freeBytes, 0u);
+
+	// Freeing every other block leaves half the range free but nothing larger than one block
+	for (size_t i = 0; i < blocks.size(); i += 2)
+		allocator.Free(blocks[i]);
+
+	BuddyAllocator::Statistics stats = allocator.GetStatistics();
+	EXPECT_EQ(stats.freeBytes, 512 * kilobyte);
+	EXPECT_EQ(stats.largestFreeBlock, 64 * kilobyte);
+	EXPECT_EQ(stats.freeBlockCount, 8u);
+	EXPECT_FLOAT_EQ(stats.fragmentation, 1.0f - 1.0f / 8.0f);
+	EXPECT_EQ(allocator.Allocate(128 * kilobyte, 1), BuddyAllocator::invalidOffset);
+
+	for (size_t i = 1; i < blocks.size(); i += 2)
+		allocator.Free(blocks[i]);
+
+	stats = allocator.GetStatistics();
+	EXPECT_TRUE(allocator.IsEmpty());
+	EXPECT_EQ(stats.freeBlockCount, 1u);
+	EXPECT_EQ(stats.largestFreeBlock, 1 * megabyte);
+	EXPECT_FLOAT_EQ(stats.fragmentation, 0.0f);
+}
+
+TEST(BuddyAllocator, FreeOfAnUnknownOffsetThrows)
+{
+	BuddyAllocator allocator(1 * megabyte, 64 * kilobyte);
+
+	EXPECT_THROW(allocator.Free(0), std::invalid_argument);
+
+	const uint64_t offset = allocator.Allocate(64 * kilobyte, 1);
+	allocator.Free(offset);
+	EXPECT_THROW(allocator.Free(offset), std::invalid_argument);
+}
+
+TEST(BuddyAllocator, SyntheticTraceKeepsBlocksDisjoint)
+{
+	BuddyAllocator allocator(64 * megabyte, 64 * kilobyte);
+	std::mt19937 random(7);
+	std::uniform_int_distribution<uint64_t> sizes(1, 4 * megabyte);
+	std::uniform_int_distribution<uint32_t> alignmentShift(0, 22);
+
+	// Offset to requested size of every live allocation
+	std::map<uint64_t, uint64_t> live;
+	std::vector<uint64_t> liveOffsets;
+	for (int step = 0; step < 20000; step++)
+	{
+		// Lean towards allocating until about half the range is in use, then keep the load level
+		const bool allocate = liveOffsets.empty() || (random() % 100) < (allocator.GetStatistics().usedBytes < 32 * megabyte ? 70u : 45u);
+		if (allocate)
+		{
+			const uint64_t size = sizes(random);
+			const uint64_t alignment = 1ull << alignmentShift(random);
+			const uint64_t offset = allocator.Allocate(size, alignment);
+			if (offset == BuddyAllocator::invalidOffset)
+				continue;
+
+			ASSERT_EQ(offset % alignment, 0u);
+			ASSERT_TRUE(live.emplace(offset, size).second) << "offset " << offset << " handed out twice";
+			liveOffsets.push_back(offset);
+		}
+		else
+		{
+			const size_t index = random() % liveOffsets.size();
+			allocator.Free(liveOffsets[index]);
+			live.erase(liveOffsets[index]);
+			liveOffsets[index] = liveOffsets.back();
+			liveOffsets.pop_back();
+		}
+
+		if (step % 500 == 0)
+			ExpectConsistent(allocator, live);
+	}
+
+	ExpectConsistent(allocator, live);
+
+	for (uint64_t offset : liveOffsets)
+		allocator.Free(offset);
+
+	const BuddyAllocator::Statistics stats = allocator.GetStatistics();
+	EXPECT_TRUE(allocator.IsEmpty());
+	EXPECT_EQ(stats.freeBlockCount, 1u);
+	EXPECT_EQ(stats.largestFreeBlock, 64 * megabyte);
+	EXPECT_EQ(stats.requestedBytes, 0u);
+}
+
+TEST(BuddyAllocator, NextPowerOfTwo)
+{
+	EXPECT_EQ(BuddyAllocator::NextPowerOfTwo(0), 1u);
+	EXPECT_EQ(BuddyAllocator::NextPowerOfTwo(1), 1u);
+	EXPECT_EQ(BuddyAllocator::NextPowerOfTwo(3), 4u);
+	EXPECT_EQ(BuddyAllocator::NextPowerOfTwo(64 * kilobyte), 64 * kilobyte);
+	EXPECT_EQ(BuddyAllocator::NextPowerOfTwo(64 * kilobyte + 1), 128 * kilobyte);
+	EXPECT_EQ(BuddyAllocator::NextPowerOfTwo(1ull << 63), 1ull << 63);
+}
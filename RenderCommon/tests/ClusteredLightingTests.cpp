@@ -0,0 +1,211 @@
+#include <gtest/gtest.h>
+
+#include <cmath>
+#include <random>
+#include <stdexcept>
+#include <vector>
+
+#include <ClusteredLighting.h>
+#include <FrustumCulling.h>
+#include <JobSystem.h>
+
+using namespace UltReality::Rendering::Common;
+
+namespace
+{
+	constexpr CullingSimdPath allPaths[] = { CullingSimdPath::Scalar, CullingSimdPath::Sse, CullingSimdPath::Neon, CullingSimdPath::Avx2 };
+
+	// View space lights spread through and around the frustum, some behind the camera or beyond the far plane
+	void RandomLights(uint32_t count, uint32_t seed, float maxRange, BoundingSphereSoA& lights)
+	{
+		std::mt19937 random(seed);
+		std::uniform_real_distribution<float> unit(0.0f, 1.0f);
+
+		lights.Clear();
+		for (uint32_t i = 0; i < count; i++)
+		{
+			const float z = unit(random) * 130.0f - 5.0f;
+			const float center[3] = { (unit(random) * 2.0f - 1.0f) * z * 1.1f, (unit(random) * 2.0f - 1.0f) * z * 0.7f, z };
+			lights.Add(center, 0.2f + unit(random) * maxRange);
+		}
+	}
+
+	void ExpectSameBins(const std::vector<ClusterLightRange>& clusters, const std::vector<uint32_t>& lightIndices,
+		const std::vector<ClusterLightRange>& expectedClusters, const std::vector<uint32_t>& expectedIndices)
+	{
+		ASSERT_EQ(clusters.size(), expectedClusters.size());
+		for (size_t cluster = 0; cluster < clusters.size(); cluster++)
+		{
+			ASSERT_EQ(clusters[cluster].offset, expectedClusters[cluster].offset) << "cluster " << cluster;
+			ASSERT_EQ(clusters[cluster].count, expectedClusters[cluster].count) << "cluster " << cluster;
+		}
+		ASSERT_EQ(lightIndices, expectedIndices);
+	}
+}
+
+TEST(ClusteredLighting, RejectsInvalidGridsAndProjections)
+{
+	EXPECT_THROW(ClusteredLightBinner(nullptr, ClusterGridSettings{ 0, 9, 24 }), std::invalid_argument);
+	EXPECT_THROW(ClusteredLightBinner(nullptr, ClusterGridSettings{ 64, 64, 32 }), std::invalid_argument);
+
+	ClusteredLightBinner binner;
+	BoundingSphereSoA lights;
+	std::vector<ClusterLightRange> clusters;
+	std::vector<uint32_t> lightIndices;
+	EXPECT_THROW(binner.Bin(lights, clusters, lightIndices), std::logic_error);
+
+	EXPECT_THROW(binner.SetProjection(0.0f, 1.0f, 0.1f, 100.0f), std::invalid_argument);
+	EXPECT_THROW(binner.SetProjection(1.0f, 0.0f, 0.1f, 100.0f), std::invalid_argument);
+	EXPECT_THROW(binner.SetProjection(1.0f, 1.0f, 0.0f, 100.0f), std::invalid_argument);
+	EXPECT_THROW(binner.SetProjection(1.0f, 1.0f, 10.0f, 1.0f), std::invalid_argument);
+
+	// A new grid needs a new projection
+	binner.SetProjection(1.0f, 1.0f, 0.1f, 100.0f);
+	binner.SetGrid(ClusterGridSettings{ 8, 4, 16 });
+	EXPECT_EQ(binner.GetClusterCount(), 8u * 4u * 16u);
+	EXPECT_THROW(binner.Bin(lights, clusters, lightIndices), std::logic_error);
+}
+
+TEST(ClusteredLighting, SlicesCoverTheDepthRangeExponentially)
+{
+	const ClusterGridSettings grid{ 16, 9, 24 };
+	ClusteredLightBinner binner(nullptr, grid);
+	binner.SetProjection(1.0f, 16.0f / 9.0f, 0.1f, 100.0f);
+
+	float min[3];
+	float max[3];
+	float previousFar = 0.1f;
+	for (uint32_t slice = 0; slice < grid.depthSlices; slice++)
+	{
+		binner.GetClusterBounds(slice * grid.tilesX * grid.tilesY, min, max);
+		EXPECT_FLOAT_EQ(min[2], previousFar) << "slice " << slice;
+		previousFar = max[2];
+
+		// Every slice spans the same depth ratio, and its middle maps back to it
+		EXPECT_NEAR(std::log2(max[2] / min[2]), std::log2(1000.0f) / grid.depthSlices, 1e-3f) << "slice " << slice;
+		EXPECT_EQ(binner.GetDepthSlice(std::sqrt(min[2] * max[2])), slice);
+	}
+	EXPECT_EQ(previousFar, 100.0f);
+
+	EXPECT_EQ(binner.GetDepthSlice(0.01f), 0u);
+	EXPECT_EQ(binner.GetDepthSlice(1000.0f), grid.depthSlices - 1);
+	EXPECT_THROW(binner.GetClusterBounds(binner.GetClusterCount(), min, max), std::out_of_range);
+
+	// The shader's slice formula is the one the binner uses
+	const ClusterShaderConstants constants = binner.GetShaderConstants(42);
+	EXPECT_EQ(constants.tilesX, grid.tilesX);
+	EXPECT_EQ(constants.depthSlices, grid.depthSlices);
+	EXPECT_EQ(constants.lightCount, 42u);
+	EXPECT_EQ(constants.lightBufferIndex, UINT32_MAX);
+	for (float viewZ : { 0.5f, 3.0f, 20.0f, 77.0f })
+	{
+		const float slice = std::floor(std::log2(viewZ) * constants.sliceScale + constants.sliceBias);
+		EXPECT_EQ(static_cast<uint32_t>(slice), binner.GetDepthSlice(viewZ)) << "depth " << viewZ;
+	}
+}
+
+TEST(ClusteredLighting, PointLightsLandInTheClusterContainingThem)
+{
+	const ClusterGridSettings grid{ 16, 9, 24 };
+	ClusteredLightBinner binner(nullptr, grid);
+	binner.SetProjection(1.0f, 16.0f / 9.0f, 0.1f, 100.0f);
+
+	BoundingSphereSoA lights;
+	const float inside[3] = { 1.0f, 0.5f, 20.0f };
+	const float behind[3] = { 0.0f, 0.0f, -5.0f };
+	const float beyondFar[3] = { 0.0f, 0.0f, 150.0f };
+	lights.Add(inside, 0.01f);
+	lights.Add(behind, 1.0f);
+	lights.Add(beyondFar, 1.0f);
+
+	std::vector<ClusterLightRange> clusters;
+	std::vector<uint32_t> lightIndices;
+	binner.Bin(lights, clusters, lightIndices);
+
+	// Only the first light is binned, into the one cluster around it
+	ASSERT_EQ(lightIndices, std::vector<uint32_t>{ 0 });
+	uint32_t cluster = 0;
+	while (clusters[cluster].count == 0)
+		cluster++;
+
+	EXPECT_EQ(cluster / (grid.tilesX * grid.tilesY), binner.GetDepthSlice(inside[2]));
+	float min[3];
+	float max[3];
+	binner.GetClusterBounds(cluster, min, max);
+	for (uint32_t axis = 0; axis < 3; axis++)
+	{
+		EXPECT_LE(min[axis], inside[axis]);
+		EXPECT_GE(max[axis], inside[axis]);
+	}
+
+	const ClusteredLightBinner::Statistics& statistics = binner.GetStatistics();
+	EXPECT_EQ(statistics.lightCount, 3u);
+	EXPECT_EQ(statistics.clusterCount, binner.GetClusterCount());
+	EXPECT_EQ(statistics.indexCount, 1u);
+	EXPECT_EQ(statistics.maxLightsPerCluster, 1u);
+}
+
+TEST(ClusteredLighting, BinningMatchesTheReference)
+{
+	JobSystem jobSystem(4);
+
+	for (uint32_t count : { 0u, 1u, 7u, 333u, 2000u })
+	{
+		BoundingSphereSoA lights;
+		RandomLights(count, count + 3, 8.0f, lights);
+
+		for (JobSystem* jobs : { static_cast<JobSystem*>(nullptr), &jobSystem })
+		{
+			ClusteredLightBinner binner(jobs);
+			binner.SetProjection(1.0f, 16.0f / 9.0f, 0.1f, 100.0f);
+
+			std::vector<ClusterLightRange> expectedClusters;
+			std::vector<uint32_t> expectedIndices;
+			BinClusterLightsReference(binner, lights, expectedClusters, expectedIndices);
+
+			for (CullingSimdPath path : allPaths)
+			{
+				if (!FrustumCuller::IsSimdPathSupported(path))
+					continue;
+
+				binner.SetSimdPath(path);
+				std::vector<ClusterLightRange> clusters;
+				std::vector<uint32_t> lightIndices;
+				binner.Bin(lights, clusters, lightIndices);
+
+				SCOPED_TRACE(testing::Message() << count << " lights, path " << static_cast<uint32_t>(path) << (jobs ? ", parallel" : ""));
+				ExpectSameBins(clusters, lightIndices, expectedClusters, expectedIndices);
+				EXPECT_EQ(binner.GetStatistics().indexCount, expectedIndices.size());
+			}
+		}
+	}
+}
+
+TEST(ClusteredLighting, ClustersListOnlyTheirLocalLights)
+{
+	// Many small lights: every pixel should see a small fraction of them
+	ClusteredLightBinner binner;
+	binner.SetProjection(1.0f, 16.0f / 9.0f, 0.1f, 100.0f);
+
+	BoundingSphereSoA lights;
+	RandomLights(4000, 9, 2.0f, lights);
+
+	std::vector<ClusterLightRange> clusters;
+	std::vector<uint32_t> lightIndices;
+	binner.Bin(lights, clusters, lightIndices);
+
+	const ClusteredLightBinner::Statistics& statistics = binner.GetStatistics();
+	EXPECT_GT(statistics.indexCount, 0u);
+	EXPECT_LT(statistics.maxLightsPerCluster, 4000u / 10u);
+
+	// Ranges are packed back to back, every index list ascending
+	uint32_t offset = 0;
+	for (const ClusterLightRange& range : clusters)
+	{
+		ASSERT_EQ(range.offset, offset);
+		for (uint32_t i = 1; i < range.count; i++)
+			ASSERT_LT(lightIndices[range.offset + i - 1], lightIndices[range.offset + i]);
+		offset += range.count;
+	}
+	EXPECT_EQ(offset, lightIndices.size());
+}
@@ -0,0 +1,171 @@
+#include <gtest/gtest.h>
+
+#include <stdint.h>
+#include <memory>
+#include <vector>
+
+#include <DeferredReleaseQueue.h>
+#include <FrameRing.h>
+#include <SimulatedFenceTimeline.h>
+
+using namespace UltReality::Rendering::Common;
+using UltReality::Rendering::Common::Tests::SimulatedFenceTimeline;
+
+namespace
+{
+	/// <summary>
+	/// What happened to the simulated GPU resources of a test
+	/// </summary>
+	struct ResourceLog
+	{
+		const SimulatedFenceTimeline* timeline = nullptr;
+		uint32_t liveCount = 0;
+		// Resources destroyed before the GPU completed the last frame that used them
+		uint32_t destroyedInUse = 0;
+	};
+
+	/// <summary>
+	/// Resource the GPU uses until the fence value of the last frame that referenced it completes
+	/// </summary>
+	struct SimulatedResource
+	{
+		ResourceLog* log;
+		uint64_t lastUseFenceValue = 0;
+
+		explicit SimulatedResource(ResourceLog* log) : log(log)
+		{
+			log->liveCount++;
+		}
+
+		~SimulatedResource()
+		{
+			log->liveCount--;
+			if (log->timeline->GetCompletedValue() < lastUseFenceValue)
+				log->destroyedInUse++;
+		}
+	};
+}
+
+TEST(DeferredReleaseQueue, KeepsObjectsUntilTheirFrameCompletes)
+{
+	SimulatedFenceTimeline timeline;
+	ResourceLog log{ &timeline };
+	DeferredReleaseQueue<std::unique_ptr<SimulatedResource>> queue;
+
+	queue.Release(std::make_unique<SimulatedResource>(&log));
+	queue.FinishFrame(timeline.Signal());
+	queue.Release(std::make_unique<SimulatedResource>(&log));
+	queue.Release(std::make_unique<SimulatedResource>(&log));
+	queue.FinishFrame(timeline.Signal());
+	EXPECT_EQ(queue.GetPendingCount(), 3u);
+
+	queue.Retire(timeline.GetCompletedValue());
+	EXPECT_EQ(log.liveCount, 3u);
+
+	timeline.Complete(1);
+	queue.Retire(timeline.GetCompletedValue());
+	EXPECT_EQ(log.liveCount, 2u);
+	EXPECT_EQ(queue.GetPendingCount(), 2u);
+
+	timeline.CompleteAll();
+	queue.Retire(timeline.GetCompletedValue());
+	EXPECT_EQ(log.liveCount, 0u);
+	EXPECT_EQ(queue.GetPendingCount(), 0u);
+	EXPECT_TRUE(timeline.GetBlockingWaits().empty());
+}
+
+TEST(DeferredReleaseQueue, ObjectsReleasedBetweenFramesWaitForTheNextFrame)
+{
+	SimulatedFenceTimeline timeline;
+	ResourceLog log{ &timeline };
+	DeferredReleaseQueue<std::unique_ptr<SimulatedResource>> queue;
+
+	queue.FinishFrame(timeline.Signal());
+	queue.Release(std::make_unique<SimulatedResource>(&log));
+
+	// The frame before the release completing is not enough, nor is an untagged retire
+	timeline.CompleteAll();
+	queue.Retire(UINT64_MAX);
+	EXPECT_EQ(log.liveCount, 1u);
+
+	queue.FinishFrame(timeline.Signal());
+	queue.Retire(timeline.GetCompletedValue());
+	EXPECT_EQ(log.liveCount, 1u);
+
+	timeline.CompleteAll();
+	queue.Retire(timeline.GetCompletedValue());
+	EXPECT_EQ(log.liveCount, 0u);
+}
+
+TEST(DeferredReleaseQueue, RetireHandsBackObjectsOldestFirst)
+{
+	DeferredReleaseQueue<uint32_t> queue;
+	for (uint32_t frame = 0; frame < 5; frame++)
+	{
+		queue.Release(frame * 10);
+		queue.Release(frame * 10 + 1);
+		queue.FinishFrame(frame + 1);
+	}
+
+	// Frames without releases add nothing
+	queue.FinishFrame(6);
+	EXPECT_EQ(queue.GetPendingCount(), 10u);
+
+	std::vector<uint32_t> retired;
+	queue.Retire(3, [&retired](uint32_t& object) { retired.push_back(object); });
+	EXPECT_EQ(retired, (std::vector<uint32_t>{ 0, 1, 10, 11, 20, 21 }));
+	EXPECT_EQ(queue.GetPendingCount(), 4u);
+
+	queue.Retire(2, [&retired](uint32_t& object) { retired.push_back(object); });
+	EXPECT_EQ(retired.size(), 6u);
+
+	queue.Retire(100, [&retired](uint32_t& object) { retired.push_back(object); });
+	EXPECT_EQ(retired, (std::vector<uint32_t>{ 0, 1, 10, 11, 20, 21, 30, 31, 40, 41 }));
+	EXPECT_EQ(queue.GetPendingCount(), 0u);
+}
+
+TEST(DeferredReleaseQueue, ReplacingResourcesEveryFewFramesNeverStallsOrFreesEarly)
+{
+	SimulatedFenceTimeline timeline;
+	ResourceLog log{ &timeline };
+	DeferredReleaseQueue<std::unique_ptr<SimulatedResource>> queue;
+	FrameRing ring(&timeline, 3);
+
+	// A settings change replaces the target the frames draw into, sometimes mid frame and sometimes between frames
+	std::unique_ptr<SimulatedResource> target = std::make_unique<SimulatedResource>(&log);
+	for (uint32_t frame = 0; frame < 500; frame++)
+	{
+		ring.BeginFrame();
+		queue.Retire(timeline.GetCompletedValue());
+
+		if (frame % 7 == 0)
+		{
+			queue.Release(std::move(target));
+			target = std::make_unique<SimulatedResource>(&log);
+		}
+		target->lastUseFenceValue = timeline.GetSignaledValue() + 1;
+
+		const uint64_t fenceValue = ring.EndFrame();
+		queue.FinishFrame(fenceValue);
+
+		if (frame % 11 == 5)
+		{
+			queue.Release(std::move(target));
+			target = std::make_unique<SimulatedResource>(&log);
+		}
+
+		// The GPU runs one to three frames behind
+		timeline.Complete(fenceValue - frame % 3);
+		ASSERT_EQ(log.liveCount, queue.GetPendingCount() + 1) << "frame " << frame;
+	}
+
+	EXPECT_EQ(log.destroyedInUse, 0u);
+	// The only waits are the ring's own for a free frame slot, never one for a replaced resource
+	EXPECT_EQ(timeline.GetBlockingWaits().size(), ring.GetStallCount());
+
+	ring.WaitForIdle();
+	queue.Retire(timeline.GetCompletedValue());
+	target.reset();
+	EXPECT_EQ(log.liveCount, 0u);
+	EXPECT_EQ(log.destroyedInUse, 0u);
+}
@@ -0,0 +1,195 @@
+#include <gtest/gtest.h>
+
+#include <algorithm>
+#include <random>
+#include <stdexcept>
+#include <vector>
+
+#include <DescriptorFreeList.h>
+#include <LinearRingAllocator.h>
+
+using namespace UltReality::Rendering::Common;
+
+namespace
+{
+	// Descriptor heap that stores the id of the allocation owning each slot, so overlapping ranges are caught
+	class FakeDescriptorHeap : public IDescriptorPageFactory
+	{
+	public:
+		static constexpr int freeSlot = -1;
+
+		std::vector<std::vector<int>> pages;
+
+		void CreatePage(uint32_t pageIndex, uint32_t descriptorCount) override
+		{
+			ASSERT_EQ(pageIndex, pages.size()) << "pages must be created in order";
+			pages.emplace_back(descriptorCount, freeSlot);
+		}
+
+		// Writes owner into every slot of range, failing if a slot is already owned
+		void Write(const DescriptorRange& range, int owner)
+		{
+			ASSERT_TRUE(range.IsValid());
+			ASSERT_LT(range.page, pages.size());
+			ASSERT_LE(range.offset + range.count, pages[range.page].size());
+			for (uint32_t slot = range.offset; slot < range.offset + range.count; slot++)
+			{
+				ASSERT_EQ(pages[range.page][slot], freeSlot) << "slot " << slot << " of page " << range.page << " handed out twice";
+				pages[range.page][slot] = owner;
+			}
+		}
+
+		void Clear(const DescriptorRange& range)
+		{
+			for (uint32_t slot = range.offset; slot < range.offset + range.count; slot++)
+				pages[range.page][slot] = freeSlot;
+		}
+	};
+}
+
+TEST(DescriptorFreeList, RejectsInvalidArguments)
+{
+	FakeDescriptorHeap heap;
+
+	EXPECT_THROW(DescriptorFreeList(nullptr, 64), std::invalid_argument);
+	EXPECT_THROW(DescriptorFreeList(&heap, 0), std::invalid_argument);
+
+	DescriptorFreeList freeList(&heap, 64);
+	EXPECT_THROW(freeList.Allocate(0), std::out_of_range);
+	EXPECT_THROW(freeList.Allocate(65), std::out_of_range);
+	EXPECT_THROW(freeList.Free(DescriptorRange{ 3, 0, 1 }), std::out_of_range);
+}
+
+TEST(DescriptorFreeList, CreatesPagesLazilyAndOnlyWhenFull)
+{
+	FakeDescriptorHeap heap;
+	DescriptorFreeList freeList(&heap, 8);
+
+	EXPECT_EQ(freeList.GetPageCount(), 0u);
+	EXPECT_TRUE(heap.pages.empty());
+
+	const DescriptorRange first = freeList.Allocate(5);
+	EXPECT_EQ(first.page, 0u);
+	EXPECT_EQ(first.offset, 0u);
+	EXPECT_EQ(heap.pages.size(), 1u);
+
+	const DescriptorRange second = freeList.Allocate(3);
+	EXPECT_EQ(second.page, 0u);
+	EXPECT_EQ(second.offset, 5u);
+
+	// Page 0 is full, so the next allocation grows
+	const DescriptorRange third = freeList.Allocate(1);
+	EXPECT_EQ(third.page, 1u);
+	EXPECT_EQ(heap.pages.size(), 2u);
+	EXPECT_EQ(freeList.GetAllocatedCount(), 9u);
+
+	// Freed space in an earlier page is used before later pages
+	freeList.Free(first);
+	const DescriptorRange fourth = freeList.Allocate(4);
+	EXPECT_EQ(fourth.page, 0u);
+	EXPECT_EQ(fourth.offset, 0u);
+	EXPECT_EQ(heap.pages.size(), 2u);
+}
+
+TEST(DescriptorFreeList, CoalescesNeighbouringFreeRanges)
+{
+	FakeDescriptorHeap heap;
+	DescriptorFreeList freeList(&heap, 16);
+
+	const DescriptorRange a = freeList.Allocate(4);
+	const DescriptorRange b = freeList.Allocate(4);
+	const DescriptorRange c = freeList.Allocate(4);
+	const DescriptorRange d = freeList.Allocate(4);
+
+	// Freeing b then c then a leaves a free run of 12 in front of d, which only fits if all three merged
+	freeList.Free(b);
+	freeList.Free(c);
+	freeList.Free(a);
+
+	const DescriptorRange merged = freeList.Allocate(12);
+	EXPECT_EQ(merged.page, 0u);
+	EXPECT_EQ(merged.offset, 0u);
+	EXPECT_EQ(freeList.GetPageCount(), 1u);
+
+	freeList.Free(merged);
+	freeList.Free(d);
+	EXPECT_EQ(freeList.GetAllocatedCount(), 0u);
+
+	const DescriptorRange whole = freeList.Allocate(16);
+	EXPECT_EQ(whole.page, 0u);
+	EXPECT_EQ(whole.offset, 0u);
+}
+
+TEST(DescriptorFreeList, RandomTraceNeverOverlapsRanges)
+{
+	FakeDescriptorHeap heap;
+	DescriptorFreeList freeList(&heap, 256);
+	std::mt19937 random(11);
+
+	std::vector<DescriptorRange> live;
+	uint32_t liveCount = 0;
+	uint32_t peakLiveCount = 0;
+	for (int step = 0; step < 20000; step++)
+	{
+		if (live.empty() || random() % 100 < 55)
+		{
+			const DescriptorRange range = freeList.Allocate(1 + random() % 32);
+			heap.Write(range, step);
+			ASSERT_FALSE(HasFatalFailure());
+			live.push_back(range);
+			liveCount += range.count;
+			peakLiveCount = std::max(peakLiveCount, liveCount);
+		}
+		else
+		{
+			const size_t index = random() % live.size();
+			heap.Clear(live[index]);
+			freeList.Free(live[index]);
+			liveCount -= live[index].count;
+			live[index] = live.back();
+			live.pop_back();
+		}
+
+		ASSERT_EQ(freeList.GetAllocatedCount(), liveCount);
+	}
+
+	// First fit keeps the live set packed, so the heap never grows far past the most that was ever in use
+	EXPECT_LE(freeList.GetPageCount() * freeList.GetPageSize(), 2 * peakLiveCount);
+}
+
+TEST(DescriptorRing, RetiresTablesOnlyAfterTheirFrame)
+{
+	// Shader-visible tables are carved from a ring of descriptors, one unit per descriptor
+	constexpr uint32_t ringSize = 2048;
+	LinearRingAllocator ring(ringSize);
+	std::vector<uint64_t> slotFrame(ringSize, 0);
+
+	uint64_t completedFrame = 0;
+	std::mt19937 random(5);
+	for (uint64_t frame = 1; frame <= 500; frame++)
+	{
+		// Three frames in flight, the GPU retires the oldest before the CPU starts a new one
+		if (frame > 3)
+		{
+			completedFrame = frame - 3;
+			ring.Retire(completedFrame);
+		}
+
+		const uint32_t tableCount = 1 + random() % 20;
+		for (uint32_t table = 0; table < tableCount; table++)
+		{
+			const uint32_t size = 1 + random() % 16;
+			const uint64_t offset = ring.Allocate(size, 1);
+			ASSERT_NE(offset, LinearRingAllocator::invalidOffset);
+
+			// Every slot reused must belong to a frame the GPU already finished
+			for (uint64_t slot = offset; slot < offset + size; slot++)
+			{
+				ASSERT_LE(slotFrame[slot], completedFrame) << "slot " << slot << " overwritten while frame " << slotFrame[slot] << " is in flight";
+				slotFrame[slot] = frame;
+			}
+		}
+
+		ring.FinishFrame(frame);
+	}
+}
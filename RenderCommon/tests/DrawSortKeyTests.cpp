@@ -0,0 +1,169 @@
+#include <gtest/gtest.h>
+
+#include <algorithm>
+#include <cmath>
+#include <numeric>
+#include <random>
+#include <stdexcept>
+#include <vector>
+
+#include <DrawSortKey.h>
+#include <JobSystem.h>
+
+using namespace UltReality::Rendering::Common;
+
+namespace
+{
+	DrawSortKeyFields Fields(uint32_t pass, DrawLayer layer, uint32_t pipeline, uint32_t material, float depth)
+	{
+		DrawSortKeyFields fields;
+		fields.pass = pass;
+		fields.layer = layer;
+		fields.pipeline = pipeline;
+		fields.material = material;
+		fields.depth = depth;
+
+		return fields;
+	}
+
+	std::vector<uint32_t> StableSortedOrder(const std::vector<uint64_t>& keys)
+	{
+		std::vector<uint32_t> order(keys.size());
+		std::iota(order.begin(), order.end(), 0u);
+		std::stable_sort(order.begin(), order.end(), [&keys](uint32_t a, uint32_t b) { return keys[a] < keys[b]; });
+
+		return order;
+	}
+}
+
+TEST(DrawSortKey, FieldsSurviveARoundTrip)
+{
+	for (DrawLayer layer : { DrawLayer::Opaque, DrawLayer::AlphaTested, DrawLayer::Transparent, DrawLayer::Overlay })
+	{
+		const DrawSortKeyFields decoded = DecodeDrawSortKey(EncodeDrawSortKey(Fields(maxDrawPasses - 1, layer, 1234, maxDrawStateIds - 1, 0.25f)));
+		EXPECT_EQ(decoded.pass, maxDrawPasses - 1);
+		EXPECT_EQ(decoded.layer, layer);
+		EXPECT_EQ(decoded.pipeline, 1234u);
+		EXPECT_EQ(decoded.material, maxDrawStateIds - 1);
+		EXPECT_NEAR(decoded.depth, 0.25f, 1.0f / (1 << drawSortDepthBits));
+	}
+
+	// Depths outside [0, 1] and NaN are clamped
+	EXPECT_EQ(DecodeDrawSortKey(EncodeDrawSortKey(Fields(0, DrawLayer::Opaque, 0, 0, -3.0f))).depth, 0.0f);
+	EXPECT_EQ(DecodeDrawSortKey(EncodeDrawSortKey(Fields(0, DrawLayer::Opaque, 0, 0, 7.0f))).depth, 1.0f);
+	EXPECT_EQ(DecodeDrawSortKey(EncodeDrawSortKey(Fields(0, DrawLayer::Opaque, 0, 0, std::nanf("")))).depth, 0.0f);
+
+	EXPECT_THROW(EncodeDrawSortKey(Fields(maxDrawPasses, DrawLayer::Opaque, 0, 0, 0.0f)), std::invalid_argument);
+	EXPECT_THROW(EncodeDrawSortKey(Fields(0, DrawLayer::Opaque, maxDrawStateIds, 0, 0.0f)), std::invalid_argument);
+	EXPECT_THROW(EncodeDrawSortKey(Fields(0, DrawLayer::Opaque, 0, maxDrawStateIds, 0.0f)), std::invalid_argument);
+}
+
+TEST(DrawSortKey, KeysOrderPassesLayersStateAndDepth)
+{
+	auto key = [](uint32_t pass, DrawLayer layer, uint32_t pipeline, uint32_t material, float depth)
+	{
+		return EncodeDrawSortKey(Fields(pass, layer, pipeline, material, depth));
+	};
+
+	// Pass, then layer, before anything else
+	EXPECT_LT(key(0, DrawLayer::Overlay, 9, 9, 1.0f), key(1, DrawLayer::Opaque, 0, 0, 0.0f));
+	EXPECT_LT(key(0, DrawLayer::Opaque, 9, 9, 1.0f), key(0, DrawLayer::AlphaTested, 0, 0, 0.0f));
+	EXPECT_LT(key(0, DrawLayer::AlphaTested, 9, 9, 0.0f), key(0, DrawLayer::Transparent, 0, 0, 1.0f));
+
+	// Opaque: pipeline, then material, then front to back
+	EXPECT_LT(key(0, DrawLayer::Opaque, 1, 9, 1.0f), key(0, DrawLayer::Opaque, 2, 0, 0.0f));
+	EXPECT_LT(key(0, DrawLayer::Opaque, 1, 1, 1.0f), key(0, DrawLayer::Opaque, 1, 2, 0.0f));
+	EXPECT_LT(key(0, DrawLayer::Opaque, 1, 1, 0.1f), key(0, DrawLayer::Opaque, 1, 1, 0.9f));
+
+	// Transparent: back to front, state only breaks ties
+	EXPECT_LT(key(0, DrawLayer::Transparent, 9, 9, 0.9f), key(0, DrawLayer::Transparent, 0, 0, 0.1f));
+	EXPECT_LT(key(0, DrawLayer::Transparent, 1, 9, 0.5f), key(0, DrawLayer::Transparent, 2, 0, 0.5f));
+
+	// The state bits ignore depth only
+	EXPECT_EQ(DrawSortKeyState(key(0, DrawLayer::Opaque, 1, 1, 0.1f)), DrawSortKeyState(key(0, DrawLayer::Opaque, 1, 1, 0.9f)));
+	EXPECT_EQ(DrawSortKeyState(key(0, DrawLayer::Transparent, 1, 1, 0.1f)), DrawSortKeyState(key(0, DrawLayer::Transparent, 1, 1, 0.9f)));
+	EXPECT_NE(DrawSortKeyState(key(0, DrawLayer::Opaque, 1, 1, 0.1f)), DrawSortKeyState(key(0, DrawLayer::Opaque, 1, 2, 0.1f)));
+
+	const std::vector<uint64_t> keys = {
+		key(0, DrawLayer::Opaque, 1, 1, 0.1f),
+		key(0, DrawLayer::Opaque, 1, 1, 0.5f),
+		key(0, DrawLayer::Opaque, 2, 1, 0.5f),
+		key(0, DrawLayer::Opaque, 1, 1, 0.7f)
+	};
+	EXPECT_EQ(CountDrawStateChanges(keys), 2u);
+	const uint32_t grouped[] = { 0, 1, 3, 2 };
+	EXPECT_EQ(CountDrawStateChanges(keys, grouped), 1u);
+	EXPECT_EQ(CountDrawStateChanges({}), 0u);
+}
+
+TEST(DrawSortKey, RadixSortMatchesStableSort)
+{
+	std::mt19937 random(3);
+	JobSystem jobSystem(4);
+
+	for (uint32_t count : { 0u, 1u, 2u, 100u, 16385u, 100000u })
+	{
+		std::vector<uint64_t> keys(count);
+		for (uint64_t& key : keys)
+		{
+			key = EncodeDrawSortKey(Fields(random() % 4, static_cast<DrawLayer>(random() % 4), random() % 200, random() % 50,
+				static_cast<float>(random() % 1000) / 1000.0f));
+		}
+		// Equal keys must keep their submission order
+		for (uint32_t i = 0; i + 8 < count; i += 7)
+			keys[i + 8] = keys[i];
+
+		const std::vector<uint32_t> expected = StableSortedOrder(keys);
+
+		// Chunks small enough that several jobs histogram and scatter every pass
+		for (JobSystem* jobs : { static_cast<JobSystem*>(nullptr), &jobSystem })
+		{
+			for (uint32_t keysPerJob : { DrawKeySorter::defaultKeysPerJob, 1000u })
+			{
+				DrawKeySorter sorter(jobs, keysPerJob);
+				std::vector<uint32_t> order;
+				sorter.Sort(keys, order);
+				ASSERT_EQ(order, expected) << count << " keys, " << keysPerJob << " per job" << (jobs ? ", parallel" : "");
+				EXPECT_EQ(sorter.GetStatistics().keyCount, count);
+			}
+		}
+	}
+}
+
+TEST(DrawSortKey, SkipsPassesOverBytesEveryKeyShares)
+{
+	// Only the material differs, which lives in bits 24 to 39 of an opaque key
+	std::vector<uint64_t> keys;
+	for (uint32_t material : { 700u, 3u, 65000u, 3u, 12u })
+		keys.push_back(EncodeDrawSortKey(Fields(2, DrawLayer::Opaque, 9, material, 0.5f)));
+
+	DrawKeySorter sorter;
+	std::vector<uint32_t> order;
+	sorter.Sort(keys, order);
+	EXPECT_EQ(order, (std::vector<uint32_t>{ 1, 3, 4, 0, 2 }));
+	EXPECT_EQ(sorter.GetStatistics().passCount, 2u);
+
+	// Identical keys need no pass at all
+	sorter.Sort(std::vector<uint64_t>(10, keys[0]), order);
+	EXPECT_EQ(sorter.GetStatistics().passCount, 0u);
+	EXPECT_EQ(order, (std::vector<uint32_t>{ 0, 1, 2, 3, 4, 5, 6, 7, 8, 9 }));
+}
+
+TEST(DrawSortKey, SortingReducesStateChanges)
+{
+	std::mt19937 random(5);
+	std::vector<uint64_t> keys(10000);
+	for (uint64_t& key : keys)
+		key = EncodeDrawSortKey(Fields(0, DrawLayer::Opaque, random() % 16, random() % 64, static_cast<float>(random() % 1000) / 1000.0f));
+
+	DrawKeySorter sorter;
+	std::vector<uint32_t> order;
+	sorter.Sort(keys, order);
+
+	// Sorted opaque draws change state once per distinct pipeline and material pair
+	const DrawKeySorter::Statistics& statistics = sorter.GetStatistics();
+	EXPECT_EQ(statistics.sortedStateChanges, 16u * 64u - 1u);
+	EXPECT_GT(statistics.submittedStateChanges, 9000u);
+	EXPECT_EQ(statistics.submittedStateChanges, CountDrawStateChanges(keys));
+	EXPECT_EQ(statistics.sortedStateChanges, CountDrawStateChanges(keys, order.data()));
+}
@@ -0,0 +1,240 @@
+#include <gtest/gtest.h>
+
+#include <cmath>
+#include <deque>
+#include <stdexcept>
+#include <vector>
+
+#include <DynamicResolution.h>
+
+using namespace UltReality::Rendering::Common;
+
+namespace
+{
+	/// <summary>
+	/// GPU whose frame time is a fixed cost plus a per-pixel cost, with deterministic noise. Its timings reach the
+	/// controller a few frames late, as the timestamp readback does
+	/// </summary>
+	class SimulatedGpu
+	{
+	private:
+		uint32_t m_seed = 12345;
+		std::deque<float> m_pendingTimes;
+
+	public:
+		// Frames between drawing a frame and its time reaching the controller
+		uint32_t latency = 2;
+		float fixedMilliseconds = 1.0f;
+		// Relative amplitude of the noise on the per-pixel cost
+		float noise = 0.06f;
+
+		// Draws one frame at the controller's scale, feeds it any timing that arrived and returns the frame's time
+		float Frame(DynamicResolutionController& controller, float fullScaleMilliseconds)
+		{
+			m_seed = m_seed * 1664525u + 1013904223u;
+			const float jitter = static_cast<float>(m_seed >> 8) / 16777216.0f - 0.5f;
+
+			const float scale = controller.GetScale();
+			const float milliseconds = fixedMilliseconds + fullScaleMilliseconds * scale * scale * (1.0f + noise * jitter);
+			m_pendingTimes.push_back(milliseconds);
+			if (m_pendingTimes.size() > latency)
+			{
+				controller.Update(m_pendingTimes.front());
+				m_pendingTimes.pop_front();
+			}
+
+			return milliseconds;
+		}
+	};
+
+	DynamicResolutionConfig EnabledConfig()
+	{
+		DynamicResolutionConfig config;
+		config.enabled = true;
+		return config;
+	}
+
+	// Times the controller changes direction, the measure of oscillation
+	uint32_t CountReversals(const std::vector<float>& scales)
+	{
+		uint32_t reversals = 0;
+		float lastDelta = 0.0f;
+		for (size_t i = 1; i < scales.size(); i++)
+		{
+			const float delta = scales[i] - scales[i - 1];
+			if (delta == 0.0f)
+				continue;
+			if (lastDelta != 0.0f && (delta > 0.0f) != (lastDelta > 0.0f))
+				reversals++;
+			lastDelta = delta;
+		}
+
+		return reversals;
+	}
+}
+
+TEST(DynamicResolution, RejectsInvalidConfigs)
+{
+	const auto Rejects = [](void (*change)(DynamicResolutionConfig&)) {
+		DynamicResolutionConfig config;
+		change(config);
+		EXPECT_THROW(DynamicResolutionController{ config }, std::invalid_argument);
+	};
+
+	Rejects([](DynamicResolutionConfig& config) { config.targetFrameMilliseconds = 0.0f; });
+	Rejects([](DynamicResolutionConfig& config) { config.minScale = 0.0f; });
+	Rejects([](DynamicResolutionConfig& config) { config.minScale = 0.8f; config.maxScale = 0.7f; });
+	Rejects([](DynamicResolutionConfig& config) { config.maxScale = 1.5f; });
+	Rejects([](DynamicResolutionConfig& config) { config.integralGain = 0.0f; });
+	Rejects([](DynamicResolutionConfig& config) { config.proportionalGain = -0.1f; });
+	Rejects([](DynamicResolutionConfig& config) { config.deadbandStops = -0.1f; });
+	Rejects([](DynamicResolutionConfig& config) { config.targetFrameMilliseconds = NAN; });
+
+	// A rejected config leaves the old one in place
+	DynamicResolutionController controller;
+	DynamicResolutionConfig config;
+	config.minScale = 0.0f;
+	EXPECT_THROW(controller.SetConfig(config), std::invalid_argument);
+	EXPECT_EQ(controller.GetConfig().minScale, 0.5f);
+}
+
+TEST(DynamicResolution, StartsAtTheMaximumScaleAndIgnoresMissingTimes)
+{
+	DynamicResolutionConfig config = EnabledConfig();
+	config.maxScale = 0.9f;
+	DynamicResolutionController controller(config);
+	EXPECT_EQ(controller.GetScale(), 0.9f);
+
+	EXPECT_EQ(controller.Update(0.0f), 0.9f);
+	EXPECT_EQ(controller.Update(-3.0f), 0.9f);
+	EXPECT_EQ(controller.GetUpdateCount(), 0u);
+
+	controller.Update(40.0f);
+	EXPECT_LT(controller.GetScale(), 0.9f);
+	EXPECT_EQ(controller.GetUpdateCount(), 1u);
+
+	controller.Reset();
+	EXPECT_EQ(controller.GetScale(), 0.9f);
+	EXPECT_EQ(controller.GetUpdateCount(), 0u);
+}
+
+TEST(DynamicResolution, ConvergesOnTheBudgetAndSettles)
+{
+	for (uint32_t latency : { 1u, 2u, 3u, 4u })
+	{
+		DynamicResolutionController controller(EnabledConfig());
+		SimulatedGpu gpu;
+		gpu.latency = latency;
+
+		// 25 ms at full scale needs about 0.75 to fit in 15
+		std::vector<float> scales;
+		float milliseconds = 0.0f;
+		uint32_t settledFrame = UINT32_MAX;
+		for (uint32_t frame = 0; frame < 600; frame++)
+		{
+			milliseconds = gpu.Frame(controller, 25.0f);
+			scales.push_back(controller.GetScale());
+			if (settledFrame == UINT32_MAX && std::abs(milliseconds - 15.0f) < 1.5f)
+				settledFrame = frame;
+		}
+
+		SCOPED_TRACE(testing::Message() << "latency " << latency);
+		EXPECT_LT(settledFrame, 60u);
+		EXPECT_NEAR(milliseconds, 15.0f, 1.5f);
+		EXPECT_NEAR(controller.GetScale(), 0.75f, 0.07f);
+
+		// Once settled, noise within the deadband does not move the viewport
+		const std::vector<float> lastScales(scales.end() - 200, scales.end());
+		EXPECT_EQ(CountReversals(lastScales), 0u);
+	}
+}
+
+TEST(DynamicResolution, StaysAtFullScaleWithHeadroom)
+{
+	DynamicResolutionController controller(EnabledConfig());
+	SimulatedGpu gpu;
+	for (uint32_t frame = 0; frame < 600; frame++)
+	{
+		gpu.Frame(controller, 10.0f);
+		ASSERT_EQ(controller.GetScale(), 1.0f) << "frame " << frame;
+	}
+}
+
+TEST(DynamicResolution, RecoversFromSaturationWithoutWindup)
+{
+	DynamicResolutionController controller(EnabledConfig());
+	SimulatedGpu gpu;
+	gpu.noise = 0.0f;
+
+	// Far over budget even at the minimum scale
+	for (uint32_t frame = 0; frame < 300; frame++)
+		gpu.Frame(controller, 200.0f);
+	EXPECT_EQ(controller.GetScale(), 0.5f);
+
+	// Had the integral kept accumulating, the controller would sit at the minimum long after the load dropped
+	uint32_t recoveredFrame = UINT32_MAX;
+	for (uint32_t frame = 0; frame < 300 && recoveredFrame == UINT32_MAX; frame++)
+	{
+		gpu.Frame(controller, 10.0f);
+		if (controller.GetScale() == 1.0f)
+			recoveredFrame = frame;
+	}
+	EXPECT_LT(recoveredFrame, 60u);
+}
+
+TEST(DynamicResolution, FollowsLoadStepsWithoutOscillating)
+{
+	for (uint32_t latency : { 1u, 2u, 4u })
+	{
+		DynamicResolutionController controller(EnabledConfig());
+		SimulatedGpu gpu;
+		gpu.latency = latency;
+
+		SCOPED_TRACE(testing::Message() << "latency " << latency);
+		for (const float load : { 10.0f, 30.0f, 18.0f })
+		{
+			std::vector<float> scales;
+			float milliseconds = 0.0f;
+			for (uint32_t frame = 0; frame < 300; frame++)
+			{
+				milliseconds = gpu.Frame(controller, load);
+				scales.push_back(controller.GetScale());
+			}
+
+			SCOPED_TRACE(testing::Message() << "load " << load);
+			if (load + gpu.fixedMilliseconds <= 15.0f)
+				EXPECT_EQ(controller.GetScale(), 1.0f);
+			else
+				EXPECT_NEAR(milliseconds, 15.0f, 1.5f);
+
+			const std::vector<float> lastScales(scales.end() - 150, scales.end());
+			EXPECT_LE(CountReversals(lastScales), 2u);
+		}
+	}
+}
+
+TEST(DynamicResolution, SameTimesGiveTheSameScales)
+{
+	DynamicResolutionController first(EnabledConfig());
+	DynamicResolutionController second(EnabledConfig());
+	for (uint32_t frame = 0; frame < 1000; frame++)
+	{
+		const float milliseconds = 5.0f + std::fmod(frame * 7.3f, 30.0f);
+		ASSERT_EQ(first.Update(milliseconds), second.Update(milliseconds)) << "frame " << frame;
+	}
+
+	// Every scale is a whole step within the bounds
+	const float steps = first.GetScale() / first.GetConfig().scaleStep;
+	EXPECT_EQ(steps, std::round(steps));
+	EXPECT_GE(first.GetScale(), first.GetConfig().minScale);
+	EXPECT_LE(first.GetScale(), first.GetConfig().maxScale);
+}
+
+TEST(DynamicResolution, ScalesSizesToWholePixels)
+{
+	EXPECT_EQ(DynamicResolutionController::ScaleSize(1920, 0.75f), 1440u);
+	EXPECT_EQ(DynamicResolutionController::ScaleSize(1080, 0.5f), 540u);
+	EXPECT_EQ(DynamicResolutionController::ScaleSize(1081, 0.5f), 541u);
+	EXPECT_EQ(DynamicResolutionController::ScaleSize(1, 0.5f), 1u);
+	EXPECT_EQ(DynamicResolutionController::ScaleSize(0, 1.0f), 1u);
+}
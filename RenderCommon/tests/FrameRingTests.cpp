@@ -0,0 +1,147 @@
+#include <gtest/gtest.h>
+
+#include <stdexcept>
+
+#include <FrameRing.h>
+#include <SimulatedFenceTimeline.h>
+
+using namespace UltReality::Rendering::Common;
+using UltReality::Rendering::Common::Tests::SimulatedFenceTimeline;
+
+TEST(FrameRing, RejectsInvalidConstruction)
+{
+	SimulatedFenceTimeline timeline;
+
+	EXPECT_THROW(FrameRing(nullptr, 2), std::invalid_argument);
+	EXPECT_THROW(FrameRing(&timeline, 0), std::out_of_range);
+	EXPECT_THROW(FrameRing(&timeline, FrameRing::maxFramesInFlight + 1), std::out_of_range);
+}
+
+TEST(FrameRing, FillingTheRingDoesNotStall)
+{
+	SimulatedFenceTimeline timeline;
+	FrameRing ring(&timeline, 3);
+
+	for (uint32_t frame = 0; frame < 3; frame++)
+	{
+		EXPECT_EQ(ring.BeginFrame(), frame);
+		EXPECT_EQ(ring.EndFrame(), frame + 1);
+		EXPECT_EQ(ring.GetFrameFenceValue(frame), frame + 1);
+	}
+
+	EXPECT_EQ(ring.GetStallCount(), 0u);
+	EXPECT_TRUE(timeline.GetBlockingWaits().empty());
+}
+
+TEST(FrameRing, StallsOnAFullRingUntilTheOldestFrameRetires)
+{
+	SimulatedFenceTimeline timeline;
+	FrameRing ring(&timeline, 2);
+
+	ring.BeginFrame();
+	ring.EndFrame();
+	ring.BeginFrame();
+	ring.EndFrame();
+
+	// The GPU has not finished anything, so reusing slot 0 must wait on the frame that used it, and only on that one
+	EXPECT_EQ(ring.BeginFrame(), 0u);
+	EXPECT_EQ(ring.GetStallCount(), 1u);
+	ASSERT_EQ(timeline.GetBlockingWaits().size(), 1u);
+	EXPECT_EQ(timeline.GetBlockingWaits()[0], 1u);
+	EXPECT_EQ(timeline.GetCompletedValue(), 1u);
+}
+
+TEST(FrameRing, DoesNotStallWhenTheGpuKeepsUp)
+{
+	SimulatedFenceTimeline timeline;
+	FrameRing ring(&timeline, 2);
+
+	for (int frame = 0; frame < 64; frame++)
+	{
+		ring.BeginFrame();
+		const uint64_t fenceValue = ring.EndFrame();
+
+		// The GPU stays one frame behind the CPU
+		if (fenceValue > 1)
+			timeline.Complete(fenceValue - 1);
+	}
+
+	EXPECT_EQ(ring.GetStallCount(), 0u);
+}
+
+TEST(FrameRing, WrapsAroundTheSlots)
+{
+	SimulatedFenceTimeline timeline;
+	FrameRing ring(&timeline, 3);
+
+	for (uint32_t frame = 0; frame < 10; frame++)
+	{
+		EXPECT_EQ(ring.BeginFrame(), frame % 3);
+		const uint64_t fenceValue = ring.EndFrame();
+		EXPECT_EQ(ring.GetFrameFenceValue(frame % 3), fenceValue);
+		EXPECT_EQ(ring.GetFrameIndex(), (frame + 1) % 3);
+		timeline.CompleteAll();
+	}
+
+	EXPECT_EQ(ring.GetStallCount(), 0u);
+}
+
+TEST(FrameRing, StallsOncePerWrapWhenTheGpuFallsBehind)
+{
+	SimulatedFenceTimeline timeline;
+	FrameRing ring(&timeline, 2);
+
+	// Every wait completes the GPU up to the awaited frame only, so every frame after the first two waits once
+	for (int frame = 0; frame < 8; frame++)
+	{
+		ring.BeginFrame();
+		ring.EndFrame();
+	}
+
+	EXPECT_EQ(ring.GetStallCount(), 6u);
+	const std::vector<uint64_t> expectedWaits{ 1, 2, 3, 4, 5, 6 };
+	EXPECT_EQ(timeline.GetBlockingWaits(), expectedWaits);
+}
+
+TEST(FrameRing, WaitForIdleCompletesAllSubmittedWork)
+{
+	SimulatedFenceTimeline timeline;
+	FrameRing ring(&timeline, 3);
+
+	ring.BeginFrame();
+	ring.EndFrame();
+	ring.BeginFrame();
+	ring.EndFrame();
+
+	ring.WaitForIdle();
+
+	EXPECT_EQ(timeline.GetCompletedValue(), timeline.GetSignaledValue());
+	EXPECT_GT(timeline.GetCompletedValue(), 2u);
+
+	// Every slot is retired, so the ring can wrap without stalling
+	for (int frame = 0; frame < 3; frame++)
+	{
+		ring.BeginFrame();
+		ring.EndFrame();
+	}
+	EXPECT_EQ(ring.GetStallCount(), 0u);
+}
+
+TEST(FrameRing, ResizeDrainsAndRestartsAtTheFirstSlot)
+{
+	SimulatedFenceTimeline timeline;
+	FrameRing ring(&timeline, 2);
+
+	ring.BeginFrame();
+	ring.EndFrame();
+
+	ring.Resize(4);
+
+	EXPECT_EQ(ring.GetFramesInFlight(), 4u);
+	EXPECT_EQ(ring.GetFrameIndex(), 0u);
+	EXPECT_EQ(timeline.GetCompletedValue(), timeline.GetSignaledValue());
+	for (uint32_t slot = 0; slot < 4; slot++)
+		EXPECT_EQ(ring.GetFrameFenceValue(slot), 0u);
+
+	EXPECT_THROW(ring.Resize(0), std::out_of_range);
+}
@@ -0,0 +1,189 @@
+#include <gtest/gtest.h>
+
+#include <atomic>
+#include <cmath>
+#include <thread>
+
+#include <FrameTimingStats.h>
+
+using namespace UltReality::Rendering::Common;
+
+namespace
+{
+	// Stands in for the game timer the renderer reads: time only moves when a frame says how long it took, so the
+	// recorded samples are exact
+	class SyntheticFrameTimer
+	{
+	private:
+		double m_now = 0.0;
+		double m_lastPresent = -1.0;
+
+	public:
+		// Simulates a frame that records for cpuMilliseconds, waits fenceWaitMilliseconds on its slot and presents
+		FrameTimingSample Frame(float cpuMilliseconds, float fenceWaitMilliseconds)
+		{
+			m_now += fenceWaitMilliseconds + cpuMilliseconds;
+
+			FrameTimingSample sample;
+			sample.cpuFrameMilliseconds = cpuMilliseconds;
+			sample.fenceWaitMilliseconds = fenceWaitMilliseconds;
+			sample.presentIntervalMilliseconds = m_lastPresent < 0.0 ? 0.0f : static_cast<float>(m_now - m_lastPresent);
+			m_lastPresent = m_now;
+
+			return sample;
+		}
+	};
+}
+
+TEST(FrameTimingStats, EmptyStatsSummarizeToZero)
+{
+	FrameTimingStats stats;
+	const FrameTimingSummary summary = stats.GetSummary();
+
+	EXPECT_EQ(summary.sampleCount, 0u);
+	EXPECT_EQ(summary.frameCount, 0u);
+	EXPECT_EQ(summary.presentInterval.max, 0.0);
+	EXPECT_EQ(summary.framesPerSecond, 0.0);
+}
+
+TEST(FrameTimingStats, ComputesNearestRankPercentiles)
+{
+	FrameTimingStats stats;
+	SyntheticFrameTimer timer;
+
+	// CPU times 1..100 in shuffled order
+	for (uint32_t i = 0; i < 100; i++)
+		stats.Record(timer.Frame(static_cast<float>(1 + (i * 37) % 100), 0.5f));
+
+	const FrameTimingSummary summary = stats.GetSummary();
+	EXPECT_EQ(summary.sampleCount, 100u);
+	EXPECT_DOUBLE_EQ(summary.cpuFrame.mean, 50.5);
+	EXPECT_DOUBLE_EQ(summary.cpuFrame.p50, 50.0);
+	EXPECT_DOUBLE_EQ(summary.cpuFrame.p95, 95.0);
+	EXPECT_DOUBLE_EQ(summary.cpuFrame.p99, 99.0);
+	EXPECT_DOUBLE_EQ(summary.cpuFrame.max, 100.0);
+	EXPECT_DOUBLE_EQ(summary.fenceWait.p99, 0.5);
+}
+
+TEST(FrameTimingStats, KeepsOnlyTheMostRecentFrames)
+{
+	FrameTimingStats stats;
+	SyntheticFrameTimer timer;
+
+	// An old slow stretch falls out of the window
+	for (uint32_t i = 0; i < 100; i++)
+		stats.Record(timer.Frame(40.0f, 0.0f));
+	for (uint32_t i = 0; i < FrameTimingStats::capacity; i++)
+		stats.Record(timer.Frame(10.0f, 0.0f));
+
+	const FrameTimingSummary summary = stats.GetSummary();
+	EXPECT_EQ(summary.sampleCount, FrameTimingStats::capacity);
+	EXPECT_EQ(summary.frameCount, 100u + FrameTimingStats::capacity);
+	EXPECT_DOUBLE_EQ(summary.cpuFrame.max, 10.0);
+
+	std::array<FrameTimingSample, FrameTimingStats::capacity> samples;
+	ASSERT_EQ(stats.CopySamples(samples), FrameTimingStats::capacity);
+	EXPECT_FLOAT_EQ(samples.front().presentIntervalMilliseconds, 10.0f);
+
+	stats.Reset();
+	EXPECT_EQ(stats.GetSummary().sampleCount, 0u);
+	EXPECT_EQ(stats.GetSummary().frameCount, 0u);
+}
+
+TEST(FrameTimingStats, CountsHitchesAgainstTheRunningAverage)
+{
+	FrameTimingStats stats;
+	SyntheticFrameTimer timer;
+
+	// A slow frame during warm-up is not counted, the average is not settled yet
+	EXPECT_FALSE(stats.Record(timer.Frame(16.0f, 0.0f)));
+	EXPECT_FALSE(stats.Record(timer.Frame(60.0f, 0.0f)));
+
+	uint32_t injected = 0;
+	for (uint32_t frame = 2; frame < 600; frame++)
+	{
+		const bool spike = frame % 100 == 50;
+		injected += spike;
+
+		const bool hitch = stats.Record(timer.Frame(spike ? 45.0f : 15.0f, spike ? 0.0f : 1.6667f));
+		EXPECT_EQ(hitch, spike) << "frame " << frame;
+	}
+
+	const FrameTimingSummary summary = stats.GetSummary();
+	EXPECT_EQ(summary.hitchCount, injected);
+	EXPECT_NEAR(summary.presentInterval.p50, 16.6667, 1e-3);
+	EXPECT_NEAR(summary.presentInterval.max, 45.0, 1e-3);
+	EXPECT_NEAR(summary.framesPerSecond, 1000.0 / summary.presentInterval.mean, 1e-9);
+
+	// A frame twice as slow as a very fast average is still no hitch below the floor
+	FrameTimingStats fast;
+	SyntheticFrameTimer fastTimer;
+	for (uint32_t frame = 0; frame < 50; frame++)
+		fast.Record(fastTimer.Frame(2.0f, 0.0f));
+	EXPECT_FALSE(fast.Record(fastTimer.Frame(6.0f, 0.0f)));
+
+	fast.SetHitchThreshold(2.0f, 1.0f);
+	EXPECT_TRUE(fast.Record(fastTimer.Frame(6.0f, 0.0f)));
+}
+
+TEST(FrameTimingStats, PacingDeviationSeparatesEvenFromUnevenFrames)
+{
+	// Both run at 40 fps on average, one alternates short and long presents
+	FrameTimingStats even;
+	FrameTimingStats uneven;
+	SyntheticFrameTimer evenTimer;
+	SyntheticFrameTimer unevenTimer;
+	for (uint32_t frame = 0; frame < 201; frame++)
+	{
+		even.Record(evenTimer.Frame(25.0f, 0.0f));
+		uneven.Record(unevenTimer.Frame(frame % 2 == 0 ? 15.0f : 35.0f, 0.0f));
+	}
+
+	const FrameTimingSummary evenSummary = even.GetSummary();
+	const FrameTimingSummary unevenSummary = uneven.GetSummary();
+
+	EXPECT_NEAR(evenSummary.framesPerSecond, 40.0, 1e-6);
+	EXPECT_NEAR(unevenSummary.framesPerSecond, 40.0, 0.1);
+	EXPECT_NEAR(evenSummary.pacingStandardDeviation, 0.0, 1e-6);
+	EXPECT_NEAR(unevenSummary.pacingStandardDeviation, 10.0, 0.1);
+}
+
+TEST(FrameTimingStats, ReadersNeverSeeTornSamples)
+{
+	FrameTimingStats stats;
+	std::atomic<bool> stop{ false };
+	std::atomic<uint32_t> tornSamples{ 0 };
+	std::atomic<uint32_t> summaries{ 0 };
+
+	// Every recorded sample carries the same value in all fields, a mix of two frames shows up as a mismatch
+	std::thread reader([&]()
+	{
+		std::array<FrameTimingSample, FrameTimingStats::capacity> samples;
+		while (!stop.load() || summaries.load() == 0)
+		{
+			const uint32_t count = stats.CopySamples(samples);
+			for (uint32_t i = 0; i < count; i++)
+			{
+				if (samples[i].cpuFrameMilliseconds != samples[i].fenceWaitMilliseconds
+					|| samples[i].cpuFrameMilliseconds != samples[i].presentIntervalMilliseconds)
+					tornSamples++;
+			}
+
+			if (stats.GetSummary().sampleCount > FrameTimingStats::capacity)
+				tornSamples++;
+			summaries++;
+		}
+	});
+
+	for (uint32_t frame = 0; frame < 500000; frame++)
+	{
+		const float value = static_cast<float>(1 + frame % 1000);
+		stats.Record({ value, value, value });
+	}
+
+	stop = true;
+	reader.join();
+
+	EXPECT_EQ(tornSamples.load(), 0u);
+	EXPECT_GT(summaries.load(), 0u);
+}
@@ -0,0 +1,211 @@
+#include <gtest/gtest.h>
+
+#include <cmath>
+#include <random>
+#include <stdexcept>
+#include <vector>
+
+#include <FrustumCulling.h>
+#include <GpuCulling.h>
+#include <JobSystem.h>
+
+using namespace UltReality::Rendering::Common;
+
+namespace
+{
+	constexpr CullingSimdPath allPaths[] = { CullingSimdPath::Scalar, CullingSimdPath::Sse, CullingSimdPath::Neon, CullingSimdPath::Avx2 };
+
+	// Planes of a left handed perspective camera at the origin looking down +z
+	void PerspectivePlanes(float planes[6][4])
+	{
+		const float yScale = 1.0f / std::tan(0.5f);
+		const float nearZ = 1.0f;
+		const float farZ = 150.0f;
+		const float range = farZ / (farZ - nearZ);
+
+		const float viewProjection[16] = {
+			yScale, 0.0f, 0.0f, 0.0f,
+			0.0f, yScale, 0.0f, 0.0f,
+			0.0f, 0.0f, range, 1.0f,
+			0.0f, 0.0f, -nearZ * range, 0.0f
+		};
+		ExtractFrustumPlanes(viewProjection, planes);
+	}
+
+	// Random volumes around the frustum, so a good share of them straddles a plane
+	void FillVolumes(uint32_t count, uint32_t seed, BoundingSphereSoA& spheres, BoundingBoxSoA& boxes)
+	{
+		std::mt19937 random(seed);
+		std::uniform_real_distribution<float> position(-100.0f, 100.0f);
+
+		for (uint32_t i = 0; i < count; i++)
+		{
+			const float center[3] = { position(random), position(random), position(random) + 100.0f };
+			spheres.Add(center, std::abs(position(random)) / 20.0f);
+
+			const float min[3] = { center[0] - 1.0f, center[1] - 2.0f, center[2] - 0.5f };
+			const float max[3] = { center[0] + 1.0f, center[1] + position(random) / 50.0f + 2.0f, center[2] + 0.5f };
+			boxes.Add(min, max);
+		}
+	}
+
+	std::vector<uint32_t> ReferenceVisibleSpheres(const float planes[6][4], const BoundingSphereSoA& spheres)
+	{
+		std::vector<uint32_t> visible;
+		for (uint32_t i = 0; i < spheres.Size(); i++)
+		{
+			const float center[3] = { spheres.CenterX()[i], spheres.CenterY()[i], spheres.CenterZ()[i] };
+			if (IsSphereInFrustum(planes, center, spheres.Radius()[i]))
+				visible.push_back(i);
+		}
+
+		return visible;
+	}
+}
+
+TEST(FrustumCulling, SoAStoragePadsForTheWidestPath)
+{
+	BoundingSphereSoA spheres;
+	const float center[3] = { 1.0f, 2.0f, 3.0f };
+	for (uint32_t i = 0; i < 9; i++)
+		EXPECT_EQ(spheres.Add(center, static_cast<float>(i)), i);
+	EXPECT_EQ(spheres.Size(), 9u);
+
+	// The widest path loads whole chunks, the culler masks the padding lanes out of the result
+	for (uint32_t i = 9; i < 16; i++)
+		EXPECT_EQ(spheres.Radius()[i], 0.0f) << "lane " << i;
+
+	const float moved[3] = { -4.0f, 5.0f, 6.0f };
+	spheres.Set(3, moved, 0.5f);
+	EXPECT_EQ(spheres.CenterX()[3], -4.0f);
+	EXPECT_EQ(spheres.Radius()[3], 0.5f);
+
+	spheres.Clear();
+	EXPECT_EQ(spheres.Size(), 0u);
+
+	BoundingBoxSoA boxes;
+	const float min[3] = { -1.0f, 0.0f, 2.0f };
+	const float max[3] = { 3.0f, 1.0f, 2.0f };
+	EXPECT_EQ(boxes.Add(min, max), 0u);
+	EXPECT_EQ(boxes.CenterX()[0], 1.0f);
+	EXPECT_EQ(boxes.CenterY()[0], 0.5f);
+	EXPECT_EQ(boxes.CenterZ()[0], 2.0f);
+	EXPECT_EQ(boxes.ExtentX()[0], 2.0f);
+	EXPECT_EQ(boxes.ExtentY()[0], 0.5f);
+	EXPECT_EQ(boxes.ExtentZ()[0], 0.0f);
+}
+
+TEST(FrustumCulling, RejectsPathsTheBuildCannotRun)
+{
+	FrustumCuller culler;
+	EXPECT_TRUE(FrustumCuller::IsSimdPathSupported(CullingSimdPath::Scalar));
+	EXPECT_TRUE(FrustumCuller::IsSimdPathSupported(culler.GetSimdPath()));
+	EXPECT_EQ(culler.GetSimdPath(), FrustumCuller::DetectSimdPath());
+
+	// SSE and NEON never both exist in one build
+	EXPECT_FALSE(FrustumCuller::IsSimdPathSupported(CullingSimdPath::Sse) && FrustumCuller::IsSimdPathSupported(CullingSimdPath::Neon));
+
+	for (CullingSimdPath path : allPaths)
+	{
+		if (FrustumCuller::IsSimdPathSupported(path))
+		{
+			culler.SetSimdPath(path);
+			EXPECT_EQ(culler.GetSimdPath(), path);
+		}
+		else
+		{
+			EXPECT_THROW(culler.SetSimdPath(path), std::invalid_argument);
+		}
+	}
+}
+
+TEST(FrustumCulling, VolumesTouchingAPlaneAreVisibleOnEveryPath)
+{
+	// Axis aligned planes at whole offsets make the distances exact, so every path sees the same touching case
+	float planes[6][4] = {
+		{ 1.0f, 0.0f, 0.0f, 0.0f }, { -1.0f, 0.0f, 0.0f, 10.0f },
+		{ 0.0f, 1.0f, 0.0f, 10.0f }, { 0.0f, -1.0f, 0.0f, 10.0f },
+		{ 0.0f, 0.0f, 1.0f, 10.0f }, { 0.0f, 0.0f, -1.0f, 10.0f }
+	};
+
+	BoundingSphereSoA spheres;
+	BoundingBoxSoA boxes;
+	for (float x : { -2.0f, -2.0f, -2.5f, 5.0f, 12.0f })
+	{
+		const float center[3] = { x, 0.0f, 0.0f };
+		spheres.Add(center, 2.0f);
+
+		const float min[3] = { x - 2.0f, -1.0f, -1.0f };
+		const float max[3] = { x + 2.0f, 1.0f, 1.0f };
+		boxes.Add(min, max);
+	}
+
+	const std::vector<uint32_t> expected = { 0, 1, 3, 4 };
+	FrustumCuller culler;
+	for (CullingSimdPath path : allPaths)
+	{
+		if (!FrustumCuller::IsSimdPathSupported(path))
+			continue;
+
+		culler.SetSimdPath(path);
+		std::vector<uint32_t> visible;
+		culler.CullSpheres(planes, spheres, visible);
+		EXPECT_EQ(visible, expected) << "spheres, path " << static_cast<uint32_t>(path);
+		culler.CullBoxes(planes, boxes, visible);
+		EXPECT_EQ(visible, expected) << "boxes, path " << static_cast<uint32_t>(path);
+	}
+}
+
+TEST(FrustumCulling, SimdPathsMatchTheScalarPath)
+{
+	float planes[6][4];
+	PerspectivePlanes(planes);
+	JobSystem jobSystem(4);
+
+	// Counts around the 4 and 8 lane widths and the chunk size, culled on one thread and in parallel chunks
+	for (uint32_t count : { 0u, 1u, 3u, 7u, 9u, 100u, 4095u, 4097u, 50000u })
+	{
+		BoundingSphereSoA spheres;
+		BoundingBoxSoA boxes;
+		FillVolumes(count, count + 1, spheres, boxes);
+
+		const std::vector<uint32_t> expectedSpheres = ReferenceVisibleSpheres(planes, spheres);
+		std::vector<uint32_t> expectedBoxes;
+		FrustumCuller scalar;
+		scalar.SetSimdPath(CullingSimdPath::Scalar);
+		scalar.CullBoxes(planes, boxes, expectedBoxes);
+
+		for (JobSystem* jobs : { static_cast<JobSystem*>(nullptr), &jobSystem })
+		{
+			FrustumCuller culler(jobs, 4096);
+			for (CullingSimdPath path : allPaths)
+			{
+				if (!FrustumCuller::IsSimdPathSupported(path))
+					continue;
+
+				culler.SetSimdPath(path);
+				std::vector<uint32_t> visible = { 12345 };
+
+				culler.CullSpheres(planes, spheres, visible);
+				ASSERT_EQ(visible, expectedSpheres) << count << " spheres, path " << static_cast<uint32_t>(path) << (jobs ? ", parallel" : "");
+				EXPECT_EQ(culler.GetStatistics().testedCount, count);
+				EXPECT_EQ(culler.GetStatistics().visibleCount, expectedSpheres.size());
+
+				culler.CullBoxes(planes, boxes, visible);
+				ASSERT_EQ(visible, expectedBoxes) << count << " boxes, path " << static_cast<uint32_t>(path) << (jobs ? ", parallel" : "");
+			}
+
+			if (jobs != nullptr && count > 0)
+			{
+				EXPECT_EQ(culler.GetStatistics().chunkCount, (count + 4095) / 4096);
+			}
+		}
+
+		// The sets straddle the frustum, so both outcomes are exercised
+		if (count >= 100)
+		{
+			EXPECT_GT(expectedSpheres.size(), 0u);
+			EXPECT_LT(expectedSpheres.size(), count);
+		}
+	}
+}
@@ -0,0 +1,283 @@
+#include <gtest/gtest.h>
+
+#include <cmath>
+#include <cstring>
+#include <random>
+#include <stdexcept>
+#include <vector>
+
+#include <GpuCulling.h>
+
+using namespace UltReality::Rendering::Common;
+
+namespace
+{
+	// Left handed perspective projection in row-vector form with a [0, 1] depth range, the camera at the origin looking down +z
+	void PerspectiveMatrix(float verticalFov, float aspect, float nearZ, float farZ, float matrix[16])
+	{
+		const float yScale = 1.0f / std::tan(verticalFov * 0.5f);
+		const float range = farZ / (farZ - nearZ);
+
+		const float values[16] = {
+			yScale / aspect, 0.0f, 0.0f, 0.0f,
+			0.0f, yScale, 0.0f, 0.0f,
+			0.0f, 0.0f, range, 1.0f,
+			0.0f, 0.0f, -nearZ * range, 0.0f
+		};
+		std::memcpy(matrix, values, sizeof(values));
+	}
+
+	struct SimulatedCullOutput
+	{
+		std::vector<IndirectDrawCommand> commands;
+		uint32_t drawCount = 0;
+	};
+
+	// Runs the culling and compaction shaders of D3D12GpuCuller thread group by thread group, every loop over the
+	// threads of a group standing for the work between two group barriers
+	SimulatedCullOutput SimulateCullDispatch(const GpuCullConstants& constants, const std::vector<GpuInstance>& instances, const std::vector<GpuMesh>& meshes)
+	{
+		std::vector<uint32_t> localOffsets(constants.instanceCount);
+		std::vector<uint32_t> groupCounts(constants.groupCount);
+		uint32_t sums[gpuCullGroupSize];
+		uint32_t totals[gpuCullGroupSize];
+
+		// CullInstances
+		for (uint32_t group = 0; group < constants.groupCount; group++)
+		{
+			uint32_t visible[gpuCullGroupSize];
+			for (uint32_t thread = 0; thread < gpuCullGroupSize; thread++)
+			{
+				const uint32_t index = group * gpuCullGroupSize + thread;
+				visible[thread] = index < constants.instanceCount && instances[index].meshIndex < constants.meshCount &&
+					IsSphereInFrustum(constants.frustumPlanes, instances[index].boundsCenter, instances[index].boundsRadius) ? 1 : 0;
+				sums[thread] = visible[thread];
+			}
+
+			for (uint32_t offset = 1; offset < gpuCullGroupSize; offset <<= 1)
+			{
+				uint32_t values[gpuCullGroupSize];
+				for (uint32_t thread = 0; thread < gpuCullGroupSize; thread++)
+					values[thread] = thread >= offset ? sums[thread - offset] : 0;
+				for (uint32_t thread = 0; thread < gpuCullGroupSize; thread++)
+					sums[thread] += values[thread];
+			}
+
+			for (uint32_t thread = 0; thread < gpuCullGroupSize; thread++)
+			{
+				const uint32_t index = group * gpuCullGroupSize + thread;
+				if (index < constants.instanceCount)
+					localOffsets[index] = visible[thread] != 0 ? sums[thread] - 1 : gpuCulledOffset;
+			}
+
+			groupCounts[group] = sums[gpuCullGroupSize - 1];
+		}
+
+		// CompactInstances, the command buffer holding room for every instance
+		SimulatedCullOutput output;
+		output.commands.resize(constants.instanceCount);
+		for (uint32_t group = 0; group < constants.groupCount; group++)
+		{
+			for (uint32_t thread = 0; thread < gpuCullGroupSize; thread++)
+			{
+				sums[thread] = 0;
+				totals[thread] = 0;
+				for (uint32_t counted = thread; counted < constants.groupCount; counted += gpuCullGroupSize)
+				{
+					totals[thread] += groupCounts[counted];
+					if (counted < group)
+						sums[thread] += groupCounts[counted];
+				}
+			}
+
+			for (uint32_t stride = gpuCullGroupSize / 2; stride > 0; stride >>= 1)
+			{
+				for (uint32_t thread = 0; thread < stride; thread++)
+				{
+					sums[thread] += sums[thread + stride];
+					totals[thread] += totals[thread + stride];
+				}
+			}
+
+			if (group == 0)
+				output.drawCount = totals[0];
+
+			for (uint32_t thread = 0; thread < gpuCullGroupSize; thread++)
+			{
+				const uint32_t index = group * gpuCullGroupSize + thread;
+				if (index >= constants.instanceCount || localOffsets[index] == gpuCulledOffset)
+					continue;
+
+				const GpuMesh& mesh = meshes[instances[index].meshIndex];
+
+				IndirectDrawCommand command;
+				command.instanceIndex = index;
+				command.indexCountPerInstance = mesh.indexCount;
+				command.instanceCount = 1;
+				command.startIndexLocation = mesh.startIndex;
+				command.baseVertexLocation = mesh.baseVertex;
+				command.startInstanceLocation = 0;
+				output.commands[sums[0] + localOffsets[index]] = command;
+			}
+		}
+
+		output.commands.resize(output.drawCount);
+		return output;
+	}
+
+	GpuInstance Instance(float x, float y, float z, float radius, uint32_t meshIndex)
+	{
+		GpuInstance instance;
+		instance.boundsCenter[0] = x;
+		instance.boundsCenter[1] = y;
+		instance.boundsCenter[2] = z;
+		instance.boundsRadius = radius;
+		instance.meshIndex = meshIndex;
+
+		return instance;
+	}
+}
+
+TEST(GpuCulling, ExtractsNormalizedFrustumPlanes)
+{
+	float viewProjection[16];
+	PerspectiveMatrix(1.5707964f, 1.0f, 1.0f, 100.0f, viewProjection);
+
+	GpuCullConstants constants;
+	ExtractFrustumPlanes(viewProjection, constants.frustumPlanes);
+
+	for (const float* plane : constants.frustumPlanes)
+		EXPECT_NEAR(plane[0] * plane[0] + plane[1] * plane[1] + plane[2] * plane[2], 1.0f, 1e-5f);
+
+	// A 90 degree field of view puts the side planes at 45 degrees
+	const float diagonal = std::sqrt(0.5f);
+	EXPECT_NEAR(constants.frustumPlanes[0][0], diagonal, 1e-5f);
+	EXPECT_NEAR(constants.frustumPlanes[0][2], diagonal, 1e-5f);
+	EXPECT_NEAR(constants.frustumPlanes[1][0], -diagonal, 1e-5f);
+	EXPECT_NEAR(constants.frustumPlanes[3][1], -diagonal, 1e-5f);
+
+	// Near at z = 1 and far at z = 100
+	EXPECT_NEAR(constants.frustumPlanes[4][2], 1.0f, 1e-5f);
+	EXPECT_NEAR(constants.frustumPlanes[4][3], -1.0f, 1e-4f);
+	EXPECT_NEAR(constants.frustumPlanes[5][2], -1.0f, 1e-5f);
+	EXPECT_NEAR(constants.frustumPlanes[5][3], 100.0f, 1e-3f);
+}
+
+TEST(GpuCulling, SpheresTouchingThePlanesAreVisible)
+{
+	float viewProjection[16];
+	PerspectiveMatrix(1.5707964f, 1.0f, 1.0f, 100.0f, viewProjection);
+	float planes[6][4];
+	ExtractFrustumPlanes(viewProjection, planes);
+
+	const float ahead[3] = { 0.0f, 0.0f, 50.0f };
+	const float behind[3] = { 0.0f, 0.0f, -2.0f };
+	const float beyondFar[3] = { 0.0f, 0.0f, 102.0f };
+	const float left[3] = { -60.0f, 0.0f, 50.0f };
+
+	EXPECT_TRUE(IsSphereInFrustum(planes, ahead, 0.0f));
+	EXPECT_FALSE(IsSphereInFrustum(planes, behind, 2.5f));
+	EXPECT_TRUE(IsSphereInFrustum(planes, behind, 3.5f));
+	EXPECT_FALSE(IsSphereInFrustum(planes, beyondFar, 1.5f));
+	EXPECT_TRUE(IsSphereInFrustum(planes, beyondFar, 2.5f));
+	// 10 units left of the plane, which is sqrt(50) away along its normal
+	EXPECT_FALSE(IsSphereInFrustum(planes, left, 7.0f));
+	EXPECT_TRUE(IsSphereInFrustum(planes, left, 7.1f));
+}
+
+TEST(GpuCulling, ReferenceCompactsVisibleInstancesInOrder)
+{
+	float viewProjection[16];
+	PerspectiveMatrix(1.5707964f, 1.0f, 1.0f, 100.0f, viewProjection);
+
+	const std::vector<GpuMesh> meshes = { GpuMesh{ 36, 0, 0 }, GpuMesh{ 600, 36, -12 } };
+	const std::vector<GpuInstance> instances = {
+		Instance(0.0f, 0.0f, 10.0f, 1.0f, 1),
+		Instance(0.0f, 0.0f, -10.0f, 1.0f, 0), // Behind the camera
+		Instance(5.0f, 0.0f, 20.0f, 1.0f, 0),
+		Instance(0.0f, 0.0f, 30.0f, 1.0f, 7),  // Mesh outside the table
+		Instance(0.0f, 0.0f, 40.0f, 1.0f, 1)
+	};
+
+	GpuCullConstants constants;
+	ExtractFrustumPlanes(viewProjection, constants.frustumPlanes);
+	constants.instanceCount = static_cast<uint32_t>(instances.size());
+	constants.meshCount = static_cast<uint32_t>(meshes.size());
+	constants.groupCount = GpuCullGroupCount(constants.instanceCount);
+
+	const std::vector<IndirectDrawCommand> commands = CullAndCompactReference(constants, instances, meshes);
+	ASSERT_EQ(commands.size(), 3u);
+	EXPECT_EQ(commands[0].instanceIndex, 0u);
+	EXPECT_EQ(commands[1].instanceIndex, 2u);
+	EXPECT_EQ(commands[2].instanceIndex, 4u);
+
+	EXPECT_EQ(commands[0].indexCountPerInstance, 600u);
+	EXPECT_EQ(commands[0].startIndexLocation, 36u);
+	EXPECT_EQ(commands[0].baseVertexLocation, -12);
+	EXPECT_EQ(commands[0].instanceCount, 1u);
+	EXPECT_EQ(commands[1].indexCountPerInstance, 36u);
+
+	// Constants reaching past the buffers are an error rather than a read out of bounds
+	GpuCullConstants tooMany = constants;
+	tooMany.instanceCount++;
+	EXPECT_THROW(CullAndCompactReference(tooMany, instances, meshes), std::invalid_argument);
+	tooMany = constants;
+	tooMany.meshCount++;
+	EXPECT_THROW(CullAndCompactReference(tooMany, instances, meshes), std::invalid_argument);
+}
+
+TEST(GpuCulling, CountsGroupsOfTheCullingDispatch)
+{
+	EXPECT_EQ(GpuCullGroupCount(0), 0u);
+	EXPECT_EQ(GpuCullGroupCount(1), 1u);
+	EXPECT_EQ(GpuCullGroupCount(gpuCullGroupSize), 1u);
+	EXPECT_EQ(GpuCullGroupCount(gpuCullGroupSize + 1), 2u);
+	EXPECT_EQ(GpuCullGroupCount(1000000), 3907u);
+}
+
+TEST(GpuCulling, ShaderCompactionMatchesTheReferenceBitForBit)
+{
+	std::mt19937 random(3);
+	std::uniform_real_distribution<float> position(-50.0f, 50.0f);
+
+	float viewProjection[16];
+	PerspectiveMatrix(1.0f, 16.0f / 9.0f, 1.0f, 80.0f, viewProjection);
+
+	// Counts around group boundaries and enough groups that the strided group count sums take several rounds
+	for (uint32_t instanceCount : { 0u, 1u, 255u, 256u, 257u, 4999u, 70000u })
+	{
+		const uint32_t meshCount = 1 + random() % 20;
+		std::vector<GpuMesh> meshes(meshCount);
+		for (GpuMesh& mesh : meshes)
+		{
+			mesh.indexCount = random() % 1000;
+			mesh.startIndex = random() % 10000;
+			mesh.baseVertex = static_cast<int32_t>(random() % 100) - 50;
+		}
+
+		std::vector<GpuInstance> instances(instanceCount);
+		for (GpuInstance& instance : instances)
+		{
+			// Some instances reference meshes past the table
+			instance = Instance(position(random), position(random), position(random) + 50.0f, std::abs(position(random)) / 10.0f, random() % (meshCount + 2));
+			instance.userData = random();
+		}
+
+		GpuCullConstants constants;
+		ExtractFrustumPlanes(viewProjection, constants.frustumPlanes);
+		constants.instanceCount = instanceCount;
+		constants.meshCount = meshCount;
+		constants.groupCount = GpuCullGroupCount(instanceCount);
+
+		const std::vector<IndirectDrawCommand> reference = CullAndCompactReference(constants, instances, meshes);
+		const SimulatedCullOutput simulated = SimulateCullDispatch(constants, instances, meshes);
+
+		ASSERT_EQ(simulated.drawCount, reference.size()) << instanceCount << " instances";
+		EXPECT_EQ(std::memcmp(simulated.commands.data(), reference.data(), reference.size() * sizeof(IndirectDrawCommand)), 0) << instanceCount << " instances";
+		if (instanceCount > 1000)
+		{
+			EXPECT_GT(reference.size(), 0u);
+			EXPECT_LT(reference.size(), instanceCount);
+		}
+	}
+}
@@ -0,0 +1,239 @@
+#include <gtest/gtest.h>
+
+#include <thread>
+#include <vector>
+
+#include <GpuProfiler.h>
+
+using namespace UltReality::Rendering::Common;
+
+namespace
+{
+	// 1000 ticks per millisecond keeps the expected values readable
+	constexpr uint64_t ticksPerSecond = 1000000;
+
+	// Query heap the simulated GPU writes timestamps into, laid out the way the profiler hands out query indices
+	class SimulatedTimestamps
+	{
+	private:
+		GpuProfiler& m_profiler;
+		std::vector<uint64_t> m_queries;
+
+	public:
+		explicit SimulatedTimestamps(GpuProfiler& profiler)
+			: m_profiler(profiler), m_queries(profiler.GetQueryCount(), 0)
+		{
+		}
+
+		uint32_t Scope(const char* name, uint64_t begin, uint64_t end, uint32_t parent = GpuProfiler::invalidScope)
+		{
+			const uint32_t scope = m_profiler.BeginScope(name, parent);
+			if (scope == GpuProfiler::invalidScope)
+				return scope;
+
+			m_queries[m_profiler.GetBeginQuery(scope)] = begin;
+			m_queries[m_profiler.GetEndQuery(scope)] = end;
+			m_profiler.EndScope(scope);
+
+			return scope;
+		}
+
+		uint32_t Open(const char* name, uint64_t begin, uint32_t parent = GpuProfiler::invalidScope)
+		{
+			const uint32_t scope = m_profiler.BeginScope(name, parent);
+			m_queries[m_profiler.GetBeginQuery(scope)] = begin;
+
+			return scope;
+		}
+
+		void Close(uint32_t scope, uint64_t end)
+		{
+			m_queries[m_profiler.GetEndQuery(scope)] = end;
+			m_profiler.EndScope(scope);
+		}
+
+		// Reads back every frame whose fence completed, oldest first
+		std::vector<uint64_t> ReadCompleted(uint64_t completedFenceValue, uint32_t maxScopesPerFrame)
+		{
+			std::vector<uint64_t> frames;
+			uint32_t slot;
+			while (m_profiler.NextCompletedFrame(completedFenceValue, slot))
+			{
+				m_profiler.ReadFrame(slot, m_queries.data() + static_cast<size_t>(slot) * maxScopesPerFrame * 2);
+				frames.push_back(m_profiler.GetLatestProfile().frameNumber);
+			}
+
+			return frames;
+		}
+	};
+}
+
+TEST(GpuProfiler, AggregatesNestedAndRepeatedScopes)
+{
+	constexpr uint32_t maxScopes = 16;
+	GpuProfiler profiler(maxScopes);
+	profiler.SetTimestampFrequency(ticksPerSecond);
+	SimulatedTimestamps timestamps(profiler);
+
+	ASSERT_TRUE(profiler.BeginFrame());
+	const uint32_t frame = timestamps.Open("Frame", 10000);
+	timestamps.Scope("Shadows", 10000, 11000, frame);
+	const uint32_t scene = timestamps.Open("Scene", 11000, frame);
+	for (uint64_t chunk = 0; chunk < 3; chunk++)
+		timestamps.Scope("Draws", 11200 + chunk * 1000, 11700 + chunk * 1000, scene);
+	timestamps.Close(scene, 15000);
+	timestamps.Close(frame, 16000);
+	profiler.EndFrame(1);
+
+	ASSERT_EQ(timestamps.ReadCompleted(1, maxScopes), std::vector<uint64_t>{ 1 });
+
+	const GpuFrameProfile& profile = profiler.GetLatestProfile();
+	EXPECT_DOUBLE_EQ(profile.frameMilliseconds, 6.0);
+	ASSERT_EQ(profile.scopes.size(), 4u);
+
+	EXPECT_EQ(profile.scopes[0].name, "Frame");
+	EXPECT_EQ(profile.scopes[0].parent, GpuProfiler::invalidScope);
+	EXPECT_DOUBLE_EQ(profile.scopes[0].milliseconds, 6.0);
+	EXPECT_DOUBLE_EQ(profile.scopes[0].exclusiveMilliseconds, 1.0);
+
+	EXPECT_EQ(profile.scopes[1].name, "Shadows");
+	EXPECT_EQ(profile.scopes[1].parent, 0u);
+	EXPECT_EQ(profile.scopes[1].depth, 1u);
+
+	EXPECT_EQ(profile.scopes[2].name, "Scene");
+	EXPECT_DOUBLE_EQ(profile.scopes[2].milliseconds, 4.0);
+	EXPECT_DOUBLE_EQ(profile.scopes[2].exclusiveMilliseconds, 2.5);
+
+	EXPECT_EQ(profile.scopes[3].name, "Draws");
+	EXPECT_EQ(profile.scopes[3].parent, 2u);
+	EXPECT_EQ(profile.scopes[3].depth, 2u);
+	EXPECT_EQ(profile.scopes[3].count, 3u);
+	EXPECT_DOUBLE_EQ(profile.scopes[3].milliseconds, 1.5);
+
+	EXPECT_DOUBLE_EQ(profile.GetMilliseconds("Draws"), 1.5);
+	EXPECT_DOUBLE_EQ(profile.GetMilliseconds("Missing"), 0.0);
+}
+
+TEST(GpuProfiler, DropsOpenScopesAndBadTimestamps)
+{
+	constexpr uint32_t maxScopes = 4;
+	GpuProfiler profiler(maxScopes);
+	profiler.SetTimestampFrequency(ticksPerSecond);
+	SimulatedTimestamps timestamps(profiler);
+
+	ASSERT_TRUE(profiler.BeginFrame());
+	// A scope left open takes its children with it
+	const uint32_t open = timestamps.Open("Open", 1000);
+	timestamps.Scope("Child", 1100, 1200, open);
+	// Timestamps from a reset counter count as no time
+	timestamps.Scope("Reversed", 5000, 4000);
+	timestamps.Scope("Valid", 2000, 3000);
+	// Past the scope budget
+	EXPECT_EQ(profiler.BeginScope("Overflow"), GpuProfiler::invalidScope);
+	EXPECT_EQ(profiler.GetScopeCount(), maxScopes);
+	profiler.EndFrame(1);
+
+	timestamps.ReadCompleted(1, maxScopes);
+
+	const GpuFrameProfile& profile = profiler.GetLatestProfile();
+	ASSERT_EQ(profile.scopes.size(), 2u);
+	EXPECT_EQ(profile.scopes[0].name, "Reversed");
+	EXPECT_DOUBLE_EQ(profile.scopes[0].milliseconds, 0.0);
+	EXPECT_EQ(profile.scopes[1].name, "Valid");
+	EXPECT_DOUBLE_EQ(profile.frameMilliseconds, 1.0);
+}
+
+TEST(GpuProfiler, ReadsFramesBackOnlyAfterTheirFence)
+{
+	constexpr uint32_t maxScopes = 2;
+	GpuProfiler profiler(maxScopes);
+	profiler.SetTimestampFrequency(ticksPerSecond);
+	SimulatedTimestamps timestamps(profiler);
+
+	// Each frame's single scope lasts as many milliseconds as its frame number, so a reused slot shows up
+	uint64_t fence = 0;
+	auto recordFrame = [&]()
+	{
+		if (!profiler.BeginFrame())
+			return false;
+
+		const uint64_t frameNumber = fence + 1;
+		timestamps.Scope("Frame", 0, frameNumber * 1000);
+		profiler.EndFrame(++fence);
+
+		return true;
+	};
+
+	for (uint32_t frame = 0; frame < GpuProfiler::frameSlotCount; frame++)
+		ASSERT_TRUE(recordFrame());
+
+	// Nothing completed yet, so every further frame finds its slot in flight and is skipped
+	uint32_t slot;
+	EXPECT_FALSE(profiler.NextCompletedFrame(0, slot));
+	EXPECT_FALSE(recordFrame());
+	EXPECT_FALSE(recordFrame());
+	EXPECT_EQ(profiler.GetSkippedFrameCount(), 2u);
+	EXPECT_EQ(profiler.BeginScope("Skipped"), GpuProfiler::invalidScope);
+
+	// Completed frames come back oldest first and are never overwritten before that
+	EXPECT_EQ(timestamps.ReadCompleted(2, maxScopes), (std::vector<uint64_t>{ 1, 2 }));
+	EXPECT_DOUBLE_EQ(profiler.GetLatestProfile().scopes[0].milliseconds, 2.0);
+
+	const uint64_t lastFence = fence;
+	EXPECT_EQ(timestamps.ReadCompleted(lastFence, maxScopes).size(), GpuProfiler::frameSlotCount - 2);
+	EXPECT_DOUBLE_EQ(profiler.GetLatestProfile().scopes[0].milliseconds, static_cast<double>(lastFence));
+
+	// With the GPU caught up the profiler records again
+	EXPECT_TRUE(recordFrame());
+	EXPECT_EQ(profiler.GetSkippedFrameCount(), 2u);
+}
+
+TEST(GpuProfiler, MergesScopesOpenedFromSeveralThreads)
+{
+	constexpr uint32_t threadCount = 4;
+	constexpr uint32_t scopesPerThread = 25;
+	constexpr uint32_t maxScopes = 1 + threadCount * scopesPerThread;
+
+	GpuProfiler profiler(maxScopes);
+	profiler.SetTimestampFrequency(ticksPerSecond);
+	std::vector<uint64_t> queries(profiler.GetQueryCount(), 0);
+
+	ASSERT_TRUE(profiler.BeginFrame());
+	const uint32_t frame = profiler.BeginScope("Frame");
+
+	// Recording jobs each open scopes of the same name under the frame scope, 1 ms each
+	std::vector<std::thread> threads;
+	for (uint32_t thread = 0; thread < threadCount; thread++)
+	{
+		threads.emplace_back([&, thread]()
+		{
+			for (uint32_t i = 0; i < scopesPerThread; i++)
+			{
+				const uint32_t scope = profiler.BeginScope("Chunk", frame);
+				ASSERT_NE(scope, GpuProfiler::invalidScope);
+
+				const uint64_t begin = (thread * scopesPerThread + i) * 1000;
+				queries[profiler.GetBeginQuery(scope)] = begin;
+				queries[profiler.GetEndQuery(scope)] = begin + 1000;
+				profiler.EndScope(scope);
+			}
+		});
+	}
+	for (std::thread& thread : threads)
+		thread.join();
+
+	queries[profiler.GetBeginQuery(frame)] = 0;
+	queries[profiler.GetEndQuery(frame)] = threadCount * scopesPerThread * 1000;
+	profiler.EndScope(frame);
+	profiler.EndFrame(1);
+
+	uint32_t slot;
+	ASSERT_TRUE(profiler.NextCompletedFrame(1, slot));
+	profiler.ReadFrame(slot, queries.data() + profiler.GetFrameQueryOffset());
+
+	const GpuFrameProfile& profile = profiler.GetLatestProfile();
+	ASSERT_EQ(profile.scopes.size(), 2u);
+	EXPECT_EQ(profile.scopes[1].count, threadCount * scopesPerThread);
+	EXPECT_DOUBLE_EQ(profile.scopes[1].milliseconds, threadCount * scopesPerThread * 1.0);
+	EXPECT_DOUBLE_EQ(profile.scopes[0].exclusiveMilliseconds, 0.0);
+}
@@ -0,0 +1,185 @@
+#include <gtest/gtest.h>
+
+#include <algorithm>
+#include <random>
+#include <set>
+#include <stdexcept>
+#include <utility>
+#include <vector>
+
+#include <InstanceBatcher.h>
+
+using namespace UltReality::Rendering::Common;
+
+namespace
+{
+	struct DrawList
+	{
+		std::vector<uint64_t> sortKeys;
+		std::vector<uint64_t> batchKeys;
+
+		void Add(uint32_t pass, DrawLayer layer, uint32_t pipeline, uint32_t material, float depth, uint64_t batchKey)
+		{
+			DrawSortKeyFields fields;
+			fields.pass = pass;
+			fields.layer = layer;
+			fields.pipeline = pipeline;
+			fields.material = material;
+			fields.depth = depth;
+
+			sortKeys.push_back(EncodeDrawSortKey(fields));
+			batchKeys.push_back(batchKey);
+		}
+	};
+
+	bool IsBackToFront(uint64_t sortKey)
+	{
+		const DrawLayer layer = DecodeDrawSortKey(sortKey).layer;
+		return layer == DrawLayer::Transparent || layer == DrawLayer::Overlay;
+	}
+}
+
+TEST(InstanceBatcher, RejectsMismatchedKeyArrays)
+{
+	InstanceBatcher batcher;
+	std::vector<InstanceBatch> batches;
+	std::vector<uint32_t> instanceOrder;
+	EXPECT_THROW(batcher.Build({ 1, 2 }, { 1 }, batches, instanceOrder), std::invalid_argument);
+
+	batcher.Build({}, {}, batches, instanceOrder);
+	EXPECT_TRUE(batches.empty());
+	EXPECT_TRUE(instanceOrder.empty());
+}
+
+TEST(InstanceBatcher, MergesOpaqueDrawsButKeepsBlendingOrder)
+{
+	DrawList draws;
+	draws.Add(0, DrawLayer::Opaque, 1, 0, 0.1f, 10);
+	draws.Add(0, DrawLayer::Opaque, 1, 0, 0.2f, 11);
+	draws.Add(0, DrawLayer::Opaque, 1, 0, 0.3f, 10);
+	draws.Add(0, DrawLayer::Transparent, 2, 0, 0.9f, 20);
+	draws.Add(0, DrawLayer::Transparent, 2, 0, 0.8f, 21);
+	draws.Add(0, DrawLayer::Transparent, 2, 0, 0.7f, 20);
+	draws.Add(0, DrawLayer::Transparent, 2, 0, 0.6f, 20);
+
+	InstanceBatcher batcher;
+	std::vector<InstanceBatch> batches;
+	std::vector<uint32_t> instanceOrder;
+	batcher.Build(draws.sortKeys, draws.batchKeys, batches, instanceOrder);
+
+	// Opaque A B A becomes two batches, transparent A B A A three since B sits between the A's
+	ASSERT_EQ(batches.size(), 5u);
+	EXPECT_EQ(instanceOrder, (std::vector<uint32_t>{ 0, 2, 1, 3, 4, 5, 6 }));
+	EXPECT_EQ(batches[0].firstInstance, 0u);
+	EXPECT_EQ(batches[0].instanceCount, 2u);
+	EXPECT_EQ(batches[1].instanceCount, 1u);
+	EXPECT_EQ(batches[4].firstInstance, 5u);
+	EXPECT_EQ(batches[4].instanceCount, 2u);
+
+	EXPECT_EQ(batcher.GetStatistics().drawCount, 7u);
+	EXPECT_EQ(batcher.GetStatistics().batchCount, 5u);
+}
+
+TEST(InstanceBatcher, BatchesNeverSpanPassesOrLayers)
+{
+	// Same batch key everywhere, only the pass and layer split the draws
+	DrawList draws;
+	draws.Add(1, DrawLayer::Opaque, 0, 0, 0.5f, 7);
+	draws.Add(0, DrawLayer::Opaque, 0, 0, 0.5f, 7);
+	draws.Add(0, DrawLayer::AlphaTested, 0, 0, 0.5f, 7);
+	draws.Add(0, DrawLayer::Opaque, 0, 0, 0.2f, 7);
+	draws.Add(1, DrawLayer::Opaque, 0, 0, 0.1f, 7);
+
+	InstanceBatcher batcher;
+	std::vector<InstanceBatch> batches;
+	std::vector<uint32_t> instanceOrder;
+	batcher.Build(draws.sortKeys, draws.batchKeys, batches, instanceOrder);
+
+	ASSERT_EQ(batches.size(), 3u);
+	EXPECT_EQ(instanceOrder, (std::vector<uint32_t>{ 3, 1, 2, 4, 0 }));
+	EXPECT_EQ(batches[0].instanceCount, 2u);
+	EXPECT_EQ(batches[1].instanceCount, 1u);
+	EXPECT_EQ(batches[2].instanceCount, 2u);
+}
+
+TEST(InstanceBatcher, RandomScenesGroupEveryDrawExactlyOnce)
+{
+	std::mt19937 random(5);
+	std::uniform_real_distribution<float> depth(0.0f, 1.0f);
+
+	for (int scene = 0; scene < 20; scene++)
+	{
+		const uint32_t drawCount = 1 + random() % 5000;
+		const uint32_t meshCount = 1 + random() % 100;
+
+		DrawList draws;
+		for (uint32_t draw = 0; draw < drawCount; draw++)
+		{
+			const uint32_t pass = random() % 2;
+			const bool transparent = random() % 8 == 0;
+			const uint32_t mesh = random() % meshCount;
+			const uint32_t material = random() % 4;
+			// The batch key covers what the sort key does not, so equal batch keys never differ in state
+			const uint64_t batchKey = static_cast<uint64_t>(mesh) << 32 | material << 1 | (transparent ? 1u : 0u);
+			draws.Add(pass, transparent ? DrawLayer::Transparent : DrawLayer::Opaque, transparent ? 1 : 0, material, depth(random), batchKey);
+		}
+
+		InstanceBatcher batcher;
+		std::vector<InstanceBatch> batches;
+		std::vector<uint32_t> instanceOrder;
+		batcher.Build(draws.sortKeys, draws.batchKeys, batches, instanceOrder);
+
+		std::vector<uint32_t> sorted = instanceOrder;
+		std::sort(sorted.begin(), sorted.end());
+		for (uint32_t draw = 0; draw < drawCount; draw++)
+			ASSERT_EQ(sorted[draw], draw) << "scene " << scene;
+
+		uint32_t nextInstance = 0;
+		std::set<std::pair<uint64_t, uint64_t>> opaqueGroups;
+		uint32_t opaqueBatches = 0;
+		for (const InstanceBatch& batch : batches)
+		{
+			ASSERT_EQ(batch.firstInstance, nextInstance);
+			ASSERT_GT(batch.instanceCount, 0u);
+			nextInstance += batch.instanceCount;
+
+			// Interchangeable draws only, in sort order
+			const uint32_t first = instanceOrder[batch.firstInstance];
+			for (uint32_t instance = 1; instance < batch.instanceCount; instance++)
+			{
+				const uint32_t draw = instanceOrder[batch.firstInstance + instance];
+				ASSERT_EQ(draws.batchKeys[draw], draws.batchKeys[first]) << "scene " << scene;
+				ASSERT_EQ(draws.sortKeys[draw] >> 56, draws.sortKeys[first] >> 56) << "scene " << scene;
+				ASSERT_LE(draws.sortKeys[instanceOrder[batch.firstInstance + instance - 1]], draws.sortKeys[draw]) << "scene " << scene;
+			}
+
+			if (!IsBackToFront(draws.sortKeys[first]))
+			{
+				opaqueGroups.emplace(draws.sortKeys[first] >> 56, draws.batchKeys[first]);
+				opaqueBatches++;
+			}
+		}
+		EXPECT_EQ(nextInstance, drawCount);
+
+		// Front to back layers merge every draw of a batch key into one batch
+		EXPECT_EQ(opaqueBatches, opaqueGroups.size()) << "scene " << scene;
+
+		// Back to front draws come out in exactly their sorted order
+		std::vector<uint32_t> expectedTransparent;
+		for (uint32_t draw = 0; draw < drawCount; draw++)
+		{
+			if (IsBackToFront(draws.sortKeys[draw]))
+				expectedTransparent.push_back(draw);
+		}
+		std::stable_sort(expectedTransparent.begin(), expectedTransparent.end(),
+			[&draws](uint32_t a, uint32_t b) { return draws.sortKeys[a] < draws.sortKeys[b]; });
+
+		std::vector<uint32_t> transparent;
+		for (uint32_t draw : instanceOrder)
+		{
+			if (IsBackToFront(draws.sortKeys[draw]))
+				transparent.push_back(draw);
+		}
+		EXPECT_EQ(transparent, expectedTransparent) << "scene " << scene;
+	}
+}
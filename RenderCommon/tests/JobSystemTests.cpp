@@ -0,0 +1,202 @@
+#include <gtest/gtest.h>
+
+#include <atomic>
+#include <stdexcept>
+#include <thread>
+#include <vector>
+
+#include <JobSystem.h>
+
+using namespace UltReality::Rendering::Common;
+
+namespace
+{
+	// Fails if two jobs run with the same worker index at once, which would share per-worker resources
+	class WorkerExclusivityCheck
+	{
+	private:
+		std::vector<std::atomic<bool>> m_busy;
+		std::atomic<uint32_t> m_violations{ 0 };
+		std::atomic<uint32_t> m_invalidIndices{ 0 };
+
+	public:
+		explicit WorkerExclusivityCheck(uint32_t workerCount)
+			: m_busy(workerCount)
+		{
+		}
+
+		void Run(uint32_t workerIndex)
+		{
+			if (workerIndex >= m_busy.size())
+			{
+				m_invalidIndices++;
+				return;
+			}
+
+			if (m_busy[workerIndex].exchange(true))
+				m_violations++;
+
+			// Give another thread the chance to collide with this worker index
+			std::this_thread::yield();
+
+			m_busy[workerIndex].store(false);
+		}
+
+		uint32_t GetViolations() const { return m_violations.load(); }
+
+		uint32_t GetInvalidIndices() const { return m_invalidIndices.load(); }
+	};
+}
+
+TEST(JobSystem, CountsTheOwningThreadAsWorkerZero)
+{
+	JobSystem jobSystem(3);
+
+	EXPECT_EQ(jobSystem.GetWorkerCount(), 4u);
+	EXPECT_EQ(jobSystem.CurrentWorkerIndex(), 0u);
+
+	uint32_t externalIndex = 0;
+	std::thread external([&]() { externalIndex = jobSystem.CurrentWorkerIndex(); });
+	external.join();
+	EXPECT_EQ(externalIndex, JobSystem::externalThreadIndex);
+}
+
+TEST(JobSystem, DispatchRunsEveryIndexOnce)
+{
+	JobSystem jobSystem(3);
+	std::vector<std::atomic<uint32_t>> hits(10007);
+
+	JobCounter counter;
+	jobSystem.Dispatch(static_cast<uint32_t>(hits.size()), 64, [&](uint32_t first, uint32_t last, uint32_t workerIndex)
+	{
+		EXPECT_LT(workerIndex, jobSystem.GetWorkerCount());
+		for (uint32_t i = first; i < last; i++)
+			hits[i]++;
+	}, counter);
+	jobSystem.Wait(counter);
+
+	EXPECT_TRUE(counter.IsDone());
+	for (size_t i = 0; i < hits.size(); i++)
+		ASSERT_EQ(hits[i].load(), 1u) << "index " << i;
+}
+
+TEST(JobSystem, DispatchOfNothingReturnsImmediately)
+{
+	JobSystem jobSystem(1);
+
+	JobCounter counter;
+	jobSystem.Dispatch(0, 16, [](uint32_t, uint32_t, uint32_t) { FAIL(); }, counter);
+	jobSystem.Wait(counter);
+
+	EXPECT_TRUE(counter.IsDone());
+}
+
+TEST(JobSystem, JobsCanWaitOnNestedJobs)
+{
+	JobSystem jobSystem(2);
+	std::atomic<uint32_t> innerRuns{ 0 };
+
+	JobCounter outer;
+	jobSystem.Dispatch(16, 1, [&](uint32_t, uint32_t, uint32_t)
+	{
+		// Waiting inside a job runs other jobs instead of blocking the worker, so this cannot deadlock
+		JobCounter inner;
+		jobSystem.Dispatch(32, 4, [&](uint32_t first, uint32_t last, uint32_t) { innerRuns += last - first; }, inner);
+		jobSystem.Wait(inner);
+	}, outer);
+	jobSystem.Wait(outer);
+
+	EXPECT_EQ(innerRuns.load(), 16u * 32u);
+}
+
+TEST(JobSystem, WaitRethrowsTheFirstJobException)
+{
+	JobSystem jobSystem(2);
+	std::atomic<uint32_t> runs{ 0 };
+
+	JobCounter counter;
+	jobSystem.Dispatch(64, 1, [&](uint32_t first, uint32_t, uint32_t)
+	{
+		runs++;
+		if (first % 8 == 0)
+			throw std::runtime_error("job failed");
+	}, counter);
+
+	EXPECT_THROW(jobSystem.Wait(counter), std::runtime_error);
+
+	// The failing jobs do not stop the rest of the group
+	EXPECT_EQ(runs.load(), 64u);
+
+	// The exception was consumed by the first Wait
+	EXPECT_NO_THROW(jobSystem.Wait(counter));
+}
+
+TEST(JobSystem, ExternalThreadsGetTheirOwnQueue)
+{
+	JobSystem jobSystem(2);
+	const std::thread::id ownerThread = std::this_thread::get_id();
+
+	std::atomic<uint32_t> runs{ 0 };
+	std::atomic<uint32_t> runsOnExternalThread{ 0 };
+	std::atomic<uint32_t> invalidIndices{ 0 };
+
+	std::thread external([&]()
+	{
+		const std::thread::id externalThread = std::this_thread::get_id();
+
+		JobCounter counter;
+		jobSystem.Dispatch(256, 4, [&](uint32_t first, uint32_t last, uint32_t workerIndex)
+		{
+			if (std::this_thread::get_id() == externalThread)
+				runsOnExternalThread++;
+			if (workerIndex >= jobSystem.GetWorkerCount())
+				invalidIndices++;
+			runs += last - first;
+		}, counter);
+		jobSystem.Wait(counter);
+	});
+	external.join();
+
+	EXPECT_EQ(runs.load(), 256u);
+	EXPECT_EQ(runsOnExternalThread.load(), 0u);
+	EXPECT_EQ(invalidIndices.load(), 0u);
+	EXPECT_EQ(std::this_thread::get_id(), ownerThread);
+}
+
+TEST(JobSystem, WorkerIndicesAreNeverShared)
+{
+	JobSystem jobSystem(3);
+	WorkerExclusivityCheck check(jobSystem.GetWorkerCount());
+
+	auto submitAndWait = [&]()
+	{
+		for (int round = 0; round < 20; round++)
+		{
+			JobCounter counter;
+			jobSystem.Dispatch(512, 8, [&](uint32_t, uint32_t, uint32_t workerIndex) { check.Run(workerIndex); }, counter);
+			jobSystem.Wait(counter);
+		}
+	};
+
+	// The owner and two external threads submit at the same time
+	std::thread externalA(submitAndWait);
+	std::thread externalB(submitAndWait);
+	submitAndWait();
+	externalA.join();
+	externalB.join();
+
+	EXPECT_EQ(check.GetViolations(), 0u);
+	EXPECT_EQ(check.GetInvalidIndices(), 0u);
+}
+
+TEST(JobSystem, DestructionRunsQueuedJobs)
+{
+	std::atomic<uint32_t> runs{ 0 };
+	{
+		JobSystem jobSystem(2);
+		for (int i = 0; i < 100; i++)
+			jobSystem.Submit([&](uint32_t) { runs++; });
+	}
+
+	EXPECT_EQ(runs.load(), 100u);
+}
@@ -0,0 +1,139 @@
+#include <gtest/gtest.h>
+
+#include <stdexcept>
+
+#include <LinearRingAllocator.h>
+
+using namespace UltReality::Rendering::Common;
+
+TEST(LinearRingAllocator, RejectsInvalidArguments)
+{
+	EXPECT_THROW(LinearRingAllocator(0), std::invalid_argument);
+
+	LinearRingAllocator allocator(1024);
+	EXPECT_THROW(allocator.Allocate(16, 0), std::invalid_argument);
+	EXPECT_THROW(allocator.Allocate(16, 48), std::invalid_argument);
+}
+
+TEST(LinearRingAllocator, AlignsEveryAllocation)
+{
+	LinearRingAllocator allocator(4096);
+
+	EXPECT_EQ(allocator.Allocate(100, 256), 0u);
+	EXPECT_EQ(allocator.Allocate(1, 256), 256u);
+	EXPECT_EQ(allocator.Allocate(3, 4), 260u);
+	EXPECT_EQ(allocator.Allocate(8, 16), 272u);
+	EXPECT_EQ(allocator.Allocate(1, 1), 280u);
+
+	// Alignment padding counts as used until the frame retires
+	EXPECT_EQ(allocator.GetUsedSize(), 281u);
+
+	for (uint64_t alignment = 1; alignment <= 1024; alignment *= 2)
+	{
+		const uint64_t offset = allocator.Allocate(7, alignment);
+		ASSERT_NE(offset, LinearRingAllocator::invalidOffset);
+		EXPECT_EQ(offset % alignment, 0u);
+	}
+}
+
+TEST(LinearRingAllocator, AlignUp)
+{
+	EXPECT_EQ(LinearRingAllocator::AlignUp(0, 256), 0u);
+	EXPECT_EQ(LinearRingAllocator::AlignUp(1, 256), 256u);
+	EXPECT_EQ(LinearRingAllocator::AlignUp(256, 256), 256u);
+	EXPECT_EQ(LinearRingAllocator::AlignUp(257, 256), 512u);
+	EXPECT_EQ(LinearRingAllocator::AlignUp(5, 1), 5u);
+}
+
+TEST(LinearRingAllocator, ReclaimsFramesOnceTheirFenceRetires)
+{
+	LinearRingAllocator allocator(1024);
+
+	allocator.Allocate(256, 256);
+	allocator.FinishFrame(1);
+	allocator.Allocate(512, 256);
+	allocator.FinishFrame(2);
+	EXPECT_EQ(allocator.GetUsedSize(), 768u);
+
+	allocator.Retire(0);
+	EXPECT_EQ(allocator.GetUsedSize(), 768u);
+
+	allocator.Retire(1);
+	EXPECT_EQ(allocator.GetUsedSize(), 512u);
+
+	allocator.Retire(2);
+	EXPECT_EQ(allocator.GetUsedSize(), 0u);
+}
+
+TEST(LinearRingAllocator, WrapsToTheStartOnceItIsRetired)
+{
+	LinearRingAllocator allocator(1024);
+
+	EXPECT_EQ(allocator.Allocate(512, 256), 0u);
+	allocator.FinishFrame(1);
+	EXPECT_EQ(allocator.Allocate(256, 256), 512u);
+	allocator.FinishFrame(2);
+
+	// [768, 1024) is too small and the start is still in use by frame 1
+	EXPECT_EQ(allocator.Allocate(384, 256), LinearRingAllocator::invalidOffset);
+
+	allocator.Retire(1);
+
+	// Wrapping skips the tail end, which stays used until the wrapping frame retires
+	EXPECT_EQ(allocator.Allocate(384, 256), 0u);
+	EXPECT_EQ(allocator.GetUsedSize(), 256u + 256u + 384u);
+	allocator.FinishFrame(3);
+
+	// Free space is now [384, 512) between the new tail and the head of frame 2
+	EXPECT_EQ(allocator.Allocate(128, 128), 384u);
+	EXPECT_EQ(allocator.Allocate(1, 1), LinearRingAllocator::invalidOffset);
+	allocator.FinishFrame(4);
+
+	allocator.Retire(4);
+	EXPECT_EQ(allocator.GetUsedSize(), 0u);
+}
+
+TEST(LinearRingAllocator, SustainsManyFramesWithoutLeaking)
+{
+	LinearRingAllocator allocator(8192);
+
+	// Three frames in flight, each allocating an odd amount so the tail lands everywhere in the ring
+	for (uint64_t frame = 1; frame <= 1000; frame++)
+	{
+		for (uint64_t i = 0; i < frame % 5 + 1; i++)
+		{
+			const uint64_t offset = allocator.Allocate(100 + (frame * 37 + i * 11) % 200, 64);
+			ASSERT_NE(offset, LinearRingAllocator::invalidOffset) << "frame " << frame;
+			EXPECT_EQ(offset % 64, 0u);
+		}
+		allocator.FinishFrame(frame);
+
+		if (frame > 2)
+			allocator.Retire(frame - 2);
+	}
+
+	allocator.Retire(1000);
+	EXPECT_EQ(allocator.GetUsedSize(), 0u);
+	EXPECT_EQ(allocator.GetOverflowCount(), 0u);
+}
+
+TEST(LinearRingAllocator, ReportsOverflowInsteadOfOverwriting)
+{
+	LinearRingAllocator allocator(1024);
+
+	// Larger than the whole ring
+	EXPECT_EQ(allocator.Allocate(2048, 1), LinearRingAllocator::invalidOffset);
+	EXPECT_EQ(allocator.GetOverflowCount(), 1u);
+
+	// Filling the ring exactly, then asking for more
+	EXPECT_EQ(allocator.Allocate(1024, 256), 0u);
+	EXPECT_EQ(allocator.GetUsedSize(), allocator.GetCapacity());
+	EXPECT_EQ(allocator.Allocate(1, 1), LinearRingAllocator::invalidOffset);
+	EXPECT_EQ(allocator.GetOverflowCount(), 2u);
+
+	// A failed allocation does not consume anything, so the ring is whole again after retiring
+	allocator.FinishFrame(1);
+	allocator.Retire(1);
+	EXPECT_EQ(allocator.GetUsedSize(), 0u);
+	EXPECT_NE(allocator.Allocate(1024, 256), LinearRingAllocator::invalidOffset);
+}
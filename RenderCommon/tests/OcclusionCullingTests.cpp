@@ -0,0 +1,273 @@
+#include <gtest/gtest.h>
+
+#include <algorithm>
+#include <cmath>
+#include <random>
+#include <stdexcept>
+#include <vector>
+
+#include <OcclusionCulling.h>
+#include <FrustumCulling.h>
+#include <JobSystem.h>
+
+using namespace UltReality::Rendering::Common;
+
+namespace
+{
+	constexpr CullingSimdPath allPaths[] = { CullingSimdPath::Scalar, CullingSimdPath::Sse, CullingSimdPath::Neon, CullingSimdPath::Avx2 };
+
+	// Left handed perspective projection in row-vector form with a [0, 1] depth range, the camera at the origin looking down +z
+	void PerspectiveMatrix(float verticalFov, float aspect, float nearZ, float farZ, float matrix[16])
+	{
+		std::fill_n(matrix, 16, 0.0f);
+		const float yScale = 1.0f / std::tan(verticalFov * 0.5f);
+		matrix[0] = yScale / aspect;
+		matrix[5] = yScale;
+		matrix[10] = farZ / (farZ - nearZ);
+		matrix[11] = 1.0f;
+		matrix[14] = -nearZ * farZ / (farZ - nearZ);
+	}
+
+	// Random small triangles scattered through the view, overlapping each other at different depths
+	void TriangleSoup(uint32_t triangleCount, std::mt19937& random, std::vector<float>& positions, std::vector<uint32_t>& indices)
+	{
+		std::uniform_real_distribution<float> unit(-1.0f, 1.0f);
+		for (uint32_t triangle = 0; triangle < triangleCount; triangle++)
+		{
+			const float center[3] = { unit(random) * 60.0f, unit(random) * 30.0f, 5.0f + (unit(random) + 1.0f) * 50.0f };
+			for (uint32_t vertex = 0; vertex < 3; vertex++)
+			{
+				for (uint32_t axis = 0; axis < 3; axis++)
+					positions.push_back(center[axis] + unit(random) * 6.0f);
+				indices.push_back(triangle * 3 + vertex);
+			}
+		}
+	}
+
+	// Pixel exact test of a box against level 0: visible when any pixel its screen rectangle touches is not nearer
+	bool IsBoxVisibleOnDepthBuffer(const float viewProjection[16], const std::vector<float>& depth, uint32_t width, uint32_t height, const float min[3], const float max[3])
+	{
+		float minX = 1e30f, maxX = -1e30f, minY = 1e30f, maxY = -1e30f, nearest = 1e30f;
+		for (uint32_t corner = 0; corner < 8; corner++)
+		{
+			const float point[3] = { (corner & 1) != 0 ? max[0] : min[0], (corner & 2) != 0 ? max[1] : min[1], (corner & 4) != 0 ? max[2] : min[2] };
+			float clip[4];
+			for (uint32_t j = 0; j < 4; j++)
+				clip[j] = point[0] * viewProjection[j] + point[1] * viewProjection[4 + j] + point[2] * viewProjection[8 + j] + viewProjection[12 + j];
+
+			const float x = (clip[0] / clip[3] * 0.5f + 0.5f) * static_cast<float>(width);
+			const float y = (0.5f - clip[1] / clip[3] * 0.5f) * static_cast<float>(height);
+			minX = std::min(minX, x);
+			maxX = std::max(maxX, x);
+			minY = std::min(minY, y);
+			maxY = std::max(maxY, y);
+			nearest = std::min(nearest, clip[2] / clip[3]);
+		}
+
+		const int lastX = static_cast<int>(width) - 1;
+		const int lastY = static_cast<int>(height) - 1;
+		for (int y = std::max(0, static_cast<int>(std::floor(minY))); y <= std::min(lastY, static_cast<int>(std::floor(maxY))); y++)
+		{
+			for (int x = std::max(0, static_cast<int>(std::floor(minX))); x <= std::min(lastX, static_cast<int>(std::floor(maxX))); x++)
+			{
+				if (depth[y * width + x] >= nearest)
+					return true;
+			}
+		}
+
+		return false;
+	}
+}
+
+TEST(OcclusionCulling, RejectsDepthBuffersOutsideTheTileGrid)
+{
+	EXPECT_THROW(OcclusionCuller(nullptr, 0, 128), std::invalid_argument);
+	EXPECT_THROW(OcclusionCuller(nullptr, 256, 0), std::invalid_argument);
+	EXPECT_THROW(OcclusionCuller(nullptr, 250, 128), std::invalid_argument);
+	EXPECT_THROW(OcclusionCuller(nullptr, 256, 120), std::invalid_argument);
+
+	OcclusionCuller culler(nullptr, 64, 32);
+	EXPECT_EQ(culler.GetWidth(), 64u);
+	EXPECT_EQ(culler.GetHeight(), 32u);
+	EXPECT_FALSE(culler.HasOccluders());
+}
+
+TEST(OcclusionCulling, ReferenceCoversPixelCentersAndKeepsTheNearestDepth)
+{
+	constexpr uint32_t size = 16;
+	std::vector<float> depth(size * size, 1.0f);
+
+	// Covers the pixels whose centers satisfy x + y <= 8, the hypotenuse included
+	const OccluderTriangle far = { { 0.0f, 8.0f, 0.0f }, { 0.0f, 0.0f, 8.0f }, { 0.5f, 0.5f, 0.5f } };
+	RasterizeOccludersReference({ far }, size, size, depth);
+
+	uint32_t covered = 0;
+	for (uint32_t y = 0; y < size; y++)
+	{
+		for (uint32_t x = 0; x < size; x++)
+		{
+			const bool inside = x + y <= 7;
+			EXPECT_EQ(depth[y * size + x], inside ? 0.5f : 1.0f) << "pixel " << x << ", " << y;
+			covered += inside ? 1 : 0;
+		}
+	}
+	EXPECT_EQ(covered, 36u);
+
+	// A nearer triangle over part of it wins, a farther one changes nothing
+	const OccluderTriangle nearer = { { 0.0f, 4.0f, 0.0f }, { 0.0f, 0.0f, 4.0f }, { 0.25f, 0.25f, 0.25f } };
+	const OccluderTriangle behind = { { 0.0f, 16.0f, 0.0f }, { 0.0f, 0.0f, 16.0f }, { 0.9f, 0.9f, 0.9f } };
+	RasterizeOccludersReference({ nearer, behind }, size, size, depth);
+	EXPECT_EQ(depth[0], 0.25f);
+	EXPECT_EQ(depth[3], 0.25f);
+	EXPECT_EQ(depth[5], 0.5f);
+	EXPECT_EQ(depth[9], 0.9f);
+}
+
+TEST(OcclusionCulling, DropsOccludersTheCameraCannotRasterize)
+{
+	float viewProjection[16];
+	PerspectiveMatrix(1.2f, 2.0f, 0.1f, 1000.0f, viewProjection);
+
+	OcclusionCuller culler;
+	culler.BeginFrame(viewProjection);
+
+	const float positions[] = {
+		-1.0f, -1.0f, 10.0f, 1.0f, -1.0f, 10.0f, 0.0f, 1.0f, 10.0f,    // In view
+		-1.0f, -1.0f, -5.0f, 1.0f, -1.0f, 5.0f, 0.0f, 1.0f, 5.0f,      // Crosses the near plane
+		-1.0f, -1.0f, 2000.0f, 1.0f, -1.0f, 2000.0f, 0.0f, 1.0f, 2000.0f, // Beyond the far plane
+		500.0f, 0.0f, 10.0f, 501.0f, 0.0f, 10.0f, 500.0f, 1.0f, 10.0f   // Off screen
+	};
+	const uint32_t indices[] = { 0, 2, 1, 3, 4, 5, 6, 7, 8, 9, 10, 11 };
+	culler.AddOccluder(positions, 12, indices, 12);
+
+	// Wound the other way round on screen, but kept and flipped
+	ASSERT_EQ(culler.GetTriangles().size(), 1u);
+	EXPECT_TRUE(culler.HasOccluders());
+
+	const uint32_t badIndices[] = { 0, 1, 12 };
+	EXPECT_THROW(culler.AddOccluder(positions, 12, badIndices, 3), std::out_of_range);
+
+	culler.BeginFrame(viewProjection);
+	EXPECT_FALSE(culler.HasOccluders());
+}
+
+TEST(OcclusionCulling, SimdRasterizerMatchesTheReference)
+{
+	float viewProjection[16];
+	PerspectiveMatrix(1.2f, 2.0f, 0.1f, 1000.0f, viewProjection);
+
+	std::mt19937 random(7);
+	std::vector<float> positions;
+	std::vector<uint32_t> indices;
+	TriangleSoup(2000, random, positions, indices);
+
+	JobSystem jobSystem(4);
+	for (CullingSimdPath path : allPaths)
+	{
+		if (!FrustumCuller::IsSimdPathSupported(path))
+			continue;
+
+		for (JobSystem* jobs : { static_cast<JobSystem*>(nullptr), &jobSystem })
+		{
+			OcclusionCuller culler(jobs, 320, 176);
+			culler.SetSimdPath(path);
+			culler.BeginFrame(viewProjection);
+			culler.AddOccluder(positions.data(), static_cast<uint32_t>(positions.size() / 3), indices.data(), static_cast<uint32_t>(indices.size()));
+			culler.Rasterize();
+
+			std::vector<float> reference(320 * 176, 1.0f);
+			RasterizeOccludersReference(culler.GetTriangles(), 320, 176, reference);
+
+			const std::vector<float>& depth = culler.GetDepthBuffer();
+			ASSERT_EQ(depth.size(), reference.size());
+
+			size_t mismatches = 0;
+			size_t covered = 0;
+			for (size_t i = 0; i < reference.size(); i++)
+			{
+				mismatches += depth[i] != reference[i] ? 1 : 0;
+				covered += reference[i] < 1.0f ? 1 : 0;
+			}
+
+			EXPECT_EQ(mismatches, 0u) << "path " << static_cast<uint32_t>(path) << (jobs ? ", parallel" : "");
+			EXPECT_GT(covered, reference.size() / 4);
+			EXPECT_EQ(culler.GetStatistics().occluderTriangleCount, culler.GetTriangles().size());
+		}
+	}
+}
+
+TEST(OcclusionCulling, WallsHideOnlyWhatIsFullyBehindThem)
+{
+	float viewProjection[16];
+	PerspectiveMatrix(1.2f, 2.0f, 0.1f, 1000.0f, viewProjection);
+	JobSystem jobSystem(4);
+	OcclusionCuller culler(&jobSystem);
+
+	const uint32_t quad[] = { 0, 1, 2, 0, 2, 3 };
+	const float wall[] = { -100.0f, -100.0f, 10.0f, 100.0f, -100.0f, 10.0f, 100.0f, 100.0f, 10.0f, -100.0f, 100.0f, 10.0f };
+	culler.BeginFrame(viewProjection);
+	culler.AddOccluder(wall, 4, quad, 6);
+
+	const float behindMin[3] = { -1.0f, -1.0f, 20.0f }, behindMax[3] = { 1.0f, 1.0f, 22.0f };
+	const float frontMin[3] = { -1.0f, -1.0f, 5.0f }, frontMax[3] = { 1.0f, 1.0f, 6.0f };
+	const float straddleMin[3] = { -1.0f, -1.0f, 9.0f }, straddleMax[3] = { 1.0f, 1.0f, 11.0f };
+	const float cameraMin[3] = { -1.0f, -1.0f, -1.0f }, cameraMax[3] = { 1.0f, 1.0f, 1.0f };
+	EXPECT_FALSE(culler.IsBoxVisible(behindMin, behindMax));
+	EXPECT_TRUE(culler.IsBoxVisible(frontMin, frontMax));
+	EXPECT_TRUE(culler.IsBoxVisible(straddleMin, straddleMax));
+	EXPECT_TRUE(culler.IsBoxVisible(cameraMin, cameraMax));
+
+	// Only the left half of the screen is covered now
+	const float halfWall[] = { -100.0f, -100.0f, 10.0f, 0.0f, -100.0f, 10.0f, 0.0f, 100.0f, 10.0f, -100.0f, 100.0f, 10.0f };
+	culler.BeginFrame(viewProjection);
+	culler.AddOccluder(halfWall, 4, quad, 6);
+
+	const float leftMin[3] = { -10.0f, -1.0f, 20.0f }, leftMax[3] = { -8.0f, 1.0f, 22.0f };
+	const float rightMin[3] = { 8.0f, -1.0f, 20.0f }, rightMax[3] = { 10.0f, 1.0f, 22.0f };
+	BoundingBoxSoA boxes;
+	boxes.Add(behindMin, behindMax);
+	boxes.Add(leftMin, leftMax);
+	boxes.Add(rightMin, rightMax);
+	boxes.Add(frontMin, frontMax);
+
+	std::vector<uint32_t> visible = { 0, 1, 2, 3 };
+	culler.CullBoxes(boxes, visible);
+	EXPECT_EQ(visible, (std::vector<uint32_t>{ 0, 2, 3 }));
+	EXPECT_EQ(culler.GetStatistics().testedCount, 4u);
+	EXPECT_EQ(culler.GetStatistics().occludedCount, 1u);
+}
+
+TEST(OcclusionCulling, HiZNeverHidesABoxThePixelsShow)
+{
+	float viewProjection[16];
+	PerspectiveMatrix(1.2f, 2.0f, 0.1f, 1000.0f, viewProjection);
+
+	std::mt19937 random(11);
+	std::vector<float> positions;
+	std::vector<uint32_t> indices;
+	TriangleSoup(2000, random, positions, indices);
+
+	OcclusionCuller culler(nullptr, 320, 176);
+	culler.BeginFrame(viewProjection);
+	culler.AddOccluder(positions.data(), static_cast<uint32_t>(positions.size() / 3), indices.data(), static_cast<uint32_t>(indices.size()));
+	culler.Rasterize();
+
+	std::uniform_real_distribution<float> unit(-1.0f, 1.0f);
+	uint32_t occluded = 0;
+	for (int box = 0; box < 20000; box++)
+	{
+		const float center[3] = { unit(random) * 80.0f, unit(random) * 40.0f, 20.0f + (unit(random) + 1.0f) * 60.0f };
+		const float extent = 0.2f + (unit(random) + 1.0f) * 2.0f;
+		const float min[3] = { center[0] - extent, center[1] - extent, center[2] - extent };
+		const float max[3] = { center[0] + extent, center[1] + extent, center[2] + extent };
+
+		if (culler.IsBoxVisible(min, max))
+			continue;
+
+		occluded++;
+		ASSERT_FALSE(IsBoxVisibleOnDepthBuffer(viewProjection, culler.GetDepthBuffer(), 320, 176, min, max)) << "box " << box;
+	}
+
+	// The pyramid is conservative but still hides a good share of the boxes
+	EXPECT_GT(occluded, 1000u);
+}
@@ -0,0 +1,187 @@
+#include <gtest/gtest.h>
+
+#include <filesystem>
+#include <fstream>
+#include <vector>
+
+#include <PipelineCacheIndex.h>
+#include <StableHash.h>
+
+using namespace UltReality::Rendering::Common;
+
+namespace
+{
+	using LoadResult = PipelineCacheIndex::LoadResult;
+
+	constexpr uint64_t compatibilityHash = 0x1234;
+	constexpr uint64_t libraryHash = 0x5678;
+
+	// Serialized index, loaded back and serialized again, the way one run of the application hands it to the next
+	PipelineCacheIndex NextRun(const PipelineCacheIndex& index)
+	{
+		const std::vector<uint8_t> data = index.Serialize();
+
+		PipelineCacheIndex next;
+		EXPECT_EQ(next.Deserialize(data.data(), data.size(), index.GetCompatibilityHash(), index.GetLibraryHash()), LoadResult::Loaded);
+
+		return next;
+	}
+
+	std::filesystem::path TemporaryPath(const char* name)
+	{
+		return std::filesystem::temp_directory_path() / (std::string("RenderCommonTests_") + name);
+	}
+}
+
+TEST(StableHasher, MatchesReferenceFnv1a)
+{
+	// Published FNV-1a 64 test vectors, keys persisted by older builds depend on them never changing
+	EXPECT_EQ(StableHash("", 0), StableHasher::offsetBasis);
+	EXPECT_EQ(StableHash("a", 1), 0xaf63dc4c8601ec8cull);
+	EXPECT_EQ(StableHash("foobar", 6), 0x85944171f73967e8ull);
+}
+
+TEST(StableHasher, HashesValuesNotRepresentations)
+{
+	EXPECT_EQ(StableHasher().Add(0.0f).Finish(), StableHasher().Add(-0.0f).Finish());
+
+	// Integers are hashed as little endian bytes whatever the host order
+	const uint8_t littleEndian[] = { 0x04, 0x03, 0x02, 0x01 };
+	EXPECT_EQ(StableHasher().Add<uint32_t>(0x01020304u).Finish(), StableHash(littleEndian, sizeof(littleEndian)));
+
+	// The width is part of the value
+	EXPECT_NE(StableHasher().Add<uint32_t>(1).Finish(), StableHasher().Add<uint64_t>(1).Finish());
+
+	// String lengths separate neighbouring strings
+	EXPECT_NE(StableHasher().AddString("ab").AddString("c").Finish(), StableHasher().AddString("a").AddString("bc").Finish());
+}
+
+TEST(PipelineCacheIndex, CountsUsesOncePerRun)
+{
+	PipelineCacheIndex index(compatibilityHash);
+	index.SetLibraryHash(libraryHash);
+
+	EXPECT_FALSE(index.MarkUsed(5));
+	EXPECT_TRUE(index.MarkUsed(5));
+	EXPECT_FALSE(index.MarkUsed(3));
+
+	PipelineCacheIndex next = NextRun(index);
+	EXPECT_EQ(next.GetRun(), 1u);
+	EXPECT_TRUE(next.Contains(5));
+	EXPECT_TRUE(next.MarkUsed(5));
+
+	const std::vector<PipelineCacheIndexEntry> entries = next.GetEntries();
+	ASSERT_EQ(entries.size(), 2u);
+	EXPECT_EQ(entries[0].key, 3u);
+	EXPECT_EQ(entries[0].useCount, 1u);
+	EXPECT_EQ(entries[0].lastUsedRun, 0u);
+	EXPECT_EQ(entries[1].key, 5u);
+	EXPECT_EQ(entries[1].useCount, 2u);
+	EXPECT_EQ(entries[1].lastUsedRun, 1u);
+}
+
+TEST(PipelineCacheIndex, SerializesToTheDocumentedLayout)
+{
+	PipelineCacheIndex index(compatibilityHash);
+	index.SetLibraryHash(libraryHash);
+	index.MarkUsed(0xAABBCCDDEEFF0011ull);
+
+	const std::vector<uint8_t> data = index.Serialize();
+	ASSERT_EQ(data.size(), 32u + 16u + 8u);
+
+	auto readLittleEndian = [&](size_t offset, size_t size)
+	{
+		uint64_t value = 0;
+		for (size_t i = 0; i < size; i++)
+			value |= static_cast<uint64_t>(data[offset + i]) << (i * 8);
+		return value;
+	};
+
+	EXPECT_EQ(readLittleEndian(0, 4), PipelineCacheIndex::magic);
+	EXPECT_EQ(readLittleEndian(4, 4), PipelineCacheIndex::formatVersion);
+	EXPECT_EQ(readLittleEndian(8, 8), compatibilityHash);
+	EXPECT_EQ(readLittleEndian(16, 8), libraryHash);
+	EXPECT_EQ(readLittleEndian(24, 4), 0u);
+	EXPECT_EQ(readLittleEndian(28, 4), 1u);
+	EXPECT_EQ(readLittleEndian(32, 8), 0xAABBCCDDEEFF0011ull);
+	EXPECT_EQ(readLittleEndian(40, 4), 1u);
+	EXPECT_EQ(readLittleEndian(44, 4), 0u);
+	EXPECT_EQ(readLittleEndian(48, 8), StableHash(data.data(), 48));
+
+	// Insertion order does not change the bytes
+	PipelineCacheIndex a(compatibilityHash);
+	PipelineCacheIndex b(compatibilityHash);
+	for (uint64_t key = 0; key < 64; key++)
+	{
+		a.MarkUsed(key * 7919);
+		b.MarkUsed((63 - key) * 7919);
+	}
+	EXPECT_EQ(a.Serialize(), b.Serialize());
+}
+
+TEST(PipelineCacheIndex, RejectsMismatchedOrDamagedIndices)
+{
+	PipelineCacheIndex index(compatibilityHash);
+	index.SetLibraryHash(libraryHash);
+	for (uint64_t key = 1; key <= 10; key++)
+		index.MarkUsed(key);
+
+	const std::vector<uint8_t> data = index.Serialize();
+	PipelineCacheIndex loaded;
+
+	EXPECT_EQ(loaded.Deserialize(data.data(), data.size(), compatibilityHash + 1, libraryHash), LoadResult::CompatibilityMismatch);
+	EXPECT_EQ(loaded.GetEntryCount(), 0u);
+	EXPECT_EQ(loaded.GetCompatibilityHash(), compatibilityHash + 1);
+
+	EXPECT_EQ(loaded.Deserialize(data.data(), data.size(), compatibilityHash, libraryHash + 1), LoadResult::LibraryMismatch);
+	EXPECT_EQ(loaded.GetEntryCount(), 0u);
+
+	EXPECT_EQ(loaded.Deserialize(data.data(), data.size() - 1, compatibilityHash, libraryHash), LoadResult::Corrupt);
+	EXPECT_EQ(loaded.Deserialize(data.data(), 10, compatibilityHash, libraryHash), LoadResult::Corrupt);
+
+	// Every single bit flip is caught by the checksum
+	for (size_t byte = 0; byte < data.size(); byte++)
+	{
+		std::vector<uint8_t> damaged = data;
+		damaged[byte] ^= 0x10;
+		ASSERT_EQ(loaded.Deserialize(damaged.data(), damaged.size(), compatibilityHash, libraryHash), LoadResult::Corrupt) << "byte " << byte;
+		ASSERT_EQ(loaded.GetEntryCount(), 0u);
+	}
+
+	EXPECT_EQ(loaded.Deserialize(data.data(), data.size(), compatibilityHash, libraryHash), LoadResult::Loaded);
+	EXPECT_EQ(loaded.GetEntryCount(), 10u);
+}
+
+TEST(PipelineCacheIndex, RoundTripsThroughFiles)
+{
+	const std::filesystem::path path = TemporaryPath("PipelineCacheIndex.bin");
+	std::filesystem::remove(path);
+
+	PipelineCacheIndex loaded;
+	EXPECT_EQ(loaded.LoadFromFile(path.string(), compatibilityHash, libraryHash), LoadResult::Missing);
+	EXPECT_EQ(loaded.GetCompatibilityHash(), compatibilityHash);
+
+	PipelineCacheIndex index(compatibilityHash);
+	index.SetLibraryHash(libraryHash);
+	index.MarkUsed(42);
+	ASSERT_TRUE(index.SaveToFile(path.string()));
+	EXPECT_FALSE(std::filesystem::exists(path.string() + ".tmp"));
+
+	// Saving again replaces the previous index
+	index.MarkUsed(43);
+	ASSERT_TRUE(index.SaveToFile(path.string()));
+
+	EXPECT_EQ(loaded.LoadFromFile(path.string(), compatibilityHash, libraryHash), LoadResult::Loaded);
+	EXPECT_EQ(loaded.GetEntryCount(), 2u);
+	EXPECT_TRUE(loaded.Contains(42));
+	EXPECT_TRUE(loaded.Contains(43));
+
+	{
+		std::ofstream file(path, std::ios::binary | std::ios::trunc);
+		file << "not an index";
+	}
+	EXPECT_EQ(loaded.LoadFromFile(path.string(), compatibilityHash, libraryHash), LoadResult::Corrupt);
+	EXPECT_EQ(loaded.GetEntryCount(), 0u);
+
+	std::filesystem::remove(path);
+}
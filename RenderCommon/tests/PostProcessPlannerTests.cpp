@@ -0,0 +1,188 @@
+#include <gtest/gtest.h>
+
+#include <stdexcept>
+
+#include <PostProcessPlanner.h>
+
+using namespace UltReality::Rendering::Common;
+
+namespace
+{
+	using Kind = PostProcessTarget::Kind;
+	using Type = PostProcessPass::Type;
+
+	void ExpectTarget(const PostProcessTarget& target, Kind kind, uint32_t index)
+	{
+		EXPECT_EQ(target.kind, kind);
+		EXPECT_EQ(target.index, index);
+	}
+
+	bool HasEffect(PostEffect effects, PostEffect effect)
+	{
+		return (effects & effect) != PostEffect::None;
+	}
+}
+
+TEST(PostProcessPlanner, RejectsEmptyImagesAndInvalidPyramids)
+{
+	PostProcessConfig config;
+	PostProcessPlan plan;
+	EXPECT_THROW(BuildPostProcessPlan(config, 0, 1080, plan), std::invalid_argument);
+	EXPECT_THROW(BuildPostProcessPlan(config, 1920, 0, plan), std::invalid_argument);
+
+	config.effects = PostEffect::Bloom;
+	config.bloomLevels = 0;
+	EXPECT_THROW(BuildPostProcessPlan(config, 1920, 1080, plan), std::invalid_argument);
+
+	config.effects = PostEffect::AutoExposure;
+	config.exposureReduceSize = 0;
+	EXPECT_THROW(BuildPostProcessPlan(config, 1920, 1080, plan), std::invalid_argument);
+
+	// Pyramid settings only matter for the effects that use them
+	config.effects = PostEffect::Tonemap;
+	config.bloomLevels = 0;
+	EXPECT_NO_THROW(BuildPostProcessPlan(config, 1920, 1080, plan));
+}
+
+TEST(PostProcessPlanner, WithoutEffectsTheSceneIsStillWrittenToTheOutput)
+{
+	PostProcessConfig config;
+	PostProcessPlan plan;
+	BuildPostProcessPlan(config, 1920, 1080, plan);
+
+	ASSERT_EQ(plan.passes.size(), 1u);
+	EXPECT_EQ(plan.passes[0].type, Type::Fused);
+	EXPECT_EQ(plan.passes[0].effects, PostEffect::None);
+	ExpectTarget(plan.passes[0].input, Kind::SceneColor, 0);
+	ExpectTarget(plan.passes[0].output, Kind::Output, 0);
+	EXPECT_EQ(plan.pyramidLevels, 0u);
+	EXPECT_EQ(plan.intermediateCount, 0u);
+	EXPECT_EQ(plan.bandwidthBytes, 1920ull * 1080ull * (postProcessColorBytes + postProcessOutputBytes));
+}
+
+TEST(PostProcessPlanner, PerPixelEffectsFuseIntoOnePass)
+{
+	PostProcessConfig config;
+	config.effects = PostEffect::Tonemap | PostEffect::ColorGrading | PostEffect::Vignette | PostEffect::FilmGrain;
+	PostProcessPlan plan;
+	BuildPostProcessPlan(config, 1920, 1080, plan);
+
+	ASSERT_EQ(plan.passes.size(), 1u);
+	EXPECT_EQ(plan.passes[0].effects, config.effects);
+	EXPECT_EQ(plan.fullResolutionPasses, 1u);
+
+	// One pass per effect would read and write the full image four times
+	EXPECT_EQ(plan.bandwidthBytes, 1920ull * 1080ull * (postProcessColorBytes + postProcessOutputBytes));
+	EXPECT_GT(plan.unfusedBandwidthBytes, 3 * plan.bandwidthBytes);
+}
+
+TEST(PostProcessPlanner, FullChainSharesOnePyramidAndSplitsOnlyAtSharpen)
+{
+	PostProcessConfig config;
+	config.effects = PostEffect::All;
+	PostProcessPlan plan;
+	BuildPostProcessPlan(config, 1920, 1080, plan);
+
+	// 6 downsamples, the exposure reduction, 5 bloom upsamples and two fused passes
+	ASSERT_EQ(plan.passes.size(), 14u);
+	EXPECT_EQ(plan.pyramidLevels, 6u);
+	EXPECT_EQ(plan.bloomLevels, 6u);
+	// Level 5 is 60x33, the first at most 64 pixels wide
+	EXPECT_EQ(plan.exposureLevel, 5u);
+	EXPECT_EQ(plan.fullResolutionPasses, 2u);
+	EXPECT_EQ(plan.intermediateCount, 1u);
+	ExpectTarget(plan.bloomSource, Kind::Bloom, 1);
+
+	for (uint32_t level = 1; level <= 6; level++)
+	{
+		const PostProcessPass& pass = plan.passes[level - 1];
+		EXPECT_EQ(pass.type, Type::Downsample);
+		ExpectTarget(pass.input, level == 1 ? Kind::SceneColor : Kind::Pyramid, level - 1);
+		ExpectTarget(pass.output, Kind::Pyramid, level);
+		EXPECT_EQ(pass.width, 1920u >> level);
+		EXPECT_EQ(pass.height, 1080u >> level);
+	}
+
+	EXPECT_EQ(plan.passes[6].type, Type::Exposure);
+	ExpectTarget(plan.passes[6].input, Kind::Pyramid, 5);
+	ExpectTarget(plan.passes[6].output, Kind::Exposure, 0);
+
+	for (uint32_t i = 7; i < 12; i++)
+	{
+		const uint32_t level = 12 - i;
+		EXPECT_EQ(plan.passes[i].type, Type::Upsample);
+		ExpectTarget(plan.passes[i].input, level == 5 ? Kind::Pyramid : Kind::Bloom, level + 1);
+		ExpectTarget(plan.passes[i].output, Kind::Bloom, level);
+	}
+
+	// Sharpen reads its neighbors, so everything before it has to land in memory first
+	EXPECT_EQ(plan.passes[12].effects, PostEffect::ChromaticAberration | PostEffect::Bloom | PostEffect::AutoExposure
+		| PostEffect::Tonemap | PostEffect::ColorGrading | PostEffect::Vignette);
+	ExpectTarget(plan.passes[12].input, Kind::SceneColor, 0);
+	ExpectTarget(plan.passes[12].output, Kind::Intermediate, 0);
+	EXPECT_EQ(plan.passes[13].effects, PostEffect::Sharpen | PostEffect::FilmGrain);
+	ExpectTarget(plan.passes[13].input, Kind::Intermediate, 0);
+	ExpectTarget(plan.passes[13].output, Kind::Output, 0);
+
+	EXPECT_LT(plan.bandwidthBytes, plan.unfusedBandwidthBytes);
+}
+
+TEST(PostProcessPlanner, PyramidStopsAtASinglePixel)
+{
+	PostProcessConfig config;
+	config.effects = PostEffect::Bloom;
+	config.bloomLevels = 20;
+	PostProcessPlan plan;
+
+	BuildPostProcessPlan(config, 1, 1, plan);
+	EXPECT_EQ(plan.pyramidLevels, 1u);
+	EXPECT_EQ(plan.passes.size(), 2u);
+
+	BuildPostProcessPlan(config, 256, 4, plan);
+	EXPECT_EQ(plan.pyramidLevels, 8u);
+	EXPECT_EQ(plan.passes.back().output.kind, Kind::Output);
+}
+
+TEST(PostProcessPlanner, PassCountsForEveryEffectCombination)
+{
+	PostProcessConfig config;
+	PostProcessPlan plan;
+	for (uint32_t mask = 0; mask <= static_cast<uint32_t>(PostEffect::All); mask++)
+	{
+		config.effects = static_cast<PostEffect>(mask);
+		BuildPostProcessPlan(config, 1280, 720, plan);
+
+		const bool bloom = HasEffect(config.effects, PostEffect::Bloom);
+		const bool autoExposure = HasEffect(config.effects, PostEffect::AutoExposure);
+
+		// Chromatic aberration is always first, so only a sharpen after another effect starts a second pass
+		const bool splitAtSharpen = HasEffect(config.effects, PostEffect::Sharpen)
+			&& (mask & (static_cast<uint32_t>(PostEffect::Sharpen) - 1)) != 0;
+		const uint32_t fusedPasses = splitAtSharpen ? 2 : 1;
+		const uint32_t bloomUpsamples = bloom ? config.bloomLevels - 1 : 0;
+
+		SCOPED_TRACE(testing::Message() << "effects " << mask);
+		ASSERT_EQ(plan.fullResolutionPasses, fusedPasses);
+		ASSERT_EQ(plan.intermediateCount, fusedPasses - 1);
+		ASSERT_EQ(plan.passes.size(), plan.pyramidLevels + (autoExposure ? 1u : 0u) + bloomUpsamples + fusedPasses);
+		// Bloom spans six levels, auto exposure reduces 40x22 at level 5
+		ASSERT_EQ(plan.pyramidLevels, bloom ? 6u : autoExposure ? 5u : 0u);
+		ASSERT_LE(plan.bandwidthBytes, plan.unfusedBandwidthBytes);
+
+		// The fused passes chain from the scene to the output and apply every effect exactly once
+		PostEffect applied = PostEffect::None;
+		PostProcessTarget previous{ Kind::SceneColor, 0 };
+		for (size_t i = plan.passes.size() - fusedPasses; i < plan.passes.size(); i++)
+		{
+			const PostProcessPass& pass = plan.passes[i];
+			ASSERT_EQ(pass.type, Type::Fused);
+			ASSERT_EQ(pass.input.kind, previous.kind);
+			ASSERT_EQ(pass.input.index, previous.index);
+			ASSERT_EQ(pass.effects & applied, PostEffect::None);
+			applied |= pass.effects;
+			previous = pass.output;
+		}
+		ASSERT_EQ(previous.kind, Kind::Output);
+		ASSERT_EQ(applied, config.effects);
+	}
+}
@@ -0,0 +1,192 @@
+#include <gtest/gtest.h>
+
+#include <random>
+#include <stdexcept>
+#include <vector>
+
+#include <QueueScheduler.h>
+
+using namespace UltReality::Rendering::Common;
+
+namespace
+{
+	// Checks what Simulate does not: a submission signals exactly when something waits on it, and after the join
+	// waits every submission of the batch is complete on the join queue
+	void ExpectSignalsAndJoinAreExact(const std::vector<QueueSubmission>& submissions, const QueueSchedule& schedule, QueueType joinQueue)
+	{
+		const size_t count = submissions.size();
+
+		std::vector<bool> waitedOn(count, false);
+		for (const ScheduledSubmission& scheduled : schedule.submissions)
+		{
+			for (uint32_t wait : scheduled.waits)
+				waitedOn[wait] = true;
+		}
+		for (uint32_t wait : schedule.joinWaits)
+			waitedOn[wait] = true;
+
+		for (size_t index = 0; index < count; index++)
+			EXPECT_EQ(schedule.submissions[index].signal, waitedOn[index]) << "submission " << index;
+
+		// Walk backwards from the join point along queue order and waits
+		std::vector<bool> reached(count, false);
+		std::vector<uint32_t> stack(schedule.joinWaits.begin(), schedule.joinWaits.end());
+		for (size_t index = count; index-- > 0;)
+		{
+			if (submissions[index].queue == joinQueue)
+			{
+				stack.push_back(static_cast<uint32_t>(index));
+				break;
+			}
+		}
+
+		while (!stack.empty())
+		{
+			const uint32_t index = stack.back();
+			stack.pop_back();
+			if (reached[index])
+				continue;
+
+			reached[index] = true;
+			for (uint32_t wait : schedule.submissions[index].waits)
+				stack.push_back(wait);
+			for (uint32_t earlier = index; earlier-- > 0;)
+			{
+				if (submissions[earlier].queue == submissions[index].queue)
+				{
+					stack.push_back(earlier);
+					break;
+				}
+			}
+		}
+
+		for (size_t index = 0; index < count; index++)
+			EXPECT_TRUE(reached[index]) << "submission " << index << " is not covered by the join";
+	}
+}
+
+TEST(QueueScheduler, RejectsDependenciesOnLaterSubmissions)
+{
+	QueueScheduler scheduler;
+	const uint32_t first = scheduler.Add(QueueType::Graphics);
+
+	EXPECT_THROW(scheduler.Add(QueueType::Compute, { first + 1 }), std::invalid_argument);
+	EXPECT_THROW(scheduler.Add(QueueType::Compute, { 99 }), std::invalid_argument);
+	EXPECT_EQ(scheduler.GetSubmissionCount(), 1u);
+
+	scheduler.Reset();
+	EXPECT_EQ(scheduler.GetSubmissionCount(), 0u);
+	EXPECT_TRUE(scheduler.Resolve().submissions.empty());
+}
+
+TEST(QueueScheduler, WaitsOnlyForWhatIsNotAlreadyKnown)
+{
+	QueueScheduler scheduler;
+	const uint32_t depthPrepass = scheduler.Add(QueueType::Graphics);
+	const uint32_t lightCulling = scheduler.Add(QueueType::Compute, { depthPrepass });
+	const uint32_t lightCompaction = scheduler.Add(QueueType::Compute, { lightCulling });
+	// Also consumes the culling output, but waiting for the compaction covers it
+	const uint32_t shading = scheduler.Add(QueueType::Graphics, { lightCompaction, lightCulling });
+	// The compute queue already waited for the prepass
+	const uint32_t particles = scheduler.Add(QueueType::Compute, { depthPrepass });
+	const uint32_t post = scheduler.Add(QueueType::Graphics, { shading });
+
+	const QueueSchedule schedule = scheduler.Resolve();
+	ASSERT_EQ(schedule.submissions.size(), 6u);
+
+	EXPECT_EQ(schedule.submissions[lightCulling].waits, std::vector<uint32_t>{ depthPrepass });
+	EXPECT_TRUE(schedule.submissions[lightCompaction].waits.empty());
+	EXPECT_EQ(schedule.submissions[shading].waits, std::vector<uint32_t>{ lightCompaction });
+	EXPECT_TRUE(schedule.submissions[particles].waits.empty());
+	EXPECT_TRUE(schedule.submissions[post].waits.empty());
+
+	// The particles are the only compute work graphics has not waited for yet
+	EXPECT_EQ(schedule.joinWaits, std::vector<uint32_t>{ particles });
+
+	const QueueSimulationResult result = QueueScheduler::Simulate(scheduler.GetSubmissions(), schedule);
+	EXPECT_TRUE(result.completed);
+	EXPECT_TRUE(result.dependenciesSatisfied);
+	EXPECT_EQ(result.redundantWaits, 0u);
+	ExpectSignalsAndJoinAreExact(scheduler.GetSubmissions(), schedule, QueueType::Graphics);
+}
+
+TEST(QueueScheduler, FollowsDependenciesThroughOtherQueues)
+{
+	// Upload on copy, consumed by compute, and graphics consumes both: waiting for compute is enough
+	QueueScheduler scheduler;
+	const uint32_t upload = scheduler.Add(QueueType::Copy);
+	const uint32_t simulate = scheduler.Add(QueueType::Compute, { upload });
+	const uint32_t draw = scheduler.Add(QueueType::Graphics, { upload, simulate });
+
+	const QueueSchedule schedule = scheduler.Resolve();
+	EXPECT_EQ(schedule.submissions[draw].waits, std::vector<uint32_t>{ simulate });
+	EXPECT_TRUE(schedule.joinWaits.empty());
+	ExpectSignalsAndJoinAreExact(scheduler.GetSubmissions(), schedule, QueueType::Graphics);
+
+	// Joining on compute instead needs nothing from copy either, but has to wait for graphics
+	const QueueSchedule computeJoin = scheduler.Resolve(QueueType::Compute);
+	EXPECT_EQ(computeJoin.joinWaits, std::vector<uint32_t>{ draw });
+	ExpectSignalsAndJoinAreExact(scheduler.GetSubmissions(), computeJoin, QueueType::Compute);
+}
+
+TEST(QueueScheduler, SimulationCatchesBrokenSchedules)
+{
+	QueueScheduler scheduler;
+	const uint32_t prepass = scheduler.Add(QueueType::Graphics);
+	const uint32_t culling = scheduler.Add(QueueType::Compute, { prepass });
+	const uint32_t shading = scheduler.Add(QueueType::Graphics, { culling });
+	const QueueSchedule schedule = scheduler.Resolve();
+
+	// A missing wait lets shading run before culling finished
+	QueueSchedule missingWait = schedule;
+	missingWait.submissions[shading].waits.clear();
+	EXPECT_FALSE(QueueScheduler::Simulate(scheduler.GetSubmissions(), missingWait).dependenciesSatisfied);
+
+	// Waiting on work that is queued behind the waiter never finishes
+	QueueSchedule deadlock = schedule;
+	deadlock.submissions[culling].waits = { shading };
+	deadlock.submissions[shading].signal = true;
+	EXPECT_FALSE(QueueScheduler::Simulate(scheduler.GetSubmissions(), deadlock).completed);
+
+	// A wait on a submission that never signals blocks as well
+	QueueSchedule missingSignal = schedule;
+	missingSignal.submissions[prepass].signal = false;
+	EXPECT_FALSE(QueueScheduler::Simulate(scheduler.GetSubmissions(), missingSignal).completed);
+
+	// Waiting twice for the same work is counted
+	QueueSchedule redundant = schedule;
+	redundant.submissions[shading].waits.push_back(prepass);
+	EXPECT_EQ(QueueScheduler::Simulate(scheduler.GetSubmissions(), redundant).redundantWaits, 1u);
+}
+
+TEST(QueueScheduler, RandomGraphsResolveToMinimalDeadlockFreeSchedules)
+{
+	std::mt19937 random(1);
+	for (int graph = 0; graph < 5000; graph++)
+	{
+		QueueScheduler scheduler;
+		const uint32_t count = 1 + random() % 16;
+		for (uint32_t index = 0; index < count; index++)
+		{
+			std::vector<uint32_t> dependencies;
+			for (uint32_t earlier = 0; earlier < index; earlier++)
+			{
+				if (random() % 4 == 0)
+					dependencies.push_back(earlier);
+			}
+
+			scheduler.Add(static_cast<QueueType>(random() % queueTypeCount), dependencies);
+		}
+
+		const QueueType joinQueue = static_cast<QueueType>(random() % queueTypeCount);
+		const QueueSchedule schedule = scheduler.Resolve(joinQueue);
+		const QueueSimulationResult result = QueueScheduler::Simulate(scheduler.GetSubmissions(), schedule);
+
+		ASSERT_TRUE(result.completed) << "graph " << graph;
+		ASSERT_TRUE(result.dependenciesSatisfied) << "graph " << graph;
+		ASSERT_EQ(result.redundantWaits, 0u) << "graph " << graph;
+
+		ExpectSignalsAndJoinAreExact(scheduler.GetSubmissions(), schedule, joinQueue);
+		ASSERT_FALSE(HasFailure()) << "graph " << graph;
+	}
+}
@@ -0,0 +1,418 @@
+#include <gtest/gtest.h>
+
+#include <algorithm>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+#include <RenderGraph.h>
+
+using namespace UltReality::Rendering::Common;
+
+namespace
+{
+	constexpr uint64_t megabyte = 1024 * 1024;
+	constexpr uint64_t placementAlignment = 64 * 1024;
+
+	const RenderGraphCompiledPass* FindPass(const CompiledRenderGraph& compiled, uint32_t passIndex)
+	{
+		for (const RenderGraphCompiledPass& pass : compiled.passes)
+		{
+			if (pass.passIndex == passIndex)
+				return &pass;
+		}
+
+		return nullptr;
+	}
+
+	std::vector<RenderGraphBarrier> BarriersOf(const CompiledRenderGraph& compiled, uint32_t passIndex, RenderGraphResource resource)
+	{
+		std::vector<RenderGraphBarrier> barriers;
+		if (const RenderGraphCompiledPass* pass = FindPass(compiled, passIndex))
+		{
+			for (const RenderGraphBarrier& barrier : pass->barriers)
+			{
+				if (barrier.resource == resource)
+					barriers.push_back(barrier);
+			}
+		}
+
+		return barriers;
+	}
+
+	// Appended rather than concatenated, which GCC 12 misreports under -Wrestrict
+	std::string NumberedName(const char* prefix, uint32_t number)
+	{
+		std::string name(prefix);
+		name += std::to_string(number);
+
+		return name;
+	}
+
+	// Records the transients of a compiled graph in the order they take over their memory, as a backend does at the end of a frame
+	void OccupyInUseOrder(TransientMemoryHistory& history, const CompiledRenderGraph& compiled, uint64_t firstId)
+	{
+		std::vector<RenderGraphTransientPlacement> placements = compiled.transients;
+		std::stable_sort(placements.begin(), placements.end(),
+			[](const RenderGraphTransientPlacement& lhs, const RenderGraphTransientPlacement& rhs) { return lhs.firstUse < rhs.firstUse; });
+
+		for (const RenderGraphTransientPlacement& placement : placements)
+			history.Occupy(placement.offset, placement.size, firstId + placement.resource);
+	}
+}
+
+TEST(RenderGraph, RejectsInvalidDeclarations)
+{
+	RenderGraph graph;
+
+	EXPECT_THROW(graph.CreateTransient("empty", 0, placementAlignment), std::invalid_argument);
+	EXPECT_THROW(graph.CreateTransient("unaligned", megabyte, 3), std::invalid_argument);
+
+	const uint32_t pass = graph.AddPass("pass");
+	EXPECT_THROW(graph.Read(pass, 42, ResourceState::PixelShaderResource), std::out_of_range);
+	EXPECT_THROW(graph.Write(pass, 42, ResourceState::RenderTarget), std::out_of_range);
+}
+
+TEST(RenderGraph, ReadingATransientBeforeWritingItThrows)
+{
+	RenderGraph graph;
+	const RenderGraphResource backBuffer = graph.ImportResource("back buffer", ResourceState::Present, ResourceState::Present);
+	const RenderGraphResource transient = graph.CreateTransient("transient", megabyte, placementAlignment);
+
+	const uint32_t pass = graph.AddPass("pass");
+	graph.Read(pass, transient, ResourceState::PixelShaderResource);
+	graph.Write(pass, backBuffer, ResourceState::RenderTarget);
+
+	EXPECT_THROW(graph.Compile(), std::logic_error);
+}
+
+TEST(RenderGraph, CullsPassesWhoseOutputIsNeverConsumed)
+{
+	RenderGraph graph;
+	const RenderGraphResource backBuffer = graph.ImportResource("back buffer", ResourceState::Present, ResourceState::Present);
+	const RenderGraphResource scene = graph.CreateTransient("scene", megabyte, placementAlignment);
+	const RenderGraphResource unusedA = graph.CreateTransient("unused a", megabyte, placementAlignment);
+	const RenderGraphResource unusedB = graph.CreateTransient("unused b", megabyte, placementAlignment);
+
+	const uint32_t scenePass = graph.AddPass("scene");
+	graph.Write(scenePass, scene, ResourceState::RenderTarget);
+
+	// A chain whose end is never read dies completely
+	const uint32_t deadA = graph.AddPass("dead a");
+	graph.Write(deadA, unusedA, ResourceState::RenderTarget);
+	const uint32_t deadB = graph.AddPass("dead b");
+	graph.Read(deadB, unusedA, ResourceState::PixelShaderResource);
+	graph.Write(deadB, unusedB, ResourceState::RenderTarget);
+
+	const uint32_t readback = graph.AddPass("readback", true);
+
+	const uint32_t present = graph.AddPass("present");
+	graph.Read(present, scene, ResourceState::PixelShaderResource);
+	graph.Write(present, backBuffer, ResourceState::RenderTarget);
+
+	const CompiledRenderGraph& compiled = graph.Compile();
+
+	EXPECT_EQ(compiled.culledPasses, (std::vector<uint32_t>{ deadA, deadB }));
+	ASSERT_EQ(compiled.passes.size(), 3u);
+	EXPECT_EQ(compiled.passes[0].passIndex, scenePass);
+	EXPECT_EQ(compiled.passes[1].passIndex, readback);
+	EXPECT_EQ(compiled.passes[2].passIndex, present);
+
+	// Transients of culled passes get no memory
+	EXPECT_EQ(compiled.transients.size(), 1u);
+	EXPECT_EQ(compiled.transients[0].resource, scene);
+}
+
+TEST(RenderGraph, AliasesTransientsWithDisjointLifetimes)
+{
+	RenderGraph graph;
+	const RenderGraphResource backBuffer = graph.ImportResource("back buffer", ResourceState::Present, ResourceState::Present);
+	const RenderGraphResource a = graph.CreateTransient("a", 4 * megabyte, placementAlignment);
+	const RenderGraphResource b = graph.CreateTransient("b", 4 * megabyte, placementAlignment);
+	const RenderGraphResource c = graph.CreateTransient("c", 4 * megabyte, placementAlignment);
+
+	const uint32_t passA = graph.AddPass("a");
+	graph.Write(passA, a, ResourceState::RenderTarget);
+	const uint32_t passB = graph.AddPass("b");
+	graph.Read(passB, a, ResourceState::PixelShaderResource);
+	graph.Write(passB, b, ResourceState::RenderTarget);
+	const uint32_t passC = graph.AddPass("c");
+	graph.Read(passC, b, ResourceState::PixelShaderResource);
+	graph.Write(passC, c, ResourceState::UnorderedAccess);
+	const uint32_t passD = graph.AddPass("d");
+	graph.Read(passD, c, ResourceState::PixelShaderResource);
+	graph.Write(passD, backBuffer, ResourceState::RenderTarget);
+
+	const CompiledRenderGraph& compiled = graph.Compile();
+
+	// a dies before c is born, so only two of the three are alive at once
+	EXPECT_EQ(compiled.transientMemoryUnaliased, 12 * megabyte);
+	EXPECT_EQ(compiled.transientMemoryAliased, 8 * megabyte);
+
+	// c takes over the memory of a, which has to be announced with an aliasing barrier
+	const std::vector<RenderGraphBarrier> cBarriers = BarriersOf(compiled, passC, c);
+	ASSERT_EQ(cBarriers.size(), 1u);
+	EXPECT_EQ(cBarriers[0].type, RenderGraphBarrier::Type::Aliasing);
+	EXPECT_EQ(cBarriers[0].aliasBefore, a);
+
+	// Transients are created in the state of their first use, so their first write needs no transition
+	for (const RenderGraphTransientPlacement& placement : compiled.transients)
+	{
+		if (placement.resource == c)
+		{
+			EXPECT_EQ(placement.initialState, ResourceState::UnorderedAccess);
+		}
+		else if (placement.resource == a)
+		{
+			EXPECT_EQ(placement.initialState, ResourceState::RenderTarget);
+		}
+	}
+}
+
+TEST(RenderGraph, OverlappingLifetimesNeverShareMemory)
+{
+	// Many transients with staggered lifetimes of different lengths
+	RenderGraph graph;
+	const RenderGraphResource backBuffer = graph.ImportResource("back buffer", ResourceState::Present, ResourceState::Present);
+
+	std::vector<RenderGraphResource> transients;
+	for (uint32_t i = 0; i < 24; i++)
+		transients.push_back(graph.CreateTransient(NumberedName("t", i), (1 + i % 5) * megabyte, placementAlignment << (i % 3)));
+
+	for (uint32_t i = 0; i < transients.size(); i++)
+	{
+		// Kept regardless of consumers so every lifetime ends where its last reader is
+		const uint32_t pass = graph.AddPass(NumberedName("p", i), true);
+		graph.Write(pass, transients[i], ResourceState::RenderTarget);
+		// Each pass also reads a transient written a few passes back, stretching its lifetime
+		for (uint32_t back = 1; back <= i % 4 && back <= i; back++)
+			graph.Read(pass, transients[i - back], ResourceState::PixelShaderResource);
+	}
+	const uint32_t present = graph.AddPass("present");
+	graph.Read(present, transients.back(), ResourceState::PixelShaderResource);
+	graph.Write(present, backBuffer, ResourceState::RenderTarget);
+
+	const CompiledRenderGraph& compiled = graph.Compile();
+
+	ASSERT_EQ(compiled.transients.size(), transients.size());
+	for (size_t i = 0; i < compiled.transients.size(); i++)
+	{
+		const RenderGraphTransientPlacement& lhs = compiled.transients[i];
+		EXPECT_LE(lhs.offset + lhs.size, compiled.transientMemoryAliased);
+
+		for (size_t j = i + 1; j < compiled.transients.size(); j++)
+		{
+			const RenderGraphTransientPlacement& rhs = compiled.transients[j];
+			const bool livesOverlap = lhs.firstUse <= rhs.lastUse && rhs.firstUse <= lhs.lastUse;
+			const bool memoryOverlaps = lhs.offset < rhs.offset + rhs.size && rhs.offset < lhs.offset + lhs.size;
+			EXPECT_FALSE(livesOverlap && memoryOverlaps) << graph.GetResourceName(lhs.resource) << " and " << graph.GetResourceName(rhs.resource);
+		}
+	}
+
+	EXPECT_LT(compiled.transientMemoryAliased, compiled.transientMemoryUnaliased);
+}
+
+TEST(RenderGraph, MergesConsecutiveReadersIntoOneTransition)
+{
+	RenderGraph graph;
+	const RenderGraphResource backBuffer = graph.ImportResource("back buffer", ResourceState::Present, ResourceState::Present);
+	const RenderGraphResource depth = graph.CreateTransient("depth", megabyte, placementAlignment);
+	const RenderGraphResource lit = graph.CreateTransient("lit", megabyte, placementAlignment);
+
+	const uint32_t prepass = graph.AddPass("depth prepass");
+	graph.Write(prepass, depth, ResourceState::DepthWrite);
+	const uint32_t lighting = graph.AddPass("lighting");
+	graph.Read(lighting, depth, ResourceState::NonPixelShaderResource);
+	graph.Write(lighting, lit, ResourceState::UnorderedAccess);
+	const uint32_t composite = graph.AddPass("composite");
+	graph.Read(composite, depth, ResourceState::PixelShaderResource);
+	graph.Read(composite, lit, ResourceState::PixelShaderResource);
+	graph.Write(composite, backBuffer, ResourceState::RenderTarget);
+
+	const CompiledRenderGraph& compiled = graph.Compile();
+
+	const std::vector<RenderGraphBarrier> lightingBarriers = BarriersOf(compiled, lighting, depth);
+	ASSERT_EQ(lightingBarriers.size(), 1u);
+	EXPECT_EQ(lightingBarriers[0].stateBefore, ResourceState::DepthWrite);
+	EXPECT_EQ(lightingBarriers[0].stateAfter, ResourceState::ShaderResource);
+
+	// The second reader is already covered by the merged read state
+	EXPECT_TRUE(BarriersOf(compiled, composite, depth).empty());
+}
+
+TEST(RenderGraph, SplitsTransitionsAcrossInterveningPasses)
+{
+	RenderGraph graph;
+	const RenderGraphResource backBuffer = graph.ImportResource("back buffer", ResourceState::Present, ResourceState::Present);
+	const RenderGraphResource shadow = graph.CreateTransient("shadow", megabyte, placementAlignment);
+	const RenderGraphResource other = graph.CreateTransient("other", megabyte, placementAlignment);
+
+	const uint32_t shadowPass = graph.AddPass("shadow");
+	graph.Write(shadowPass, shadow, ResourceState::DepthWrite);
+	const uint32_t unrelated = graph.AddPass("unrelated");
+	graph.Write(unrelated, other, ResourceState::RenderTarget);
+	const uint32_t consumer = graph.AddPass("consumer");
+	graph.Read(consumer, shadow, ResourceState::PixelShaderResource);
+	graph.Read(consumer, other, ResourceState::PixelShaderResource);
+	graph.Write(consumer, backBuffer, ResourceState::RenderTarget);
+
+	const CompiledRenderGraph& compiled = graph.Compile();
+
+	// The transition starts as soon as the shadow pass is done and is only waited on by its consumer
+	const std::vector<RenderGraphBarrier> begin = BarriersOf(compiled, unrelated, shadow);
+	ASSERT_EQ(begin.size(), 1u);
+	EXPECT_EQ(begin[0].split, RenderGraphBarrier::Split::Begin);
+	EXPECT_EQ(begin[0].stateAfter, ResourceState::PixelShaderResource);
+
+	const std::vector<RenderGraphBarrier> end = BarriersOf(compiled, consumer, shadow);
+	ASSERT_EQ(end.size(), 1u);
+	EXPECT_EQ(end[0].split, RenderGraphBarrier::Split::End);
+
+	// other is consumed by the very next pass, so there is nothing to overlap with
+	const std::vector<RenderGraphBarrier> adjacent = BarriersOf(compiled, consumer, other);
+	ASSERT_EQ(adjacent.size(), 1u);
+	EXPECT_EQ(adjacent[0].split, RenderGraphBarrier::Split::None);
+}
+
+TEST(RenderGraph, OrdersBackToBackUnorderedAccess)
+{
+	RenderGraph graph;
+	const RenderGraphResource buffer = graph.ImportResource("buffer", ResourceState::UnorderedAccess, ResourceState::UnorderedAccess);
+
+	const uint32_t first = graph.AddPass("first");
+	graph.Write(first, buffer, ResourceState::UnorderedAccess);
+	const uint32_t second = graph.AddPass("second");
+	graph.Write(second, buffer, ResourceState::UnorderedAccess);
+
+	const CompiledRenderGraph& compiled = graph.Compile();
+
+	EXPECT_TRUE(BarriersOf(compiled, first, buffer).empty());
+	const std::vector<RenderGraphBarrier> barriers = BarriersOf(compiled, second, buffer);
+	ASSERT_EQ(barriers.size(), 1u);
+	EXPECT_EQ(barriers[0].type, RenderGraphBarrier::Type::UnorderedAccess);
+	EXPECT_TRUE(compiled.finalBarriers.empty());
+}
+
+TEST(RenderGraph, ReturnsImportedResourcesToTheirFinalState)
+{
+	RenderGraph graph;
+	const RenderGraphResource backBuffer = graph.ImportResource("back buffer", ResourceState::Present, ResourceState::Present);
+
+	const uint32_t pass = graph.AddPass("draw");
+	graph.Write(pass, backBuffer, ResourceState::RenderTarget);
+
+	const CompiledRenderGraph& compiled = graph.Compile();
+
+	ASSERT_EQ(compiled.passes.size(), 1u);
+	ASSERT_EQ(compiled.passes[0].barriers.size(), 1u);
+	EXPECT_EQ(compiled.passes[0].barriers[0].stateBefore, ResourceState::Present);
+	EXPECT_EQ(compiled.passes[0].barriers[0].stateAfter, ResourceState::RenderTarget);
+
+	ASSERT_EQ(compiled.finalBarriers.size(), 1u);
+	EXPECT_EQ(compiled.finalBarriers[0].stateBefore, ResourceState::RenderTarget);
+	EXPECT_EQ(compiled.finalBarriers[0].stateAfter, ResourceState::Present);
+
+	EXPECT_EQ(compiled.barrierCount, 2u);
+	EXPECT_EQ(compiled.barrierBatchCount, 2u);
+}
+
+TEST(RenderGraph, ResetClearsTheGraph)
+{
+	RenderGraph graph;
+	graph.ImportResource("back buffer", ResourceState::Present, ResourceState::Present);
+	graph.AddPass("pass", true);
+	graph.Compile();
+
+	graph.Reset();
+
+	EXPECT_EQ(graph.GetPassCount(), 0u);
+	EXPECT_EQ(graph.GetResourceCount(), 0u);
+	EXPECT_TRUE(graph.GetCompiled().passes.empty());
+}
+
+TEST(TransientMemoryHistory, RejectsEmptyRangesAndReservedIds)
+{
+	TransientMemoryHistory history;
+	EXPECT_THROW(history.Occupy(0, 0, 1), std::invalid_argument);
+	EXPECT_THROW(history.Occupy(0, megabyte, TransientMemoryHistory::noOccupant), std::invalid_argument);
+	EXPECT_THROW(history.Occupy(0, megabyte, TransientMemoryHistory::severalOccupants), std::invalid_argument);
+	EXPECT_EQ(history.GetRangeCount(), 0u);
+}
+
+TEST(TransientMemoryHistory, NewOccupantsReplaceTheRangesTheyOverlap)
+{
+	TransientMemoryHistory history;
+	EXPECT_EQ(history.FindPreviousOccupant(0, megabyte, 1), TransientMemoryHistory::noOccupant);
+
+	history.Occupy(0, 4 * megabyte, 1);
+	history.Occupy(megabyte, 2 * megabyte, 2);
+	EXPECT_EQ(history.GetRangeCount(), 3u);
+
+	EXPECT_EQ(history.FindPreviousOccupant(0, megabyte, 3), 1u);
+	EXPECT_EQ(history.FindPreviousOccupant(megabyte, 2 * megabyte, 3), 2u);
+	EXPECT_EQ(history.FindPreviousOccupant(3 * megabyte, megabyte, 3), 1u);
+	EXPECT_EQ(history.FindPreviousOccupant(0, 4 * megabyte, 3), TransientMemoryHistory::severalOccupants);
+
+	// A resource does not wait for itself, only for whoever used its memory in between
+	EXPECT_EQ(history.FindPreviousOccupant(megabyte, 2 * megabyte, 2), TransientMemoryHistory::noOccupant);
+	EXPECT_EQ(history.FindPreviousOccupant(0, 4 * megabyte, 1), 2u);
+	EXPECT_EQ(history.FindPreviousOccupant(4 * megabyte, megabyte, 3), TransientMemoryHistory::noOccupant);
+
+	// Covering every range leaves a single one
+	history.Occupy(0, 8 * megabyte, 4);
+	EXPECT_EQ(history.GetRangeCount(), 1u);
+	EXPECT_EQ(history.FindPreviousOccupant(2 * megabyte, megabyte, 5), 4u);
+
+	history.Clear();
+	EXPECT_EQ(history.GetRangeCount(), 0u);
+	EXPECT_EQ(history.FindPreviousOccupant(0, 8 * megabyte, 5), TransientMemoryHistory::noOccupant);
+}
+
+TEST(TransientMemoryHistory, FirstUsersWaitForTheLastUserOfTheFrameBefore)
+{
+	// Frame 1 aliases two transients with disjoint lifetimes in the same memory
+	RenderGraph graph;
+	const RenderGraphResource backBuffer = graph.ImportResource("back buffer", ResourceState::Present, ResourceState::Present);
+	const RenderGraphResource first = graph.CreateTransient("first", 2 * megabyte, placementAlignment);
+	const RenderGraphResource second = graph.CreateTransient("second", 2 * megabyte, placementAlignment);
+
+	const uint32_t writeFirst = graph.AddPass("write first", true);
+	graph.Write(writeFirst, first, ResourceState::RenderTarget);
+	const uint32_t writeSecond = graph.AddPass("write second");
+	graph.Write(writeSecond, second, ResourceState::RenderTarget);
+	const uint32_t present = graph.AddPass("present");
+	graph.Read(present, second, ResourceState::PixelShaderResource);
+	graph.Write(present, backBuffer, ResourceState::RenderTarget);
+
+	// Copied, the graph is rebuilt for the next frame
+	const CompiledRenderGraph firstFrame = graph.Compile();
+	ASSERT_EQ(firstFrame.transients.size(), 2u);
+	ASSERT_EQ(firstFrame.transientMemoryAliased, 2 * megabyte);
+
+	TransientMemoryHistory history;
+	const uint64_t firstFrameIds = 1;
+	OccupyInUseOrder(history, firstFrame, firstFrameIds);
+
+	// Frame 2 puts one larger transient over both
+	graph.Reset();
+	graph.ImportResource("back buffer", ResourceState::Present, ResourceState::Present);
+	const RenderGraphResource large = graph.CreateTransient("large", 4 * megabyte, placementAlignment);
+	const uint32_t writeLarge = graph.AddPass("write large", true);
+	graph.Write(writeLarge, large, ResourceState::UnorderedAccess);
+
+	const CompiledRenderGraph& secondFrame = graph.Compile();
+	ASSERT_EQ(secondFrame.transients.size(), 1u);
+	const RenderGraphTransientPlacement& placement = secondFrame.transients[0];
+	const uint64_t secondFrameIds = 100;
+
+	// Nothing in the compiled plan orders it against the previous frame
+	for (const RenderGraphBarrier& barrier : BarriersOf(secondFrame, writeLarge, large))
+		EXPECT_NE(barrier.type, RenderGraphBarrier::Type::Aliasing);
+
+	// Its memory was last used by the later of the two transients of frame 1
+	EXPECT_EQ(history.FindPreviousOccupant(placement.offset, placement.size, secondFrameIds + large), firstFrameIds + second);
+	OccupyInUseOrder(history, secondFrame, secondFrameIds);
+
+	// The same resource reused by frame 3 took the memory over in frame 2 and needs nothing more
+	EXPECT_EQ(history.FindPreviousOccupant(placement.offset, placement.size, secondFrameIds + large), TransientMemoryHistory::noOccupant);
+}
@@ -0,0 +1,279 @@
+#include <gtest/gtest.h>
+
+#include <map>
+#include <random>
+#include <stdexcept>
+#include <vector>
+
+#include <ResourceStateTracker.h>
+
+using namespace UltReality::Rendering::Common;
+
+namespace
+{
+	// Replays recorded barrier streams the way the GPU would see them, failing on any barrier whose before state is
+	// wrong and on any use of a resource that is not in a state that allows it
+	class SimulatedQueue
+	{
+	private:
+		std::map<TrackedResource, ResourceState> m_states;
+		// Target of split transitions that were begun but not ended
+		std::map<TrackedResource, ResourceState> m_splits;
+
+	public:
+		uint64_t executedBarriers = 0;
+
+		void Register(TrackedResource resource, ResourceState state)
+		{
+			m_states[resource] = state;
+		}
+
+		void Execute(const std::vector<TrackedBarrier>& barriers)
+		{
+			for (const TrackedBarrier& barrier : barriers)
+			{
+				executedBarriers++;
+				if (barrier.type == TrackedBarrier::Type::UnorderedAccess)
+					continue;
+
+				switch (barrier.split)
+				{
+				case TrackedBarrier::Split::None:
+					ASSERT_EQ(m_splits.count(barrier.resource), 0u) << "transition of resource " << barrier.resource << " during a split";
+					ASSERT_EQ(m_states[barrier.resource], barrier.stateBefore) << "wrong before state for resource " << barrier.resource;
+					m_states[barrier.resource] = barrier.stateAfter;
+					break;
+				case TrackedBarrier::Split::Begin:
+					ASSERT_EQ(m_states[barrier.resource], barrier.stateBefore) << "wrong before state for resource " << barrier.resource;
+					m_splits[barrier.resource] = barrier.stateAfter;
+					break;
+				case TrackedBarrier::Split::End:
+					ASSERT_EQ(m_splits.count(barrier.resource), 1u) << "split end without begin for resource " << barrier.resource;
+					ASSERT_EQ(m_splits[barrier.resource], barrier.stateAfter);
+					m_states[barrier.resource] = barrier.stateAfter;
+					m_splits.erase(barrier.resource);
+					break;
+				}
+			}
+		}
+
+		void Use(TrackedResource resource, ResourceState state)
+		{
+			ASSERT_EQ(m_splits.count(resource), 0u) << "resource " << resource << " used while its split transition is in flight";
+			ASSERT_TRUE(StateSatisfies(m_states[resource], state)) << "resource " << resource << " used in state "
+				<< static_cast<uint32_t>(state) << " while in " << static_cast<uint32_t>(m_states[resource]);
+		}
+
+		ResourceState Get(TrackedResource resource)
+		{
+			return m_states[resource];
+		}
+	};
+
+	// One command recorded into a list: the resource it uses and the state it needs
+	struct RecordedUse
+	{
+		TrackedResource resource;
+		ResourceState state;
+		// Barriers flushed right before the command
+		std::vector<TrackedBarrier> barriers;
+	};
+
+	constexpr ResourceState useStates[] =
+	{
+		ResourceState::RenderTarget,
+		ResourceState::UnorderedAccess,
+		ResourceState::PixelShaderResource,
+		ResourceState::NonPixelShaderResource,
+		ResourceState::CopySource,
+		ResourceState::CopyDest,
+		ResourceState::IndirectArgument,
+	};
+}
+
+TEST(ResourceStateTable, TracksRegisteredResources)
+{
+	ResourceStateTable table;
+	table.Register(1, ResourceState::Present);
+
+	EXPECT_TRUE(table.IsRegistered(1));
+	EXPECT_EQ(table.Get(1), ResourceState::Present);
+
+	table.Set(1, ResourceState::RenderTarget);
+	EXPECT_EQ(table.Get(1), ResourceState::RenderTarget);
+
+	table.Unregister(1);
+	EXPECT_FALSE(table.IsRegistered(1));
+	EXPECT_THROW(table.Get(1), std::out_of_range);
+	EXPECT_THROW(table.Set(1, ResourceState::Common), std::out_of_range);
+	EXPECT_EQ(table.GetCount(), 0u);
+}
+
+TEST(ResourceStateTracker, DropsRedundantAndMergesQueuedTransitions)
+{
+	ResourceStateTable table;
+	table.Register(1, ResourceState::Present);
+
+	ResourceStateTracker tracker;
+	std::vector<TrackedBarrier> barriers;
+
+	// The first use is only known at submission, so nothing is flushed for it
+	tracker.Transition(1, ResourceState::RenderTarget);
+	EXPECT_EQ(tracker.Flush(barriers), 0u);
+
+	tracker.Transition(1, ResourceState::RenderTarget);
+	EXPECT_EQ(tracker.GetDroppedCount(), 1u);
+
+	// Transitions queued without a use in between collapse into one, and read states combine
+	tracker.Transition(1, ResourceState::CopySource);
+	tracker.Transition(1, ResourceState::PixelShaderResource);
+	tracker.Transition(1, ResourceState::NonPixelShaderResource);
+	ASSERT_EQ(tracker.Flush(barriers), 1u);
+	EXPECT_EQ(barriers[0].stateBefore, ResourceState::RenderTarget);
+	EXPECT_EQ(barriers[0].stateAfter, ResourceState::CopySource | ResourceState::PixelShaderResource | ResourceState::NonPixelShaderResource);
+	EXPECT_EQ(tracker.GetMergedCount(), 2u);
+
+	// A round trip that nothing used in between is dropped entirely
+	barriers.clear();
+	tracker.Transition(1, ResourceState::RenderTarget);
+	tracker.Transition(1, ResourceState::CopySource | ResourceState::PixelShaderResource | ResourceState::NonPixelShaderResource);
+	EXPECT_EQ(tracker.Flush(barriers), 0u);
+	EXPECT_FALSE(tracker.HasQueuedBarriers());
+}
+
+TEST(ResourceStateTracker, SplitsTransitionsAroundIndependentWork)
+{
+	ResourceStateTable table;
+	table.Register(2, ResourceState::DepthWrite);
+
+	ResourceStateTracker tracker;
+	std::vector<TrackedBarrier> barriers;
+
+	// A split needs a before state the list recorded itself, so the first use is a clear before the depth pass
+	tracker.Transition(2, ResourceState::CopyDest);
+	tracker.Transition(2, ResourceState::DepthWrite);
+	ASSERT_EQ(tracker.Flush(barriers), 1u);
+
+	barriers.clear();
+	tracker.BeginTransition(2, ResourceState::PixelShaderResource);
+	ASSERT_EQ(tracker.Flush(barriers), 1u);
+	EXPECT_EQ(barriers[0].split, TrackedBarrier::Split::Begin);
+	EXPECT_EQ(barriers[0].stateBefore, ResourceState::DepthWrite);
+
+	barriers.clear();
+	tracker.Transition(2, ResourceState::PixelShaderResource);
+	ASSERT_EQ(tracker.Flush(barriers), 1u);
+	EXPECT_EQ(barriers[0].split, TrackedBarrier::Split::End);
+	EXPECT_EQ(barriers[0].stateBefore, ResourceState::DepthWrite);
+	EXPECT_EQ(barriers[0].stateAfter, ResourceState::PixelShaderResource);
+	EXPECT_EQ(tracker.GetSplitCount(), 1u);
+
+	// Without a known state there is nothing to split from, the begin falls back to a pending first use
+	ResourceStateTracker fresh;
+	fresh.BeginTransition(3, ResourceState::CopySource);
+	barriers.clear();
+	EXPECT_EQ(fresh.Flush(barriers), 0u);
+	EXPECT_EQ(fresh.GetSplitCount(), 0u);
+}
+
+TEST(ResourceStateTracker, ResolvesFirstUsesAgainstTheCommittedState)
+{
+	ResourceStateTable table;
+	table.Register(1, ResourceState::Present);
+	table.Register(2, ResourceState::DepthWrite);
+	table.Register(3, ResourceState::ShaderResource);
+
+	ResourceStateTracker tracker;
+	tracker.Transition(1, ResourceState::RenderTarget);
+	tracker.Transition(2, ResourceState::DepthWrite);
+	tracker.Transition(3, ResourceState::PixelShaderResource);
+
+	std::vector<TrackedBarrier> barriers;
+	ASSERT_EQ(tracker.ResolvePending(table, barriers), 1u);
+	EXPECT_EQ(barriers[0].resource, 1u);
+	EXPECT_EQ(barriers[0].stateBefore, ResourceState::Present);
+	EXPECT_EQ(barriers[0].stateAfter, ResourceState::RenderTarget);
+
+	tracker.Commit(table);
+	EXPECT_EQ(table.Get(1), ResourceState::RenderTarget);
+	EXPECT_EQ(table.Get(2), ResourceState::DepthWrite);
+	// A read state that covers the use is kept rather than narrowed
+	EXPECT_EQ(table.Get(3), ResourceState::ShaderResource);
+
+	tracker.Reset();
+	EXPECT_FALSE(tracker.HasQueuedBarriers());
+	barriers.clear();
+	EXPECT_EQ(tracker.ResolvePending(table, barriers), 0u);
+}
+
+TEST(ResourceStateTracker, RecordedStreamsReplayWithoutStateErrors)
+{
+	constexpr TrackedResource resourceCount = 12;
+	std::mt19937 random(3);
+
+	ResourceStateTable table;
+	SimulatedQueue queue;
+	for (TrackedResource resource = 1; resource <= resourceCount; resource++)
+	{
+		table.Register(resource, ResourceState::Common);
+		queue.Register(resource, ResourceState::Common);
+	}
+
+	uint64_t recordedTransitions = 0;
+	uint64_t splitCount = 0;
+	for (int list = 0; list < 200; list++)
+	{
+		// Record a command list on its own tracker, as a recording job would
+		ResourceStateTracker tracker;
+		std::vector<RecordedUse> commands;
+		for (int command = 0; command < 40; command++)
+		{
+			const TrackedResource resource = 1 + random() % resourceCount;
+			const ResourceState state = useStates[random() % std::size(useStates)];
+
+			// Sometimes start the transition early and record unrelated work before the use
+			if (random() % 4 == 0)
+			{
+				tracker.BeginTransition(resource, state);
+				recordedTransitions++;
+
+				const TrackedResource other = 1 + (resource % resourceCount);
+				tracker.Transition(other, ResourceState::CopySource);
+				RecordedUse otherUse{ other, ResourceState::CopySource, {} };
+				tracker.Flush(otherUse.barriers);
+				commands.push_back(std::move(otherUse));
+			}
+
+			tracker.Transition(resource, state);
+			recordedTransitions++;
+			if (state == ResourceState::UnorderedAccess)
+				tracker.UAVBarrier(resource);
+
+			RecordedUse use{ resource, state, {} };
+			tracker.Flush(use.barriers);
+			commands.push_back(std::move(use));
+		}
+
+		// Submission: the fix-up barriers run ahead of the list, then the table learns the list's final states
+		std::vector<TrackedBarrier> fixUp;
+		tracker.ResolvePending(table, fixUp);
+		tracker.Commit(table);
+		splitCount += tracker.GetSplitCount();
+
+		queue.Execute(fixUp);
+		ASSERT_FALSE(HasFatalFailure()) << "list " << list;
+		for (const RecordedUse& use : commands)
+		{
+			queue.Execute(use.barriers);
+			queue.Use(use.resource, use.state);
+			ASSERT_FALSE(HasFatalFailure()) << "list " << list;
+		}
+
+		for (TrackedResource resource = 1; resource <= resourceCount; resource++)
+			ASSERT_EQ(queue.Get(resource), table.Get(resource)) << "committed state of resource " << resource << " after list " << list;
+	}
+
+	// Redundant and mergeable transitions are common in random streams, the tracker must have removed some
+	EXPECT_LT(queue.executedBarriers, recordedTransitions);
+	EXPECT_GT(splitCount, 0u);
+}
@@ -0,0 +1,331 @@
+#include <gtest/gtest.h>
+
+#include <atomic>
+#include <filesystem>
+#include <fstream>
+#include <map>
+#include <mutex>
+#include <string>
+#include <vector>
+
+#include <ShaderCache.h>
+
+using namespace UltReality::Rendering::Common;
+
+namespace
+{
+	// Source tree held in memory. Include names are the paths, so every file can include every other
+	class InMemoryIncludeResolver : public IShaderIncludeResolver
+	{
+	private:
+		std::mutex m_mutex;
+		std::map<std::string, std::string> m_files;
+
+	public:
+		void Set(const std::string& path, const std::string& contents)
+		{
+			std::lock_guard<std::mutex> lock(m_mutex);
+			m_files[path] = contents;
+		}
+
+		std::string Resolve(const std::string&, const std::string& include) override
+		{
+			std::lock_guard<std::mutex> lock(m_mutex);
+			return m_files.count(include) != 0 ? include : std::string();
+		}
+
+		bool Read(const std::string& path, std::string& contents) override
+		{
+			std::lock_guard<std::mutex> lock(m_mutex);
+			auto it = m_files.find(path);
+			if (it == m_files.end())
+				return false;
+
+			contents = it->second;
+			return true;
+		}
+	};
+
+	// Produces the source text as bytecode, and fails on sources containing "error"
+	class FakeShaderCompiler : public IShaderCompiler
+	{
+	public:
+		std::atomic<uint32_t> compileCount{ 0 };
+
+		uint64_t GetVersionHash() const override { return 0x1111; }
+
+		bool Compile(const ShaderCompileRequest&, const std::string& source, IShaderIncludeResolver&,
+			std::vector<uint8_t>& bytecode, std::string& messages) override
+		{
+			compileCount++;
+			if (source.find("error") != std::string::npos)
+			{
+				messages = "syntax error";
+				return false;
+			}
+
+			bytecode.assign(source.begin(), source.end());
+			return true;
+		}
+	};
+
+	ShaderCompileRequest MakeRequest(const std::string& sourcePath)
+	{
+		ShaderCompileRequest request;
+		request.sourcePath = sourcePath;
+		request.entryPoint = "main";
+		request.target = "ps_6_0";
+
+		return request;
+	}
+
+	std::string ToString(const ShaderBlob& blob)
+	{
+		return std::string(reinterpret_cast<const char*>(blob.data), blob.size);
+	}
+
+	// Cache directory that is empty when the test starts and removed when it ends
+	class ShaderCacheDirectory
+	{
+	public:
+		const std::filesystem::path path;
+
+		explicit ShaderCacheDirectory(const char* name)
+			: path(std::filesystem::temp_directory_path() / (std::string("RenderCommonTests_") + name))
+		{
+			std::filesystem::remove_all(path);
+		}
+
+		~ShaderCacheDirectory()
+		{
+			std::error_code error;
+			std::filesystem::remove_all(path, error);
+		}
+
+		std::vector<std::filesystem::path> GetBlobFiles() const
+		{
+			std::vector<std::filesystem::path> files;
+			for (const std::filesystem::directory_entry& entry : std::filesystem::directory_iterator(path))
+			{
+				if (entry.path().extension() == ShaderCache::fileExtension)
+					files.push_back(entry.path());
+			}
+
+			return files;
+		}
+	};
+}
+
+TEST(ShaderCompiler, ScansIncludesOutsideCommentsAndStrings)
+{
+	const std::vector<std::string> includes = ScanShaderIncludes(
+		"// #include \"commented.hlsli\"\n"
+		"#include \"common.hlsli\"\n"
+		"/* #include \"block.hlsli\" */ # include <lighting.hlsli>\n"
+		"static const char* text = \"#include <string.hlsli>\";\n"
+		"\t#include \"indented.hlsli\"\n");
+
+	EXPECT_EQ(includes, (std::vector<std::string>{ "common.hlsli", "lighting.hlsli", "indented.hlsli" }));
+}
+
+TEST(ShaderCache, KeyCoversRequestAndIncludeClosure)
+{
+	InMemoryIncludeResolver resolver;
+	resolver.Set("shader.hlsl", "#include \"common.hlsli\"\n#include \"optional.hlsli\"\nfloat4 main() : SV_Target { return 0; }\n");
+	resolver.Set("common.hlsli", "#include \"math.hlsli\"\n#include \"common.hlsli\"\n");
+	resolver.Set("math.hlsli", "#define PI 3.14159\n");
+	resolver.Set("unrelated.hlsli", "#define UNUSED 1\n");
+
+	FakeShaderCompiler compiler;
+	ShaderCache cache({}, &compiler, &resolver);
+
+	const ShaderCompileRequest request = MakeRequest("shader.hlsl");
+	const uint64_t key = cache.ComputeKey(request);
+	EXPECT_EQ(cache.ComputeKey(request), key);
+
+	// Every part of the request is part of the key
+	ShaderCompileRequest changed = request;
+	changed.entryPoint = "mainAlt";
+	EXPECT_NE(cache.ComputeKey(changed), key);
+	changed = request;
+	changed.target = "ps_6_6";
+	EXPECT_NE(cache.ComputeKey(changed), key);
+	changed = request;
+	changed.defines.push_back({ "SHADOWS", "" });
+	EXPECT_NE(cache.ComputeKey(changed), key);
+	changed = request;
+	changed.arguments.push_back("-O3");
+	EXPECT_NE(cache.ComputeKey(changed), key);
+
+	// A compiler without a version identifies differently
+	ShaderCache storedOnly({}, nullptr, &resolver);
+	EXPECT_NE(storedOnly.ComputeKey(request), key);
+
+	// Files outside the closure do not matter, nested includes do
+	resolver.Set("unrelated.hlsli", "#define UNUSED 2\n");
+	EXPECT_EQ(cache.ComputeKey(request), key);
+
+	resolver.Set("math.hlsli", "#define PI 3.1415926\n");
+	const uint64_t editedKey = cache.ComputeKey(request);
+	EXPECT_NE(editedKey, key);
+
+	// Creating an include that was missing invalidates the shader too
+	resolver.Set("optional.hlsli", "");
+	EXPECT_NE(cache.ComputeKey(request), editedKey);
+
+	EXPECT_THROW(cache.ComputeKey(MakeRequest("missing.hlsl")), std::runtime_error);
+}
+
+TEST(ShaderCache, CompilesMissesOnceAndReportsFailures)
+{
+	InMemoryIncludeResolver resolver;
+	resolver.Set("a.hlsl", "float4 a() : SV_Target { return 0; }\n");
+	resolver.Set("b.hlsl", "float4 b() : SV_Target { return 1; }\n");
+	resolver.Set("broken.hlsl", "error\n");
+
+	FakeShaderCompiler compiler;
+	ShaderCache cache({}, &compiler, &resolver);
+	JobSystem jobSystem(2);
+
+	std::vector<ShaderCompileRequest> requests;
+	for (int variant = 0; variant < 16; variant++)
+	{
+		requests.push_back(MakeRequest(variant % 2 == 0 ? "a.hlsl" : "b.hlsl"));
+		requests.back().defines.push_back({ "VARIANT", std::to_string(variant) });
+	}
+	requests.push_back(MakeRequest("broken.hlsl"));
+	requests.push_back(MakeRequest("missing.hlsl"));
+
+	const std::vector<ShaderCompileResult> first = cache.Compile(requests, jobSystem);
+	ASSERT_EQ(first.size(), requests.size());
+	for (size_t i = 0; i < 16; i++)
+	{
+		EXPECT_TRUE(first[i].blob);
+		EXPECT_FALSE(first[i].cacheHit);
+		EXPECT_EQ(first[i].key, cache.ComputeKey(requests[i]));
+	}
+	EXPECT_EQ(ToString(first[1].blob), "float4 b() : SV_Target { return 1; }\n");
+
+	EXPECT_FALSE(first[16].blob);
+	EXPECT_EQ(first[16].messages, "syntax error");
+	EXPECT_FALSE(first[17].blob);
+	EXPECT_EQ(first[17].key, 0u);
+	EXPECT_FALSE(first[17].messages.empty());
+
+	const std::vector<ShaderCompileResult> second = cache.Compile(requests, jobSystem);
+	for (size_t i = 0; i < 16; i++)
+	{
+		EXPECT_TRUE(second[i].cacheHit);
+		EXPECT_EQ(second[i].blob.data, first[i].blob.data);
+	}
+
+	// The broken shader is retried, everything else came from the cache
+	EXPECT_EQ(compiler.compileCount.load(), 18u);
+
+	const ShaderCache::Statistics statistics = cache.GetStatistics();
+	EXPECT_EQ(statistics.compileCount, 16u);
+	EXPECT_EQ(statistics.cacheHits, 16u);
+	EXPECT_EQ(statistics.failedCount, 4u);
+	EXPECT_EQ(cache.GetBlobCount(), 16u);
+}
+
+TEST(ShaderCache, ServesStoredBlobsAcrossRuns)
+{
+	ShaderCacheDirectory directory("ShaderCacheStored");
+
+	InMemoryIncludeResolver resolver;
+	resolver.Set("shader.hlsl", "#include \"lib.hlsli\"\nfloat4 main() : SV_Target { return 0; }\n");
+	resolver.Set("lib.hlsli", "#define VALUE 1\n");
+
+	FakeShaderCompiler compiler;
+	JobSystem jobSystem(1);
+	const std::vector<ShaderCompileRequest> requests = { MakeRequest("shader.hlsl") };
+
+	uint64_t key;
+	{
+		ShaderCache cache(directory.path.string(), &compiler, &resolver);
+		key = cache.Compile(requests, jobSystem)[0].key;
+		cache.Store(0xABCD, { 1, 2, 3 });
+	}
+	EXPECT_EQ(directory.GetBlobFiles().size(), 2u);
+
+	{
+		ShaderCache cache(directory.path.string(), &compiler, &resolver);
+		EXPECT_EQ(cache.GetStatistics().mappedFiles, 2u);
+
+		const std::vector<ShaderCompileResult> results = cache.Compile(requests, jobSystem);
+		EXPECT_TRUE(results[0].cacheHit);
+		EXPECT_EQ(results[0].key, key);
+		EXPECT_EQ(compiler.compileCount.load(), 1u);
+		EXPECT_EQ(ToString(results[0].blob), "#include \"lib.hlsli\"\nfloat4 main() : SV_Target { return 0; }\n");
+	}
+
+	// Without a compiler stored blobs are still served by key
+	{
+		ShaderCache cache(directory.path.string(), nullptr, &resolver);
+		const ShaderBlob blob = cache.Find(0xABCD);
+		ASSERT_TRUE(blob);
+		EXPECT_EQ(std::vector<uint8_t>(blob.data, blob.data + blob.size), (std::vector<uint8_t>{ 1, 2, 3 }));
+
+		const std::vector<ShaderCompileResult> results = cache.Compile(requests, jobSystem);
+		EXPECT_FALSE(results[0].blob);
+		EXPECT_FALSE(results[0].messages.empty());
+	}
+}
+
+TEST(ShaderCache, InvalidatedAndDamagedBlobsAreRemoved)
+{
+	ShaderCacheDirectory directory("ShaderCacheInvalidation");
+
+	InMemoryIncludeResolver resolver;
+	resolver.Set("shader.hlsl", "#include \"lib.hlsli\"\nfloat4 main() : SV_Target { return 0; }\n");
+	resolver.Set("other.hlsl", "float4 other() : SV_Target { return 1; }\n");
+	resolver.Set("lib.hlsli", "#define VALUE 1\n");
+
+	FakeShaderCompiler compiler;
+	JobSystem jobSystem(1);
+	const std::vector<ShaderCompileRequest> requests = { MakeRequest("shader.hlsl"), MakeRequest("other.hlsl") };
+
+	uint64_t oldKey;
+	{
+		ShaderCache cache(directory.path.string(), &compiler, &resolver);
+		oldKey = cache.Compile(requests, jobSystem)[0].key;
+	}
+
+	// Editing the include gives the shader a new key, the old blob is never looked up again
+	resolver.Set("lib.hlsli", "#define VALUE 2\n");
+	{
+		ShaderCache cache(directory.path.string(), &compiler, &resolver);
+		const std::vector<ShaderCompileResult> results = cache.Compile(requests, jobSystem);
+		EXPECT_FALSE(results[0].cacheHit);
+		EXPECT_NE(results[0].key, oldKey);
+		EXPECT_TRUE(results[1].cacheHit);
+
+		EXPECT_EQ(cache.RemoveUnused(), 1u);
+		EXPECT_FALSE(cache.Find(oldKey));
+	}
+	ASSERT_EQ(directory.GetBlobFiles().size(), 2u);
+
+	// Flip a bytecode byte of every blob, the checksum rejects them on lookup and they are compiled again
+	for (const std::filesystem::path& file : directory.GetBlobFiles())
+	{
+		std::fstream stream(file, std::ios::in | std::ios::out | std::ios::binary);
+		stream.seekp(40);
+		stream.put('#');
+	}
+	// A file that is not even a full header is dropped when the directory is mapped
+	std::ofstream(directory.path / ("0000000000000001" + std::string(ShaderCache::fileExtension)), std::ios::binary) << "torn";
+
+	{
+		const uint32_t compiledBefore = compiler.compileCount.load();
+		ShaderCache cache(directory.path.string(), &compiler, &resolver);
+		EXPECT_EQ(cache.GetStatistics().rejectedFiles, 1u);
+
+		const std::vector<ShaderCompileResult> results = cache.Compile(requests, jobSystem);
+		EXPECT_FALSE(results[0].cacheHit);
+		EXPECT_FALSE(results[1].cacheHit);
+		EXPECT_EQ(compiler.compileCount.load(), compiledBefore + 2);
+		EXPECT_EQ(cache.GetStatistics().rejectedFiles, 3u);
+		EXPECT_EQ(ToString(results[1].blob), "float4 other() : SV_Target { return 1; }\n");
+	}
+}
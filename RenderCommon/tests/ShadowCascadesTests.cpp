@@ -0,0 +1,295 @@
+#include <gtest/gtest.h>
+
+#include <cmath>
+#include <random>
+#include <stdexcept>
+
+#include <ShadowCascades.h>
+
+using namespace UltReality::Rendering::Common;
+
+namespace
+{
+	void TransformPoint(const float matrix[16], const float point[3], float result[4])
+	{
+		for (uint32_t j = 0; j < 4; j++)
+			result[j] = point[0] * matrix[j] + point[1] * matrix[4 + j] + point[2] * matrix[8 + j] + matrix[12 + j];
+	}
+
+	// Camera at position looking along forward, with a world up of +y
+	ShadowCamera LookingCamera(const float position[3], const float forward[3], float verticalFov, float aspectRatio, float farZ)
+	{
+		const float worldUp[3] = { 0.0f, 1.0f, 0.0f };
+		float right[3] = {
+			worldUp[1] * forward[2] - worldUp[2] * forward[1],
+			worldUp[2] * forward[0] - worldUp[0] * forward[2],
+			worldUp[0] * forward[1] - worldUp[1] * forward[0]
+		};
+		const float length = std::sqrt(right[0] * right[0] + right[1] * right[1] + right[2] * right[2]);
+		for (float& value : right)
+			value /= length;
+
+		const float up[3] = {
+			forward[1] * right[2] - forward[2] * right[1],
+			forward[2] * right[0] - forward[0] * right[2],
+			forward[0] * right[1] - forward[1] * right[0]
+		};
+
+		ShadowCamera camera;
+		for (uint32_t i = 0; i < 3; i++)
+		{
+			camera.cameraToWorld[i] = right[i];
+			camera.cameraToWorld[4 + i] = up[i];
+			camera.cameraToWorld[8 + i] = forward[i];
+			camera.cameraToWorld[12 + i] = position[i];
+		}
+		camera.cameraToWorld[15] = 1.0f;
+		camera.verticalFov = verticalFov;
+		camera.aspectRatio = aspectRatio;
+		camera.nearZ = 0.1f;
+		camera.farZ = farZ;
+
+		return camera;
+	}
+
+	// Corner of the camera's frustum slice at view depth z, corner bits selecting right and top
+	void SliceCorner(const ShadowCamera& camera, float z, uint32_t corner, float point[3])
+	{
+		const float tanY = std::tan(camera.verticalFov * 0.5f);
+		const float x = ((corner & 1) != 0 ? 1.0f : -1.0f) * tanY * camera.aspectRatio * z;
+		const float y = ((corner & 2) != 0 ? 1.0f : -1.0f) * tanY * z;
+		for (uint32_t i = 0; i < 3; i++)
+			point[i] = camera.cameraToWorld[12 + i] + camera.cameraToWorld[i] * x + camera.cameraToWorld[4 + i] * y + camera.cameraToWorld[8 + i] * z;
+	}
+
+	uint32_t DirtyCount(const ShadowCascadeSet& set)
+	{
+		uint32_t dirty = 0;
+		for (uint32_t cascade = 0; cascade < set.GetCascadeCount(); cascade++)
+			dirty += set.GetCascade(cascade).staticDirty ? 1 : 0;
+
+		return dirty;
+	}
+
+	void MarkAllRendered(ShadowCascadeSet& set)
+	{
+		for (uint32_t cascade = 0; cascade < set.GetCascadeCount(); cascade++)
+			set.MarkStaticRendered(cascade);
+	}
+}
+
+TEST(ShadowCascades, SplitsBlendUniformAndLogarithmicSchemes)
+{
+	float splits[maxShadowCascades];
+
+	ComputeCascadeSplits(1.0f, 9.0f, 4, 0.0f, splits);
+	EXPECT_NEAR(splits[0], 3.0f, 1e-5f);
+	EXPECT_NEAR(splits[1], 5.0f, 1e-5f);
+	EXPECT_NEAR(splits[2], 7.0f, 1e-5f);
+	EXPECT_EQ(splits[3], 9.0f);
+
+	ComputeCascadeSplits(1.0f, 16.0f, 4, 1.0f, splits);
+	EXPECT_NEAR(splits[0], 2.0f, 1e-4f);
+	EXPECT_NEAR(splits[1], 4.0f, 1e-4f);
+	EXPECT_NEAR(splits[2], 8.0f, 1e-4f);
+	EXPECT_EQ(splits[3], 16.0f);
+
+	// The blend lies between both schemes
+	ComputeCascadeSplits(1.0f, 16.0f, 4, 0.5f, splits);
+	EXPECT_NEAR(splits[0], (2.0f + 4.75f) * 0.5f, 1e-4f);
+	EXPECT_EQ(splits[3], 16.0f);
+
+	ComputeCascadeSplits(0.1f, 100.0f, 4, 0.75f, splits);
+	EXPECT_GT(splits[0], 0.1f);
+	EXPECT_LT(splits[0], splits[1]);
+	EXPECT_LT(splits[1], splits[2]);
+	EXPECT_LT(splits[2], splits[3]);
+
+	EXPECT_THROW(ComputeCascadeSplits(0.0f, 1.0f, 4, 0.5f, splits), std::invalid_argument);
+	EXPECT_THROW(ComputeCascadeSplits(2.0f, 1.0f, 4, 0.5f, splits), std::invalid_argument);
+	EXPECT_THROW(ComputeCascadeSplits(0.1f, 1.0f, 0, 0.5f, splits), std::invalid_argument);
+	EXPECT_THROW(ComputeCascadeSplits(0.1f, 1.0f, maxShadowCascades + 1, 0.5f, splits), std::invalid_argument);
+}
+
+TEST(ShadowCascades, SettingsAreValidatedAndLaidOutInTheAtlas)
+{
+	auto withSettings = [](auto change)
+	{
+		ShadowCascadeSettings settings;
+		change(settings);
+		return settings;
+	};
+
+	EXPECT_THROW(ShadowCascadeSet(withSettings([](ShadowCascadeSettings& s) { s.cascadeCount = 0; })), std::invalid_argument);
+	EXPECT_THROW(ShadowCascadeSet(withSettings([](ShadowCascadeSettings& s) { s.cascadeCount = maxShadowCascades + 1; })), std::invalid_argument);
+	EXPECT_THROW(ShadowCascadeSet(withSettings([](ShadowCascadeSettings& s) { s.cascadeResolution = 0; })), std::invalid_argument);
+	EXPECT_THROW(ShadowCascadeSet(withSettings([](ShadowCascadeSettings& s) { s.splitLambda = 1.5f; })), std::invalid_argument);
+	EXPECT_THROW(ShadowCascadeSet(withSettings([](ShadowCascadeSettings& s) { s.cachePadding = 0.9f; })), std::invalid_argument);
+	EXPECT_THROW(ShadowCascadeSet(withSettings([](ShadowCascadeSettings& s) { s.maxLightAngle = -1.0f; })), std::invalid_argument);
+
+	// Three tiles fill a 2x2 grid row by row
+	ShadowCascadeSet set(withSettings([](ShadowCascadeSettings& s) { s.cascadeCount = 3; s.cascadeResolution = 512; }));
+	EXPECT_EQ(set.GetCascadeCount(), 3u);
+	EXPECT_EQ(set.GetAtlasWidth(), 1024u);
+	EXPECT_EQ(set.GetAtlasHeight(), 1024u);
+	EXPECT_EQ(set.GetCascade(1).atlasX, 512u);
+	EXPECT_EQ(set.GetCascade(1).atlasY, 0u);
+	EXPECT_EQ(set.GetCascade(2).atlasX, 0u);
+	EXPECT_EQ(set.GetCascade(2).atlasY, 512u);
+	EXPECT_EQ(set.GetCascade(2).atlasSize, 512u);
+	EXPECT_THROW(set.GetCascade(3), std::out_of_range);
+	EXPECT_THROW(set.MarkStaticRendered(3), std::out_of_range);
+
+	set.SetSettings(withSettings([](ShadowCascadeSettings& s) { s.cascadeCount = 2; s.cascadeResolution = 1024; }));
+	EXPECT_EQ(set.GetAtlasWidth(), 2048u);
+	EXPECT_EQ(set.GetAtlasHeight(), 1024u);
+}
+
+TEST(ShadowCascades, CascadesCoverTheirSliceAndItsCasters)
+{
+	std::mt19937 random(1);
+	std::uniform_real_distribution<float> unit(-1.0f, 1.0f);
+
+	for (int trial = 0; trial < 200; trial++)
+	{
+		const float yaw = unit(random) * 3.0f;
+		const float pitch = unit(random) * 1.2f;
+		const float forward[3] = { std::cos(pitch) * std::sin(yaw), std::sin(pitch), std::cos(pitch) * std::cos(yaw) };
+		const float position[3] = { unit(random) * 50.0f, unit(random) * 10.0f, unit(random) * 50.0f };
+		const ShadowCamera camera = LookingCamera(position, forward, 0.5f + (unit(random) + 1.0f) * 0.6f, 1.0f + unit(random) + 1.0f, 50.0f + (unit(random) + 1.0f) * 100.0f);
+
+		float light[3] = { unit(random), -1.0f, unit(random) };
+		const float length = std::sqrt(light[0] * light[0] + light[1] * light[1] + light[2] * light[2]);
+		for (float& value : light)
+			value /= length;
+
+		ShadowCascadeSet set;
+		set.Update(camera, light);
+
+		float previousFar = camera.nearZ;
+		for (uint32_t index = 0; index < set.GetCascadeCount(); index++)
+		{
+			const ShadowCascade& cascade = set.GetCascade(index);
+			EXPECT_TRUE(cascade.staticDirty);
+			EXPECT_EQ(cascade.splitNear, previousFar);
+			previousFar = cascade.splitFar;
+
+			// Every corner of the slice lies in the sphere and inside the cascade's clip volume
+			for (uint32_t corner = 0; corner < 8; corner++)
+			{
+				float point[3];
+				SliceCorner(camera, (corner & 4) != 0 ? cascade.splitFar : cascade.splitNear, corner, point);
+
+				const float offset[3] = { point[0] - cascade.center[0], point[1] - cascade.center[1], point[2] - cascade.center[2] };
+				ASSERT_LE(std::sqrt(offset[0] * offset[0] + offset[1] * offset[1] + offset[2] * offset[2]), cascade.radius * 1.0001f) << "trial " << trial;
+
+				float clip[4];
+				TransformPoint(cascade.viewProjection, point, clip);
+				ASSERT_LE(std::fabs(clip[0]), 1.0001f) << "trial " << trial;
+				ASSERT_LE(std::fabs(clip[1]), 1.0001f) << "trial " << trial;
+				ASSERT_GE(clip[2], 0.0f) << "trial " << trial;
+				ASSERT_LE(clip[2], 1.0001f) << "trial " << trial;
+				ASSERT_EQ(clip[3], 1.0f);
+			}
+
+			// A caster almost the full caster distance towards the light still lands in front of the near plane
+			float caster[3];
+			for (uint32_t i = 0; i < 3; i++)
+				caster[i] = cascade.center[i] - light[i] * (cascade.radius + 99.0f);
+			float clip[4];
+			TransformPoint(cascade.viewProjection, caster, clip);
+			ASSERT_GE(clip[2], 0.0f) << "trial " << trial;
+			ASSERT_LT(clip[2], 0.01f) << "trial " << trial;
+		}
+		EXPECT_EQ(previousFar, camera.farZ);
+	}
+}
+
+TEST(ShadowCascades, ProjectionsSnapToWholeTexels)
+{
+	const float light[3] = { 0.0f, -1.0f, 0.0f };
+	float first[3] = { 1.0f, 0.0f, 2.0f };
+	float nudged[3] = { 1.001f, 0.0f, 2.0f };
+	float firstMatrix[16];
+	float nudgedMatrix[16];
+	BuildCascadeViewProjection(light, first, 10.0f, 0.0f, 1024, firstMatrix);
+	BuildCascadeViewProjection(light, nudged, 10.0f, 0.0f, 1024, nudgedMatrix);
+
+	// A sub-texel move leaves the projection exactly where it was
+	EXPECT_EQ(firstMatrix[12], nudgedMatrix[12]);
+	EXPECT_EQ(firstMatrix[13], nudgedMatrix[13]);
+	EXPECT_EQ(first[0], nudged[0]);
+
+	// A move of whole texels shifts it by exactly that many texels, 2 / 1024 in clip space each
+	float moved[3] = { 1.0f + 3.0f * 20.0f / 1024.0f, 0.0f, 2.0f };
+	float movedMatrix[16];
+	BuildCascadeViewProjection(light, moved, 10.0f, 0.0f, 1024, movedMatrix);
+	const float shift = std::fabs(movedMatrix[12] - firstMatrix[12]) + std::fabs(movedMatrix[13] - firstMatrix[13]);
+	EXPECT_NEAR(shift * 1024.0f / 2.0f, 3.0f, 1e-2f);
+
+	float zero[3] = { 0.0f, 0.0f, 0.0f };
+	float matrix[16];
+	EXPECT_THROW(BuildCascadeViewProjection(zero, first, 10.0f, 0.0f, 1024, matrix), std::invalid_argument);
+}
+
+TEST(ShadowCascades, StaticCacheSurvivesSmallMovesOnly)
+{
+	const float position[3] = { 0.0f, 2.0f, 0.0f };
+	const float forward[3] = { 0.0f, 0.0f, 1.0f };
+	ShadowCamera camera = LookingCamera(position, forward, 1.0f, 16.0f / 9.0f, 100.0f);
+	const float light[3] = { 0.3f, -1.0f, 0.2f };
+
+	ShadowCascadeSet set;
+	set.Update(camera, light);
+	EXPECT_EQ(DirtyCount(set), set.GetCascadeCount());
+	MarkAllRendered(set);
+	EXPECT_EQ(DirtyCount(set), 0u);
+
+	// A step well inside the padding keeps every cached projection
+	ShadowCascade before = set.GetCascade(0);
+	camera.cameraToWorld[12] += 0.01f;
+	set.Update(camera, light);
+	EXPECT_EQ(DirtyCount(set), 0u);
+	EXPECT_EQ(set.GetCascade(0).center[0], before.center[0]);
+
+	// Leaving the padded spheres invalidates every cascade
+	camera.cameraToWorld[12] += 1000.0f;
+	set.Update(camera, light);
+	EXPECT_EQ(DirtyCount(set), set.GetCascadeCount());
+	MarkAllRendered(set);
+
+	// So does turning the light beyond the tolerated angle, while a tiny turn does not
+	const float nudgedLight[3] = { 0.3f + 1e-5f, -1.0f, 0.2f };
+	set.Update(camera, nudgedLight);
+	EXPECT_EQ(DirtyCount(set), 0u);
+	const float turnedLight[3] = { 0.35f, -1.0f, 0.2f };
+	set.Update(camera, turnedLight);
+	EXPECT_EQ(DirtyCount(set), set.GetCascadeCount());
+
+	MarkAllRendered(set);
+	set.InvalidateStatic();
+	EXPECT_EQ(DirtyCount(set), set.GetCascadeCount());
+}
+
+TEST(ShadowCascades, CacheValidityFollowsTheThresholds)
+{
+	ShadowCascade cached;
+	cached.center[0] = 10.0f;
+	cached.radius = 5.0f;
+	cached.lightDirection[1] = -1.0f;
+
+	const float light[3] = { 0.0f, -1.0f, 0.0f };
+	const float minLightCosine = std::cos(0.01f);
+
+	// The required sphere must fit in the cached one
+	const float inside[3] = { 11.0f, 0.0f, 0.0f };
+	const float outside[3] = { 13.0f, 0.0f, 0.0f };
+	EXPECT_TRUE(IsCascadeCacheValid(cached, light, inside, 4.0f, minLightCosine));
+	EXPECT_FALSE(IsCascadeCacheValid(cached, light, inside, 4.5f, minLightCosine));
+	EXPECT_FALSE(IsCascadeCacheValid(cached, light, outside, 3.0f, minLightCosine));
+
+	const float slightlyTurned[3] = { std::sin(0.005f), -std::cos(0.005f), 0.0f };
+	const float turned[3] = { std::sin(0.02f), -std::cos(0.02f), 0.0f };
+	EXPECT_TRUE(IsCascadeCacheValid(cached, slightlyTurned, inside, 4.0f, minLightCosine));
+	EXPECT_FALSE(IsCascadeCacheValid(cached, turned, inside, 4.0f, minLightCosine));
+}
@@ -0,0 +1,72 @@
+#ifndef ULTREALITY_RENDERING_COMMON_TESTS_SIMULATED_FENCE_TIMELINE_H
+#define ULTREALITY_RENDERING_COMMON_TESTS_SIMULATED_FENCE_TIMELINE_H
+
+#include <stdint.h>
+#include <algorithm>
+#include <vector>
+
+#include <IFenceTimeline.h>
+
+namespace UltReality::Rendering::Common::Tests
+{
+	/// <summary>
+	/// Fence timeline of a simulated queue. The test decides when the GPU completes work, and a wait completes the
+	/// fence up to the awaited value as the GPU would have, recording the value so stalls can be checked
+	/// </summary>
+	class SimulatedFenceTimeline : public IFenceTimeline
+	{
+	private:
+		uint64_t m_signaledValue = 0;
+		uint64_t m_completedValue = 0;
+		// Value of every WaitForValue call that had to block, in call order
+		std::vector<uint64_t> m_blockingWaits;
+
+	public:
+		uint64_t Signal() override
+		{
+			return ++m_signaledValue;
+		}
+
+		uint64_t GetCompletedValue() const override
+		{
+			return m_completedValue;
+		}
+
+		void WaitForValue(uint64_t value) override
+		{
+			if (m_completedValue >= value)
+				return;
+
+			m_blockingWaits.push_back(value);
+			m_completedValue = value;
+		}
+
+		/// <summary>
+		/// Lets the GPU finish all work up to <paramref name="value"/>, never past the last signal
+		/// </summary>
+		void Complete(uint64_t value)
+		{
+			m_completedValue = std::max(m_completedValue, std::min(value, m_signaledValue));
+		}
+
+		/// <summary>
+		/// Lets the GPU finish all submitted work
+		/// </summary>
+		void CompleteAll()
+		{
+			m_completedValue = m_signaledValue;
+		}
+
+		uint64_t GetSignaledValue() const
+		{
+			return m_signaledValue;
+		}
+
+		const std::vector<uint64_t>& GetBlockingWaits() const
+		{
+			return m_blockingWaits;
+		}
+	};
+}
+
+#endif // !ULTREALITY_RENDERING_COMMON_TESTS_SIMULATED_FENCE_TIMELINE_H
@@ -0,0 +1,151 @@
+#ifndef ULTREALITY_RENDERING_COMMON_TESTS_SIMULATED_UPLOAD_QUEUE_H
+#define ULTREALITY_RENDERING_COMMON_TESTS_SIMULATED_UPLOAD_QUEUE_H
+
+#include <stdint.h>
+#include <atomic>
+#include <cstring>
+#include <deque>
+#include <mutex>
+#include <vector>
+
+#include <StreamingUploader.h>
+
+namespace UltReality::Rendering::Common::Tests
+{
+	/// <summary>
+	/// Copy queue whose GPU only runs when the test lets it. Copy destinations are std::vector&lt;uint8_t&gt; and a batch
+	/// reads the staging memory when it completes, not when it is submitted, so staging memory reused too early shows up
+	/// as wrong destination bytes. A wait completes the queue up to the awaited value, recording the value
+	/// </summary>
+	class SimulatedUploadQueue : public IUploadQueue
+	{
+	public:
+		struct Batch
+		{
+			uint64_t fenceValue = 0;
+			std::vector<UploadCopy> copies;
+		};
+
+	private:
+		std::vector<uint8_t> m_staging;
+		// Completes every batch as soon as it is submitted, a GPU that always keeps up
+		bool m_completeOnSubmit;
+
+		mutable std::mutex m_mutex;
+		std::vector<UploadCopy> m_open;
+		std::deque<Batch> m_executing;
+		std::vector<Batch> m_submitted;
+		std::vector<uint64_t> m_blockingWaits;
+		uint64_t m_submittedValue = 0;
+		std::atomic<uint64_t> m_completedValue{ 0 };
+
+		// Requires m_mutex
+		void CompleteLocked(uint64_t value)
+		{
+			while (!m_executing.empty() && m_executing.front().fenceValue <= value)
+			{
+				for (const UploadCopy& copy : m_executing.front().copies)
+				{
+					std::vector<uint8_t>& destination = *static_cast<std::vector<uint8_t>*>(copy.destination);
+					std::memcpy(destination.data() + copy.destinationOffset, m_staging.data() + copy.stagingOffset, copy.size);
+				}
+
+				m_completedValue.store(m_executing.front().fenceValue);
+				m_executing.pop_front();
+			}
+		}
+
+	public:
+		explicit SimulatedUploadQueue(uint64_t stagingCapacity, bool completeOnSubmit = false)
+			: m_staging(stagingCapacity), m_completeOnSubmit(completeOnSubmit)
+		{
+		}
+
+		uint8_t* GetStagingMemory() override
+		{
+			return m_staging.data();
+		}
+
+		uint64_t GetStagingCapacity() const override
+		{
+			return m_staging.size();
+		}
+
+		void RecordCopy(const UploadCopy& copy) override
+		{
+			std::lock_guard<std::mutex> lock(m_mutex);
+			m_open.push_back(copy);
+		}
+
+		uint64_t SubmitBatch() override
+		{
+			std::lock_guard<std::mutex> lock(m_mutex);
+
+			Batch batch;
+			batch.fenceValue = ++m_submittedValue;
+			batch.copies = std::move(m_open);
+			m_open.clear();
+
+			m_submitted.push_back(batch);
+			m_executing.push_back(std::move(batch));
+
+			if (m_completeOnSubmit)
+				CompleteLocked(m_submittedValue);
+
+			return m_submittedValue;
+		}
+
+		uint64_t GetCompletedValue() const override
+		{
+			return m_completedValue.load();
+		}
+
+		void WaitForValue(uint64_t value) override
+		{
+			std::lock_guard<std::mutex> lock(m_mutex);
+			if (m_completedValue.load() >= value)
+				return;
+
+			m_blockingWaits.push_back(value);
+			CompleteLocked(value);
+		}
+
+		/// <summary>
+		/// Lets the GPU finish every batch up to <paramref name="value"/>
+		/// </summary>
+		void Complete(uint64_t value)
+		{
+			std::lock_guard<std::mutex> lock(m_mutex);
+			CompleteLocked(value);
+		}
+
+		/// <summary>
+		/// Lets the GPU finish every submitted batch
+		/// </summary>
+		void CompleteAll()
+		{
+			std::lock_guard<std::mutex> lock(m_mutex);
+			CompleteLocked(m_submittedValue);
+		}
+
+		uint64_t GetSubmittedValue() const
+		{
+			std::lock_guard<std::mutex> lock(m_mutex);
+			return m_submittedValue;
+		}
+
+		std::vector<Batch> GetSubmittedBatches() const
+		{
+			std::lock_guard<std::mutex> lock(m_mutex);
+			return m_submitted;
+		}
+
+		std::vector<uint64_t> GetBlockingWaits() const
+		{
+			std::lock_guard<std::mutex> lock(m_mutex);
+			return m_blockingWaits;
+		}
+	};
+}
+
+#endif // !ULTREALITY_RENDERING_COMMON_TESTS_SIMULATED_UPLOAD_QUEUE_H
@@ -0,0 +1,219 @@
+#include <gtest/gtest.h>
+
+#include <atomic>
+#include <cstring>
+#include <future>
+#include <stdexcept>
+#include <thread>
+#include <vector>
+
+#include <StreamingUploader.h>
+#include <SimulatedUploadQueue.h>
+
+using namespace UltReality::Rendering::Common;
+using namespace UltReality::Rendering::Common::Tests;
+
+namespace
+{
+	// Spins until the uploader thread submitted batchCount batches
+	void WaitForSubmittedBatches(const SimulatedUploadQueue& queue, uint64_t batchCount)
+	{
+		while (queue.GetSubmittedValue() < batchCount)
+			std::this_thread::yield();
+	}
+
+	// Request whose writer blocks the uploader thread until release is set, so the test can queue more requests behind it.
+	// started is set once the uploader thread is inside the writer
+	UploadRequest BlockingRequest(std::vector<uint8_t>& destination, std::atomic<bool>& started, std::shared_future<void> release)
+	{
+		UploadRequest request;
+		request.size = 16;
+		request.destination = &destination;
+		request.write = [&started, release](uint8_t* staging)
+		{
+			started = true;
+			release.wait();
+			std::memset(staging, 0, 16);
+		};
+
+		return request;
+	}
+}
+
+TEST(StreamingUploader, RejectsInvalidRequests)
+{
+	SimulatedUploadQueue queue(4096);
+	EXPECT_THROW(StreamingUploader(&queue, 0, 16), std::invalid_argument);
+	EXPECT_THROW(StreamingUploader(&queue, 1024, 0), std::invalid_argument);
+
+	StreamingUploader uploader(&queue, 1024, 16);
+	std::vector<uint8_t> destination(4096);
+
+	UploadRequest noWriter;
+	noWriter.size = 16;
+	EXPECT_THROW(uploader.Enqueue(noWriter), std::invalid_argument);
+
+	UploadRequest unaligned;
+	unaligned.size = 16;
+	unaligned.alignment = 24;
+	unaligned.write = [](uint8_t*) {};
+	EXPECT_THROW(uploader.Enqueue(unaligned), std::invalid_argument);
+
+	// More than half the ring could never be placed behind a wrapped head
+	EXPECT_THROW(uploader.EnqueueBuffer(&destination, 0, std::vector<uint8_t>(2048)), std::invalid_argument);
+	EXPECT_THROW(uploader.EnqueueBuffer(&destination, 0, {}), std::invalid_argument);
+
+	EXPECT_THROW(uploader.Wait(1), std::invalid_argument);
+}
+
+TEST(StreamingUploader, BatchesQueuedRequestsUpToTheLimits)
+{
+	constexpr uint32_t maxBatchCopies = 64;
+	constexpr uint64_t maxBatchBytes = 4096;
+
+	SimulatedUploadQueue queue(1 << 20, true);
+	StreamingUploader uploader(&queue, maxBatchBytes, maxBatchCopies);
+	std::vector<uint8_t> destination(1 << 20);
+
+	std::atomic<bool> started{ false };
+	std::promise<void> release;
+	uploader.Enqueue(BlockingRequest(destination, started, release.get_future().share()));
+	while (!started)
+		std::this_thread::yield();
+
+	// Queued while the uploader thread is busy, so they are all pending when it next looks
+	constexpr uint32_t smallCount = 1000;
+	std::vector<UploadTicket> tickets;
+	for (uint32_t i = 0; i < smallCount; i++)
+		tickets.push_back(uploader.EnqueueBuffer(&destination, i * 32, std::vector<uint8_t>(32, static_cast<uint8_t>(i))));
+	// Too large to share a batch under the byte limit, but still uploaded on its own
+	const UploadTicket large = uploader.EnqueueBuffer(&destination, 64 * 1024, std::vector<uint8_t>(8192, 0xAB));
+
+	release.set_value();
+	uploader.WaitForIdle();
+
+	EXPECT_TRUE(uploader.IsComplete(large));
+	EXPECT_EQ(uploader.GetCompletedTicket(), large);
+	for (uint32_t i = 0; i < smallCount; i++)
+		ASSERT_EQ(destination[i * 32 + 31], static_cast<uint8_t>(i)) << "request " << i;
+	EXPECT_EQ(destination[64 * 1024 + 8191], 0xAB);
+
+	// The copy limit allows 64 per batch, the byte limit 128, so 1000 requests take 16 batches after the blocking one
+	const std::vector<SimulatedUploadQueue::Batch> batches = queue.GetSubmittedBatches();
+	ASSERT_EQ(batches.size(), 1u + 16u + 1u);
+	for (size_t i = 1; i + 1 < batches.size(); i++)
+	{
+		uint64_t bytes = 0;
+		for (const UploadCopy& copy : batches[i].copies)
+			bytes += copy.size;
+
+		EXPECT_LE(batches[i].copies.size(), maxBatchCopies);
+		EXPECT_LE(bytes, maxBatchBytes);
+	}
+	ASSERT_EQ(batches.back().copies.size(), 1u);
+	EXPECT_EQ(batches.back().copies[0].size, 8192u);
+
+	const StreamingUploader::Statistics statistics = uploader.GetStatistics();
+	EXPECT_EQ(statistics.requestCount, smallCount + 2);
+	EXPECT_EQ(statistics.batchCount, batches.size());
+	EXPECT_EQ(statistics.bytesUploaded, 16u + smallCount * 32 + 8192);
+	EXPECT_EQ(statistics.stagingStalls, 0u);
+}
+
+TEST(StreamingUploader, TicketsCompleteWithTheirBatchFence)
+{
+	SimulatedUploadQueue queue(1 << 16);
+	StreamingUploader uploader(&queue, 1 << 16, 1);
+	std::vector<uint8_t> destination(1024);
+
+	const UploadTicket first = uploader.EnqueueBuffer(&destination, 0, std::vector<uint8_t>(8, 1));
+	const UploadTicket second = uploader.EnqueueBuffer(&destination, 8, std::vector<uint8_t>(8, 2));
+	const UploadTicket third = uploader.EnqueueBuffer(&destination, 16, std::vector<uint8_t>(8, 3));
+	EXPECT_EQ(first, 1u);
+	EXPECT_EQ(second, 2u);
+	EXPECT_EQ(third, 3u);
+
+	// One copy per batch, so every ticket has its own fence value
+	WaitForSubmittedBatches(queue, 3);
+	EXPECT_FALSE(uploader.IsComplete(first));
+	EXPECT_EQ(destination[0], 0u);
+
+	queue.Complete(2);
+	EXPECT_TRUE(uploader.IsComplete(first));
+	EXPECT_TRUE(uploader.IsComplete(second));
+	EXPECT_FALSE(uploader.IsComplete(third));
+	EXPECT_EQ(uploader.GetCompletedTicket(), second);
+	EXPECT_EQ(destination[8], 2u);
+
+	// Waiting blocks on exactly the fence of the ticket's batch
+	uploader.Wait(third);
+	EXPECT_EQ(queue.GetBlockingWaits(), std::vector<uint64_t>{ 3 });
+	EXPECT_EQ(destination[16], 3u);
+
+	// Waiting on a complete ticket does not touch the queue
+	uploader.Wait(first);
+	EXPECT_EQ(queue.GetBlockingWaits().size(), 1u);
+}
+
+TEST(StreamingUploader, ReusesStagingMemoryOnlyAfterItsBatchCompleted)
+{
+	// Room for three 1000 byte requests, the GPU never completes on its own
+	SimulatedUploadQueue queue(4096);
+	StreamingUploader uploader(&queue, 1 << 16, 2);
+
+	constexpr uint32_t requestCount = 200;
+	std::vector<uint8_t> destination(requestCount * 1000);
+	for (uint32_t i = 0; i < requestCount; i++)
+	{
+		std::vector<uint8_t> data(1000);
+		for (uint32_t byte = 0; byte < data.size(); byte++)
+			data[byte] = static_cast<uint8_t>(i * 7 + byte);
+
+		uploader.EnqueueBuffer(&destination, i * 1000, std::move(data));
+	}
+
+	uploader.WaitForIdle();
+
+	// The batches read staging when they complete, so a request written over memory still in flight corrupts one
+	for (uint32_t i = 0; i < requestCount; i++)
+	{
+		for (uint32_t byte = 0; byte < 1000; byte += 97)
+			ASSERT_EQ(destination[i * 1000 + byte], static_cast<uint8_t>(i * 7 + byte)) << "request " << i << " byte " << byte;
+	}
+
+	const StreamingUploader::Statistics statistics = uploader.GetStatistics();
+	EXPECT_GT(statistics.stagingStalls, 0u);
+	EXPECT_EQ(statistics.requestCount, requestCount);
+}
+
+TEST(StreamingUploader, WriterFailuresReachTheCaller)
+{
+	SimulatedUploadQueue queue(4096, true);
+	StreamingUploader uploader(&queue, 1024, 16);
+
+	UploadRequest failing;
+	failing.size = 16;
+	failing.write = [](uint8_t*) { throw std::runtime_error("source data unavailable"); };
+	const UploadTicket ticket = uploader.Enqueue(std::move(failing));
+
+	EXPECT_THROW(uploader.Wait(ticket), std::runtime_error);
+
+	// The uploader thread stopped, further requests are refused with the same error
+	std::vector<uint8_t> destination(64);
+	EXPECT_THROW(uploader.EnqueueBuffer(&destination, 0, std::vector<uint8_t>(8)), std::runtime_error);
+}
+
+TEST(StreamingUploader, DestructionSubmitsQueuedRequests)
+{
+	SimulatedUploadQueue queue(1 << 16);
+	std::vector<uint8_t> destination(1024);
+	{
+		StreamingUploader uploader(&queue, 1 << 16, 4);
+		for (uint32_t i = 0; i < 32; i++)
+			uploader.EnqueueBuffer(&destination, i * 8, std::vector<uint8_t>(8, static_cast<uint8_t>(i + 1)));
+	}
+
+	queue.CompleteAll();
+	for (uint32_t i = 0; i < 32; i++)
+		EXPECT_EQ(destination[i * 8], i + 1);
+}
@@ -0,0 +1,290 @@
+#include <gtest/gtest.h>
+
+#include <algorithm>
+#include <random>
+#include <stdexcept>
+#include <vector>
+
+#include <TextureStreaming.h>
+
+using namespace UltReality::Rendering::Common;
+
+namespace
+{
+	constexpr uint64_t megabyte = 1024 * 1024;
+	constexpr uint64_t tailSize = 4096;
+
+	// RGBA8 texture with a full mip chain down to 64 pixels, and everything smaller packed into one tail
+	StreamingTextureDesc SquareTexture(uint32_t baseSize)
+	{
+		StreamingTextureDesc desc;
+		desc.baseSize = baseSize;
+		for (uint32_t size = baseSize; size >= 64; size /= 2)
+			desc.mipSizes.push_back(static_cast<uint64_t>(size) * size * 4);
+		desc.mipSizes.push_back(tailSize);
+
+		return desc;
+	}
+
+	// Backend that finishes loads a fixed number of updates after they were issued and keeps its own account of
+	// resident memory, so the manager's accounting can be checked against what was actually loaded and evicted
+	class SimulatedStreamingBackend
+	{
+	private:
+		struct InFlightLoad
+		{
+			TextureMipChange change;
+			uint64_t readyUpdate;
+		};
+
+		TextureStreamingManager& m_manager;
+		std::vector<StreamingTextureDesc> m_descs;
+		std::vector<uint32_t> m_residentMips;
+		std::vector<bool> m_loading;
+		std::vector<InFlightLoad> m_inFlight;
+		uint64_t m_updateIndex = 0;
+		uint64_t m_loadLatency;
+
+	public:
+		SimulatedStreamingBackend(TextureStreamingManager& manager, uint64_t loadLatency)
+			: m_manager(manager), m_loadLatency(loadLatency)
+		{
+		}
+
+		uint32_t Register(const StreamingTextureDesc& desc)
+		{
+			const uint32_t texture = m_manager.Register(desc);
+			EXPECT_EQ(texture, m_descs.size());
+
+			m_descs.push_back(desc);
+			m_residentMips.push_back(static_cast<uint32_t>(desc.mipSizes.size()) - 1);
+			m_loading.push_back(false);
+
+			return texture;
+		}
+
+		void Update()
+		{
+			m_updateIndex++;
+			const TextureStreamingUpdate update = m_manager.Update();
+
+			for (const TextureMipChange& load : update.loads)
+			{
+				ASSERT_FALSE(m_loading[load.texture]) << "second load in flight for texture " << load.texture;
+				ASSERT_LT(load.mip, m_residentMips[load.texture]) << "load of texture " << load.texture << " is not finer";
+
+				m_loading[load.texture] = true;
+				m_inFlight.push_back(InFlightLoad{ load, m_updateIndex + m_loadLatency });
+			}
+
+			for (const TextureMipChange& eviction : update.evictions)
+			{
+				ASSERT_FALSE(m_loading[eviction.texture]) << "eviction of texture " << eviction.texture << " while it loads";
+				ASSERT_GT(eviction.mip, m_residentMips[eviction.texture]) << "eviction of texture " << eviction.texture << " is not coarser";
+
+				m_residentMips[eviction.texture] = eviction.mip;
+			}
+
+			for (size_t i = 0; i < m_inFlight.size();)
+			{
+				if (m_inFlight[i].readyUpdate > m_updateIndex)
+				{
+					i++;
+					continue;
+				}
+
+				const TextureMipChange load = m_inFlight[i].change;
+				m_residentMips[load.texture] = load.mip;
+				m_loading[load.texture] = false;
+				m_manager.OnMipsResident(load.texture, load.mip);
+
+				m_inFlight[i] = m_inFlight.back();
+				m_inFlight.pop_back();
+			}
+		}
+
+		// Memory of every resident mip plus the mips of loads in flight
+		uint64_t GetCommittedBytes() const
+		{
+			std::vector<uint32_t> finest = m_residentMips;
+			for (const InFlightLoad& load : m_inFlight)
+				finest[load.change.texture] = std::min(finest[load.change.texture], load.change.mip);
+
+			uint64_t bytes = 0;
+			for (size_t texture = 0; texture < m_descs.size(); texture++)
+			{
+				for (size_t mip = finest[texture]; mip < m_descs[texture].mipSizes.size(); mip++)
+					bytes += m_descs[texture].mipSizes[mip];
+			}
+
+			return bytes;
+		}
+
+		bool IsIdle() const
+		{
+			return m_inFlight.empty();
+		}
+
+		uint32_t GetResidentMip(uint32_t texture) const
+		{
+			return m_residentMips[texture];
+		}
+	};
+}
+
+TEST(TextureStreaming, RegistersTexturesWithOnlyTheirTail)
+{
+	TextureStreamingManager manager(64 * megabyte);
+
+	EXPECT_THROW(manager.Register(StreamingTextureDesc{}), std::invalid_argument);
+	EXPECT_THROW(manager.Register(StreamingTextureDesc{ 0, { tailSize } }), std::invalid_argument);
+
+	const uint32_t texture = manager.Register(SquareTexture(1024));
+	EXPECT_EQ(manager.GetResidentMip(texture), 5u);
+	EXPECT_EQ(manager.GetRequestedMip(texture), 5u);
+	EXPECT_EQ(manager.GetStatistics().textureCount, 1u);
+
+	// Indices of unregistered textures are reused
+	manager.Unregister(texture);
+	EXPECT_EQ(manager.GetStatistics().textureCount, 0u);
+	EXPECT_EQ(manager.Register(SquareTexture(256)), texture);
+}
+
+TEST(TextureStreaming, RequestsTheMipMatchingTheFootprint)
+{
+	TextureStreamingManager manager(256 * megabyte);
+	const uint32_t texture = manager.Register(SquareTexture(1024));
+
+	auto requestedFor = [&](float footprint)
+	{
+		if (footprint > 0.0f)
+			manager.ReportFootprint(texture, footprint);
+		manager.Update();
+
+		return manager.GetRequestedMip(texture);
+	};
+
+	EXPECT_EQ(requestedFor(2048.0f), 0u);
+	EXPECT_EQ(requestedFor(1024.0f), 0u);
+	EXPECT_EQ(requestedFor(512.0f), 1u);
+	EXPECT_EQ(requestedFor(300.0f), 1u);
+	EXPECT_EQ(requestedFor(256.0f), 2u);
+	EXPECT_EQ(requestedFor(1.0f), 5u);
+	// Not drawn since the last update
+	EXPECT_EQ(requestedFor(0.0f), 5u);
+
+	// The largest footprint of an update counts
+	manager.ReportFootprint(texture, 100.0f);
+	manager.ReportFootprint(texture, 1024.0f);
+	manager.Update();
+	EXPECT_EQ(manager.GetRequestedMip(texture), 0u);
+
+	// A positive bias streams coarser mips
+	manager.SetMipBias(1.0f);
+	EXPECT_EQ(requestedFor(1024.0f), 1u);
+}
+
+TEST(TextureStreaming, SpendsTheBudgetOnTheMostVisibleTexturesFirst)
+{
+	// Mip 0 and 1 of a 1024 texture take 5 MB, all three textures fully resident would need 15 MB
+	TextureStreamingManager manager(8 * megabyte);
+	SimulatedStreamingBackend backend(manager, 1);
+	const uint32_t close = backend.Register(SquareTexture(1024));
+	const uint32_t far = backend.Register(SquareTexture(1024));
+	const uint32_t hidden = backend.Register(SquareTexture(1024));
+
+	for (int update = 0; update < 4; update++)
+	{
+		manager.ReportFootprint(close, 1500.0f);
+		manager.ReportFootprint(far, 300.0f);
+		backend.Update();
+		ASSERT_FALSE(HasFatalFailure());
+	}
+
+	EXPECT_EQ(manager.GetTargetMip(close), 0u);
+	EXPECT_EQ(manager.GetTargetMip(far), 1u);
+	EXPECT_EQ(manager.GetTargetMip(hidden), 5u);
+	EXPECT_EQ(backend.GetResidentMip(close), 0u);
+	EXPECT_EQ(backend.GetResidentMip(far), 1u);
+
+	// The far texture never goes finer than it asked for, even with budget to spare
+	manager.SetBudget(64 * megabyte);
+	manager.ReportFootprint(close, 1500.0f);
+	manager.ReportFootprint(far, 300.0f);
+	backend.Update();
+	EXPECT_EQ(manager.GetTargetMip(far), manager.GetRequestedMip(far));
+	EXPECT_EQ(manager.GetStatistics().requestedBytes, manager.GetStatistics().committedBytes);
+}
+
+TEST(TextureStreaming, KeepsMipsCachedUntilTheBudgetNeedsThem)
+{
+	TextureStreamingManager manager(16 * megabyte);
+	SimulatedStreamingBackend backend(manager, 0);
+	const uint32_t first = backend.Register(SquareTexture(1024));
+	const uint32_t second = backend.Register(SquareTexture(1024));
+
+	manager.ReportFootprint(first, 1024.0f);
+	manager.ReportFootprint(second, 1024.0f);
+	backend.Update();
+	EXPECT_EQ(backend.GetResidentMip(first), 0u);
+	EXPECT_EQ(backend.GetResidentMip(second), 0u);
+
+	// Neither is drawn any more, but the budget still holds both, so nothing is evicted
+	backend.Update();
+	EXPECT_EQ(manager.GetStatistics().evictionCount, 0u);
+	EXPECT_EQ(backend.GetResidentMip(first), 0u);
+
+	// The first texture comes back into view while the budget shrinks: the invisible one is evicted, and only that
+	manager.SetBudget(8 * megabyte);
+	manager.ReportFootprint(first, 1024.0f);
+	backend.Update();
+	ASSERT_FALSE(HasFatalFailure());
+	EXPECT_EQ(manager.GetStatistics().evictionCount, 1u);
+	EXPECT_EQ(backend.GetResidentMip(first), 0u);
+	EXPECT_EQ(backend.GetResidentMip(second), 5u);
+	EXPECT_LE(manager.GetStatistics().committedBytes, 8 * megabyte);
+}
+
+TEST(TextureStreaming, SimulatedBudgetsAreRespectedOnceLoadsSettle)
+{
+	std::mt19937 random(1);
+	TextureStreamingManager manager(64 * megabyte);
+	SimulatedStreamingBackend backend(manager, 3);
+
+	std::vector<uint32_t> textures;
+	for (int i = 0; i < 200; i++)
+		textures.push_back(backend.Register(SquareTexture(64u << (random() % 6))));
+
+	for (int update = 0; update < 600; update++)
+	{
+		// The budget moves as other applications take and release video memory
+		if (update % 50 == 0)
+			manager.SetBudget((8 + random() % 120) * megabyte);
+
+		for (uint32_t texture : textures)
+		{
+			if (random() % 3 != 0)
+				manager.ReportFootprint(texture, static_cast<float>(random() % 2000));
+		}
+
+		backend.Update();
+		ASSERT_FALSE(HasFatalFailure()) << "update " << update;
+
+		for (uint32_t texture : textures)
+			ASSERT_GE(manager.GetTargetMip(texture), manager.GetRequestedMip(texture)) << "texture " << texture;
+
+		ASSERT_EQ(manager.GetStatistics().committedBytes, backend.GetCommittedBytes()) << "update " << update;
+	}
+
+	// With the view held still and the loads done, memory stays within the budget and the plan is stable
+	for (int update = 0; update < 10; update++)
+	{
+		for (uint32_t texture : textures)
+			manager.ReportFootprint(texture, 500.0f);
+		backend.Update();
+	}
+
+	EXPECT_TRUE(backend.IsIdle());
+	EXPECT_EQ(manager.GetStatistics().loadCount, 0u);
+	EXPECT_LE(manager.GetStatistics().committedBytes, manager.GetStatistics().budgetBytes);
+}
@@ -0,0 +1,93 @@
+#ifndef ULTREALITY_RENDERING_COMMON_TESTS_BENCHMARK_UTILITIES_H
+#define ULTREALITY_RENDERING_COMMON_TESTS_BENCHMARK_UTILITIES_H
+
+#include <stddef.h>
+#include <algorithm>
+#include <chrono>
+#include <vector>
+
+namespace UltReality::Rendering::Common::Tests
+{
+	using BenchmarkClock = std::chrono::steady_clock;
+
+	/// <summary>
+	/// Milliseconds elapsed since <paramref name="start"/>
+	/// </summary>
+	inline double MillisecondsSince(BenchmarkClock::time_point start)
+	{
+		return std::chrono::duration<double, std::milli>(BenchmarkClock::now() - start).count();
+	}
+
+	/// <summary>
+	/// Runs <paramref name="function"/> <paramref name="repetitions"/> times and returns the fastest run in
+	/// milliseconds. The fastest run is the one least disturbed by the rest of the machine
+	/// </summary>
+	template<typename Function>
+	double BestOfMilliseconds(int repetitions, Function&& function)
+	{
+		double best = 0.0;
+		for (int repetition = 0; repetition < repetitions; repetition++)
+		{
+			const auto start = BenchmarkClock::now();
+			function();
+			const double elapsed = MillisecondsSince(start);
+			best = repetition == 0 ? elapsed : std::min(best, elapsed);
+		}
+
+		return best;
+	}
+
+	/// <summary>
+	/// Collects individual latencies, in nanoseconds, and reports their distribution
+	/// </summary>
+	class LatencySamples
+	{
+	private:
+		std::vector<double> m_samples;
+		bool m_sorted = true;
+
+	public:
+		void Add(double nanoseconds)
+		{
+			m_samples.push_back(nanoseconds);
+			m_sorted = false;
+		}
+
+		size_t Count() const
+		{
+			return m_samples.size();
+		}
+
+		double Mean() const
+		{
+			if (m_samples.empty())
+				return 0.0;
+
+			double sum = 0.0;
+			for (double sample : m_samples)
+				sum += sample;
+
+			return sum / static_cast<double>(m_samples.size());
+		}
+
+		/// <summary>
+		/// Gets the sample below which <paramref name="fraction"/> of the samples fall
+		/// </summary>
+		double Percentile(double fraction)
+		{
+			if (m_samples.empty())
+				return 0.0;
+
+			if (!m_sorted)
+			{
+				std::sort(m_samples.begin(), m_samples.end());
+				m_sorted = true;
+			}
+
+			const size_t index = static_cast<size_t>(fraction * static_cast<double>(m_samples.size() - 1) + 0.5);
+			return m_samples[std::min(index, m_samples.size() - 1)];
+		}
+	};
+}
+
+#endif // !ULTREALITY_RENDERING_COMMON_TESTS_BENCHMARK_UTILITIES_H
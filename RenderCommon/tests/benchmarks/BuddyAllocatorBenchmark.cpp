@@ -0,0 +1,121 @@
+#include <gtest/gtest.h>
+
+#include <stdio.h>
+#include <random>
+#include <vector>
+
+#include <BuddyAllocator.h>
+#include <BenchmarkUtilities.h>
+
+using namespace UltReality::Rendering::Common;
+using namespace UltReality::Rendering::Common::Tests;
+
+namespace
+{
+	constexpr uint64_t kilobyte = 1024;
+	constexpr uint64_t megabyte = 1024 * kilobyte;
+
+	struct TraceResult
+	{
+		LatencySamples allocateNanoseconds;
+		LatencySamples freeNanoseconds;
+		double meanFragmentation = 0.0;
+		double maxFragmentation = 0.0;
+		double meanInternalWaste = 0.0;
+		uint64_t failedAllocations = 0;
+	};
+
+	// Replays a trace shaped like a level's GPU resources: many small buffers and textures, some large render
+	// targets, freed in random order while the heap is kept at a target load
+	TraceResult RunTrace(uint64_t capacity, float targetLoad, int steps, uint32_t seed)
+	{
+		BuddyAllocator allocator(capacity, 64 * kilobyte);
+		std::mt19937 random(seed);
+		std::uniform_int_distribution<uint64_t> smallSizes(4 * kilobyte, 1 * megabyte);
+		std::uniform_int_distribution<uint64_t> largeSizes(2 * megabyte, 16 * megabyte);
+
+		TraceResult result;
+		std::vector<uint64_t> live;
+		int sampleCount = 0;
+		for (int step = 0; step < steps; step++)
+		{
+			const BuddyAllocator::Statistics stats = allocator.GetStatistics();
+			const bool allocate = live.empty() || static_cast<float>(stats.usedBytes) < targetLoad * static_cast<float>(capacity);
+			if (allocate)
+			{
+				const uint64_t size = (random() % 10 == 0) ? largeSizes(random) : smallSizes(random);
+				const uint64_t alignment = (random() % 4 == 0) ? 4 * megabyte : 64 * kilobyte;
+
+				const auto start = BenchmarkClock::now();
+				const uint64_t offset = allocator.Allocate(size, alignment);
+				result.allocateNanoseconds.Add(std::chrono::duration<double, std::nano>(BenchmarkClock::now() - start).count());
+
+				if (offset == BuddyAllocator::invalidOffset)
+				{
+					result.failedAllocations++;
+					// Free something so the trace keeps moving, as a streaming system would evict
+					const size_t index = random() % live.size();
+					allocator.Free(live[index]);
+					live[index] = live.back();
+					live.pop_back();
+					continue;
+				}
+				live.push_back(offset);
+			}
+			else
+			{
+				const size_t index = random() % live.size();
+
+				const auto start = BenchmarkClock::now();
+				allocator.Free(live[index]);
+				result.freeNanoseconds.Add(std::chrono::duration<double, std::nano>(BenchmarkClock::now() - start).count());
+
+				live[index] = live.back();
+				live.pop_back();
+			}
+
+			// Sample the heap once it reached its steady state
+			if (step > steps / 10 && step % 64 == 0)
+			{
+				const BuddyAllocator::Statistics sample = allocator.GetStatistics();
+				result.meanFragmentation += sample.fragmentation;
+				result.maxFragmentation = std::max(result.maxFragmentation, static_cast<double>(sample.fragmentation));
+				if (sample.usedBytes > 0)
+					result.meanInternalWaste += 1.0 - static_cast<double>(sample.requestedBytes) / static_cast<double>(sample.usedBytes);
+				sampleCount++;
+			}
+		}
+
+		if (sampleCount > 0)
+		{
+			result.meanFragmentation /= sampleCount;
+			result.meanInternalWaste /= sampleCount;
+		}
+
+		return result;
+	}
+}
+
+TEST(BuddyAllocatorBenchmark, FragmentationAndLatency)
+{
+	constexpr uint64_t capacity = 256 * megabyte;
+	constexpr int steps = 200000;
+
+	printf("%-6s %12s %12s %12s %12s %12s %10s %10s %8s\n",
+		"load", "alloc avg", "alloc p99", "alloc max", "free avg", "free p99", "frag avg", "frag max", "waste");
+
+	for (float load : { 0.5f, 0.75f, 0.9f })
+	{
+		TraceResult result = RunTrace(capacity, load, steps, 1234);
+
+		printf("%-6.2f %10.0fns %10.0fns %10.0fns %10.0fns %10.0fns %10.3f %10.3f %7.1f%%\n",
+			load,
+			result.allocateNanoseconds.Mean(), result.allocateNanoseconds.Percentile(0.99), result.allocateNanoseconds.Percentile(1.0),
+			result.freeNanoseconds.Mean(), result.freeNanoseconds.Percentile(0.99),
+			result.meanFragmentation, result.maxFragmentation, 100.0 * result.meanInternalWaste);
+		printf("       %llu of %zu allocations failed\n",
+			static_cast<unsigned long long>(result.failedAllocations), result.allocateNanoseconds.Count());
+
+		EXPECT_GT(result.allocateNanoseconds.Count(), 0u);
+	}
+}
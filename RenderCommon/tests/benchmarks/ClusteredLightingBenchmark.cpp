@@ -0,0 +1,60 @@
+#include <gtest/gtest.h>
+
+#include <stdio.h>
+#include <random>
+#include <vector>
+
+#include <ClusteredLighting.h>
+#include <FrustumCulling.h>
+#include <JobSystem.h>
+#include <BenchmarkUtilities.h>
+
+using namespace UltReality::Rendering::Common;
+using namespace UltReality::Rendering::Common::Tests;
+
+TEST(ClusteredLightingBenchmark, BinningTimeByLightCount)
+{
+	JobSystem jobSystem;
+
+	printf("%8s %6s %12s %12s %12s %10s %12s\n", "lights", "path", "jobs ms", "serial ms", "reference ms", "indices", "max/cluster");
+	for (uint32_t count : { 1000u, 4000u, 16000u, 64000u })
+	{
+		std::mt19937 random(count);
+		std::uniform_real_distribution<float> unit(0.0f, 1.0f);
+		BoundingSphereSoA lights;
+		for (uint32_t i = 0; i < count; i++)
+		{
+			const float z = unit(random) * 130.0f - 5.0f;
+			const float center[3] = { (unit(random) * 2.0f - 1.0f) * z * 1.1f, (unit(random) * 2.0f - 1.0f) * z * 0.7f, z };
+			lights.Add(center, 0.2f + unit(random) * 3.0f);
+		}
+
+		ClusteredLightBinner parallel(&jobSystem);
+		ClusteredLightBinner serial;
+		parallel.SetProjection(1.0f, 16.0f / 9.0f, 0.1f, 100.0f);
+		serial.SetProjection(1.0f, 16.0f / 9.0f, 0.1f, 100.0f);
+
+		std::vector<ClusterLightRange> clusters;
+		std::vector<uint32_t> lightIndices;
+
+		// The brute force reference is too slow to be worth timing beyond a few thousand lights
+		double referenceMilliseconds = 0.0;
+		if (count <= 4000)
+			referenceMilliseconds = BestOfMilliseconds(1, [&]() { BinClusterLightsReference(serial, lights, clusters, lightIndices); });
+
+		for (CullingSimdPath path : { CullingSimdPath::Scalar, CullingSimdPath::Sse, CullingSimdPath::Neon, CullingSimdPath::Avx2 })
+		{
+			if (!FrustumCuller::IsSimdPathSupported(path))
+				continue;
+
+			parallel.SetSimdPath(path);
+			serial.SetSimdPath(path);
+			const double parallelMilliseconds = BestOfMilliseconds(5, [&]() { parallel.Bin(lights, clusters, lightIndices); });
+			const double serialMilliseconds = BestOfMilliseconds(3, [&]() { serial.Bin(lights, clusters, lightIndices); });
+
+			const ClusteredLightBinner::Statistics& statistics = parallel.GetStatistics();
+			printf("%8u %6u %12.3f %12.3f %12.1f %10u %12u\n", count, static_cast<uint32_t>(path), parallelMilliseconds, serialMilliseconds,
+				referenceMilliseconds, statistics.indexCount, statistics.maxLightsPerCluster);
+		}
+	}
+}
@@ -0,0 +1,87 @@
+#include <gtest/gtest.h>
+
+#include <stdio.h>
+#include <cmath>
+#include <random>
+#include <vector>
+
+#include <FrustumCulling.h>
+#include <GpuCulling.h>
+#include <JobSystem.h>
+#include <BenchmarkUtilities.h>
+
+using namespace UltReality::Rendering::Common;
+using namespace UltReality::Rendering::Common::Tests;
+
+namespace
+{
+	const char* PathName(CullingSimdPath path)
+	{
+		switch (path)
+		{
+		case CullingSimdPath::Sse:
+			return "SSE";
+		case CullingSimdPath::Neon:
+			return "NEON";
+		case CullingSimdPath::Avx2:
+			return "AVX2";
+		default:
+			return "Scalar";
+		}
+	}
+}
+
+TEST(FrustumCullingBenchmark, ObjectsCulledPerMillisecond)
+{
+	const float yScale = 1.0f / std::tan(0.5f);
+	const float range = 150.0f / 149.0f;
+	const float viewProjection[16] = {
+		yScale, 0.0f, 0.0f, 0.0f,
+		0.0f, yScale, 0.0f, 0.0f,
+		0.0f, 0.0f, range, 1.0f,
+		0.0f, 0.0f, -range, 0.0f
+	};
+	float planes[6][4];
+	ExtractFrustumPlanes(viewProjection, planes);
+
+	JobSystem jobSystem;
+
+	printf("%8s %8s %9s %16s %16s %16s\n", "objects", "path", "visible", "spheres/ms", "spheres/ms jobs", "boxes/ms jobs");
+	for (uint32_t count : { 10000u, 100000u, 1000000u })
+	{
+		std::mt19937 random(7);
+		std::uniform_real_distribution<float> position(-100.0f, 100.0f);
+
+		BoundingSphereSoA spheres;
+		BoundingBoxSoA boxes;
+		for (uint32_t i = 0; i < count; i++)
+		{
+			const float center[3] = { position(random), position(random), position(random) + 100.0f };
+			spheres.Add(center, std::abs(position(random)) / 20.0f);
+
+			const float min[3] = { center[0] - 1.0f, center[1] - 1.0f, center[2] - 1.0f };
+			const float max[3] = { center[0] + 1.0f, center[1] + 1.0f, center[2] + 1.0f };
+			boxes.Add(min, max);
+		}
+
+		for (CullingSimdPath path : { CullingSimdPath::Scalar, CullingSimdPath::Sse, CullingSimdPath::Neon, CullingSimdPath::Avx2 })
+		{
+			if (!FrustumCuller::IsSimdPathSupported(path))
+				continue;
+
+			FrustumCuller serial;
+			FrustumCuller parallel(&jobSystem);
+			serial.SetSimdPath(path);
+			parallel.SetSimdPath(path);
+
+			std::vector<uint32_t> visible;
+			const double serialSpheres = BestOfMilliseconds(20, [&]() { serial.CullSpheres(planes, spheres, visible); });
+			const double parallelSpheres = BestOfMilliseconds(20, [&]() { parallel.CullSpheres(planes, spheres, visible); });
+			const size_t visibleCount = visible.size();
+			const double parallelBoxes = BestOfMilliseconds(20, [&]() { parallel.CullBoxes(planes, boxes, visible); });
+
+			printf("%8u %8s %9zu %16.0f %16.0f %16.0f\n", count, PathName(path), visibleCount,
+				count / serialSpheres, count / parallelSpheres, count / parallelBoxes);
+		}
+	}
+}
@@ -0,0 +1,70 @@
+#include <gtest/gtest.h>
+
+#include <stdio.h>
+#include <random>
+#include <vector>
+
+#include <InstanceBatcher.h>
+#include <BenchmarkUtilities.h>
+
+using namespace UltReality::Rendering::Common;
+using namespace UltReality::Rendering::Common::Tests;
+
+namespace
+{
+	struct Scene
+	{
+		const char* name;
+		uint32_t drawCount;
+		// Distinct meshes and materials the draws pick from
+		uint32_t meshCount;
+		uint32_t materialCount;
+		// One in how many draws is transparent, zero for none
+		uint32_t transparentEvery;
+	};
+}
+
+TEST(InstanceBatcherBenchmark, DrawCallReduction)
+{
+	// A prop-heavy forest, a city block with more variety, an interior with glass, and the worst case of all unique draws
+	const Scene scenes[] = {
+		{ "forest", 100000, 20, 4, 0 },
+		{ "city", 100000, 500, 16, 0 },
+		{ "interior", 20000, 300, 32, 10 },
+		{ "unique", 20000, 20000, 1, 0 }
+	};
+
+	printf("%10s %8s %8s %10s %10s\n", "scene", "draws", "batches", "reduction", "build ms");
+	for (const Scene& scene : scenes)
+	{
+		std::mt19937 random(9);
+		std::uniform_real_distribution<float> depth(0.0f, 1.0f);
+
+		std::vector<uint64_t> sortKeys(scene.drawCount);
+		std::vector<uint64_t> batchKeys(scene.drawCount);
+		for (uint32_t draw = 0; draw < scene.drawCount; draw++)
+		{
+			const bool transparent = scene.transparentEvery != 0 && random() % scene.transparentEvery == 0;
+			const uint32_t mesh = scene.meshCount == scene.drawCount ? draw : random() % scene.meshCount;
+			const uint32_t material = random() % scene.materialCount;
+
+			DrawSortKeyFields fields;
+			fields.layer = transparent ? DrawLayer::Transparent : DrawLayer::Opaque;
+			fields.pipeline = transparent ? 1 : 0;
+			fields.material = material;
+			fields.depth = depth(random);
+			sortKeys[draw] = EncodeDrawSortKey(fields);
+			batchKeys[draw] = static_cast<uint64_t>(mesh) << 32 | material << 1 | (transparent ? 1u : 0u);
+		}
+
+		InstanceBatcher batcher;
+		std::vector<InstanceBatch> batches;
+		std::vector<uint32_t> instanceOrder;
+		const double milliseconds = BestOfMilliseconds(10, [&]() { batcher.Build(sortKeys, batchKeys, batches, instanceOrder); });
+
+		printf("%10s %8u %8zu %9.1fx %10.3f\n", scene.name, scene.drawCount, batches.size(),
+			static_cast<double>(scene.drawCount) / static_cast<double>(batches.size()), milliseconds);
+
+		EXPECT_LE(batches.size(), scene.drawCount);
+	}
+}
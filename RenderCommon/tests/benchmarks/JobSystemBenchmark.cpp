@@ -0,0 +1,76 @@
+#include <gtest/gtest.h>
+
+#include <stdio.h>
+#include <algorithm>
+#include <atomic>
+#include <thread>
+
+#include <JobSystem.h>
+#include <BenchmarkUtilities.h>
+
+using namespace UltReality::Rendering::Common;
+using namespace UltReality::Rendering::Common::Tests;
+
+namespace
+{
+	// Stand-in for recording a chunk of draws, a few microseconds of work that does not touch shared memory
+	uint64_t SimulateWork(uint32_t seed, uint32_t iterations)
+	{
+		uint64_t state = seed * 0x9E3779B97F4A7C15ull + 1;
+		for (uint32_t i = 0; i < iterations; i++)
+			state ^= (state << 13) ^ (state >> 7) ^ (state << 17);
+
+		return state;
+	}
+
+	double RunWorkload(JobSystem& jobSystem, uint32_t jobCount, uint32_t iterations)
+	{
+		std::atomic<uint64_t> sink{ 0 };
+
+		return BestOfMilliseconds(5, [&]()
+		{
+			JobCounter counter;
+			jobSystem.Dispatch(jobCount, 1, [&](uint32_t first, uint32_t, uint32_t)
+			{
+				sink.fetch_xor(SimulateWork(first, iterations), std::memory_order_relaxed);
+			}, counter);
+			jobSystem.Wait(counter);
+		});
+	}
+}
+
+TEST(JobSystemBenchmark, ScalingWithCoreCount)
+{
+	const uint32_t hardwareThreads = std::max(1u, std::thread::hardware_concurrency());
+	constexpr uint32_t jobCount = 4096;
+
+	// Small jobs measure the scheduling overhead, large ones how close the speedup gets to the core count
+	for (uint32_t iterations : { 200u, 5000u })
+	{
+		uint64_t serialSink = 0;
+		const double serial = BestOfMilliseconds(5, [&]()
+		{
+			for (uint32_t job = 0; job < jobCount; job++)
+				serialSink ^= SimulateWork(job, iterations);
+		});
+
+		printf("%u jobs of %u iterations, %u hardware threads, %.2fms serial\n", jobCount, iterations, hardwareThreads, serial);
+		printf("%8s %12s %10s %12s\n", "workers", "time", "speedup", "efficiency");
+
+		// The calling thread is a worker too, so the system always has one more worker than background threads
+		const uint32_t maxThreads = std::max(hardwareThreads - 1, 1u);
+		for (uint32_t threads = 1; ; threads = std::min(threads * 2, maxThreads))
+		{
+			JobSystem jobSystem(threads);
+			const double milliseconds = RunWorkload(jobSystem, jobCount, iterations);
+
+			const double speedup = serial / milliseconds;
+			printf("%8u %10.2fms %9.2fx %11.0f%%\n", jobSystem.GetWorkerCount(), milliseconds, speedup, 100.0 * speedup / jobSystem.GetWorkerCount());
+
+			if (threads == maxThreads)
+				break;
+		}
+
+		EXPECT_NE(serialSink, 1u);
+	}
+}
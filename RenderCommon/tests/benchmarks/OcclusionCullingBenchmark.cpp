@@ -0,0 +1,82 @@
+#include <gtest/gtest.h>
+
+#include <stdio.h>
+#include <cmath>
+#include <random>
+#include <vector>
+
+#include <OcclusionCulling.h>
+#include <FrustumCulling.h>
+#include <JobSystem.h>
+#include <BenchmarkUtilities.h>
+
+using namespace UltReality::Rendering::Common;
+using namespace UltReality::Rendering::Common::Tests;
+
+TEST(OcclusionCullingBenchmark, RasterizationAndOccludeeThroughput)
+{
+	float viewProjection[16] = {};
+	const float yScale = 1.0f / std::tan(0.6f);
+	viewProjection[0] = yScale / 2.0f;
+	viewProjection[5] = yScale;
+	viewProjection[10] = 1000.0f / 999.9f;
+	viewProjection[11] = 1.0f;
+	viewProjection[14] = -0.1f * 1000.0f / 999.9f;
+
+	// An interior's worth of low-poly occluders, and occludees spread through the same volume
+	std::mt19937 random(7);
+	std::uniform_real_distribution<float> unit(-1.0f, 1.0f);
+	std::vector<float> positions;
+	std::vector<uint32_t> indices;
+	for (uint32_t triangle = 0; triangle < 2000; triangle++)
+	{
+		const float center[3] = { unit(random) * 60.0f, unit(random) * 30.0f, 5.0f + (unit(random) + 1.0f) * 50.0f };
+		for (uint32_t vertex = 0; vertex < 3; vertex++)
+		{
+			for (uint32_t axis = 0; axis < 3; axis++)
+				positions.push_back(center[axis] + unit(random) * 6.0f);
+			indices.push_back(triangle * 3 + vertex);
+		}
+	}
+
+	constexpr uint32_t occludeeCount = 100000;
+	BoundingBoxSoA boxes;
+	for (uint32_t box = 0; box < occludeeCount; box++)
+	{
+		const float center[3] = { unit(random) * 80.0f, unit(random) * 40.0f, 20.0f + (unit(random) + 1.0f) * 60.0f };
+		const float min[3] = { center[0] - 1.0f, center[1] - 1.0f, center[2] - 1.0f };
+		const float max[3] = { center[0] + 1.0f, center[1] + 1.0f, center[2] + 1.0f };
+		boxes.Add(min, max);
+	}
+
+	JobSystem jobSystem;
+
+	printf("%8s %8s %10s %14s %14s %12s\n", "path", "jobs", "triangles", "raster ms", "occludees/ms", "occluded");
+	for (CullingSimdPath path : { CullingSimdPath::Scalar, CullingSimdPath::Sse, CullingSimdPath::Neon, CullingSimdPath::Avx2 })
+	{
+		if (!FrustumCuller::IsSimdPathSupported(path))
+			continue;
+
+		for (JobSystem* jobs : { static_cast<JobSystem*>(nullptr), &jobSystem })
+		{
+			OcclusionCuller culler(jobs, 320, 176);
+			culler.SetSimdPath(path);
+			culler.BeginFrame(viewProjection);
+			culler.AddOccluder(positions.data(), static_cast<uint32_t>(positions.size() / 3), indices.data(), static_cast<uint32_t>(indices.size()));
+
+			const double rasterMilliseconds = BestOfMilliseconds(20, [&]() { culler.Rasterize(); });
+
+			std::vector<uint32_t> visible;
+			const double testMilliseconds = BestOfMilliseconds(20, [&]()
+			{
+				visible.resize(occludeeCount);
+				for (uint32_t i = 0; i < occludeeCount; i++)
+					visible[i] = i;
+				culler.CullBoxes(boxes, visible);
+			});
+
+			printf("%8u %8s %10zu %14.3f %14.0f %12zu\n", static_cast<uint32_t>(path), jobs ? "yes" : "no", culler.GetTriangles().size(),
+				rasterMilliseconds, occludeeCount / testMilliseconds, occludeeCount - visible.size());
+		}
+	}
+}
@@ -0,0 +1,59 @@
+#include <gtest/gtest.h>
+
+#include <stdio.h>
+#include <cstring>
+#include <vector>
+
+#include <StreamingUploader.h>
+#include <SimulatedUploadQueue.h>
+#include <BenchmarkUtilities.h>
+
+using namespace UltReality::Rendering::Common;
+using namespace UltReality::Rendering::Common::Tests;
+
+namespace
+{
+	constexpr uint64_t kilobyte = 1024;
+	constexpr uint64_t megabyte = 1024 * kilobyte;
+}
+
+TEST(StreamingUploaderBenchmark, ThroughputByRequestSize)
+{
+	// The simulated GPU completes every batch on submission, so this measures the CPU side: queueing, the uploader
+	// thread's writes into staging and the batching. Copy time on a real queue comes on top
+	constexpr uint64_t totalBytes = 256 * megabyte;
+	constexpr uint64_t stagingCapacity = 64 * megabyte;
+	constexpr uint64_t maxBatchBytes = 4 * megabyte;
+	constexpr uint32_t maxBatchCopies = 1024;
+
+	printf("%10s %10s %12s %10s %12s %14s\n", "size", "requests", "time", "batches", "MB/s", "requests/s");
+	for (uint64_t requestSize : { uint64_t(256), 4 * kilobyte, 64 * kilobyte, 1 * megabyte })
+	{
+		const uint64_t requestCount = totalBytes / requestSize;
+		std::vector<uint8_t> source(requestSize, 0x5A);
+		std::vector<uint8_t> destination(requestSize);
+
+		SimulatedUploadQueue queue(stagingCapacity, true);
+		StreamingUploader uploader(&queue, maxBatchBytes, maxBatchCopies);
+
+		const auto start = BenchmarkClock::now();
+		for (uint64_t request = 0; request < requestCount; request++)
+		{
+			UploadRequest upload;
+			upload.size = requestSize;
+			upload.destination = &destination;
+			upload.write = [&source](uint8_t* staging) { std::memcpy(staging, source.data(), source.size()); };
+			uploader.Enqueue(std::move(upload));
+		}
+		uploader.WaitForIdle();
+		const double milliseconds = MillisecondsSince(start);
+
+		const StreamingUploader::Statistics statistics = uploader.GetStatistics();
+		printf("%9lluB %10llu %10.1fms %10llu %12.0f %14.0f\n", static_cast<unsigned long long>(requestSize),
+			static_cast<unsigned long long>(requestCount), milliseconds, static_cast<unsigned long long>(statistics.batchCount),
+			totalBytes / static_cast<double>(megabyte) / (milliseconds / 1000.0), requestCount / (milliseconds / 1000.0));
+
+		EXPECT_EQ(statistics.requestCount, requestCount);
+		EXPECT_EQ(destination.back(), 0x5A);
+	}
+}